@@ -63,6 +63,8 @@ public:
     virtual bool onActivate();
     virtual F32 getEaseInDuration();
     virtual bool onUpdate(F32 activeTime, U8* joint_mask);
+    // onUpdate() adjusts the pelvis after the keyframes
+    virtual bool canDeferPose() { return false; }
 
 protected:
     //-------------------------------------------------------------------------
@@ -39,6 +39,7 @@
 #include "llendianswizzle.h"
 #include "llkeyframemotion.h"
 #include "llquantize.h"
+#include "llvector4a.h"
 #include "m3math.h"
 #include "message.h"
 #include "llfilesystem.h"
@@ -130,6 +131,109 @@ U32 LLKeyframeMotion::JointMotionList::dumpDiagInfo()
 //-----------------------------------------------------------------------------
 
 
+namespace
+{
+    // Index of the first key at or after time, like std::lower_bound, but
+    // starting from where the previous lookup landed
+    U32 find_key(const std::vector<F32>& times, F32 time, U32& cursor)
+    {
+        const U32 count = (U32)times.size();
+        U32 right = llmin(cursor, count);
+        if (right > 0 && times[right - 1] >= time)
+        {
+            // time went back, the animation looped
+            right = (U32)(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+        }
+        else if (right < count && times[right] < time)
+        {
+            // usually just the next key
+            ++right;
+            if (right < count && times[right] < time)
+            {
+                right = (U32)(std::lower_bound(times.begin() + right, times.end(), time) - times.begin());
+            }
+        }
+        cursor = right;
+        return right;
+    }
+
+    // Clamped before the first and after the last key, interpolated between
+    template <typename VALUE, typename INTERP>
+    VALUE curve_value(const std::vector<F32>& times, const std::vector<VALUE>& values,
+                      F32 time, U32& cursor, INTERP&& interp)
+    {
+        U32 right = find_key(times, time, cursor);
+        if (right == times.size())
+        {
+            // Past last key
+            return values.back();
+        }
+        if (right == 0 || times[right] == time)
+        {
+            // Before first key or exactly on a key
+            return values[right];
+        }
+        // Between two keys
+        U32 left = right - 1;
+        F32 u = (time - times[left]) / (times[right] - times[left]);
+        return interp(u, values[left], values[right]);
+    }
+
+    template <typename VALUE>
+    void add_key(std::vector<F32>& times, std::vector<VALUE>& values, F32 time, const VALUE& value)
+    {
+        // keys mostly arrive in order
+        if (times.empty() || times.back() < time)
+        {
+            times.push_back(time);
+            values.push_back(value);
+            return;
+        }
+        auto found = std::lower_bound(times.begin(), times.end(), time);
+        size_t index = found - times.begin();
+        if (*found == time)
+        {
+            values[index] = value;
+        }
+        else
+        {
+            times.insert(found, time);
+            values.insert(values.begin() + index, value);
+        }
+    }
+
+    // nlerp() with the same hemisphere case, nearly all of them for
+    // neighbouring keys, done in SIMD
+    LLQuaternion nlerp4a(F32 u, const LLQuaternion& a, const LLQuaternion& b)
+    {
+        LLVector4a qa, qb;
+        qa.loadua(a.mQ);
+        qb.loadua(b.mQ);
+        if (qa.dot4(qb).getF32() < 0.f)
+        {
+            return slerp(u, a, b);
+        }
+
+        LLVector4a delta;
+        delta.setSub(qb, qa);
+        delta.mul(u);
+        qa.add(delta);
+
+        // same as LLQuaternion::normalize()
+        F32 mag = sqrtf(qa.dot4(qa).getF32());
+        LLQuaternion result;
+        if (mag > FP_MAG_THRESHOLD)
+        {
+            if (fabs(1.f - mag) > ONE_PART_IN_A_MILLION)
+            {
+                qa.mul(1.f / mag);
+            }
+            _mm_storeu_ps(result.mQ, qa);
+        }
+        return result;
+    }
+}
+
 //-----------------------------------------------------------------------------
 // ScaleCurve::ScaleCurve()
 //-----------------------------------------------------------------------------
@@ -144,72 +248,59 @@ LLKeyframeMotion::ScaleCurve::ScaleCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::ScaleCurve::~ScaleCurve()
 {
-    mKeys.clear();
     mNumKeys = 0;
 }
 
 //-----------------------------------------------------------------------------
 // getValue()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration)
+LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration) const
 {
-    LLVector3 value;
+    U32 cursor = 0;
+    return getValue(time, duration, cursor);
+}
 
-    if (mKeys.empty())
+LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration, U32& cursor) const
+{
+    if (mKeyTimes.empty())
     {
+        LLVector3 value;
         value.clearVec();
         return value;
     }
 
-    key_map_t::iterator right = mKeys.lower_bound(time);
-    if (right == mKeys.end())
-    {
-        // Past last key
-        --right;
-        value = right->second.mScale;
-    }
-    else if (right == mKeys.begin() || right->first == time)
-    {
-        // Before first key or exactly on a key
-        value = right->second.mScale;
-    }
-    else
-    {
-        // Between two keys
-        key_map_t::iterator left = right; --left;
-        F32 index_before = left->first;
-        F32 index_after = right->first;
-        ScaleKey& scale_before = left->second;
-        ScaleKey& scale_after = right->second;
-        if (right == mKeys.end())
-        {
-            scale_after = mLoopInKey;
-            index_after = duration;
-        }
-
-        F32 u = (time - index_before) / (index_after - index_before);
-        value = interp(u, scale_before, scale_after);
-    }
-    return value;
+    return curve_value(mKeyTimes, mKeyScales, time, cursor,
+                       [this](F32 u, const LLVector3& before, const LLVector3& after)
+                       {
+                           return interp(u, before, after);
+                       });
 }
 
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, ScaleKey& before, ScaleKey& after)
+LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, const LLVector3& before, const LLVector3& after) const
 {
     switch (mInterpolationType)
     {
     case IT_STEP:
-        return before.mScale;
+        return before;
 
     default:
     case IT_LINEAR:
     case IT_SPLINE:
-        return lerp(before.mScale, after.mScale, u);
+        return lerp(before, after, u);
     }
 }
 
+//-----------------------------------------------------------------------------
+// addKey()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::ScaleCurve::addKey(const ScaleKey& key)
+{
+    add_key(mKeyTimes, mKeyScales, key.mTime, key.mScale);
+}
+
 //-----------------------------------------------------------------------------
 // RotationCurve::RotationCurve()
 //-----------------------------------------------------------------------------
@@ -224,72 +315,57 @@ LLKeyframeMotion::RotationCurve::RotationCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::RotationCurve::~RotationCurve()
 {
-    mKeys.clear();
     mNumKeys = 0;
 }
 
 //-----------------------------------------------------------------------------
 // RotationCurve::getValue()
 //-----------------------------------------------------------------------------
-LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
+LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration) const
 {
-    LLQuaternion value;
-
-    if (mKeys.empty())
-    {
-        value = LLQuaternion::DEFAULT;
-        return value;
-    }
+    U32 cursor = 0;
+    return getValue(time, duration, cursor);
+}
 
-    key_map_t::iterator right = mKeys.lower_bound(time);
-    if (right == mKeys.end())
-    {
-        // Past last key
-        --right;
-        value = right->second.mRotation;
-    }
-    else if (right == mKeys.begin() || right->first == time)
+LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration, U32& cursor) const
+{
+    if (mKeyTimes.empty())
     {
-        // Before first key or exactly on a key
-        value = right->second.mRotation;
+        return LLQuaternion::DEFAULT;
     }
-    else
-    {
-        // Between two keys
-        key_map_t::iterator left = right; --left;
-        F32 index_before = left->first;
-        F32 index_after = right->first;
-        RotationKey& rot_before = left->second;
-        RotationKey& rot_after = right->second;
-        if (right == mKeys.end())
-        {
-            rot_after = mLoopInKey;
-            index_after = duration;
-        }
 
-        F32 u = (time - index_before) / (index_after - index_before);
-        value = interp(u, rot_before, rot_after);
-    }
-    return value;
+    return curve_value(mKeyTimes, mKeyRotations, time, cursor,
+                       [this](F32 u, const LLQuaternion& before, const LLQuaternion& after)
+                       {
+                           return interp(u, before, after);
+                       });
 }
 
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, RotationKey& before, RotationKey& after)
+LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, const LLQuaternion& before, const LLQuaternion& after) const
 {
     switch (mInterpolationType)
     {
     case IT_STEP:
-        return before.mRotation;
+        return before;
 
     default:
     case IT_LINEAR:
     case IT_SPLINE:
-        return nlerp(u, before.mRotation, after.mRotation);
+        return nlerp4a(u, before, after);
     }
 }
 
+//-----------------------------------------------------------------------------
+// addKey()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::RotationCurve::addKey(const RotationKey& key)
+{
+    add_key(mKeyTimes, mKeyRotations, key.mTime, key.mRotation);
+}
+
 
 //-----------------------------------------------------------------------------
 // PositionCurve::PositionCurve()
@@ -305,52 +381,32 @@ LLKeyframeMotion::PositionCurve::PositionCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::PositionCurve::~PositionCurve()
 {
-    mKeys.clear();
     mNumKeys = 0;
 }
 
 //-----------------------------------------------------------------------------
 // PositionCurve::getValue()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
+LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration) const
 {
-    LLVector3 value;
+    U32 cursor = 0;
+    return getValue(time, duration, cursor);
+}
 
-    if (mKeys.empty())
+LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration, U32& cursor) const
+{
+    if (mKeyTimes.empty())
     {
+        LLVector3 value;
         value.clearVec();
         return value;
     }
 
-    key_map_t::iterator right = mKeys.lower_bound(time);
-    if (right == mKeys.end())
-    {
-        // Past last key
-        --right;
-        value = right->second.mPosition;
-    }
-    else if (right == mKeys.begin() || right->first == time)
-    {
-        // Before first key or exactly on a key
-        value = right->second.mPosition;
-    }
-    else
-    {
-        // Between two keys
-        key_map_t::iterator left = right; --left;
-        F32 index_before = left->first;
-        F32 index_after = right->first;
-        PositionKey& pos_before = left->second;
-        PositionKey& pos_after = right->second;
-        if (right == mKeys.end())
-        {
-            pos_after = mLoopInKey;
-            index_after = duration;
-        }
-
-        F32 u = (time - index_before) / (index_after - index_before);
-        value = interp(u, pos_before, pos_after);
-    }
+    LLVector3 value = curve_value(mKeyTimes, mKeyPositions, time, cursor,
+                                  [this](F32 u, const LLVector3& before, const LLVector3& after)
+                                  {
+                                      return interp(u, before, after);
+                                  });
 
     llassert(value.isFinite());
 
@@ -360,19 +416,27 @@ LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, PositionKey& after)
+LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, const LLVector3& before, const LLVector3& after) const
 {
     switch (mInterpolationType)
     {
     case IT_STEP:
-        return before.mPosition;
+        return before;
     default:
     case IT_LINEAR:
     case IT_SPLINE:
-        return lerp(before.mPosition, after.mPosition, u);
+        return lerp(before, after, u);
     }
 }
 
+//-----------------------------------------------------------------------------
+// addKey()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::PositionCurve::addKey(const PositionKey& key)
+{
+    add_key(mKeyTimes, mKeyPositions, key.mTime, key.mPosition);
+}
+
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -383,7 +447,7 @@ LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, Po
 //-----------------------------------------------------------------------------
 // JointMotion::update()
 //-----------------------------------------------------------------------------
-void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration)
+void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration, KeyCursor& cursor) const
 {
     // this value being 0 is the cause of https://jira.lindenlab.com/browse/SL-22678 but I haven't
     // managed to get a stack to see how it got here. Testing for 0 here will stop the crash.
@@ -399,7 +463,7 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
     //-------------------------------------------------------------------------
     if ((usage & LLJointState::SCALE) && mScaleCurve.mNumKeys)
     {
-        joint_state->setScale( mScaleCurve.getValue( time, duration ) );
+        joint_state->setScale( mScaleCurve.getValue( time, duration, cursor.mScale ) );
     }
 
     //-------------------------------------------------------------------------
@@ -407,7 +471,7 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
     //-------------------------------------------------------------------------
     if ((usage & LLJointState::ROT) && mRotationCurve.mNumKeys)
     {
-        joint_state->setRotation( mRotationCurve.getValue( time, duration ) );
+        joint_state->setRotation( mRotationCurve.getValue( time, duration, cursor.mRotation ) );
     }
 
     //-------------------------------------------------------------------------
@@ -415,7 +479,7 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
     //-------------------------------------------------------------------------
     if ((usage & LLJointState::POS) && mPositionCurve.mNumKeys)
     {
-        joint_state->setPosition( mPositionCurve.getValue( time, duration ) );
+        joint_state->setPosition( mPositionCurve.getValue( time, duration, cursor.mPosition ) );
     }
 }
 
@@ -723,28 +787,75 @@ bool LLKeyframeMotion::onUpdate(F32 time, U8* joint_mask)
         mLastLoopedTime = time;
     }
 
-    applyKeyframes(mLastLoopedTime);
+    if (mDeferPose)
+    {
+        // the curves get evaluated in evaluatePose()
+        applyHandPose();
+    }
+    else
+    {
+        applyKeyframes(mLastLoopedTime);
 
-    applyConstraints(mLastLoopedTime, joint_mask);
+        applyConstraints(mLastLoopedTime, joint_mask);
+    }
 
     mLastUpdateTime = time;
 
     return mLastLoopedTime <= mJointMotionList->mDuration;
 }
 
+//-----------------------------------------------------------------------------
+// LLKeyframeMotion::canDeferPose()
+//-----------------------------------------------------------------------------
+bool LLKeyframeMotion::canDeferPose()
+{
+    // constraints work from this frame's keyframes and the world around the
+    // character, so they need the curves evaluated inside onUpdate()
+    return mJointMotionList && mConstraints.empty();
+}
+
+//-----------------------------------------------------------------------------
+// LLKeyframeMotion::evaluatePose()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::evaluatePose()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    evaluateKeyframes(mLastLoopedTime);
+}
+
 //-----------------------------------------------------------------------------
 // applyKeyframes()
 //-----------------------------------------------------------------------------
 void LLKeyframeMotion::applyKeyframes(F32 time)
+{
+    evaluateKeyframes(time);
+    applyHandPose();
+}
+
+//-----------------------------------------------------------------------------
+// evaluateKeyframes()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::evaluateKeyframes(F32 time)
 {
     llassert_always (mJointMotionList->getNumJointMotions() <= mJointStates.size());
+    if (mKeyCursors.size() != mJointMotionList->getNumJointMotions())
+    {
+        mKeyCursors.resize(mJointMotionList->getNumJointMotions());
+    }
     for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
     {
         mJointMotionList->getJointMotion(i)->update(mJointStates[i],
                                                       time,
-                                                      mJointMotionList->mDuration );
+                                                      mJointMotionList->mDuration,
+                                                      mKeyCursors[i]);
     }
+}
 
+//-----------------------------------------------------------------------------
+// applyHandPose()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::applyHandPose()
+{
     LLJoint::JointPriority* pose_priority = (LLJoint::JointPriority* )mCharacter->getAnimationData("Hand Pose Priority");
     if (pose_priority)
     {
@@ -1663,14 +1774,17 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
                 return false;
             }
 
-            rCurve->mKeys[time] = rot_key;
+            rCurve->addKey(rot_key);
         }
+        // curves stay in the keyframe cache for as long as the animation is used
+        rCurve->mKeyTimes.shrink_to_fit();
+        rCurve->mKeyRotations.shrink_to_fit();
 
-        if (joint_motion->mRotationCurve.mNumKeys > joint_motion->mRotationCurve.mKeys.size())
+        if (joint_motion->mRotationCurve.mNumKeys > joint_motion->mRotationCurve.getKeyCount())
         {
             rotation_duplicates++;
             LL_INFOS() << "Motion " << asset() << " had duplicated rotation keys that were removed: "
-                << joint_motion->mRotationCurve.mNumKeys << " > " << joint_motion->mRotationCurve.mKeys.size()
+                << joint_motion->mRotationCurve.mNumKeys << " > " << joint_motion->mRotationCurve.getKeyCount()
                 << " (" << rotation_duplicates << ")" << LL_ENDL;
         }
 
@@ -1772,19 +1886,21 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
                 return false;
             }
 
-            pCurve->mKeys[pos_key.mTime] = pos_key;
+            pCurve->addKey(pos_key);
 
             if (is_pelvis)
             {
                 joint_motion_list->mPelvisBBox.addPoint(pos_key.mPosition);
             }
         }
+        pCurve->mKeyTimes.shrink_to_fit();
+        pCurve->mKeyPositions.shrink_to_fit();
 
-        if (joint_motion->mPositionCurve.mNumKeys > joint_motion->mPositionCurve.mKeys.size())
+        if (joint_motion->mPositionCurve.mNumKeys > joint_motion->mPositionCurve.getKeyCount())
         {
             position_duplicates++;
             LL_INFOS() << "Motion " << asset() << " had duplicated position keys that were removed: "
-                << joint_motion->mPositionCurve.mNumKeys << " > " << joint_motion->mPositionCurve.mKeys.size()
+                << joint_motion->mPositionCurve.mNumKeys << " > " << joint_motion->mPositionCurve.getKeyCount()
                 << " (" << position_duplicates << ")" << LL_ENDL;
         }
 
@@ -2082,15 +2198,15 @@ bool LLKeyframeMotion::serialize(LLDataPacker& dp) const
         JointMotion* joint_motionp = mJointMotionList->getJointMotion(i);
         success &= dp.packString(joint_motionp->mJointName, "joint_name");
         success &= dp.packS32(joint_motionp->mPriority, "joint_priority");
-        success &= dp.packS32(static_cast<S32>(joint_motionp->mRotationCurve.mKeys.size()), "num_rot_keys");
+        success &= dp.packS32(static_cast<S32>(joint_motionp->mRotationCurve.getKeyCount()), "num_rot_keys");
 
         LL_DEBUGS("BVH") << "Joint " << i
             << " name: " << joint_motionp->mJointName
-            << " Rotation keys: " << joint_motionp->mRotationCurve.mKeys.size()
-            << " Position keys: " << joint_motionp->mPositionCurve.mKeys.size() << LL_ENDL;
-        for (RotationCurve::key_map_t::value_type& rot_pair : joint_motionp->mRotationCurve.mKeys)
+            << " Rotation keys: " << joint_motionp->mRotationCurve.getKeyCount()
+            << " Position keys: " << joint_motionp->mPositionCurve.getKeyCount() << LL_ENDL;
+        for (U32 k = 0; k < joint_motionp->mRotationCurve.getKeyCount(); k++)
         {
-            RotationKey& rot_key = rot_pair.second;
+            RotationKey rot_key = joint_motionp->mRotationCurve.getKey(k);
             U16 time_short = F32_to_U16(rot_key.mTime, 0.f, mJointMotionList->mDuration);
             success &= dp.packU16(time_short, "time");
 
@@ -2108,15 +2224,17 @@ bool LLKeyframeMotion::serialize(LLDataPacker& dp) const
             LL_DEBUGS("BVH") << "  rot: t " << rot_key.mTime << " angles " << rot_angles.mV[VX] <<","<< rot_angles.mV[VY] <<","<< rot_angles.mV[VZ] << LL_ENDL;
         }
 
-        success &= dp.packS32(static_cast<S32>(joint_motionp->mPositionCurve.mKeys.size()), "num_pos_keys");
-        for (PositionCurve::key_map_t::value_type& pos_pair : joint_motionp->mPositionCurve.mKeys)
+        success &= dp.packS32(static_cast<S32>(joint_motionp->mPositionCurve.getKeyCount()), "num_pos_keys");
+        for (U32 k = 0; k < joint_motionp->mPositionCurve.getKeyCount(); k++)
         {
-            PositionKey& pos_key = pos_pair.second;
+            // the curve keeps the quantized position
+            LLVector3& position = joint_motionp->mPositionCurve.mKeyPositions[k];
+            position.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+            PositionKey pos_key = joint_motionp->mPositionCurve.getKey(k);
             U16 time_short = F32_to_U16(pos_key.mTime, 0.f, mJointMotionList->mDuration);
             success &= dp.packU16(time_short, "time");
 
             U16 x, y, z;
-            pos_key.mPosition.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
             x = F32_to_U16(pos_key.mPosition.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
             y = F32_to_U16(pos_key.mPosition.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
             z = F32_to_U16(pos_key.mPosition.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
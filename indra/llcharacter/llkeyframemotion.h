@@ -147,6 +147,10 @@ public:
     // called when a motion is deactivated
     virtual void onDeactivate();
 
+    // curves of motions without constraints can be evaluated off the main thread
+    virtual bool canDeferPose();
+    virtual void evaluatePose();
+
     virtual void setStopTime(F32 time);
 
     static void onLoadComplete(const LLUUID& asset_uuid,
@@ -261,6 +265,10 @@ protected:
 
     void applyKeyframes(F32 time);
 
+    void evaluateKeyframes(F32 time);
+
+    void applyHandPose();
+
     void applyConstraints(F32 time, U8* joint_mask);
 
     void activateConstraint(JointConstraint* constraintp);
@@ -325,15 +333,23 @@ public:
     public:
         ScaleCurve();
         ~ScaleCurve();
-        LLVector3 getValue(F32 time, F32 duration);
-        LLVector3 interp(F32 u, ScaleKey& before, ScaleKey& after);
-
-        InterpolationType   mInterpolationType;
-        S32                 mNumKeys;
-        typedef std::map<F32, ScaleKey> key_map_t;
-        key_map_t           mKeys;
-        ScaleKey            mLoopInKey;
-        ScaleKey            mLoopOutKey;
+        LLVector3 getValue(F32 time, F32 duration) const;
+        // cursor remembers the key found last time, see JointMotion::KeyCursor
+        LLVector3 getValue(F32 time, F32 duration, U32& cursor) const;
+        LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after) const;
+
+        // keeps the keys sorted, a key at the time of another replaces it
+        void addKey(const ScaleKey& key);
+        U32 getKeyCount() const { return (U32)mKeyTimes.size(); }
+        ScaleKey getKey(U32 index) const { return ScaleKey(mKeyTimes[index], mKeyScales[index]); }
+
+        InterpolationType       mInterpolationType;
+        S32                     mNumKeys;
+        // sorted by time, one entry per key in each
+        std::vector<F32>        mKeyTimes;
+        std::vector<LLVector3>  mKeyScales;
+        ScaleKey                mLoopInKey;
+        ScaleKey                mLoopOutKey;
     };
 
     //-------------------------------------------------------------------------
@@ -344,15 +360,23 @@ public:
     public:
         RotationCurve();
         ~RotationCurve();
-        LLQuaternion getValue(F32 time, F32 duration);
-        LLQuaternion interp(F32 u, RotationKey& before, RotationKey& after);
-
-        InterpolationType   mInterpolationType;
-        S32                 mNumKeys;
-        typedef std::map<F32, RotationKey> key_map_t;
-        key_map_t       mKeys;
-        RotationKey     mLoopInKey;
-        RotationKey     mLoopOutKey;
+        LLQuaternion getValue(F32 time, F32 duration) const;
+        // cursor remembers the key found last time, see JointMotion::KeyCursor
+        LLQuaternion getValue(F32 time, F32 duration, U32& cursor) const;
+        LLQuaternion interp(F32 u, const LLQuaternion& before, const LLQuaternion& after) const;
+
+        // keeps the keys sorted, a key at the time of another replaces it
+        void addKey(const RotationKey& key);
+        U32 getKeyCount() const { return (U32)mKeyTimes.size(); }
+        RotationKey getKey(U32 index) const { return RotationKey(mKeyTimes[index], mKeyRotations[index]); }
+
+        InterpolationType           mInterpolationType;
+        S32                         mNumKeys;
+        // sorted by time, one entry per key in each
+        std::vector<F32>            mKeyTimes;
+        std::vector<LLQuaternion>   mKeyRotations;
+        RotationKey                 mLoopInKey;
+        RotationKey                 mLoopOutKey;
     };
 
     //-------------------------------------------------------------------------
@@ -363,15 +387,23 @@ public:
     public:
         PositionCurve();
         ~PositionCurve();
-        LLVector3 getValue(F32 time, F32 duration);
-        LLVector3 interp(F32 u, PositionKey& before, PositionKey& after);
-
-        InterpolationType   mInterpolationType;
-        S32                 mNumKeys;
-        typedef std::map<F32, PositionKey> key_map_t;
-        key_map_t       mKeys;
-        PositionKey     mLoopInKey;
-        PositionKey     mLoopOutKey;
+        LLVector3 getValue(F32 time, F32 duration) const;
+        // cursor remembers the key found last time, see JointMotion::KeyCursor
+        LLVector3 getValue(F32 time, F32 duration, U32& cursor) const;
+        LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after) const;
+
+        // keeps the keys sorted, a key at the time of another replaces it
+        void addKey(const PositionKey& key);
+        U32 getKeyCount() const { return (U32)mKeyTimes.size(); }
+        PositionKey getKey(U32 index) const { return PositionKey(mKeyTimes[index], mKeyPositions[index]); }
+
+        InterpolationType       mInterpolationType;
+        S32                     mNumKeys;
+        // sorted by time, one entry per key in each
+        std::vector<F32>        mKeyTimes;
+        std::vector<LLVector3>  mKeyPositions;
+        PositionKey             mLoopInKey;
+        PositionKey             mLoopOutKey;
     };
 
     //-------------------------------------------------------------------------
@@ -380,6 +412,18 @@ public:
     class JointMotion
     {
     public:
+        // Where the last lookup landed in each curve. Curves are shared by
+        // every instance of an animation through LLKeyframeDataCache, so
+        // each LLKeyframeMotion keeps its own cursors. Time mostly moves
+        // forward by less than a key per frame, so the next lookup is
+        // usually the same or the next key.
+        struct KeyCursor
+        {
+            U32 mPosition = 0;
+            U32 mRotation = 0;
+            U32 mScale = 0;
+        };
+
         PositionCurve   mPositionCurve;
         RotationCurve   mRotationCurve;
         ScaleCurve      mScaleCurve;
@@ -387,7 +431,7 @@ public:
         U32             mUsage;
         LLJoint::JointPriority  mPriority;
 
-        void update(LLJointState* joint_state, F32 time, F32 duration);
+        void update(LLJointState* joint_state, F32 time, F32 duration, KeyCursor& cursor) const;
     };
 
     //-------------------------------------------------------------------------
@@ -426,6 +470,7 @@ public:
 protected:
     JointMotionList*                mJointMotionList;
     std::vector<LLPointer<LLJointState> > mJointStates;
+    std::vector<JointMotion::KeyCursor> mKeyCursors;
     LLJoint*                        mPelvisp;
     LLCharacter*                    mCharacter;
     typedef std::list<JointConstraint*> constraint_list_t;
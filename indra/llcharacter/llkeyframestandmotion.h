@@ -66,6 +66,8 @@ public:
     virtual bool onActivate();
     void    onDeactivate();
     virtual bool onUpdate(F32 time, U8* joint_mask);
+    // onUpdate() plants the feet on top of the keyframes
+    virtual bool canDeferPose() { return false; }
 
 public:
     //-------------------------------------------------------------------------
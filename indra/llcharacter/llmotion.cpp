@@ -45,6 +45,7 @@
 LLMotion::LLMotion( const LLUUID &id ) :
     mStopped(true),
     mActive(false),
+    mDeferPose(false),
     mID(id),
     mActivationTimestamp(0.f),
     mStopTimestamp(0.f),
@@ -151,6 +151,14 @@ public:
     // called when a motion is deactivated
     virtual void onDeactivate() = 0;
 
+    // motions that can fill in their joint states separately from the rest
+    // of onUpdate() return true here. When the controller defers the pose,
+    // onUpdate() leaves the joint states alone and evaluatePose() sets them
+    // before blending, possibly on a worker thread: it may only write the
+    // motion's own joint states and read data nothing else changes meanwhile.
+    virtual bool canDeferPose() { return false; }
+    virtual void evaluatePose() {}
+
     // can we crossfade this motion with a new instance when restarted?
     // should ultimately always be true, but lack of emote blending, etc
     // requires this
@@ -171,6 +179,7 @@ protected:
     LLPose      mPose;
     bool        mStopped;       // motion has been stopped;
     bool        mActive;        // motion is on active list (can be stopped or not stopped)
+    bool        mDeferPose;     // set by the controller: leave the joint states to evaluatePose()
 
     //-------------------------------------------------------------------------
     // these are set implicitly by the motion controller and
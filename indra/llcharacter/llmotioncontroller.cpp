@@ -141,6 +141,8 @@ LLMotionController::LLMotionController()
       mTimeStepCount(0),
       mLastInterp(0.f),
       mIsSelf(false),
+      mDeferPose(false),
+      mPosePending(false),
       mLastCountAfterPurge(0)
 {
 }
@@ -169,6 +171,14 @@ void LLMotionController::incMotionCounts(S32& num_motions, S32& num_loading_moti
 //-----------------------------------------------------------------------------
 void LLMotionController::deleteAllMotions()
 {
+    // the character may be half gone already, drop any pose still pending
+    mDeferredPoses.clear();
+    if (mPosePending)
+    {
+        mPoseBlender.clearBlenders();
+        mPosePending = false;
+    }
+
     mLoadingMotions.clear();
     mLoadedMotions.clear();
     mActiveMotions.clear();
@@ -328,6 +338,9 @@ void LLMotionController::removeMotionInstance(LLMotion* motionp)
 {
     if (motionp)
     {
+        // the pending pose may still refer to this motion
+        applyPose();
+
         llassert(findMotion(motionp->getID()) != motionp);
         if (motionp->isActive())
             motionp->deactivate();
@@ -564,6 +577,8 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
     bool update_result = true;
     U8 last_joint_signature[LL_CHARACTER_MAX_ANIMATED_JOINTS];
+    // the time step quantum caches blended poses, see updateMotions()
+    bool defer_pose = mDeferPose && mTimeStep == 0.f;
 
     memset(&last_joint_signature, 0, sizeof(U8) * LL_CHARACTER_MAX_ANIMATED_JOINTS);
 
@@ -649,6 +664,8 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
             motionp->fadeIn();
         }
 
+        motionp->mDeferPose = defer_pose && motionp->canDeferPose();
+
         //**********************
         // MOTION INACTIVE
         //**********************
@@ -762,6 +779,11 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 
         }
 
+        if (motionp->mDeferPose)
+        {
+            mDeferredPoses.push_back(motionp);
+        }
+
         // even if onupdate returns false, add this motion in to the blend one last time
         mPoseBlender.addMotion(motionp);
     }
@@ -821,6 +843,9 @@ void LLMotionController::updateLoadingMotions()
 void LLMotionController::updateMotions(bool force_update)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    // a pose left over from the last update goes first
+    applyPose();
+
     // SL-763: "Distant animated objects run at super fast speed"
     // The use_quantum optimization or possibly the associated code in setTimeStamp()
     // does not work as implemented.
@@ -900,6 +925,10 @@ void LLMotionController::updateMotions(bool force_update)
         {
             mPoseBlender.blendAndCache(true);
         }
+        else if (mDeferPose)
+        {
+            mPosePending = true;
+        }
         else
         {
             mPoseBlender.blendAndApply();
@@ -917,6 +946,8 @@ void LLMotionController::updateMotions(bool force_update)
 void LLMotionController::updateMotionsMinimal()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    applyPose();
+
     // Always update mPrevTimerElapsed
     mPrevTimerElapsed = mTimer.getElapsedTimeF32();
 
@@ -929,6 +960,30 @@ void LLMotionController::updateMotionsMinimal()
     mHasRunOnce = true;
 }
 
+//-----------------------------------------------------------------------------
+// applyPose()
+//-----------------------------------------------------------------------------
+void LLMotionController::applyPose()
+{
+    if (!mPosePending && mDeferredPoses.empty())
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    for (LLMotion* motionp : mDeferredPoses)
+    {
+        motionp->evaluatePose();
+    }
+    mDeferredPoses.clear();
+
+    if (mPosePending)
+    {
+        mPoseBlender.blendAndApply();
+        mPosePending = false;
+    }
+}
+
 //-----------------------------------------------------------------------------
 // activateMotionInstance()
 //-----------------------------------------------------------------------------
@@ -33,6 +33,7 @@
 #include <string>
 #include <map>
 #include <deque>
+#include <vector>
 
 #include "llmotion.h"
 #include "llpose.h"
@@ -135,6 +136,15 @@ public:
     // minimal update (e.g. while hidden)
     void updateMotionsMinimal();
 
+    // deferred pose
+    // with setDeferPose(true), updateMotions() leaves evaluating keyframes
+    // and blending the pose to applyPose(). applyPose() only touches this
+    // character's motions and joints, so characters can apply their poses on
+    // worker threads, one thread per character, while nothing else runs.
+    void setDeferPose(bool defer) { mDeferPose = defer; }
+    bool hasPendingPose() const { return mPosePending; }
+    void applyPose();
+
     void clearBlenders() { mPoseBlender.clearBlenders(); }
 
     // flush motions
@@ -232,6 +242,10 @@ protected:
     F32                 mLastInterp;
 
     U8                  mJointSignature[2][LL_CHARACTER_MAX_ANIMATED_JOINTS];
+
+    bool                mDeferPose;
+    bool                mPosePending;
+    std::vector<LLMotion*> mDeferredPoses; // updated motions waiting for evaluatePose()
 private:
     U32                 mLastCountAfterPurge; //for logging and debugging purposes
 };
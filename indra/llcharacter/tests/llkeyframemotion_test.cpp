@@ -0,0 +1,254 @@
+/**
+ * @file llkeyframemotion_test.cpp
+ * @brief Keyframe curve tests and N avatars x M animations evaluation benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llkeyframemotion.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+
+namespace
+{
+    typedef LLKeyframeMotion::RotationCurve RotationCurve;
+    typedef LLKeyframeMotion::PositionCurve PositionCurve;
+    typedef LLKeyframeMotion::RotationKey RotationKey;
+    typedef LLKeyframeMotion::PositionKey PositionKey;
+
+    // The std::map lookup the curves used to do
+    template <typename VALUE, typename INTERP>
+    VALUE map_value(const std::map<F32, VALUE>& keys, F32 time, INTERP&& interp)
+    {
+        auto right = keys.lower_bound(time);
+        if (right == keys.end())
+        {
+            return (--right)->second;
+        }
+        if (right == keys.begin() || right->first == time)
+        {
+            return right->second;
+        }
+        auto left = right;
+        --left;
+        F32 u = (time - left->first) / (right->first - left->first);
+        return interp(u, left->second, right->second);
+    }
+
+    LLQuaternion map_rotation(const std::map<F32, LLQuaternion>& keys, F32 time)
+    {
+        return map_value(keys, time, [](F32 u, const LLQuaternion& a, const LLQuaternion& b) { return nlerp(u, a, b); });
+    }
+
+    LLVector3 map_position(const std::map<F32, LLVector3>& keys, F32 time)
+    {
+        return map_value(keys, time, [](F32 u, const LLVector3& a, const LLVector3& b) { return lerp(a, b, u); });
+    }
+
+    struct Random
+    {
+        U32 mSeed;
+        U32 next() { mSeed = mSeed * 1664525 + 1013904223; return mSeed >> 8; }
+        F32 unit() { return (F32)(next() & 0xffff) / 65535.f; }
+    };
+
+    // A joint track like an uploaded animation: roughly 30 keys a second,
+    // mostly small rotations from one key to the next
+    struct Track
+    {
+        RotationCurve mRotation;
+        PositionCurve mPosition;
+        std::map<F32, LLQuaternion> mRotationMap;
+        std::map<F32, LLVector3> mPositionMap;
+    };
+
+    void makeTrack(Track& track, F32 duration, Random& random)
+    {
+        LLVector3 axis(random.unit() - 0.5f, random.unit() - 0.5f, random.unit() + 0.1f);
+        axis.normVec();
+        F32 angle = 0.f;
+        for (F32 time = 0.f; time <= duration; time += 1.f / 30.f)
+        {
+            angle += (random.unit() - 0.3f) * 0.2f;
+            LLQuaternion rotation(angle, axis);
+            LLVector3 position(random.unit(), random.unit(), random.unit());
+            // every so often a flip to the other hemisphere, which takes the slerp path
+            if (random.next() % 50 == 0)
+            {
+                rotation = -1.f * rotation;
+            }
+            track.mRotation.addKey(RotationKey(time, rotation));
+            track.mPosition.addKey(PositionKey(time, position));
+            track.mRotationMap[time] = rotation;
+            track.mPositionMap[time] = position;
+        }
+    }
+
+    bool close_enough(const LLQuaternion& a, const LLQuaternion& b)
+    {
+        for (S32 i = 0; i < 4; ++i)
+        {
+            if (fabsf(a.mQ[i] - b.mQ[i]) > 1e-5f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace tut
+{
+    struct keyframemotion_data
+    {
+    };
+    typedef test_group<keyframemotion_data> keyframemotion_test;
+    typedef keyframemotion_test::object keyframemotion_object;
+    tut::keyframemotion_test keyframemotion_testcase("LLKeyframeMotion");
+
+    template<> template<>
+    void keyframemotion_object::test<1>()
+    {
+        set_test_name("keys are sorted, a repeated time replaces the key");
+        PositionCurve curve;
+        curve.addKey(PositionKey(0.5f, LLVector3(5.f, 0.f, 0.f)));
+        curve.addKey(PositionKey(0.f, LLVector3(0.f, 0.f, 0.f)));
+        curve.addKey(PositionKey(1.f, LLVector3(10.f, 0.f, 0.f)));
+        curve.addKey(PositionKey(0.5f, LLVector3(6.f, 0.f, 0.f)));
+        ensure_equals("duplicate removed", curve.getKeyCount(), 3u);
+        ensure_equals("sorted", curve.getKey(1).mTime, 0.5f);
+        ensure_equals("last one wins", curve.getKey(1).mPosition.mV[VX], 6.f);
+
+        ensure_equals("before first key", curve.getValue(-1.f, 1.f).mV[VX], 0.f);
+        ensure_equals("on a key", curve.getValue(0.5f, 1.f).mV[VX], 6.f);
+        ensure_equals("between keys", curve.getValue(0.75f, 1.f).mV[VX], 8.f);
+        ensure_equals("past last key", curve.getValue(2.f, 1.f).mV[VX], 10.f);
+
+        PositionCurve empty;
+        ensure("no keys", empty.getValue(0.5f, 1.f).isExactlyZero());
+        ensure("no rotation keys", RotationCurve().getValue(0.5f, 1.f) == LLQuaternion::DEFAULT);
+    }
+
+    template<> template<>
+    void keyframemotion_object::test<2>()
+    {
+        set_test_name("cursor lookups match the map lookups, looping included");
+        Random random{ 7 };
+        Track track;
+        makeTrack(track, 4.f, random);
+
+        U32 rotation_cursor = 0;
+        U32 position_cursor = 0;
+        F32 time = 0.f;
+        for (S32 frame = 0; frame < 2000; ++frame)
+        {
+            // uneven frame times, sometimes several keys at once, and a
+            // loop back from time to time
+            time += random.unit() * (random.next() % 10 ? 0.03f : 0.3f);
+            if (time > 4.5f)
+            {
+                time = random.unit();
+            }
+            F32 sample = (random.next() % 20) ? time : track.mRotation.getKey(random.next() % track.mRotation.getKeyCount()).mTime;
+
+            LLQuaternion rotation = track.mRotation.getValue(sample, 4.f, rotation_cursor);
+            ensure("rotation", close_enough(rotation, map_rotation(track.mRotationMap, sample)));
+            ensure("no cursor", close_enough(rotation, track.mRotation.getValue(sample, 4.f)));
+
+            LLVector3 position = track.mPosition.getValue(sample, 4.f, position_cursor);
+            ensure("position", position == map_position(track.mPositionMap, sample));
+        }
+    }
+
+    template<> template<>
+    void keyframemotion_object::test<3>()
+    {
+        set_test_name("60 avatars x 6 animations x 30 joints");
+
+        skip_unless_benchmarks();
+        constexpr S32 AVATARS = 60;
+        constexpr S32 ANIMATIONS = 6;
+        constexpr S32 JOINTS = 30;
+        constexpr S32 FRAMES = 120;
+        constexpr F32 DURATION = 5.f;
+
+        // animations are shared by the avatars playing them, like
+        // LLKeyframeDataCache does
+        Random random{ 11 };
+        std::vector<Track> tracks(ANIMATIONS * JOINTS);
+        for (Track& track : tracks)
+        {
+            makeTrack(track, DURATION, random);
+        }
+        std::vector<F32> start(AVATARS * ANIMATIONS);
+        for (F32& offset : start)
+        {
+            offset = random.unit() * DURATION;
+        }
+        std::vector<LLKeyframeMotion::JointMotion::KeyCursor> cursors(AVATARS * ANIMATIONS * JOINTS);
+
+        auto run = [&](auto&& evaluate)
+        {
+            F32 checksum = 0.f;
+            auto begin = std::chrono::steady_clock::now();
+            for (S32 frame = 0; frame < FRAMES; ++frame)
+            {
+                for (S32 motion = 0; motion < AVATARS * ANIMATIONS; ++motion)
+                {
+                    F32 time = fmodf(start[motion] + frame / 60.f, DURATION);
+                    for (S32 joint = 0; joint < JOINTS; ++joint)
+                    {
+                        checksum += evaluate(motion, joint, time);
+                    }
+                }
+            }
+            F64 ms = std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            return std::make_pair(ms / FRAMES, checksum);
+        };
+
+        auto map = run([&](S32 motion, S32 joint, F32 time)
+            {
+                const Track& track = tracks[(motion % ANIMATIONS) * JOINTS + joint];
+                return map_rotation(track.mRotationMap, time).mQ[VW] + map_position(track.mPositionMap, time).mV[VX];
+            });
+        auto flat = run([&](S32 motion, S32 joint, F32 time)
+            {
+                const Track& track = tracks[(motion % ANIMATIONS) * JOINTS + joint];
+                auto& cursor = cursors[motion * JOINTS + joint];
+                return track.mRotation.getValue(time, DURATION, cursor.mRotation).mQ[VW]
+                     + track.mPosition.getValue(time, DURATION, cursor.mPosition).mV[VX];
+            });
+
+        std::cout << "\nKeyframe evaluation, " << AVATARS << " avatars x " << ANIMATIONS << " animations x "
+                  << JOINTS << " joints per frame:"
+                  << "\n  std::map curves:       " << map.first << " ms"
+                  << "\n  flat curves + cursor:  " << flat.first << " ms" << std::endl;
+        ensure("same animation", fabsf(map.second - flat.second) <= 1e-3f * fabsf(map.second));
+    }
+}
@@ -0,0 +1,304 @@
+/**
+ * @file llmappedfile.cpp
+ * @brief Cross platform read/write memory mapping of a disk file.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmappedfile.h"
+#include "llstring.h"
+#include "llerror.h"
+
+#if LL_WINDOWS
+#include "llwin32headers.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+LLMappedFile::LLMappedFile()
+:   mMode(READ_ONLY),
+    mSize(0),
+    mAddress(nullptr),
+    mIsOpen(false)
+#if LL_WINDOWS
+    , mFileHandle(INVALID_HANDLE_VALUE),
+    mMappingHandle(nullptr)
+#else
+    , mFD(-1)
+#endif
+{
+}
+
+LLMappedFile::~LLMappedFile()
+{
+    close();
+}
+
+bool LLMappedFile::open(const std::string& filename, EMode mode, size_t min_size, bool exclusive)
+{
+    close();
+
+    mFilename = filename;
+    mMode = mode;
+
+#if LL_WINDOWS
+    llutf16string utf16filename = utf8str_to_utf16str(filename);
+    DWORD access = (mode == READ_WRITE) ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+    DWORD disposition = (mode == READ_WRITE) ? OPEN_ALWAYS : OPEN_EXISTING;
+    DWORD share = exclusive ? 0 : (FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE);
+    HANDLE file = CreateFileW(utf16filename.c_str(), access, share,
+                              nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        LL_DEBUGS("MappedFile") << "Unable to open " << filename << " error " << GetLastError() << LL_ENDL;
+        return false;
+    }
+    mFileHandle = file;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+    {
+        close();
+        return false;
+    }
+    mSize = (size_t)file_size.QuadPart;
+#else
+    int flags = (mode == READ_WRITE) ? (O_RDWR | O_CREAT) : O_RDONLY;
+    mFD = ::open(filename.c_str(), flags, 0600);
+    if (mFD < 0)
+    {
+        LL_DEBUGS("MappedFile") << "Unable to open " << filename << ": " << strerror(errno) << LL_ENDL;
+        return false;
+    }
+
+    if (exclusive && flock(mFD, LOCK_EX | LOCK_NB) != 0)
+    {
+        LL_DEBUGS("MappedFile") << "Unable to lock " << filename << ": " << strerror(errno) << LL_ENDL;
+        close();
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(mFD, &file_stat) != 0)
+    {
+        close();
+        return false;
+    }
+    mSize = (size_t)file_stat.st_size;
+#endif
+
+    mIsOpen = true;
+
+    if (mode == READ_WRITE && mSize < min_size)
+    {
+        return resize(min_size);
+    }
+
+    if (!map())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LLMappedFile::close()
+{
+    unmap();
+#if LL_WINDOWS
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle((HANDLE)mFileHandle);
+        mFileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (mFD >= 0)
+    {
+        ::close(mFD);
+        mFD = -1;
+    }
+#endif
+    mSize = 0;
+    mIsOpen = false;
+}
+
+bool LLMappedFile::resize(size_t new_size)
+{
+    if (!mIsOpen || mMode != READ_WRITE)
+    {
+        return false;
+    }
+
+    unmap();
+
+#if LL_WINDOWS
+    LARGE_INTEGER pos;
+    pos.QuadPart = (LONGLONG)new_size;
+    if (!SetFilePointerEx((HANDLE)mFileHandle, pos, nullptr, FILE_BEGIN) || !SetEndOfFile((HANDLE)mFileHandle))
+    {
+        LL_WARNS("MappedFile") << "Unable to resize " << mFilename << " to " << new_size << " error " << GetLastError() << LL_ENDL;
+        close();
+        return false;
+    }
+#else
+    // A plain ftruncate() grow is sparse: on a full disk the first store
+    // to a new page raises SIGBUS instead of failing here. Allocate the
+    // new blocks up front.
+    int error = 0;
+    if (new_size > mSize)
+    {
+        error = allocate(mSize, new_size);
+    }
+    if (!error && ftruncate(mFD, (off_t)new_size) != 0)
+    {
+        error = errno;
+    }
+    if (error)
+    {
+        LL_WARNS("MappedFile") << "Unable to resize " << mFilename << " to " << new_size << ": " << strerror(error) << LL_ENDL;
+        // give back what was allocated of the extension
+        if (new_size > mSize && ftruncate(mFD, (off_t)mSize) != 0)
+        {
+            LL_WARNS("MappedFile") << "Unable to truncate " << mFilename << " back to " << mSize << LL_ENDL;
+        }
+        close();
+        return false;
+    }
+#endif
+
+    mSize = new_size;
+    if (!map())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+#if !LL_WINDOWS
+int LLMappedFile::allocate(size_t from, size_t to)
+{
+#if LL_LINUX
+    int error = posix_fallocate(mFD, (off_t)from, (off_t)(to - from));
+    if (error != EOPNOTSUPP && error != EINVAL)
+    {
+        return error;
+    }
+    // filesystem without fallocate, write the zeros ourselves
+#endif
+    static const char zeros[65536] = {};
+    while (from < to)
+    {
+        size_t chunk = llmin(to - from, sizeof(zeros));
+        ssize_t written = pwrite(mFD, zeros, chunk, (off_t)from);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno;
+        }
+        from += (size_t)written;
+    }
+    return 0;
+}
+#endif
+
+bool LLMappedFile::flush()
+{
+    if (!mAddress || mMode != READ_WRITE)
+    {
+        return true;
+    }
+#if LL_WINDOWS
+    return FlushViewOfFile(mAddress, 0) != 0;
+#else
+    return msync(mAddress, mSize, MS_ASYNC) == 0;
+#endif
+}
+
+bool LLMappedFile::map()
+{
+    if (mSize == 0)
+    {
+        // Nothing to map, but an empty file is still a valid mapping.
+        return true;
+    }
+
+#if LL_WINDOWS
+    DWORD protect = (mMode == READ_WRITE) ? PAGE_READWRITE : PAGE_READONLY;
+    DWORD access = (mMode == READ_WRITE) ? FILE_MAP_WRITE : FILE_MAP_READ;
+    mMappingHandle = CreateFileMappingW((HANDLE)mFileHandle, nullptr, protect, 0, 0, nullptr);
+    if (!mMappingHandle)
+    {
+        LL_WARNS("MappedFile") << "CreateFileMapping failed for " << mFilename << " error " << GetLastError() << LL_ENDL;
+        return false;
+    }
+    mAddress = MapViewOfFile((HANDLE)mMappingHandle, access, 0, 0, mSize);
+    if (!mAddress)
+    {
+        LL_WARNS("MappedFile") << "MapViewOfFile failed for " << mFilename << " error " << GetLastError() << LL_ENDL;
+        CloseHandle((HANDLE)mMappingHandle);
+        mMappingHandle = nullptr;
+        return false;
+    }
+#else
+    int prot = (mMode == READ_WRITE) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* address = ::mmap(nullptr, mSize, prot, MAP_SHARED, mFD, 0);
+    if (address == MAP_FAILED)
+    {
+        LL_WARNS("MappedFile") << "mmap failed for " << mFilename << ": " << strerror(errno) << LL_ENDL;
+        return false;
+    }
+    mAddress = address;
+#endif
+    return true;
+}
+
+void LLMappedFile::unmap()
+{
+#if LL_WINDOWS
+    if (mAddress)
+    {
+        UnmapViewOfFile(mAddress);
+    }
+    if (mMappingHandle)
+    {
+        CloseHandle((HANDLE)mMappingHandle);
+        mMappingHandle = nullptr;
+    }
+#else
+    if (mAddress)
+    {
+        ::munmap(mAddress, mSize);
+    }
+#endif
+    mAddress = nullptr;
+}
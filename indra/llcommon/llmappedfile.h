@@ -0,0 +1,113 @@
+/**
+ * @file llmappedfile.h
+ * @brief Cross platform read/write memory mapping of a disk file.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMAPPEDFILE_H
+#define LL_LLMAPPEDFILE_H
+
+#include <string>
+
+/**
+ * @class LLMappedFile
+ * @brief Maps a whole file into the address space of the process.
+ *
+ * The mapping is shared with the file, so writes to data() end up on
+ * disk without any explicit write call; flush() only forces the OS to
+ * do so now. The file can be grown with resize(), which remaps it: any
+ * pointer obtained from data() before a resize() is invalid afterwards.
+ *
+ * This class is not thread safe. Callers sharing a mapping between
+ * threads must provide their own locking.
+ */
+class LL_COMMON_API LLMappedFile
+{
+public:
+    enum EMode
+    {
+        READ_ONLY,
+        READ_WRITE     // creates the file if it does not exist
+    };
+
+    LLMappedFile();
+    ~LLMappedFile();
+
+    LLMappedFile(const LLMappedFile&) = delete;
+    LLMappedFile& operator=(const LLMappedFile&) = delete;
+
+    /**
+     * Open and map filename. In READ_WRITE mode the file is created if
+     * needed and, when it is smaller than min_size bytes, extended (zero
+     * filled) to min_size first. With exclusive set, opening fails if
+     * another process already holds the file exclusively (Windows share
+     * mode / advisory flock elsewhere). Returns false if the file could
+     * not be opened or mapped; a zero length file opened READ_ONLY is a
+     * valid, empty mapping.
+     */
+    bool open(const std::string& filename, EMode mode, size_t min_size = 0, bool exclusive = false);
+    void close();
+
+    /**
+     * Grow or shrink the underlying file and remap it. Only valid for
+     * READ_WRITE mappings. Growing allocates the disk space, so a full
+     * disk fails here rather than on a later write to data(). Returns
+     * false (and leaves the file closed) on failure.
+     */
+    bool resize(size_t new_size);
+
+    /// Ask the OS to write dirty pages back to disk.
+    bool flush();
+
+    bool isOpen() const         { return mIsOpen; }
+    bool isWritable() const     { return mMode == READ_WRITE; }
+    size_t size() const         { return mSize; }
+    const std::string& getFilename() const { return mFilename; }
+
+    U8* data()                  { return (U8*)mAddress; }
+    const U8* data() const      { return (const U8*)mAddress; }
+
+private:
+    bool map();
+    void unmap();
+#if !LL_WINDOWS
+    // Backs [from, to) of the file with real blocks, returns an errno
+    int allocate(size_t from, size_t to);
+#endif
+
+private:
+    std::string mFilename;
+    EMode       mMode;
+    size_t      mSize;
+    void*       mAddress;
+    bool        mIsOpen;
+#if LL_WINDOWS
+    void*       mFileHandle;
+    void*       mMappingHandle;
+#else
+    int         mFD;
+#endif
+};
+
+#endif // LL_LLMAPPEDFILE_H
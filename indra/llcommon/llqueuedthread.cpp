@@ -27,6 +27,7 @@
 #include "llqueuedthread.h"
 
 #include <chrono>
+#include <limits>
 
 #include "llstl.h"
 #include "lltimer.h"    // ms_sleep()
@@ -246,11 +247,32 @@ bool LLQueuedThread::addRequest(QueuedRequest* req)
     unlockData();
 
     llassert(!mDataLock->isSelfLocked());
-    mRequestQueue.post([this, req]() { processRequest(req); });
+    postRequest(req);
 
     return true;
 }
 
+void LLQueuedThread::postRequest(QueuedRequest* req)
+{
+    // A request waiting out its retry backoff goes behind everything else,
+    // so it doesn't keep coming back to the front while it can't run. It is
+    // queued without its handle, so updatePriority() can't raise it again.
+    if (req->mDeferUntil > LL::WorkQueue::TimePoint::clock::now())
+    {
+        mRequestQueue.post([this, req]() { processRequest(req); }, std::numeric_limits<F32>::lowest(), LL::WorkPriorityQueue::NO_KEY);
+        return;
+    }
+    mRequestQueue.post([this, req]() { processRequest(req); }, req->getPriority(), req->getHashKey());
+}
+
+void LLQueuedThread::updatePriority(handle_t handle, F32 priority)
+{
+    if (handle != nullHandle())
+    {
+        mRequestQueue.updatePriority(handle, priority);
+    }
+}
+
 // MAIN thread
 bool LLQueuedThread::waitForResult(LLQueuedThread::handle_t handle, bool auto_complete)
 {
@@ -432,7 +454,9 @@ void LLQueuedThread::processRequest(LLQueuedThread::QueuedRequest* req)
             using namespace std::chrono_literals;
 
             const auto throttle_time = 2ms;
-            if (req->mDeferUntil > LL::WorkQueue::TimePoint::clock::now())
+            // only when there is nothing else to do, deferred requests are
+            // queued behind everything else
+            if (req->mDeferUntil > LL::WorkQueue::TimePoint::clock::now() && mRequestQueue.size() == 0)
             {
                 ms_sleep((U32)throttle_time.count());
             }
@@ -443,7 +467,7 @@ void LLQueuedThread::processRequest(LLQueuedThread::QueuedRequest* req)
 
                 lockData();
                 req->setStatus(STATUS_QUEUED);
-                mRequestQueue.post([this, req]() { processRequest(req); });
+                postRequest(req);
                 unlockData();
                 mIdleThread = true;
                 return;
@@ -515,7 +539,7 @@ void LLQueuedThread::processRequest(LLQueuedThread::QueuedRequest* req)
                 auto retry_time = LL::WorkQueue::TimePoint::clock::now() + retry_backoff; 
                 req->defer_until(retry_time);
                 LL_PROFILE_ZONE_NAMED("processRequest - post deferred");
-                mRequestQueue.post([this, req]() { processRequest(req); });
+                postRequest(req);
                 // </FS:Beq>
 #endif
 
@@ -84,6 +84,11 @@ public:
         {
             return mFlags;
         }
+        // Higher runs first. Read whenever the request is (re)queued.
+        virtual F32 getPriority() const
+        {
+            return 0.f;
+        }
 
     protected:
         status_t setStatus(status_t newstatus)
@@ -136,6 +141,7 @@ private:
 protected:
     handle_t generateHandle();
     bool addRequest(QueuedRequest* req);
+    void postRequest(QueuedRequest* req);
     void processRequest(QueuedRequest* req);
     void incQueue();
 
@@ -155,6 +161,12 @@ public:
     status_t getRequestStatus(handle_t handle);
     void abortRequest(handle_t handle, bool autocomplete);
     void setFlags(handle_t handle, U32 flags);
+    // Move a queued request according to its new priority. Only touches the
+    // queue, not the request, so the request's getPriority() must already
+    // return the new value for a requeue to keep it. Safe to call with any
+    // lock held, no-op if the request is not queued right now or is
+    // deferred.
+    void updatePriority(handle_t handle, F32 priority);
     bool completeRequest(handle_t handle);
     // This is public for support classes like LLWorkerThread,
     // but generally the methods above should be used.
@@ -170,7 +182,9 @@ protected:
 
     //typedef std::set<QueuedRequest*, queued_request_less> request_queue_t;
     //request_queue_t mRequestQueue;
-    LL::WorkQueue mRequestQueue;
+    // Requests are keyed by handle, work posted without a priority (like
+    // the per frame threadedUpdate()) runs ahead of them.
+    LL::WorkPriorityQueue mRequestQueue;
     LL::WorkQueue::weak_t mMainQueue;
 
     enum { REQUEST_HASH_SIZE = 512 }; // must be power of 2
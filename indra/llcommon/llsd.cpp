@@ -34,6 +34,7 @@
 #include "llerror.h"
 #include "../llmath/llmath.h"
 #include "llformat.h"
+#include "llsdarena.h"
 #include "llsdserialize.h"
 #include "stringize.h"
 
@@ -101,8 +102,18 @@ protected:
     bool shared() const                         { return (mUseCount > 1) && (mUseCount != STATIC_USAGE_COUNT); }
 
     U32 mUseCount;
+    U32 mArenaOffset;
+        ///< offset of this object in its LLSDArena chunk, 0 when it was
+        //   allocated on the heap
 
 public:
+    template<class ImplType, typename... Args>
+    static ImplType* create(Args&&... args);
+        ///< allocate a new Impl from the current LLSDArena, if any, or
+        //   from the heap
+    static void destroy(Impl* impl);
+        ///< counterpart of create()
+
     static void reset(Impl*& var, Impl* impl);
         ///< safely set var to refer to the new impl (possibly shared)
 
@@ -188,6 +199,37 @@ public:
     static U32 sOutstandingCount;
 };
 
+template<class ImplType, typename... Args>
+ImplType* LLSD::Impl::create(Args&&... args)
+{
+    U32 offset = 0;
+    void* memory = LLSDArena::allocate(sizeof(ImplType), offset);
+    if (!memory)
+    {
+        memory = ::operator new(sizeof(ImplType));
+        offset = 0;
+    }
+    ImplType* impl;
+    try
+    {
+        impl = new (memory) ImplType(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        if (offset)
+        {
+            LLSDArena::free(memory, offset);
+        }
+        else
+        {
+            ::operator delete(memory);
+        }
+        throw;
+    }
+    impl->mArenaOffset = offset;
+    return impl;
+}
+
 #ifdef NAME_UNNAMED_NAMESPACE
 namespace LLSDUnnamedNamespace
 #else
@@ -436,6 +478,7 @@ namespace
         DataMap mData;
 
     protected:
+        friend class LLSD::Impl;
         ImplMap(const DataMap& data) : mData(data) { }
 
     public:
@@ -488,7 +531,7 @@ namespace
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
         if (shared())
         {
-            ImplMap* i = new ImplMap(mData);
+            ImplMap* i = create<ImplMap>(mData);
             Impl::assign(var, i);
             return *i;
         }
@@ -528,7 +571,17 @@ namespace
     void ImplMap::insert(std::string_view k, const LLSD& v)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-        mData.emplace(k, v);
+        // Serialized maps come out of our own formatters in key order, so
+        // when parsing, new keys nearly always go at the end: skip the
+        // tree search for those.
+        if (mData.empty() || mData.key_comp()(mData.rbegin()->first, k))
+        {
+            mData.emplace_hint(mData.end(), k, v);
+        }
+        else
+        {
+            mData.emplace(k, v);
+        }
     }
 
     void ImplMap::erase(const LLSD::String& k)
@@ -539,6 +592,11 @@ namespace
 
     LLSD& ImplMap::ref(std::string_view k)
     {
+        if (mData.empty() || mData.key_comp()(mData.rbegin()->first, k))
+        {
+            return mData.emplace_hint(mData.end(), k, LLSD())->second;
+        }
+
         DataMap::iterator i = mData.lower_bound(k);
         if (i == mData.end() || mData.key_comp()(k, i->first))
         {
@@ -595,6 +653,7 @@ namespace
         DataVector mData;
 
     protected:
+        friend class LLSD::Impl;
         ImplArray(const DataVector& data) : mData(data) { }
 
     public:
@@ -644,7 +703,7 @@ namespace
     {
         if (shared())
         {
-            ImplArray* i = new ImplArray(mData);
+            ImplArray* i = create<ImplArray>(mData);
             Impl::assign(var, i);
             return *i;
         }
@@ -747,17 +806,31 @@ namespace
 }
 
 LLSD::Impl::Impl()
-    : mUseCount(0)
+    : mUseCount(0), mArenaOffset(0)
 {
     ++sAllocationCount;
     ++sOutstandingCount;
 }
 
 LLSD::Impl::Impl(StaticAllocationMarker)
-    : mUseCount(0)
+    : mUseCount(0), mArenaOffset(0)
 {
 }
 
+void LLSD::Impl::destroy(Impl* impl)
+{
+    U32 offset = impl->mArenaOffset;
+    impl->~Impl();
+    if (offset)
+    {
+        LLSDArena::free(impl, offset);
+    }
+    else
+    {
+        ::operator delete(impl);
+    }
+}
+
 LLSD::Impl::~Impl()
 {
     --sOutstandingCount;
@@ -771,7 +844,7 @@ void LLSD::Impl::reset(Impl*& var, Impl* impl)
     }
     if (var  &&  var->mUseCount != STATIC_USAGE_COUNT && --var->mUseCount == 0)
     {
-        delete var;
+        destroy(var);
     }
     var = impl;
 }
@@ -780,7 +853,7 @@ void LLSD::Impl::move(Impl*& var, Impl*& impl)
 {
     if (var && var->mUseCount != STATIC_USAGE_COUNT && --var->mUseCount == 0)
     {
-        delete var; // destroy var if usage falls to 0 and not static
+        destroy(var); // destroy var if usage falls to 0 and not static
     }
     var = impl; // Steal impl to var without incrementing use since this is a move
     impl = nullptr; // null out old-impl pointer
@@ -801,14 +874,14 @@ const LLSD::Impl& LLSD::Impl::safe(const Impl* impl)
 ImplMap& LLSD::Impl::makeMap(Impl*& var)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-    ImplMap* im = new ImplMap;
+    ImplMap* im = create<ImplMap>();
     reset(var, im);
     return *im;
 }
 
 ImplArray& LLSD::Impl::makeArray(Impl*& var)
 {
-    ImplArray* ia = new ImplArray;
+    ImplArray* ia = create<ImplArray>();
     reset(var, ia);
     return *ia;
 }
@@ -826,72 +899,72 @@ void LLSD::Impl::assignUndefined(Impl*& var)
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Boolean v)
 {
-    reset(var, new ImplBoolean(v));
+    reset(var, create<ImplBoolean>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Integer v)
 {
-    reset(var, new ImplInteger(v));
+    reset(var, create<ImplInteger>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Real v)
 {
-    reset(var, new ImplReal(v));
+    reset(var, create<ImplReal>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const char* v)
 {
-    reset(var, new ImplString(v));
+    reset(var, create<ImplString>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::String& v)
 {
-    reset(var, new ImplString(v));
+    reset(var, create<ImplString>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::UUID& v)
 {
-    reset(var, new ImplUUID(v));
+    reset(var, create<ImplUUID>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::Date& v)
 {
-    reset(var, new ImplDate(v));
+    reset(var, create<ImplDate>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::URI& v)
 {
-    reset(var, new ImplURI(v));
+    reset(var, create<ImplURI>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, const LLSD::Binary& v)
 {
-    reset(var, new ImplBinary(v));
+    reset(var, create<ImplBinary>(v));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::String&& v)
 {
-    reset(var, new ImplString(std::move(v)));
+    reset(var, create<ImplString>(std::move(v)));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::UUID&& v)
 {
-    reset(var, new ImplUUID(std::move(v)));
+    reset(var, create<ImplUUID>(std::move(v)));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Date&& v)
 {
-    reset(var, new ImplDate(std::move(v)));
+    reset(var, create<ImplDate>(std::move(v)));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::URI&& v)
 {
-    reset(var, new ImplURI(std::move(v)));
+    reset(var, create<ImplURI>(std::move(v)));
 }
 
 void LLSD::Impl::assign(Impl*& var, LLSD::Binary&& v)
 {
-    reset(var, new ImplBinary(std::move(v)));
+    reset(var, create<ImplBinary>(std::move(v)));
 }
 
 
@@ -0,0 +1,166 @@
+/**
+ * @file llsdarena.cpp
+ * @brief Chunked bump allocator for LLSD nodes built by bulk parses.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llsdarena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // Small documents should not pay for a big chunk, large ones should
+    // not go back to the heap every few hundred nodes.
+    constexpr size_t FIRST_CHUNK_SIZE = 4 * 1024;
+    constexpr size_t MAX_CHUNK_SIZE = 64 * 1024;
+    constexpr size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+
+    constexpr size_t align_up(size_t size)
+    {
+        return (size + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1);
+    }
+
+    thread_local LLSDArena* sCurrentArena = nullptr;
+    std::atomic<S32> sChunkCount{ 0 };
+}
+
+struct alignas(std::max_align_t) LLSDArena::Chunk
+{
+    // One reference per live block, plus one held by the arena while it
+    // still allocates from this chunk.
+    std::atomic<S32> mLive;
+};
+
+//---------------------------------------------------------------------------
+// LLSDArena::Scope
+//---------------------------------------------------------------------------
+LLSDArena::Scope::Scope()
+:   mPrevious(sCurrentArena),
+    mArena(new LLSDArena)
+{
+    sCurrentArena = mArena;
+}
+
+LLSDArena::Scope::~Scope()
+{
+    llassert(sCurrentArena == mArena);
+    sCurrentArena = mPrevious;
+    delete mArena;
+}
+
+//---------------------------------------------------------------------------
+// LLSDArena
+//---------------------------------------------------------------------------
+LLSDArena::LLSDArena()
+:   mChunk(nullptr),
+    mCursor(nullptr),
+    mEnd(nullptr),
+    mNextChunkSize(FIRST_CHUNK_SIZE)
+{
+}
+
+LLSDArena::~LLSDArena()
+{
+    retireChunk();
+}
+
+// static
+void* LLSDArena::allocate(size_t size, U32& offset)
+{
+    LLSDArena* arena = sCurrentArena;
+    if (!arena || align_up(size) > MAX_CHUNK_SIZE - sizeof(Chunk))
+    {
+        return nullptr;
+    }
+    return arena->allocateBlock(align_up(size), offset);
+}
+
+// static
+void LLSDArena::free(void* ptr, U32 offset)
+{
+    Chunk* chunk = (Chunk*)((char*)ptr - offset);
+    if (chunk->mLive.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        chunk->~Chunk();
+        ::operator delete(chunk);
+        --sChunkCount;
+    }
+}
+
+// static
+bool LLSDArena::active()
+{
+    return sCurrentArena != nullptr;
+}
+
+// static
+S32 LLSDArena::getChunkCount()
+{
+    return sChunkCount.load();
+}
+
+void* LLSDArena::allocateBlock(size_t size, U32& offset)
+{
+    if (!mChunk || (size_t)(mEnd - mCursor) < size)
+    {
+        retireChunk();
+
+        // a block larger than the next chunk gets a chunk of its own size
+        size_t chunk_size = std::max(mNextChunkSize, size + sizeof(Chunk));
+        mNextChunkSize = std::min(mNextChunkSize * 2, MAX_CHUNK_SIZE);
+
+        void* memory = ::operator new(chunk_size, std::nothrow);
+        if (!memory)
+        {
+            return nullptr;
+        }
+        ++sChunkCount;
+        mChunk = new (memory) Chunk{ 1 };
+        mCursor = (char*)memory + sizeof(Chunk);
+        mEnd = (char*)memory + chunk_size;
+    }
+
+    void* block = mCursor;
+    offset = (U32)(mCursor - (char*)mChunk);
+    mCursor += size;
+    mChunk->mLive.fetch_add(1, std::memory_order_relaxed);
+    return block;
+}
+
+void LLSDArena::retireChunk()
+{
+    if (mChunk)
+    {
+        // Drop the arena's own reference; the chunk is freed here or by
+        // the last free() of one of its blocks.
+        free((char*)mChunk + sizeof(Chunk), sizeof(Chunk));
+        mChunk = nullptr;
+        mCursor = mEnd = nullptr;
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * @file llsdarena.h
+ * @brief Chunked bump allocator for LLSD nodes built by bulk parses.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSDARENA_H
+#define LL_LLSDARENA_H
+
+/**
+ * @class LLSDArena
+ * @brief Monotonic allocation of LLSD value nodes while a document is built.
+ *
+ * While an LLSDArena::Scope is alive on a thread, every LLSD value
+ * created on that thread gets its node from a chunk owned by the scope
+ * instead of from the heap. Allocation is a pointer bump and freeing a
+ * node only decrements the live count of its chunk; a chunk goes back
+ * to the heap once the scope has moved past it and its last node died.
+ *
+ * Nodes stay ordinary LLSD values: they can be copied, modified, kept
+ * after the scope ends and released on any thread. The price is that a
+ * single long lived value keeps its whole chunk allocated, so only open
+ * a scope around building a document that is consumed and dropped as a
+ * whole (a parse of a capability or AIS response, say), not around code
+ * that keeps a few values out of a large tree for the rest of the
+ * session.
+ *
+ * Strings, binaries and the map and array containers inside a node are
+ * still allocated normally.
+ */
+class LL_COMMON_API LLSDArena
+{
+public:
+    class LL_COMMON_API Scope
+    {
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        LLSDArena* mPrevious;
+        LLSDArena* mArena;
+    };
+
+    /**
+     * Allocate size bytes from the arena of the innermost scope on this
+     * thread. Returns nullptr when there is no scope or size is too big
+     * for a chunk; the caller then uses the heap. On success offset is
+     * set to the (never zero) distance of the block from the start of
+     * its chunk, which is what free() needs to find the chunk again.
+     */
+    static void* allocate(size_t size, U32& offset);
+
+    /// Release a block returned by allocate().
+    static void free(void* ptr, U32 offset);
+
+    /// True if a scope is active on the calling thread.
+    static bool active();
+
+    /// Number of chunks currently allocated, over all threads.
+    static S32 getChunkCount();
+
+private:
+    struct Chunk;
+
+    LLSDArena();
+    ~LLSDArena();
+
+    void* allocateBlock(size_t size, U32& offset);
+    void retireChunk();
+
+private:
+    Chunk*  mChunk;
+    char*   mCursor;
+    char*   mEnd;
+    size_t  mNextChunkSize;
+};
+
+#endif // LL_LLSDARENA_H
@@ -50,6 +50,7 @@
 #include "lldate.h"
 #include "llmemorystream.h"
 #include "llsd.h"
+#include "llsdarena.h"
 #include "llstring.h"
 #include "lluri.h"
 
@@ -380,7 +381,7 @@ static const char BINARY_FALSE_SERIAL = '0';
  * LLSDParser
  */
 LLSDParser::LLSDParser()
-    : mCheckLimits(true), mMaxBytesLeft(0), mParseLines(false)
+    : mCheckLimits(true), mMaxBytesLeft(0), mParseLines(false), mUseArena(false)
 {
 }
 
@@ -392,6 +393,11 @@ S32 LLSDParser::parse(std::istream& istr, LLSD& data, llssize max_bytes, S32 max
 {
     mCheckLimits = LLSDSerialize::SIZE_UNLIMITED != max_bytes;
     mMaxBytesLeft = max_bytes;
+    if (mUseArena)
+    {
+        LLSDArena::Scope arena;
+        return doParse(istr, data, max_depth);
+    }
     return doParse(istr, data, max_depth);
 }
 
@@ -401,6 +407,11 @@ S32 LLSDParser::parseLines(std::istream& istr, LLSD& data)
 {
     mCheckLimits = false;
     mParseLines = true;
+    if (mUseArena)
+    {
+        LLSDArena::Scope arena;
+        return doParse(istr, data);
+    }
     return doParse(istr, data);
 }
 
@@ -2356,6 +2367,84 @@ LLUZipHelper::EZipRresult LLUZipHelper::unzip_llsd(LLSD& data, const U8* in, S32
         free(result);
     return ZR_OK;
 }
+// <FS> Streaming mesh decoder
+LLUZipHelper::EZipRresult LLUZipHelper::unzip_raw(const U8* in, S32 size, std::vector<U8>& buffer, size_t& out_size)
+{
+    out_size = 0;
+    if (!in || size <= 0)
+    {
+        return ZR_SIZE_ERROR;
+    }
+
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    strm.avail_in = size;
+    strm.next_in = const_cast<U8*>(in);
+
+    if (inflateInit(&strm) != Z_OK)
+    {
+        return ZR_MEM_ERROR;
+    }
+
+    // Mesh LODs typically inflate to 3-5 times their compressed size.
+    // Inflating straight into the caller's buffer saves the chunk copies
+    // unzip_llsd() does.
+    try
+    {
+        if (buffer.size() < (size_t)size * 4)
+        {
+            buffer.resize((size_t)size * 4);
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        inflateEnd(&strm);
+        return ZR_MEM_ERROR;
+    }
+
+    S32 ret = Z_OK;
+    do
+    {
+        if (out_size == buffer.size())
+        {
+            try
+            {
+                buffer.resize(buffer.size() * 2);
+            }
+            catch (const std::bad_alloc&)
+            {
+                inflateEnd(&strm);
+                return ZR_MEM_ERROR;
+            }
+        }
+        const size_t avail = llmin(buffer.size() - out_size, (size_t)U32_MAX);
+        strm.avail_out = (uInt)avail;
+        strm.next_out = buffer.data() + out_size;
+        ret = inflate(&strm, Z_NO_FLUSH);
+        switch (ret)
+        {
+        case Z_NEED_DICT:
+        case Z_DATA_ERROR:
+            inflateEnd(&strm);
+            return ZR_DATA_ERROR;
+        case Z_STREAM_ERROR:
+        case Z_BUF_ERROR:
+            inflateEnd(&strm);
+            return ZR_BUFFER_ERROR;
+        case Z_MEM_ERROR:
+            inflateEnd(&strm);
+            return ZR_MEM_ERROR;
+        }
+        out_size += avail - strm.avail_out;
+    } while (ret == Z_OK);
+
+    inflateEnd(&strm);
+    return ret == Z_STREAM_END ? ZR_OK : ZR_DATA_ERROR;
+}
+// </FS>
+
 //This unzip function will only work with a gzip header and trailer - while the contents
 //of the actual compressed data is the same for either format (gzip vs zlib ), the headers
 //and trailers are different for the formats.
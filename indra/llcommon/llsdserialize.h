@@ -90,6 +90,14 @@ public:
      */
     void reset()    { doReset();    };
 
+    /**
+     * @brief Allocate the nodes of parsed documents from an LLSDArena.
+     *
+     * Off by default. Worth it for big documents that are consumed and
+     * dropped as a whole; see LLSDArena.
+     */
+    void setUseArena(bool use_arena) { mUseArena = use_arena; }
+
 
 protected:
     /**
@@ -211,6 +219,11 @@ protected:
      * @brief Use line-based reading to get text
      */
     bool mParseLines;
+
+    /**
+     * @brief Build documents with an LLSDArena::Scope active
+     */
+    bool mUseArena;
 };
 
 /**
@@ -864,6 +877,11 @@ public:
     // return OK or reason for failure
     static EZipRresult unzip_llsd(LLSD& data, std::istream& is, S32 size);
     static EZipRresult unzip_llsd(LLSD& data, const U8* in, S32 size);
+    // <FS> Streaming mesh decoder
+    // Inflate a zlib block without parsing it. buffer is reused and only
+    // ever grows; on success its first out_size bytes hold the result.
+    static EZipRresult unzip_raw(const U8* in, S32 size, std::vector<U8>& buffer, size_t& out_size);
+    // </FS>
 };
 
 //dirty little zip functions -- yell at davep
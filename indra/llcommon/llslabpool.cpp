@@ -0,0 +1,265 @@
+/**
+ * @file llslabpool.cpp
+ * @brief Fixed size block allocation from large slabs.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llslabpool.h"
+
+#include <atomic>
+#include <new>
+
+namespace
+{
+    const size_t BLOCK_ALIGN = alignof(std::max_align_t);
+
+    size_t round_up(size_t size, size_t align)
+    {
+        return (size + align - 1) & ~(align - 1);
+    }
+
+    size_t block_size_for(size_t size)
+    {
+        return round_up(llmax(size, sizeof(void*)), BLOCK_ALIGN);
+    }
+
+    // threads take the shards in turn
+    size_t thread_shard(size_t shard_count)
+    {
+        static std::atomic<size_t> next_shard{ 0 };
+        thread_local size_t shard = next_shard++;
+        return shard % shard_count;
+    }
+}
+
+LLSlabPool::LLSlabPool(size_t block_size, size_t blocks_per_slab) :
+    mBlockSize(block_size_for(block_size))
+{
+    mHeaderSize = round_up(sizeof(Slab), BLOCK_ALIGN);
+    const size_t wanted = mHeaderSize + mBlockSize * llmax(blocks_per_slab, (size_t)1);
+    mSlabSize = BLOCK_ALIGN;
+    while (mSlabSize < wanted)
+    {
+        mSlabSize *= 2;
+    }
+    // whatever the power of two leaves over holds more blocks
+    mBlocksPerSlab = (mSlabSize - mHeaderSize) / mBlockSize;
+}
+
+LLSlabPool::~LLSlabPool()
+{
+    size_t live = getLiveCount();
+    if (live)
+    {
+        LL_WARNS() << live << " blocks of " << mBlockSize << " bytes still in use" << LL_ENDL;
+    }
+    for (Shard& shard : mShards)
+    {
+        for (Slab* slab : shard.mSlabs)
+        {
+            ::operator delete(slab, std::align_val_t(mSlabSize));
+        }
+    }
+}
+
+void* LLSlabPool::allocate()
+{
+    Shard& shard = mShards[thread_shard(SHARD_COUNT)];
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    Slab* slab = shard.mFirstFree;
+    if (!slab)
+    {
+        slab = addSlab(shard);
+    }
+    if (!slab->mUsed)
+    {
+        --shard.mEmptyCount;
+    }
+
+    FreeBlock* block = slab->mFree;
+    slab->mFree = block->mNext;
+    ++slab->mUsed;
+    if (!slab->mFree)
+    {
+        unlink(shard, slab);
+    }
+    ++shard.mLive;
+    return block;
+}
+
+void LLSlabPool::free(void* ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    Slab* slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t)(mSlabSize - 1));
+    // the shard it was allocated from, whichever thread frees it
+    Shard& shard = *slab->mShard;
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+
+    const bool was_full = !slab->mFree;
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->mNext = slab->mFree;
+    slab->mFree = block;
+    --slab->mUsed;
+    --shard.mLive;
+
+    if (slab->mUsed)
+    {
+        if (was_full)
+        {
+            linkFront(shard, slab);
+        }
+        return;
+    }
+
+    if (!was_full)
+    {
+        unlink(shard, slab);
+    }
+    if (shard.mEmptyCount)
+    {
+        releaseSlab(shard, slab);
+    }
+    else
+    {
+        // kept, but only used once the partly used slabs are full
+        linkBack(shard, slab);
+        ++shard.mEmptyCount;
+    }
+}
+
+size_t LLSlabPool::getSlabCount() const
+{
+    size_t count = 0;
+    for (const Shard& shard : mShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        count += shard.mSlabs.size();
+    }
+    return count;
+}
+
+size_t LLSlabPool::getLiveCount() const
+{
+    size_t count = 0;
+    for (const Shard& shard : mShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        count += shard.mLive;
+    }
+    return count;
+}
+
+LLSlabPool::Slab* LLSlabPool::addSlab(Shard& shard)
+{
+    char* memory = static_cast<char*>(::operator new(mSlabSize, std::align_val_t(mSlabSize)));
+    Slab* slab = reinterpret_cast<Slab*>(memory);
+    slab->mShard = &shard;
+    slab->mFree = nullptr;
+    slab->mUsed = 0;
+
+    // threaded back to front, so blocks are handed out in address order
+    for (size_t i = mBlocksPerSlab; i-- > 0; )
+    {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(memory + mHeaderSize + i * mBlockSize);
+        block->mNext = slab->mFree;
+        slab->mFree = block;
+    }
+
+    shard.mSlabs.push_back(slab);
+    linkFront(shard, slab);
+    ++shard.mEmptyCount;
+    return slab;
+}
+
+void LLSlabPool::releaseSlab(Shard& shard, Slab* slab)
+{
+    for (size_t i = 0; i < shard.mSlabs.size(); ++i)
+    {
+        if (shard.mSlabs[i] == slab)
+        {
+            shard.mSlabs[i] = shard.mSlabs.back();
+            shard.mSlabs.pop_back();
+            break;
+        }
+    }
+    ::operator delete(slab, std::align_val_t(mSlabSize));
+}
+
+// static
+void LLSlabPool::linkFront(Shard& shard, Slab* slab)
+{
+    slab->mPrev = nullptr;
+    slab->mNext = shard.mFirstFree;
+    if (shard.mFirstFree)
+    {
+        shard.mFirstFree->mPrev = slab;
+    }
+    else
+    {
+        shard.mLastFree = slab;
+    }
+    shard.mFirstFree = slab;
+}
+
+// static
+void LLSlabPool::linkBack(Shard& shard, Slab* slab)
+{
+    slab->mNext = nullptr;
+    slab->mPrev = shard.mLastFree;
+    if (shard.mLastFree)
+    {
+        shard.mLastFree->mNext = slab;
+    }
+    else
+    {
+        shard.mFirstFree = slab;
+    }
+    shard.mLastFree = slab;
+}
+
+// static
+void LLSlabPool::unlink(Shard& shard, Slab* slab)
+{
+    if (slab->mPrev)
+    {
+        slab->mPrev->mNext = slab->mNext;
+    }
+    else
+    {
+        shard.mFirstFree = slab->mNext;
+    }
+    if (slab->mNext)
+    {
+        slab->mNext->mPrev = slab->mPrev;
+    }
+    else
+    {
+        shard.mLastFree = slab->mPrev;
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ * @file llslabpool.h
+ * @brief Fixed size block allocation from large slabs.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSLABPOOL_H
+#define LL_LLSLABPOOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class LLSlabPool
+ * @brief Blocks of one size carved out of large slabs.
+ *
+ * For classes with many small, long lived instances: their objects end up
+ * packed next to each other instead of spread over the heap, and an
+ * allocation is popping a free list.
+ *
+ * allocate() and free() may be called from any thread. Each thread
+ * allocates from one of SHARD_COUNT shards with their own lock and slabs,
+ * so threads only contend when there are more of them than shards or when
+ * a block is freed by another thread than the one that allocated it. A
+ * slab is returned to the heap once all of its blocks are freed, except
+ * for one empty slab per shard kept for the next allocations.
+ *
+ * Typically used from class specific operator new and delete:
+ * @code
+ *   void* LLFoo::operator new(size_t size)
+ *   {
+ *       return size == sizeof(LLFoo) ? getPool().allocate() : ::operator new(size);
+ *   }
+ * @endcode
+ */
+class LL_COMMON_API LLSlabPool
+{
+public:
+    static constexpr size_t SHARD_COUNT = 8;
+
+    // block_size is rounded up to keep blocks aligned for any type. Slabs
+    // are sized to a power of two and hold at least blocks_per_slab blocks.
+    LLSlabPool(size_t block_size, size_t blocks_per_slab = 256);
+    ~LLSlabPool();
+
+    LLSlabPool(const LLSlabPool&) = delete;
+    LLSlabPool& operator=(const LLSlabPool&) = delete;
+
+    void* allocate();
+    // ptr must come from allocate() of this pool
+    void free(void* ptr);
+
+    size_t getBlockSize() const { return mBlockSize; }
+    size_t getBlocksPerSlab() const { return mBlocksPerSlab; }
+    size_t getSlabCount() const;
+    // Blocks handed out and not freed yet
+    size_t getLiveCount() const;
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* mNext;
+    };
+
+    struct Shard;
+
+    // At the start of every slab. Slabs are aligned to their size, so a
+    // block finds its slab by masking its address.
+    struct Slab
+    {
+        Shard* mShard;
+        FreeBlock* mFree;
+        size_t mUsed;
+        // among the shard's slabs with free blocks
+        Slab* mPrev;
+        Slab* mNext;
+    };
+
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mMutex;
+        // slabs with free blocks, partly used ones in front
+        Slab* mFirstFree = nullptr;
+        Slab* mLastFree = nullptr;
+        std::vector<Slab*> mSlabs;
+        size_t mEmptyCount = 0;
+        size_t mLive = 0;
+    };
+
+    Slab* addSlab(Shard& shard);
+    void releaseSlab(Shard& shard, Slab* slab);
+    static void linkFront(Shard& shard, Slab* slab);
+    static void linkBack(Shard& shard, Slab* slab);
+    static void unlink(Shard& shard, Slab* slab);
+
+    Shard mShards[SHARD_COUNT];
+    const size_t mBlockSize;
+    size_t mHeaderSize;
+    size_t mSlabSize;
+    size_t mBlocksPerSlab;
+};
+
+#endif // LL_LLSLABPOOL_H
@@ -0,0 +1,348 @@
+/**
+ * @file lluuidhashmap.h
+ * @brief Open addressing hash map keyed by LLUUID.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLUUIDHASHMAP_H
+#define LL_LLUUIDHASHMAP_H
+
+#include "lluuid.h"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @class LLUUIDHashMap
+ * @brief Drop in for a std::map<LLUUID, T> that is only used by key.
+ *
+ * The entries live in one array, probed linearly from the slot that
+ * LLUUID::getDigest64() hashes to, so a lookup usually touches a single
+ * cache line instead of walking a tree of separately allocated nodes.
+ * Erasing shifts the entries that follow back into the hole, so there
+ * are no tombstones and lookups do not degrade as the map churns.
+ *
+ * Unlike std::map:
+ * - the iteration order is unspecified;
+ * - inserting or erasing invalidates every iterator and reference into
+ *   the map, so do not modify the map while walking it;
+ * - clear() keeps the slot array allocated for the next fill.
+ */
+template <typename T>
+class LLUUIDHashMap
+{
+public:
+    typedef LLUUID key_type;
+    typedef T mapped_type;
+    typedef std::pair<LLUUID, T> value_type;
+    typedef size_t size_type;
+
+private:
+    template <bool IS_CONST>
+    class Iterator
+    {
+        friend class LLUUIDHashMap;
+        friend class Iterator<!IS_CONST>;
+        typedef typename std::conditional<IS_CONST, const LLUUIDHashMap, LLUUIDHashMap>::type map_t;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename LLUUIDHashMap::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<IS_CONST, const value_type*, value_type*>::type pointer;
+        typedef typename std::conditional<IS_CONST, const value_type&, value_type&>::type reference;
+
+        Iterator() : mMap(nullptr), mIndex(0) {}
+        // Also the conversion from iterator to const_iterator
+        Iterator(const Iterator<false>& other) : mMap(other.mMap), mIndex(other.mIndex) {}
+
+        reference operator*() const { return mMap->mSlots[mIndex]; }
+        pointer operator->() const { return &mMap->mSlots[mIndex]; }
+
+        Iterator& operator++()
+        {
+            mIndex = mMap->nextUsed(mIndex + 1);
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator previous(*this);
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const { return mIndex == other.mIndex && mMap == other.mMap; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        Iterator(map_t* map, size_t index) : mMap(map), mIndex(index) {}
+
+        map_t* mMap;
+        size_t mIndex;
+    };
+
+public:
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    LLUUIDHashMap() : mSlots(nullptr), mCapacity(0), mShift(64), mSize(0) {}
+    ~LLUUIDHashMap()
+    {
+        clear();
+        release();
+    }
+
+    LLUUIDHashMap(const LLUUIDHashMap&) = delete;
+    LLUUIDHashMap& operator=(const LLUUIDHashMap&) = delete;
+
+    iterator begin() { return iterator(this, nextUsed(0)); }
+    iterator end() { return iterator(this, mCapacity); }
+    const_iterator begin() const { return const_iterator(this, nextUsed(0)); }
+    const_iterator end() const { return const_iterator(this, mCapacity); }
+
+    size_type size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+    iterator find(const LLUUID& key) { return iterator(this, findIndex(key)); }
+    const_iterator find(const LLUUID& key) const { return const_iterator(this, findIndex(key)); }
+    size_type count(const LLUUID& key) const { return findIndex(key) != mCapacity ? 1 : 0; }
+
+    // Inserts a default constructed value if the key is not there yet
+    T& operator[](const LLUUID& key)
+    {
+        size_t index = findIndex(key);
+        if (index == mCapacity)
+        {
+            index = emplaceNew(key, T());
+        }
+        return mSlots[index].second;
+    }
+
+    // Like std::map::insert(), does not overwrite an existing value
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        size_t index = findIndex(value.first);
+        if (index != mCapacity)
+        {
+            return std::make_pair(iterator(this, index), false);
+        }
+        index = emplaceNew(value.first, value.second);
+        return std::make_pair(iterator(this, index), true);
+    }
+
+    size_type erase(const LLUUID& key)
+    {
+        size_t index = findIndex(key);
+        if (index == mCapacity)
+        {
+            return 0;
+        }
+        eraseIndex(index);
+        return 1;
+    }
+
+    void erase(const_iterator iter)
+    {
+        eraseIndex(iter.mIndex);
+    }
+
+    void clear()
+    {
+        if (!mSize)
+        {
+            return;
+        }
+        for (size_t i = 0; i < mCapacity; ++i)
+        {
+            if (mUsed[i])
+            {
+                mSlots[i].~value_type();
+            }
+        }
+        memset(mUsed.get(), 0, mCapacity);
+        mSize = 0;
+    }
+
+    // Sizes the slot array so that count entries fit without growing
+    void reserve(size_type count)
+    {
+        size_t capacity = MIN_CAPACITY;
+        while (tooFull(count, capacity))
+        {
+            capacity *= 2;
+        }
+        if (capacity > mCapacity)
+        {
+            rehash(capacity);
+        }
+    }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    // Keep at least a quarter of the slots empty, linear probing clusters
+    // quickly above that
+    static bool tooFull(size_t count, size_t capacity)
+    {
+        return count * 4 > capacity * 3;
+    }
+
+    // The digest spread over the top bits, so that ids which only differ
+    // in a few bits still land far apart
+    size_t slotOf(const LLUUID& key) const
+    {
+        return (size_t)((key.getDigest64() * 0x9E3779B97F4A7C15ULL) >> mShift);
+    }
+
+    size_t findIndex(const LLUUID& key) const
+    {
+        if (!mSize)
+        {
+            return mCapacity;
+        }
+        const size_t mask = mCapacity - 1;
+        for (size_t i = slotOf(key); mUsed[i]; i = (i + 1) & mask)
+        {
+            if (mSlots[i].first == key)
+            {
+                return i;
+            }
+        }
+        return mCapacity;
+    }
+
+    size_t nextUsed(size_t index) const
+    {
+        while (index < mCapacity && !mUsed[index])
+        {
+            ++index;
+        }
+        return index;
+    }
+
+    // The key must not be in the map yet
+    template <typename VALUE>
+    size_t emplaceNew(const LLUUID& key, VALUE&& value)
+    {
+        if (tooFull(mSize + 1, mCapacity))
+        {
+            rehash(mCapacity ? mCapacity * 2 : MIN_CAPACITY);
+        }
+        size_t index = freeSlotFor(key);
+        new (&mSlots[index]) value_type(key, std::forward<VALUE>(value));
+        mUsed[index] = 1;
+        ++mSize;
+        return index;
+    }
+
+    size_t freeSlotFor(const LLUUID& key) const
+    {
+        const size_t mask = mCapacity - 1;
+        size_t index = slotOf(key);
+        while (mUsed[index])
+        {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void eraseIndex(size_t hole)
+    {
+        mSlots[hole].~value_type();
+        mUsed[hole] = 0;
+        --mSize;
+
+        // Move back every following entry of the cluster whose home slot
+        // is not between the hole and where it sits now
+        const size_t mask = mCapacity - 1;
+        for (size_t i = (hole + 1) & mask; mUsed[i]; i = (i + 1) & mask)
+        {
+            size_t home = slotOf(mSlots[i].first);
+            if (((i - home) & mask) >= ((i - hole) & mask))
+            {
+                new (&mSlots[hole]) value_type(std::move(mSlots[i]));
+                mUsed[hole] = 1;
+                mSlots[i].~value_type();
+                mUsed[i] = 0;
+                hole = i;
+            }
+        }
+    }
+
+    void rehash(size_t capacity)
+    {
+        value_type* old_slots = mSlots;
+        std::unique_ptr<U8[]> old_used(std::move(mUsed));
+        const size_t old_capacity = mCapacity;
+
+        mSlots = std::allocator<value_type>().allocate(capacity);
+        mUsed.reset(new U8[capacity]());
+        mCapacity = capacity;
+        mShift = 64;
+        for (size_t c = capacity; c > 1; c >>= 1)
+        {
+            --mShift;
+        }
+
+        for (size_t i = 0; i < old_capacity; ++i)
+        {
+            if (old_used[i])
+            {
+                size_t index = freeSlotFor(old_slots[i].first);
+                new (&mSlots[index]) value_type(std::move(old_slots[i]));
+                mUsed[index] = 1;
+                old_slots[i].~value_type();
+            }
+        }
+        if (old_slots)
+        {
+            std::allocator<value_type>().deallocate(old_slots, old_capacity);
+        }
+    }
+
+    void release()
+    {
+        if (mSlots)
+        {
+            std::allocator<value_type>().deallocate(mSlots, mCapacity);
+        }
+        mSlots = nullptr;
+        mUsed.reset();
+        mCapacity = 0;
+        mShift = 64;
+    }
+
+    value_type* mSlots;
+    std::unique_ptr<U8[]> mUsed;
+    size_t mCapacity;   // zero or a power of two
+    U32 mShift;         // 64 - log2(mCapacity)
+    size_t mSize;
+};
+
+#endif // LL_LLUUIDHASHMAP_H
@@ -176,6 +176,12 @@ void LLWorkerThread::WorkRequest::deleteRequest()
     LLQueuedThread::QueuedRequest::deleteRequest();
 }
 
+// virtual
+F32 LLWorkerThread::WorkRequest::getPriority() const
+{
+    return mWorkerClass->getWorkPriority();
+}
+
 // virtual
 bool LLWorkerThread::WorkRequest::processRequest()
 {
@@ -205,7 +211,8 @@ LLWorkerClass::LLWorkerClass(LLWorkerThread* workerthread, const std::string& na
       mWorkerClassName(name),
       mRequestHandle(LLWorkerThread::nullHandle()),
       mMutex(),
-      mWorkFlags(0)
+      mWorkFlags(0),
+      mWorkPriority(0.f)
 {
     if (!mWorkerThread)
     {
@@ -310,6 +317,16 @@ void LLWorkerClass::addWork(S32 param)
     mMutex.unlock();
 }
 
+void LLWorkerClass::setWorkPriority(F32 priority)
+{
+    mWorkPriority = priority;
+    // Doesn't take mMutex or the thread's data lock, callers may hold locks
+    // the worker thread takes while it holds those. A stale handle is a
+    // no-op, and work queued before mRequestHandle is set already reads
+    // mWorkPriority.
+    mWorkerThread->updatePriority(mRequestHandle, priority);
+}
+
 void LLWorkerClass::abortWork(bool autocomplete)
 {
     mMutex.lock();
@@ -70,6 +70,7 @@ public:
         /*virtual*/ bool processRequest();
         /*virtual*/ void finishRequest(bool completed);
         /*virtual*/ void deleteRequest();
+        /*virtual*/ F32 getPriority() const;
 
     private:
         LLWorkerClass* mWorkerClass;
@@ -170,6 +171,11 @@ protected:
     // abortWork(): requests that work be aborted
     void abortWork(bool autocomplete);
 
+    // setWorkPriority(): higher priority work is picked first, moves
+    // already queued work too (ANY THREAD)
+    void setWorkPriority(F32 priority);
+    F32 getWorkPriority() const { return mWorkPriority.CurrentValue(); }
+
     // checkWork(): if doWork is complete or aborted, call endWork() and return true
     bool checkWork(bool aborting = false);
 
@@ -193,6 +199,7 @@ protected:
 private:
     LLMutex mMutex;
     LLAtomicU32 mWorkFlags;
+    LLAtomicBase<F32> mWorkPriority;
 };
 
 //============================================================================
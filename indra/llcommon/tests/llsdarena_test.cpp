@@ -0,0 +1,336 @@
+/**
+ * @file llsdarena_test.cpp
+ * @brief LLSDArena tests and bulk parse benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llsdarena.h"
+#include "llformat.h"
+#include "llmemory.h"
+#include "llsd.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+
+#include "../test/lltut.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+// Count heap allocations and live heap bytes through operator new, which
+// is where LLSD nodes, map nodes, strings and arena chunks come from.
+#if !((TRACY_ENABLE) && LL_PROFILER_ENABLE_TRACY_MEMORY)
+static std::atomic<U64> sAllocations{ 0 };
+static std::atomic<S64> sLiveBytes{ 0 };
+static std::atomic<S64> sPeakBytes{ 0 };
+
+static constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+void* operator new(size_t size)
+{
+    ++sAllocations;
+    char* ptr = (char*)(malloc)(size + HEADER_SIZE);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    *(size_t*)ptr = size;
+    S64 live = (sLiveBytes += (S64)size);
+    S64 peak = sPeakBytes.load();
+    while (live > peak && !sPeakBytes.compare_exchange_weak(peak, live))
+    {
+    }
+    return ptr + HEADER_SIZE;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr)
+    {
+        char* block = (char*)ptr - HEADER_SIZE;
+        sLiveBytes -= (S64)*(size_t*)block;
+        (free)(block);
+    }
+}
+
+static U64 allocation_count()
+{
+    return sAllocations.load();
+}
+
+static void reset_peak_bytes()
+{
+    sPeakBytes = sLiveBytes.load();
+}
+
+static S64 peak_bytes()
+{
+    return sPeakBytes.load() - sLiveBytes.load();
+}
+#else
+static U64 allocation_count()
+{
+    return 0;
+}
+
+static void reset_peak_bytes()
+{
+}
+
+static S64 peak_bytes()
+{
+    return 0;
+}
+#endif
+
+namespace
+{
+    // Something shaped like an AIS folder fetch: one map per item with
+    // a nested permissions and sale info map.
+    LLSD makeInventory(S32 items)
+    {
+        LLSD folder;
+        folder["folder_id"] = LLUUID::generateNewID();
+        folder["owner_id"] = LLUUID::generateNewID();
+        folder["version"] = 42;
+        LLSD& list = folder["items"];
+        list = LLSD::emptyArray();
+        for (S32 i = 0; i < items; ++i)
+        {
+            LLSD item;
+            item["item_id"] = LLUUID::generateNewID();
+            item["parent_id"] = folder["folder_id"];
+            item["asset_id"] = LLUUID::generateNewID();
+            item["name"] = llformat("Item %d with a reasonably long name", i);
+            item["desc"] = (i % 3) ? std::string("(No Description)") : std::string();
+            item["type"] = i % 20;
+            item["inv_type"] = i % 18;
+            item["flags"] = i * 7;
+            item["created_at"] = (S32)(1500000000 + i);
+
+            LLSD& perms = item["permissions"];
+            perms["creator_id"] = LLUUID::generateNewID();
+            perms["owner_id"] = folder["owner_id"];
+            perms["group_id"] = LLUUID::null;
+            perms["base_mask"] = (S32)0x7fffffff;
+            perms["owner_mask"] = (S32)0x7fffffff;
+            perms["group_mask"] = 0;
+            perms["everyone_mask"] = 0;
+            perms["next_owner_mask"] = (S32)0x82000;
+            perms["is_owner_group"] = false;
+
+            LLSD& sale = item["sale_info"];
+            sale["sale_price"] = 10;
+            sale["sale_type"] = "not";
+
+            list.append(item);
+        }
+        return folder;
+    }
+
+    enum EFormat { BINARY, NOTATION, XML };
+
+    std::string serialize(const LLSD& sd, EFormat format)
+    {
+        std::ostringstream str;
+        switch (format)
+        {
+        case BINARY:   LLSDSerialize::toBinary(sd, str); break;
+        case NOTATION: LLSDSerialize::toNotation(sd, str); break;
+        case XML:      LLSDSerialize::toXML(sd, str); break;
+        }
+        return str.str();
+    }
+
+    bool parse(LLSD& sd, const std::string& data, EFormat format, bool use_arena)
+    {
+        std::istringstream str(data);
+        LLPointer<LLSDParser> parser;
+        switch (format)
+        {
+        case BINARY:   parser = new LLSDBinaryParser; break;
+        case NOTATION: parser = new LLSDNotationParser; break;
+        case XML:      parser = new LLSDXMLParser; break;
+        }
+        parser->setUseArena(use_arena);
+        return parser->parse(str, sd, data.size()) != LLSDParser::PARSE_FAILURE;
+    }
+}
+
+namespace tut
+{
+    struct LLSDArenaFixture
+    {
+    };
+    typedef test_group<LLSDArenaFixture> LLSDArena_t;
+    typedef LLSDArena_t::object LLSDArena_object_t;
+    tut::LLSDArena_t tut_LLSDArena("LLSDArena");
+
+    template<> template<>
+    void LLSDArena_object_t::test<1>()
+    {
+        set_test_name("values outlive their scope and release their chunks");
+
+        const S32 chunks = LLSDArena::getChunkCount();
+        LLSD kept;
+        {
+            LLSDArena::Scope arena;
+            ensure("scope active", LLSDArena::active());
+
+            LLSD map = LLSD::emptyMap();
+            for (S32 i = 0; i < 5000; ++i)
+            {
+                map[llformat("key%05d", i)] = llsd::array(i, "value", LLUUID::null);
+            }
+            // out of order key still ends up sorted
+            map.insert("aaa", 1);
+            ensure_equals("size", map.size(), size_t(5001));
+            ensure_equals("first key", map.beginMap()->first, "aaa");
+            ensure("chunks in use", LLSDArena::getChunkCount() > chunks);
+
+            kept = map["key00100"];
+        }
+        ensure("scope gone", !LLSDArena::active());
+        ensure_equals("kept value", kept[0].asInteger(), 100);
+        ensure_equals("kept string", kept[1].asString(), "value");
+
+        // and can still be modified from the heap
+        kept.append("more");
+        ensure_equals("appended", kept.size(), size_t(4));
+
+        kept.clear();
+        ensure_equals("chunks released", LLSDArena::getChunkCount(), chunks);
+    }
+
+    template<> template<>
+    void LLSDArena_object_t::test<2>()
+    {
+        set_test_name("arena parse gives the same document");
+
+        const LLSD inventory = makeInventory(200);
+        const S32 chunks = LLSDArena::getChunkCount();
+        for (EFormat format : { BINARY, NOTATION, XML })
+        {
+            const std::string data = serialize(inventory, format);
+            LLSD heap, arena;
+            ensure("heap parse", parse(heap, data, format, false));
+            ensure("arena parse", parse(arena, data, format, true));
+            ensure("same document", llsd_equals(heap, arena));
+        }
+        ensure_equals("chunks released", LLSDArena::getChunkCount(), chunks);
+    }
+
+    template<> template<>
+    void LLSDArena_object_t::test<3>()
+    {
+        set_test_name("first block larger than the first chunk");
+
+        const S32 chunks = LLSDArena::getChunkCount();
+        {
+            LLSDArena::Scope arena;
+            const size_t size = 10 * 1024;
+            U32 offset = 0;
+            char* big = (char*)LLSDArena::allocate(size, offset);
+            ensure("allocated", big != nullptr);
+            memset(big, 0x5a, size);
+
+            U32 small_offset = 0;
+            char* small = (char*)LLSDArena::allocate(64, small_offset);
+            ensure("small allocated", small != nullptr);
+            ensure("no overlap", small >= big + size || small + 64 <= big);
+            memset(small, 0xa5, 64);
+            ensure("big intact", big[size - 1] == 0x5a);
+
+            LLSDArena::free(small, small_offset);
+            LLSDArena::free(big, offset);
+
+            // and through a parse, a long string as the first value
+            const std::string text(20 * 1024, 'x');
+            LLSD parsed;
+            ensure("parse", parse(parsed, serialize(llsd::array(text), BINARY), BINARY, true));
+            ensure_equals("string", parsed[0].asString(), text);
+        }
+        ensure_equals("chunks released", LLSDArena::getChunkCount(), chunks);
+    }
+
+    template<> template<>
+    void LLSDArena_object_t::test<4>()
+    {
+        set_test_name("bulk parse throughput, peak memory and teardown");
+
+        skip_unless_benchmarks();
+
+        // About the size of a large AIS or inventory skeleton response
+        const S32 ITERATIONS = 5;
+        const LLSD inventory = makeInventory(20000);
+        const char* names[] = { "binary", "notation", "xml" };
+        const S32 chunks = LLSDArena::getChunkCount();
+
+        for (EFormat format : { BINARY, NOTATION, XML })
+        {
+            const std::string data = serialize(inventory, format);
+            const F64 mb = data.size() / (1024.0 * 1024.0);
+
+            for (bool use_arena : { false, true })
+            {
+                F64 parse_seconds = 0.0;
+                F64 teardown_seconds = 0.0;
+                S64 peak = 0;
+                U64 allocations = 0;
+                S64 rss = 0;
+                for (S32 i = 0; i < ITERATIONS; ++i)
+                {
+                    LLSD sd;
+                    reset_peak_bytes();
+                    const U64 allocs_before = allocation_count();
+                    const S64 rss_before = (S64)LLMemory::getCurrentRSS();
+                    auto start = std::chrono::steady_clock::now();
+                    ensure("parse", parse(sd, data, format, use_arena));
+                    auto parsed = std::chrono::steady_clock::now();
+                    rss = llmax(rss, (S64)LLMemory::getCurrentRSS() - rss_before);
+                    allocations = allocation_count() - allocs_before;
+                    peak = llmax(peak, peak_bytes());
+
+                    sd.clear();
+                    auto done = std::chrono::steady_clock::now();
+                    parse_seconds += std::chrono::duration<F64>(parsed - start).count();
+                    teardown_seconds += std::chrono::duration<F64>(done - parsed).count();
+                }
+
+                std::cout << "\nLLSD " << names[format] << " parse (" << mb << " MB, "
+                          << (use_arena ? "arena" : "heap") << "): "
+                          << mb * ITERATIONS / llmax(parse_seconds, 1e-9) << " MB/s, "
+                          << allocations << " allocations, peak heap "
+                          << peak / 1024 << " KB, RSS growth " << rss / 1024 << " KB, teardown "
+                          << teardown_seconds * 1000.0 / ITERATIONS << " ms" << std::endl;
+            }
+        }
+        ensure_equals("chunks released", LLSDArena::getChunkCount(), chunks);
+    }
+}
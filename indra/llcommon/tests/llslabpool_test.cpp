@@ -0,0 +1,185 @@
+/**
+ * @file llslabpool_test.cpp
+ * @brief LLSlabPool tests.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llslabpool.h"
+
+#include "../test/lltut.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace tut
+{
+    struct LLSlabPoolFixture
+    {
+    };
+    typedef test_group<LLSlabPoolFixture> LLSlabPool_t;
+    typedef LLSlabPool_t::object LLSlabPool_object_t;
+    tut::LLSlabPool_t tut_LLSlabPool("LLSlabPool");
+
+    template<> template<>
+    void LLSlabPool_object_t::test<1>()
+    {
+        set_test_name("blocks are distinct, aligned and reused");
+        LLSlabPool pool(40, 8);
+        ensure_equals("rounded block size", pool.getBlockSize() % alignof(std::max_align_t), size_t(0));
+        ensure("block fits", pool.getBlockSize() >= 40);
+
+        std::set<void*> blocks;
+        for (S32 i = 0; i < 20; ++i)
+        {
+            void* block = pool.allocate();
+            ensure_equals("aligned", (uintptr_t)block % alignof(std::max_align_t), uintptr_t(0));
+            memset(block, 0xa5, 40);
+            ensure("distinct", blocks.insert(block).second);
+        }
+        ensure("at least as asked", pool.getBlocksPerSlab() >= 8);
+        const size_t slabs = (20 + pool.getBlocksPerSlab() - 1) / pool.getBlocksPerSlab();
+        ensure_equals("slabs", pool.getSlabCount(), slabs);
+        ensure_equals("live", pool.getLiveCount(), size_t(20));
+
+        void* freed = *blocks.begin();
+        pool.free(freed);
+        ensure_equals("live after free", pool.getLiveCount(), size_t(19));
+        ensure("freed block reused", pool.allocate() == freed);
+        ensure_equals("no new slab", pool.getSlabCount(), slabs);
+
+        for (void* block : blocks)
+        {
+            pool.free(block);
+        }
+        ensure_equals("all freed", pool.getLiveCount(), size_t(0));
+        ensure_equals("one empty slab kept", pool.getSlabCount(), size_t(1));
+    }
+
+    template<> template<>
+    void LLSlabPool_object_t::test<2>()
+    {
+        set_test_name("allocate and free from several threads");
+        LLSlabPool pool(sizeof(U64) * 4, 64);
+        std::vector<std::thread> threads;
+        for (U64 t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&pool, t]()
+                {
+                    std::vector<U64*> blocks;
+                    for (S32 round = 0; round < 50; ++round)
+                    {
+                        for (U64 i = 0; i < 200; ++i)
+                        {
+                            U64* block = static_cast<U64*>(pool.allocate());
+                            block[0] = t;
+                            block[3] = i;
+                            blocks.push_back(block);
+                        }
+                        for (size_t i = 0; i < blocks.size(); ++i)
+                        {
+                            // nobody else wrote into our blocks
+                            if (blocks[i][0] != t || blocks[i][3] != i)
+                            {
+                                throw std::runtime_error("block shared between threads");
+                            }
+                            pool.free(blocks[i]);
+                        }
+                        blocks.clear();
+                    }
+                });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        ensure_equals("all freed", pool.getLiveCount(), size_t(0));
+        ensure("one empty slab kept per thread", pool.getSlabCount() <= 4);
+    }
+
+    template<> template<>
+    void LLSlabPool_object_t::test<3>()
+    {
+        set_test_name("empty slabs go back to the heap, also when freed by another thread");
+        LLSlabPool pool(64, 16);
+        const size_t per_slab = pool.getBlocksPerSlab();
+
+        std::vector<void*> blocks;
+        for (size_t i = 0; i < per_slab * 10; ++i)
+        {
+            blocks.push_back(pool.allocate());
+        }
+        ensure_equals("peak", pool.getSlabCount(), size_t(10));
+
+        // one block left in every other slab
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            if (i % (per_slab * 2) != 0)
+            {
+                pool.free(blocks[i]);
+                blocks[i] = nullptr;
+            }
+        }
+        ensure_equals("partly used slabs stay, one empty kept", pool.getSlabCount(), size_t(6));
+
+        // refilled from the partly used slabs before the empty one
+        std::vector<void*> refill;
+        for (size_t i = 0; i < (per_slab - 1) * 5; ++i)
+        {
+            refill.push_back(pool.allocate());
+        }
+        ensure_equals("no slab added", pool.getSlabCount(), size_t(6));
+
+        // allocated on another thread, freed here
+        std::vector<void*> other;
+        std::thread thread([&pool, &other, per_slab]()
+            {
+                for (size_t i = 0; i < per_slab * 3; ++i)
+                {
+                    other.push_back(pool.allocate());
+                }
+            });
+        thread.join();
+        const size_t with_other = pool.getSlabCount();
+        ensure("own slabs", with_other >= 9);
+        for (void* block : other)
+        {
+            pool.free(block);
+        }
+        ensure_equals("released", pool.getSlabCount(), with_other - 2);
+
+        for (void* block : refill)
+        {
+            pool.free(block);
+        }
+        for (void* block : blocks)
+        {
+            pool.free(block);
+        }
+        ensure_equals("all freed", pool.getLiveCount(), size_t(0));
+        ensure_equals("one empty slab per shard used", pool.getSlabCount(), size_t(2));
+    }
+}
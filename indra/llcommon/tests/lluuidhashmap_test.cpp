@@ -0,0 +1,389 @@
+/**
+ * @file lluuidhashmap_test.cpp
+ * @brief LLUUIDHashMap tests and inventory walk benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lluuidhashmap.h"
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "llslabpool.h"
+#include "llstl.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Random ids like the ones the grid hands out
+    struct IDSource
+    {
+        std::mt19937_64 mRandom{ 1234 };
+
+        LLUUID next()
+        {
+            LLUUID id;
+            U64 words[2] = { mRandom(), mRandom() };
+            memcpy(id.mData, words, UUID_BYTES);
+            return id;
+        }
+    };
+
+    // Shaped like the inventory model: objects owned through LLPointer,
+    // looked up by id, and parent id -> children arrays.
+    struct HeapItem : public LLRefCount
+    {
+        LLUUID mID;
+        LLUUID mParentID;
+        LLUUID mAssetID;
+        std::string mName;
+        U32 mFlags = 0;
+    };
+
+    struct PooledItem : public HeapItem
+    {
+        static LLSlabPool& getPool()
+        {
+            static LLSlabPool pool(sizeof(PooledItem), 1024);
+            return pool;
+        }
+        static void* operator new(size_t size)
+        {
+            return size == sizeof(PooledItem) ? getPool().allocate() : ::operator new(size);
+        }
+        static void operator delete(void* ptr, size_t size)
+        {
+            if (size == sizeof(PooledItem))
+            {
+                getPool().free(ptr);
+            }
+            else
+            {
+                ::operator delete(ptr);
+            }
+        }
+    };
+
+    template <template <typename> class MAP, typename ITEM>
+    struct Inventory
+    {
+        typedef std::vector<LLUUID> cat_array_t;
+        typedef ITEM item_t;
+        typedef std::vector<LLPointer<ITEM> > item_array_t;
+
+        MAP<LLPointer<ITEM> > mItemMap;
+        MAP<LLUUID> mCategoryMap;   // category -> parent
+        MAP<cat_array_t*> mParentChildCategoryTree;
+        MAP<item_array_t*> mParentChildItemTree;
+        LLUUID mRootID;
+
+        ~Inventory()
+        {
+            std::for_each(mParentChildCategoryTree.begin(), mParentChildCategoryTree.end(), DeletePairedPointer());
+            std::for_each(mParentChildItemTree.begin(), mParentChildItemTree.end(), DeletePairedPointer());
+        }
+
+        void addCategory(const LLUUID& id, const LLUUID& parent_id)
+        {
+            mCategoryMap[id] = parent_id;
+            mParentChildCategoryTree[id] = new cat_array_t;
+            mParentChildItemTree[id] = new item_array_t;
+            if (parent_id.notNull())
+            {
+                mParentChildCategoryTree[parent_id]->push_back(id);
+            }
+        }
+
+        void addItem(ITEM* item)
+        {
+            mItemMap[item->mID] = item;
+            mParentChildItemTree[item->mParentID]->push_back(item);
+        }
+
+        // folder_count folders in a bushy tree a few levels deep, a tenth
+        // of the items are links to other items
+        void fill(U32 folder_count, U32 item_count)
+        {
+            IDSource ids;
+            std::vector<LLUUID> folders;
+            mRootID = ids.next();
+            addCategory(mRootID, LLUUID::null);
+            folders.push_back(mRootID);
+            for (U32 i = 1; i < folder_count; ++i)
+            {
+                folders.push_back(ids.next());
+                addCategory(folders.back(), folders[(i - 1) / 8]);
+            }
+
+            std::vector<LLUUID> item_ids;
+            item_ids.reserve(item_count);
+            for (U32 i = 0; i < item_count; ++i)
+            {
+                ITEM* item = new ITEM;
+                item->mID = ids.next();
+                item->mParentID = folders[ids.mRandom() % folders.size()];
+                item->mAssetID = (i % 10 == 9) ? item_ids[ids.mRandom() % item_ids.size()] : ids.next();
+                item->mName = "Item with a reasonably long name";
+                item->mFlags = i;
+                addItem(item);
+                item_ids.push_back(item->mID);
+            }
+        }
+
+        // Like collectDescendentsIf(): down the tree by parent id lookups
+        void collectDescendents(const LLUUID& id, std::vector<ITEM*>& items) const
+        {
+            if (cat_array_t* cats = get_ptr_in_map(mParentChildCategoryTree, id))
+            {
+                for (const LLUUID& cat_id : *cats)
+                {
+                    collectDescendents(cat_id, items);
+                }
+            }
+            if (item_array_t* item_array = get_ptr_in_map(mParentChildItemTree, id))
+            {
+                for (const LLPointer<ITEM>& item : *item_array)
+                {
+                    if (item->mFlags & 1)
+                    {
+                        items.push_back(item);
+                    }
+                }
+            }
+        }
+
+        // Every item, resolving its link target and walking its parents up
+        // to the root, like link resolution and isObjectDescendentOf() do
+        U32 walk() const
+        {
+            U32 depth = 0;
+            for (auto iter = mItemMap.begin(); iter != mItemMap.end(); ++iter)
+            {
+                const ITEM* item = iter->second;
+                auto target = mItemMap.find(item->mAssetID);
+                if (target != mItemMap.end())
+                {
+                    depth += target->second->mFlags & 1;
+                }
+                for (auto cat = mCategoryMap.find(item->mParentID); cat != mCategoryMap.end(); cat = mCategoryMap.find(cat->second))
+                {
+                    ++depth;
+                }
+            }
+            return depth;
+        }
+    };
+
+    template <typename T>
+    using StdMap = std::map<LLUUID, T>;
+}
+
+namespace tut
+{
+    struct LLUUIDHashMapFixture
+    {
+    };
+    typedef test_group<LLUUIDHashMapFixture> LLUUIDHashMap_t;
+    typedef LLUUIDHashMap_t::object LLUUIDHashMap_object_t;
+    tut::LLUUIDHashMap_t tut_LLUUIDHashMap("LLUUIDHashMap");
+
+    template<> template<>
+    void LLUUIDHashMap_object_t::test<1>()
+    {
+        set_test_name("same contents as std::map through random inserts and erases");
+        // few keys, so clusters form and erases shift them around
+        IDSource ids;
+        std::vector<LLUUID> keys(300);
+        for (LLUUID& key : keys)
+        {
+            key = ids.next();
+        }
+        keys[0].setNull();
+
+        LLUUIDHashMap<S32> map;
+        std::map<LLUUID, S32> expected;
+        for (S32 i = 0; i < 100000; ++i)
+        {
+            const LLUUID& key = keys[ids.mRandom() % keys.size()];
+            switch (ids.mRandom() % 4)
+            {
+            case 0:
+                map[key] = i;
+                expected[key] = i;
+                break;
+            case 1:
+                ensure_equals("insert", map.insert(std::make_pair(key, i)).second, expected.insert(std::make_pair(key, i)).second);
+                break;
+            case 2:
+                ensure_equals("erase", map.erase(key), expected.erase(key));
+                break;
+            default:
+                ensure_equals("count", map.count(key), expected.count(key));
+                break;
+            }
+            ensure_equals("size", map.size(), expected.size());
+        }
+
+        size_t visited = 0;
+        for (const auto& entry : map)
+        {
+            auto iter = expected.find(entry.first);
+            ensure("walked key expected", iter != expected.end());
+            ensure_equals("walked value", entry.second, iter->second);
+            ++visited;
+        }
+        ensure_equals("walked each once", visited, expected.size());
+        for (const auto& entry : expected)
+        {
+            auto iter = map.find(entry.first);
+            ensure("key found", iter != map.end());
+            ensure_equals("value", iter->second, entry.second);
+        }
+    }
+
+    template<> template<>
+    void LLUUIDHashMap_object_t::test<2>()
+    {
+        set_test_name("std::map style use");
+        LLUUIDHashMap<std::vector<S32>*> map;
+        ensure("empty", map.empty());
+        ensure("begin is end", map.begin() == map.end());
+        ensure("nothing found", get_ptr_in_map(map, LLUUID::null) == nullptr);
+
+        IDSource ids;
+        std::vector<LLUUID> keys;
+        for (S32 i = 0; i < 1000; ++i)
+        {
+            keys.push_back(ids.next());
+            map[keys.back()] = new std::vector<S32>(1, i);
+        }
+        ensure_equals("pointer", get_ptr_in_map(map, keys[500])->front(), 500);
+
+        LLUUIDHashMap<std::vector<S32>*>::iterator iter = map.find(keys[10]);
+        LLUUIDHashMap<std::vector<S32>*>::const_iterator const_iter = iter;
+        ensure("converted iterator", const_iter == map.find(keys[10]));
+        delete iter->second;
+        map.erase(const_iter);
+        ensure("erased", !map.count(keys[10]));
+        ensure_equals("size", map.size(), size_t(999));
+
+        std::for_each(map.begin(), map.end(), DeletePairedPointer());
+        map.clear();
+        ensure("cleared", map.empty() && map.begin() == map.end());
+        ensure("nothing left", !map.count(keys[0]));
+
+        map.reserve(5000);
+        map[keys[1]] = nullptr;
+        ensure("usable after clear", map.count(keys[1]) && !map.find(keys[1])->second);
+    }
+
+    template<> template<>
+    void LLUUIDHashMap_object_t::test<3>()
+    {
+        set_test_name("values are destroyed");
+        LLPointer<LLRefCount> shared = new LLRefCount;
+        {
+            LLUUIDHashMap<LLPointer<LLRefCount> > map;
+            IDSource ids;
+            for (S32 i = 0; i < 100; ++i)
+            {
+                map[ids.next()] = shared;
+            }
+            ensure_equals("referenced", shared->getNumRefs(), 101);
+            map.erase(map.begin()->first);
+            ensure_equals("erase releases", shared->getNumRefs(), 100);
+            map.clear();
+            ensure_equals("clear releases", shared->getNumRefs(), 1);
+            for (S32 i = 0; i < 100; ++i)
+            {
+                map[ids.next()] = shared;
+            }
+        }
+        ensure_equals("destructor releases", shared->getNumRefs(), 1);
+    }
+
+    template <typename INVENTORY>
+    void run_inventory_benchmark(const char* name, U32& collected, U32& walked)
+    {
+        const U32 FOLDERS = 20000;
+        const U32 ITEMS = 200000;
+        const S32 ROUNDS = 10;
+        typedef std::chrono::steady_clock clock;
+
+        auto start = clock::now();
+        F64 collect_seconds = 0.0;
+        F64 walk_seconds = 0.0;
+        {
+            INVENTORY inventory;
+            inventory.fill(FOLDERS, ITEMS);
+            auto filled = clock::now();
+
+            std::vector<typename INVENTORY::item_t*> items;
+            for (S32 i = 0; i < ROUNDS; ++i)
+            {
+                auto round_start = clock::now();
+                items.clear();
+                inventory.collectDescendents(inventory.mRootID, items);
+                auto round_collected = clock::now();
+                walked = inventory.walk();
+                auto round_walked = clock::now();
+                collect_seconds += std::chrono::duration<F64>(round_collected - round_start).count();
+                walk_seconds += std::chrono::duration<F64>(round_walked - round_collected).count();
+            }
+            collected = (U32)items.size();
+
+            std::cout << "\n" << name << ", " << FOLDERS << " folders / " << ITEMS << " items:\n"
+                      << "  fill         " << std::chrono::duration<F64, std::milli>(filled - start).count() << " ms\n"
+                      << "  descendents  " << collect_seconds * 1000.0 / ROUNDS << " ms\n"
+                      << "  full walk    " << walk_seconds * 1000.0 / ROUNDS << " ms" << std::endl;
+        }
+    }
+
+    template<> template<>
+    void LLUUIDHashMap_object_t::test<4>()
+    {
+        set_test_name("inventory walk benchmark");
+
+        skip_unless_benchmarks();
+        U32 std_collected, std_walked;
+        run_inventory_benchmark<Inventory<StdMap, HeapItem> >("std::map", std_collected, std_walked);
+        U32 hash_collected, hash_walked;
+        run_inventory_benchmark<Inventory<LLUUIDHashMap, HeapItem> >("LLUUIDHashMap", hash_collected, hash_walked);
+        U32 pool_collected, pool_walked;
+        run_inventory_benchmark<Inventory<LLUUIDHashMap, PooledItem> >("LLUUIDHashMap, slab items", pool_collected, pool_walked);
+
+        ensure_equals("same descendents", hash_collected, std_collected);
+        ensure_equals("same walk", hash_walked, std_walked);
+        ensure_equals("same descendents from slabs", pool_collected, std_collected);
+        ensure_equals("same walk from slabs", pool_walked, std_walked);
+        ensure_equals("slab items freed", PooledItem::getPool().getLiveCount(), size_t(0));
+    }
+}
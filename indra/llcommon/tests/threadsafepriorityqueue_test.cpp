@@ -0,0 +1,316 @@
+/**
+ * @file   threadsafepriorityqueue_test.cpp
+ * @brief  Test for threadsafepriorityqueue and WorkPriorityQueue, with a
+ *         simulated camera spin benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "threadsafepriorityqueue.h"
+// STL headers
+#include <algorithm>
+#include <atomic>
+#include <vector>
+// std headers
+#include <chrono>
+#include <iostream>
+#include <thread>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "stringize.h"
+#include "threadpool.h"
+#include "workqueue.h"
+
+using namespace std::literals::string_literals; // s suffix
+using Queue = LL::ThreadSafePriorityQueue<U32, std::string>;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // A texture request: a cache read or decode stand in
+    void busy_wait(std::chrono::microseconds duration)
+    {
+        auto until = Clock::now() + duration;
+        while (Clock::now() < until)
+        {
+        }
+    }
+
+    struct SpinResult
+    {
+        F64 mMeanMs = 0.0;
+        F64 mP95Ms = 0.0;
+        S32 mInView = 0;    // visible textures that got their pixels while still in view
+        S32 mVisible = 0;
+    };
+
+    /**
+     * The camera spins: each frame some textures come into view and get
+     * requested, the ones requested a while ago leave the view again, with
+     * a backlog of requests from where the camera looked before. Measures
+     * the time from a texture coming into view to its request being done.
+     */
+    template <typename QUEUE, typename POST, typename UPDATE>
+    SpinResult camera_spin(const std::string& name, POST&& post, UPDATE&& update)
+    {
+        constexpr S32 STALE = 4000;
+        constexpr S32 FRAMES = 60;
+        constexpr S32 PER_FRAME = 40;
+        constexpr S32 FRAMES_IN_VIEW = 10;
+        constexpr auto WORK = std::chrono::microseconds(25);
+        constexpr auto FRAME = std::chrono::milliseconds(4);
+
+        const S32 total = STALE + FRAMES * PER_FRAME;
+        std::vector<Clock::time_point> posted(total + 1);
+        std::vector<Clock::time_point> done(total + 1);
+        std::atomic<S32> remaining{ total };
+
+        LL::ThreadPoolUsing<QUEUE> pool(name, 2, 1024 * 1024, false);
+        QUEUE& queue = pool.getQueue();
+
+        auto request = [&](U32 key, F32 priority)
+        {
+            posted[key] = Clock::now();
+            post(queue, [&, key]()
+                {
+                    busy_wait(WORK);
+                    done[key] = Clock::now();
+                    --remaining;
+                }, priority, key);
+        };
+
+        // keys start at 1, 0 is "no key"
+        U32 key = 1;
+        for (S32 i = 0; i < STALE; ++i)
+        {
+            request(key++, 1.f);
+        }
+        pool.start();
+
+        const U32 first_visible = key;
+        auto frame_start = Clock::now();
+        for (S32 frame = 0; frame < FRAMES; ++frame)
+        {
+            for (S32 i = 0; i < PER_FRAME; ++i)
+            {
+                request(key++, 1000.f);
+            }
+            if (frame >= FRAMES_IN_VIEW)
+            {
+                U32 gone = first_visible + (frame - FRAMES_IN_VIEW) * PER_FRAME;
+                for (S32 i = 0; i < PER_FRAME; ++i)
+                {
+                    update(queue, gone + i, 1.f);
+                }
+            }
+            frame_start += FRAME;
+            std::this_thread::sleep_until(frame_start);
+        }
+        while (remaining > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        pool.close();
+
+        SpinResult result;
+        std::vector<F64> latencies;
+        for (U32 k = first_visible; k < key; ++k)
+        {
+            S32 frame = (S32)(k - first_visible) / PER_FRAME;
+            auto left_view = posted[first_visible + frame * PER_FRAME] + FRAMES_IN_VIEW * FRAME;
+            F64 latency = std::chrono::duration<F64, std::milli>(done[k] - posted[k]).count();
+            latencies.push_back(latency);
+            result.mInView += done[k] <= left_view;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        for (F64 latency : latencies)
+        {
+            result.mMeanMs += latency;
+        }
+        result.mVisible = (S32)latencies.size();
+        result.mMeanMs /= latencies.size();
+        result.mP95Ms = latencies[latencies.size() * 95 / 100];
+        return result;
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct threadsafepriorityqueue_data
+    {
+        Queue queue;
+    };
+    typedef test_group<threadsafepriorityqueue_data> threadsafepriorityqueue_group;
+    typedef threadsafepriorityqueue_group::object object;
+    threadsafepriorityqueue_group threadsafepriorityqueuegrp("threadsafepriorityqueue");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("priority order, FIFO among equals");
+        queue.push(Queue::PriorityTuple(1.f, 1, "low"s));
+        queue.push(Queue::PriorityTuple(5.f, 2, "first"s));
+        queue.push(Queue::PriorityTuple(5.f, 3, "second"s));
+        queue.push(Queue::PriorityTuple(9.f, 0, "high, no key"s));
+        queue.push(Queue::PriorityTuple(5.f, 4, "third"s));
+        queue.close();
+        ensure_equals(std::get<2>(queue.pop()), "high, no key"s);
+        ensure_equals(std::get<2>(queue.pop()), "first"s);
+        ensure_equals(std::get<2>(queue.pop()), "second"s);
+        ensure_equals(std::get<2>(queue.pop()), "third"s);
+        ensure_equals(std::get<2>(queue.pop()), "low"s);
+        ensure("queue not done", queue.done());
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("updatePriority");
+        for (U32 key = 1; key <= 10; ++key)
+        {
+            queue.push(Queue::PriorityTuple((F32)key, key, stringize(key)));
+        }
+        ensure("raise", queue.updatePriority(3, 100.f));
+        ensure("lower", queue.updatePriority(10, 0.f));
+        ensure("unknown key", !queue.updatePriority(42, 1.f));
+
+        Queue::PriorityTuple item;
+        ensure(queue.tryPop(item));
+        ensure_equals("raised first", std::get<2>(item), "3"s);
+        ensure("popped key is forgotten", !queue.updatePriority(3, 1.f));
+        ensure(queue.tryPop(item));
+        ensure_equals("then the rest", std::get<2>(item), "9"s);
+        for (S32 i = 0; i < 7; ++i)
+        {
+            ensure(queue.tryPop(item));
+        }
+        ensure_equals("lowered last", std::get<2>(item), "10"s);
+        ensure("empty", !queue.tryPop(item));
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("a pushed again key moves the newest item");
+        queue.push(Queue::PriorityTuple(1.f, 7, "old"s));
+        queue.push(Queue::PriorityTuple(2.f, 8, "other"s));
+        queue.push(Queue::PriorityTuple(1.f, 7, "new"s));
+        ensure(queue.updatePriority(7, 3.f));
+        Queue::PriorityTuple item;
+        ensure(queue.tryPop(item));
+        ensure_equals(std::get<2>(item), "new"s);
+        ensure(queue.tryPop(item));
+        ensure_equals(std::get<2>(item), "other"s);
+        ensure("old item not indexed", !queue.contains(7));
+        ensure(queue.tryPop(item));
+        ensure_equals(std::get<2>(item), "old"s);
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("random updates match a sorted reference");
+        Queue big(100000);
+        std::vector<F32> priority(2001, 0.f);
+        U32 seed = 42;
+        auto next = [&seed]() { seed = seed * 1664525 + 1013904223; return seed >> 8; };
+        for (U32 key = 1; key <= 2000; ++key)
+        {
+            priority[key] = (F32)(next() % 1000);
+            big.push(Queue::PriorityTuple(priority[key], key, std::string()));
+        }
+        for (S32 i = 0; i < 5000; ++i)
+        {
+            U32 key = next() % 2000 + 1;
+            priority[key] = (F32)(next() % 1000);
+            ensure(big.updatePriority(key, priority[key]));
+        }
+        F32 last = std::numeric_limits<F32>::max();
+        Queue::PriorityTuple item;
+        for (S32 i = 0; i < 2000; ++i)
+        {
+            ensure(big.tryPop(item));
+            ensure("descending", std::get<0>(item) <= last);
+            ensure_equals("current priority", std::get<0>(item), priority[std::get<1>(item)]);
+            last = std::get<0>(item);
+        }
+        ensure("empty", !big.tryPop(item));
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("WorkPriorityQueue in a ThreadPool");
+        LL::ThreadPoolUsing<LL::WorkPriorityQueue> pool("priority pool", 1, 1024, false);
+        LL::WorkPriorityQueue& work = pool.getQueue();
+        std::vector<S32> order;
+        // queued before the thread starts, so the queue decides the order
+        work.post([&]() { order.push_back(1); }, 1.f, 1);
+        work.post([&]() { order.push_back(2); }, 2.f, 2);
+        work.post([&]() { order.push_back(3); }, 3.f, 3);
+        work.post([&]() { order.push_back(0); });
+        ensure(work.updatePriority(1, 10.f));
+        pool.start();
+        pool.close();
+        ensure_equals("all ran", order.size(), (size_t)4);
+        ensure_equals("no priority first", order[0], 0);
+        ensure_equals("raised next", order[1], 1);
+        ensure_equals("then by priority", order[2], 3);
+        ensure_equals("lowest last", order[3], 2);
+    }
+
+    template<> template<>
+    void object::test<6>()
+    {
+        set_test_name("time to first pixel during a camera spin");
+
+        skip_unless_benchmarks();
+
+        SpinResult fifo = camera_spin<LL::WorkQueue>("spin fifo",
+            [](LL::WorkQueue& queue, const LL::WorkQueue::Work& work, F32, U32) { queue.post(work); },
+            [](LL::WorkQueue&, U32, F32) {});
+        SpinResult prioritized = camera_spin<LL::WorkPriorityQueue>("spin priority",
+            [](LL::WorkPriorityQueue& queue, const LL::WorkQueue::Work& work, F32 priority, U32 key) { queue.post(work, priority, key); },
+            [](LL::WorkPriorityQueue& queue, U32 key, F32 priority) { queue.updatePriority(key, priority); });
+
+        auto print = [](const char* name, const SpinResult& result)
+        {
+            std::cout << "\n  " << name << ": mean " << result.mMeanMs << " ms, p95 " << result.mP95Ms
+                      << " ms, " << result.mInView << "/" << result.mVisible << " done while in view";
+        };
+        std::cout << "\nNewly visible texture requests behind a 4000 request backlog:";
+        print("FIFO WorkQueue    ", fifo);
+        print("WorkPriorityQueue ", prioritized);
+        std::cout << std::endl;
+
+        ensure("prioritized requests overtake the backlog", prioritized.mMeanMs < fifo.mMeanMs);
+    }
+} // namespace tut
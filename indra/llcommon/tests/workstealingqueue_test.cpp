@@ -0,0 +1,398 @@
+/**
+ * @file   workstealingqueue_test.cpp
+ * @brief  Test for the work-stealing containers and WorkStealingQueue, with
+ *         a throughput and latency comparison against the locked WorkQueue.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "workstealingdeque.h"
+// STL headers
+#include <algorithm>
+#include <atomic>
+#include <vector>
+// std headers
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "threadpool.h"
+#include "workqueue.h"
+
+using Deque = LL::WorkStealingPrivate::ChaseLevDeque<U32*>;
+using Ring = LL::WorkStealingPrivate::InjectionRing<U32>;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct PoolResult
+    {
+        F64 mJobsPerSecond = 0.0;
+        F64 mP50Us = 0.0;
+        F64 mP99Us = 0.0;
+    };
+
+    /**
+     * The main thread posts small jobs in per frame bursts, the way mesh
+     * LOD processing and image decode get fed. Measures throughput and the
+     * time from post() to a worker starting the job.
+     */
+    template <typename POOL>
+    PoolResult run_pool(const std::string& name, size_t threads)
+    {
+        constexpr U32 JOBS = 100000;
+        constexpr U32 BURST = 2000;
+        std::vector<Clock::time_point> posted(JOBS);
+        std::vector<Clock::time_point> started(JOBS);
+        std::atomic<U32> remaining{ JOBS };
+
+        POOL pool(name, threads, 1024 * 1024, false);
+        pool.start();
+        auto& queue = pool.getQueue();
+
+        auto begin = Clock::now();
+        for (U32 job = 0; job < JOBS; ++job)
+        {
+            posted[job] = Clock::now();
+            queue.post([&, job]()
+                {
+                    started[job] = Clock::now();
+                    // a few hundred nanoseconds of work
+                    volatile U32 sink = job;
+                    for (S32 i = 0; i < 200; ++i)
+                    {
+                        sink = sink * 1664525 + 1013904223;
+                    }
+                    --remaining;
+                });
+            if (job % BURST == BURST - 1)
+            {
+                // the rest of the frame
+                while (remaining > JOBS - job - 1 + BURST / 2)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        while (remaining > 0)
+        {
+            std::this_thread::yield();
+        }
+        F64 seconds = std::chrono::duration<F64>(Clock::now() - begin).count();
+        pool.close();
+
+        std::vector<F64> latencies(JOBS);
+        for (U32 job = 0; job < JOBS; ++job)
+        {
+            latencies[job] = std::chrono::duration<F64, std::micro>(started[job] - posted[job]).count();
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        PoolResult result;
+        result.mJobsPerSecond = JOBS / seconds;
+        result.mP50Us = latencies[JOBS / 2];
+        result.mP99Us = latencies[JOBS * 99 / 100];
+        return result;
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct workstealingqueue_data
+    {
+    };
+    typedef test_group<workstealingqueue_data> workstealingqueue_group;
+    typedef workstealingqueue_group::object object;
+    workstealingqueue_group workstealingqueuegrp("workstealingqueue");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("Chase-Lev deque ends and growth");
+        std::vector<U32> items(1000);
+        Deque deque(4);
+        ensure("starts empty", deque.empty());
+        ensure("pop empty", deque.pop() == nullptr);
+        ensure("steal empty", deque.steal() == nullptr);
+        for (U32 i = 0; i < items.size(); ++i)
+        {
+            items[i] = i;
+            deque.push(&items[i]);
+        }
+        ensure_equals("owner pops newest", *deque.pop(), 999u);
+        ensure_equals("thief steals oldest", *deque.steal(), 0u);
+        for (U32 i = 1; i < 999; ++i)
+        {
+            ensure_equals("grown ring keeps order", *deque.steal(), i);
+        }
+        ensure("drained", deque.empty() && deque.pop() == nullptr);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("Chase-Lev deque under concurrent stealing");
+        constexpr U32 ITEMS = 200000;
+        std::vector<U32> items(ITEMS);
+        std::vector<std::atomic<U32>> taken(ITEMS);
+        Deque deque;
+        std::atomic<bool> pushing{ true };
+
+        auto take = [&](U32* item) { ++taken[item - items.data()]; };
+        std::vector<std::thread> thieves;
+        for (S32 t = 0; t < 3; ++t)
+        {
+            thieves.emplace_back([&]()
+                {
+                    while (pushing || !deque.empty())
+                    {
+                        if (U32* item = deque.steal())
+                        {
+                            take(item);
+                        }
+                    }
+                });
+        }
+        for (U32 i = 0; i < ITEMS; ++i)
+        {
+            deque.push(&items[i]);
+            // the owner keeps some of its own work
+            if (i % 3 == 0)
+            {
+                if (U32* item = deque.pop())
+                {
+                    take(item);
+                }
+            }
+        }
+        while (U32* item = deque.pop())
+        {
+            take(item);
+        }
+        pushing = false;
+        for (auto& thief : thieves)
+        {
+            thief.join();
+        }
+        for (U32 i = 0; i < ITEMS; ++i)
+        {
+            ensure_equals("taken exactly once", taken[i].load(), 1u);
+        }
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("injection ring, many producers and consumers");
+        {
+            Ring small(3);
+            ensure_equals("rounded up", small.capacity(), (size_t)4);
+            for (U32 i = 0; i < 4; ++i)
+            {
+                ensure("room", small.tryPush(i));
+            }
+            ensure("full", !small.tryPush(4u));
+            U32 value;
+            ensure(small.tryPop(value));
+            ensure_equals("FIFO", value, 0u);
+        }
+
+        constexpr U32 PER_PRODUCER = 50000;
+        constexpr U32 PRODUCERS = 4;
+        Ring ring(1024);
+        std::vector<std::atomic<U32>> seen(PER_PRODUCER * PRODUCERS);
+        std::atomic<U32> consumed{ 0 };
+        std::vector<std::thread> threads;
+        for (U32 p = 0; p < PRODUCERS; ++p)
+        {
+            threads.emplace_back([&, p]()
+                {
+                    for (U32 i = 0; i < PER_PRODUCER; ++i)
+                    {
+                        while (!ring.tryPush(p * PER_PRODUCER + i))
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+        }
+        for (U32 c = 0; c < 4; ++c)
+        {
+            threads.emplace_back([&]()
+                {
+                    U32 value;
+                    while (consumed < PER_PRODUCER * PRODUCERS)
+                    {
+                        if (ring.tryPop(value))
+                        {
+                            ++seen[value];
+                            ++consumed;
+                        }
+                    }
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        for (auto& count : seen)
+        {
+            ensure_equals("popped exactly once", count.load(), 1u);
+        }
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("WorkStealingQueue runs all work, nested posts are stolen");
+        constexpr U32 OUTER = 2000;
+        constexpr U32 INNER = 20;
+        std::atomic<U32> ran{ 0 };
+        std::vector<std::atomic<U32>> ran_on(4);
+        {
+            LL::WorkStealingThreadPool pool("stealing", 4, 1024 * 1024, false);
+            LL::WorkStealingQueue& queue = pool.getQueue();
+            pool.start();
+            for (U32 i = 0; i < OUTER; ++i)
+            {
+                ensure("posted", queue.post([&]()
+                    {
+                        for (U32 j = 0; j < INNER; ++j)
+                        {
+                            // posted from a worker: goes to its own deque
+                            queue.post([&]() { ++ran; });
+                        }
+                        ++ran;
+                    }));
+            }
+            while (ran < OUTER * (INNER + 1))
+            {
+                std::this_thread::yield();
+            }
+            ensure_equals("drained", queue.size(), (size_t)0);
+            pool.close();
+            ensure("closed", queue.done());
+            ensure("no post after close", !queue.post([]() {}));
+            ensure("no tryPost after close", !queue.tryPost([]() {}));
+        }
+        ensure_equals("all ran", ran.load(), OUTER * (INNER + 1));
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("close drains queued work");
+        std::atomic<U32> ran{ 0 };
+        LL::WorkStealingThreadPool pool("drain", 2, 1024, false);
+        LL::WorkStealingQueue& queue = pool.getQueue();
+        for (U32 i = 0; i < 500; ++i)
+        {
+            queue.post([&]() { ++ran; });
+        }
+        pool.start();
+        pool.close();
+        ensure_equals("queued work ran before the threads quit", ran.load(), 500u);
+    }
+
+    template<> template<>
+    void object::test<6>()
+    {
+        set_test_name("capacity");
+        LL::WorkStealingQueue queue("tiny", 2);
+        ensure("first", queue.tryPost([]() {}));
+        ensure("second", queue.tryPost([]() {}));
+        ensure("full", !queue.tryPost([]() {}));
+        ensure("runs one", queue.runOne());
+        ensure("room again", queue.tryPost([]() {}));
+        ensure_equals("size", queue.size(), (size_t)2);
+        queue.close();
+        ensure("not done", !queue.done());
+        queue.runPending();
+        ensure("done", queue.done());
+    }
+
+    template<> template<>
+    void object::test<7>()
+    {
+        set_test_name("parallel_for runs every index once");
+        constexpr size_t COUNT = 10000;
+        std::vector<std::atomic<U32>> ran(COUNT);
+        {
+            LL::ThreadPool pool("parallel", 4, 1024, false);
+            pool.start();
+            LL::parallel_for(pool, COUNT, [&ran](size_t i) { ++ran[i]; });
+            ensure("every index once", std::all_of(ran.begin(), ran.end(),
+                                                   [](const std::atomic<U32>& n) { return n == 1; }));
+            LL::parallel_for(pool, 0, [](size_t) { ensure("called for an empty range", false); });
+            // fewer helpers than threads, and none at all
+            LL::parallel_for(pool, COUNT, [&ran](size_t i) { ++ran[i]; }, 1);
+            LL::parallel_for(pool, COUNT, [&ran](size_t i) { ++ran[i]; }, 0);
+            ensure("every index three times", std::all_of(ran.begin(), ran.end(),
+                                                          [](const std::atomic<U32>& n) { return n == 3; }));
+            pool.close();
+        }
+        // no pool by that name: the calling thread does all of it
+        std::thread::id caller = std::this_thread::get_id();
+        size_t serial = 0;
+        LL::parallel_for("no such pool", COUNT, [&](size_t i)
+            {
+                ensure("on the calling thread", std::this_thread::get_id() == caller);
+                ensure_equals("in order", i, serial++);
+            });
+        ensure_equals("serial count", serial, COUNT);
+    }
+
+    template<> template<>
+    void object::test<8>()
+    {
+        set_test_name("jobs/sec and post-to-start latency, WorkQueue vs WorkStealingQueue");
+
+        skip_unless_benchmarks();
+        std::cout << "\n100000 small jobs posted from one thread in bursts of 2000:"
+                  << "\n  threads   pool        jobs/s      p50 us     p99 us";
+        auto print = [](size_t threads, const char* name, const PoolResult& result)
+        {
+            std::cout << "\n  " << std::setw(7) << threads << "   " << std::left << std::setw(10) << name
+                      << std::right << std::fixed << std::setprecision(0)
+                      << std::setw(10) << result.mJobsPerSecond
+                      << std::setprecision(1) << std::setw(11) << result.mP50Us
+                      << std::setw(11) << result.mP99Us;
+        };
+        for (size_t threads : { 1, 2, 4, 8, 16, 32 })
+        {
+            print(threads, "locked", run_pool<LL::ThreadPool>("bench locked", threads));
+            print(threads, "stealing", run_pool<LL::WorkStealingThreadPool>("bench stealing", threads));
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+} // namespace tut
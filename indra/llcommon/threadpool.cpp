@@ -14,7 +14,10 @@
 // associated header
 #include "threadpool.h"
 // STL headers
+#include <algorithm>
+#include <atomic>
 // std headers
+#include <thread>
 // external library headers
 // other Linden headers
 #include "commoncontrol.h"
@@ -206,3 +209,71 @@ size_t LL::ThreadPoolBase::getWidth(const std::string& name, size_t dft)
         return getConfiguredWidth(name, dft);
     }
 }
+
+namespace
+{
+    // Shared by the calling thread and the tasks helping it, so a task that
+    // starts late still has a counter to look at
+    struct ParallelFor
+    {
+        const std::function<void(size_t)>* mFunc = nullptr;
+        size_t mCount = 0;
+        std::atomic<size_t> mNext{ 0 };
+        std::atomic<size_t> mDone{ 0 };
+
+        void run()
+        {
+            for (size_t i = mNext++; i < mCount; i = mNext++)
+            {
+                (*mFunc)(i);
+                ++mDone;
+            }
+        }
+    };
+} // anonymous namespace
+
+void LL::parallel_for(ThreadPoolBase& pool, size_t count,
+                      const std::function<void(size_t)>& func, size_t max_helpers)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    auto batch = std::make_shared<ParallelFor>();
+    batch->mFunc = &func;
+    batch->mCount = count;
+
+    // the calling thread takes a share too
+    const size_t helpers = std::min({ pool.getWidth(), count - 1, max_helpers });
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        // a full queue leaves the rest to the threads already on it
+        if (!pool.mQueue->tryPost([batch]() { batch->run(); }))
+        {
+            break;
+        }
+    }
+    batch->run();
+    while (batch->mDone < count)
+    {
+        // whatever is still out was already started, and is nearly done
+        std::this_thread::yield();
+    }
+}
+
+void LL::parallel_for(const std::string& pool, size_t count,
+                      const std::function<void(size_t)>& func, size_t max_helpers)
+{
+    if (auto instance{ ThreadPoolBase::getInstance(pool) })
+    {
+        parallel_for(*instance, count, func, max_helpers);
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            func(i);
+        }
+    }
+}
@@ -15,6 +15,8 @@
 
 #include "threadpool_fwd.h"
 #include "workqueue.h"
+#include <functional>
+#include <limits>
 #include <memory>                   // std::unique_ptr
 #include <string>
 #include <thread>
@@ -86,6 +88,9 @@ namespace LL
         size_t getWidth(const std::string& name, size_t dft);
 
     protected:
+        friend void parallel_for(ThreadPoolBase& pool, size_t count,
+                                 const std::function<void(size_t)>& func, size_t max_helpers);
+
         std::unique_ptr<WorkQueueBase> mQueue;
         std::vector<std::pair<std::string, std::thread>> mThreads;
         bool mAutomaticShutdown;
@@ -98,7 +103,8 @@ namespace LL
     };
 
     /**
-     * Specialize with WorkQueue or, for timestamped tasks, WorkSchedule
+     * Specialize with WorkQueue or, for timestamped tasks, WorkSchedule, or,
+     * for many small independent tasks, WorkStealingQueue
      */
     template <class QUEUE>
     struct ThreadPoolUsing: public ThreadPoolBase
@@ -136,6 +142,29 @@ namespace LL
     /// ThreadPool is shorthand for using the simpler WorkQueue
     using ThreadPool = ThreadPoolUsing<WorkQueue>;
 
+    /// for many small, independent tasks
+    using WorkStealingThreadPool = ThreadPoolUsing<WorkStealingQueue>;
+
+    /**
+     * Calls func(i) for every i in [0, count). The calling thread and up to
+     * max_helpers tasks posted to the pool each take the next index until
+     * none are left, so there is never more than one helper less than there
+     * are indices. Returns once every call has returned. A task that only
+     * starts after that finds nothing left and never touches func, which
+     * can therefore refer to the caller's locals.
+     */
+    void parallel_for(ThreadPoolBase& pool, size_t count,
+                      const std::function<void(size_t)>& func,
+                      size_t max_helpers = std::numeric_limits<size_t>::max());
+
+    /**
+     * The same, with the pool looked up by name. Without such a pool the
+     * calling thread does all of it.
+     */
+    void parallel_for(const std::string& pool, size_t count,
+                      const std::function<void(size_t)>& func,
+                      size_t max_helpers = std::numeric_limits<size_t>::max());
+
 } // namespace LL
 
 #endif /* ! defined(LL_THREADPOOL_H) */
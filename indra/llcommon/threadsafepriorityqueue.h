@@ -0,0 +1,246 @@
+/**
+ * @file   threadsafepriorityqueue.h
+ * @brief  ThreadSafePriorityQueue is an LLThreadSafeQueue that pops the
+ *         highest priority item first, and whose items can be
+ *         re-prioritized while queued.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_THREADSAFEPRIORITYQUEUE_H)
+#define LL_THREADSAFEPRIORITYQUEUE_H
+
+#include "llthreadsafequeue.h"
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace LL
+{
+    namespace ThreadSafePriorityQueuePrivate
+    {
+        /**
+         * Binary max-heap of (priority, key, value) tuples that also keeps a
+         * key -> heap slot index, so a queued item can be re-prioritized in
+         * O(log n). Items with equal priority pop in the order they were
+         * pushed. Items pushed with a default constructed KEY are not
+         * indexed and keep their priority. Pushing a key that is already
+         * queued indexes the new item, the older one keeps its priority.
+         *
+         * Presents the std::queue subset LLThreadSafeQueue uses.
+         */
+        template <typename KEY, typename T>
+        class KeyedHeap
+        {
+        public:
+            typedef std::tuple<F32, KEY, T> value_type;
+            typedef size_t                  size_type;
+            typedef const value_type&       const_reference;
+
+            const_reference front() const { return mHeap.front().mItem; }
+            bool empty() const            { return mHeap.empty(); }
+            size_type size() const        { return mHeap.size(); }
+
+            void push(const value_type& value) { emplace(value); }
+            void push(value_type&& value)      { emplace(std::move(value)); }
+
+            void pop()
+            {
+                unindex(mHeap.front());
+                if (mHeap.size() > 1)
+                {
+                    mHeap.front() = std::move(mHeap.back());
+                    mHeap.pop_back();
+                    siftDown(0);
+                }
+                else
+                {
+                    mHeap.pop_back();
+                }
+            }
+
+            // Returns false if nothing with that key is queued
+            bool update(const KEY& key, F32 priority)
+            {
+                auto found = mIndex.find(key);
+                if (found == mIndex.end())
+                {
+                    return false;
+                }
+                size_t slot = found->second;
+                F32& current = std::get<0>(mHeap[slot].mItem);
+                if (priority > current)
+                {
+                    current = priority;
+                    siftUp(slot);
+                }
+                else if (priority < current)
+                {
+                    current = priority;
+                    siftDown(slot);
+                }
+                return true;
+            }
+
+            bool contains(const KEY& key) const { return mIndex.find(key) != mIndex.end(); }
+
+        private:
+            struct Entry
+            {
+                value_type mItem;
+                U64        mSequence;
+                bool       mIndexed;
+            };
+
+            template <typename V>
+            void emplace(V&& value)
+            {
+                mHeap.push_back(Entry{ std::forward<V>(value), mNextSequence++, false });
+                Entry& entry = mHeap.back();
+                const KEY& key = std::get<1>(entry.mItem);
+                if (key != KEY())
+                {
+                    auto found = mIndex.find(key);
+                    if (found != mIndex.end())
+                    {
+                        mHeap[found->second].mIndexed = false;
+                    }
+                    entry.mIndexed = true;
+                    mIndex[key] = mHeap.size() - 1;
+                }
+                siftUp(mHeap.size() - 1);
+            }
+
+            // true if a pops before b
+            static bool before(const Entry& a, const Entry& b)
+            {
+                F32 pa = std::get<0>(a.mItem);
+                F32 pb = std::get<0>(b.mItem);
+                return pa > pb || (pa == pb && a.mSequence < b.mSequence);
+            }
+
+            void place(size_t slot, Entry&& entry)
+            {
+                mHeap[slot] = std::move(entry);
+                if (mHeap[slot].mIndexed)
+                {
+                    mIndex[std::get<1>(mHeap[slot].mItem)] = slot;
+                }
+            }
+
+            void unindex(const Entry& entry)
+            {
+                if (entry.mIndexed)
+                {
+                    mIndex.erase(std::get<1>(entry.mItem));
+                }
+            }
+
+            void siftUp(size_t slot)
+            {
+                Entry entry = std::move(mHeap[slot]);
+                while (slot > 0)
+                {
+                    size_t parent = (slot - 1) / 2;
+                    if (!before(entry, mHeap[parent]))
+                    {
+                        break;
+                    }
+                    place(slot, std::move(mHeap[parent]));
+                    slot = parent;
+                }
+                place(slot, std::move(entry));
+            }
+
+            void siftDown(size_t slot)
+            {
+                const size_t count = mHeap.size();
+                Entry entry = std::move(mHeap[slot]);
+                while (true)
+                {
+                    size_t child = slot * 2 + 1;
+                    if (child >= count)
+                    {
+                        break;
+                    }
+                    if (child + 1 < count && before(mHeap[child + 1], mHeap[child]))
+                    {
+                        ++child;
+                    }
+                    if (!before(mHeap[child], entry))
+                    {
+                        break;
+                    }
+                    place(slot, std::move(mHeap[child]));
+                    slot = child;
+                }
+                place(slot, std::move(entry));
+            }
+
+            std::vector<Entry> mHeap;
+            std::unordered_map<KEY, size_t> mIndex;
+            U64 mNextSequence = 0;
+        };
+    } // namespace ThreadSafePriorityQueuePrivate
+
+    /**
+     * ThreadSafePriorityQueue is an LLThreadSafeQueue of (priority, key,
+     * value) tuples that pops the highest priority first, FIFO among equal
+     * priorities. updatePriority() moves a still queued item in O(log n),
+     * so a producer can promote work that became urgent instead of letting
+     * it wait behind everything queued before it.
+     */
+    template <typename KEY, typename T>
+    class ThreadSafePriorityQueue:
+        public LLThreadSafeQueue<std::tuple<F32, KEY, T>,
+                                 ThreadSafePriorityQueuePrivate::KeyedHeap<KEY, T>>
+    {
+    private:
+        using super = LLThreadSafeQueue<std::tuple<F32, KEY, T>,
+                                        ThreadSafePriorityQueuePrivate::KeyedHeap<KEY, T>>;
+        using lock_t = typename super::lock_t;
+
+    public:
+        using PriorityTuple = std::tuple<F32, KEY, T>;
+
+        ThreadSafePriorityQueue(size_t capacity=1024):
+            super(capacity)
+        {}
+
+        /// Returns false if nothing with that key is queued any more
+        bool updatePriority(const KEY& key, F32 priority)
+        {
+            LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+            lock_t lock(super::mLock);
+            return super::mStorage.update(key, priority);
+        }
+
+        bool contains(const KEY& key)
+        {
+            lock_t lock(super::mLock);
+            return super::mStorage.contains(key);
+        }
+    };
+} // namespace LL
+
+#endif /* ! defined(LL_THREADSAFEPRIORITYQUEUE_H) */
@@ -14,7 +14,9 @@
 // associated header
 #include "workqueue.h"
 // STL headers
+#include <algorithm>
 // std headers
+#include <thread>
 // external library headers
 // other Linden headers
 #include "llapp.h"
@@ -320,3 +322,349 @@ bool LL::WorkSchedule::tryPop_(Work& work)
 {
     return mQueue.tryPop(work);
 }
+
+/*****************************************************************************
+*   WorkPriorityQueue
+*****************************************************************************/
+LL::WorkPriorityQueue::WorkPriorityQueue(const std::string& name, size_t capacity):
+    super(name),
+    mQueue(capacity)
+{
+}
+
+void LL::WorkPriorityQueue::close()
+{
+    mQueue.close();
+}
+
+size_t LL::WorkPriorityQueue::size()
+{
+    return mQueue.size();
+}
+
+bool LL::WorkPriorityQueue::isClosed()
+{
+    return mQueue.isClosed();
+}
+
+bool LL::WorkPriorityQueue::done()
+{
+    return mQueue.done();
+}
+
+bool LL::WorkPriorityQueue::post(const Work& callable)
+{
+    return post(callable, DEFAULT_PRIORITY);
+}
+
+bool LL::WorkPriorityQueue::post(const Work& callable, F32 priority, Key key)
+{
+    return mQueue.pushIfOpen(Queue::PriorityTuple(priority, key, callable));
+}
+
+bool LL::WorkPriorityQueue::tryPost(const Work& callable)
+{
+    return tryPost(callable, DEFAULT_PRIORITY);
+}
+
+bool LL::WorkPriorityQueue::tryPost(const Work& callable, F32 priority, Key key)
+{
+    return mQueue.tryPush(Queue::PriorityTuple(priority, key, callable));
+}
+
+bool LL::WorkPriorityQueue::updatePriority(Key key, F32 priority)
+{
+    return mQueue.updatePriority(key, priority);
+}
+
+LL::WorkPriorityQueue::Work LL::WorkPriorityQueue::pop_()
+{
+    return std::get<2>(mQueue.pop());
+}
+
+bool LL::WorkPriorityQueue::tryPop_(Work& work)
+{
+    Queue::PriorityTuple item;
+    if (!mQueue.tryPop(item))
+    {
+        return false;
+    }
+    work = std::move(std::get<2>(item));
+    return true;
+}
+
+/*****************************************************************************
+*   WorkStealingQueue
+*****************************************************************************/
+namespace
+{
+    // 0 is never a queue serial number
+    std::atomic<U64> sWorkStealingSerial{ 0 };
+
+    // The WorkStealingQueue, if any, whose pop_() the calling thread serves
+    struct WorkStealingWorker
+    {
+        U64 mSerial = 0;
+        S32 mIndex = -1;
+    };
+    thread_local WorkStealingWorker sWorkStealingWorker;
+
+    // How many times an idle worker looks around before going to sleep
+    constexpr S32 WORK_STEALING_SPINS = 64;
+} // anonymous namespace
+
+LL::WorkStealingQueue::WorkStealingQueue(const std::string& name, size_t capacity):
+    super(name),
+    mCapacity(capacity),
+    mSerial(++sWorkStealingSerial),
+    mInjection(std::min(capacity, MAX_INJECTION_SLOTS))
+{
+    for (auto& deque : mDeques)
+    {
+        deque.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+LL::WorkStealingQueue::~WorkStealingQueue()
+{
+    for (auto& slot : mDeques)
+    {
+        Deque* deque = slot.load(std::memory_order_acquire);
+        if (deque)
+        {
+            while (Work* work = deque->steal())
+            {
+                delete work;
+            }
+            delete deque;
+        }
+    }
+}
+
+void LL::WorkStealingQueue::close()
+{
+    mClosed.store(true);
+    {
+        Lock lock(mSleepLock);
+        ++mEpoch;
+    }
+    mWake.notify_all();
+}
+
+size_t LL::WorkStealingQueue::size()
+{
+    return mPending.load();
+}
+
+bool LL::WorkStealingQueue::isClosed()
+{
+    return mClosed.load();
+}
+
+bool LL::WorkStealingQueue::done()
+{
+    return mClosed.load() && mPending.load() == 0;
+}
+
+bool LL::WorkStealingQueue::post(const Work& work)
+{
+    return post_(work, true);
+}
+
+bool LL::WorkStealingQueue::tryPost(const Work& work)
+{
+    return post_(work, false);
+}
+
+bool LL::WorkStealingQueue::post_(const Work& work, bool wait)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    size_t pending = mPending.load(std::memory_order_relaxed);
+    do
+    {
+        if (mClosed.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        if (pending >= mCapacity)
+        {
+            if (!wait)
+            {
+                return false;
+            }
+            // full: the workers are busy draining, give them the CPU
+            std::this_thread::yield();
+            pending = mPending.load(std::memory_order_relaxed);
+            continue;
+        }
+    } while (!mPending.compare_exchange_weak(pending, pending + 1));
+
+    // Counted before checking mClosed: a worker that sees the queue closed
+    // and empty can quit, as any post after that sees it closed too.
+    if (mClosed.load())
+    {
+        --mPending;
+        return false;
+    }
+    push_(work);
+    wake();
+    return true;
+}
+
+void LL::WorkStealingQueue::push_(const Work& work)
+{
+    S32 index = workerIndex();
+    if (index >= 0)
+    {
+        mDeques[index].load(std::memory_order_relaxed)->push(new Work(work));
+    }
+    else if (!mInjection.tryPush(work))
+    {
+        std::lock_guard<std::mutex> lock(mOverflowLock);
+        mOverflow.push_back(work);
+        ++mOverflowSize;
+    }
+}
+
+void LL::WorkStealingQueue::wake()
+{
+    ++mEpoch;
+    if (mSleepers.load())
+    {
+        // A worker registers as a sleeper, then checks mEpoch, both under
+        // mSleepLock. Taking the lock here means it's either still going to
+        // see the new epoch or already waiting for our notify.
+        {
+            Lock lock(mSleepLock);
+        }
+        mWake.notify_one();
+    }
+}
+
+bool LL::WorkStealingQueue::take_(Work& work)
+{
+    S32 index = workerIndex();
+    if (index >= 0)
+    {
+        // our own newest work first, it's the most likely to be in cache
+        if (Work* item = mDeques[index].load(std::memory_order_relaxed)->pop())
+        {
+            work = std::move(*item);
+            delete item;
+            --mPending;
+            return true;
+        }
+    }
+
+    if (mInjection.tryPop(work))
+    {
+        --mPending;
+        return true;
+    }
+
+    if (mOverflowSize.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(mOverflowLock);
+        if (!mOverflow.empty())
+        {
+            work = std::move(mOverflow.front());
+            mOverflow.pop_front();
+            --mOverflowSize;
+            --mPending;
+            return true;
+        }
+    }
+
+    // Steal the oldest work of another worker, starting with our neighbour
+    // so thieves spread out over their victims.
+    U32 workers = std::min(mWorkerCount.load(std::memory_order_acquire), (U32)MAX_WORKERS);
+    U32 start = index >= 0 ? (U32)index + 1 : 0;
+    for (U32 i = 0; i < workers; ++i)
+    {
+        U32 victim = (start + i) % workers;
+        if ((S32)victim == index)
+        {
+            continue;
+        }
+        Deque* deque = mDeques[victim].load(std::memory_order_acquire);
+        if (!deque)
+        {
+            // still registering
+            continue;
+        }
+        if (Work* item = deque->steal())
+        {
+            work = std::move(*item);
+            delete item;
+            --mPending;
+            return true;
+        }
+    }
+    return false;
+}
+
+S32 LL::WorkStealingQueue::workerIndex() const
+{
+    return sWorkStealingWorker.mSerial == mSerial ? sWorkStealingWorker.mIndex : -1;
+}
+
+void LL::WorkStealingQueue::registerWorker()
+{
+    U32 slot = mWorkerCount++;
+    sWorkStealingWorker.mSerial = mSerial;
+    sWorkStealingWorker.mIndex = -1;
+    if (slot < MAX_WORKERS)
+    {
+        mDeques[slot].store(new Deque(), std::memory_order_release);
+        sWorkStealingWorker.mIndex = (S32)slot;
+    }
+}
+
+LL::WorkStealingQueue::Work LL::WorkStealingQueue::pop_()
+{
+    if (sWorkStealingWorker.mSerial != mSerial)
+    {
+        registerWorker();
+    }
+
+    Work work;
+    for (;;)
+    {
+        for (S32 spin = 0; spin < WORK_STEALING_SPINS; ++spin)
+        {
+            if (take_(work))
+            {
+                return work;
+            }
+            if (done())
+            {
+                LLTHROW(Closed());
+            }
+            std::this_thread::yield();
+        }
+
+        // Nothing anywhere: sleep until something is posted. Read the epoch
+        // before the last look, so a post right after it isn't missed.
+        U64 epoch = mEpoch.load();
+        if (take_(work))
+        {
+            return work;
+        }
+        if (done())
+        {
+            LLTHROW(Closed());
+        }
+        Lock lock(mSleepLock);
+        ++mSleepers;
+        while (mEpoch.load() == epoch)
+        {
+            mWake.wait(lock);
+        }
+        --mSleepers;
+    }
+}
+
+bool LL::WorkStealingQueue::tryPop_(Work& work)
+{
+    return take_(work);
+}
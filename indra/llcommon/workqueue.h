@@ -16,10 +16,16 @@
 #include "llexception.h"
 #include "llinstancetracker.h"
 #include "llinstancetrackersubclass.h"
+#include "threadsafepriorityqueue.h"
 #include "threadsafeschedule.h"
+#include "workstealingdeque.h"
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <exception>                // std::current_exception
 #include <functional>               // std::function
+#include <limits>
+#include <mutex>
 #include <string>
 
 namespace LL
@@ -354,6 +360,165 @@ namespace LL
         bool tryPop_(Work&) override;
     };
 
+/*****************************************************************************
+*   WorkPriorityQueue: add support for prioritized, re-prioritizable tasks
+*****************************************************************************/
+    class WorkPriorityQueue: public LLInstanceTrackerSubclass<WorkPriorityQueue, WorkQueueBase>
+    {
+    private:
+        using super = LLInstanceTrackerSubclass<WorkPriorityQueue, WorkQueueBase>;
+
+    public:
+        using Key = U64;
+        using Queue = ThreadSafePriorityQueue<Key, Work>;
+
+        /// Work posted without a priority runs before any prioritized work,
+        /// in the order it was posted.
+        static constexpr F32 DEFAULT_PRIORITY = std::numeric_limits<F32>::max();
+        /// Work posted with this key can't be re-prioritized
+        static constexpr Key NO_KEY = 0;
+
+        /**
+         * You may omit the WorkPriorityQueue name, in which case a unique
+         * name is synthesized; for practical purposes that makes it anonymous.
+         */
+        WorkPriorityQueue(const std::string& name = std::string(), size_t capacity=1024);
+
+        void close() override;
+        size_t size() override;
+        /// producer end: are we prevented from pushing any additional items?
+        bool isClosed() override;
+        /// consumer end: are we done, is the queue entirely drained?
+        bool done() override;
+
+        /*---------------------- fire and forget API -----------------------*/
+
+        /**
+         * post work at DEFAULT_PRIORITY, unless the queue is closed before we
+         * can post
+         */
+        bool post(const Work& callable) override;
+
+        /**
+         * post work with a priority, higher runs first, unless the queue is
+         * closed before we can post. A key other than NO_KEY lets
+         * updatePriority() move the work while it is still queued.
+         */
+        bool post(const Work& callable, F32 priority, Key key = NO_KEY);
+
+        /**
+         * post work at DEFAULT_PRIORITY, unless the queue is full
+         */
+        bool tryPost(const Work& callable) override;
+
+        /**
+         * post work with a priority, unless the queue is full
+         */
+        bool tryPost(const Work& callable, F32 priority, Key key = NO_KEY);
+
+        /**
+         * Change the priority of queued work in O(log n). Returns false if
+         * no work with that key is queued any more.
+         */
+        bool updatePriority(Key key, F32 priority);
+
+    private:
+        Queue mQueue;
+
+        Work pop_() override;
+        bool tryPop_(Work&) override;
+    };
+
+/*****************************************************************************
+*   WorkStealingQueue: per-worker deques for many small tasks
+*****************************************************************************/
+    /**
+     * WorkStealingQueue serves the threads of a pool from per-worker
+     * Chase-Lev deques instead of one locked queue. Work posted by one of
+     * its own workers goes to that worker's deque, newest first, where idle
+     * workers steal it from the other end. Work posted from any other
+     * thread goes through a lock-free injection ring; only when that ring
+     * is full does post() fall back to a locked overflow queue.
+     *
+     * Unlike WorkQueue there is no ordering guarantee between work items,
+     * so don't use it for a single thread that expects FIFO behaviour.
+     */
+    class WorkStealingQueue: public LLInstanceTrackerSubclass<WorkStealingQueue, WorkQueueBase>
+    {
+    private:
+        using super = LLInstanceTrackerSubclass<WorkStealingQueue, WorkQueueBase>;
+
+    public:
+        /// workers beyond this many share the injection ring
+        static constexpr size_t MAX_WORKERS = 64;
+        /// the injection ring never takes more slots than this
+        static constexpr size_t MAX_INJECTION_SLOTS = 8192;
+
+        /**
+         * You may omit the WorkStealingQueue name, in which case a unique
+         * name is synthesized; for practical purposes that makes it
+         * anonymous. capacity limits the number of queued work items.
+         */
+        WorkStealingQueue(const std::string& name = std::string(), size_t capacity=1024);
+        ~WorkStealingQueue() override;
+
+        void close() override;
+        size_t size() override;
+        /// producer end: are we prevented from pushing any additional items?
+        bool isClosed() override;
+        /// consumer end: are we done, is the queue entirely drained?
+        bool done() override;
+
+        /*---------------------- fire and forget API -----------------------*/
+
+        /**
+         * post work, unless the queue is closed before we can post. Waits
+         * while the queue holds capacity items.
+         */
+        bool post(const Work&) override;
+
+        /**
+         * post work, unless the queue is full
+         */
+        bool tryPost(const Work&) override;
+
+    private:
+        using Deque = WorkStealingPrivate::ChaseLevDeque<Work*>;
+        using Ring = WorkStealingPrivate::InjectionRing<Work>;
+
+        bool post_(const Work& work, bool wait);
+        void push_(const Work& work);
+        bool take_(Work& work);
+        void wake();
+        // -1 unless the calling thread is one of our registered workers
+        S32 workerIndex() const;
+        void registerWorker();
+
+        Work pop_() override;
+        bool tryPop_(Work&) override;
+
+        const size_t mCapacity;
+        // tells a thread's cached registration apart from one with a
+        // previous queue that lived at the same address
+        const U64 mSerial;
+        Ring mInjection;
+        std::atomic<Deque*> mDeques[MAX_WORKERS];
+        std::atomic<U32> mWorkerCount{ 0 };
+        // queued items, counting posts that are still being pushed
+        alignas(WorkStealingPrivate::CACHE_LINE) std::atomic<size_t> mPending{ 0 };
+        std::atomic<bool> mClosed{ false };
+
+        std::mutex mOverflowLock;
+        std::deque<Work> mOverflow;
+        std::atomic<size_t> mOverflowSize{ 0 };
+
+        // idle workers wait on mWake until mEpoch moves
+        alignas(WorkStealingPrivate::CACHE_LINE) std::atomic<U64> mEpoch{ 0 };
+        std::atomic<U32> mSleepers{ 0 };
+        LLCoros::Mutex mSleepLock;
+        LLCoros::ConditionVariable mWake;
+    };
+
     /**
      * BackJack is, in effect, a hand-rolled lambda, binding a WorkSchedule, a
      * CALLABLE that returns bool, a TimePoint and an interval at which to
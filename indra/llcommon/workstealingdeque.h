@@ -0,0 +1,305 @@
+/**
+ * @file   workstealingdeque.h
+ * @brief  Lock-free containers behind WorkStealingQueue: a Chase-Lev
+ *         work-stealing deque and a bounded multi-producer multi-consumer
+ *         injection ring.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_WORKSTEALINGDEQUE_H)
+#define LL_WORKSTEALINGDEQUE_H
+
+#include "stdtypes.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace LL
+{
+    namespace WorkStealingPrivate
+    {
+        // keep the producer and consumer indices on separate cache lines
+        constexpr size_t CACHE_LINE = 64;
+
+        /**
+         * Chase-Lev deque of pointers, after Le, Pop, Cohen and Zappa
+         * Nardelli, "Correct and Efficient Work-Stealing for Weak Memory
+         * Models" (PPoPP 2013).
+         *
+         * Only the owning thread may push() and pop(), at the bottom. Any
+         * thread may steal() from the top. The ring grows when full; a
+         * grown out ring stays allocated until the deque is destroyed,
+         * since a stealer may still be reading it.
+         */
+        template <typename T>
+        class ChaseLevDeque
+        {
+        public:
+            ChaseLevDeque(size_t capacity = 256):
+                mArray(new Array(roundUp(capacity)))
+            {}
+
+            ~ChaseLevDeque()
+            {
+                delete mArray.load(std::memory_order_relaxed);
+            }
+
+            ChaseLevDeque(const ChaseLevDeque&) = delete;
+            ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+            /// owner only
+            void push(T item)
+            {
+                S64 bottom = mBottom.load(std::memory_order_relaxed);
+                S64 top = mTop.load(std::memory_order_acquire);
+                Array* array = mArray.load(std::memory_order_relaxed);
+                if (bottom - top > (S64)array->mMask)
+                {
+                    array = grow(array, top, bottom);
+                }
+                array->put(bottom, item);
+                std::atomic_thread_fence(std::memory_order_release);
+                mBottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            /// owner only, newest first; returns T() when empty
+            T pop()
+            {
+                S64 bottom = mBottom.load(std::memory_order_relaxed) - 1;
+                Array* array = mArray.load(std::memory_order_relaxed);
+                mBottom.store(bottom, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                S64 top = mTop.load(std::memory_order_relaxed);
+                if (top > bottom)
+                {
+                    // empty
+                    mBottom.store(bottom + 1, std::memory_order_relaxed);
+                    return T();
+                }
+                T item = array->get(bottom);
+                if (top == bottom)
+                {
+                    // last item: race the stealers for it
+                    if (!mTop.compare_exchange_strong(top, top + 1,
+                                                      std::memory_order_seq_cst,
+                                                      std::memory_order_relaxed))
+                    {
+                        item = T();
+                    }
+                    mBottom.store(bottom + 1, std::memory_order_relaxed);
+                }
+                return item;
+            }
+
+            /// any thread, oldest first; returns T() when empty or when it
+            /// lost a race, in which case retrying may succeed
+            T steal()
+            {
+                S64 top = mTop.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                S64 bottom = mBottom.load(std::memory_order_acquire);
+                if (top >= bottom)
+                {
+                    return T();
+                }
+                Array* array = mArray.load(std::memory_order_acquire);
+                T item = array->get(top);
+                if (!mTop.compare_exchange_strong(top, top + 1,
+                                                  std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed))
+                {
+                    return T();
+                }
+                return item;
+            }
+
+            /// approximate, for any thread
+            bool empty() const
+            {
+                return mBottom.load(std::memory_order_relaxed) <= mTop.load(std::memory_order_relaxed);
+            }
+
+        private:
+            struct Array
+            {
+                Array(size_t size):
+                    mMask(size - 1),
+                    mSlots(new std::atomic<T>[size])
+                {}
+
+                T get(S64 index) const { return mSlots[index & mMask].load(std::memory_order_relaxed); }
+                void put(S64 index, T item) { mSlots[index & mMask].store(item, std::memory_order_relaxed); }
+
+                const size_t mMask;
+                std::unique_ptr<std::atomic<T>[]> mSlots;
+            };
+
+            static size_t roundUp(size_t capacity)
+            {
+                size_t size = 2;
+                while (size < capacity)
+                {
+                    size <<= 1;
+                }
+                return size;
+            }
+
+            Array* grow(Array* array, S64 top, S64 bottom)
+            {
+                Array* bigger = new Array((array->mMask + 1) * 2);
+                for (S64 i = top; i < bottom; ++i)
+                {
+                    bigger->put(i, array->get(i));
+                }
+                mRetired.emplace_back(array);
+                mArray.store(bigger, std::memory_order_release);
+                return bigger;
+            }
+
+            alignas(CACHE_LINE) std::atomic<S64> mTop{ 0 };
+            alignas(CACHE_LINE) std::atomic<S64> mBottom{ 0 };
+            std::atomic<Array*> mArray;
+            // owner only
+            std::vector<std::unique_ptr<Array>> mRetired;
+        };
+
+        /**
+         * Bounded multi-producer multi-consumer ring, after Dmitry Vyukov's
+         * "Bounded MPMC queue": each cell carries a sequence number telling
+         * producers and consumers whose turn it is, so neither side takes a
+         * lock. tryPush() fails when the ring is full, tryPop() when it is
+         * empty. FIFO as long as producers do not race each other.
+         */
+        template <typename T>
+        class InjectionRing
+        {
+        public:
+            InjectionRing(size_t capacity):
+                mMask(roundUp(capacity) - 1),
+                mCells(new Cell[mMask + 1])
+            {
+                for (size_t i = 0; i <= mMask; ++i)
+                {
+                    mCells[i].mSequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            InjectionRing(const InjectionRing&) = delete;
+            InjectionRing& operator=(const InjectionRing&) = delete;
+
+            template <typename V>
+            bool tryPush(V&& value)
+            {
+                size_t pos = mEnqueue.load(std::memory_order_relaxed);
+                Cell* cell;
+                for (;;)
+                {
+                    cell = &mCells[pos & mMask];
+                    size_t sequence = cell->mSequence.load(std::memory_order_acquire);
+                    std::ptrdiff_t diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)pos;
+                    if (diff == 0)
+                    {
+                        if (mEnqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        // full
+                        return false;
+                    }
+                    else
+                    {
+                        pos = mEnqueue.load(std::memory_order_relaxed);
+                    }
+                }
+                cell->mValue = std::forward<V>(value);
+                cell->mSequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool tryPop(T& value)
+            {
+                size_t pos = mDequeue.load(std::memory_order_relaxed);
+                Cell* cell;
+                for (;;)
+                {
+                    cell = &mCells[pos & mMask];
+                    size_t sequence = cell->mSequence.load(std::memory_order_acquire);
+                    std::ptrdiff_t diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)(pos + 1);
+                    if (diff == 0)
+                    {
+                        if (mDequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        // empty
+                        return false;
+                    }
+                    else
+                    {
+                        pos = mDequeue.load(std::memory_order_relaxed);
+                    }
+                }
+                value = std::move(cell->mValue);
+                // don't keep whatever the value holds on to alive
+                cell->mValue = T();
+                cell->mSequence.store(pos + mMask + 1, std::memory_order_release);
+                return true;
+            }
+
+            size_t capacity() const { return mMask + 1; }
+
+        private:
+            struct Cell
+            {
+                std::atomic<size_t> mSequence;
+                T mValue;
+            };
+
+            static size_t roundUp(size_t capacity)
+            {
+                size_t size = 2;
+                while (size < capacity)
+                {
+                    size <<= 1;
+                }
+                return size;
+            }
+
+            const size_t mMask;
+            std::unique_ptr<Cell[]> mCells;
+            alignas(CACHE_LINE) std::atomic<size_t> mEnqueue{ 0 };
+            alignas(CACHE_LINE) std::atomic<size_t> mDequeue{ 0 };
+        };
+    } // namespace WorkStealingPrivate
+} // namespace LL
+
+#endif /* ! defined(LL_WORKSTEALINGDEQUE_H) */
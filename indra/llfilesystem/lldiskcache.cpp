@@ -38,6 +38,7 @@
 #include <chrono>
 
 #include "lldiskcache.h"
+#include "llfilehandlepool.h" // <FS> Open-once read handles
 
  /**
   * The prefix inserted at the start of a cache file filename to
@@ -49,6 +50,32 @@
   */
 static const std::string CACHE_FILENAME_PREFIX("sl_cache");
 
+// <FS> Persistent cache manifest
+// Deliberately does not contain CACHE_FILENAME_PREFIX so that neither the
+// purge nor clearCache() will ever delete it.
+static const std::string CACHE_INDEX_FILENAME("asset_manifest.idx");
+
+LLDiskCacheIndex* LLDiskCache::sIndex = nullptr;
+// </FS>
+
+// <FS> Pack file for small assets
+static const std::string CACHE_PACK_FILENAME("asset_pack.dat");
+
+LLDiskCachePack* LLDiskCache::sPack = nullptr;
+
+// Extract the asset id from a cache file path, see metaDataToFilepath()
+static LLUUID filepathToID(const std::string& file_path)
+{
+    std::string uuid_as_string = gDirUtilp->getBaseFileName(file_path, true);
+    if (uuid_as_string.size() < CACHE_FILENAME_PREFIX.size() + 1 + UUID_STR_LENGTH - 1)
+    {
+        return LLUUID::null;
+    }
+    uuid_as_string = uuid_as_string.substr(CACHE_FILENAME_PREFIX.size() + 1, UUID_STR_LENGTH - 1);
+    return LLUUID::validate(uuid_as_string) ? LLUUID(uuid_as_string) : LLUUID::null;
+}
+// </FS>
+
 std::string LLDiskCache::sCacheDir;
 
 // <FS:Ansariel> Optimize asset simple disk cache
@@ -68,13 +95,28 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
     sCacheDir = cache_dir;
     LLFile::mkdir(cache_dir);
 
+    std::vector<std::string> cache_dirs{ cache_dir }; // <FS> Persistent cache manifest
     // <FS:Ansariel> Optimize asset simple disk cache
     for (S32 i = 0; i < 16; i++)
     {
         std::string dirname = cache_dir + gDirUtilp->getDirDelimiter() + subdirs[i];
         LLFile::mkdir(dirname);
+        cache_dirs.push_back(dirname); // <FS> Persistent cache manifest
     }
     // </FS:Ansariel>
+    // <FS> Persistent cache manifest
+    if (mIndex.open(cache_dir + gDirUtilp->getDirDelimiter() + CACHE_INDEX_FILENAME, cache_dirs))
+    {
+        sIndex = &mIndex;
+
+        // The small asset pack only goes with the manifest: its exclusive
+        // lock is what keeps a second viewer instance out of the pack.
+        if (mPack.open(cache_dir + gDirUtilp->getDirDelimiter() + CACHE_PACK_FILENAME))
+        {
+            sPack = &mPack;
+        }
+    }
+    // </FS>
     // <FS:Beq> add static assets into the new cache after clear.
     // Only missing entries are copied on init, skiplist is setup
     // For everything we populate FS specific assets to allow future updates
@@ -82,6 +124,16 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
     // </FS:Beq>
 }
 
+// <FS> Persistent cache manifest
+LLDiskCache::~LLDiskCache()
+{
+    sPack = nullptr; // <FS> Pack file for small assets
+    mPack.close();   // <FS> Pack file for small assets
+    sIndex = nullptr;
+    mIndex.close();
+}
+// </FS>
+
 // WARNING: purge() is called by LLPurgeDiskCacheThread. As such it must
 // NOT touch any LLDiskCache data without introducing and locking a mutex!
 
@@ -117,6 +169,15 @@ void LLDiskCache::purge()
         LL_INFOS() << "Total dir size before purge is " << dirFileSize(sCacheDir) << LL_ENDL;
     }
 
+    // <FS> Persistent cache manifest
+    if (mIndex.isComplete())
+    {
+        purgeIndexed();
+        return;
+    }
+    std::vector<LLDiskCacheIndex::Entry> scanned;
+    // </FS>
+
     boost::system::error_code ec;
     auto start_time = std::chrono::high_resolution_clock::now();
 
@@ -157,12 +218,36 @@ void LLDiskCache::purge()
                     file_size_total += file_size; // <FS:Beq/> try to make simple cache less naive.
 
                     file_info.push_back(file_info_t(file_time, { file_size, file_path }));
+
+                    // <FS> Persistent cache manifest
+                    LLUUID file_id = filepathToID(file_path);
+                    if (file_id.notNull())
+                    {
+                        scanned.push_back({ file_id, LLAssetType::AT_UNKNOWN, 0, file_size, (S64)file_time });
+                    }
+                    // </FS>
                 }
             }
             iter.increment(ec);
         }
     }
 
+    // <FS> Persistent cache manifest
+    // From here on the manifest keeps track of the cache, so this should be
+    // the only full directory walk of the session.
+    mPack.collectEntries(scanned); // <FS> Pack file for small assets
+    mIndex.rebuild(scanned);
+    if (mIndex.isComplete())
+    {
+        // The manifest now has every file and packed asset with its access
+        // time, purge from it like every later purge does
+        purgeIndexed();
+        return;
+    }
+    // Without it packed assets can't be purged here, but they still count
+    file_size_total += mPack.getFileBytes(); // <FS> Pack file for small assets
+    // </FS>
+
     // <FS:Beq> add high water/low water thresholds to reduce the churn in the cache.
     LL_DEBUGS("LLDiskCache") << "Cache is " << (int)(((F32)file_size_total)/mMaxSizeBytes*100.0) << "% full" << LL_ENDL;
     if( file_size_total < mMaxSizeBytes * (mHighPercent/100) )
@@ -250,6 +335,8 @@ void LLDiskCache::purge()
             {
                 LL_WARNS() << "Failed to delete cache file " << entry.second.second << ": " << ec.message() << LL_ENDL;
             }
+            mIndex.recordRemove(LLUUID(uuid_as_string)); // <FS> Persistent cache manifest
+            LLFileHandlePool::invalidate(LLUUID(uuid_as_string)); // <FS> Open-once read handles
         }
     }
 // <FS:Beq> update the debug logging to be more useful
@@ -326,6 +413,85 @@ void LLDiskCache::purge()
     // } <FS:Beq/> this bracket was moved up a few lines.
 }
 
+// <FS> Persistent cache manifest
+void LLDiskCache::purgeIndexed()
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    uintmax_t file_size_total = mIndex.getTotalSize();
+    LL_DEBUGS("LLDiskCache") << "Cache is " << (int)(((F32)file_size_total)/mMaxSizeBytes*100.0) << "% full" << LL_ENDL;
+    if (file_size_total < mMaxSizeBytes * (mHighPercent/100))
+    {
+        LL_DEBUGS("LLDiskCache") << "Not exceded high water - do nothing" << LL_ENDL;
+        updateCacheSize(file_size_total);
+        return;
+    }
+
+    auto target_size = (uintmax_t)(mMaxSizeBytes * (mLowPercent/100));
+    LL_INFOS() << "Purging cache to a maximum of " << target_size << " bytes" << LL_ENDL;
+
+    const S64 now = (S64)std::time(nullptr);
+    U32 entry_count = mIndex.getEntryCount();
+    U32 del{ 0 };
+    U32 skip{ 0 };
+    uintmax_t deleted_size_total = 0;
+    boost::system::error_code ec;
+
+    LLDiskCacheIndex::Entry entry;
+    while ((file_size_total - deleted_size_total) > target_size && (del + skip) < entry_count && mIndex.popOldest(entry))
+    {
+        const std::string uuid_as_string = entry.mID.asString();
+        if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) != mSkipList.end())
+        {
+            // Static asset, put it back as most recently used and keep going
+            mIndex.recordWrite(entry.mID, (LLAssetType::EType)entry.mType, entry.mSize, now);
+            skip++;
+            if (mEnableCacheDebugInfo)
+            {
+                LL_INFOS("LLDiskCache") << "STATIC  " << entry.mLastAccess << "  " << entry.mSize << "  " << uuid_as_string << LL_ENDL;
+            }
+            continue;
+        }
+
+        const std::string file_path = metaDataToFilepath(entry.mID, (LLAssetType::EType)entry.mType);
+        // Small assets live in the pack, everything else in its own file
+        ec.clear();
+        if (!mPack.remove(entry.mID))
+        {
+            boost::filesystem::remove(file_path, ec);
+        }
+        if (ec.failed())
+        {
+            LL_WARNS() << "Failed to delete cache file " << file_path << ": " << ec.message() << LL_ENDL;
+        }
+        LLFileHandlePool::invalidate(entry.mID); // <FS> Open-once read handles
+        deleted_size_total += entry.mSize;
+        del++;
+        if (mEnableCacheDebugInfo)
+        {
+            LL_INFOS("LLDiskCache") << "DELETE  " << entry.mLastAccess << "  " << entry.mSize << "  " << file_path
+                                    << " (" << file_size_total - deleted_size_total << "/" << mMaxSizeBytes << ")" << LL_ENDL;
+        }
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+    auto newCacheSize = updateCacheSize(mIndex.getTotalSize());
+    LL_INFOS("LLDiskCache") << "Total dir size after purge is " << newCacheSize << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Cache purge took " << execute_time << " ms to execute for " << entry_count << " files" << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Deleted: " << del << " Skipped: " << skip << " Kept: " << entry_count - del << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Total of " << deleted_size_total << " bytes removed." << LL_ENDL;
+}
+// </FS>
+
+// <FS> Pack file for small assets
+void LLDiskCache::compactPack()
+{
+    mPack.compact();
+}
+// </FS>
+
 const std::string LLDiskCache::metaDataToFilepath(const LLUUID& id, LLAssetType::EType at)
 {
     return llformat("%s%s%s_%s_0.asset", sCacheDir.c_str(), gDirUtilp->getDirDelimiter().c_str(), CACHE_FILENAME_PREFIX.c_str(), id.asString().c_str());
@@ -390,6 +556,16 @@ void LLDiskCache::prepopulateCacheWithStatic()
                     {
                         LL_WARNS("LLDiskCache") << "Failed to copy " << from_asset_file << " to " << to_asset_file << LL_ENDL;
                     }
+                    // <FS> Persistent cache manifest
+                    else
+                    {
+                        llstat file_stat;
+                        if (LLFile::stat(to_asset_file, &file_stat) == 0)
+                        {
+                            mIndex.recordWrite(uuid, LLAssetType::AT_UNKNOWN, file_stat.st_size, (S64)std::time(nullptr));
+                        }
+                    }
+                    // </FS>
                 }
                 if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) == mSkipList.end())
                 {
@@ -442,6 +618,9 @@ void LLDiskCache::clearCache()
             }
             iter.increment(ec);
         }
+        mIndex.clear(); // <FS> Persistent cache manifest
+        mPack.clear(); // <FS> Pack file for small assets
+        LLFileHandlePool::invalidateAll(); // <FS> Open-once read handles
         // <FS:Beq> add static assets into the new cache after clear
     LL_INFOS() << "prepopulating new cache " << LL_ENDL;
         prepopulateCacheWithStatic();
@@ -509,6 +688,13 @@ uintmax_t LLDiskCache::dirFileSize(const std::string& dir, bool force)
         return mStoredCacheSize;
     }
 // </FS:Beq>
+    // <FS> Persistent cache manifest
+    // The manifest keeps a running total, no need to scan at all.
+    if (dir == sCacheDir && mIndex.isComplete())
+    {
+        return updateCacheSize(mIndex.getTotalSize());
+    }
+    // </FS>
     uintmax_t total_file_size = 0;
 
     /**
@@ -568,5 +754,6 @@ void LLPurgeDiskCacheThread::run()
     while (LLApp::instance()->sleep(CHECK_INTERVAL))
     {
         LLDiskCache::instance().purge();
+        LLDiskCache::instance().compactPack(); // <FS> Pack file for small assets
     }
 }
@@ -28,6 +28,9 @@
  *    directory, sorts them by date of last access (write) and then
  *    deletes any files based on age until the total size of all
  *    the files is less than the maximum size specified.
+ *    <FS> Once the manifest in lldiskcacheindex.h has been built
+ *    (one scan per unclean shutdown) the purge pops the least
+ *    recently used entries from it instead of walking the directory.
  * 4/ An LLSingleton idiom is used since there will only ever be
  *    a single cache and we want to access it from numerous places.
  * 5/ Performance on my modest system seems very acceptable. For
@@ -63,6 +66,8 @@
 #define _LLDISKCACHE
 
 #include "llsingleton.h"
+#include "lldiskcacheindex.h" // <FS> Persistent cache manifest
+#include "lldiskcachepack.h" // <FS> Pack file for small assets
 #include <chrono>
 using namespace std::chrono;
 
@@ -108,7 +113,7 @@ class LLDiskCache :
                     // </FS:Beq>
                     );
 
-        virtual ~LLDiskCache() = default;
+        virtual ~LLDiskCache(); // <FS> Persistent cache manifest
 
     public:
         /**
@@ -152,6 +157,35 @@ class LLDiskCache :
 
         void removeOldVFSFiles();
 
+        // <FS> Persistent cache manifest
+        /**
+         * The manifest of cache files, or nullptr if the cache has not been
+         * initialized. LLFileSystem reports writes, reads, renames and
+         * removals here so that purge() never has to walk the directory.
+         */
+        static LLDiskCacheIndex* getIndex() { return sIndex; }
+        // </FS>
+
+        // <FS> Pack file for small assets
+        /**
+         * The pack file small assets are stored in, or nullptr if the cache
+         * has not been initialized or the pack could not be opened.
+         */
+        static LLDiskCachePack* getPack() { return sPack; }
+
+        /**
+         * Assets up to this size are written to the pack instead of their
+         * own file. Zero turns the pack off for new writes.
+         */
+        void setPackThreshold(U32 bytes) { mPack.setThreshold(bytes); }
+
+        /**
+         * Reclaim space taken by replaced and removed assets in the pack.
+         * Called from LLPurgeDiskCacheThread after each purge.
+         */
+        void compactPack();
+        // </FS>
+
         // <FS:Ansariel> Better asset cache size control
         void setMaxSizeBytes(uintmax_t size) { mMaxSizeBytes = size; }
         // <FS:Beq> High/Low water control
@@ -168,6 +202,15 @@ class LLDiskCache :
         uintmax_t updateCacheSize(const uintmax_t newsize); // <FS:Beq/> enable time based caching of dirfilesize except when force is true.
         uintmax_t dirFileSize(const std::string& dir, bool force = false); // <FS:Beq/> enable time based caching of dirfilesize except when force is true.
 
+        // <FS> Persistent cache manifest
+        /**
+         * Purge using the manifest: pop least recently used entries until the
+         * cache is below the low water mark. Only used once the manifest is
+         * complete; until then purge() scans the directory and rebuilds it.
+         */
+        void purgeIndexed();
+        // </FS>
+
         /**
          * cache the directory size cos it takes forever to calculate it
          * 
@@ -202,6 +245,16 @@ class LLDiskCache :
         bool mEnableCacheDebugInfo;
         
         std::vector<std::string> mSkipList;  // <FS:Beq/> Vector of "static" untouchable assets that should never be purged
+
+        // <FS> Persistent cache manifest
+        LLDiskCacheIndex mIndex;
+        static LLDiskCacheIndex* sIndex;
+        // </FS>
+
+        // <FS> Pack file for small assets
+        LLDiskCachePack mPack;
+        static LLDiskCachePack* sPack;
+        // </FS>
 };
 
 class LLPurgeDiskCacheThread : public LLThread
@@ -0,0 +1,651 @@
+/**
+ * @file lldiskcacheindex.cpp
+ * @brief Persistent manifest of the files held in the asset disk cache.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lldiskcacheindex.h"
+#include "llfile.h"
+
+static const U32 INDEX_MAGIC = 0x49435346; // "FSCI"
+static const U32 INDEX_VERSION = 1;
+static const U32 INDEX_INITIAL_CAPACITY = 16384;
+
+static const U32 ENTRY_IN_USE = 0x1;
+
+struct LLDiskCacheIndex::Header
+{
+    U32 mMagic;
+    U32 mVersion;
+    U32 mEntrySize;
+    U32 mCapacity;
+    U32 mCleanShutdown;
+    U32 mReserved0;
+    U64 mDirStamp;      // getDirStamp() at the clean close
+    U32 mReserved[8];
+};
+
+static_assert(sizeof(LLDiskCacheIndex::Entry) == 40, "Disk cache index entry layout changed, bump INDEX_VERSION");
+
+LLDiskCacheIndex::LLDiskCacheIndex()
+:   mComplete(false),
+    mCapacity(0),
+    mTotalSize(0),
+    mHead(NO_SLOT),
+    mTail(NO_SLOT)
+{
+}
+
+LLDiskCacheIndex::~LLDiskCacheIndex()
+{
+    close();
+}
+
+LLDiskCacheIndex::Header* LLDiskCacheIndex::getHeader()
+{
+    return (Header*)mFile.data();
+}
+
+LLDiskCacheIndex::Entry* LLDiskCacheIndex::getEntries()
+{
+    return (Entry*)(mFile.data() + sizeof(Header));
+}
+
+// Changes whenever a file is created, removed or renamed in one of the
+// directories, whoever does it
+U64 LLDiskCacheIndex::getDirStamp() const
+{
+    U64 stamp = 0;
+    for (const std::string& dir : mWatchedDirs)
+    {
+        llstat dir_stat;
+        U64 mtime = 0;
+        if (LLFile::stat(dir, &dir_stat) == 0)
+        {
+            mtime = (U64)dir_stat.st_mtime * 1000000000;
+#if LL_LINUX
+            mtime += (U64)dir_stat.st_mtim.tv_nsec;
+#elif LL_DARWIN
+            mtime += (U64)dir_stat.st_mtimespec.tv_nsec;
+#endif
+        }
+        stamp = stamp * 1000003 + mtime + 1;
+    }
+    return stamp;
+}
+
+std::string LLDiskCacheIndex::getMarkerFilename() const
+{
+    return mFilename + ".shared";
+}
+
+bool LLDiskCacheIndex::open(const std::string& filename, const std::vector<std::string>& watched_dirs)
+{
+    LLMutexLock lock(&mMutex);
+
+    mComplete = false;
+    mFilename = filename;
+    mWatchedDirs = watched_dirs;
+    if (!mFile.open(filename, LLMappedFile::READ_WRITE, 0, true))
+    {
+        LL_WARNS("LLDiskCache") << "Unable to open cache index " << filename << ", falling back to directory scans" << LL_ENDL;
+        // Most likely another instance holds it. Our writes bypass it, so
+        // tell it not to trust its records.
+        touchMarker();
+        return false;
+    }
+
+    Header* header = mFile.size() >= sizeof(Header) ? getHeader() : nullptr;
+    bool valid = header &&
+                 header->mMagic == INDEX_MAGIC &&
+                 header->mVersion == INDEX_VERSION &&
+                 header->mEntrySize == sizeof(Entry) &&
+                 mFile.size() >= sizeof(Header) + (size_t)header->mCapacity * sizeof(Entry);
+    if (!valid)
+    {
+        LL_INFOS("LLDiskCache") << "Cache index missing or outdated, it will be rebuilt" << LL_ENDL;
+        if (!initEmpty(INDEX_INITIAL_CAPACITY))
+        {
+            return false;
+        }
+        header = getHeader();
+    }
+    else if (!header->mCleanShutdown)
+    {
+        LL_INFOS("LLDiskCache") << "Cache index was not closed cleanly, it will be rebuilt" << LL_ENDL;
+    }
+    else if (LLFile::isfile(getMarkerFilename()))
+    {
+        LL_INFOS("LLDiskCache") << "Cache was used without the index, it will be rebuilt" << LL_ENDL;
+    }
+    else if (header->mDirStamp != getDirStamp())
+    {
+        // another viewer build or something else changed the directories
+        LL_INFOS("LLDiskCache") << "Cache changed since the index was closed, it will be rebuilt" << LL_ENDL;
+    }
+    else
+    {
+        mComplete = true;
+    }
+    LLFile::remove(getMarkerFilename(), ENOENT);
+
+    mCapacity = header->mCapacity;
+    if (!mComplete)
+    {
+        // The records of an unclean session may list files that are gone
+        // or miss ones that were written, the scan rebuild() gets is the
+        // truth. Start empty so only what is recorded from now on is kept,
+        // but remember the access times: reads no longer touch the files,
+        // so their modification times are older than the records.
+        if (valid)
+        {
+            Entry* entries = getEntries();
+            for (U32 slot = 0; slot < header->mCapacity; ++slot)
+            {
+                if (entries[slot].mFlags & ENTRY_IN_USE)
+                {
+                    mPreviousAccess[entries[slot].mID] = entries[slot].mLastAccess;
+                }
+            }
+        }
+        clearLocked();
+        header->mCleanShutdown = 0;
+        mFile.flush();
+        return true;
+    }
+
+    // Rebuild the in-memory lookup and LRU order from the records. This is
+    // the only O(n log n) step and touches nothing but the mapped file.
+    mSlots.clear();
+    mFreeSlots.clear();
+    mPrev.assign(mCapacity, NO_SLOT);
+    mNext.assign(mCapacity, NO_SLOT);
+    mHead = mTail = NO_SLOT;
+    mTotalSize = 0;
+
+    std::vector<U32> used;
+    Entry* entries = getEntries();
+    for (U32 slot = mCapacity; slot-- > 0; )
+    {
+        if (entries[slot].mFlags & ENTRY_IN_USE)
+        {
+            used.push_back(slot);
+        }
+        else
+        {
+            mFreeSlots.push_back(slot);
+        }
+    }
+    std::sort(used.begin(), used.end(), [entries](U32 a, U32 b)
+    {
+        return entries[a].mLastAccess < entries[b].mLastAccess;
+    });
+    for (U32 slot : used)
+    {
+        mSlots[entries[slot].mID] = slot;
+        mTotalSize += entries[slot].mSize;
+        linkTail(slot);
+    }
+
+    // Until close() runs we cannot vouch for the contents on disk.
+    header->mCleanShutdown = 0;
+    mFile.flush();
+
+    LL_INFOS("LLDiskCache") << "Cache index loaded with " << mSlots.size() << " entries, " << mTotalSize << " bytes" << LL_ENDL;
+    return true;
+}
+
+void LLDiskCacheIndex::close()
+{
+    LLMutexLock lock(&mMutex);
+    if (!mFile.isOpen())
+    {
+        if (!mFilename.empty())
+        {
+            // we ran without the index, whoever holds it may have closed it
+            // cleanly in the meantime
+            touchMarker();
+            mFilename.clear();
+        }
+        return;
+    }
+
+    if (LLFile::isfile(getMarkerFilename()))
+    {
+        // another instance wrote to the cache while we held the index
+        mComplete = false;
+    }
+    if (mComplete)
+    {
+        Header* header = getHeader();
+        header->mDirStamp = getDirStamp();
+        header->mCleanShutdown = 1;
+    }
+    mFile.flush();
+    mFile.close();
+    resetLocked();
+    mFilename.clear();
+}
+
+void LLDiskCacheIndex::touchMarker()
+{
+    if (LLFILE* marker = LLFile::fopen(getMarkerFilename(), "wb"))
+    {
+        LLFile::close(marker);
+    }
+}
+
+void LLDiskCacheIndex::resetLocked()
+{
+    mSlots.clear();
+    mFreeSlots.clear();
+    mPrev.clear();
+    mNext.clear();
+    mHead = mTail = NO_SLOT;
+    mCapacity = 0;
+    mTotalSize = 0;
+    mComplete = false;
+    mRemoved.clear();
+    mRenamed.clear();
+    mPreviousAccess.clear();
+}
+
+bool LLDiskCacheIndex::initEmpty(U32 capacity)
+{
+    if (!mFile.resize(sizeof(Header) + (size_t)capacity * sizeof(Entry)))
+    {
+        return false;
+    }
+    memset(mFile.data(), 0, mFile.size());
+
+    Header* header = getHeader();
+    header->mMagic = INDEX_MAGIC;
+    header->mVersion = INDEX_VERSION;
+    header->mEntrySize = sizeof(Entry);
+    header->mCapacity = capacity;
+    return true;
+}
+
+bool LLDiskCacheIndex::grow()
+{
+    U32 new_capacity = mCapacity * 2;
+    if (!mFile.resize(sizeof(Header) + (size_t)new_capacity * sizeof(Entry)))
+    {
+        LL_WARNS("LLDiskCache") << "Unable to grow cache index to " << new_capacity << " entries" << LL_ENDL;
+        mComplete = false;
+        if (!mFile.isOpen())
+        {
+            // resize() dropped the mapping, e.g. on a full disk. Every call
+            // is a no-op from here and LLDiskCache goes back to scanning.
+            resetLocked();
+        }
+        return false;
+    }
+
+    // New space is zero filled by the OS, i.e. not in use
+    getHeader()->mCapacity = new_capacity;
+    mPrev.resize(new_capacity, NO_SLOT);
+    mNext.resize(new_capacity, NO_SLOT);
+    for (U32 slot = new_capacity; slot-- > mCapacity; )
+    {
+        mFreeSlots.push_back(slot);
+    }
+    mCapacity = new_capacity;
+    return true;
+}
+
+U32 LLDiskCacheIndex::allocSlot()
+{
+    if (mFreeSlots.empty() && !grow())
+    {
+        return NO_SLOT;
+    }
+    U32 slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+    return slot;
+}
+
+void LLDiskCacheIndex::freeSlot(U32 slot)
+{
+    Entry& entry = getEntries()[slot];
+    mTotalSize -= entry.mSize;
+    mSlots.erase(entry.mID);
+    unlink(slot);
+    memset((void*)&entry, 0, sizeof(Entry));
+    mFreeSlots.push_back(slot);
+}
+
+void LLDiskCacheIndex::linkTail(U32 slot)
+{
+    mPrev[slot] = mTail;
+    mNext[slot] = NO_SLOT;
+    if (mTail != NO_SLOT)
+    {
+        mNext[mTail] = slot;
+    }
+    else
+    {
+        mHead = slot;
+    }
+    mTail = slot;
+}
+
+void LLDiskCacheIndex::unlink(U32 slot)
+{
+    U32 prev = mPrev[slot];
+    U32 next = mNext[slot];
+    if (prev != NO_SLOT)
+    {
+        mNext[prev] = next;
+    }
+    else
+    {
+        mHead = next;
+    }
+    if (next != NO_SLOT)
+    {
+        mPrev[next] = prev;
+    }
+    else
+    {
+        mTail = prev;
+    }
+    mPrev[slot] = mNext[slot] = NO_SLOT;
+}
+
+void LLDiskCacheIndex::clearLocked()
+{
+    if (!mFile.isOpen())
+    {
+        return;
+    }
+    memset((void*)getEntries(), 0, (size_t)mCapacity * sizeof(Entry));
+    mSlots.clear();
+    mFreeSlots.clear();
+    for (U32 slot = mCapacity; slot-- > 0; )
+    {
+        mFreeSlots.push_back(slot);
+    }
+    mPrev.assign(mCapacity, NO_SLOT);
+    mNext.assign(mCapacity, NO_SLOT);
+    mHead = mTail = NO_SLOT;
+    mTotalSize = 0;
+}
+
+void LLDiskCacheIndex::clear()
+{
+    LLMutexLock lock(&mMutex);
+    clearLocked();
+    mComplete = mFile.isOpen();
+    mRemoved.clear();
+    mRenamed.clear();
+    mPreviousAccess.clear();
+}
+
+void LLDiskCacheIndex::rebuild(const std::vector<Entry>& entries)
+{
+    LLMutexLock lock(&mMutex);
+    if (!mFile.isOpen())
+    {
+        return;
+    }
+
+    // Keep whatever was recorded while the scan was running - it is more
+    // recent than what the scan saw - and add everything else. The scan
+    // ran without the lock, so it may list files removed or renamed since.
+    std::vector<Entry> sorted;
+    sorted.reserve(entries.size());
+    for (const Entry& scanned : entries)
+    {
+        Entry entry = scanned;
+        for (auto renamed = mRenamed.find(entry.mID); renamed != mRenamed.end(); renamed = mRenamed.find(entry.mID))
+        {
+            entry.mID = renamed->second.first;
+            entry.mType = renamed->second.second;
+        }
+        if (mRemoved.count(entry.mID))
+        {
+            continue;
+        }
+        auto previous = mPreviousAccess.find(scanned.mID);
+        if (previous != mPreviousAccess.end())
+        {
+            entry.mLastAccess = llmax(entry.mLastAccess, previous->second);
+        }
+        sorted.push_back(entry);
+    }
+    mRemoved.clear();
+    mRenamed.clear();
+    mPreviousAccess.clear();
+
+    std::sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b)
+    {
+        return a.mLastAccess < b.mLastAccess;
+    });
+
+    std::unordered_map<LLUUID, U32> live;
+    live.swap(mSlots);
+    std::vector<Entry> recent;
+    recent.reserve(live.size());
+    for (U32 slot = mHead; slot != NO_SLOT; slot = mNext[slot])
+    {
+        recent.push_back(getEntries()[slot]);
+    }
+
+    clearLocked();
+    mComplete = true;
+
+    auto insert = [this](const Entry& source)
+    {
+        U32 slot = allocSlot();
+        if (slot == NO_SLOT)
+        {
+            return;
+        }
+        Entry& entry = getEntries()[slot];
+        entry = source;
+        entry.mFlags |= ENTRY_IN_USE;
+        mSlots[entry.mID] = slot;
+        mTotalSize += entry.mSize;
+        linkTail(slot);
+    };
+
+    for (const Entry& entry : sorted)
+    {
+        if (live.find(entry.mID) == live.end() && mSlots.find(entry.mID) == mSlots.end())
+        {
+            insert(entry);
+        }
+    }
+    for (const Entry& entry : recent)
+    {
+        insert(entry);
+    }
+
+    LL_INFOS("LLDiskCache") << "Cache index rebuilt with " << mSlots.size() << " entries, " << mTotalSize << " bytes" << LL_ENDL;
+}
+
+void LLDiskCacheIndex::recordWrite(const LLUUID& id, LLAssetType::EType type, U64 size, S64 now)
+{
+    LLMutexLock lock(&mMutex);
+    if (!mFile.isOpen())
+    {
+        return;
+    }
+
+    U32 slot;
+    auto it = mSlots.find(id);
+    if (it != mSlots.end())
+    {
+        slot = it->second;
+        unlink(slot);
+        mTotalSize -= getEntries()[slot].mSize;
+    }
+    else
+    {
+        slot = allocSlot();
+        if (slot == NO_SLOT)
+        {
+            return;
+        }
+        mSlots[id] = slot;
+    }
+
+    Entry& entry = getEntries()[slot];
+    entry.mID = id;
+    entry.mType = type;
+    entry.mFlags = ENTRY_IN_USE;
+    entry.mSize = size;
+    entry.mLastAccess = now;
+    mTotalSize += size;
+    linkTail(slot);
+}
+
+void LLDiskCacheIndex::recordAccess(const LLUUID& id, S64 now)
+{
+    LLMutexLock lock(&mMutex);
+    if (!mFile.isOpen())
+    {
+        return;
+    }
+    auto it = mSlots.find(id);
+    if (it == mSlots.end())
+    {
+        return;
+    }
+
+    U32 slot = it->second;
+    getEntries()[slot].mLastAccess = now;
+    if (slot != mTail)
+    {
+        unlink(slot);
+        linkTail(slot);
+    }
+}
+
+void LLDiskCacheIndex::recordRemove(const LLUUID& id)
+{
+    LLMutexLock lock(&mMutex);
+    if (!mFile.isOpen())
+    {
+        return;
+    }
+    auto it = mSlots.find(id);
+    if (it != mSlots.end())
+    {
+        freeSlot(it->second);
+    }
+    if (!mComplete)
+    {
+        mRemoved.insert(id);
+        mRenamed.erase(id);
+    }
+}
+
+void LLDiskCacheIndex::recordRename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type)
+{
+    LLMutexLock lock(&mMutex);
+    if (!mFile.isOpen())
+    {
+        return;
+    }
+    if (!mComplete)
+    {
+        // the scan may list either name, or none
+        mRemoved.insert(old_id);
+        mRemoved.erase(new_id);
+        mRenamed.erase(new_id);
+        if (mSlots.find(old_id) == mSlots.end())
+        {
+            mRenamed[old_id] = { new_id, new_type };
+        }
+    }
+    auto it = mSlots.find(old_id);
+    if (it == mSlots.end())
+    {
+        return;
+    }
+
+    U32 slot = it->second;
+    mSlots.erase(it);
+
+    // The rename replaces any existing file of the new name
+    auto existing = mSlots.find(new_id);
+    if (existing != mSlots.end())
+    {
+        freeSlot(existing->second);
+    }
+
+    Entry& entry = getEntries()[slot];
+    entry.mID = new_id;
+    entry.mType = new_type;
+    mSlots[new_id] = slot;
+}
+
+bool LLDiskCacheIndex::popOldest(Entry& entry)
+{
+    LLMutexLock lock(&mMutex);
+    if (!mFile.isOpen())
+    {
+        return false;
+    }
+    if (mHead == NO_SLOT)
+    {
+        return false;
+    }
+
+    entry = getEntries()[mHead];
+    freeSlot(mHead);
+    return true;
+}
+
+bool LLDiskCacheIndex::getEntry(const LLUUID& id, Entry& entry)
+{
+    LLMutexLock lock(&mMutex);
+    if (!mFile.isOpen())
+    {
+        return false;
+    }
+    auto it = mSlots.find(id);
+    if (it == mSlots.end())
+    {
+        return false;
+    }
+    entry = getEntries()[it->second];
+    return true;
+}
+
+U64 LLDiskCacheIndex::getTotalSize()
+{
+    LLMutexLock lock(&mMutex);
+    return mTotalSize;
+}
+
+U32 LLDiskCacheIndex::getEntryCount()
+{
+    LLMutexLock lock(&mMutex);
+    return (U32)mSlots.size();
+}
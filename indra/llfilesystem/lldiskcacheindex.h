@@ -0,0 +1,175 @@
+/**
+ * @file lldiskcacheindex.h
+ * @brief Persistent manifest of the files held in the asset disk cache.
+ *
+ * @Description:
+ * The simple disk cache (see lldiskcache.h) originally derived all of its
+ * bookkeeping from the filesystem: the purge walked every cache file,
+ * stat'ed it and sorted the lot by modification time. With caches of
+ * several hundred thousand files that walk takes minutes of disk time.
+ *
+ * This index keeps the same information (id, type, size and last access)
+ * in a fixed record array inside a memory mapped file in the cache
+ * directory, plus an in-memory LRU list threaded through the records.
+ * LLFileSystem updates it on write, read, rename and remove, so the total
+ * cache size is a counter and purging is an LRU pop per evicted file.
+ *
+ * The index is only trusted if the previous session closed it cleanly
+ * and nothing else has touched the cache since. A clean close stamps the
+ * modification times of the cache directories, which change with any
+ * file created or removed by anyone, e.g. an older viewer build. An
+ * instance that runs without the index because another one holds it
+ * leaves a marker file next to it. Otherwise (crash, version change,
+ * first run, foreign writes) it reports itself as incomplete and
+ * LLDiskCache rebuilds it from one directory scan.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLDISKCACHEINDEX_H
+#define LL_LLDISKCACHEINDEX_H
+
+#include "llassettype.h"
+#include "llmappedfile.h"
+#include "llmutex.h"
+#include "lluuid.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class LLDiskCacheIndex
+{
+public:
+    /**
+     * One cache file as seen by the index. This is also the on-disk
+     * record layout, so do not reorder or resize the members without
+     * bumping the index version.
+     */
+    struct Entry
+    {
+        LLUUID  mID;
+        S32     mType;          // LLAssetType::EType
+        U32     mFlags;
+        U64     mSize;
+        S64     mLastAccess;    // time_t, seconds
+    };
+
+    LLDiskCacheIndex();
+    ~LLDiskCacheIndex();
+
+    /**
+     * Map the index file. watched_dirs are the directories holding the
+     * cache files. Returns false if the index could not be opened at all
+     * (for example because another viewer instance holds it), in which
+     * case every other call is a no-op and isComplete() is false.
+     */
+    bool open(const std::string& filename, const std::vector<std::string>& watched_dirs = std::vector<std::string>());
+
+    /**
+     * Mark the index as cleanly closed and unmap it. The next open() will
+     * trust its contents unless the watched directories change first.
+     */
+    void close();
+
+    bool isOpen() const { return mFile.isOpen(); }
+
+    /**
+     * True when the index is believed to describe every file in the cache.
+     * When false, the caller should scan the cache once and hand the result
+     * to rebuild().
+     */
+    bool isComplete() const { return mComplete; }
+
+    /**
+     * Replace the contents of the index with the result of a directory scan.
+     * Files removed or renamed since the index was opened are left out or
+     * renamed, since the scan may have seen them first. Access times the
+     * previous session recorded win over older modification times.
+     */
+    void rebuild(const std::vector<Entry>& entries);
+
+    /// Forget every entry (used when the cache is cleared).
+    void clear();
+
+    void recordWrite(const LLUUID& id, LLAssetType::EType type, U64 size, S64 now);
+    void recordAccess(const LLUUID& id, S64 now);
+    void recordRemove(const LLUUID& id);
+    void recordRename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type);
+
+    /**
+     * Remove the least recently used entry from the index and return it in
+     * entry. Returns false if the index is empty.
+     */
+    bool popOldest(Entry& entry);
+
+    bool getEntry(const LLUUID& id, Entry& entry);
+    U64  getTotalSize();
+    U32  getEntryCount();
+
+private:
+    struct Header;
+
+    Header* getHeader();
+    U64     getDirStamp() const;
+    std::string getMarkerFilename() const;
+    void    touchMarker();
+    Entry*  getEntries();
+
+    bool    initEmpty(U32 capacity);
+    bool    grow();
+    U32     allocSlot();
+    void    freeSlot(U32 slot);
+
+    void    linkTail(U32 slot);
+    void    unlink(U32 slot);
+    void    clearLocked();
+    void    resetLocked();
+
+private:
+    static constexpr U32 NO_SLOT = 0xFFFFFFFF;
+
+    LLMutex         mMutex;
+    LLMappedFile    mFile;
+    std::string     mFilename;
+    std::vector<std::string> mWatchedDirs;
+    bool            mComplete;
+    U32             mCapacity;
+    U64             mTotalSize;
+
+    std::unordered_map<LLUUID, U32> mSlots;     // id -> record index
+    std::vector<U32> mFreeSlots;
+
+    // Until rebuild() runs: what the directory scan cannot know about
+    std::unordered_set<LLUUID> mRemoved;
+    std::unordered_map<LLUUID, std::pair<LLUUID, S32>> mRenamed;  // old id -> new id, type
+    std::unordered_map<LLUUID, S64> mPreviousAccess;              // from the untrusted records
+
+    // LRU list threaded through the record indices, oldest at mHead
+    std::vector<U32> mPrev;
+    std::vector<U32> mNext;
+    U32             mHead;
+    U32             mTail;
+};
+
+#endif // LL_LLDISKCACHEINDEX_H
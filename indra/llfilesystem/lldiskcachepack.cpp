@@ -0,0 +1,656 @@
+/**
+ * @file lldiskcachepack.cpp
+ * @brief Append-only pack file for small asset cache entries.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lldiskcachepack.h"
+#include "llfile.h"
+#include "llmappedfile.h"
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+
+#if LL_WINDOWS
+#include "llwin32headers.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const U32 PACK_MAGIC = 0x4b505346; // "FSPK"
+static const U32 PACK_VERSION = 2;    // 2: records carry their access time
+
+// Same threshold as LLFileSystem::updateFileAccessTime() uses for loose files
+static const S64 TOUCH_INTERVAL = 60 * 60;
+
+enum
+{
+    RECORD_DATA         = 0x41544144,  // "DATA"
+    RECORD_TOMBSTONE    = 0x424d4f54   // "TOMB"
+};
+
+struct PackFileHeader
+{
+    U32 mMagic;
+    U32 mVersion;
+};
+
+struct PackRecordHeader
+{
+    U32     mKind;
+    LLUUID  mID;
+    S32     mType;
+    U32     mSize;
+    U32     mReserved;  // zero
+    S64     mTime;      // last access, rewritten in place by touch()
+};
+
+static_assert(sizeof(PackRecordHeader) == 40, "Cache pack record layout changed, bump PACK_VERSION");
+
+static const intptr_t NO_HANDLE = -1;
+
+//----------------------------------------------------------------------------
+// Positional file I/O. Reads from several threads share one handle, so no
+// call here may depend on a file position.
+namespace
+{
+    intptr_t openPackFile(const std::string& filename, bool truncate)
+    {
+#if LL_WINDOWS
+        llutf16string utf16filename = utf8str_to_utf16str(filename);
+        HANDLE handle = CreateFileW(utf16filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                    FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                    truncate ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        return handle == INVALID_HANDLE_VALUE ? NO_HANDLE : (intptr_t)handle;
+#else
+        int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0600);
+        return fd < 0 ? NO_HANDLE : (intptr_t)fd;
+#endif
+    }
+
+    void closePackFile(intptr_t handle)
+    {
+        if (handle == NO_HANDLE)
+        {
+            return;
+        }
+#if LL_WINDOWS
+        CloseHandle((HANDLE)handle);
+#else
+        ::close((int)handle);
+#endif
+    }
+
+    S64 readPackFile(intptr_t handle, U64 offset, void* buffer, U32 bytes)
+    {
+        U32 total = 0;
+        while (total < bytes)
+        {
+#if LL_WINDOWS
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = (DWORD)((offset + total) & 0xFFFFFFFF);
+            overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+            DWORD done = 0;
+            if (!ReadFile((HANDLE)handle, (U8*)buffer + total, bytes - total, &done, &overlapped) && GetLastError() != ERROR_HANDLE_EOF)
+            {
+                return -1;
+            }
+#else
+            ssize_t done = ::pread((int)handle, (U8*)buffer + total, bytes - total, (off_t)(offset + total));
+            if (done < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return -1;
+            }
+#endif
+            if (done == 0)
+            {
+                break;
+            }
+            total += (U32)done;
+        }
+        return total;
+    }
+
+    bool writePackFile(intptr_t handle, U64 offset, const void* buffer, U32 bytes)
+    {
+        U32 total = 0;
+        while (total < bytes)
+        {
+#if LL_WINDOWS
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = (DWORD)((offset + total) & 0xFFFFFFFF);
+            overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+            DWORD done = 0;
+            if (!WriteFile((HANDLE)handle, (const U8*)buffer + total, bytes - total, &done, &overlapped))
+            {
+                return false;
+            }
+#else
+            ssize_t done = ::pwrite((int)handle, (const U8*)buffer + total, bytes - total, (off_t)(offset + total));
+            if (done < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+#endif
+            total += (U32)done;
+        }
+        return true;
+    }
+
+    bool truncatePackFile(intptr_t handle, U64 size)
+    {
+#if LL_WINDOWS
+        LARGE_INTEGER pos;
+        pos.QuadPart = (LONGLONG)size;
+        return SetFilePointerEx((HANDLE)handle, pos, nullptr, FILE_BEGIN) && SetEndOfFile((HANDLE)handle);
+#else
+        return ftruncate((int)handle, (off_t)size) == 0;
+#endif
+    }
+
+    // Atomically put from in place of to, which may exist
+    bool replacePackFile(const std::string& from, const std::string& to)
+    {
+#if LL_WINDOWS
+        llutf16string utf16from = utf8str_to_utf16str(from);
+        llutf16string utf16to = utf8str_to_utf16str(to);
+        return MoveFileExW(utf16from.c_str(), utf16to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return ::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    // Write a complete record into a handle that nobody else is using yet
+    bool copyRecord(intptr_t from, const LLDiskCachePack::Location& location, const LLUUID& id,
+                    intptr_t to, U64& to_size, U64& new_data_offset, std::vector<U8>& scratch)
+    {
+        scratch.resize(location.mSize);
+        if (readPackFile(from, location.mOffset, scratch.data(), location.mSize) != (S64)location.mSize)
+        {
+            return false;
+        }
+        PackRecordHeader header{ RECORD_DATA, id, location.mType, location.mSize, 0, location.mLastAccess };
+        if (!writePackFile(to, to_size, &header, sizeof(header)) ||
+            !writePackFile(to, to_size + sizeof(header), scratch.data(), location.mSize))
+        {
+            return false;
+        }
+        new_data_offset = to_size + sizeof(header);
+        to_size += sizeof(header) + location.mSize;
+        return true;
+    }
+}
+
+//----------------------------------------------------------------------------
+
+LLDiskCachePack::LLDiskCachePack()
+:   mHandle(NO_HANDLE),
+    mFileSize(0),
+    mLiveBytes(0),
+    mGeneration(0),
+    mThreshold(0)
+{
+}
+
+LLDiskCachePack::~LLDiskCachePack()
+{
+    close();
+}
+
+bool LLDiskCachePack::isOpen() const
+{
+    return mHandle != NO_HANDLE;
+}
+
+bool LLDiskCachePack::open(const std::string& filename)
+{
+    LLExclusiveMutexLock lock(&mMutex);
+
+    mFilename = filename;
+    if (!load())
+    {
+        LL_WARNS("LLDiskCache") << "Unable to open cache pack " << filename << ", small assets will use loose files" << LL_ENDL;
+        closePackFile(mHandle);
+        mHandle = NO_HANDLE;
+        mLocations.clear();
+        return false;
+    }
+
+    LL_INFOS("LLDiskCache") << "Cache pack loaded with " << mLocations.size() << " assets, "
+                            << mLiveBytes << " live of " << mFileSize << " bytes" << LL_ENDL;
+    return true;
+}
+
+bool LLDiskCachePack::load()
+{
+    mLocations.clear();
+    mLiveBytes = 0;
+    mFileSize = 0;
+
+    // Replay the log through a read only mapping: one sequential pass,
+    // no per-record syscalls.
+    U64 valid_end = 0;
+    {
+        LLMappedFile mapping;
+        if (mapping.open(mFilename, LLMappedFile::READ_ONLY) && mapping.size() >= sizeof(PackFileHeader))
+        {
+            const PackFileHeader* file_header = (const PackFileHeader*)mapping.data();
+            if (file_header->mMagic == PACK_MAGIC && file_header->mVersion == PACK_VERSION)
+            {
+                const U64 size = mapping.size();
+                U64 pos = sizeof(PackFileHeader);
+                while (pos + sizeof(PackRecordHeader) <= size)
+                {
+                    PackRecordHeader record;
+                    memcpy((void*)&record, mapping.data() + pos, sizeof(record));
+                    const U64 data_offset = pos + sizeof(PackRecordHeader);
+                    if ((record.mKind != RECORD_DATA && record.mKind != RECORD_TOMBSTONE) ||
+                        data_offset + record.mSize > size)
+                    {
+                        break;
+                    }
+
+                    auto it = mLocations.find(record.mID);
+                    if (it != mLocations.end())
+                    {
+                        mLiveBytes -= it->second.mSize;
+                        mLocations.erase(it);
+                    }
+                    if (record.mKind == RECORD_DATA)
+                    {
+                        mLocations[record.mID] = { data_offset, record.mSize, (LLAssetType::EType)record.mType, record.mTime };
+                        mLiveBytes += record.mSize;
+                    }
+                    pos = data_offset + record.mSize;
+                }
+                valid_end = pos;
+            }
+        }
+    }
+
+    mHandle = openPackFile(mFilename, valid_end == 0);
+    if (mHandle == NO_HANDLE)
+    {
+        return false;
+    }
+
+    if (valid_end == 0)
+    {
+        mLocations.clear();
+        mLiveBytes = 0;
+        PackFileHeader file_header{ PACK_MAGIC, PACK_VERSION };
+        if (!writePackFile(mHandle, 0, &file_header, sizeof(file_header)))
+        {
+            return false;
+        }
+        valid_end = sizeof(file_header);
+    }
+
+    // Cut off anything after the last complete record
+    if (!truncatePackFile(mHandle, valid_end))
+    {
+        return false;
+    }
+    mFileSize = valid_end;
+    return true;
+}
+
+void LLDiskCachePack::close()
+{
+    LLExclusiveMutexLock lock(&mMutex);
+    closePackFile(mHandle);
+    mHandle = NO_HANDLE;
+    mLocations.clear();
+    mFileSize = 0;
+    mLiveBytes = 0;
+}
+
+bool LLDiskCachePack::appendRecord(U32 kind, const LLUUID& id, LLAssetType::EType type, const U8* data, U32 bytes, S64 time, U64& data_offset)
+{
+    // Header and data go out in one write so a record is never half there
+    // unless the process dies mid-write, which load() copes with.
+    std::vector<U8> record(sizeof(PackRecordHeader) + bytes);
+    PackRecordHeader header{ kind, id, type, bytes, 0, time };
+    memcpy(record.data(), (const void*)&header, sizeof(header));
+    if (bytes)
+    {
+        memcpy(record.data() + sizeof(header), data, bytes);
+    }
+
+    if (!writePackFile(mHandle, mFileSize, record.data(), (U32)record.size()))
+    {
+        LL_WARNS("LLDiskCache") << "Failed to append to cache pack " << mFilename << LL_ENDL;
+        // Anything partially written is past mFileSize and will be
+        // overwritten by the next record or cut off by the next load().
+        return false;
+    }
+    data_offset = mFileSize + sizeof(header);
+    mFileSize += record.size();
+    return true;
+}
+
+bool LLDiskCachePack::write(const LLUUID& id, LLAssetType::EType type, const U8* data, S32 bytes)
+{
+    LLExclusiveMutexLock lock(&mMutex);
+    if (mHandle == NO_HANDLE || bytes < 0)
+    {
+        return false;
+    }
+
+    const S64 now = (S64)std::time(nullptr);
+    U64 data_offset;
+    if (!appendRecord(RECORD_DATA, id, type, data, (U32)bytes, now, data_offset))
+    {
+        return false;
+    }
+
+    auto it = mLocations.find(id);
+    if (it != mLocations.end())
+    {
+        mLiveBytes -= it->second.mSize;
+    }
+    mLocations[id] = { data_offset, (U32)bytes, type, now };
+    mLiveBytes += bytes;
+    return true;
+}
+
+void LLDiskCachePack::touch(const LLUUID& id, S64 now)
+{
+    {
+        LLSharedMutexLock lock(&mMutex);
+        auto it = mLocations.find(id);
+        if (it == mLocations.end() || now - it->second.mLastAccess <= TOUCH_INTERVAL)
+        {
+            return;
+        }
+    }
+
+    LLExclusiveMutexLock lock(&mMutex);
+    auto it = mLocations.find(id);
+    if (it == mLocations.end() || now - it->second.mLastAccess <= TOUCH_INTERVAL)
+    {
+        return;
+    }
+    it->second.mLastAccess = now;
+    const U64 time_offset = it->second.mOffset - sizeof(PackRecordHeader) + offsetof(PackRecordHeader, mTime);
+    writePackFile(mHandle, time_offset, &now, sizeof(now));
+}
+
+S32 LLDiskCachePack::read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes)
+{
+    LLSharedMutexLock lock(&mMutex);
+    auto it = mLocations.find(id);
+    if (it == mLocations.end())
+    {
+        return -1;
+    }
+
+    const Location& location = it->second;
+    if (offset < 0 || (U32)offset >= location.mSize || bytes <= 0)
+    {
+        return 0;
+    }
+    U32 to_read = llmin((U32)bytes, location.mSize - (U32)offset);
+    S64 done = readPackFile(mHandle, location.mOffset + offset, buffer, to_read);
+    return done < 0 ? -1 : (S32)done;
+}
+
+bool LLDiskCachePack::readAll(const LLUUID& id, std::vector<U8>& data)
+{
+    LLSharedMutexLock lock(&mMutex);
+    auto it = mLocations.find(id);
+    if (it == mLocations.end())
+    {
+        return false;
+    }
+    data.resize(it->second.mSize);
+    return readPackFile(mHandle, it->second.mOffset, data.data(), it->second.mSize) == (S64)it->second.mSize;
+}
+
+bool LLDiskCachePack::contains(const LLUUID& id)
+{
+    LLSharedMutexLock lock(&mMutex);
+    return mLocations.find(id) != mLocations.end();
+}
+
+S32 LLDiskCachePack::getSize(const LLUUID& id)
+{
+    LLSharedMutexLock lock(&mMutex);
+    auto it = mLocations.find(id);
+    return it == mLocations.end() ? -1 : (S32)it->second.mSize;
+}
+
+bool LLDiskCachePack::remove(const LLUUID& id)
+{
+    LLExclusiveMutexLock lock(&mMutex);
+    auto it = mLocations.find(id);
+    if (it == mLocations.end())
+    {
+        return false;
+    }
+
+    U64 unused;
+    appendRecord(RECORD_TOMBSTONE, id, it->second.mType, nullptr, 0, 0, unused);
+    mLiveBytes -= it->second.mSize;
+    mLocations.erase(it);
+    return true;
+}
+
+bool LLDiskCachePack::rename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type)
+{
+    std::vector<U8> data;
+    if (!readAll(old_id, data))
+    {
+        return false;
+    }
+    write(new_id, new_type, data.data(), (S32)data.size());
+    remove(old_id);
+    return true;
+}
+
+void LLDiskCachePack::clear()
+{
+    LLExclusiveMutexLock lock(&mMutex);
+    if (mHandle == NO_HANDLE)
+    {
+        return;
+    }
+    mLocations.clear();
+    mLiveBytes = 0;
+    truncatePackFile(mHandle, sizeof(PackFileHeader));
+    mFileSize = sizeof(PackFileHeader);
+    ++mGeneration;
+}
+
+bool LLDiskCachePack::compact(F32 dead_ratio, U64 min_dead_bytes)
+{
+    LLMutexLock compact_lock(&mCompactMutex);
+
+    std::unordered_map<LLUUID, Location> snapshot;
+    intptr_t old_handle;
+    U32 old_generation;
+    {
+        LLSharedMutexLock lock(&mMutex);
+        if (mHandle == NO_HANDLE)
+        {
+            return false;
+        }
+        // every live record keeps its header through a compaction
+        const U64 live_bytes = mLiveBytes + (U64)mLocations.size() * sizeof(PackRecordHeader);
+        const U64 dead_bytes = mFileSize - sizeof(PackFileHeader) - live_bytes;
+        if (dead_bytes < min_dead_bytes || dead_bytes < (U64)(mFileSize * dead_ratio))
+        {
+            return false;
+        }
+        snapshot = mLocations;
+        old_handle = mHandle;
+        old_generation = mGeneration;
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    const std::string temp_filename = mFilename + ".tmp";
+    intptr_t new_handle = openPackFile(temp_filename, true);
+    if (new_handle == NO_HANDLE)
+    {
+        return false;
+    }
+
+    PackFileHeader file_header{ PACK_MAGIC, PACK_VERSION };
+    U64 new_size = sizeof(file_header);
+    bool ok = writePackFile(new_handle, 0, &file_header, sizeof(file_header));
+
+    // Copy everything live at snapshot time without blocking readers or
+    // writers. Records already in the old file never change (it is append
+    // only); a clear() or close() in the meantime makes us give up.
+    std::vector<U8> scratch;
+    std::unordered_map<LLUUID, U64> new_offsets;
+    new_offsets.reserve(snapshot.size());
+    for (auto it = snapshot.begin(); ok && it != snapshot.end(); ++it)
+    {
+        LLSharedMutexLock lock(&mMutex);
+        if (mHandle != old_handle || mGeneration != old_generation)
+        {
+            ok = false;
+            break;
+        }
+        U64 new_offset;
+        ok = copyRecord(old_handle, it->second, it->first, new_handle, new_size, new_offset, scratch);
+        new_offsets[it->first] = new_offset;
+    }
+
+    if (ok)
+    {
+        LLExclusiveMutexLock lock(&mMutex);
+        ok = (mHandle == old_handle && mGeneration == old_generation);
+
+        // Pick up whatever changed while we were copying
+        std::unordered_map<LLUUID, Location> new_locations;
+        new_locations.reserve(mLocations.size());
+        for (auto it = mLocations.begin(); ok && it != mLocations.end(); ++it)
+        {
+            Location location = it->second;
+            auto snap = snapshot.find(it->first);
+            if (snap != snapshot.end() && snap->second.mOffset == location.mOffset)
+            {
+                location.mOffset = new_offsets[it->first];
+                if (location.mLastAccess != snap->second.mLastAccess)
+                {
+                    // touched while we were copying
+                    const U64 time_offset = location.mOffset - sizeof(PackRecordHeader) + offsetof(PackRecordHeader, mTime);
+                    ok = writePackFile(new_handle, time_offset, &location.mLastAccess, sizeof(location.mLastAccess));
+                }
+            }
+            else
+            {
+                ok = copyRecord(old_handle, it->second, it->first, new_handle, new_size, location.mOffset, scratch);
+            }
+            new_locations[it->first] = location;
+        }
+
+        if (ok)
+        {
+            closePackFile(mHandle);
+            closePackFile(new_handle);
+            new_handle = NO_HANDLE;
+            // The old pack stays in place until the new one replaces it in
+            // one step, a crash in between leaves one or the other.
+            const bool replaced = replacePackFile(temp_filename, mFilename);
+            if (!replaced)
+            {
+                LL_WARNS("LLDiskCache") << "Unable to replace cache pack " << mFilename << ", keeping it uncompacted" << LL_ENDL;
+                LLFile::remove(temp_filename, ENOENT);
+            }
+            mHandle = openPackFile(mFilename, false);
+            if (mHandle == NO_HANDLE)
+            {
+                LL_WARNS("LLDiskCache") << "Lost cache pack " << mFilename << " during compaction" << LL_ENDL;
+                mLocations.clear();
+                mLiveBytes = 0;
+                mFileSize = 0;
+                return false;
+            }
+            if (!replaced)
+            {
+                return false;
+            }
+            const U64 old_size = mFileSize;
+            mLocations.swap(new_locations);
+            mFileSize = new_size;
+
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+            LL_INFOS("LLDiskCache") << "Compacted cache pack from " << old_size << " to " << new_size
+                                    << " bytes in " << execute_time << " ms" << LL_ENDL;
+        }
+    }
+
+    if (new_handle != NO_HANDLE)
+    {
+        closePackFile(new_handle);
+        LLFile::remove(temp_filename, ENOENT);
+    }
+    return ok;
+}
+
+void LLDiskCachePack::collectEntries(std::vector<LLDiskCacheIndex::Entry>& entries)
+{
+    LLSharedMutexLock lock(&mMutex);
+    entries.reserve(entries.size() + mLocations.size());
+    for (const auto& location : mLocations)
+    {
+        entries.push_back({ location.first, location.second.mType, 0, location.second.mSize, location.second.mLastAccess });
+    }
+}
+
+U64 LLDiskCachePack::getLiveBytes()
+{
+    LLSharedMutexLock lock(&mMutex);
+    return mLiveBytes;
+}
+
+U64 LLDiskCachePack::getFileBytes()
+{
+    LLSharedMutexLock lock(&mMutex);
+    return mFileSize;
+}
+
+U32 LLDiskCachePack::getCount()
+{
+    LLSharedMutexLock lock(&mMutex);
+    return (U32)mLocations.size();
+}
@@ -0,0 +1,157 @@
+/**
+ * @file lldiskcachepack.h
+ * @brief Append-only pack file for small asset cache entries.
+ *
+ * @Description:
+ * Most assets that go through LLFileSystem are tiny (notecards, gestures,
+ * animations, sound headers, small meshes) and storing each of them in its
+ * own sl_cache_* file costs more in inodes, directory entries and open/close
+ * calls than in data. Assets no bigger than a configurable threshold are
+ * instead appended to a single pack file:
+ *
+ *     file header  : magic, version
+ *     record       : kind, id, type, size, followed by size data bytes
+ *
+ * A DATA record supersedes any earlier record for the same id and a
+ * TOMBSTONE record removes it, so the offset index is rebuilt at startup
+ * by one sequential pass over the (memory mapped) file. Dead records are
+ * reclaimed by compact(), which the purge thread calls in the background;
+ * it copies the live records to a new file and only holds the exclusive
+ * lock for the final swap.
+ *
+ * Reads take a shared lock and use positional reads, so any number of
+ * threads can read while a single writer appends.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLDISKCACHEPACK_H
+#define LL_LLDISKCACHEPACK_H
+
+#include "llassettype.h"
+#include "lldiskcacheindex.h"
+#include "llmutex.h"
+#include "lluuid.h"
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+class LLDiskCachePack
+{
+public:
+    LLDiskCachePack();
+    ~LLDiskCachePack();
+
+    /**
+     * Open (creating if needed) the pack file and rebuild the offset index
+     * from it. A torn record at the end, left by a crash, is cut off.
+     */
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const;
+
+    /**
+     * Assets of at most this many bytes are stored in the pack by
+     * LLFileSystem. Zero disables new writes to the pack; assets already
+     * in it stay readable.
+     */
+    void setThreshold(U32 bytes)    { mThreshold = bytes; }
+    U32  getThreshold() const       { return mThreshold; }
+    bool accepts(S32 bytes) const   { return bytes > 0 && (U32)bytes <= mThreshold.load() && isOpen(); }
+
+    /// Store data as the complete content of id, replacing any previous one.
+    bool write(const LLUUID& id, LLAssetType::EType type, const U8* data, S32 bytes);
+
+    /**
+     * Note a read of id at now. The time kept in the pack is only
+     * rewritten once it is an hour old, like the modification time of a
+     * loose cache file.
+     */
+    void touch(const LLUUID& id, S64 now);
+
+    /**
+     * Read up to bytes from offset of id. Returns the number of bytes read,
+     * or -1 if id is not in the pack.
+     */
+    S32  read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes);
+
+    /// Copy out the whole content of id. Returns false if id is not in the pack.
+    bool readAll(const LLUUID& id, std::vector<U8>& data);
+
+    bool contains(const LLUUID& id);
+
+    /// Size of id in bytes, or -1 if id is not in the pack.
+    S32  getSize(const LLUUID& id);
+
+    /// Returns false if id was not in the pack.
+    bool remove(const LLUUID& id);
+
+    /// Move the content of old_id to new_id. Returns false if old_id was not in the pack.
+    bool rename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type);
+
+    /// Drop everything.
+    void clear();
+
+    /**
+     * Rewrite the pack without dead records if they make up more than
+     * dead_ratio of the file and at least min_dead_bytes. Meant to be
+     * called from a background thread.
+     */
+    bool compact(F32 dead_ratio = 0.5f, U64 min_dead_bytes = 4 * 1024 * 1024);
+
+    /// Append an index entry for every asset in the pack (for manifest rebuilds).
+    void collectEntries(std::vector<LLDiskCacheIndex::Entry>& entries);
+
+    U64  getLiveBytes();
+    U64  getFileBytes();
+    U32  getCount();
+
+public:
+    struct Location
+    {
+        U64                 mOffset;    // of the data, not the record header
+        U32                 mSize;
+        LLAssetType::EType  mType;
+        S64                 mLastAccess;    // time_t, as stored in the record
+    };
+
+private:
+    bool appendRecord(U32 kind, const LLUUID& id, LLAssetType::EType type, const U8* data, U32 bytes, S64 time, U64& data_offset);
+    bool load();
+
+private:
+    LLSharedMutex   mMutex;
+    std::string     mFilename;
+    intptr_t        mHandle;
+    U64             mFileSize;
+    U64             mLiveBytes;
+    U32             mGeneration;    // bumped by clear()
+    std::atomic<U32> mThreshold;
+    std::unordered_map<LLUUID, Location> mLocations;
+
+    // Only one compaction at a time
+    LLMutex         mCompactMutex;
+};
+
+#endif // LL_LLDISKCACHEPACK_H
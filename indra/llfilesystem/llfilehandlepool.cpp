@@ -0,0 +1,252 @@
+/**
+ * @file llfilehandlepool.cpp
+ * @brief Per-thread pool of open read handles for asset cache files.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llfilehandlepool.h"
+#include "lldiskcache.h"
+
+#include <mutex>
+
+#if LL_WINDOWS
+#include "llwin32headers.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if LL_WINDOWS
+    typedef HANDLE native_handle_t;
+    const native_handle_t INVALID_NATIVE_HANDLE = INVALID_HANDLE_VALUE;
+#else
+    typedef int native_handle_t;
+    const native_handle_t INVALID_NATIVE_HANDLE = -1;
+#endif
+
+    native_handle_t openForRead(const std::string& filename)
+    {
+#if LL_WINDOWS
+        llutf16string utf16filename = utf8str_to_utf16str(filename);
+        // FILE_SHARE_DELETE so that an idle handle never blocks the purge
+        // or a rename over the file.
+        return CreateFileW(utf16filename.c_str(), GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+        return ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+    }
+
+    void closeHandle(native_handle_t handle)
+    {
+#if LL_WINDOWS
+        CloseHandle(handle);
+#else
+        ::close(handle);
+#endif
+    }
+
+    S32 readAt(native_handle_t handle, S64 offset, U8* buffer, S32 bytes)
+    {
+        S32 total = 0;
+        while (total < bytes)
+        {
+#if LL_WINDOWS
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = (DWORD)((offset + total) & 0xFFFFFFFF);
+            overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+            DWORD bytes_read = 0;
+            if (!ReadFile(handle, buffer + total, (DWORD)(bytes - total), &bytes_read, &overlapped))
+            {
+                if (GetLastError() != ERROR_HANDLE_EOF)
+                {
+                    return total ? total : -1;
+                }
+            }
+            if (bytes_read == 0)
+            {
+                break;
+            }
+#else
+            ssize_t bytes_read = ::pread(handle, buffer + total, bytes - total, (off_t)(offset + total));
+            if (bytes_read < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return total ? total : -1;
+            }
+            if (bytes_read == 0)
+            {
+                break;
+            }
+#endif
+            total += (S32)bytes_read;
+        }
+        return total;
+    }
+
+    struct CachedHandle
+    {
+        LLUUID              mID;
+        LLAssetType::EType  mType;
+        native_handle_t     mHandle;
+    };
+
+    struct ThreadHandles;
+
+    // Every thread's handles, so invalidation can close them all
+    std::mutex sRegistryMutex;
+    std::vector<ThreadHandles*> sRegistry;
+
+    // Most recently used first. With at most MAX_HANDLES_PER_THREAD entries
+    // a linear scan beats any map. mMutex is only contended while another
+    // thread invalidates.
+    struct ThreadHandles
+    {
+        std::mutex mMutex;
+        std::vector<CachedHandle> mHandles;
+
+        ThreadHandles()
+        {
+            std::lock_guard<std::mutex> lock(sRegistryMutex);
+            sRegistry.push_back(this);
+        }
+
+        ~ThreadHandles()
+        {
+            {
+                std::lock_guard<std::mutex> lock(sRegistryMutex);
+                sRegistry.erase(std::find(sRegistry.begin(), sRegistry.end(), this));
+            }
+            std::lock_guard<std::mutex> lock(mMutex);
+            closeAll();
+        }
+
+        void closeAll()
+        {
+            for (CachedHandle& cached : mHandles)
+            {
+                closeHandle(cached.mHandle);
+            }
+            mHandles.clear();
+        }
+
+        void close(const LLUUID& id)
+        {
+            for (auto it = mHandles.begin(); it != mHandles.end(); )
+            {
+                if (it->mID == id)
+                {
+                    closeHandle(it->mHandle);
+                    it = mHandles.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+    };
+
+    thread_local ThreadHandles sThreadHandles;
+
+    // Closes right away rather than when each thread next looks: on Windows
+    // an open handle keeps a deleted file around, and creating the same
+    // cache file again fails until it is closed.
+    template <typename FUNC>
+    void forEachThread(FUNC func)
+    {
+        std::lock_guard<std::mutex> registry_lock(sRegistryMutex);
+        for (ThreadHandles* thread_handles : sRegistry)
+        {
+            std::lock_guard<std::mutex> lock(thread_handles->mMutex);
+            func(*thread_handles);
+        }
+    }
+}
+
+// static
+S32 LLFileHandlePool::read(const LLUUID& id, LLAssetType::EType type, S32 offset, U8* buffer, S32 bytes)
+{
+    std::lock_guard<std::mutex> lock(sThreadHandles.mMutex);
+    std::vector<CachedHandle>& handles = sThreadHandles.mHandles;
+
+    native_handle_t handle = INVALID_NATIVE_HANDLE;
+    for (size_t i = 0; i < handles.size(); ++i)
+    {
+        if (handles[i].mID == id && handles[i].mType == type)
+        {
+            CachedHandle cached = handles[i];
+            handle = cached.mHandle;
+            handles.erase(handles.begin() + i);
+            handles.insert(handles.begin(), cached);
+            break;
+        }
+    }
+
+    if (handle == INVALID_NATIVE_HANDLE)
+    {
+        handle = openForRead(LLDiskCache::metaDataToFilepath(id, type));
+        if (handle == INVALID_NATIVE_HANDLE)
+        {
+            return -1;
+        }
+
+        if (handles.size() >= (size_t)MAX_HANDLES_PER_THREAD)
+        {
+            closeHandle(handles.back().mHandle);
+            handles.pop_back();
+        }
+        handles.insert(handles.begin(), { id, type, handle });
+    }
+
+    return readAt(handle, offset, buffer, bytes);
+}
+
+// static
+void LLFileHandlePool::invalidate(const LLUUID& id)
+{
+    forEachThread([&id](ThreadHandles& thread_handles) { thread_handles.close(id); });
+}
+
+// static
+void LLFileHandlePool::invalidateAll()
+{
+    forEachThread([](ThreadHandles& thread_handles) { thread_handles.closeAll(); });
+}
+
+// static
+void LLFileHandlePool::closeThreadHandles()
+{
+    std::lock_guard<std::mutex> lock(sThreadHandles.mMutex);
+    sThreadHandles.closeAll();
+}
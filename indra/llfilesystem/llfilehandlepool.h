@@ -0,0 +1,70 @@
+/**
+ * @file llfilehandlepool.h
+ * @brief Per-thread pool of open read handles for asset cache files.
+ *
+ * @Description:
+ * LLFileSystem::read() used to build the cache path, open, seek, read and
+ * close the file for every chunk. Mesh and animation loading read the same
+ * asset in many small chunks, so most of that work is repeated. This pool
+ * keeps a handful of files open per thread, keyed by asset id and type,
+ * and reads them with positional reads (pread / overlapped ReadFile) so a
+ * warm read is a single syscall.
+ *
+ * Anything that changes a cache file (write, rename, remove, purge) must
+ * call invalidate() once it is done. That closes the handles every thread
+ * holds for the file before it returns, waiting for a read in progress,
+ * so on Windows a removed file is really gone and can be created again.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFILEHANDLEPOOL_H
+#define LL_LLFILEHANDLEPOOL_H
+
+#include "llassettype.h"
+#include "lluuid.h"
+
+class LLFileHandlePool
+{
+public:
+    /// Maximum number of files each thread keeps open.
+    static const S32 MAX_HANDLES_PER_THREAD = 16;
+
+    /**
+     * Read up to bytes from offset of the cache file for id/type into
+     * buffer. Returns the number of bytes read (0 at end of file), or -1
+     * if the file could not be opened.
+     */
+    static S32 read(const LLUUID& id, LLAssetType::EType type, S32 offset, U8* buffer, S32 bytes);
+
+    /// Forget every handle to the cache file for id, on all threads.
+    static void invalidate(const LLUUID& id);
+
+    /// Forget every handle to every cache file, on all threads.
+    static void invalidateAll();
+
+    /// Close the handles held by the calling thread.
+    static void closeThreadHandles();
+};
+
+#endif // LL_LLFILEHANDLEPOOL_H
@@ -33,6 +33,8 @@
 #include "llfilesystem.h"
 #include "llfasttimer.h"
 #include "lldiskcache.h"
+#include "llfilehandlepool.h" // <FS> Open-once read handles
+#include "lldiskcachepack.h" // <FS> Pack file for small assets
 
 #include "boost/filesystem.hpp"
 
@@ -56,6 +58,23 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
     // we decided to follow Henri's suggestion and move the code to update the last access time here.
     if (mode == LLFileSystem::READ)
     {
+        // <FS> Pack file for small assets
+        if (LLDiskCachePack* pack = LLDiskCache::getPack())
+        {
+            pack->touch(mFileID, (S64)std::time(nullptr));
+        }
+        // </FS>
+        // <FS> Persistent cache manifest
+        // When the manifest knows this file, record the access there instead
+        // of stat'ing and touching the file on disk.
+        LLDiskCacheIndex* index = LLDiskCache::getIndex();
+        if (index && index->isComplete())
+        {
+            index->recordAccess(mFileID, (S64)std::time(nullptr));
+            return;
+        }
+        // </FS>
+
         // build the filename (TODO: we do this in a few places - perhaps we should factor into a single function)
         const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
 
@@ -75,6 +94,12 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
 bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     LL_PROFILE_ZONE_SCOPED;
+    // <FS> Pack file for small assets
+    if (LLDiskCachePack* pack = LLDiskCache::getPack(); pack && pack->getSize(file_id) > 0)
+    {
+        return true;
+    }
+    // </FS>
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
     // <FS:Ansariel> IO-streams replacement
@@ -100,7 +125,22 @@ bool LLFileSystem::removeFile(const LLUUID& file_id, const LLAssetType::EType fi
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
-    LLFile::remove(filename.c_str(), suppress_error);
+    // <FS> Pack file for small assets
+    //LLFile::remove(filename.c_str(), suppress_error);
+    LLDiskCachePack* pack = LLDiskCache::getPack();
+    if (!pack || !pack->remove(file_id))
+    {
+        LLFile::remove(filename.c_str(), suppress_error);
+    }
+    // </FS>
+    LLFileHandlePool::invalidate(file_id); // <FS> Open-once read handles
+
+    // <FS> Persistent cache manifest
+    if (LLDiskCacheIndex* index = LLDiskCache::getIndex())
+    {
+        index->recordRemove(file_id);
+    }
+    // </FS>
 
     return true;
 }
@@ -116,7 +156,26 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
     // Rename needs the new file to not exist.
     LLFileSystem::removeFile(new_file_id, new_file_type, ENOENT);
 
-    if (LLFile::rename(old_filename, new_filename) != 0)
+    // <FS> Pack file for small assets
+    if (LLDiskCachePack* pack = LLDiskCache::getPack(); pack && pack->rename(old_file_id, new_file_id, new_file_type))
+    {
+        LLFileHandlePool::invalidate(old_file_id);
+        LLFileHandlePool::invalidate(new_file_id);
+        if (LLDiskCacheIndex* index = LLDiskCache::getIndex())
+        {
+            index->recordRename(old_file_id, new_file_id, new_file_type);
+        }
+        return true;
+    }
+    // </FS>
+
+    // <FS> Open-once read handles
+    //if (LLFile::rename(old_filename, new_filename) != 0)
+    const bool renamed = (LLFile::rename(old_filename, new_filename) == 0);
+    LLFileHandlePool::invalidate(old_file_id);
+    LLFileHandlePool::invalidate(new_file_id);
+    if (!renamed)
+    // </FS>
     {
         // We would like to return false here indicating the operation
         // failed but the original code does not and doing so seems to
@@ -124,6 +183,12 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
         //return false;
         LL_WARNS() << "Failed to rename " << old_file_id << " to " << new_file_id << " reason: " << strerror(errno) << LL_ENDL;
     }
+    // <FS> Persistent cache manifest
+    else if (LLDiskCacheIndex* index = LLDiskCache::getIndex())
+    {
+        index->recordRename(old_file_id, new_file_id, new_file_type);
+    }
+    // </FS>
 
     return true;
 }
@@ -134,6 +199,17 @@ S32 LLFileSystem::getFileSize(const LLUUID& file_id, const LLAssetType::EType fi
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
+    // <FS> Pack file for small assets
+    if (LLDiskCachePack* pack = LLDiskCache::getPack())
+    {
+        S32 packed_size = pack->getSize(file_id);
+        if (packed_size >= 0)
+        {
+            return packed_size;
+        }
+    }
+    // </FS>
+
     S32 file_size = 0;
     // <FS:Ansariel> IO-streams replacement
     //llifstream file(filename, std::ios::binary);
@@ -157,7 +233,7 @@ bool LLFileSystem::read(U8* buffer, S32 bytes)
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
     bool success = false;
 
-    const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
+    //const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType); // <FS> Open-once read handles
 
     // <FS:Ansariel> IO-streams replacement
     //llifstream file(filename, std::ios::binary);
@@ -184,23 +260,45 @@ bool LLFileSystem::read(U8* buffer, S32 bytes)
     //        success = true;
     //    }
     //}
-    LLFILE* file = LLFile::fopen(filename, "rb");
-    if (file)
+    // <FS> Open-once read handles
+    //LLFILE* file = LLFile::fopen(filename, "rb");
+    //if (file)
+    //{
+    //    if (fseek(file, mPosition, SEEK_SET) == 0)
+    //    {
+    //        mBytesRead = static_cast<S32>(fread(buffer, 1, bytes, file));
+    //        fclose(file);
+
+    //        mPosition += mBytesRead;
+    //        // It probably would be correct to check for mBytesRead == bytes,
+    //        // but that will break avatar rezzing...
+    //        if (mBytesRead)
+    //        {
+    //            success = true;
+    //        }
+    //    }
+    //}
+    // <FS> Pack file for small assets
+    //S32 bytes_read = LLFileHandlePool::read(mFileID, mFileType, mPosition, buffer, bytes);
+    LLDiskCachePack* pack = LLDiskCache::getPack();
+    S32 bytes_read = pack ? pack->read(mFileID, mPosition, buffer, bytes) : -1;
+    if (bytes_read < 0)
     {
-        if (fseek(file, mPosition, SEEK_SET) == 0)
+        bytes_read = LLFileHandlePool::read(mFileID, mFileType, mPosition, buffer, bytes);
+    }
+    // </FS>
+    if (bytes_read >= 0)
+    {
+        mBytesRead = bytes_read;
+        mPosition += mBytesRead;
+        // It probably would be correct to check for mBytesRead == bytes,
+        // but that will break avatar rezzing...
+        if (mBytesRead)
         {
-            mBytesRead = static_cast<S32>(fread(buffer, 1, bytes, file));
-            fclose(file);
-
-            mPosition += mBytesRead;
-            // It probably would be correct to check for mBytesRead == bytes,
-            // but that will break avatar rezzing...
-            if (mBytesRead)
-            {
-                success = true;
-            }
+            success = true;
         }
     }
+    // </FS>
     // </FS:Ansariel>
 
     return success;
@@ -224,6 +322,49 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
     const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
 
     bool success = false;
+    long file_size = -1; // <FS> Persistent cache manifest
+
+    // <FS> Pack file for small assets
+    if (LLDiskCachePack* pack = LLDiskCache::getPack())
+    {
+        if (mMode == WRITE && pack->accepts(bytes))
+        {
+            // WRITE always replaces the whole content, so small ones go
+            // straight into the pack.
+            if (pack->write(mFileID, mFileType, buffer, bytes))
+            {
+                LLFile::remove(filename, ENOENT);
+                LLFileHandlePool::invalidate(mFileID);
+                mPosition = bytes;
+                if (LLDiskCacheIndex* index = LLDiskCache::getIndex())
+                {
+                    index->recordWrite(mFileID, mFileType, (U64)bytes, (S64)std::time(nullptr));
+                }
+                return true;
+            }
+        }
+        else if (mMode != WRITE)
+        {
+            // Appending to or patching a packed asset: move it out to its
+            // own file first, the pack only holds complete assets.
+            std::vector<U8> packed;
+            if (pack->readAll(mFileID, packed))
+            {
+                LLFILE* ofs = LLFile::fopen(filename, "wb");
+                if (ofs)
+                {
+                    fwrite(packed.data(), 1, packed.size(), ofs);
+                    fclose(ofs);
+                }
+                pack->remove(mFileID);
+            }
+        }
+        else
+        {
+            pack->remove(mFileID);
+        }
+    }
+    // </FS>
 
     // <FS:Ansariel> IO-streams replacement
     //if (mMode == APPEND)
@@ -280,6 +421,7 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
         {
             S32 bytes_written = static_cast<S32>(fwrite(buffer, 1, bytes, ofs));
             mPosition = ftell(ofs);
+            file_size = mPosition; // <FS> Persistent cache manifest
             fclose(ofs);
             success = (bytes_written == bytes);
         }
@@ -293,6 +435,12 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
             {
                 S32 bytes_written = static_cast<S32>(fwrite(buffer, 1, bytes, ofs));
                 mPosition = ftell(ofs);
+                // <FS> Persistent cache manifest
+                if (fseek(ofs, 0, SEEK_END) == 0)
+                {
+                    file_size = ftell(ofs);
+                }
+                // </FS>
                 fclose(ofs);
                 success = (bytes_written == bytes);
             }
@@ -304,6 +452,7 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
             {
                 S32 bytes_written = static_cast<S32>(fwrite(buffer, 1, bytes, ofs));
                 mPosition = ftell(ofs);
+                file_size = mPosition; // <FS> Persistent cache manifest
                 fclose(ofs);
                 success = (bytes_written == bytes);
             }
@@ -316,12 +465,25 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
         {
             S32 bytes_written = static_cast<S32>(fwrite(buffer, 1, bytes, ofs));
             mPosition = ftell(ofs);
+            file_size = mPosition; // <FS> Persistent cache manifest
             fclose(ofs);
             success = (bytes_written == bytes);
         }
     }
     // </FS:Ansariel>
 
+    LLFileHandlePool::invalidate(mFileID); // <FS> Open-once read handles
+
+    // <FS> Persistent cache manifest
+    if (file_size >= 0)
+    {
+        if (LLDiskCacheIndex* index = LLDiskCache::getIndex())
+        {
+            index->recordWrite(mFileID, mFileType, (U64)file_size, (S64)std::time(nullptr));
+        }
+    }
+    // </FS>
+
     return success;
 }
 
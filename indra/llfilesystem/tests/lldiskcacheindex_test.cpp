@@ -0,0 +1,340 @@
+/**
+ * @file lldiskcacheindex_test.cpp
+ * @brief LLDiskCacheIndex test cases.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lldiskcacheindex.h"
+#include "llfile.h"
+
+#include "../test/lltut.h"
+
+#include <boost/filesystem.hpp>
+
+namespace tut
+{
+    struct LLDiskCacheIndexFixture
+    {
+        std::string mFilename;
+        std::string mCacheDir;
+
+        LLDiskCacheIndexFixture()
+        {
+            mFilename = std::string(LLFile::tmpdir()) + "lldiskcacheindex_test.idx";
+            mCacheDir = std::string(LLFile::tmpdir()) + "lldiskcacheindex_test_dir";
+            LLFile::remove(mFilename, ENOENT);
+            LLFile::remove(mFilename + ".shared", ENOENT);
+            LLFile::mkdir(mCacheDir);
+        }
+
+        ~LLDiskCacheIndexFixture()
+        {
+            LLFile::remove(mFilename, ENOENT);
+            LLFile::remove(mFilename + ".shared", ENOENT);
+            LLFile::rmdir(mCacheDir);
+        }
+
+        // a clean session that recorded one file
+        void cleanSession(const LLUUID& id)
+        {
+            LLDiskCacheIndex index;
+            index.open(mFilename, { mCacheDir });
+            index.rebuild(std::vector<LLDiskCacheIndex::Entry>());
+            index.recordWrite(id, LLAssetType::AT_SOUND, 10, 1);
+        }
+    };
+    typedef test_group<LLDiskCacheIndexFixture> LLDiskCacheIndex_t;
+    typedef LLDiskCacheIndex_t::object LLDiskCacheIndex_object_t;
+    tut::LLDiskCacheIndex_t tut_LLDiskCacheIndex("LLDiskCacheIndex");
+
+    template<> template<>
+    void LLDiskCacheIndex_object_t::test<1>()
+    {
+        set_test_name("new index is incomplete until rebuilt");
+
+        LLDiskCacheIndex index;
+        ensure("open", index.open(mFilename));
+        ensure("fresh index must be rebuilt", !index.isComplete());
+
+        std::vector<LLDiskCacheIndex::Entry> scanned;
+        scanned.push_back({ LLUUID::generateNewID(), LLAssetType::AT_UNKNOWN, 0, 100, 10 });
+        scanned.push_back({ LLUUID::generateNewID(), LLAssetType::AT_UNKNOWN, 0, 200, 5 });
+        index.rebuild(scanned);
+
+        ensure("complete after rebuild", index.isComplete());
+        ensure_equals("count", index.getEntryCount(), 2U);
+        ensure_equals("size", index.getTotalSize(), (U64)300);
+    }
+
+    template<> template<>
+    void LLDiskCacheIndex_object_t::test<2>()
+    {
+        set_test_name("LRU order and accounting");
+
+        LLDiskCacheIndex index;
+        index.open(mFilename);
+        index.rebuild(std::vector<LLDiskCacheIndex::Entry>());
+
+        LLUUID a = LLUUID::generateNewID();
+        LLUUID b = LLUUID::generateNewID();
+        LLUUID c = LLUUID::generateNewID();
+        index.recordWrite(a, LLAssetType::AT_SOUND, 10, 1);
+        index.recordWrite(b, LLAssetType::AT_SOUND, 20, 2);
+        index.recordWrite(c, LLAssetType::AT_SOUND, 30, 3);
+        index.recordAccess(a, 4);
+
+        // rewriting replaces the size rather than adding to it
+        index.recordWrite(c, LLAssetType::AT_SOUND, 35, 5);
+        ensure_equals("size", index.getTotalSize(), (U64)65);
+
+        LLDiskCacheIndex::Entry entry;
+        ensure("pop b", index.popOldest(entry));
+        ensure_equals("oldest is b", entry.mID, b);
+        ensure("pop a", index.popOldest(entry));
+        ensure_equals("a was touched", entry.mID, a);
+        ensure("pop c", index.popOldest(entry));
+        ensure_equals("c", entry.mID, c);
+        ensure("empty", !index.popOldest(entry));
+        ensure_equals("size after pops", index.getTotalSize(), (U64)0);
+    }
+
+    template<> template<>
+    void LLDiskCacheIndex_object_t::test<3>()
+    {
+        set_test_name("contents persist across a clean close");
+
+        LLUUID a = LLUUID::generateNewID();
+        LLUUID b = LLUUID::generateNewID();
+        {
+            LLDiskCacheIndex index;
+            index.open(mFilename);
+            index.rebuild(std::vector<LLDiskCacheIndex::Entry>());
+            index.recordWrite(a, LLAssetType::AT_ANIMATION, 1000, 1);
+            index.recordWrite(b, LLAssetType::AT_ANIMATION, 2000, 2);
+            index.recordRename(a, b, LLAssetType::AT_ANIMATION);
+        }
+
+        LLDiskCacheIndex index;
+        ensure("reopen", index.open(mFilename));
+        ensure("clean close is trusted", index.isComplete());
+        ensure_equals("rename replaced b", index.getEntryCount(), 1U);
+
+        LLDiskCacheIndex::Entry entry;
+        ensure("b present", index.getEntry(b, entry));
+        ensure_equals("b has a's size", entry.mSize, (U64)1000);
+        ensure("a gone", !index.getEntry(a, entry));
+    }
+
+    template<> template<>
+    void LLDiskCacheIndex_object_t::test<4>()
+    {
+        set_test_name("index grows past its initial capacity");
+
+        LLDiskCacheIndex index;
+        index.open(mFilename);
+        index.rebuild(std::vector<LLDiskCacheIndex::Entry>());
+
+        const U32 count = 40000;
+        for (U32 i = 0; i < count; ++i)
+        {
+            index.recordWrite(LLUUID::generateNewID(), LLAssetType::AT_TEXTURE, 1, i);
+        }
+        ensure_equals("count", index.getEntryCount(), count);
+        ensure_equals("size", index.getTotalSize(), (U64)count);
+
+        LLDiskCacheIndex::Entry entry;
+        ensure("pop", index.popOldest(entry));
+        ensure_equals("oldest first", entry.mLastAccess, (S64)0);
+    }
+
+    template<> template<>
+    void LLDiskCacheIndex_object_t::test<5>()
+    {
+        set_test_name("records of an unclean session are dropped for the scan");
+
+        // a copy taken while the index is open looks like a crash
+        const std::string crashed = mFilename + ".crashed";
+        LLUUID a = LLUUID::generateNewID();
+        LLUUID b = LLUUID::generateNewID();
+        {
+            LLDiskCacheIndex index;
+            index.open(mFilename);
+            index.rebuild(std::vector<LLDiskCacheIndex::Entry>());
+            index.recordWrite(a, LLAssetType::AT_SOUND, 10, 1);
+            index.recordWrite(b, LLAssetType::AT_SOUND, 20, 2);
+            llofstream copy(crashed.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            copy << LLFile::getContents(mFilename);
+        }
+
+        LLDiskCacheIndex index;
+        ensure("reopen", index.open(crashed));
+        ensure("unclean close is not trusted", !index.isComplete());
+        ensure_equals("stale records dropped", index.getEntryCount(), 0U);
+
+        // only b is still on disk
+        std::vector<LLDiskCacheIndex::Entry> scanned;
+        scanned.push_back({ b, LLAssetType::AT_SOUND, 0, 25, 3 });
+        index.rebuild(scanned);
+
+        LLDiskCacheIndex::Entry entry;
+        ensure_equals("count", index.getEntryCount(), 1U);
+        ensure("a gone", !index.getEntry(a, entry));
+        ensure("b from the scan", index.getEntry(b, entry));
+        ensure_equals("scanned size", entry.mSize, (U64)25);
+
+        index.close();
+        LLFile::remove(crashed, ENOENT);
+    }
+
+    template<> template<>
+    void LLDiskCacheIndex_object_t::test<6>()
+    {
+        set_test_name("changes to the cache directories after a clean close are noticed");
+
+        LLUUID a = LLUUID::generateNewID();
+        cleanSession(a);
+        {
+            LLDiskCacheIndex index;
+            ensure("reopen", index.open(mFilename, { mCacheDir }));
+            ensure("untouched cache is trusted", index.isComplete());
+            ensure_equals("count", index.getEntryCount(), 1U);
+        }
+
+        // what another viewer writing or removing a file would do
+        boost::filesystem::path dir(mCacheDir);
+        boost::filesystem::last_write_time(dir, boost::filesystem::last_write_time(dir) - 10);
+
+        LLDiskCacheIndex index;
+        ensure("reopen after the change", index.open(mFilename, { mCacheDir }));
+        ensure("changed cache must be rescanned", !index.isComplete());
+        ensure_equals("records dropped", index.getEntryCount(), 0U);
+    }
+
+    template<> template<>
+    void LLDiskCacheIndex_object_t::test<7>()
+    {
+        set_test_name("an instance without the index makes the holder rescan");
+
+        LLUUID a = LLUUID::generateNewID();
+        cleanSession(a);
+        {
+            LLDiskCacheIndex holder;
+            ensure("holder", holder.open(mFilename, { mCacheDir }));
+            ensure("holder trusts it", holder.isComplete());
+
+            // a second instance can't get the lock and scans instead
+            LLDiskCacheIndex other;
+            ensure("locked out", !other.open(mFilename, { mCacheDir }));
+        }
+
+        {
+            LLDiskCacheIndex index;
+            ensure("reopen", index.open(mFilename, { mCacheDir }));
+            ensure("shared cache must be rescanned", !index.isComplete());
+            index.rebuild(std::vector<LLDiskCacheIndex::Entry>());
+        }
+
+        LLDiskCacheIndex index;
+        ensure("reopen after the rescan", index.open(mFilename, { mCacheDir }));
+        ensure("marker is gone", index.isComplete());
+    }
+
+    template<> template<>
+    void LLDiskCacheIndex_object_t::test<8>()
+    {
+        set_test_name("files removed or renamed during the scan are not brought back");
+
+        LLDiskCacheIndex index;
+        index.open(mFilename);
+
+        // the scan saw all three, then these ran before rebuild()
+        LLUUID removed = LLUUID::generateNewID();
+        LLUUID renamed = LLUUID::generateNewID();
+        LLUUID kept = LLUUID::generateNewID();
+        LLUUID new_name = LLUUID::generateNewID();
+        std::vector<LLDiskCacheIndex::Entry> scanned;
+        scanned.push_back({ removed, LLAssetType::AT_UNKNOWN, 0, 10, 1 });
+        scanned.push_back({ renamed, LLAssetType::AT_UNKNOWN, 0, 20, 2 });
+        scanned.push_back({ kept, LLAssetType::AT_UNKNOWN, 0, 30, 3 });
+        index.recordRemove(removed);
+        index.recordRename(renamed, new_name, LLAssetType::AT_SOUND);
+        index.rebuild(scanned);
+
+        LLDiskCacheIndex::Entry entry;
+        ensure_equals("count", index.getEntryCount(), 2U);
+        ensure_equals("size", index.getTotalSize(), (U64)50);
+        ensure("removed stays gone", !index.getEntry(removed, entry));
+        ensure("old name gone", !index.getEntry(renamed, entry));
+        ensure("new name present", index.getEntry(new_name, entry));
+        ensure_equals("new type", entry.mType, (S32)LLAssetType::AT_SOUND);
+        ensure("kept", index.getEntry(kept, entry));
+
+        // once complete, a remove is only a remove
+        index.recordRemove(kept);
+        index.recordWrite(kept, LLAssetType::AT_SOUND, 5, 4);
+        ensure("written again", index.getEntry(kept, entry));
+    }
+
+    template<> template<>
+    void LLDiskCacheIndex_object_t::test<9>()
+    {
+        set_test_name("recorded access times survive an unclean session");
+
+        const std::string crashed = mFilename + ".crashed";
+        LLUUID a = LLUUID::generateNewID();
+        LLUUID b = LLUUID::generateNewID();
+        {
+            LLDiskCacheIndex index;
+            index.open(mFilename);
+            index.rebuild(std::vector<LLDiskCacheIndex::Entry>());
+            index.recordWrite(a, LLAssetType::AT_SOUND, 10, 1);
+            index.recordWrite(b, LLAssetType::AT_SOUND, 20, 2);
+            // a read: the file itself is not touched
+            index.recordAccess(a, 50);
+            llofstream copy(crashed.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            copy << LLFile::getContents(mFilename);
+        }
+
+        LLDiskCacheIndex index;
+        ensure("reopen", index.open(crashed));
+        ensure("unclean close is not trusted", !index.isComplete());
+
+        // the scan only has the modification times of the writes
+        std::vector<LLDiskCacheIndex::Entry> scanned;
+        scanned.push_back({ a, LLAssetType::AT_UNKNOWN, 0, 10, 1 });
+        scanned.push_back({ b, LLAssetType::AT_UNKNOWN, 0, 20, 2 });
+        index.rebuild(scanned);
+
+        LLDiskCacheIndex::Entry entry;
+        ensure("pop", index.popOldest(entry));
+        ensure_equals("b is older than the read of a", entry.mID, b);
+        ensure("a", index.getEntry(a, entry));
+        ensure_equals("recorded access time", entry.mLastAccess, (S64)50);
+
+        index.close();
+        LLFile::remove(crashed, ENOENT);
+    }
+}
@@ -0,0 +1,325 @@
+/**
+ * @file lldiskcachepack_test.cpp
+ * @brief Tests and benchmark for the small asset pack file.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lldiskcachepack.h"
+#include "llfile.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+
+namespace
+{
+    // A typical cache of small assets
+    const S32 BENCH_ASSET_COUNT = 100000;
+    const S32 BENCH_ASSET_SIZE = 1024;
+
+    F64 secondsSince(const std::chrono::steady_clock::time_point& start)
+    {
+        std::chrono::duration<F64> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    // Read and write syscalls made by this process so far, -1 where the
+    // system doesn't tell. Opens and closes are counted by the benchmark.
+    S64 ioSyscalls()
+    {
+#if LL_LINUX
+        // stat() reports no size for /proc files, so no getContents()
+        llifstream io("/proc/self/io");
+        S64 total = 0;
+        S32 found = 0;
+        std::string line;
+        while (std::getline(io, line))
+        {
+            if (line.rfind("syscr: ", 0) == 0 || line.rfind("syscw: ", 0) == 0)
+            {
+                total += atoll(line.c_str() + 7);
+                ++found;
+            }
+        }
+        return found == 2 ? total : -1;
+#else
+        return -1;
+#endif
+    }
+}
+
+namespace tut
+{
+    struct LLDiskCachePackFixture
+    {
+        std::string mFilename;
+        LLDiskCachePack mPack;
+
+        LLDiskCachePackFixture()
+        {
+            mFilename = std::string(LLFile::tmpdir()) + "lldiskcachepack_test.dat";
+            LLFile::remove(mFilename, ENOENT);
+            LLFile::remove(mFilename + ".tmp", ENOENT);
+        }
+
+        ~LLDiskCachePackFixture()
+        {
+            mPack.close();
+            LLFile::remove(mFilename, ENOENT);
+            LLFile::remove(mFilename + ".tmp", ENOENT);
+        }
+    };
+    typedef test_group<LLDiskCachePackFixture> LLDiskCachePack_t;
+    typedef LLDiskCachePack_t::object LLDiskCachePack_object_t;
+    tut::LLDiskCachePack_t tut_LLDiskCachePack("LLDiskCachePack");
+
+    template<> template<>
+    void LLDiskCachePack_object_t::test<1>()
+    {
+        set_test_name("write, replace, remove and rename survive a reopen");
+
+        ensure("open", mPack.open(mFilename));
+
+        LLUUID a = LLUUID::generateNewID();
+        LLUUID b = LLUUID::generateNewID();
+        LLUUID c = LLUUID::generateNewID();
+        U8 first[3] = { 1, 2, 3 };
+        U8 second[5] = { 5, 6, 7, 8, 9 };
+
+        ensure("write a", mPack.write(a, LLAssetType::AT_NOTECARD, first, sizeof(first)));
+        ensure("replace a", mPack.write(a, LLAssetType::AT_NOTECARD, second, sizeof(second)));
+        ensure("write b", mPack.write(b, LLAssetType::AT_GESTURE, first, sizeof(first)));
+        ensure("remove b", mPack.remove(b));
+        ensure("write c", mPack.write(c, LLAssetType::AT_SOUND, first, sizeof(first)));
+        LLUUID d = LLUUID::generateNewID();
+        ensure("rename c", mPack.rename(c, d, LLAssetType::AT_SOUND));
+
+        mPack.close();
+        ensure("reopen", mPack.open(mFilename));
+
+        ensure_equals("count", mPack.getCount(), 2U);
+        ensure_equals("size of a", mPack.getSize(a), (S32)sizeof(second));
+        ensure("b removed", !mPack.contains(b));
+        ensure("c renamed away", !mPack.contains(c));
+        ensure("d present", mPack.contains(d));
+
+        U8 buffer[8] = {};
+        ensure_equals("partial read", mPack.read(a, 2, buffer, sizeof(buffer)), 3);
+        ensure_equals("byte 2 of a", (S32)buffer[0], 7);
+        ensure_equals("missing id", mPack.read(b, 0, buffer, sizeof(buffer)), -1);
+    }
+
+    template<> template<>
+    void LLDiskCachePack_object_t::test<2>()
+    {
+        set_test_name("torn tail is dropped and compaction keeps live data");
+
+        ensure("open", mPack.open(mFilename));
+
+        std::vector<U8> data(1000, 0x5A);
+        LLUUID keep = LLUUID::generateNewID();
+        ensure("write keep", mPack.write(keep, LLAssetType::AT_ANIMATION, data.data(), (S32)data.size()));
+        for (S32 i = 0; i < 20; ++i)
+        {
+            LLUUID id = LLUUID::generateNewID();
+            mPack.write(id, LLAssetType::AT_ANIMATION, data.data(), (S32)data.size());
+            mPack.remove(id);
+        }
+        mPack.close();
+
+        // Simulate a crash part way through an append
+        LLFILE* file = LLFile::fopen(mFilename, "ab");
+        ensure("append", file != nullptr);
+        U8 garbage[7] = { 1, 0, 0, 0, 0xFF, 0xFF, 0xFF };
+        fwrite(garbage, 1, sizeof(garbage), file);
+        fclose(file);
+
+        ensure("reopen", mPack.open(mFilename));
+        ensure_equals("count after torn tail", mPack.getCount(), 1U);
+
+        U64 before = mPack.getFileBytes();
+        ensure("compacted", mPack.compact(0.5f, 0));
+        ensure("file shrank", mPack.getFileBytes() < before);
+
+        std::vector<U8> read_back;
+        ensure("readAll", mPack.readAll(keep, read_back));
+        ensure("content kept", read_back == data);
+    }
+
+    template<> template<>
+    void LLDiskCachePack_object_t::test<3>()
+    {
+        set_test_name("access times are kept for manifest rebuilds");
+
+        ensure("open", mPack.open(mFilename));
+        const S64 now = (S64)std::time(nullptr);
+        LLUUID a = LLUUID::generateNewID();
+        LLUUID b = LLUUID::generateNewID();
+        U8 data[4] = { 1, 2, 3, 4 };
+        mPack.write(a, LLAssetType::AT_NOTECARD, data, sizeof(data));
+        mPack.write(b, LLAssetType::AT_NOTECARD, data, sizeof(data));
+        // a is read again two hours later, b is only re-read right away
+        mPack.touch(a, now + 2 * 60 * 60);
+        mPack.touch(b, now + 60);
+        mPack.close();
+
+        ensure("reopen", mPack.open(mFilename));
+        std::vector<LLDiskCacheIndex::Entry> entries;
+        mPack.collectEntries(entries);
+        ensure_equals("count", entries.size(), (size_t)2);
+        for (const LLDiskCacheIndex::Entry& entry : entries)
+        {
+            if (entry.mID == a)
+            {
+                ensure_equals("a touched", entry.mLastAccess, now + 2 * 60 * 60);
+            }
+            else
+            {
+                ensure("b written", entry.mLastAccess >= now && entry.mLastAccess < now + 60);
+            }
+        }
+
+        // and survive a compaction
+        mPack.remove(b);
+        ensure("compacted", mPack.compact(0.f, 0));
+        entries.clear();
+        mPack.collectEntries(entries);
+        ensure_equals("compacted count", entries.size(), (size_t)1);
+        ensure_equals("a after compaction", entries[0].mLastAccess, now + 2 * 60 * 60);
+    }
+
+    template<> template<>
+    void LLDiskCachePack_object_t::test<4>()
+    {
+        set_test_name("small asset write and cold start, loose files vs pack");
+
+        skip_unless_benchmarks();
+
+        std::vector<U8> data(BENCH_ASSET_SIZE, 0x42);
+        std::vector<LLUUID> ids;
+        for (S32 i = 0; i < BENCH_ASSET_COUNT; ++i)
+        {
+            ids.push_back(LLUUID::generateNewID());
+        }
+        const std::string loose_prefix = std::string(LLFile::tmpdir()) + "lldiskcachepack_test_";
+
+        // One file per asset, as LLFileSystem does without the pack
+        S64 syscalls = ioSyscalls();
+        auto start = std::chrono::steady_clock::now();
+        for (const LLUUID& id : ids)
+        {
+            LLFILE* file = LLFile::fopen(loose_prefix + id.asString(), "wb");
+            if (file)
+            {
+                fwrite(data.data(), 1, data.size(), file);
+                fclose(file);
+            }
+        }
+        F64 loose_write = secondsSince(start);
+        S64 loose_write_calls = ioSyscalls() - syscalls;
+
+        syscalls = ioSyscalls();
+        start = std::chrono::steady_clock::now();
+        S32 loose_found = 0;
+        std::vector<U8> buffer(BENCH_ASSET_SIZE);
+        for (const LLUUID& id : ids)
+        {
+            LLFILE* file = LLFile::fopen(loose_prefix + id.asString(), "rb");
+            if (file)
+            {
+                loose_found += fread(buffer.data(), 1, buffer.size(), file) == buffer.size();
+                fclose(file);
+            }
+        }
+        F64 loose_read = secondsSince(start);
+        S64 loose_read_calls = ioSyscalls() - syscalls;
+
+        for (const LLUUID& id : ids)
+        {
+            LLFile::remove(loose_prefix + id.asString());
+        }
+
+        ensure("open", mPack.open(mFilename));
+        syscalls = ioSyscalls();
+        start = std::chrono::steady_clock::now();
+        for (const LLUUID& id : ids)
+        {
+            mPack.write(id, LLAssetType::AT_NOTECARD, data.data(), (S32)data.size());
+        }
+        F64 pack_write = secondsSince(start);
+        S64 pack_write_calls = ioSyscalls() - syscalls;
+        mPack.close();
+
+        // Cold start: rebuild the index from the file, then read everything
+        syscalls = ioSyscalls();
+        start = std::chrono::steady_clock::now();
+        ensure("reopen", mPack.open(mFilename));
+        F64 pack_open = secondsSince(start);
+        S32 pack_found = 0;
+        for (const LLUUID& id : ids)
+        {
+            pack_found += mPack.read(id, 0, buffer.data(), (S32)buffer.size()) == BENCH_ASSET_SIZE;
+        }
+        F64 pack_read = secondsSince(start);
+        S64 pack_read_calls = ioSyscalls() - syscalls;
+
+        // opens and closes: one of each per asset and pass for loose files,
+        // one pair per open() of the pack plus its read only mapping
+        std::cout << "\n" << BENCH_ASSET_COUNT << " assets of " << BENCH_ASSET_SIZE << " bytes"
+                  << " (read/write syscalls, plus opens+closes):\n"
+                  << "  loose files: write " << loose_write << "s, " << loose_write_calls << " + " << 2 * BENCH_ASSET_COUNT
+                  << "; read " << loose_read << "s, " << loose_read_calls << " + " << 2 * BENCH_ASSET_COUNT << "\n"
+                  << "  pack:        write " << pack_write << "s, " << pack_write_calls << " + 0"
+                  << "; open " << pack_open << "s, open+read " << pack_read << "s, " << pack_read_calls << " + 4"
+                  << std::endl;
+
+        ensure_equals("loose reads", loose_found, BENCH_ASSET_COUNT);
+        ensure_equals("pack reads", pack_found, BENCH_ASSET_COUNT);
+    }
+
+    template<> template<>
+    void LLDiskCachePack_object_t::test<5>()
+    {
+        set_test_name("record headers of live entries are not dead space");
+
+        ensure("open", mPack.open(mFilename));
+        U8 data[4] = { 1, 2, 3, 4 };
+        for (S32 i = 0; i < 1000; ++i)
+        {
+            mPack.write(LLUUID::generateNewID(), LLAssetType::AT_NOTECARD, data, sizeof(data));
+        }
+        ensure("nothing to compact", !mPack.compact(0.5f, 0));
+
+        LLUUID replaced = LLUUID::generateNewID();
+        std::vector<U8> big(64 * 1024, 0x42);
+        mPack.write(replaced, LLAssetType::AT_NOTECARD, big.data(), (S32)big.size());
+        mPack.write(replaced, LLAssetType::AT_NOTECARD, data, sizeof(data));
+        ensure("replaced data is dead", mPack.compact(0.5f, 0));
+        ensure("compacted once", !mPack.compact(0.5f, 0));
+    }
+}
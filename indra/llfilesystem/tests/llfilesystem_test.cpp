@@ -0,0 +1,267 @@
+/**
+ * @file llfilesystem_test.cpp
+ * @brief LLFileSystem read path tests and benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lldiskcache.h"
+#include "../llfilehandlepool.h"
+#include "../llfilesystem.h"
+#include "llfile.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <thread>
+
+#if LL_LINUX
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const S32 ASSET_COUNT = 500;
+    const S32 ASSET_SIZE = 64 * 1024;
+    const S32 CHUNK_SIZE = 4096;
+
+    // What LLFileSystem::read() did for every chunk before the handle pool
+    bool legacyRead(const LLUUID& id, S32 position, U8* buffer, S32 bytes)
+    {
+        const std::string filename = LLDiskCache::metaDataToFilepath(id, LLAssetType::AT_ANIMATION);
+        LLFILE* file = LLFile::fopen(filename, "rb");
+        if (!file)
+        {
+            return false;
+        }
+        bool success = false;
+        if (fseek(file, position, SEEK_SET) == 0)
+        {
+            success = fread(buffer, 1, bytes, file) > 0;
+        }
+        fclose(file);
+        return success;
+    }
+
+    template <typename READ>
+    F64 chunkedReadsPerSecond(const std::vector<LLUUID>& ids, READ read_chunk)
+    {
+        std::vector<U8> buffer(CHUNK_SIZE);
+        S64 reads = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const LLUUID& id : ids)
+        {
+            for (S32 pos = 0; pos < ASSET_SIZE; pos += CHUNK_SIZE)
+            {
+                read_chunk(id, pos, buffer.data());
+                ++reads;
+            }
+        }
+        std::chrono::duration<F64> elapsed = std::chrono::steady_clock::now() - start;
+        return reads / llmax(elapsed.count(), 1e-9);
+    }
+
+#if LL_LINUX
+    // Whether this process still has filename open
+    bool isOpen(const std::string& filename)
+    {
+        bool found = false;
+        if (DIR* fds = opendir("/proc/self/fd"))
+        {
+            while (dirent* fd = readdir(fds))
+            {
+                char target[4096];
+                ssize_t length = readlink((std::string("/proc/self/fd/") + fd->d_name).c_str(), target, sizeof(target) - 1);
+                if (length > 0 && std::string(target, length).find(filename) == 0)
+                {
+                    found = true;
+                }
+            }
+            closedir(fds);
+        }
+        return found;
+    }
+#endif
+}
+
+namespace tut
+{
+    struct LLFileSystemFixture
+    {
+        std::string mCacheDir;
+        std::vector<LLUUID> mIDs;
+
+        LLFileSystemFixture()
+        {
+            mCacheDir = std::string(LLFile::tmpdir()) + "llfilesystem_test_cache";
+            if (!LLDiskCache::instanceExists())
+            {
+                LLDiskCache::initParamSingleton(mCacheDir, (uintmax_t)1024 * 1024 * 1024, false, 95.f, 70.f);
+            }
+        }
+
+        void writeAssets(S32 count)
+        {
+            std::vector<U8> data(ASSET_SIZE);
+            for (S32 i = 0; i < ASSET_SIZE; ++i)
+            {
+                data[i] = (U8)(i & 0xFF);
+            }
+            for (S32 i = 0; i < count; ++i)
+            {
+                LLUUID id = LLUUID::generateNewID();
+                LLFileSystem file(id, LLAssetType::AT_ANIMATION, LLFileSystem::WRITE);
+                file.write(data.data(), ASSET_SIZE);
+                mIDs.push_back(id);
+            }
+        }
+
+        ~LLFileSystemFixture()
+        {
+            for (const LLUUID& id : mIDs)
+            {
+                LLFileSystem::removeFile(id, LLAssetType::AT_ANIMATION, ENOENT);
+            }
+        }
+    };
+    typedef test_group<LLFileSystemFixture> LLFileSystem_t;
+    typedef LLFileSystem_t::object LLFileSystem_object_t;
+    tut::LLFileSystem_t tut_LLFileSystem("LLFileSystem");
+
+    template<> template<>
+    void LLFileSystem_object_t::test<1>()
+    {
+        set_test_name("chunked reads see rewritten content");
+
+        writeAssets(1);
+        const LLUUID& id = mIDs[0];
+
+        U8 value = 0;
+        LLFileSystem reader(id, LLAssetType::AT_ANIMATION, LLFileSystem::READ);
+        reader.seek(1);
+        ensure("read", reader.read(&value, 1));
+        ensure_equals("byte 1", (S32)value, 1);
+
+        // Rewrite the asset; the cached handle must not serve stale data
+        U8 replacement[4] = { 9, 8, 7, 6 };
+        LLFileSystem writer(id, LLAssetType::AT_ANIMATION, LLFileSystem::WRITE);
+        writer.write(replacement, sizeof(replacement));
+
+        LLFileSystem reread(id, LLAssetType::AT_ANIMATION, LLFileSystem::READ);
+        reread.seek(1);
+        ensure("reread", reread.read(&value, 1));
+        ensure_equals("rewritten byte 1", (S32)value, 8);
+
+        LLFileSystem::removeFile(id, LLAssetType::AT_ANIMATION);
+        LLFileSystem gone(id, LLAssetType::AT_ANIMATION, LLFileSystem::READ);
+        ensure("removed file is not readable", !gone.read(&value, 1));
+    }
+
+    template<> template<>
+    void LLFileSystem_object_t::test<2>()
+    {
+        set_test_name("cold and warm asset reads per second");
+
+        skip_unless_benchmarks();
+
+        writeAssets(ASSET_COUNT);
+
+        F64 legacy = chunkedReadsPerSecond(mIDs, [](const LLUUID& id, S32 pos, U8* buffer)
+        {
+            legacyRead(id, pos, buffer, CHUNK_SIZE);
+        });
+
+        // Cold: every asset's first chunk has to open the file
+        LLFileHandlePool::invalidateAll();
+        F64 cold = chunkedReadsPerSecond(mIDs, [](const LLUUID& id, S32 pos, U8* buffer)
+        {
+            LLFileSystem file(id, LLAssetType::AT_ANIMATION, LLFileSystem::READ);
+            file.seek(pos, 0);
+            file.read(buffer, CHUNK_SIZE);
+        });
+
+        // Warm: a handful of assets read over and over, as mesh and
+        // animation decoding does
+        std::vector<LLUUID> hot;
+        for (S32 i = 0; i < 100; ++i)
+        {
+            hot.push_back(mIDs[i % LLFileHandlePool::MAX_HANDLES_PER_THREAD]);
+        }
+        F64 warm = chunkedReadsPerSecond(hot, [](const LLUUID& id, S32 pos, U8* buffer)
+        {
+            LLFileSystem file(id, LLAssetType::AT_ANIMATION, LLFileSystem::READ);
+            file.seek(pos, 0);
+            file.read(buffer, CHUNK_SIZE);
+        });
+
+        std::cout << "\nLLFileSystem " << CHUNK_SIZE << " byte chunk reads/sec:"
+                  << " fopen per read " << (S64)legacy
+                  << ", pooled cold " << (S64)cold
+                  << ", pooled warm " << (S64)warm << std::endl;
+
+        ensure("benchmark ran", legacy > 0 && cold > 0 && warm > 0);
+    }
+
+    template<> template<>
+    void LLFileSystem_object_t::test<3>()
+    {
+        set_test_name("removing a file closes the handles other threads hold");
+
+        writeAssets(1);
+        const LLUUID id = mIDs[0];
+        const std::string filename = LLDiskCache::metaDataToFilepath(id, LLAssetType::AT_ANIMATION);
+
+        // a reader thread that keeps its handle, as a decode thread would
+        std::promise<bool> read;
+        std::promise<void> done;
+        std::thread reader([&]()
+            {
+                U8 value = 0;
+                LLFileSystem file(id, LLAssetType::AT_ANIMATION, LLFileSystem::READ);
+                read.set_value(file.read(&value, 1));
+                done.get_future().wait();
+            });
+        ensure("read on the other thread", read.get_future().get());
+#if LL_LINUX
+        ensure("held open", isOpen(filename));
+#endif
+
+        LLFileSystem::removeFile(id, LLAssetType::AT_ANIMATION);
+#if LL_LINUX
+        ensure("closed by the remove", !isOpen(filename));
+#endif
+
+        // what fails on Windows while the old file is still held
+        U8 replacement[4] = { 9, 8, 7, 6 };
+        LLFileSystem writer(id, LLAssetType::AT_ANIMATION, LLFileSystem::WRITE);
+        ensure("created again", writer.write(replacement, sizeof(replacement)));
+
+        done.set_value();
+        reader.join();
+    }
+}
@@ -42,6 +42,8 @@ LLImageJ2CImpl* fallbackCreateLLImageJ2CImpl();
 LLImageCompressionTester* LLImageJ2C::sTesterp = NULL ;
 const std::string sTesterName("ImageCompressionTester");
 
+std::atomic<S32> LLImageJ2C::sDecodeThreads{ 1 };
+
 //static
 std::string LLImageJ2C::getEngineInfo()
 {
@@ -51,6 +53,18 @@ std::string LLImageJ2C::getEngineInfo()
     return impl->getEngineInfo();
 }
 
+//static
+void LLImageJ2C::setDecodeThreads(S32 threads)
+{
+    sDecodeThreads = llmax(threads, 1);
+}
+
+//static
+S32 LLImageJ2C::getDecodeThreads()
+{
+    return sDecodeThreads;
+}
+
 LLImageJ2C::LLImageJ2C() :  LLImageFormatted(IMG_CODEC_J2C),
                             mMaxBytes(0),
                             mRawDiscardLevel(-1),
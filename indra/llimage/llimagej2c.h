@@ -31,6 +31,8 @@
 #include "llassettype.h"
 #include "llmetricperformancetester.h"
 
+#include <atomic>
+
 // JPEG2000 : compression rate used in j2c conversion.
 const F32 DEFAULT_COMPRESSION_RATE = 1.f/8.f;
 
@@ -78,6 +80,11 @@ public:
 
     static std::string getEngineInfo();
 
+    // Threads a single codestream decode may use, on top of the decode
+    // thread pool. Only large images are worth splitting.
+    static void setDecodeThreads(S32 threads);
+    static S32 getDecodeThreads();
+
 protected:
     friend class LLImageJ2CImpl;
     friend class LLImageJ2COJ;
@@ -99,6 +106,8 @@ protected:
 
     // Image compression/decompression tester
     static LLImageCompressionTester* sTesterp;
+
+    static std::atomic<S32> sDecodeThreads;
 };
 
 // Derive from this class to implement JPEG2000 decoding
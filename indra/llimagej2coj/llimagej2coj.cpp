@@ -34,6 +34,16 @@
 
 #define MAX_ENCODED_DISCARD_LEVELS 5
 
+// Below this many decoded pixels, starting OpenJPEG's thread pool costs
+// more than it saves.
+constexpr U32 MIN_THREADED_DECODE_AREA = 512 * 512;
+
+#if OPJ_VERSION_MAJOR > 2 || (OPJ_VERSION_MAJOR == 2 && OPJ_VERSION_MINOR >= 2)
+#define LL_OPJ_THREADS 1
+#else
+#define LL_OPJ_THREADS 0
+#endif
+
 // Factory function: see declaration in llimagej2c.cpp
 LLImageJ2CImpl* fallbackCreateLLImageJ2CImpl()
 {
@@ -97,6 +107,65 @@ int ceildivpow2(int a, int b)
     return (a + (1 << b) - 1) >> b;
 }
 
+// Where a decode at discard_level may stop reading: the start of the first
+// tile-part it doesn't need, or 0 if the stream can't be cut. Only single
+// tile, resolution-major (RLCP/RPCL) streams with one tile-part per
+// resolution, as JPEG2KEncode writes them, have such a boundary. In
+// anything else the packets of the last quality layers come at the end.
+static S32 resolution_cut(const U8* data, S32 size, S32 discard_level)
+{
+    // SOC, then marker segments with a 16 bit length up to the first SOT
+    if (discard_level <= 0 || size < 4 || data[0] != 0xff || data[1] != 0x4f)
+    {
+        return 0;
+    }
+    S32 order = -1;
+    S32 levels = -1;
+    S32 pos = 2;
+    while (pos + 4 <= size && data[pos] == 0xff && data[pos + 1] != 0x90)
+    {
+        U8 marker = data[pos + 1];
+        S32 length = (data[pos + 2] << 8) | data[pos + 3];
+        if (marker == 0x52 && pos + 10 <= size) // COD: Scod, order, layers, MCT, decomposition levels
+        {
+            order = data[pos + 5];
+            levels = data[pos + 9];
+        }
+        else if (marker == 0x53) // COC: a component with its own levels
+        {
+            return 0;
+        }
+        pos += 2 + length;
+    }
+    if ((order != OPJ_RLCP && order != OPJ_RPCL) || discard_level > levels)
+    {
+        return 0;
+    }
+
+    // SOT: Lsot, Isot, Psot (length of the tile-part), TPsot (its index), TNsot (count)
+    const S32 resolutions = levels + 1;
+    const S32 needed = resolutions - discard_level;
+    for (S32 part = 0; pos + 12 <= size && data[pos] == 0xff && data[pos + 1] == 0x90; ++part)
+    {
+        U32 tile = (data[pos + 4] << 8) | data[pos + 5];
+        U32 length = ((U32)data[pos + 6] << 24) | (data[pos + 7] << 16) | (data[pos + 8] << 8) | data[pos + 9];
+        if (tile != 0 || data[pos + 10] != part || data[pos + 11] != resolutions || length == 0)
+        {
+            return 0;
+        }
+        if (part == needed)
+        {
+            return pos;
+        }
+        if (length > (U32)(size - pos))
+        {
+            break;
+        }
+        pos += length;
+    }
+    return 0;
+}
+
 class JPEG2KBase
 {
 public:
@@ -336,13 +405,22 @@ public:
         return true;
     }
 
-    bool decode(U8* data, U32 dataSize, U32* channels, U8 discard_level)
+    bool decode(U8* data, U32 dataSize, U32* channels, U8 discard_level, S32 threads = 1)
     {
         parameters.flags &= ~OPJ_DPARAMETERS_DUMP_FLAG;
 
         decoder = opj_create_decompress(OPJ_CODEC_J2K);
         opj_setup_decoder(decoder, &parameters);
 
+#if LL_OPJ_THREADS
+        // decode code blocks of this image in parallel, has to be set
+        // before the header is read
+        if (threads > 1 && opj_has_thread_support())
+        {
+            opj_codec_set_threads(decoder, threads);
+        }
+#endif
+
         opj_set_info_handler(decoder, opj_info, this);
         opj_set_warning_handler(decoder, opj_warn, this);
         opj_set_error_handler(decoder, opj_error, this);
@@ -499,6 +577,10 @@ public:
         parameters.tcp_mct = (image->numcomps >= 3) ? 1 : 0;
         parameters.cod_format = OPJ_CODEC_J2K;
         parameters.prog_order = OPJ_RLCP;
+        // one tile-part per resolution, so reduced decodes can stop at a
+        // tile-part boundary (see resolution_cut())
+        parameters.tp_on = 1;
+        parameters.tp_flag = 'R';
         parameters.cp_disto_alloc = 1;
 
         // if not lossless compression, computes tcp_numlayers and max_cs_size depending on the image dimensions
@@ -828,7 +910,25 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
     U32 image_channels = 0;
     S32 data_size = base.getDataSize();
     S32 max_bytes = (base.getMaxBytes() ? base.getMaxBytes() : data_size);
-    bool decoded = decoder.decode(base.getData(), max_bytes, &image_channels, base.mDiscardLevel);
+
+    // The tile-parts of the resolutions past the requested discard level
+    // would only be parsed to be skipped
+    S32 discard_level = base.mDiscardLevel;
+    S32 cut = resolution_cut(c_data, llmin(c_size, max_bytes), discard_level);
+    if (cut > 0)
+    {
+        max_bytes = cut;
+    }
+
+    S32 threads = 1;
+    S32 reduce = llclamp(discard_level, 0, (S32)MAX_DISCARD_LEVEL);
+    U32 decoded_area = (U32)(base.getWidth() >> reduce) * (U32)(base.getHeight() >> reduce);
+    if (decoded_area >= MIN_THREADED_DECODE_AREA)
+    {
+        threads = LLImageJ2C::getDecodeThreads();
+    }
+
+    bool decoded = decoder.decode(base.getData(), max_bytes, &image_channels, discard_level, threads);
 
     // set correct channel count early so failed decodes don't miss it...
     S32 channels = (S32)image_channels - first_channel;
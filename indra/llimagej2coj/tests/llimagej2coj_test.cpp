@@ -0,0 +1,276 @@
+/**
+ * @file llimagej2coj_test.cpp
+ * @brief OpenJPEG decode tests and per discard level decode benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagej2c.h"
+#include "llmemory.h"
+#include "llstring.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    struct CorpusEntry
+    {
+        std::string mName;
+        std::vector<U8> mData;
+    };
+
+    LLPointer<LLImageJ2C> makeJ2C(const std::vector<U8>& data)
+    {
+        LLPointer<LLImageJ2C> j2c = new LLImageJ2C;
+        U8* copy = (U8*)ll_aligned_malloc_16(data.size());
+        memcpy(copy, data.data(), data.size());
+        if (!j2c->validate(copy, (U32)data.size()))
+        {
+            return nullptr;
+        }
+        return j2c;
+    }
+
+    // Something with detail at every scale, so no resolution is free
+    LLPointer<LLImageRaw> makeRaw(S32 size, S8 components)
+    {
+        LLPointer<LLImageRaw> raw = new LLImageRaw(size, size, components);
+        U8* data = raw->getData();
+        U32 seed = 12345;
+        for (S32 y = 0; y < size; ++y)
+        {
+            for (S32 x = 0; x < size; ++x)
+            {
+                seed = seed * 1664525 + 1013904223;
+                for (S32 c = 0; c < components; ++c)
+                {
+                    *data++ = (U8)(((x ^ y) >> c) + (x * (c + 1)) / 7 + ((seed >> 24) & 0x1f));
+                }
+            }
+        }
+        return raw;
+    }
+
+    std::vector<U8> encode(S32 size, S8 components)
+    {
+        LLPointer<LLImageJ2C> j2c = new LLImageJ2C;
+        if (!j2c->encode(makeRaw(size, components), 0.f))
+        {
+            return std::vector<U8>();
+        }
+        return std::vector<U8>(j2c->getData(), j2c->getData() + j2c->getDataSize());
+    }
+
+    // Offsets of the tile-part (SOT) markers of a codestream
+    std::vector<size_t> tileParts(const std::vector<U8>& data)
+    {
+        std::vector<size_t> parts;
+        size_t pos = 2;
+        while (pos + 4 <= data.size() && data[pos] == 0xff && data[pos + 1] != 0x90)
+        {
+            pos += 2 + ((data[pos + 2] << 8) | data[pos + 3]);
+        }
+        while (pos + 12 <= data.size() && data[pos] == 0xff && data[pos + 1] == 0x90)
+        {
+            parts.push_back(pos);
+            U32 length = ((U32)data[pos + 6] << 24) | (data[pos + 7] << 16) | (data[pos + 8] << 8) | data[pos + 9];
+            if (!length)
+            {
+                break;
+            }
+            pos += length;
+        }
+        return parts;
+    }
+
+    // The same codestream with its tile-part count marked unknown, which
+    // the decoder never cuts short
+    std::vector<U8> uncut(std::vector<U8> data)
+    {
+        for (size_t pos : tileParts(data))
+        {
+            data[pos + 11] = 0;
+        }
+        return data;
+    }
+
+    // The files in $J2C_CORPUS if set, texture sized synthetic images
+    // otherwise.
+    std::vector<CorpusEntry> loadCorpus()
+    {
+        std::vector<CorpusEntry> corpus;
+        std::string dir = LLStringUtil::getenv("J2C_CORPUS");
+        if (!dir.empty())
+        {
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+            {
+                std::string ext = entry.path().extension().string();
+                LLStringUtil::toLower(ext);
+                if (ext != ".j2c" && ext != ".jp2")
+                {
+                    continue;
+                }
+                std::ifstream file(entry.path(), std::ios::binary);
+                std::vector<U8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                if (!data.empty())
+                {
+                    corpus.push_back({ entry.path().filename().string(), data });
+                }
+            }
+        }
+        if (corpus.empty())
+        {
+            corpus.push_back({ "synthetic 2048x2048 RGB", encode(2048, 3) });
+            corpus.push_back({ "synthetic 1024x1024 RGBA", encode(1024, 4) });
+            corpus.push_back({ "synthetic 512x512 RGB", encode(512, 3) });
+        }
+        return corpus;
+    }
+
+    // Seconds for one decode at discard_level, or a negative value if it failed
+    F64 timeDecode(const std::vector<U8>& data, S32 discard_level, LLPointer<LLImageRaw>* result = nullptr)
+    {
+        LLPointer<LLImageJ2C> j2c = makeJ2C(data);
+        if (j2c.isNull())
+        {
+            return -1.0;
+        }
+        j2c->setDiscardLevel(discard_level);
+        LLPointer<LLImageRaw> raw = new LLImageRaw(j2c->getWidth(), j2c->getHeight(), j2c->getComponents());
+
+        auto start = std::chrono::steady_clock::now();
+        bool decoded = j2c->decode(raw, 0.f);
+        F64 seconds = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+
+        if (result)
+        {
+            *result = raw;
+        }
+        return (decoded && raw->getData()) ? seconds : -1.0;
+    }
+}
+
+namespace tut
+{
+    struct imagej2coj_data
+    {
+        imagej2coj_data()
+        {
+            mDecodeThreads = LLImageJ2C::getDecodeThreads();
+        }
+
+        ~imagej2coj_data()
+        {
+            LLImageJ2C::setDecodeThreads(mDecodeThreads);
+        }
+
+        S32 mDecodeThreads;
+    };
+    typedef test_group<imagej2coj_data> imagej2coj_test;
+    typedef imagej2coj_test::object imagej2coj_object;
+    tut::imagej2coj_test imagej2coj_testcase("LLImageJ2COJ");
+
+    template<> template<>
+    void imagej2coj_object::test<1>()
+    {
+        set_test_name("cut, threaded and reduced decodes match full decodes");
+
+        std::vector<U8> data = encode(1024, 3);
+        ensure("encoded", !data.empty());
+        ensure_equals("one tile-part per resolution", tileParts(data).size(), (size_t)(MAX_DISCARD_LEVEL + 1));
+        std::vector<U8> whole = uncut(data);
+
+        for (S32 discard_level = 0; discard_level <= MAX_DISCARD_LEVEL; ++discard_level)
+        {
+            LLPointer<LLImageRaw> full, single, threaded;
+            LLImageJ2C::setDecodeThreads(1);
+            ensure("full decode", timeDecode(whole, discard_level, &full) >= 0.0);
+            ensure("single threaded decode", timeDecode(data, discard_level, &single) >= 0.0);
+            LLImageJ2C::setDecodeThreads(4);
+            ensure("threaded decode", timeDecode(data, discard_level, &threaded) >= 0.0);
+
+            ensure_equals("width", full->getWidth(), (U16)(1024 >> discard_level));
+            ensure_equals("single size", single->getDataSize(), full->getDataSize());
+            ensure("single pixels", !memcmp(single->getData(), full->getData(), full->getDataSize()));
+            ensure_equals("threaded size", threaded->getDataSize(), full->getDataSize());
+            ensure("threaded pixels", !memcmp(threaded->getData(), full->getData(), full->getDataSize()));
+        }
+    }
+
+    template<> template<>
+    void imagej2coj_object::test<2>()
+    {
+        set_test_name("decode time per discard level");
+
+        skip_unless_benchmarks();
+
+        std::vector<CorpusEntry> corpus = loadCorpus();
+        ensure("corpus", !corpus.empty());
+
+        const S32 cores = llmax((S32)std::thread::hardware_concurrency(), 1);
+        for (const CorpusEntry& entry : corpus)
+        {
+            if (entry.mData.empty())
+            {
+                continue;
+            }
+            std::cout << "\n" << entry.mName << " (" << entry.mData.size() / 1024 << " KB)";
+            for (S32 discard_level = 0; discard_level <= MAX_DISCARD_LEVEL; ++discard_level)
+            {
+                std::cout << "\n  discard " << discard_level << ":";
+                for (S32 threads : { 1, llmin(cores, 4) })
+                {
+                    LLImageJ2C::setDecodeThreads(threads);
+                    // best of a few, first one warms up caches and the allocator
+                    F64 best = -1.0;
+                    for (S32 i = 0; i < 3; ++i)
+                    {
+                        F64 seconds = timeDecode(entry.mData, discard_level);
+                        if (seconds >= 0.0 && (best < 0.0 || seconds < best))
+                        {
+                            best = seconds;
+                        }
+                    }
+                    if (best < 0.0)
+                    {
+                        std::cout << " " << threads << " thread(s) failed";
+                    }
+                    else
+                    {
+                        std::cout << " " << threads << " thread(s) " << best * 1000.0 << " ms";
+                    }
+                }
+            }
+        }
+        std::cout << std::endl;
+    }
+}
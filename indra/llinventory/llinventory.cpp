@@ -29,6 +29,7 @@
 
 #include "lldbstrings.h"
 #include "llfasttimer.h"
+#include "llinventorycache.h"
 #include "llinventorydefines.h"
 #include "llxorcipher.h"
 #include "llsd.h"
@@ -1195,6 +1196,102 @@ bool LLInventoryItem::fromLLSD(const LLSD& sd, bool is_new)
     return true;
 }
 
+void LLInventoryItem::exportCache(LLInventoryCacheWriter& writer) const
+{
+    LLInventoryCacheItem record;
+    record.mID = mUUID;
+    record.mParentID = mParentUUID;
+    record.mThumbnailID = mThumbnailUUID;
+
+    // fromLLSD() fixes up the types and masks of every item it loads. The
+    // records get the same fixes when written instead, so that loading
+    // them needs no type dictionary lookups.
+    LLInventoryType::EType inv_type = mInventoryType;
+    if((LLInventoryType::IT_NONE == inv_type)
+       || !inventory_and_asset_types_match(inv_type, mType))
+    {
+        inv_type = LLInventoryType::defaultForAssetType(mType);
+    }
+    LLPermissions perm;
+    perm.init(mPermissions.getCreator(), mPermissions.getOwner(), mPermissions.getLastOwner(), mPermissions.getGroup());
+    perm.setMaskBase(mPermissions.getMaskBase());
+    perm.setMaskOwner(mPermissions.getMaskOwner());
+    perm.setMaskEveryone(mPermissions.getMaskEveryone());
+    perm.setMaskGroup(mPermissions.getMaskGroup());
+    perm.setMaskNext(mPermissions.getMaskNextOwner());
+    perm.fix();
+    perm.initMasks(inv_type);
+
+    record.mPermissions.mCreator = perm.getCreator();
+    record.mPermissions.mOwner = perm.getOwner();
+    record.mPermissions.mLastOwner = perm.getLastOwner();
+    record.mPermissions.mGroup = perm.getGroup();
+    record.mPermissions.mMaskBase = perm.getMaskBase();
+    record.mPermissions.mMaskOwner = perm.getMaskOwner();
+    record.mPermissions.mMaskGroup = perm.getMaskGroup();
+    record.mPermissions.mMaskEveryone = perm.getMaskEveryone();
+    record.mPermissions.mMaskNextOwner = perm.getMaskNextOwner();
+
+    // same as the shadow_id asLLSD() writes
+    record.mAssetID = mAssetUUID;
+    record.mRecordFlags = 0;
+    U32 mask = mPermissions.getMaskBase();
+    if (((mask & PERM_ITEM_UNRESTRICTED) != PERM_ITEM_UNRESTRICTED) && mAssetUUID.notNull())
+    {
+        LLXORCipher cipher(MAGIC_ID.mData, UUID_BYTES);
+        cipher.encrypt(record.mAssetID.mData, UUID_BYTES);
+        record.mRecordFlags |= LLInventoryCacheItem::SHADOW_ASSET_ID;
+    }
+
+    record.mType = (S8)mType;
+    record.mInventoryType = (S8)inv_type;
+    record.mFlags = mFlags;
+    record.mSaleType = (U8)mSaleInfo.getSaleType();
+    record.mSalePrice = mSaleInfo.getSalePrice();
+    record.mCreationDate = (S32)mCreationDate;
+    record.mName = writer.addString(mName);
+    record.mDescription = writer.addString(mDescription);
+    writer.addItem(record);
+}
+
+// Called on worker threads, see LLInventoryCacheReader::decodeChunks()
+bool LLInventoryItem::importCache(const LLInventoryCacheItem& record, const LLInventoryCacheStrings& strings)
+{
+    mUUID = record.mID;
+    mParentUUID = record.mParentID;
+    mThumbnailUUID = record.mThumbnailID;
+
+    const LLInventoryCachePermissions& perm = record.mPermissions;
+    mPermissions.init(perm.mCreator, perm.mOwner, perm.mLastOwner, perm.mGroup);
+    mPermissions.setMaskBase(perm.mMaskBase);
+    mPermissions.setMaskOwner(perm.mMaskOwner);
+    mPermissions.setMaskEveryone(perm.mMaskEveryone);
+    mPermissions.setMaskGroup(perm.mMaskGroup);
+    mPermissions.setMaskNext(perm.mMaskNextOwner);
+
+    mAssetUUID = record.mAssetID;
+    if (record.mRecordFlags & LLInventoryCacheItem::SHADOW_ASSET_ID)
+    {
+        LLXORCipher cipher(MAGIC_ID.mData, UUID_BYTES);
+        cipher.decrypt(mAssetUUID.mData, UUID_BYTES);
+    }
+
+    mType = static_cast<LLAssetType::EType>(record.mType);
+    mInventoryType = static_cast<LLInventoryType::EType>(record.mInventoryType);
+    mFlags = record.mFlags;
+    mSaleInfo.setSaleType(static_cast<LLSaleInfo::EForSale>(record.mSaleType));
+    mSaleInfo.setSalePrice(record.mSalePrice);
+    mCreationDate = record.mCreationDate;
+
+    mName = strings.get(record.mName);
+    LLStringUtil::replaceNonstandardASCII(mName, ' ');
+    LLStringUtil::replaceChar(mName, '|', ' ');
+    mDescription = strings.get(record.mDescription);
+    LLStringUtil::replaceNonstandardASCII(mDescription, ' ');
+
+    return true;
+}
+
 ///----------------------------------------------------------------------------
 /// Class LLInventoryCategory
 ///----------------------------------------------------------------------------
@@ -1528,6 +1625,32 @@ bool LLInventoryCategory::importLLSD(const LLSD& cat_data)
 
     return true;
 }
+
+void LLInventoryCategory::exportCacheRecord(LLInventoryCacheCategory& record, LLInventoryCacheWriter& writer) const
+{
+    record.mID = mUUID;
+    record.mParentID = mParentUUID;
+    record.mThumbnailID = mThumbnailUUID;
+    record.mType = (S8)mType;
+    record.mPreferredType = (S8)mPreferredType;
+    record.mPad[0] = record.mPad[1] = 0;
+    record.mName = writer.addString(mName);
+}
+
+bool LLInventoryCategory::importCache(const LLInventoryCacheCategory& record, const LLInventoryCacheStrings& strings)
+{
+    setUUID(record.mID);
+    setParent(record.mParentID);
+    setThumbnailUUID(record.mThumbnailID);
+    setType(static_cast<LLAssetType::EType>(record.mType));
+    setPreferredType(static_cast<LLFolderType::EType>(record.mPreferredType));
+
+    mName = strings.get(record.mName);
+    LLStringUtil::replaceNonstandardASCII(mName, ' ');
+    LLStringUtil::replaceChar(mName, '|', ' ');
+
+    return true;
+}
 ///----------------------------------------------------------------------------
 /// Local function definitions
 ///----------------------------------------------------------------------------
@@ -37,6 +37,10 @@
 #include "lltrace.h"
 
 class LLMessageSystem;
+class LLInventoryCacheStrings;
+class LLInventoryCacheWriter;
+struct LLInventoryCacheCategory;
+struct LLInventoryCacheItem;
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Class LLInventoryObject
@@ -210,6 +214,10 @@ public:
     void asLLSD( LLSD& sd ) const;
     bool fromLLSD(const LLSD& sd, bool is_new = true);
 
+    // Binary cache records, see llinventorycache.h
+    void exportCache(LLInventoryCacheWriter& writer) const;
+    bool importCache(const LLInventoryCacheItem& record, const LLInventoryCacheStrings& strings);
+
     //--------------------------------------------------------------------
     // Member Variables
     //--------------------------------------------------------------------
@@ -272,6 +280,10 @@ public:
 
     LLSD exportLLSD() const;
     bool importLLSD(const LLSD& cat_data);
+
+    // Binary cache records, see llinventorycache.h
+    void exportCacheRecord(LLInventoryCacheCategory& record, LLInventoryCacheWriter& writer) const;
+    bool importCache(const LLInventoryCacheCategory& record, const LLInventoryCacheStrings& strings);
     //--------------------------------------------------------------------
     // Member Variables
     //--------------------------------------------------------------------
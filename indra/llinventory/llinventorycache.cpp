@@ -0,0 +1,284 @@
+/**
+ * @file llinventorycache.cpp
+ * @brief Binary inventory cache file format.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llinventorycache.h"
+
+#include "threadpool.h"
+
+#include <cstddef>
+
+namespace
+{
+    constexpr char CACHE_MAGIC[4] = { 'F', 'S', 'I', 'C' };
+    constexpr U32 CACHE_FORMAT_VERSION = 1;
+
+    struct FileHeader
+    {
+        char mMagic[4];
+        U32 mFormatVersion;
+        S32 mCacheVersion;
+        U32 mChunkCount;
+    };
+
+    struct ChunkHeader
+    {
+        U32 mCategoryCount;
+        U32 mItemCount;
+        U32 mStringsSize;
+    };
+}
+
+///----------------------------------------------------------------------------
+/// Class LLInventoryCacheStrings
+///----------------------------------------------------------------------------
+
+std::string LLInventoryCacheStrings::get(const LLInventoryCacheString& str) const
+{
+    if (str.mOffset > mSize || str.mSize > mSize - str.mOffset)
+    {
+        return std::string();
+    }
+    return std::string(mData + str.mOffset, str.mSize);
+}
+
+///----------------------------------------------------------------------------
+/// Class LLInventoryCacheWriter
+///----------------------------------------------------------------------------
+
+LLInventoryCacheWriter::LLInventoryCacheWriter(S32 cache_version) :
+    mCacheVersion(cache_version),
+    mChunkCount(0),
+    mCategoryCount(0),
+    mItemCount(0)
+{
+}
+
+bool LLInventoryCacheWriter::open(const std::string& filename)
+{
+    mFile.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!mFile.is_open())
+    {
+        return false;
+    }
+
+    // the chunk count is filled in by close()
+    FileHeader header;
+    memcpy(header.mMagic, CACHE_MAGIC, sizeof(header.mMagic));
+    header.mFormatVersion = CACHE_FORMAT_VERSION;
+    header.mCacheVersion = mCacheVersion;
+    header.mChunkCount = 0;
+    mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    mCategories.reserve(CHUNK_RECORDS);
+    mItems.reserve(CHUNK_RECORDS);
+    return !mFile.fail();
+}
+
+LLInventoryCacheString LLInventoryCacheWriter::addString(const std::string& str)
+{
+    LLInventoryCacheString record;
+    record.mOffset = (U32)mStrings.size();
+    record.mSize = (U32)str.size();
+    mStrings.append(str);
+    return record;
+}
+
+void LLInventoryCacheWriter::addCategory(const LLInventoryCacheCategory& record)
+{
+    mCategories.push_back(record);
+    ++mCategoryCount;
+    if (mCategories.size() + mItems.size() >= CHUNK_RECORDS)
+    {
+        writeChunk();
+    }
+}
+
+void LLInventoryCacheWriter::addItem(const LLInventoryCacheItem& record)
+{
+    mItems.push_back(record);
+    ++mItemCount;
+    if (mCategories.size() + mItems.size() >= CHUNK_RECORDS)
+    {
+        writeChunk();
+    }
+}
+
+void LLInventoryCacheWriter::writeChunk()
+{
+    ChunkHeader header;
+    header.mCategoryCount = (U32)mCategories.size();
+    header.mItemCount = (U32)mItems.size();
+    header.mStringsSize = (U32)mStrings.size();
+    mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    mFile.write(reinterpret_cast<const char*>(mCategories.data()), mCategories.size() * sizeof(LLInventoryCacheCategory));
+    mFile.write(reinterpret_cast<const char*>(mItems.data()), mItems.size() * sizeof(LLInventoryCacheItem));
+    mFile.write(mStrings.data(), mStrings.size());
+    ++mChunkCount;
+
+    mCategories.clear();
+    mItems.clear();
+    mStrings.clear();
+}
+
+bool LLInventoryCacheWriter::close()
+{
+    if (!mFile.is_open())
+    {
+        return false;
+    }
+
+    if (!mCategories.empty() || !mItems.empty())
+    {
+        writeChunk();
+    }
+    mFile.seekp(offsetof(FileHeader, mChunkCount));
+    mFile.write(reinterpret_cast<const char*>(&mChunkCount), sizeof(mChunkCount));
+    mFile.flush();
+    bool success = !mFile.fail();
+    mFile.close();
+    return success;
+}
+
+///----------------------------------------------------------------------------
+/// Class LLInventoryCacheReader
+///----------------------------------------------------------------------------
+
+LLInventoryCacheCategory LLInventoryCacheReader::Chunk::getCategory(U32 index) const
+{
+    LLInventoryCacheCategory record;
+    memcpy(&record, mCategories + (size_t)index * sizeof(LLInventoryCacheCategory), sizeof(record));
+    return record;
+}
+
+LLInventoryCacheItem LLInventoryCacheReader::Chunk::getItem(U32 index) const
+{
+    LLInventoryCacheItem record;
+    memcpy(&record, mItems + (size_t)index * sizeof(LLInventoryCacheItem), sizeof(record));
+    return record;
+}
+
+// static
+bool LLInventoryCacheReader::isCacheFile(const std::string& filename)
+{
+    llifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    char magic[sizeof(CACHE_MAGIC)];
+    return file.is_open()
+        && file.read(magic, sizeof(magic))
+        && !memcmp(magic, CACHE_MAGIC, sizeof(magic));
+}
+
+LLInventoryCacheReader::LLInventoryCacheReader() :
+    mCacheVersion(0),
+    mCategoryCount(0),
+    mItemCount(0)
+{
+}
+
+bool LLInventoryCacheReader::load(const std::string& filename)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    mChunks.clear();
+    mCategoryCount = 0;
+    mItemCount = 0;
+
+    llifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    if (size < (std::streamoff)sizeof(FileHeader))
+    {
+        return false;
+    }
+    mBuffer.resize((size_t)size);
+    if (!file.read(reinterpret_cast<char*>(mBuffer.data()), size))
+    {
+        return false;
+    }
+
+    FileHeader header;
+    memcpy(&header, mBuffer.data(), sizeof(header));
+    if (memcmp(header.mMagic, CACHE_MAGIC, sizeof(header.mMagic)) || header.mFormatVersion != CACHE_FORMAT_VERSION)
+    {
+        return false;
+    }
+    mCacheVersion = header.mCacheVersion;
+
+    // find the chunks, every size is checked against what is left
+    const U8* end = mBuffer.data() + mBuffer.size();
+    const U8* pos = mBuffer.data() + sizeof(header);
+    // the count is from disk too, a damaged one must not allocate
+    mChunks.reserve(llmin((size_t)header.mChunkCount, (size_t)(end - pos) / sizeof(ChunkHeader)));
+    for (U32 i = 0; i < header.mChunkCount; ++i)
+    {
+        ChunkHeader chunk_header;
+        if ((size_t)(end - pos) < sizeof(chunk_header))
+        {
+            return false;
+        }
+        memcpy(&chunk_header, pos, sizeof(chunk_header));
+        pos += sizeof(chunk_header);
+
+        U64 chunk_size = (U64)chunk_header.mCategoryCount * sizeof(LLInventoryCacheCategory)
+            + (U64)chunk_header.mItemCount * sizeof(LLInventoryCacheItem)
+            + chunk_header.mStringsSize;
+        if ((U64)(end - pos) < chunk_size)
+        {
+            return false;
+        }
+
+        Chunk chunk;
+        chunk.mFirstCategory = mCategoryCount;
+        chunk.mFirstItem = mItemCount;
+        chunk.mCategoryCount = chunk_header.mCategoryCount;
+        chunk.mItemCount = chunk_header.mItemCount;
+        chunk.mCategories = pos;
+        pos += (size_t)chunk_header.mCategoryCount * sizeof(LLInventoryCacheCategory);
+        chunk.mItems = pos;
+        pos += (size_t)chunk_header.mItemCount * sizeof(LLInventoryCacheItem);
+        chunk.mStrings = LLInventoryCacheStrings(reinterpret_cast<const char*>(pos), chunk_header.mStringsSize);
+        pos += chunk_header.mStringsSize;
+        mChunks.push_back(chunk);
+
+        mCategoryCount += chunk.mCategoryCount;
+        mItemCount += chunk.mItemCount;
+    }
+    return true;
+}
+
+void LLInventoryCacheReader::decodeChunks(const std::function<void(const Chunk&)>& decode_chunk) const
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    LL::parallel_for("General", getChunkCount(), [this, &decode_chunk](size_t i) { decode_chunk(getChunk((U32)i)); });
+}
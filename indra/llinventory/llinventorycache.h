@@ -0,0 +1,204 @@
+/**
+ * @file llinventorycache.h
+ * @brief Binary inventory cache file format.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCACHE_H
+#define LL_LLINVENTORYCACHE_H
+
+#include "llfile.h"
+#include "lluuid.h"
+
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Binary inventory cache
+//
+//   A header, then chunks of up to CHUNK_RECORDS records. Each chunk holds
+//   its category records, its item records and a pool with their names and
+//   descriptions, so chunks are written as they fill up and decoded
+//   independently of each other. Records are fixed size, in host byte order,
+//   and are copied straight out of the file buffer.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// A string in the chunk's string pool
+struct LLInventoryCacheString
+{
+    U32 mOffset;
+    U32 mSize;
+};
+
+struct LLInventoryCacheCategory
+{
+    LLUUID mID;
+    LLUUID mParentID;
+    LLUUID mOwnerID;
+    LLUUID mThumbnailID;
+    LLInventoryCacheString mName;
+    S32 mVersion;
+    S8 mType;
+    S8 mPreferredType;
+    U8 mPad[2];
+};
+
+struct LLInventoryCachePermissions
+{
+    LLUUID mCreator;
+    LLUUID mOwner;
+    LLUUID mLastOwner;
+    LLUUID mGroup;
+    U32 mMaskBase;
+    U32 mMaskOwner;
+    U32 mMaskGroup;
+    U32 mMaskEveryone;
+    U32 mMaskNextOwner;
+};
+
+// Written with its inventory type and permissions already fixed up the way
+// LLInventoryItem::fromLLSD() does on load
+struct LLInventoryCacheItem
+{
+    // mAssetID is stored like the LLSD shadow_id when this is set
+    static constexpr U8 SHADOW_ASSET_ID = 0x01;
+
+    LLUUID mID;
+    LLUUID mParentID;
+    LLUUID mAssetID;
+    LLUUID mThumbnailID;
+    LLInventoryCachePermissions mPermissions;
+    LLInventoryCacheString mName;
+    LLInventoryCacheString mDescription;
+    U32 mFlags;
+    S32 mCreationDate;
+    S32 mSalePrice;
+    S8 mType;
+    S8 mInventoryType;
+    U8 mSaleType;
+    U8 mRecordFlags;
+};
+
+static_assert(std::is_trivially_copyable<LLInventoryCacheCategory>::value, "cache records are copied as bytes");
+static_assert(std::is_trivially_copyable<LLInventoryCacheItem>::value, "cache records are copied as bytes");
+static_assert(sizeof(LLInventoryCacheCategory) == 80, "cache category record layout changed");
+static_assert(sizeof(LLInventoryCacheItem) == 180, "cache item record layout changed");
+
+// String pool of one chunk
+class LLInventoryCacheStrings
+{
+public:
+    LLInventoryCacheStrings(const char* data = nullptr, U32 size = 0) : mData(data), mSize(size) {}
+
+    // Empty if the string runs past the pool
+    std::string get(const LLInventoryCacheString& str) const;
+
+private:
+    const char* mData;
+    U32 mSize;
+};
+
+// Writes a whole cache file. Chunks are streamed out as they fill, so the
+// file is never built in memory, but every save rewrites all records: the
+// viewer gzips the file as a whole and saves it once, at logout.
+class LLInventoryCacheWriter
+{
+public:
+    static constexpr U32 CHUNK_RECORDS = 4096;
+
+    LLInventoryCacheWriter(S32 cache_version);
+
+    bool open(const std::string& filename);
+    // Adds the string to the pool of the chunk the next record goes to
+    LLInventoryCacheString addString(const std::string& str);
+    void addCategory(const LLInventoryCacheCategory& record);
+    void addItem(const LLInventoryCacheItem& record);
+    // Writes the last chunk and the chunk count, false if any write failed
+    bool close();
+
+    U32 getCategoryCount() const { return mCategoryCount; }
+    U32 getItemCount() const { return mItemCount; }
+
+private:
+    void writeChunk();
+
+    llofstream mFile;
+    S32 mCacheVersion;
+    U32 mChunkCount;
+    U32 mCategoryCount;
+    U32 mItemCount;
+    std::vector<LLInventoryCacheCategory> mCategories;
+    std::vector<LLInventoryCacheItem> mItems;
+    std::string mStrings;
+};
+
+class LLInventoryCacheReader
+{
+public:
+    struct Chunk
+    {
+        // index of the chunk's first records among all of the file's
+        U32 mFirstCategory;
+        U32 mFirstItem;
+        U32 mCategoryCount;
+        U32 mItemCount;
+        const U8* mCategories;
+        const U8* mItems;
+        LLInventoryCacheStrings mStrings;
+
+        LLInventoryCacheCategory getCategory(U32 index) const;
+        LLInventoryCacheItem getItem(U32 index) const;
+    };
+
+    // Whether the file starts like a binary cache, any other file is the
+    // older LLSD notation one
+    static bool isCacheFile(const std::string& filename);
+
+    LLInventoryCacheReader();
+
+    // Reads the whole file, false if it is not a complete cache file
+    bool load(const std::string& filename);
+
+    S32 getCacheVersion() const { return mCacheVersion; }
+    U32 getCategoryCount() const { return mCategoryCount; }
+    U32 getItemCount() const { return mItemCount; }
+    U32 getChunkCount() const { return (U32)mChunks.size(); }
+    const Chunk& getChunk(U32 index) const { return mChunks[index]; }
+
+    // Calls decode_chunk once for every chunk, on the "General" thread pool
+    // with this thread helping, and returns when all are done.
+    // decode_chunk must be safe to call from several threads at once.
+    void decodeChunks(const std::function<void(const Chunk&)>& decode_chunk) const;
+
+private:
+    std::vector<U8> mBuffer;
+    std::vector<Chunk> mChunks;
+    S32 mCacheVersion;
+    U32 mCategoryCount;
+    U32 mItemCount;
+};
+
+#endif // LL_LLINVENTORYCACHE_H
@@ -0,0 +1,260 @@
+/**
+ * @file llinventorysearchindex.cpp
+ * @brief Trigram index for inventory sub string searches.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llinventorysearchindex.h"
+
+#include "llstring.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr size_t TRIGRAM_SIZE = 3;
+    // stale list entries tolerated before compacting, on top of the live ones
+    constexpr size_t MIN_STALE_POSTINGS = 65536;
+
+    U32 trigram_at(const std::string& text, size_t pos)
+    {
+        return ((U32)(U8)text[pos] << 16) | ((U32)(U8)text[pos + 1] << 8) | (U32)(U8)text[pos + 2];
+    }
+
+    // The distinct trigrams of text, sorted
+    void get_trigrams(const std::string& text, std::vector<U32>& trigrams)
+    {
+        trigrams.clear();
+        for (size_t pos = 0; pos + TRIGRAM_SIZE <= text.size(); ++pos)
+        {
+            trigrams.push_back(trigram_at(text, pos));
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    }
+}
+
+LLInventorySearchIndex::LLInventorySearchIndex() :
+    mPostingCount(0),
+    mLivePostingCount(0),
+    mGeneration(0),
+    mIndexDescriptions(false)
+{
+}
+
+void LLInventorySearchIndex::setIndexDescriptions(bool index)
+{
+    if (index != mIndexDescriptions)
+    {
+        clear();
+        mIndexDescriptions = index;
+    }
+}
+
+void LLInventorySearchIndex::update(const LLUUID& id, const std::string& name, const std::string& description)
+{
+    std::string text[FIELD_COUNT] = { name, isIndexed(DESCRIPTION) ? description : std::string() };
+    for (std::string& str : text)
+    {
+        LLStringUtil::toUpper(str);
+    }
+
+    U32 entry_index;
+    auto iter = mEntryIndex.find(id);
+    if (iter != mEntryIndex.end())
+    {
+        entry_index = iter->second;
+        Entry& entry = mEntries[entry_index];
+        if (entry.mText[NAME] == text[NAME] && entry.mText[DESCRIPTION] == text[DESCRIPTION])
+        {
+            return;
+        }
+        dropPostings(entry);
+    }
+    else
+    {
+        if (!mFreeEntries.empty())
+        {
+            entry_index = mFreeEntries.back();
+            mFreeEntries.pop_back();
+        }
+        else
+        {
+            entry_index = (U32)mEntries.size();
+            mEntries.emplace_back();
+        }
+        mEntryIndex[id] = entry_index;
+    }
+
+    Entry& entry = mEntries[entry_index];
+    entry.mID = id;
+    entry.mLive = true;
+    for (S32 field = 0; field < FIELD_COUNT; ++field)
+    {
+        entry.mText[field].swap(text[field]);
+        addPostings(entry_index, (EField)field);
+    }
+    ++mGeneration;
+    compactPostings();
+}
+
+void LLInventorySearchIndex::remove(const LLUUID& id)
+{
+    auto iter = mEntryIndex.find(id);
+    if (iter == mEntryIndex.end())
+    {
+        return;
+    }
+    const U32 entry_index = iter->second;
+    mEntryIndex.erase(iter);
+
+    // list entries still pointing here are told apart from the next item
+    // reusing the entry by checking that item's strings
+    Entry& entry = mEntries[entry_index];
+    dropPostings(entry);
+    entry.mLive = false;
+    for (std::string& text : entry.mText)
+    {
+        text.clear();
+        text.shrink_to_fit();
+    }
+    mFreeEntries.push_back(entry_index);
+    ++mGeneration;
+    compactPostings();
+}
+
+void LLInventorySearchIndex::clear()
+{
+    mEntries.clear();
+    mFreeEntries.clear();
+    mEntryIndex.clear();
+    for (posting_map_t& postings : mPostings)
+    {
+        postings.clear();
+    }
+    mPostingCount = 0;
+    mLivePostingCount = 0;
+    ++mGeneration;
+}
+
+const std::string* LLInventorySearchIndex::getText(const LLUUID& id, EField field) const
+{
+    auto iter = mEntryIndex.find(id);
+    if (iter == mEntryIndex.end() || !isIndexed(field))
+    {
+        return nullptr;
+    }
+    return &mEntries[iter->second].mText[field];
+}
+
+bool LLInventorySearchIndex::find(EField field, const std::string& sub_string, id_set_t& ids) const
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    ids.clear();
+    if (!isIndexed(field) || sub_string.size() < TRIGRAM_SIZE)
+    {
+        return false;
+    }
+
+    // every match is on the list of each trigram, so go through the shortest
+    const posting_map_t& postings = mPostings[field];
+    const std::vector<U32>* shortest = nullptr;
+    for (size_t pos = 0; pos + TRIGRAM_SIZE <= sub_string.size(); ++pos)
+    {
+        auto iter = postings.find(trigram_at(sub_string, pos));
+        if (iter == postings.end())
+        {
+            return true;
+        }
+        if (!shortest || iter->second.size() < shortest->size())
+        {
+            shortest = &iter->second;
+        }
+    }
+
+    std::vector<U32> candidates(*shortest);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (U32 entry_index : candidates)
+    {
+        const Entry& entry = mEntries[entry_index];
+        if (entry.mLive && entry.mText[field].find(sub_string) != std::string::npos)
+        {
+            ids.insert(entry.mID);
+        }
+    }
+    return true;
+}
+
+void LLInventorySearchIndex::addPostings(U32 entry_index, EField field)
+{
+    Entry& entry = mEntries[entry_index];
+    static thread_local std::vector<U32> trigrams;
+    get_trigrams(entry.mText[field], trigrams);
+    for (U32 trigram : trigrams)
+    {
+        mPostings[field][trigram].push_back(entry_index);
+    }
+    entry.mTrigramCount[field] = (U32)trigrams.size();
+    mPostingCount += trigrams.size();
+    mLivePostingCount += trigrams.size();
+}
+
+void LLInventorySearchIndex::dropPostings(Entry& entry)
+{
+    for (U32& count : entry.mTrigramCount)
+    {
+        mLivePostingCount -= count;
+        count = 0;
+    }
+}
+
+void LLInventorySearchIndex::compactPostings()
+{
+    if (mPostingCount - mLivePostingCount <= mLivePostingCount + MIN_STALE_POSTINGS)
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+    for (posting_map_t& postings : mPostings)
+    {
+        postings.clear();
+    }
+    mPostingCount = 0;
+    mLivePostingCount = 0;
+    for (U32 entry_index = 0; entry_index < (U32)mEntries.size(); ++entry_index)
+    {
+        if (mEntries[entry_index].mLive)
+        {
+            for (S32 field = 0; field < FIELD_COUNT; ++field)
+            {
+                addPostings(entry_index, (EField)field);
+            }
+        }
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file llinventorysearchindex.h
+ * @brief Trigram index for inventory sub string searches.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYSEARCHINDEX_H
+#define LL_LLINVENTORYSEARCHINDEX_H
+
+#include "lluuid.h"
+#include "lluuidhashmap.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventorySearchIndex
+//
+//   Upper cased item names, and optionally descriptions, with a list of the
+//   items containing each three byte sequence. A sub string query only
+//   checks the items on the shortest list among its trigrams, instead of
+//   every item.
+//
+//   Updating an item appends to the lists and leaves its old entries
+//   behind; they are skipped by queries and dropped when the stale entries
+//   outnumber the live ones.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+class LLInventorySearchIndex
+{
+public:
+    enum EField
+    {
+        NAME,
+        DESCRIPTION,
+        FIELD_COUNT
+    };
+
+    typedef std::unordered_set<LLUUID> id_set_t;
+
+    LLInventorySearchIndex();
+
+    // Changing it empties the index, the owner re-adds the items
+    void setIndexDescriptions(bool index);
+    bool getIndexDescriptions() const { return mIndexDescriptions; }
+
+    // Adds the item or replaces its strings, cheap when they did not change
+    void update(const LLUUID& id, const std::string& name, const std::string& description);
+    void remove(const LLUUID& id);
+    void clear();
+
+    bool contains(const LLUUID& id) const { return mEntryIndex.count(id) != 0; }
+    size_t size() const { return mEntryIndex.size(); }
+    // The upper case string indexed for the field, nullptr if the item or
+    // the field is not indexed
+    const std::string* getText(const LLUUID& id, EField field) const;
+
+    // Bumped by every change, for callers keeping results of find()
+    U32 getGeneration() const { return mGeneration; }
+
+    // Fills ids with the items whose field contains sub_string, which must
+    // be upper case like LLInventoryFilter's. Returns false if the index
+    // can not tell: the field is not indexed or sub_string is shorter than
+    // a trigram.
+    bool find(EField field, const std::string& sub_string, id_set_t& ids) const;
+
+private:
+    struct Entry
+    {
+        LLUUID mID;
+        std::string mText[FIELD_COUNT];
+        U32 mTrigramCount[FIELD_COUNT];
+        bool mLive;
+    };
+
+    typedef std::unordered_map<U32, std::vector<U32> > posting_map_t;
+
+    bool isIndexed(EField field) const { return field == NAME || mIndexDescriptions; }
+    void addPostings(U32 entry_index, EField field);
+    void dropPostings(Entry& entry);
+    void compactPostings();
+
+    std::vector<Entry> mEntries;
+    std::vector<U32> mFreeEntries;
+    LLUUIDHashMap<U32> mEntryIndex;
+    posting_map_t mPostings[FIELD_COUNT];
+    size_t mPostingCount;       // entries in all the lists
+    size_t mLivePostingCount;   // those belonging to the current strings
+    U32 mGeneration;
+    bool mIndexDescriptions;
+};
+
+#endif // LL_LLINVENTORYSEARCHINDEX_H
@@ -0,0 +1,443 @@
+/**
+ * @file llinventorycache_test.cpp
+ * @brief Tests and a load benchmark for the binary inventory cache.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llsd.h"
+#include "llsdserialize.h"
+#include "lltimer.h"
+#include "threadpool.h"
+
+#include "../llinventory.h"
+#include "../llinventorycache.h"
+#include "../test/lltut.h"
+#include "../test/namedtempfile.h"
+
+#include <atomic>
+#include <iostream>
+
+namespace
+{
+    const S32 CACHE_VERSION = 3;
+
+    LLPointer<LLInventoryItem> make_item(U32 index, const LLUUID& parent_id, bool restricted)
+    {
+        LLUUID item_id, asset_id, creator_id, owner_id;
+        item_id.generate();
+        asset_id.generate();
+        creator_id.generate();
+        owner_id.generate();
+
+        LLPermissions perm;
+        perm.init(creator_id, owner_id, creator_id, LLUUID::null);
+        if (restricted)
+        {
+            perm.initMasks(PERM_MOVE | PERM_COPY, PERM_MOVE | PERM_COPY, PERM_NONE, PERM_NONE, PERM_MOVE | PERM_COPY);
+        }
+        else
+        {
+            perm.initMasks(PERM_ALL, PERM_ALL, PERM_COPY, PERM_NONE, PERM_ALL);
+        }
+
+        LLPointer<LLInventoryItem> item = new LLInventoryItem(
+            item_id,
+            parent_id,
+            perm,
+            asset_id,
+            index % 2 ? LLAssetType::AT_OBJECT : LLAssetType::AT_TEXTURE,
+            index % 2 ? LLInventoryType::IT_OBJECT : LLInventoryType::IT_TEXTURE,
+            llformat("Synthetic item %u - a fairly ordinary inventory name", index),
+            index % 4 ? std::string() : llformat("(No Description) %u", index),
+            LLSaleInfo(index % 8 ? LLSaleInfo::FS_NOT : LLSaleInfo::FS_COPY, (S32)(index % 500)),
+            index % 16 ? 0 : 0x100,
+            1600000000 + (S32)index);
+        if (index % 32 == 0)
+        {
+            LLUUID thumbnail_id;
+            thumbnail_id.generate();
+            item->setThumbnailUUID(thumbnail_id);
+        }
+        return item;
+    }
+
+    LLPointer<LLInventoryCategory> make_category(U32 index, const LLUUID& parent_id)
+    {
+        LLUUID cat_id;
+        cat_id.generate();
+        return new LLInventoryCategory(cat_id, parent_id, LLFolderType::FT_NONE, llformat("Folder %u", index));
+    }
+
+    void save_binary(const std::string& filename,
+                     const LLInventoryCategory::cat_array_t& categories,
+                     const LLInventoryItem::item_array_t& items)
+    {
+        LLInventoryCacheWriter writer(CACHE_VERSION);
+        tut::ensure("open cache for writing", writer.open(filename));
+        for (const auto& cat : categories)
+        {
+            LLInventoryCacheCategory record;
+            cat->exportCacheRecord(record, writer);
+            record.mOwnerID.setNull();
+            record.mVersion = 1;
+            writer.addCategory(record);
+        }
+        for (const auto& item : items)
+        {
+            item->exportCache(writer);
+        }
+        tut::ensure("close cache", writer.close());
+    }
+
+    // Decodes every record into place, categories and items keep file order
+    void load_binary(const LLInventoryCacheReader& reader,
+                     LLInventoryCategory::cat_array_t& categories,
+                     LLInventoryItem::item_array_t& items)
+    {
+        categories.resize(reader.getCategoryCount());
+        items.resize(reader.getItemCount());
+        reader.decodeChunks([&](const LLInventoryCacheReader::Chunk& chunk)
+            {
+                for (U32 i = 0; i < chunk.mCategoryCount; ++i)
+                {
+                    LLPointer<LLInventoryCategory> cat = new LLInventoryCategory;
+                    cat->importCache(chunk.getCategory(i), chunk.mStrings);
+                    categories[chunk.mFirstCategory + i] = cat;
+                }
+                for (U32 i = 0; i < chunk.mItemCount; ++i)
+                {
+                    LLPointer<LLInventoryItem> item = new LLInventoryItem;
+                    item->importCache(chunk.getItem(i), chunk.mStrings);
+                    items[chunk.mFirstItem + i] = item;
+                }
+            });
+    }
+
+    void ensure_same_item(const std::string& msg, const LLInventoryItem* a, const LLInventoryItem* b)
+    {
+        tut::ensure_equals(msg + " id", a->getUUID(), b->getUUID());
+        tut::ensure_equals(msg + " parent", a->getParentUUID(), b->getParentUUID());
+        tut::ensure_equals(msg + " thumbnail", a->getThumbnailUUID(), b->getThumbnailUUID());
+        tut::ensure_equals(msg + " asset", a->getAssetUUID(), b->getAssetUUID());
+        tut::ensure_equals(msg + " permissions", a->getPermissions(), b->getPermissions());
+        tut::ensure_equals(msg + " name", a->getName(), b->getName());
+        tut::ensure_equals(msg + " description", a->getDescription(), b->getDescription());
+        tut::ensure_equals(msg + " type", a->getType(), b->getType());
+        tut::ensure_equals(msg + " inventory type", a->getInventoryType(), b->getInventoryType());
+        tut::ensure_equals(msg + " flags", a->getFlags(), b->getFlags());
+        tut::ensure_equals(msg + " sale type", a->getSaleInfo().getSaleType(), b->getSaleInfo().getSaleType());
+        tut::ensure_equals(msg + " sale price", a->getSaleInfo().getSalePrice(), b->getSaleInfo().getSalePrice());
+        tut::ensure_equals(msg + " creation date", a->getCreationDate(), b->getCreationDate());
+    }
+
+    // Temp file path removed when the test is done
+    struct TempPath
+    {
+        TempPath(const char* sfx) : mPath(NamedTempFile::temp_path("invcache", sfx).string()) {}
+        ~TempPath() { LLFile::remove(mPath); }
+        std::string mPath;
+    };
+}
+
+namespace tut
+{
+    struct inventory_cache_data
+    {
+    };
+    typedef test_group<inventory_cache_data> inventory_cache_test;
+    typedef inventory_cache_test::object inventory_cache_object;
+    tut::inventory_cache_test invcache("LLInventoryCache");
+
+    template<> template<>
+    void inventory_cache_object::test<1>()
+    {
+        set_test_name("records load back like the LLSD cache lines");
+
+        LLUUID parent_id;
+        parent_id.generate();
+        LLInventoryCategory::cat_array_t categories;
+        categories.push_back(make_category(0, LLUUID::null));
+        LLInventoryItem::item_array_t items;
+        items.push_back(make_item(0, parent_id, false));
+        items.push_back(make_item(1, parent_id, true));     // asset id stored as a shadow id
+        items.push_back(make_item(2, parent_id, false));
+
+        TempPath path(".bin");
+        save_binary(path.mPath, categories, items);
+        ensure("detected as binary", LLInventoryCacheReader::isCacheFile(path.mPath));
+
+        LLInventoryCacheReader reader;
+        ensure("load", reader.load(path.mPath));
+        ensure_equals("cache version", reader.getCacheVersion(), CACHE_VERSION);
+        ensure_equals("one chunk", reader.getChunkCount(), 1u);
+
+        LLInventoryCategory::cat_array_t loaded_cats;
+        LLInventoryItem::item_array_t loaded_items;
+        load_binary(reader, loaded_cats, loaded_items);
+        ensure_equals("category count", loaded_cats.size(), categories.size());
+        ensure_equals("item count", loaded_items.size(), items.size());
+
+        ensure_equals("category id", loaded_cats[0]->getUUID(), categories[0]->getUUID());
+        ensure_equals("category name", loaded_cats[0]->getName(), categories[0]->getName());
+        ensure_equals("category type", loaded_cats[0]->getType(), LLAssetType::AT_CATEGORY);
+        ensure_equals("category preferred type", loaded_cats[0]->getPreferredType(), categories[0]->getPreferredType());
+
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            // what the LLSD cache would have given back
+            LLPointer<LLInventoryItem> expected = new LLInventoryItem;
+            expected->fromLLSD(items[i]->asLLSD());
+            ensure_same_item(llformat("item %d", (S32)i), loaded_items[i], expected);
+        }
+    }
+
+    template<> template<>
+    void inventory_cache_object::test<2>()
+    {
+        set_test_name("chunks and damaged files");
+
+        LLUUID parent_id;
+        parent_id.generate();
+        LLInventoryCategory::cat_array_t categories;
+        for (U32 i = 0; i < 10; ++i)
+        {
+            categories.push_back(make_category(i, parent_id));
+        }
+        LLInventoryItem::item_array_t items;
+        const U32 item_count = LLInventoryCacheWriter::CHUNK_RECORDS * 2 + 7;
+        for (U32 i = 0; i < item_count; ++i)
+        {
+            items.push_back(make_item(i, parent_id, i % 3 == 0));
+        }
+
+        TempPath path(".bin");
+        save_binary(path.mPath, categories, items);
+
+        LLInventoryCacheReader reader;
+        ensure("load", reader.load(path.mPath));
+        ensure_equals("chunks", reader.getChunkCount(), 3u);
+        ensure_equals("category count", reader.getCategoryCount(), 10u);
+        ensure_equals("item count", reader.getItemCount(), item_count);
+        ensure_equals("second chunk starts after the first", reader.getChunk(1).mFirstItem,
+                      LLInventoryCacheWriter::CHUNK_RECORDS - 10);
+
+        LLInventoryCategory::cat_array_t loaded_cats;
+        LLInventoryItem::item_array_t loaded_items;
+        load_binary(reader, loaded_cats, loaded_items);
+        ensure_equals("last item in place", loaded_items.back()->getUUID(), items.back()->getUUID());
+        ensure_equals("last item name", loaded_items.back()->getName(), items.back()->getName());
+
+        // cut the file short
+        std::string contents;
+        {
+            llifstream file(path.mPath.c_str(), std::ios::in | std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        {
+            llofstream file(path.mPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            file.write(contents.data(), contents.size() - 100);
+        }
+        ensure("truncated file still detected", LLInventoryCacheReader::isCacheFile(path.mPath));
+        ensure("truncated file rejected", !reader.load(path.mPath));
+
+        // a damaged chunk count, the fourth field of the header
+        {
+            std::string damaged = contents;
+            const U32 chunk_count = 0xFFFFFFF0;
+            memcpy(&damaged[12], &chunk_count, sizeof(chunk_count));
+            llofstream file(path.mPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            file.write(damaged.data(), damaged.size());
+        }
+        ensure("bad chunk count rejected", !reader.load(path.mPath));
+
+        // an LLSD notation cache is not a binary one
+        TempPath llsd_path(".llsd");
+        {
+            llofstream file(llsd_path.mPath.c_str());
+            LLSD version;
+            version["inv_cache_version"] = CACHE_VERSION;
+            file << LLSDOStreamer<LLSDNotationFormatter>(version) << std::endl;
+        }
+        ensure("LLSD cache not detected", !LLInventoryCacheReader::isCacheFile(llsd_path.mPath));
+        ensure("LLSD cache rejected", !reader.load(llsd_path.mPath));
+    }
+
+    template<> template<>
+    void inventory_cache_object::test<3>()
+    {
+        set_test_name("pool decodes every chunk once");
+
+        LL::ThreadPool pool("General", 3, 1024, false);
+        pool.start();
+
+        LLUUID parent_id;
+        parent_id.generate();
+        LLInventoryItem::item_array_t items;
+        const U32 item_count = LLInventoryCacheWriter::CHUNK_RECORDS * 6 + 1;
+        for (U32 i = 0; i < item_count; ++i)
+        {
+            items.push_back(make_item(i, parent_id, false));
+        }
+
+        TempPath path(".bin");
+        save_binary(path.mPath, LLInventoryCategory::cat_array_t(), items);
+
+        LLInventoryCacheReader reader;
+        ensure("load", reader.load(path.mPath));
+        ensure_equals("chunks", reader.getChunkCount(), 7u);
+
+        std::atomic<U32> chunks{ 0 };
+        std::atomic<U32> records{ 0 };
+        reader.decodeChunks([&](const LLInventoryCacheReader::Chunk& chunk)
+            {
+                ++chunks;
+                records += chunk.mItemCount;
+            });
+        ensure_equals("chunks decoded", chunks.load(), 7u);
+        ensure_equals("records decoded", records.load(), item_count);
+
+        LLInventoryCategory::cat_array_t loaded_cats;
+        LLInventoryItem::item_array_t loaded_items;
+        load_binary(reader, loaded_cats, loaded_items);
+        for (U32 i = 0; i < item_count; i += 997)
+        {
+            ensure_equals("item in place", loaded_items[i]->getUUID(), items[i]->getUUID());
+        }
+
+        pool.close();
+    }
+
+    template<> template<>
+    void inventory_cache_object::test<4>()
+    {
+        set_test_name("inventory cache load benchmark");
+
+        skip_unless_benchmarks();
+
+        const U32 item_count = 200000;
+        const U32 category_count = 4000;
+
+        LLUUID root_id;
+        root_id.generate();
+        LLInventoryCategory::cat_array_t categories;
+        for (U32 i = 0; i < category_count; ++i)
+        {
+            categories.push_back(make_category(i, root_id));
+        }
+        LLInventoryItem::item_array_t items;
+        items.reserve(item_count);
+        for (U32 i = 0; i < item_count; ++i)
+        {
+            items.push_back(make_item(i, categories[i % category_count]->getUUID(), i % 3 == 0));
+        }
+
+        // the LLSD notation cache, a line per record as LLInventoryModel
+        // has always written it
+        TempPath llsd_path(".llsd");
+        LLTimer timer;
+        {
+            llofstream file(llsd_path.mPath.c_str());
+            LLSD version;
+            version["inv_cache_version"] = CACHE_VERSION;
+            file << LLSDOStreamer<LLSDNotationFormatter>(version) << std::endl;
+            for (const auto& cat : categories)
+            {
+                file << LLSDOStreamer<LLSDNotationFormatter>(cat->exportLLSD()) << std::endl;
+            }
+            for (const auto& item : items)
+            {
+                file << LLSDOStreamer<LLSDNotationFormatter>(item->asLLSD()) << std::endl;
+            }
+        }
+        F64 llsd_save = timer.getElapsedTimeF64();
+
+        timer.reset();
+        U32 llsd_loaded = 0;
+        {
+            llifstream file(llsd_path.mPath.c_str());
+            std::string line;
+            LLPointer<LLSDParser> parser = new LLSDNotationParser();
+            while (std::getline(file, line))
+            {
+                LLSD s_item;
+                std::istringstream iss(line);
+                parser->parse(iss, s_item, line.length());
+                if (s_item.has("cat_id"))
+                {
+                    LLPointer<LLInventoryCategory> cat = new LLInventoryCategory;
+                    cat->importLLSD(s_item);
+                    ++llsd_loaded;
+                }
+                else if (s_item.has("item_id"))
+                {
+                    LLPointer<LLInventoryItem> item = new LLInventoryItem;
+                    item->fromLLSD(s_item);
+                    ++llsd_loaded;
+                }
+            }
+        }
+        F64 llsd_load = timer.getElapsedTimeF64();
+
+        TempPath bin_path(".bin");
+        timer.reset();
+        save_binary(bin_path.mPath, categories, items);
+        F64 bin_save = timer.getElapsedTimeF64();
+
+        LLInventoryCategory::cat_array_t loaded_cats;
+        LLInventoryItem::item_array_t loaded_items;
+        timer.reset();
+        {
+            LLInventoryCacheReader reader;
+            ensure("load", reader.load(bin_path.mPath));
+            load_binary(reader, loaded_cats, loaded_items);
+        }
+        F64 bin_load = timer.getElapsedTimeF64();
+        ensure_equals("binary records", (U32)(loaded_cats.size() + loaded_items.size()), llsd_loaded);
+        loaded_cats.clear();
+        loaded_items.clear();
+
+        LL::ThreadPool pool("General", 3, 1024, false);
+        pool.start();
+        timer.reset();
+        {
+            LLInventoryCacheReader reader;
+            ensure("load", reader.load(bin_path.mPath));
+            load_binary(reader, loaded_cats, loaded_items);
+        }
+        F64 pool_load = timer.getElapsedTimeF64();
+        pool.close();
+        ensure_equals("pooled records", (U32)(loaded_cats.size() + loaded_items.size()), llsd_loaded);
+        ensure_same_item("last item", loaded_items.back(), items.back());
+
+        std::cout << "\nInventory cache, " << category_count << " folders / " << item_count << " items:\n"
+                  << "  LLSD notation save:      " << llsd_save * 1000.0 << " ms, "
+                  << boost::filesystem::file_size(llsd_path.mPath) / 1024 << " KB\n"
+                  << "  LLSD notation load:      " << llsd_load * 1000.0 << " ms\n"
+                  << "  binary save:             " << bin_save * 1000.0 << " ms, "
+                  << boost::filesystem::file_size(bin_path.mPath) / 1024 << " KB\n"
+                  << "  binary load, one thread: " << bin_load * 1000.0 << " ms\n"
+                  << "  binary load, pool of 3:  " << pool_load * 1000.0 << " ms" << std::endl;
+    }
+}
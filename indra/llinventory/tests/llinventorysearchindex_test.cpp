@@ -0,0 +1,234 @@
+/**
+ * @file llinventorysearchindex_test.cpp
+ * @brief LLInventorySearchIndex tests and query benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llformat.h"
+#include "llstring.h"
+
+#include "../llinventorysearchindex.h"
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+
+namespace
+{
+    const char* const WORDS[] =
+    {
+        "Black", "Leather", "Jacket", "Boots", "Mesh", "Hair", "Blonde", "Summer",
+        "Dress", "Red", "Skin", "Tone", "Shape", "Eyes", "Blue", "Hud", "Pose",
+        "Stand", "Texture", "Wood", "Floor", "Tree", "Garden", "Lamp", "Chair",
+        "Script", "Notecard", "Landmark", "Gift", "Box", "Unpacked", "Copy",
+    };
+    const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+    struct Item
+    {
+        std::string mName;
+        std::string mDescription;
+    };
+    typedef std::map<LLUUID, Item> item_map_t;
+
+    std::string make_name(std::mt19937& random)
+    {
+        std::string name;
+        for (U32 words = 2 + random() % 4; words > 0; --words)
+        {
+            name += WORDS[random() % WORD_COUNT];
+            name += ' ';
+        }
+        name += llformat("v%u", random() % 100);
+        return name;
+    }
+
+    LLUUID make_id(std::mt19937& random)
+    {
+        LLUUID id;
+        for (U8& byte : id.mData)
+        {
+            byte = (U8)random();
+        }
+        return id;
+    }
+
+    // What LLInventoryFilter does without an index
+    LLInventorySearchIndex::id_set_t scan(const item_map_t& items, LLInventorySearchIndex::EField field, const std::string& sub_string)
+    {
+        LLInventorySearchIndex::id_set_t ids;
+        for (const auto& entry : items)
+        {
+            std::string text = field == LLInventorySearchIndex::NAME ? entry.second.mName : entry.second.mDescription;
+            LLStringUtil::toUpper(text);
+            if (text.find(sub_string) != std::string::npos)
+            {
+                ids.insert(entry.first);
+            }
+        }
+        return ids;
+    }
+}
+
+namespace tut
+{
+    struct searchindex_data
+    {
+    };
+    typedef test_group<searchindex_data> searchindex_test;
+    typedef searchindex_test::object searchindex_object;
+    tut::searchindex_test searchindex_testcase("LLInventorySearchIndex");
+
+    template<> template<>
+    void searchindex_object::test<1>()
+    {
+        set_test_name("matches a scan through names and descriptions");
+        std::mt19937 random(42);
+        item_map_t items;
+        LLInventorySearchIndex index;
+        index.setIndexDescriptions(true);
+        for (S32 i = 0; i < 5000; ++i)
+        {
+            LLUUID id = make_id(random);
+            items[id] = { make_name(random), make_name(random) };
+            index.update(id, items[id].mName, items[id].mDescription);
+        }
+        ensure_equals("size", index.size(), items.size());
+
+        for (const char* query : { "BLACK", "LEATHER JACKET", "ACK", "V42", "HUD V", "NOTHING LIKE THIS", "EATHER BOO" })
+        {
+            for (LLInventorySearchIndex::EField field : { LLInventorySearchIndex::NAME, LLInventorySearchIndex::DESCRIPTION })
+            {
+                LLInventorySearchIndex::id_set_t found;
+                ensure(std::string("answered ") + query, index.find(field, query, found));
+                ensure(std::string("same as scan ") + query, found == scan(items, field, query));
+            }
+        }
+
+        LLInventorySearchIndex::id_set_t found;
+        ensure("too short", !index.find(LLInventorySearchIndex::NAME, "BL", found));
+        index.setIndexDescriptions(false);
+        ensure("emptied", index.size() == 0);
+        index.update(items.begin()->first, items.begin()->second.mName, items.begin()->second.mDescription);
+        ensure("descriptions not indexed", !index.find(LLInventorySearchIndex::DESCRIPTION, "BLACK", found));
+        ensure("no description text", !index.getText(items.begin()->first, LLInventorySearchIndex::DESCRIPTION));
+    }
+
+    template<> template<>
+    void searchindex_object::test<2>()
+    {
+        set_test_name("renames and removals through compaction");
+        std::mt19937 random(7);
+        item_map_t items;
+        LLInventorySearchIndex index;
+        std::vector<LLUUID> ids;
+        for (S32 i = 0; i < 2000; ++i)
+        {
+            ids.push_back(make_id(random));
+        }
+
+        // enough churn to compact the lists several times
+        for (S32 i = 0; i < 200000; ++i)
+        {
+            const LLUUID& id = ids[random() % ids.size()];
+            const U32 generation = index.getGeneration();
+            if (random() % 4 == 0)
+            {
+                items.erase(id);
+                index.remove(id);
+            }
+            else
+            {
+                items[id].mName = make_name(random);
+                index.update(id, items[id].mName, std::string());
+                ensure("generation bumped", index.getGeneration() != generation);
+            }
+        }
+        ensure_equals("size", index.size(), items.size());
+
+        const U32 generation = index.getGeneration();
+        index.update(items.begin()->first, items.begin()->second.mName, std::string());
+        ensure_equals("unchanged update", index.getGeneration(), generation);
+
+        for (const char* query : { "BLACK", "DRESS RED", "ARD V", " V7" })
+        {
+            LLInventorySearchIndex::id_set_t found;
+            ensure("answered", index.find(LLInventorySearchIndex::NAME, query, found));
+            ensure(std::string("same as scan ") + query, found == scan(items, LLInventorySearchIndex::NAME, query));
+        }
+    }
+
+    template<> template<>
+    void searchindex_object::test<3>()
+    {
+        set_test_name("query benchmark");
+
+        skip_unless_benchmarks();
+        const S32 ITEMS = 200000;
+        std::mt19937 random(1);
+        item_map_t items;
+        for (S32 i = 0; i < ITEMS; ++i)
+        {
+            items[make_id(random)] = { make_name(random), std::string() };
+        }
+
+        typedef std::chrono::steady_clock clock;
+        auto start = clock::now();
+        LLInventorySearchIndex index;
+        for (const auto& entry : items)
+        {
+            index.update(entry.first, entry.second.mName, entry.second.mDescription);
+        }
+        auto built = clock::now();
+
+        std::cout << "\nInventory search index, " << ITEMS << " items, built in "
+                  << std::chrono::duration<F64, std::milli>(built - start).count() << " ms\n";
+        // every prefix of a query typed into the search box
+        for (const std::string query : { "LEATHER JACKET V1", "UNPACKED", "GIFT BOX" })
+        {
+            F64 index_ms = 0.0;
+            F64 scan_ms = 0.0;
+            size_t matches = 0;
+            for (size_t length = 3; length <= query.size(); ++length)
+            {
+                const std::string typed = query.substr(0, length);
+                LLInventorySearchIndex::id_set_t found;
+                auto query_start = clock::now();
+                index.find(LLInventorySearchIndex::NAME, typed, found);
+                auto query_done = clock::now();
+                LLInventorySearchIndex::id_set_t expected = scan(items, LLInventorySearchIndex::NAME, typed);
+                auto scan_done = clock::now();
+                index_ms += std::chrono::duration<F64, std::milli>(query_done - query_start).count();
+                scan_ms += std::chrono::duration<F64, std::milli>(scan_done - query_done).count();
+                ensure("same as scan", found == expected);
+                matches = found.size();
+            }
+            std::cout << "  \"" << query << "\" typed: index " << index_ms << " ms, scan " << scan_ms
+                      << " ms, " << matches << " matches" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,523 @@
+/**
+ * @file llmeshlodreader.cpp
+ * @brief Zero copy reader for inflated mesh LOD blocks.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmeshlodreader.h"
+#include "llsd.h"
+
+namespace
+{
+    // Deep enough for any sane LOD; the LLSD parser gives up at 96
+    const S32 MAX_SKIP_DEPTH = 32;
+
+    // Binary LLSD as written by LLSDBinaryFormatter. Multi byte values are
+    // big endian, blobs are raw.
+    class Cursor
+    {
+    public:
+        Cursor(const U8* data, size_t size)
+        :   mPos(data),
+            mEnd(data + size)
+        {
+        }
+
+        bool atEnd() const          { return mPos >= mEnd; }
+        bool has(size_t n) const    { return (size_t)(mEnd - mPos) >= n; }
+
+        bool peek(U8& c) const
+        {
+            if (!has(1))
+            {
+                return false;
+            }
+            c = *mPos;
+            return true;
+        }
+
+        bool get(U8& c)
+        {
+            if (!peek(c))
+            {
+                return false;
+            }
+            ++mPos;
+            return true;
+        }
+
+        bool expect(U8 c)
+        {
+            U8 got;
+            return get(got) && got == c;
+        }
+
+        bool readU32(U32& value)
+        {
+            if (!has(4))
+            {
+                return false;
+            }
+            value = ((U32)mPos[0] << 24) | ((U32)mPos[1] << 16) | ((U32)mPos[2] << 8) | (U32)mPos[3];
+            mPos += 4;
+            return true;
+        }
+
+        bool readF64(F64& value)
+        {
+            if (!has(8))
+            {
+                return false;
+            }
+            U64 bits = 0;
+            for (S32 i = 0; i < 8; ++i)
+            {
+                bits = (bits << 8) | mPos[i];
+            }
+            memcpy(&value, &bits, sizeof(value));
+            mPos += 8;
+            return true;
+        }
+
+        // Length prefixed bytes, as used by keys, strings, uris and binaries
+        bool readSized(LLMeshLODReader::Blob& blob)
+        {
+            U32 size;
+            if (!readU32(size) || !has(size))
+            {
+                return false;
+            }
+            blob.mData = mPos;
+            blob.mSize = size;
+            mPos += size;
+            return true;
+        }
+
+        bool skip(size_t n)
+        {
+            if (!has(n))
+            {
+                return false;
+            }
+            mPos += n;
+            return true;
+        }
+
+        bool skipValue(S32 depth = MAX_SKIP_DEPTH);
+
+        // A real or integer, as LLSD::asReal() would see it
+        bool readReal(F32& value);
+
+        // An array of reals into at most count floats; missing ones are zero
+        bool readReals(F32* values, U32 count);
+
+        // A binary value; anything else reads as empty, as asBinary() would
+        bool readBinary(LLMeshLODReader::Blob& blob);
+
+        bool readDomain(F32* min_values, F32* max_values, U32 count);
+
+    private:
+        const U8*   mPos;
+        const U8*   mEnd;
+    };
+
+    bool Cursor::skipValue(S32 depth)
+    {
+        U8 c;
+        if (depth <= 0 || !get(c))
+        {
+            return false;
+        }
+
+        LLMeshLODReader::Blob unused;
+        U32 count;
+        switch (c)
+        {
+        case '!':
+        case '0':
+        case '1':
+            return true;
+        case 'i':
+            return skip(4);
+        case 'r':
+        case 'd':
+            return skip(8);
+        case 'u':
+            return skip(16);
+        case 's':
+        case 'l':
+        case 'b':
+            return readSized(unused);
+        case '[':
+            if (!readU32(count))
+            {
+                return false;
+            }
+            for (U32 i = 0; i < count; ++i)
+            {
+                if (!skipValue(depth - 1))
+                {
+                    return false;
+                }
+            }
+            return expect(']');
+        case '{':
+            if (!readU32(count))
+            {
+                return false;
+            }
+            for (U32 i = 0; i < count; ++i)
+            {
+                if (!expect('k') || !readSized(unused) || !skipValue(depth - 1))
+                {
+                    return false;
+                }
+            }
+            return expect('}');
+        default:
+            // Notation style strings and anything newer: let LLSD deal with it
+            return false;
+        }
+    }
+
+    bool Cursor::readReal(F32& value)
+    {
+        U8 c;
+        if (!peek(c))
+        {
+            return false;
+        }
+        if (c == 'r')
+        {
+            F64 real;
+            ++mPos;
+            if (!readF64(real))
+            {
+                return false;
+            }
+            value = (F32)real;
+            return true;
+        }
+        if (c == 'i')
+        {
+            U32 integer;
+            ++mPos;
+            if (!readU32(integer))
+            {
+                return false;
+            }
+            value = (F32)(S32)integer;
+            return true;
+        }
+        value = 0.f;
+        return skipValue();
+    }
+
+    bool Cursor::readReals(F32* values, U32 count)
+    {
+        for (U32 i = 0; i < count; ++i)
+        {
+            values[i] = 0.f;
+        }
+
+        U8 c;
+        if (!peek(c))
+        {
+            return false;
+        }
+        if (c != '[')
+        {
+            return skipValue();
+        }
+
+        U32 size;
+        if (!skip(1) || !readU32(size))
+        {
+            return false;
+        }
+        for (U32 i = 0; i < size; ++i)
+        {
+            F32 value;
+            if (!readReal(value))
+            {
+                return false;
+            }
+            if (i < count)
+            {
+                values[i] = value;
+            }
+        }
+        return expect(']');
+    }
+
+    bool Cursor::readBinary(LLMeshLODReader::Blob& blob)
+    {
+        blob = LLMeshLODReader::Blob();
+
+        U8 c;
+        if (!peek(c))
+        {
+            return false;
+        }
+        if (c != 'b')
+        {
+            return skipValue();
+        }
+        ++mPos;
+        return readSized(blob);
+    }
+
+    bool Cursor::readDomain(F32* min_values, F32* max_values, U32 count)
+    {
+        for (U32 i = 0; i < count; ++i)
+        {
+            min_values[i] = max_values[i] = 0.f;
+        }
+
+        U8 c;
+        if (!peek(c))
+        {
+            return false;
+        }
+        if (c != '{')
+        {
+            return skipValue();
+        }
+
+        U32 size;
+        if (!skip(1) || !readU32(size))
+        {
+            return false;
+        }
+        for (U32 i = 0; i < size; ++i)
+        {
+            LLMeshLODReader::Blob key;
+            if (!expect('k') || !readSized(key))
+            {
+                return false;
+            }
+            bool ok;
+            if (key.mSize == 3 && memcmp(key.mData, "Min", 3) == 0)
+            {
+                ok = readReals(min_values, count);
+            }
+            else if (key.mSize == 3 && memcmp(key.mData, "Max", 3) == 0)
+            {
+                ok = readReals(max_values, count);
+            }
+            else
+            {
+                ok = skipValue();
+            }
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        return expect('}');
+    }
+
+    inline bool key_is(const LLMeshLODReader::Blob& key, const char* name, size_t length)
+    {
+        return key.mSize == length && memcmp(key.mData, name, length) == 0;
+    }
+#define KEY_IS(key, literal) key_is(key, literal, sizeof(literal) - 1)
+
+    bool readFace(Cursor& cursor, LLMeshLODReader::Face& face)
+    {
+        U32 size;
+        if (!cursor.expect('{') || !cursor.readU32(size))
+        {
+            return false;
+        }
+
+        for (U32 i = 0; i < size; ++i)
+        {
+            LLMeshLODReader::Blob key;
+            if (!cursor.expect('k') || !cursor.readSized(key))
+            {
+                return false;
+            }
+
+            bool ok;
+            if (KEY_IS(key, "Position"))
+            {
+                ok = cursor.readBinary(face.mPosition);
+            }
+            else if (KEY_IS(key, "Normal"))
+            {
+                ok = cursor.readBinary(face.mNormal);
+            }
+            else if (KEY_IS(key, "TexCoord0"))
+            {
+                ok = cursor.readBinary(face.mTexCoord0);
+            }
+            else if (KEY_IS(key, "TriangleList"))
+            {
+                ok = cursor.readBinary(face.mTriangleList);
+            }
+            else if (KEY_IS(key, "Weights"))
+            {
+                face.mHasWeights = true;
+                ok = cursor.readBinary(face.mWeights);
+            }
+            else if (KEY_IS(key, "Tangent"))
+            {
+                ok = cursor.readBinary(face.mTangent);
+            }
+            else if (KEY_IS(key, "PositionDomain"))
+            {
+                ok = cursor.readDomain(face.mPositionMin.mV, face.mPositionMax.mV, 3);
+            }
+            else if (KEY_IS(key, "TexCoord0Domain"))
+            {
+                ok = cursor.readDomain(face.mTexCoordMin.mV, face.mTexCoordMax.mV, 2);
+            }
+            else if (KEY_IS(key, "NormalizedScale"))
+            {
+                face.mHasNormalizedScale = true;
+                ok = cursor.readReals(face.mNormalizedScale.mV, 3);
+            }
+            else if (KEY_IS(key, "NoGeometry"))
+            {
+                face.mNoGeometry = true;
+                ok = cursor.skipValue();
+            }
+            else
+            {
+                ok = cursor.skipValue();
+            }
+
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        return cursor.expect('}');
+    }
+#undef KEY_IS
+
+    void blobFromLLSD(const LLSD& value, LLMeshLODReader::Blob& blob)
+    {
+        const LLSD::Binary& binary = value.asBinary();
+        blob.mData = binary.empty() ? nullptr : binary.data();
+        blob.mSize = binary.size();
+    }
+}
+
+// static
+bool LLMeshLODReader::parse(const U8* data, size_t size, std::vector<Face>& faces)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    faces.clear();
+
+    // Old assets may carry the deprecated "<? LLSD/Binary ?>" header line
+    static const char DEPRECATED_HEADER[] = "<? LLSD/Binary ?>";
+    const size_t header_length = sizeof(DEPRECATED_HEADER) - 1;
+    if (size > header_length && memcmp(data, DEPRECATED_HEADER, header_length) == 0)
+    {
+        data += header_length;
+        size -= header_length;
+        while (size && (*data == '\n' || *data == '\r'))
+        {
+            ++data;
+            --size;
+        }
+    }
+
+    Cursor cursor(data, size);
+    U32 count;
+    if (!cursor.expect('[') || !cursor.readU32(count))
+    {
+        return false;
+    }
+
+    // Every face takes at least a map header, so a count beyond that is garbage
+    if (!cursor.has((size_t)count * 6))
+    {
+        return false;
+    }
+    faces.resize(count);
+
+    for (U32 i = 0; i < count; ++i)
+    {
+        if (!readFace(cursor, faces[i]))
+        {
+            faces.clear();
+            return false;
+        }
+    }
+    if (!cursor.expect(']'))
+    {
+        faces.clear();
+        return false;
+    }
+    return true;
+}
+
+// static
+bool LLMeshLODReader::fromLLSD(const LLSD& mdl, std::vector<Face>& faces)
+{
+    faces.clear();
+    faces.resize(mdl.size());
+
+    for (size_t i = 0; i < faces.size(); ++i)
+    {
+        const LLSD& submesh = mdl[i];
+        Face& face = faces[i];
+
+        face.mNoGeometry = submesh.has("NoGeometry");
+        if (face.mNoGeometry)
+        {
+            continue;
+        }
+
+        blobFromLLSD(submesh["Position"], face.mPosition);
+        blobFromLLSD(submesh["Normal"], face.mNormal);
+        blobFromLLSD(submesh["Tangent"], face.mTangent);
+        blobFromLLSD(submesh["TexCoord0"], face.mTexCoord0);
+        blobFromLLSD(submesh["TriangleList"], face.mTriangleList);
+
+        face.mHasWeights = submesh.has("Weights");
+        if (face.mHasWeights)
+        {
+            blobFromLLSD(submesh["Weights"], face.mWeights);
+        }
+
+        face.mPositionMin.setValue(submesh["PositionDomain"]["Min"]);
+        face.mPositionMax.setValue(submesh["PositionDomain"]["Max"]);
+        face.mTexCoordMin.setValue(submesh["TexCoord0Domain"]["Min"]);
+        face.mTexCoordMax.setValue(submesh["TexCoord0Domain"]["Max"]);
+
+        face.mHasNormalizedScale = submesh.has("NormalizedScale");
+        if (face.mHasNormalizedScale)
+        {
+            face.mNormalizedScale.setValue(submesh["NormalizedScale"]);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file llmeshlodreader.h
+ * @brief Zero copy reader for inflated mesh LOD blocks.
+ *
+ * @Description:
+ * A mesh LOD block is a binary LLSD array with one map per submesh:
+ *
+ *     [ { 'Position': binary, 'Normal': binary, 'TexCoord0': binary,
+ *         'TriangleList': binary, 'Weights': binary,
+ *         'PositionDomain': { 'Min': [r,r,r], 'Max': [r,r,r] },
+ *         'TexCoord0Domain': { 'Min': [r,r], 'Max': [r,r] },
+ *         'NormalizedScale': [r,r,r], 'NoGeometry': ... }, ... ]
+ *
+ * Building an LLSD tree from it costs one heap node per value and a copy
+ * of every binary blob, only for LLVolume to copy the blobs again. This
+ * reader walks the serialized form directly and hands back pointers into
+ * the inflated buffer instead.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESHLODREADER_H
+#define LL_LLMESHLODREADER_H
+
+#include "v2math.h"
+#include "v3math.h"
+
+#include <vector>
+
+class LLSD;
+
+class LLMeshLODReader
+{
+public:
+    // A view of a binary value. Not aligned, not owned.
+    struct Blob
+    {
+        const U8*   mData = nullptr;
+        size_t      mSize = 0;
+
+        bool empty() const  { return mSize == 0; }
+    };
+
+    struct Face
+    {
+        bool        mNoGeometry = false;
+        bool        mHasNormalizedScale = false;
+        bool        mHasWeights = false;
+
+        Blob        mPosition;
+        Blob        mNormal;
+        Blob        mTangent;
+        Blob        mTexCoord0;
+        Blob        mTriangleList;
+        Blob        mWeights;
+
+        LLVector3   mPositionMin;
+        LLVector3   mPositionMax;
+        LLVector2   mTexCoordMin;
+        LLVector2   mTexCoordMax;
+        LLVector3   mNormalizedScale;
+    };
+
+    /**
+     * Read the submeshes of an inflated LOD block. The blobs point into
+     * data, which must outlive faces. Returns false if the block is not
+     * laid out as expected; callers should fall back to the generic LLSD
+     * parser then, which either copes or reports the error.
+     */
+    static bool parse(const U8* data, size_t size, std::vector<Face>& faces);
+
+    /// Fill faces from an already parsed LOD. The blobs point into mdl.
+    static bool fromLLSD(const LLSD& mdl, std::vector<Face>& faces);
+};
+
+#endif // LL_LLMESHLODREADER_H
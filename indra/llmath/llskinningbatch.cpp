@@ -0,0 +1,248 @@
+/**
+ * @file llskinningbatch.cpp
+ * @brief Batched CPU skinning of one rigged volume face.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmath.h"
+#include "llskinningbatch.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+    // Same decode as FSSkinningUtil::getPerVertexSkinMatrixSSE, so the
+    // blended matrices come out bit for bit the same.
+    void decode_weights(const LLVector4a& weights, U32 max_joints, S32* joint, F32* weight)
+    {
+        LL_ALIGN_16(S32 idx[4]);
+        LL_ALIGN_16(F32 wght[4]);
+
+        __m128i max_idx = _mm_set1_epi32((S32)max_joints - 1);
+        __m128i mIdx = _mm_cvttps_epi32((__m128)weights);
+        __m128 mWeight = _mm_sub_ps((__m128)weights, _mm_cvtepi32_ps(mIdx));
+
+        // no _mm_min_epi32 in SSE2
+        __m128i over = _mm_cmpgt_epi32(mIdx, max_idx);
+        mIdx = _mm_or_si128(_mm_and_si128(over, max_idx), _mm_andnot_si128(over, mIdx));
+        _mm_store_si128((__m128i*)idx, mIdx);
+
+        __m128 mScale = _mm_add_ps(mWeight, _mm_movehl_ps(mWeight, mWeight));
+        mScale = _mm_add_ss(mScale, _mm_shuffle_ps(mScale, mScale, 1));
+        mScale = _mm_shuffle_ps(mScale, mScale, 0);
+
+        mWeight = _mm_div_ps(mWeight, mScale);
+        _mm_store_ps(wght, mWeight);
+
+        for (S32 k = 0; k < 4; ++k)
+        {
+            joint[k] = llmax(idx[k], 0);
+            weight[k] = wght[k];
+        }
+    }
+
+    template <int C>
+    inline __m128 splat(const LLVector4a& v)
+    {
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(C, C, C, C));
+    }
+
+    // one output component for four vertices, in affineTransformSSE()'s order
+    template <int C>
+    inline __m128 transform(const LLMatrix4a& mat, __m128 x, __m128 y, __m128 z)
+    {
+        __m128 xy = _mm_add_ps(_mm_mul_ps(x, splat<C>(mat.mMatrix[0])), _mm_mul_ps(y, splat<C>(mat.mMatrix[1])));
+        __m128 zt = _mm_add_ps(_mm_mul_ps(z, splat<C>(mat.mMatrix[2])), splat<C>(mat.mMatrix[3]));
+        return _mm_add_ps(xy, zt);
+    }
+}
+
+void LLSkinningBatch::clear()
+{
+    mInfluences.clear();
+    mX.clear();
+    mY.clear();
+    mZ.clear();
+    mVertex.clear();
+    mPositions = nullptr;
+    mWeights = nullptr;
+    mFingerprint = 0;
+    mMaxJoints = 0;
+}
+
+// static
+U64 LLSkinningBatch::fingerprint(const LLVector4a* positions, const LLVector4a* weights, U32 num_vertices)
+{
+    // a few vertices spread over the face, enough to notice the pointers
+    // being reused for other geometry
+    constexpr U32 SAMPLES = 16;
+    U64 hash = 14695981039346656037ULL;
+    auto mix = [&hash](const LLVector4a& v)
+    {
+        U32 bits[4];
+        memcpy(bits, v.getF32ptr(), sizeof(bits));
+        for (U32 b : bits)
+        {
+            hash = (hash ^ b) * 1099511628211ULL;
+        }
+    };
+    U32 step = llmax(num_vertices / SAMPLES, 1u);
+    for (U32 i = 0; i < num_vertices; i += step)
+    {
+        mix(positions[i]);
+        mix(weights[i]);
+    }
+    mix(positions[num_vertices - 1]);
+    mix(weights[num_vertices - 1]);
+    return hash;
+}
+
+bool LLSkinningBatch::isBuiltFor(const LLVector4a* positions, const LLVector4a* weights, U32 num_vertices,
+                                 const LLMatrix4a& bind_shape, U32 max_joints) const
+{
+    return num_vertices > 0
+        && positions == mPositions
+        && weights == mWeights
+        && num_vertices == getVertexCount()
+        && max_joints == mMaxJoints
+        && !memcmp(&bind_shape, &mBindShape, sizeof(LLMatrix4a))
+        && fingerprint(positions, weights, num_vertices) == mFingerprint;
+}
+
+void LLSkinningBatch::build(const LLVector4a* positions, const LLVector4a* weights, U32 num_vertices,
+                            const LLMatrix4a& bind_shape, U32 max_joints)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+    clear();
+    if (!positions || !weights || !num_vertices || !max_joints)
+    {
+        return;
+    }
+
+    std::vector<Influence> decoded(num_vertices);
+    for (U32 i = 0; i < num_vertices; ++i)
+    {
+        decode_weights(weights[i], max_joints, decoded[i].mJoint, decoded[i].mWeight);
+    }
+
+    // Vertices with the same joints and weights end up next to each other.
+    // The order among influences does not matter, only that equal ones are
+    // adjacent, so compare the raw bytes.
+    constexpr size_t KEY_SIZE = sizeof(Influence::mJoint) + sizeof(Influence::mWeight);
+    static_assert(offsetof(Influence, mWeight) == sizeof(Influence::mJoint), "joints and weights must be adjacent");
+    mVertex.resize(num_vertices);
+    std::iota(mVertex.begin(), mVertex.end(), 0);
+    std::sort(mVertex.begin(), mVertex.end(), [&decoded](U32 a, U32 b)
+        {
+            S32 order = memcmp(&decoded[a], &decoded[b], KEY_SIZE);
+            return order < 0 || (order == 0 && a < b);
+        });
+
+    mX.resize(num_vertices);
+    mY.resize(num_vertices);
+    mZ.resize(num_vertices);
+    for (U32 j = 0; j < num_vertices; ++j)
+    {
+        U32 v = mVertex[j];
+        LLVector4a t;
+        bind_shape.affineTransform(positions[v], t);
+        mX[j] = t[0];
+        mY[j] = t[1];
+        mZ[j] = t[2];
+
+        if (j == 0 || memcmp(&decoded[v], &mInfluences.back(), KEY_SIZE))
+        {
+            mInfluences.push_back(decoded[v]);
+        }
+        mInfluences.back().mEnd = j + 1;
+    }
+
+    mPositions = positions;
+    mWeights = weights;
+    mBindShape = bind_shape;
+    mMaxJoints = max_joints;
+    mFingerprint = fingerprint(positions, weights, num_vertices);
+}
+
+void LLSkinningBatch::skin(const LLMatrix4a* palette, LLVector4a* out, LLVector4a& min, LLVector4a& max) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+    if (mVertex.empty())
+    {
+        min.clear();
+        max.clear();
+        return;
+    }
+
+    __m128 lo = _mm_set1_ps(F32_MAX);
+    __m128 hi = _mm_set1_ps(-F32_MAX);
+    U32 begin = 0;
+    for (const Influence& influence : mInfluences)
+    {
+        // blended the way getPerVertexSkinMatrixSSE() does it
+        LLMatrix4a mat;
+        mat.clear();
+        for (S32 k = 0; k < 4; ++k)
+        {
+            LLMatrix4a src;
+            src.setMul(palette[influence.mJoint[k]], influence.mWeight[k]);
+            mat.add(src);
+        }
+
+        U32 j = begin;
+        for (; j + 4 <= influence.mEnd; j += 4)
+        {
+            __m128 x = _mm_loadu_ps(&mX[j]);
+            __m128 y = _mm_loadu_ps(&mY[j]);
+            __m128 z = _mm_loadu_ps(&mZ[j]);
+            __m128 v0 = transform<0>(mat, x, y, z);
+            __m128 v1 = transform<1>(mat, x, y, z);
+            __m128 v2 = transform<2>(mat, x, y, z);
+            __m128 v3 = transform<3>(mat, x, y, z);
+            _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+            out[mVertex[j]] = v0;
+            out[mVertex[j + 1]] = v1;
+            out[mVertex[j + 2]] = v2;
+            out[mVertex[j + 3]] = v3;
+            lo = _mm_min_ps(lo, _mm_min_ps(_mm_min_ps(v0, v1), _mm_min_ps(v2, v3)));
+            hi = _mm_max_ps(hi, _mm_max_ps(_mm_max_ps(v0, v1), _mm_max_ps(v2, v3)));
+        }
+        for (; j < influence.mEnd; ++j)
+        {
+            LLVector4a t(mX[j], mY[j], mZ[j]);
+            LLVector4a& dst = out[mVertex[j]];
+            mat.affineTransform(t, dst);
+            lo = _mm_min_ps(lo, dst);
+            hi = _mm_max_ps(hi, dst);
+        }
+        begin = influence.mEnd;
+    }
+    min = lo;
+    max = hi;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file llskinningbatch.h
+ * @brief Batched CPU skinning of one rigged volume face.
+ *
+ * @Description:
+ * Skinning a vertex blends up to four joint matrices by its weights and
+ * transforms the bind shape space position by the result. On mesh bodies
+ * most vertices share their influences with many others: whole regions
+ * follow a single joint, seams blend the same two joints the same way.
+ * LLSkinningBatch groups the vertices of a face by influence once, keeps
+ * their bind shape space positions in that order as separate x, y and z
+ * runs, and then per update blends one matrix per influence and
+ * transforms the vertices sharing it four at a time.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSKINNINGBATCH_H
+#define LL_LLSKINNINGBATCH_H
+
+#include "llmatrix4a.h"
+
+#include <vector>
+
+class LLSkinningBatch
+{
+public:
+    // Weights are in LLVolumeFace::mWeights form: per component the joint
+    // index plus its weight. Indices are clamped to max_joints - 1.
+    void build(const LLVector4a* positions, const LLVector4a* weights, U32 num_vertices,
+               const LLMatrix4a& bind_shape, U32 max_joints);
+
+    // true if build() was last called with the same arguments
+    bool isBuiltFor(const LLVector4a* positions, const LLVector4a* weights, U32 num_vertices,
+                    const LLMatrix4a& bind_shape, U32 max_joints) const;
+
+    void clear();
+
+    // Writes the skinned positions to out[0 .. num_vertices) and their
+    // bounds to min and max. Same results as blending the matrices and
+    // transforming one vertex at a time.
+    void skin(const LLMatrix4a* palette, LLVector4a* out, LLVector4a& min, LLVector4a& max) const;
+
+    U32 getVertexCount() const { return (U32)mVertex.size(); }
+    U32 getInfluenceCount() const { return (U32)mInfluences.size(); }
+
+private:
+    struct Influence
+    {
+        S32 mJoint[4];
+        F32 mWeight[4];
+        U32 mEnd;       // one past its last vertex in influence order
+    };
+
+    static U64 fingerprint(const LLVector4a* positions, const LLVector4a* weights, U32 num_vertices);
+
+    std::vector<Influence> mInfluences;
+    // bind shape space positions in influence order
+    std::vector<F32> mX;
+    std::vector<F32> mY;
+    std::vector<F32> mZ;
+    // index of each of those in the face
+    std::vector<U32> mVertex;
+
+    const LLVector4a* mPositions = nullptr;
+    const LLVector4a* mWeights = nullptr;
+    U64 mFingerprint = 0;
+    LLMatrix4a mBindShape;
+    U32 mMaxJoints = 0;
+};
+
+#endif // LL_LLSKINNINGBATCH_H
@@ -32,6 +32,8 @@
 #include <stdint.h>
 #endif
 #include <cmath>
+#include <limits>
+#include <mutex>
 #include <unordered_map>
 
 #include "llerror.h"
@@ -52,6 +54,7 @@
 #include "llmeshoptimizer.h"
 #include "lltimer.h"
 #include "llvolumeoctree.h"
+#include "llvolumebvh.h"
 
 #include "mikktspace/mikktspace.hh"
 
@@ -2313,35 +2316,87 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
 
     //input stream is now pointing at a zlib compressed block of LLSD
-    //decompress block
-    LLSD mdl;
-    U32 uzip_result = LLUZipHelper::unzip_llsd(mdl, is, size);
-    if (uzip_result != LLUZipHelper::ZR_OK)
+    // <FS> Streaming mesh decoder
+    std::unique_ptr<U8[]> in = std::unique_ptr<U8[]>(new(std::nothrow) U8[size]);
+    if (!in)
     {
-        LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD with code " << uzip_result << " , will probably fetch from sim again." << LL_ENDL;
+        LL_DEBUGS("MeshStreaming") << "Failed to allocate " << size << " bytes for LoD, will probably fetch from sim again." << LL_ENDL;
+        return false;
+    }
+    is.read((char*)in.get(), size);
+    if (is.gcount() != size)
+    {
+        LL_DEBUGS("MeshStreaming") << "LoD stream ended after " << is.gcount() << " of " << size << " bytes" << LL_ENDL;
         return false;
     }
-    return unpackVolumeFacesInternal(mdl);
+    return unpackVolumeFaces(in.get(), size);
+    // </FS>
 }
 
 bool LLVolume::unpackVolumeFaces(U8* in_data, S32 size)
 {
+    // <FS> Streaming mesh decoder
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
     //input data is now pointing at a zlib compressed block of LLSD
-    //decompress block
-    LLSD mdl;
-    U32 uzip_result = LLUZipHelper::unzip_llsd(mdl, in_data, size);
+    //decompress block into a per thread buffer and read the submeshes
+    //straight out of it, no LLSD tree in between
+    static thread_local std::vector<U8> inflated;
+    static thread_local std::vector<LLMeshLODReader::Face> faces;
+    // don't let one huge LoD pin its buffer to a thread forever
+    constexpr size_t MAX_RETAINED_BYTES = 8 * 1024 * 1024;
+
+    size_t inflated_size = 0;
+    U32 uzip_result = LLUZipHelper::unzip_raw(in_data, size, inflated, inflated_size);
     if (uzip_result != LLUZipHelper::ZR_OK)
     {
         LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD with code " << uzip_result << " , will probably fetch from sim again." << LL_ENDL;
         return false;
     }
-    return unpackVolumeFacesInternal(mdl);
+
+    bool success;
+    if (LLMeshLODReader::parse(inflated.data(), inflated_size, faces))
+    {
+        success = unpackVolumeFacesInternal(faces);
+    }
+    else
+    {
+        // Not the layout we know, let the generic parser have a go
+        LLSD mdl;
+        uzip_result = LLUZipHelper::unzip_llsd(mdl, in_data, size);
+        if (uzip_result != LLUZipHelper::ZR_OK)
+        {
+            LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD with code " << uzip_result << " , will probably fetch from sim again." << LL_ENDL;
+            success = false;
+        }
+        else
+        {
+            success = unpackVolumeFacesInternal(mdl);
+        }
+    }
+
+    faces.clear();
+    if (inflated.size() > MAX_RETAINED_BYTES)
+    {
+        std::vector<U8>().swap(inflated);
+    }
+    return success;
+    // </FS>
 }
 
 bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
 {
+    // <FS> Streaming mesh decoder
+    std::vector<LLMeshLODReader::Face> faces;
+    LLMeshLODReader::fromLLSD(mdl, faces);
+    return unpackVolumeFacesInternal(faces);
+}
+
+bool LLVolume::unpackVolumeFacesInternal(const std::vector<LLMeshLODReader::Face>& faces)
+{
+    // </FS>
     {
-        auto face_count = mdl.size();
+        auto face_count = faces.size();
 
         if (face_count == 0)
         { //no faces unpacked, treat as failed decode
@@ -2354,8 +2409,9 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
         for (size_t i = 0; i < face_count; ++i)
         {
             LLVolumeFace& face = mVolumeFaces[i];
+            const LLMeshLODReader::Face& submesh = faces[i];
 
-            if (mdl[i].has("NoGeometry"))
+            if (submesh.mNoGeometry)
             { //face has no geometry, continue
                 face.resizeIndices(3);
                 face.resizeVertices(1);
@@ -2366,14 +2422,14 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                 continue;
             }
 
-            const LLSD::Binary& pos = mdl[i]["Position"].asBinary();
-            const LLSD::Binary& norm = mdl[i]["Normal"].asBinary();
-            const LLSD::Binary& tangent = mdl[i]["Tangent"].asBinary();
-            const LLSD::Binary& tc = mdl[i]["TexCoord0"].asBinary();
-            const LLSD::Binary& idx = mdl[i]["TriangleList"].asBinary();
+            // The blobs may point into an inflated buffer at any alignment
+            const LLMeshLODReader::Blob& pos = submesh.mPosition;
+            const LLMeshLODReader::Blob& norm = submesh.mNormal;
+            const LLMeshLODReader::Blob& tc = submesh.mTexCoord0;
+            const LLMeshLODReader::Blob& idx = submesh.mTriangleList;
 
             //copy out indices
-            auto num_indices = idx.size() / 2;
+            auto num_indices = idx.mSize / 2;
             const S32 indices_to_discard = num_indices % 3;
             if (indices_to_discard > 0)
             {
@@ -2395,14 +2451,10 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                 continue;
             }
 
-            U16* indices = (U16*) &(idx[0]);
-            for (U32 j = 0; j < num_indices; ++j)
-            {
-                face.mIndices[j] = indices[j];
-            }
+            memcpy(face.mIndices, idx.mData, num_indices * sizeof(U16));
 
             //copy out vertices
-            U32 num_verts = static_cast<U32>(pos.size())/(3*2);
+            U32 num_verts = static_cast<U32>(pos.mSize)/(3*2);
             face.resizeVertices(num_verts);
 
             if (num_verts > 0 && !face.mPositions)
@@ -2412,24 +2464,19 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                 continue;
             }
 
-            LLVector3 minp;
-            LLVector3 maxp;
-            LLVector2 min_tc;
-            LLVector2 max_tc;
+            const LLVector3& minp = submesh.mPositionMin;
+            const LLVector3& maxp = submesh.mPositionMax;
+            const LLVector2& min_tc = submesh.mTexCoordMin;
+            const LLVector2& max_tc = submesh.mTexCoordMax;
 
-            minp.setValue(mdl[i]["PositionDomain"]["Min"]);
-            maxp.setValue(mdl[i]["PositionDomain"]["Max"]);
             LLVector4a min_pos, max_pos;
             min_pos.load3(minp.mV);
             max_pos.load3(maxp.mV);
 
-            min_tc.setValue(mdl[i]["TexCoord0Domain"]["Min"]);
-            max_tc.setValue(mdl[i]["TexCoord0Domain"]["Max"]);
-
             //unpack normalized scale/translation
-            if (mdl[i].has("NormalizedScale"))
+            if (submesh.mHasNormalizedScale)
             {
-                face.mNormalizedScale.setValue(mdl[i]["NormalizedScale"]);
+                face.mNormalizedScale = submesh.mNormalizedScale;
             }
             else
             {
@@ -2449,49 +2496,50 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
             LLVector4a* tc_out = (LLVector4a*) face.mTexCoords;
 
             {
-                U16* v = (U16*) &(pos[0]);
+                const U8* src = pos.mData;
                 for (U32 j = 0; j < num_verts; ++j)
                 {
+                    U16 v[3];
+                    memcpy(v, src, sizeof(v));
+                    src += sizeof(v);
                     pos_out->set((F32) v[0], (F32) v[1], (F32) v[2]);
                     pos_out->div(65535.f);
                     pos_out->mul(pos_range);
                     pos_out->add(min_pos);
                     pos_out++;
-                    v += 3;
                 }
 
             }
 
             {
-                if (!norm.empty())
+                // a short normal list leaves the remaining normals cleared
+                const U32 num_norms = llmin(num_verts, static_cast<U32>(norm.mSize) / (3 * 2));
+                const U8* src = norm.mData;
+                for (U32 j = 0; j < num_norms; ++j)
                 {
-                    U16* n = (U16*) &(norm[0]);
-                    for (U32 j = 0; j < num_verts; ++j)
-                    {
-                        norm_out->set((F32) n[0], (F32) n[1], (F32) n[2]);
-                        norm_out->div(65535.f);
-                        norm_out->mul(2.f);
-                        norm_out->sub(1.f);
-                        norm_out++;
-                        n += 3;
-                    }
+                    U16 n[3];
+                    memcpy(n, src, sizeof(n));
+                    src += sizeof(n);
+                    norm_out->set((F32) n[0], (F32) n[1], (F32) n[2]);
+                    norm_out->div(65535.f);
+                    norm_out->mul(2.f);
+                    norm_out->sub(1.f);
+                    norm_out++;
                 }
-                else
+                for (U32 j = num_norms; j < num_verts; ++j)
                 {
-                    for (U32 j = 0; j < num_verts; ++j)
-                    {
-                        norm_out->clear();
-                        norm_out++; // or just norm_out[j].clear();
-                    }
+                    norm_out->clear();
+                    norm_out++; // or just norm_out[j].clear();
                 }
             }
 
 #if 0 // keep this code for now in case we decide to add support for on-the-wire tangents
             {
+                const LLMeshLODReader::Blob& tangent = submesh.mTangent;
                 if (!tangent.empty())
                 {
                     face.allocateTangents(face.mNumVertices);
-                    U16* t = (U16*)&(tangent[0]);
+                    U16* t = (U16*)tangent.mData;
 
                     // NOTE: tangents coming from the asset may not be mikkt space, but they should always be used by the GLTF shaders to
                     // maintain compliance with the GLTF spec
@@ -2515,11 +2563,18 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
 #endif
 
             {
-                if (!tc.empty())
+                // coordinates missing from a short list decode as the domain minimum
+                const U32 num_tcs = llmin(num_verts, static_cast<U32>(tc.mSize) / (2 * 2));
+                if (num_tcs > 0)
                 {
-                    U16* t = (U16*) &(tc[0]);
+                    const U8* src = tc.mData;
                     for (U32 j = 0; j < num_verts; j+=2)
                     {
+                        U16 t[4] = { 0, 0, 0, 0 };
+                        if (j < num_tcs)
+                        {
+                            memcpy(t, src, (j + 1 < num_tcs ? 4 : 2) * sizeof(U16));
+                        }
                         if (j < num_verts-1)
                         {
                             tc_out->set((F32) t[0], (F32) t[1], (F32) t[2], (F32) t[3]);
@@ -2529,7 +2584,7 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                             tc_out->set((F32) t[0], (F32) t[1], 0.f, 0.f);
                         }
 
-                        t += 4;
+                        src += 4 * sizeof(U16);
 
                         tc_out->div(65535.f);
                         tc_out->mul(tc_range);
@@ -2548,7 +2603,7 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                 }
             }
 
-            if (mdl[i].has("Weights"))
+            if (submesh.mHasWeights)
             {
                 face.allocateWeights(num_verts);
                 if (!face.mWeights && num_verts)
@@ -2559,12 +2614,13 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                     continue;
                 }
 
-                const LLSD::Binary& weights = mdl[i]["Weights"].asBinary();
+                const U8* weights = submesh.mWeights.mData;
+                const U32 weights_size = static_cast<U32>(submesh.mWeights.mSize);
 
                 U32 idx = 0;
 
                 U32 cur_vertex = 0;
-                while (idx < weights.size() && cur_vertex < num_verts)
+                while (idx < weights_size && cur_vertex < num_verts)
                 {
                     const U8 END_INFLUENCES = 0xFF;
                     U8 joint = weights[idx++];
@@ -2574,10 +2630,10 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                     U32 joints[4] = {0,0,0,0};
                     LLVector4 joints_with_weights(0,0,0,0);
 
-                    while (joint != END_INFLUENCES && idx < weights.size())
+                    while (joint != END_INFLUENCES && idx < weights_size)
                     {
                         U16 influence = weights[idx++];
-                        influence |= ((U16) weights[idx++] << 8);
+                        influence |= (idx < weights_size) ? ((U16) weights[idx++] << 8) : 0;
 
                         F32 w = llclamp((F32) influence / 65535.f, 0.001f, 0.999f);
                         wght.mV[cur_influence] = w;
@@ -2590,7 +2646,7 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                         }
                         else
                         {
-                            joint = weights[idx++];
+                            joint = (idx < weights_size) ? weights[idx++] : END_INFLUENCES;
                         }
                     }
                     F32 wsum = wght.mV[VX] + wght.mV[VY] + wght.mV[VZ] + wght.mV[VW];
@@ -2611,7 +2667,7 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
                     cur_vertex++;
                 }
 
-                if (cur_vertex != num_verts || idx != weights.size())
+                if (cur_vertex != num_verts || idx != weights_size)
                 {
                     LL_WARNS() << "Vertex weight count does not match vertex count!" << LL_ENDL;
                 }
@@ -4396,12 +4452,82 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
                     }
                 }
             }
-            else
+            else if (LLVolumeFace::getRaycastBVH())
             {
-                if (!face.getOctree())
+                // built on the first raycast to get this far
+                face.createBVH();
+
+                F32 a, b;
+                S32 triangle = face.getBVH()->intersect(start, dir, closest_t, a, b);
+                if (triangle >= 0)
                 {
-                    face.createOctree();
+                    hit_face = i;
+
+                    if (intersection != NULL)
+                    {
+                        LLVector4a intersect = dir;
+                        intersect.mul(closest_t);
+                        intersect.add(start);
+                        *intersection = intersect;
+                    }
+
+                    U16 idx0 = face.mIndices[triangle * 3 + 0];
+                    U16 idx1 = face.mIndices[triangle * 3 + 1];
+                    U16 idx2 = face.mIndices[triangle * 3 + 2];
+
+                    if (tex_coord != NULL && face.mTexCoords)
+                    {
+                        LLVector2* tc = (LLVector2*) face.mTexCoords;
+                        *tex_coord = ((1.f - a - b)  * tc[idx0] +
+                            a              * tc[idx1] +
+                            b              * tc[idx2]);
+                    }
+
+                    if (normal != NULL && face.mNormals)
+                    {
+                        LLVector4a* norm = face.mNormals;
+
+                        LLVector4a n1,n2,n3;
+                        n1 = norm[idx0];
+                        n1.mul(1.f-a-b);
+
+                        n2 = norm[idx1];
+                        n2.mul(a);
+
+                        n3 = norm[idx2];
+                        n3.mul(b);
+
+                        n1.add(n2);
+                        n1.add(n3);
+
+                        *normal     = n1;
+                    }
+
+                    if (tangent_out != NULL && face.mTangents)
+                    {
+                        LLVector4a* tangents = face.mTangents;
+
+                        LLVector4a t1,t2,t3;
+                        t1 = tangents[idx0];
+                        t1.mul(1.f-a-b);
+
+                        t2 = tangents[idx1];
+                        t2.mul(a);
+
+                        t3 = tangents[idx2];
+                        t3.mul(b);
+
+                        t1.add(t2);
+                        t1.add(t3);
+
+                        *tangent_out = t1;
+                    }
                 }
+            }
+            else
+            {
+                // built on the first raycast to get this far
+                face.createOctree();
 
                 LLOctreeTriangleRayIntersect intersect(start, dir, &face, &closest_t, intersection, tex_coord, normal, tangent_out);
                 intersect.traverse(face.getOctree());
@@ -5842,13 +5968,139 @@ bool LLVolumeFace::cacheOptimize(bool gen_tangents)
     return true;
 }
 
+namespace
+{
+    // Face octrees by last use, most recent first. Guards the links and
+    // the octree pointers of the faces on the list.
+    std::mutex sOctreeMutex;
+    LLVolumeFace* sOctreeHead = nullptr;
+    LLVolumeFace* sOctreeTail = nullptr;
+    U64 sOctreeBytes = 0;
+    U32 sOctreeCount = 0;
+    U64 sOctreeBudget = std::numeric_limits<U64>::max();
+    bool sRaycastBVH = false;
+
+    // Rough footprint of a face octree: its nodes, their listeners and
+    // element lists. The triangles are counted by the caller.
+    class LLVolumeOctreeSize : public LLOctreeTraveler<LLVolumeTriangle, LLVolumeTriangle*>
+    {
+    public:
+        U64 mBytes = 0;
+
+        void visit(const LLOctreeNode<LLVolumeTriangle, LLVolumeTriangle*>* branch) override
+        {
+            mBytes += sizeof(LLOctreeNode<LLVolumeTriangle, LLVolumeTriangle*>) + sizeof(LLVolumeOctreeListener)
+                    + branch->getElementCount() * sizeof(LLVolumeTriangle*);
+        }
+    };
+}
+
+// static
+void LLVolumeFace::setOctreeBudget(U64 bytes)
+{
+    std::vector<EvictedOctree> evicted;
+    {
+        std::lock_guard<std::mutex> lock(sOctreeMutex);
+        sOctreeBudget = bytes;
+        evictOctrees(nullptr, evicted);
+    }
+    deleteEvicted(evicted);
+}
+
+// static
+U64 LLVolumeFace::getOctreeBytes()
+{
+    std::lock_guard<std::mutex> lock(sOctreeMutex);
+    return sOctreeBytes;
+}
+
+// static
+U32 LLVolumeFace::getOctreeCount()
+{
+    std::lock_guard<std::mutex> lock(sOctreeMutex);
+    return sOctreeCount;
+}
+
+void LLVolumeFace::linkOctree()
+{
+    mOctreePrev = nullptr;
+    mOctreeNext = sOctreeHead;
+    if (sOctreeHead)
+    {
+        sOctreeHead->mOctreePrev = this;
+    }
+    sOctreeHead = this;
+    if (!sOctreeTail)
+    {
+        sOctreeTail = this;
+    }
+}
+
+void LLVolumeFace::unlinkOctree()
+{
+    (mOctreePrev ? mOctreePrev->mOctreeNext : sOctreeHead) = mOctreeNext;
+    (mOctreeNext ? mOctreeNext->mOctreePrev : sOctreeTail) = mOctreePrev;
+    mOctreePrev = nullptr;
+    mOctreeNext = nullptr;
+}
+
+void LLVolumeFace::addOctreeBytes(U64 bytes, std::vector<EvictedOctree>& evicted)
+{
+    if (mOctreeBytes)
+    {
+        unlinkOctree();
+    }
+    else
+    {
+        ++sOctreeCount;
+    }
+    mOctreeBytes += bytes;
+    sOctreeBytes += bytes;
+    linkOctree();
+    evictOctrees(this, evicted);
+}
+
+// static
+void LLVolumeFace::evictOctrees(const LLVolumeFace* keep, std::vector<EvictedOctree>& evicted)
+{
+    while (sOctreeBytes > sOctreeBudget && sOctreeTail && sOctreeTail != keep)
+    {
+        LLVolumeFace* face = sOctreeTail;
+        face->unlinkOctree();
+        sOctreeBytes -= face->mOctreeBytes;
+        --sOctreeCount;
+        face->mOctreeBytes = 0;
+        evicted.push_back({ face->mOctree, face->mOctreeTriangles, face->mBVH });
+        face->mOctree = nullptr;
+        face->mOctreeTriangles = nullptr;
+        face->mBVH = nullptr;
+    }
+}
+
+// static
+void LLVolumeFace::deleteEvicted(const std::vector<EvictedOctree>& evicted)
+{
+    for (const EvictedOctree& octree : evicted)
+    {
+        delete octree.mOctree;
+        delete[] octree.mTriangles;
+        delete octree.mBVH;
+    }
+}
+
 void LLVolumeFace::createOctree(F32 scaler, const LLVector4a& center, const LLVector4a& size)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
 
-    if (getOctree())
     {
-        return;
+        std::lock_guard<std::mutex> lock(sOctreeMutex);
+        if (mOctree)
+        {
+            // already built, now the most recently used
+            unlinkOctree();
+            linkOctree();
+            return;
+        }
     }
 
     ND_OCTREE_LOG << "Creating octree with scale " << scaler << " mNumIndices " << mNumIndices << ND_OCTREE_LOG_END;
@@ -5925,14 +6177,37 @@ void LLVolumeFace::createOctree(F32 scaler, const LLVector4a& center, const LLVe
         LLVolumeOctreeValidate validate;
         validate.traverse(mOctree);
     }
+
+    LLVolumeOctreeSize octree_size;
+    octree_size.traverse(mOctree);
+
+    // make room for it among the other faces' octrees
+    std::vector<EvictedOctree> evicted;
+    {
+        std::lock_guard<std::mutex> lock(sOctreeMutex);
+        addOctreeBytes(octree_size.mBytes + num_triangles * sizeof(LLVolumeTriangle), evicted);
+    }
+    deleteEvicted(evicted);
 }
 
 void LLVolumeFace::destroyOctree()
 {
-    delete mOctree;
-    mOctree = nullptr;
-    delete[] mOctreeTriangles;
-    mOctreeTriangles = nullptr;
+    EvictedOctree dropped;
+    {
+        std::lock_guard<std::mutex> lock(sOctreeMutex);
+        if (mOctreeBytes)
+        {
+            unlinkOctree();
+            sOctreeBytes -= mOctreeBytes;
+            --sOctreeCount;
+            mOctreeBytes = 0;
+        }
+        dropped = { mOctree, mOctreeTriangles, mBVH };
+        mOctree = nullptr;
+        mOctreeTriangles = nullptr;
+        mBVH = nullptr;
+    }
+    deleteEvicted({ dropped });
 }
 
 const LLVolumeOctree* LLVolumeFace::getOctree() const
@@ -5940,6 +6215,49 @@ const LLVolumeOctree* LLVolumeFace::getOctree() const
     return mOctree;
 }
 
+void LLVolumeFace::createBVH()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    {
+        std::lock_guard<std::mutex> lock(sOctreeMutex);
+        if (mBVH)
+        {
+            unlinkOctree();
+            linkOctree();
+            return;
+        }
+    }
+
+    LLVolumeBVH* bvh = new LLVolumeBVH();
+    bvh->build(*this);
+
+    std::vector<EvictedOctree> evicted;
+    {
+        std::lock_guard<std::mutex> lock(sOctreeMutex);
+        mBVH = bvh;
+        addOctreeBytes(bvh->getBytes(), evicted);
+    }
+    deleteEvicted(evicted);
+}
+
+const LLVolumeBVH* LLVolumeFace::getBVH() const
+{
+    return mBVH;
+}
+
+// static
+void LLVolumeFace::setRaycastBVH(bool enable)
+{
+    sRaycastBVH = enable;
+}
+
+// static
+bool LLVolumeFace::getRaycastBVH()
+{
+    return sRaycastBVH;
+}
+
 
 void LLVolumeFace::swapData(LLVolumeFace& rhs)
 {
@@ -42,6 +42,7 @@ class LLVolumeFace;
 class LLVolume;
 class LLVolumeTriangle;
 class LLVolumeOctree;
+class LLVolumeBVH;
 
 #include "lluuid.h"
 #include "v4color.h"
@@ -59,6 +60,7 @@ class LLVolumeOctree;
 #include "llfile.h"
 #include "llalignedarray.h"
 #include "llrigginginfo.h"
+#include "llmeshlodreader.h" // <FS/> Streaming mesh decoder
 
 //============================================================================
 
@@ -915,11 +917,27 @@ public:
     void optimize(F32 angle_cutoff = 2.f);
     bool cacheOptimize(bool gen_tangents = false);
 
+    // Builds the octree if there is none, else marks it recently used.
+    // Octrees are kept by last use; building one past the budget frees
+    // the least recently used ones of other faces.
     void createOctree(F32 scaler = 0.25f, const LLVector4a& center = LLVector4a(0,0,0), const LLVector4a& size = LLVector4a(0.5f,0.5f,0.5f));
     void destroyOctree();
     // Get a reference to the octree, which may be null
     const LLVolumeOctree* getOctree() const;
 
+    // Same for the bounding volume hierarchy, the other way to find the
+    // triangles a ray hits. It shares the octree budget and goes with it.
+    void createBVH();
+    const LLVolumeBVH* getBVH() const;
+
+    // whether LLVolume::lineSegmentIntersect() uses the BVH or the octree
+    static void setRaycastBVH(bool enable);
+    static bool getRaycastBVH();
+
+    static void setOctreeBudget(U64 bytes);
+    static U64 getOctreeBytes();
+    static U32 getOctreeCount();
+
     // Part of silhouette generation (used by selection outlines)
     // Populates the provided edge array with numbers corresponding to
     // *partial* logic of whether a particular index should be rendered
@@ -999,8 +1017,27 @@ public:
     LLVector3 mNormalizedScale = LLVector3(1,1,1);
 
 private:
+    struct EvictedOctree
+    {
+        LLVolumeOctree* mOctree;
+        LLVolumeTriangle* mTriangles;
+        LLVolumeBVH* mBVH;
+    };
+
+    // callers hold the octree lock
+    void linkOctree();
+    void unlinkOctree();
+    void addOctreeBytes(U64 bytes, std::vector<EvictedOctree>& evicted);
+    static void evictOctrees(const LLVolumeFace* keep, std::vector<EvictedOctree>& evicted);
+    static void deleteEvicted(const std::vector<EvictedOctree>& evicted);
+
     LLVolumeOctree* mOctree;
     LLVolumeTriangle* mOctreeTriangles;
+    LLVolumeBVH* mBVH = nullptr;
+    // place among the faces with an octree or BVH, by last use
+    LLVolumeFace* mOctreePrev = nullptr;
+    LLVolumeFace* mOctreeNext = nullptr;
+    U64 mOctreeBytes = 0;
 
     bool createUnCutCubeCap(LLVolume* volume, bool partial_build = false);
     bool createCap(LLVolume* volume, bool partial_build = false);
@@ -1126,8 +1163,13 @@ protected:
 public:
     bool unpackVolumeFaces(std::istream& is, S32 size);
     bool unpackVolumeFaces(U8* in_data, S32 size);
-private:
+    // <FS> Streaming mesh decoder
+    // Generic path through a parsed LLSD tree; unpackVolumeFaces() only
+    // falls back to it for blocks LLMeshLODReader does not understand
     bool unpackVolumeFacesInternal(const LLSD& mdl);
+private:
+    bool unpackVolumeFacesInternal(const std::vector<LLMeshLODReader::Face>& faces);
+    // </FS>
 
 public:
     virtual void setMeshAssetLoaded(bool loaded);
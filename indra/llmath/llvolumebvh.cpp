@@ -0,0 +1,484 @@
+/**
+ * @file llvolumebvh.cpp
+ * @brief Flattened bounding volume hierarchy over the triangles of a volume face.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmath.h"
+#include "llvolumebvh.h"
+#include "llvolume.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr U32 PACK = 4;
+    constexpr U32 BINS = 12;
+    // Splitting costs one box test per child, about what testing a pack
+    // costs. Up to this many packs stay in a leaf when no split pays.
+    constexpr F32 TRAVERSAL_COST = 1.f;
+    constexpr U32 MAX_LEAF_PACKS = 4;
+    // past this depth nodes are split at the median, which keeps the
+    // tree shallow enough for the traversal stack
+    constexpr U32 MAX_SAH_DEPTH = 32;
+    constexpr U32 STACK_SIZE = 64;
+
+    U32 pack_count(U32 triangles)
+    {
+        return (triangles + PACK - 1) / PACK;
+    }
+
+    struct Bounds
+    {
+        F32 mMin[3] = { F32_MAX, F32_MAX, F32_MAX };
+        F32 mMax[3] = { -F32_MAX, -F32_MAX, -F32_MAX };
+
+        void grow(const F32* min, const F32* max)
+        {
+            for (S32 k = 0; k < 3; ++k)
+            {
+                mMin[k] = llmin(mMin[k], min[k]);
+                mMax[k] = llmax(mMax[k], max[k]);
+            }
+        }
+
+        void grow(const Bounds& rhs)
+        {
+            grow(rhs.mMin, rhs.mMax);
+        }
+
+        // half the surface area, which is all the heuristic needs
+        F32 area() const
+        {
+            if (mMin[0] > mMax[0])
+            {
+                return 0.f;
+            }
+            F32 dx = mMax[0] - mMin[0];
+            F32 dy = mMax[1] - mMin[1];
+            F32 dz = mMax[2] - mMin[2];
+            return dx * dy + dy * dz + dz * dx;
+        }
+    };
+}
+
+struct LLVolumeBVH::BuildTriangle
+{
+    F32 mMin[3];
+    F32 mMax[3];
+    F32 mCentroid[3];
+    S32 mIndex;
+};
+
+void LLVolumeBVH::clear()
+{
+    mPairs.clear();
+    mPacks.clear();
+}
+
+U64 LLVolumeBVH::getBytes() const
+{
+    return sizeof(LLVolumeBVH) + mPairs.size() * sizeof(NodePair) + mPacks.size() * sizeof(TrianglePack);
+}
+
+void LLVolumeBVH::build(const LLVolumeFace& face)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+    clear();
+
+    const U32 num_triangles = face.mNumIndices / 3;
+    if (!num_triangles)
+    {
+        return;
+    }
+
+    std::vector<BuildTriangle> triangles(num_triangles);
+    for (U32 i = 0; i < num_triangles; ++i)
+    {
+        const F32* v0 = face.mPositions[face.mIndices[i * 3]].getF32ptr();
+        const F32* v1 = face.mPositions[face.mIndices[i * 3 + 1]].getF32ptr();
+        const F32* v2 = face.mPositions[face.mIndices[i * 3 + 2]].getF32ptr();
+        BuildTriangle& tri = triangles[i];
+        for (S32 k = 0; k < 3; ++k)
+        {
+            tri.mMin[k] = llmin(v0[k], v1[k], v2[k]);
+            tri.mMax[k] = llmax(v0[k], v1[k], v2[k]);
+            tri.mCentroid[k] = (tri.mMin[k] + tri.mMax[k]) * 0.5f;
+        }
+        tri.mIndex = (S32)i;
+    }
+
+    mPairs.reserve(num_triangles / PACK + 1);
+    mPacks.reserve(pack_count(num_triangles) * 2);
+    mPairs.emplace_back();
+    split(face, 0, triangles, 0, num_triangles, 0);
+
+    mPairs.shrink_to_fit();
+    mPacks.shrink_to_fit();
+}
+
+void LLVolumeBVH::split(const LLVolumeFace& face, U32 node, std::vector<BuildTriangle>& triangles, U32 begin, U32 end, U32 depth)
+{
+    Bounds bounds;
+    Bounds centroids;
+    for (U32 i = begin; i < end; ++i)
+    {
+        bounds.grow(triangles[i].mMin, triangles[i].mMax);
+        centroids.grow(triangles[i].mCentroid, triangles[i].mCentroid);
+    }
+
+    // Padded a little so rounding in the box test never culls a hit the
+    // triangle test would find, flat faces included.
+    {
+        Node& n = getNode(node);
+        for (S32 k = 0; k < 3; ++k)
+        {
+            F32 pad = F_APPROXIMATELY_ZERO + llmax(fabsf(bounds.mMin[k]), fabsf(bounds.mMax[k])) * 1e-6f;
+            n.mMin[k] = bounds.mMin[k] - pad;
+            n.mMax[k] = bounds.mMax[k] + pad;
+        }
+    }
+
+    const U32 count = end - begin;
+    if (count <= PACK)
+    {
+        makeLeaf(face, node, triangles, begin, end);
+        return;
+    }
+
+    U32 mid = begin;
+    const F32 parent_area = bounds.area();
+    if (depth < MAX_SAH_DEPTH && parent_area > 0.f)
+    {
+        F32 best_cost = (F32)pack_count(count);
+        S32 best_axis = -1;
+        U32 best_bin = 0;
+        for (S32 axis = 0; axis < 3; ++axis)
+        {
+            const F32 extent = centroids.mMax[axis] - centroids.mMin[axis];
+            if (extent <= 0.f)
+            {
+                continue;
+            }
+            const F32 scale = BINS / extent;
+            const F32 origin = centroids.mMin[axis];
+            auto bin_of = [=](const BuildTriangle& tri)
+            {
+                return llmin((U32)((tri.mCentroid[axis] - origin) * scale), BINS - 1);
+            };
+
+            Bounds bin_bounds[BINS];
+            U32 bin_count[BINS] = {};
+            for (U32 i = begin; i < end; ++i)
+            {
+                U32 bin = bin_of(triangles[i]);
+                bin_bounds[bin].grow(triangles[i].mMin, triangles[i].mMax);
+                ++bin_count[bin];
+            }
+
+            // everything right of each bin boundary, then sweep from the left
+            F32 right_area[BINS];
+            U32 right_count[BINS];
+            Bounds right;
+            U32 right_total = 0;
+            for (U32 bin = BINS - 1; bin > 0; --bin)
+            {
+                right.grow(bin_bounds[bin]);
+                right_total += bin_count[bin];
+                right_area[bin] = right.area();
+                right_count[bin] = right_total;
+            }
+
+            Bounds left;
+            U32 left_total = 0;
+            for (U32 bin = 0; bin < BINS - 1; ++bin)
+            {
+                left.grow(bin_bounds[bin]);
+                left_total += bin_count[bin];
+                if (!left_total || !right_count[bin + 1])
+                {
+                    continue;
+                }
+                F32 cost = TRAVERSAL_COST
+                         + (left.area() * pack_count(left_total) + right_area[bin + 1] * pack_count(right_count[bin + 1])) / parent_area;
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = bin;
+                }
+            }
+        }
+
+        if (best_axis >= 0)
+        {
+            const F32 scale = BINS / (centroids.mMax[best_axis] - centroids.mMin[best_axis]);
+            const F32 origin = centroids.mMin[best_axis];
+            auto split_point = std::partition(triangles.begin() + begin, triangles.begin() + end, [=](const BuildTriangle& tri)
+                {
+                    return llmin((U32)((tri.mCentroid[best_axis] - origin) * scale), BINS - 1) <= best_bin;
+                });
+            mid = (U32)(split_point - triangles.begin());
+        }
+        else if (count <= MAX_LEAF_PACKS * PACK)
+        {
+            makeLeaf(face, node, triangles, begin, end);
+            return;
+        }
+    }
+
+    if (mid == begin || mid == end)
+    {
+        // no useful split found, halve along the widest spread of centroids
+        S32 axis = 0;
+        for (S32 k = 1; k < 3; ++k)
+        {
+            if (centroids.mMax[k] - centroids.mMin[k] > centroids.mMax[axis] - centroids.mMin[axis])
+            {
+                axis = k;
+            }
+        }
+        mid = begin + count / 2;
+        std::nth_element(triangles.begin() + begin, triangles.begin() + mid, triangles.begin() + end,
+            [axis](const BuildTriangle& a, const BuildTriangle& b)
+            {
+                return a.mCentroid[axis] < b.mCentroid[axis];
+            });
+    }
+
+    // children go side by side in a pair of their own
+    const U32 left = (U32)mPairs.size() * 2;
+    mPairs.emplace_back();
+    getNode(node).mFirst = left;
+    getNode(node).mCount = 0;
+    split(face, left, triangles, begin, mid, depth + 1);
+    split(face, left + 1, triangles, mid, end, depth + 1);
+}
+
+void LLVolumeBVH::makeLeaf(const LLVolumeFace& face, U32 node, const std::vector<BuildTriangle>& triangles, U32 begin, U32 end)
+{
+    Node& n = getNode(node);
+    n.mFirst = (U32)mPacks.size();
+    n.mCount = pack_count(end - begin);
+
+    for (U32 i = begin; i < end; i += PACK)
+    {
+        LL_ALIGN_16(F32 v0[3][PACK]) = {};
+        LL_ALIGN_16(F32 edge1[3][PACK]) = {};
+        LL_ALIGN_16(F32 edge2[3][PACK]) = {};
+        TrianglePack pack;
+        for (U32 lane = 0; lane < PACK; ++lane)
+        {
+            pack.mTriangle[lane] = -1;
+            if (i + lane >= end)
+            {
+                continue;
+            }
+            const S32 triangle = triangles[i + lane].mIndex;
+            const LLVector4a& p0 = face.mPositions[face.mIndices[triangle * 3]];
+            const LLVector4a& p1 = face.mPositions[face.mIndices[triangle * 3 + 1]];
+            const LLVector4a& p2 = face.mPositions[face.mIndices[triangle * 3 + 2]];
+            // the edges LLTriangleRayIntersect() would compute
+            LLVector4a e1;
+            e1.setSub(p1, p0);
+            LLVector4a e2;
+            e2.setSub(p2, p0);
+            for (S32 k = 0; k < 3; ++k)
+            {
+                v0[k][lane] = p0[k];
+                edge1[k][lane] = e1[k];
+                edge2[k][lane] = e2[k];
+            }
+            pack.mTriangle[lane] = triangle;
+        }
+        for (S32 k = 0; k < 3; ++k)
+        {
+            pack.mV0[k] = _mm_load_ps(v0[k]);
+            pack.mEdge1[k] = _mm_load_ps(edge1[k]);
+            pack.mEdge2[k] = _mm_load_ps(edge2[k]);
+        }
+        mPacks.push_back(pack);
+    }
+}
+
+S32 LLVolumeBVH::intersect(const LLVector4a& start, const LLVector4a& dir, F32& closest_t, F32& a, F32& b) const
+{
+    if (mPairs.empty())
+    {
+        return -1;
+    }
+
+    const F32* origin = start.getF32ptr();
+    const F32* direction = dir.getF32ptr();
+    F32 inv_dir[3];
+    for (S32 k = 0; k < 3; ++k)
+    {
+        // a huge slope instead of infinity keeps 0 * inf out of the slab test
+        inv_dir[k] = fabsf(direction[k]) > 1e-30f ? 1.f / direction[k] : 1e30f;
+    }
+
+    // entry t of the segment into a node's box, F32_MAX if it misses or
+    // enters past limit
+    auto enter = [&](const Node& node, F32 limit)
+    {
+        F32 t_near = 0.f;
+        F32 t_far = limit;
+        for (S32 k = 0; k < 3; ++k)
+        {
+            F32 t0 = (node.mMin[k] - origin[k]) * inv_dir[k];
+            F32 t1 = (node.mMax[k] - origin[k]) * inv_dir[k];
+            t_near = llmax(t_near, llmin(t0, t1));
+            t_far = llmin(t_far, llmax(t0, t1));
+        }
+        return t_near <= t_far ? t_near : F32_MAX;
+    };
+
+    const __m128 ox = _mm_set1_ps(origin[0]);
+    const __m128 oy = _mm_set1_ps(origin[1]);
+    const __m128 oz = _mm_set1_ps(origin[2]);
+    const __m128 dx = _mm_set1_ps(direction[0]);
+    const __m128 dy = _mm_set1_ps(direction[1]);
+    const __m128 dz = _mm_set1_ps(direction[2]);
+    const __m128 epsilon = LLVector4a::getEpsilon();
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+
+    S32 hit = -1;
+    struct Entry
+    {
+        U32 mNode;
+        F32 mNear;
+    };
+    Entry stack[STACK_SIZE];
+    U32 depth = 0;
+
+    if (enter(getNode(0), llmin(closest_t, 1.f)) == F32_MAX)
+    {
+        return -1;
+    }
+
+    U32 index = 0;
+    while (true)
+    {
+        const Node& node = getNode(index);
+        if (node.mCount)
+        {
+            // LLTriangleRayIntersect() for four triangles at once, every
+            // product and sum in the same order
+            for (U32 p = node.mFirst; p < node.mFirst + node.mCount; ++p)
+            {
+                const TrianglePack& pack = mPacks[p];
+                const __m128* e1 = pack.mEdge1;
+                const __m128* e2 = pack.mEdge2;
+
+                __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2[2]), _mm_mul_ps(dz, e2[1]));
+                __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2[0]), _mm_mul_ps(dx, e2[2]));
+                __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2[1]), _mm_mul_ps(dy, e2[0]));
+                __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1[0], px), _mm_mul_ps(e1[1], py)), _mm_mul_ps(e1[2], pz));
+
+                __m128 tx = _mm_sub_ps(ox, pack.mV0[0]);
+                __m128 ty = _mm_sub_ps(oy, pack.mV0[1]);
+                __m128 tz = _mm_sub_ps(oz, pack.mV0[2]);
+                __m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz));
+
+                __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1[2]), _mm_mul_ps(tz, e1[1]));
+                __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1[0]), _mm_mul_ps(tx, e1[2]));
+                __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1[1]), _mm_mul_ps(ty, e1[0]));
+                __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz));
+
+                __m128 mask = _mm_and_ps(_mm_cmpge_ps(det, epsilon), _mm_cmpge_ps(u, zero));
+                mask = _mm_and_ps(mask, _mm_cmple_ps(u, det));
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+                mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), det));
+                if (!_mm_movemask_ps(mask))
+                {
+                    continue;
+                }
+
+                __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2[0], qx), _mm_mul_ps(e2[1], qy)), _mm_mul_ps(e2[2], qz));
+                t = _mm_div_ps(t, det);
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+                mask = _mm_and_ps(mask, _mm_cmple_ps(t, one));
+                mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(closest_t)));
+                S32 lanes = _mm_movemask_ps(mask);
+                if (!lanes)
+                {
+                    continue;
+                }
+
+                LL_ALIGN_16(F32 lane_t[4]);
+                LL_ALIGN_16(F32 lane_a[4]);
+                LL_ALIGN_16(F32 lane_b[4]);
+                _mm_store_ps(lane_t, t);
+                _mm_store_ps(lane_a, _mm_div_ps(u, det));
+                _mm_store_ps(lane_b, _mm_div_ps(v, det));
+                for (S32 lane = 0; lane < 4; ++lane)
+                {
+                    if ((lanes & (1 << lane)) && lane_t[lane] < closest_t)
+                    {
+                        closest_t = lane_t[lane];
+                        a = lane_a[lane];
+                        b = lane_b[lane];
+                        hit = pack.mTriangle[lane];
+                    }
+                }
+            }
+        }
+        else
+        {
+            // nearer child first, the other one for later
+            const F32 limit = llmin(closest_t, 1.f);
+            const U32 left = node.mFirst;
+            const F32 t_left = enter(getNode(left), limit);
+            const F32 t_right = enter(getNode(left + 1), limit);
+            if (t_left != F32_MAX || t_right != F32_MAX)
+            {
+                const bool left_first = t_left <= t_right;
+                const F32 t_later = left_first ? t_right : t_left;
+                if (t_later != F32_MAX)
+                {
+                    llassert(depth < STACK_SIZE);
+                    stack[depth++] = { left_first ? left + 1 : left, t_later };
+                }
+                index = left_first ? left : left + 1;
+                continue;
+            }
+        }
+
+        // next one still in front of the closest hit
+        while (depth && stack[depth - 1].mNear > closest_t)
+        {
+            --depth;
+        }
+        if (!depth)
+        {
+            break;
+        }
+        index = stack[--depth].mNode;
+    }
+
+    return hit;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file llvolumebvh.h
+ * @brief Flattened bounding volume hierarchy over the triangles of a volume face.
+ *
+ * @Description:
+ * An alternative to LLVolumeOctree for raycasts against a face. The
+ * triangles are split with a binned surface area heuristic into a tree of
+ * boxes stored depth first in one array, siblings side by side so both of
+ * a node's children share a cache line. Leaves hold the triangles in
+ * packs of four, vertex and edges laid out per component, and a ray is
+ * tested against a whole pack at once with the same arithmetic as
+ * LLTriangleRayIntersect, so hits and their t, a and b come out the same.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMEBVH_H
+#define LL_LLVOLUMEBVH_H
+
+#include "llvector4a.h"
+
+#include <vector>
+
+class LLVolumeFace;
+
+class LLVolumeBVH
+{
+public:
+    // Builds over the face's current positions and indices, which must
+    // not change while the hierarchy is in use.
+    void build(const LLVolumeFace& face);
+    void clear();
+
+    bool empty() const { return mPairs.empty(); }
+    U32 getNodeCount() const { return (U32)mPairs.size() * 2 - 1; }
+    U64 getBytes() const;
+
+    // Closest triangle hit by the segment start + dir * t with t in
+    // [0, 1] and t < closest_t. Returns its index in the face's triangle
+    // list, or -1, and on a hit sets closest_t and the barycentric a and
+    // b of LLTriangleRayIntersect().
+    S32 intersect(const LLVector4a& start, const LLVector4a& dir, F32& closest_t, F32& a, F32& b) const;
+
+private:
+    // 32 bytes. Inner nodes have no triangles and their children at
+    // mFirst and mFirst + 1; leaves have mCount packs from mFirst.
+    struct Node
+    {
+        F32 mMin[3];
+        U32 mFirst;
+        F32 mMax[3];
+        U32 mCount;
+    };
+
+    // one cache line; the root is alone in the first one
+    struct alignas(64) NodePair
+    {
+        Node mNode[2];
+    };
+
+    // four triangles, one per lane; unused lanes are degenerate and
+    // never hit
+    struct TrianglePack
+    {
+        LLQuad mV0[3];
+        LLQuad mEdge1[3];
+        LLQuad mEdge2[3];
+        S32 mTriangle[4];
+    };
+
+    struct BuildTriangle;
+
+    Node& getNode(U32 index) { return mPairs[index >> 1].mNode[index & 1]; }
+    const Node& getNode(U32 index) const { return mPairs[index >> 1].mNode[index & 1]; }
+
+    void split(const LLVolumeFace& face, U32 node, std::vector<BuildTriangle>& triangles, U32 begin, U32 end, U32 depth);
+    void makeLeaf(const LLVolumeFace& face, U32 node, const std::vector<BuildTriangle>& triangles, U32 begin, U32 end);
+
+    std::vector<NodePair> mPairs;
+    std::vector<TrianglePack> mPacks;
+};
+
+#endif // LL_LLVOLUMEBVH_H
@@ -0,0 +1,262 @@
+/**
+ * @file llmeshlodreader_test.cpp
+ * @brief Mesh LOD decoding tests and benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmeshlodreader.h"
+#include "../llvolume.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+
+#include "../test/lltut.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Count heap allocations made through operator new, which is where LLSD
+// nodes, strings and binary copies come from.
+#if !((TRACY_ENABLE) && LL_PROFILER_ENABLE_TRACY_MEMORY)
+static std::atomic<U64> sAllocations{ 0 };
+
+void* operator new(size_t size)
+{
+    ++sAllocations;
+    void* ptr = (malloc)(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    (free)(ptr);
+}
+
+static U64 allocation_count()
+{
+    return sAllocations.load();
+}
+#else
+static U64 allocation_count()
+{
+    return 0;
+}
+#endif
+
+namespace
+{
+    // A LOD laid out the way LLModel::writeModel() writes one
+    LLSD makeSubmesh(U32 num_verts, bool rigged, U32 seed)
+    {
+        LLSD::Binary position(num_verts * 6);
+        LLSD::Binary normal(num_verts * 6);
+        LLSD::Binary tc(num_verts * 4);
+        for (size_t i = 0; i < position.size(); ++i)
+        {
+            position[i] = (U8)(seed + i * 31);
+            normal[i] = (U8)(seed + i * 17);
+        }
+        for (size_t i = 0; i < tc.size(); ++i)
+        {
+            tc[i] = (U8)(seed + i * 7);
+        }
+
+        // a strip of triangles over the vertices
+        LLSD::Binary triangles;
+        for (U32 v = 0; v + 2 < num_verts; ++v)
+        {
+            U16 idx[3] = { (U16)v, (U16)(v + 1), (U16)(v + 2) };
+            triangles.insert(triangles.end(), (U8*)idx, (U8*)idx + sizeof(idx));
+        }
+
+        LLSD submesh;
+        submesh["Position"] = position;
+        submesh["Normal"] = normal;
+        submesh["TexCoord0"] = tc;
+        submesh["TriangleList"] = triangles;
+        submesh["PositionDomain"]["Min"] = llsd::array(-0.5, -0.5, -0.5);
+        submesh["PositionDomain"]["Max"] = llsd::array(0.5, 0.5, 0.5);
+        submesh["TexCoord0Domain"]["Min"] = llsd::array(0.0, 0.0);
+        submesh["TexCoord0Domain"]["Max"] = llsd::array(1.0, 1.0);
+
+        if (rigged)
+        {
+            // two influences per vertex
+            LLSD::Binary weights;
+            for (U32 v = 0; v < num_verts; ++v)
+            {
+                U8 influence[] = { (U8)(v % 20), 0x00, 0x80, (U8)(v % 20 + 1), 0xff, 0x7f, 0xff };
+                weights.insert(weights.end(), influence, influence + sizeof(influence));
+            }
+            submesh["Weights"] = weights;
+        }
+        return submesh;
+    }
+
+    std::string makeLOD(U32 faces, U32 verts_per_face, bool rigged)
+    {
+        LLSD lod = LLSD::emptyArray();
+        for (U32 i = 0; i < faces; ++i)
+        {
+            lod.append(makeSubmesh(verts_per_face, rigged, i));
+        }
+        return zip_llsd(lod);
+    }
+
+    LLPointer<LLVolume> makeVolume()
+    {
+        LLVolumeParams params;
+        params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+        params.setSculptID(LLUUID::generateNewID(), LL_SCULPT_TYPE_MESH);
+        return new LLVolume(params, 0.f);
+    }
+
+    // What unpackVolumeFaces() did before: a full LLSD tree per LOD
+    bool unpackThroughLLSD(LLVolume* volume, const std::string& lod)
+    {
+        LLSD mdl;
+        if (LLUZipHelper::unzip_llsd(mdl, (const U8*)lod.data(), (S32)lod.size()) != LLUZipHelper::ZR_OK)
+        {
+            return false;
+        }
+        return volume->unpackVolumeFacesInternal(mdl);
+    }
+
+    bool sameFaces(const LLVolume* a, const LLVolume* b)
+    {
+        if (a->getNumVolumeFaces() != b->getNumVolumeFaces())
+        {
+            return false;
+        }
+        for (S32 i = 0; i < a->getNumVolumeFaces(); ++i)
+        {
+            const LLVolumeFace& fa = a->getVolumeFace(i);
+            const LLVolumeFace& fb = b->getVolumeFace(i);
+            if (fa.mNumVertices != fb.mNumVertices || fa.mNumIndices != fb.mNumIndices ||
+                memcmp(fa.mIndices, fb.mIndices, fa.mNumIndices * sizeof(U16)) ||
+                memcmp(fa.mPositions, fb.mPositions, fa.mNumVertices * sizeof(LLVector4a)) ||
+                memcmp(fa.mNormals, fb.mNormals, fa.mNumVertices * sizeof(LLVector4a)) ||
+                memcmp(fa.mTexCoords, fb.mTexCoords, fa.mNumVertices * sizeof(LLVector2)) ||
+                (fa.mWeights == nullptr) != (fb.mWeights == nullptr) ||
+                (fa.mWeights && memcmp(fa.mWeights, fb.mWeights, fa.mNumVertices * sizeof(LLVector4a))))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace tut
+{
+    struct LLMeshLODReaderFixture
+    {
+    };
+    typedef test_group<LLMeshLODReaderFixture> LLMeshLODReader_t;
+    typedef LLMeshLODReader_t::object LLMeshLODReader_object_t;
+    tut::LLMeshLODReader_t tut_LLMeshLODReader("LLMeshLODReader");
+
+    template<> template<>
+    void LLMeshLODReader_object_t::test<1>()
+    {
+        set_test_name("direct decode matches the LLSD path");
+
+        for (bool rigged : { false, true })
+        {
+            std::string lod = makeLOD(4, 300, rigged);
+
+            LLPointer<LLVolume> direct = makeVolume();
+            LLPointer<LLVolume> generic = makeVolume();
+            ensure("direct decode", direct->unpackVolumeFaces((U8*)lod.data(), (S32)lod.size()));
+            ensure("llsd decode", unpackThroughLLSD(generic, lod));
+            ensure("same faces", sameFaces(direct, generic));
+        }
+
+        // garbage is rejected, not crashed on
+        std::string garbage(64, 'x');
+        LLPointer<LLVolume> volume = makeVolume();
+        ensure("garbage rejected", !volume->unpackVolumeFaces((U8*)garbage.data(), (S32)garbage.size()));
+    }
+
+    template<> template<>
+    void LLMeshLODReader_object_t::test<2>()
+    {
+        set_test_name("mesh LOD decode throughput and allocations");
+
+        skip_unless_benchmarks();
+
+        // Roughly a high LOD of a furniture item and of a rigged body part
+        const S32 ITERATIONS = 50;
+        const std::string lods[] = { makeLOD(8, 2000, false), makeLOD(4, 8000, true) };
+        const char* names[] = { "static", "rigged" };
+
+        for (S32 l = 0; l < 2; ++l)
+        {
+            const std::string& lod = lods[l];
+
+            LLSD inflated;
+            LLUZipHelper::unzip_llsd(inflated, (const U8*)lod.data(), (S32)lod.size());
+            std::ostringstream raw;
+            LLSDSerialize::toBinary(inflated, raw);
+            const F64 inflated_mb = raw.str().size() / (1024.0 * 1024.0);
+
+            auto run = [&](auto&& unpack, F64& mb_per_sec, U64& allocations)
+            {
+                std::vector<LLPointer<LLVolume> > volumes;
+                for (S32 i = 0; i < ITERATIONS; ++i)
+                {
+                    volumes.push_back(makeVolume());
+                }
+                const U64 before = allocation_count();
+                auto start = std::chrono::steady_clock::now();
+                for (S32 i = 0; i < ITERATIONS; ++i)
+                {
+                    unpack(volumes[i].get());
+                }
+                std::chrono::duration<F64> elapsed = std::chrono::steady_clock::now() - start;
+                allocations = (allocation_count() - before) / ITERATIONS;
+                mb_per_sec = inflated_mb * ITERATIONS / llmax(elapsed.count(), 1e-9);
+            };
+
+            F64 llsd_rate, direct_rate;
+            U64 llsd_allocs, direct_allocs;
+            run([&](LLVolume* volume) { unpackThroughLLSD(volume, lod); }, llsd_rate, llsd_allocs);
+            run([&](LLVolume* volume) { volume->unpackVolumeFaces((U8*)lod.data(), (S32)lod.size()); }, direct_rate, direct_allocs);
+
+            std::cout << "\nMesh LOD decode (" << names[l] << ", " << inflated_mb << " MB inflated):"
+                      << " LLSD tree " << llsd_rate << " MB/s, " << llsd_allocs << " allocations/LOD;"
+                      << " direct " << direct_rate << " MB/s, " << direct_allocs << " allocations/LOD" << std::endl;
+
+            ensure("benchmark ran", llsd_rate > 0 && direct_rate > 0);
+        }
+    }
+}
@@ -0,0 +1,313 @@
+/**
+ * @file llskinningbatch_test.cpp
+ * @brief Batched skinning tests and benchmark on the system avatar meshes.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmath.h"
+#include "../llskinningbatch.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr U32 MAX_JOINTS = 110;
+
+    // What LLRiggedVolume::update() did per vertex: the palette blend of
+    // FSSkinningUtil::getPerVertexSkinMatrixSSE() and two transforms.
+    void skin_vertex(const LLVector4a& position, const LLVector4a& weights, const LLMatrix4a* palette,
+                     const LLMatrix4a& bind_shape, U32 max_joints, LLVector4a& out)
+    {
+        LLMatrix4a final_mat;
+        final_mat.clear();
+
+        LL_ALIGN_16(S32 idx[4]);
+        LL_ALIGN_16(F32 wght[4]);
+
+        __m128i max_idx = _mm_set_epi16(max_joints - 1, max_joints - 1, max_joints - 1, max_joints - 1,
+                                        max_joints - 1, max_joints - 1, max_joints - 1, max_joints - 1);
+        __m128i mIdx = _mm_cvttps_epi32((__m128)weights);
+        __m128 mWeight = _mm_sub_ps((__m128)weights, _mm_cvtepi32_ps(mIdx));
+
+        mIdx = _mm_min_epi16(mIdx, max_idx);
+        _mm_store_si128((__m128i*)idx, mIdx);
+
+        __m128 mScale = _mm_add_ps(mWeight, _mm_movehl_ps(mWeight, mWeight));
+        mScale = _mm_add_ss(mScale, _mm_shuffle_ps(mScale, mScale, 1));
+        mScale = _mm_shuffle_ps(mScale, mScale, 0);
+
+        mWeight = _mm_div_ps(mWeight, mScale);
+        _mm_store_ps(wght, mWeight);
+
+        for (U32 k = 0; k < 4; k++)
+        {
+            LLMatrix4a src;
+            src.setMul(palette[idx[k]], wght[k]);
+            final_mat.add(src);
+        }
+
+        LLVector4a t;
+        bind_shape.affineTransform(position, t);
+        final_mat.affineTransform(t, out);
+    }
+
+    struct Random
+    {
+        U32 mSeed;
+        U32 next() { mSeed = mSeed * 1664525 + 1013904223; return mSeed >> 8; }
+        F32 unit() { return (F32)(next() & 0xffff) / 65535.f; }
+    };
+
+    // rows of an affine transform, like the joint matrices in a palette
+    void make_matrix(LLMatrix4a& mat, Random& random)
+    {
+        F32 m[16];
+        for (S32 i = 0; i < 16; ++i)
+        {
+            m[i] = (i % 4 == 3) ? (i == 15 ? 1.f : 0.f) : random.unit() * 2.f - 1.f;
+        }
+        mat.loadu(m);
+    }
+
+    void make_palette(LLMatrix4a* palette, Random& random)
+    {
+        for (U32 i = 0; i < MAX_JOINTS; ++i)
+        {
+            make_matrix(palette[i], random);
+        }
+    }
+
+    struct Mesh
+    {
+        std::vector<LLVector4a> mPositions;
+        std::vector<LLVector4a> mWeights;
+    };
+
+    // Positions and weights of a Linden Binary Mesh, see
+    // LLPolyMeshSharedData::loadMesh(). Each vertex there blends joint
+    // floor(w) and the next one, here that becomes two mWeights influences.
+    bool load_llm(const std::string& filename, Mesh& mesh)
+    {
+        FILE* fp = fopen(filename.c_str(), "rb");
+        if (!fp)
+        {
+            return false;
+        }
+        char header[24];
+        U8 flags[2];
+        F32 transform[9];
+        U8 rotation_order;
+        U16 num_vertices = 0;
+        bool ok = fread(header, 1, 24, fp) == 24
+            && !strncmp(header, "Linden Binary Mesh 1.0", 22)
+            && fread(flags, 1, 2, fp) == 2
+            && fread(transform, sizeof(F32), 6, fp) == 6
+            && fread(&rotation_order, 1, 1, fp) == 1
+            && fread(transform + 6, sizeof(F32), 3, fp) == 3
+            && fread(&num_vertices, sizeof(U16), 1, fp) == 1
+            && flags[0];
+        if (ok)
+        {
+            std::vector<F32> coords(num_vertices * 3);
+            std::vector<F32> weights(num_vertices);
+            // normals, binormals, texture and detail texture coordinates
+            long skip = num_vertices * sizeof(F32) * (3 + 3 + 2 + (flags[1] ? 2 : 0));
+            ok = fread(coords.data(), sizeof(F32), coords.size(), fp) == coords.size()
+                && !fseek(fp, skip, SEEK_CUR)
+                && fread(weights.data(), sizeof(F32), weights.size(), fp) == weights.size();
+            for (U32 i = 0; ok && i < num_vertices; ++i)
+            {
+                mesh.mPositions.emplace_back(coords[i * 3], coords[i * 3 + 1], coords[i * 3 + 2]);
+                F32 joint = floorf(weights[i]);
+                F32 blend = weights[i] - joint;
+                if (blend < 0.0001f)
+                {
+                    mesh.mWeights.emplace_back(joint + 0.9999f, 0.f, 0.f, 0.f);
+                }
+                else
+                {
+                    mesh.mWeights.emplace_back(joint + llclamp(1.f - blend, 0.0001f, 0.9999f), joint + 1.f + blend, 0.f, 0.f);
+                }
+            }
+        }
+        fclose(fp);
+        return ok && num_vertices > 0;
+    }
+
+    bool same_vertices(const std::vector<LLVector4a>& a, const std::vector<LLVector4a>& b)
+    {
+        return a.size() == b.size() && !memcmp(a.data(), b.data(), a.size() * sizeof(LLVector4a));
+    }
+}
+
+namespace tut
+{
+    struct skinningbatch_data
+    {
+    };
+    typedef test_group<skinningbatch_data> skinningbatch_test;
+    typedef skinningbatch_test::object skinningbatch_object;
+    tut::skinningbatch_test skinningbatch_testcase("LLSkinningBatch");
+
+    template<> template<>
+    void skinningbatch_object::test<1>()
+    {
+        set_test_name("same positions and bounds as skinning one vertex at a time");
+        Random random{ 3 };
+        LLMatrix4a palette[MAX_JOINTS];
+        make_palette(palette, random);
+        LLMatrix4a bind_shape;
+        make_matrix(bind_shape, random);
+
+        // a handful of influence sets of odd sizes, so most runs end in a
+        // partial group of four, plus some one off vertices
+        constexpr U32 VERTICES = 1003;
+        std::vector<LLVector4a> sets;
+        for (U32 i = 0; i < 9; ++i)
+        {
+            sets.emplace_back((F32)(random.next() % MAX_JOINTS) + 0.25f + random.unit() * 0.5f,
+                              (F32)(random.next() % (MAX_JOINTS + 20)) + 0.5f, 0.f, 0.f);
+        }
+        std::vector<LLVector4a> positions(VERTICES);
+        std::vector<LLVector4a> weights(VERTICES);
+        for (U32 i = 0; i < VERTICES; ++i)
+        {
+            positions[i].set(random.unit() - 0.5f, random.unit() - 0.5f, random.unit() * 2.f);
+            if (random.next() % 10)
+            {
+                weights[i] = sets[random.next() % sets.size()];
+            }
+            else
+            {
+                weights[i].set((F32)(random.next() % MAX_JOINTS) + 0.1f + random.unit() * 0.8f,
+                               (F32)(random.next() % MAX_JOINTS) + 0.1f + random.unit() * 0.8f,
+                               (F32)(random.next() % MAX_JOINTS) + 0.1f + random.unit() * 0.8f,
+                               (F32)(random.next() % MAX_JOINTS) + 0.1f + random.unit() * 0.8f);
+            }
+        }
+
+        std::vector<LLVector4a> expected(VERTICES);
+        LLVector4a expected_min, expected_max;
+        for (U32 i = 0; i < VERTICES; ++i)
+        {
+            skin_vertex(positions[i], weights[i], palette, bind_shape, MAX_JOINTS, expected[i]);
+            if (i == 0)
+            {
+                expected_min = expected_max = expected[0];
+            }
+            expected_min.setMin(expected_min, expected[i]);
+            expected_max.setMax(expected_max, expected[i]);
+        }
+
+        LLSkinningBatch batch;
+        ensure("not built", !batch.isBuiltFor(positions.data(), weights.data(), VERTICES, bind_shape, MAX_JOINTS));
+        batch.build(positions.data(), weights.data(), VERTICES, bind_shape, MAX_JOINTS);
+        ensure("built", batch.isBuiltFor(positions.data(), weights.data(), VERTICES, bind_shape, MAX_JOINTS));
+        ensure("fewer influences than vertices", batch.getInfluenceCount() < VERTICES / 2);
+
+        std::vector<LLVector4a> skinned(VERTICES);
+        LLVector4a min, max;
+        batch.skin(palette, skinned.data(), min, max);
+        ensure("positions", same_vertices(expected, skinned));
+        ensure("min", min.equals4(expected_min));
+        ensure("max", max.equals4(expected_max));
+
+        weights[VERTICES - 1] = sets[0];
+        ensure("weights changed in place", !batch.isBuiltFor(positions.data(), weights.data(), VERTICES, bind_shape, MAX_JOINTS));
+        LLMatrix4a other = bind_shape;
+        other.mMatrix[3].getF32ptr()[VX] += 0.5f;
+        ensure("other bind shape", !batch.isBuiltFor(positions.data(), weights.data(), VERTICES, other, MAX_JOINTS));
+        batch.clear();
+        ensure("cleared", !batch.getVertexCount());
+    }
+
+    template<> template<>
+    void skinningbatch_object::test<2>()
+    {
+        set_test_name("system avatar meshes, per vertex vs batched");
+
+        skip_unless_benchmarks();
+        // the viewer's character files, relative to this source file
+        std::string dir(__FILE__);
+        dir = dir.substr(0, dir.find_last_of("/\\") + 1) + "../../newview/character/";
+
+        Random random{ 5 };
+        LLMatrix4a palette[MAX_JOINTS];
+        make_palette(palette, random);
+        LLMatrix4a bind_shape;
+        make_matrix(bind_shape, random);
+        constexpr S32 FRAMES = 200;
+
+        for (const char* name : { "avatar_upper_body.llm", "avatar_lower_body.llm", "avatar_head.llm", "avatar_skirt.llm" })
+        {
+            Mesh mesh;
+            if (!load_llm(dir + name, mesh))
+            {
+                std::cout << "\n  " << name << " not found, skipped";
+                continue;
+            }
+            U32 count = (U32)mesh.mPositions.size();
+
+            std::vector<LLVector4a> per_vertex(count);
+            auto begin = std::chrono::steady_clock::now();
+            for (S32 frame = 0; frame < FRAMES; ++frame)
+            {
+                for (U32 i = 0; i < count; ++i)
+                {
+                    skin_vertex(mesh.mPositions[i], mesh.mWeights[i], palette, bind_shape, MAX_JOINTS, per_vertex[i]);
+                }
+            }
+            F64 per_vertex_ms = std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - begin).count() / FRAMES;
+
+            LLSkinningBatch batch;
+            begin = std::chrono::steady_clock::now();
+            batch.build(mesh.mPositions.data(), mesh.mWeights.data(), count, bind_shape, MAX_JOINTS);
+            F64 build_ms = std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+            std::vector<LLVector4a> batched(count);
+            LLVector4a min, max;
+            begin = std::chrono::steady_clock::now();
+            for (S32 frame = 0; frame < FRAMES; ++frame)
+            {
+                batch.skin(palette, batched.data(), min, max);
+            }
+            F64 batched_ms = std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - begin).count() / FRAMES;
+
+            std::cout << "\n  " << name << ": " << count << " vertices, " << batch.getInfluenceCount() << " influences"
+                      << "\n    per vertex: " << per_vertex_ms << " ms"
+                      << "\n    batched:    " << batched_ms << " ms (build once " << build_ms << " ms)";
+            ensure(std::string("same skinned mesh for ") + name, same_vertices(per_vertex, batched));
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,342 @@
+/**
+ * @file llvolumebvh_test.cpp
+ * @brief Face BVH raycasts against the octree, and a benchmark of both.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmath.h"
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+#include "../llvolumeoctree.h"
+
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    struct Random
+    {
+        U32 mSeed;
+        U32 next() { mSeed = mSeed * 1664525 + 1013904223; return mSeed >> 8; }
+        F32 unit() { return (F32)(next() & 0xffff) / 65535.f; }
+    };
+
+    // a flat grid of size x size quads, two triangles each
+    void make_grid(LLVolumeFace& face, S32 size)
+    {
+        face.resizeVertices((size + 1) * (size + 1));
+        for (S32 y = 0; y <= size; ++y)
+        {
+            for (S32 x = 0; x <= size; ++x)
+            {
+                face.mPositions[y * (size + 1) + x].set((F32)x / size - 0.5f, (F32)y / size - 0.5f, 0.f);
+            }
+        }
+        face.resizeIndices(size * size * 6);
+        U16* index = face.mIndices;
+        for (S32 y = 0; y < size; ++y)
+        {
+            for (S32 x = 0; x < size; ++x)
+            {
+                U16 corner = (U16)(y * (size + 1) + x);
+                *index++ = corner;
+                *index++ = corner + 1;
+                *index++ = corner + size + 1;
+                *index++ = corner + 1;
+                *index++ = corner + size + 2;
+                *index++ = corner + size + 1;
+            }
+        }
+        face.mExtents[0].set(-0.5f, -0.5f, 0.f);
+        face.mExtents[1].set(0.5f, 0.5f, 0.f);
+    }
+
+    // A lumpy sphere of about the detail of a high LOD mesh face, wound
+    // to face outwards
+    void make_blob(LLVolumeFace& face, S32 rings, S32 segments, Random& random)
+    {
+        face.resizeVertices((rings + 1) * (segments + 1));
+        face.mExtents[0].splat(F32_MAX);
+        face.mExtents[1].splat(-F32_MAX);
+        for (S32 r = 0; r <= rings; ++r)
+        {
+            F32 theta = F_PI * r / rings;
+            for (S32 s = 0; s <= segments; ++s)
+            {
+                F32 phi = F_TWO_PI * s / segments;
+                F32 radius = 0.4f + 0.02f * sinf(phi * 7.f) * sinf(theta * 5.f) + 0.01f * random.unit();
+                LLVector4a& p = face.mPositions[r * (segments + 1) + s];
+                p.set(radius * sinf(theta) * cosf(phi), radius * sinf(theta) * sinf(phi), radius * cosf(theta));
+                face.mExtents[0].setMin(face.mExtents[0], p);
+                face.mExtents[1].setMax(face.mExtents[1], p);
+            }
+        }
+        face.resizeIndices(rings * segments * 6);
+        U16* index = face.mIndices;
+        for (S32 r = 0; r < rings; ++r)
+        {
+            for (S32 s = 0; s < segments; ++s)
+            {
+                U16 corner = (U16)(r * (segments + 1) + s);
+                *index++ = corner;
+                *index++ = corner + segments + 1;
+                *index++ = corner + 1;
+                *index++ = corner + 1;
+                *index++ = corner + segments + 1;
+                *index++ = corner + segments + 2;
+            }
+        }
+    }
+
+    // segments from a shell around the face through a point near its
+    // middle, like picking rays from all around an object
+    void make_rays(std::vector<LLVector4a>& starts, std::vector<LLVector4a>& ends, S32 count, Random& random)
+    {
+        for (S32 i = 0; i < count; ++i)
+        {
+            LLVector4a from(random.unit() - 0.5f, random.unit() - 0.5f, random.unit() - 0.5f);
+            from.normalize3fast();
+            from.mul(2.f);
+            LLVector4a to(random.unit() * 0.8f - 0.4f, random.unit() * 0.8f - 0.4f, random.unit() * 0.8f - 0.4f);
+            starts.push_back(from);
+            ends.push_back(to);
+        }
+    }
+
+    // every triangle, the answer both structures have to give
+    bool brute_raycast(const LLVolumeFace& face, const LLVector4a& start, const LLVector4a& end, F32& t)
+    {
+        LLVector4a dir;
+        dir.setSub(end, start);
+        t = 2.f;
+        bool hit = false;
+        for (S32 i = 0; i < face.mNumIndices; i += 3)
+        {
+            F32 a, b, tri_t;
+            if (LLTriangleRayIntersect(face.mPositions[face.mIndices[i]], face.mPositions[face.mIndices[i + 1]],
+                                       face.mPositions[face.mIndices[i + 2]], start, dir, a, b, tri_t)
+                && tri_t >= 0.f && tri_t <= 1.f && tri_t < t)
+            {
+                t = tri_t;
+                hit = true;
+            }
+        }
+        return hit;
+    }
+
+    bool octree_raycast(LLVolumeFace& face, const LLVector4a& start, const LLVector4a& end, F32& t)
+    {
+        LLVector4a dir;
+        dir.setSub(end, start);
+        t = 2.f;
+        LLOctreeTriangleRayIntersect intersect(start, dir, &face, &t, nullptr, nullptr, nullptr, nullptr);
+        intersect.traverse(face.getOctree());
+        return intersect.mHitFace;
+    }
+
+    S32 bvh_raycast(const LLVolumeFace& face, const LLVector4a& start, const LLVector4a& end, F32& t)
+    {
+        LLVector4a dir;
+        dir.setSub(end, start);
+        t = 2.f;
+        F32 a, b;
+        return face.getBVH()->intersect(start, dir, t, a, b);
+    }
+}
+
+namespace tut
+{
+    struct volumebvh_data
+    {
+    };
+    typedef test_group<volumebvh_data> volumebvh_test;
+    typedef volumebvh_test::object volumebvh_object;
+    tut::volumebvh_test volumebvh_testcase("LLVolumeBVH");
+
+    template<> template<>
+    void volumebvh_object::test<1>()
+    {
+        set_test_name("same hits as testing every triangle");
+        Random random{ 3 };
+        LLVolumeFace face;
+        make_blob(face, 64, 96, random);
+        face.createBVH();
+        ensure("built", face.getBVH() && !face.getBVH()->empty());
+
+        std::vector<LLVector4a> starts;
+        std::vector<LLVector4a> ends;
+        make_rays(starts, ends, 4000, random);
+        S32 hits = 0;
+        for (size_t i = 0; i < starts.size(); ++i)
+        {
+            F32 brute_t;
+            F32 bvh_t;
+            bool brute_hit = brute_raycast(face, starts[i], ends[i], brute_t);
+            S32 triangle = bvh_raycast(face, starts[i], ends[i], bvh_t);
+            ensure_equals("hit or miss", triangle >= 0, brute_hit);
+            ensure_equals("distance", bvh_t, brute_t);
+            if (triangle >= 0)
+            {
+                ++hits;
+                // the triangle itself agrees on the distance
+                F32 a, b, t;
+                LLVector4a dir;
+                dir.setSub(ends[i], starts[i]);
+                ensure("triangle hit", LLTriangleRayIntersect(face.mPositions[face.mIndices[triangle * 3]],
+                                                              face.mPositions[face.mIndices[triangle * 3 + 1]],
+                                                              face.mPositions[face.mIndices[triangle * 3 + 2]],
+                                                              starts[i], dir, a, b, t));
+                ensure_equals("triangle distance", t, bvh_t);
+            }
+        }
+        ensure("most rays hit", hits > 2000);
+    }
+
+    template<> template<>
+    void volumebvh_object::test<2>()
+    {
+        set_test_name("flat faces and rays along edges");
+        LLVolumeFace face;
+        make_grid(face, 32);
+        face.createBVH();
+        for (S32 y = 0; y <= 32; ++y)
+        {
+            for (S32 x = 0; x <= 32; ++x)
+            {
+                // straight down onto every vertex and between them
+                F32 px = (F32)x / 32 - 0.5f + (y % 2) * (0.5f / 32);
+                F32 py = (F32)y / 32 - 0.5f;
+                LLVector4a start(px, py, 1.f);
+                LLVector4a end(px, py, -1.f);
+                F32 brute_t;
+                F32 bvh_t;
+                bool brute_hit = brute_raycast(face, start, end, brute_t);
+                ensure_equals("hit or miss", bvh_raycast(face, start, end, bvh_t) >= 0, brute_hit);
+                ensure_equals("distance", bvh_t, brute_t);
+            }
+        }
+
+        // from below the face is not hit, one sided like the octree
+        F32 t;
+        ensure("back side", bvh_raycast(face, LLVector4a(0.1f, 0.1f, -1.f), LLVector4a(0.1f, 0.1f, 1.f), t) < 0);
+        // nor past the end of the segment
+        ensure("too short", bvh_raycast(face, LLVector4a(0.1f, 0.1f, 1.f), LLVector4a(0.1f, 0.1f, 0.5f), t) < 0);
+    }
+
+    template<> template<>
+    void volumebvh_object::test<3>()
+    {
+        set_test_name("BVH shares the octree budget");
+        U32 count = LLVolumeFace::getOctreeCount();
+        U64 bytes = LLVolumeFace::getOctreeBytes();
+        {
+            LLVolumeFace face;
+            make_grid(face, 16);
+            face.createBVH();
+            ensure_equals("counted", LLVolumeFace::getOctreeCount(), count + 1);
+            U64 bvh_bytes = LLVolumeFace::getOctreeBytes() - bytes;
+            ensure_equals("its size", bvh_bytes, face.getBVH()->getBytes());
+            face.createOctree();
+            ensure_equals("one face", LLVolumeFace::getOctreeCount(), count + 1);
+            ensure("both", LLVolumeFace::getOctreeBytes() > bytes + bvh_bytes);
+            face.destroyOctree();
+            ensure("dropped with the octree", !face.getBVH());
+            ensure_equals("uncounted", LLVolumeFace::getOctreeCount(), count);
+            face.createBVH();
+        }
+        ensure_equals("freed with the face", LLVolumeFace::getOctreeCount(), count);
+        ensure_equals("bytes back", LLVolumeFace::getOctreeBytes(), bytes);
+    }
+
+    template<> template<>
+    void volumebvh_object::test<4>()
+    {
+        set_test_name("build time and rays per second, octree vs BVH");
+
+        skip_unless_benchmarks();
+        Random random{ 17 };
+        LLVolumeFace face;
+        make_blob(face, 128, 160, random);
+        const U32 triangles = face.mNumIndices / 3;
+
+        constexpr S32 BUILDS = 10;
+        auto time_ms = [](auto&& work)
+        {
+            auto begin = std::chrono::steady_clock::now();
+            work();
+            return std::chrono::duration<F64, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        };
+        F64 octree_build = time_ms([&]()
+            {
+                for (S32 i = 0; i < BUILDS; ++i)
+                {
+                    face.destroyOctree();
+                    face.createOctree();
+                }
+            }) / BUILDS;
+        F64 bvh_build = time_ms([&]()
+            {
+                for (S32 i = 0; i < BUILDS; ++i)
+                {
+                    LLVolumeBVH bvh;
+                    bvh.build(face);
+                }
+            }) / BUILDS;
+        face.createBVH();
+
+        std::vector<LLVector4a> starts;
+        std::vector<LLVector4a> ends;
+        make_rays(starts, ends, 20000, random);
+        S32 octree_hits = 0;
+        S32 bvh_hits = 0;
+        F64 octree_ms = time_ms([&]()
+            {
+                for (size_t i = 0; i < starts.size(); ++i)
+                {
+                    F32 t;
+                    octree_hits += octree_raycast(face, starts[i], ends[i], t);
+                }
+            });
+        F64 bvh_ms = time_ms([&]()
+            {
+                for (size_t i = 0; i < starts.size(); ++i)
+                {
+                    F32 t;
+                    bvh_hits += bvh_raycast(face, starts[i], ends[i], t) >= 0;
+                }
+            });
+
+        std::cout << "\nFace raycasts, " << triangles << " triangles, " << starts.size() << " rays:"
+                  << "\n  octree build:  " << octree_build << " ms, " << starts.size() / octree_ms * 1000.0 << " rays/s"
+                  << "\n  BVH build:     " << bvh_build << " ms, " << starts.size() / bvh_ms * 1000.0 << " rays/s, "
+                  << face.getBVH()->getBytes() / 1024 << " KB" << std::endl;
+        // the octree's boxes are not padded, it may lose the odd grazing hit
+        ensure("same hits", llabs(bvh_hits - octree_hits) <= (S32)starts.size() / 1000);
+    }
+}
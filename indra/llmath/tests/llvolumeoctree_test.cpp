@@ -0,0 +1,140 @@
+/**
+ * @file llvolumeoctree_test.cpp
+ * @brief Lazily built face octrees and their memory budget.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmath.h"
+#include "../llvolume.h"
+#include "../llvolumeoctree.h"
+
+#include "../test/lltut.h"
+
+#include <limits>
+#include <memory>
+
+namespace
+{
+    // a flat grid of size x size quads, two triangles each
+    void make_grid(LLVolumeFace& face, S32 size)
+    {
+        face.resizeVertices((size + 1) * (size + 1));
+        for (S32 y = 0; y <= size; ++y)
+        {
+            for (S32 x = 0; x <= size; ++x)
+            {
+                face.mPositions[y * (size + 1) + x].set((F32)x / size - 0.5f, (F32)y / size - 0.5f, 0.f);
+            }
+        }
+        face.resizeIndices(size * size * 6);
+        U16* index = face.mIndices;
+        for (S32 y = 0; y < size; ++y)
+        {
+            for (S32 x = 0; x < size; ++x)
+            {
+                U16 corner = (U16)(y * (size + 1) + x);
+                *index++ = corner;
+                *index++ = corner + 1;
+                *index++ = corner + size + 1;
+                *index++ = corner + 1;
+                *index++ = corner + size + 2;
+                *index++ = corner + size + 1;
+            }
+        }
+        face.mExtents[0].set(-0.5f, -0.5f, 0.f);
+        face.mExtents[1].set(0.5f, 0.5f, 0.f);
+    }
+}
+
+namespace tut
+{
+    struct volumeoctree_data
+    {
+        ~volumeoctree_data()
+        {
+            LLVolumeFace::setOctreeBudget(std::numeric_limits<U64>::max());
+        }
+    };
+    typedef test_group<volumeoctree_data> volumeoctree_test;
+    typedef volumeoctree_test::object volumeoctree_object;
+    tut::volumeoctree_test volumeoctree_testcase("LLVolumeOctree");
+
+    template<> template<>
+    void volumeoctree_object::test<1>()
+    {
+        set_test_name("octrees are counted while they exist");
+        U32 count = LLVolumeFace::getOctreeCount();
+        U64 bytes = LLVolumeFace::getOctreeBytes();
+        {
+            LLVolumeFace face;
+            make_grid(face, 16);
+            ensure("none until asked for", !face.getOctree());
+            face.createOctree();
+            ensure("built", face.getOctree() != nullptr);
+            ensure_equals("counted", LLVolumeFace::getOctreeCount(), count + 1);
+            ensure("at least the triangles", LLVolumeFace::getOctreeBytes() >= bytes + 16 * 16 * 2 * sizeof(LLVolumeTriangle));
+            face.destroyOctree();
+            ensure("dropped", !face.getOctree());
+            ensure_equals("uncounted", LLVolumeFace::getOctreeCount(), count);
+            face.createOctree();
+        }
+        ensure_equals("freed with the face", LLVolumeFace::getOctreeCount(), count);
+        ensure_equals("bytes back", LLVolumeFace::getOctreeBytes(), bytes);
+    }
+
+    template<> template<>
+    void volumeoctree_object::test<2>()
+    {
+        set_test_name("least recently used octrees go first past the budget");
+        constexpr S32 FACES = 4;
+        std::unique_ptr<LLVolumeFace[]> faces(new LLVolumeFace[FACES]);
+        for (S32 i = 0; i < FACES; ++i)
+        {
+            make_grid(faces[i], 16);
+        }
+        U64 before = LLVolumeFace::getOctreeBytes();
+        faces[0].createOctree();
+        U64 one = LLVolumeFace::getOctreeBytes() - before;
+
+        // room for two of them
+        LLVolumeFace::setOctreeBudget(before + one * 2 + one / 2);
+        faces[1].createOctree();
+        faces[0].createOctree(); // used again, 1 is now the oldest
+        faces[2].createOctree();
+        ensure("oldest freed", !faces[1].getOctree());
+        ensure("used again kept", faces[0].getOctree() != nullptr);
+        ensure("newest kept", faces[2].getOctree() != nullptr);
+        ensure_equals("two left", LLVolumeFace::getOctreeCount(), 2u);
+
+        // a face bigger than the budget still gets its own
+        LLVolumeFace::setOctreeBudget(one / 2);
+        ensure_equals("shrinking the budget frees them", LLVolumeFace::getOctreeCount(), 0u);
+        faces[3].createOctree();
+        ensure("over budget on its own", faces[3].getOctree() != nullptr);
+        faces[1].createOctree();
+        ensure("replaced", faces[1].getOctree() && !faces[3].getOctree());
+    }
+}
@@ -33,6 +33,7 @@
 #include "llcorehttputil.h"
 #include "llhttpconstants.h"
 #include "llsd.h"
+#include "llsdarena.h"
 #include "llsdjson.h"
 #include "llsdserialize.h"
 #include "boost/json.hpp" // Boost.Json
@@ -471,6 +472,9 @@ LLSD HttpCoroLLSDHandler::parseBody(LLCore::HttpResponse *response, bool &succes
     if (response->getBodySize() == 0)
         return LLSD();
 
+    // Capability, AIS and name lookup results are read once and dropped,
+    // which is what LLSDArena is for.
+    LLSDArena::Scope arena;
     LLSD result;
 
     if (!LLCoreHttpUtil::responseToLLSD(response, true, result))
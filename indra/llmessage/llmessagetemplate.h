@@ -91,10 +91,11 @@ public:
         }
     }
 
-    void addVariable(const char *name, EMsgVariableType type)
+    // The returned reference is only valid until the next variable is added
+    LLMsgVarData& addVariable(const char *name, EMsgVariableType type)
     {
         LLMsgVarData tmp(name,type);
-        mMemberVarData[name] = tmp;
+        return mMemberVarData[name] = tmp;
     }
 
     void addData(char *name, const void *data, S32 size, EMsgVariableType type, S32 data_size = -1)
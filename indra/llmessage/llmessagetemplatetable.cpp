@@ -0,0 +1,89 @@
+/**
+ * @file llmessagetemplatetable.cpp
+ * @brief Dense message number to template lookup for the UDP receive path.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmessagetemplatetable.h"
+#include "llmessagetemplate.h"
+
+LLMessageTemplateTable::LLMessageTemplateTable()
+:   mLow(LOW_COUNT, nullptr),
+    mCount(0)
+{
+    std::fill(std::begin(mHigh), std::end(mHigh), nullptr);
+    std::fill(std::begin(mMedium), std::end(mMedium), nullptr);
+}
+
+void LLMessageTemplateTable::add(LLMessageTemplate* templatep)
+{
+    const U32 number = templatep->mMessageNumber;
+    LLMessageTemplate** slot = nullptr;
+    switch (templatep->mFrequency)
+    {
+    case MFT_HIGH:
+        if (number < HIGH_COUNT)
+        {
+            slot = &mHigh[number];
+        }
+        break;
+    case MFT_MEDIUM:
+        if ((number & 0xFFFFFF00) == 0x0000FF00)
+        {
+            slot = &mMedium[number & 0xFF];
+        }
+        break;
+    case MFT_LOW:
+        if ((number & 0xFFFF0000) == 0xFFFF0000)
+        {
+            slot = &mLow[number & 0xFFFF];
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (!slot)
+    {
+        LL_WARNS("Messaging") << "Message " << templatep->mName << " has number " << std::hex << number << std::dec
+                              << " outside of its frequency class, not dispatchable" << LL_ENDL;
+        return;
+    }
+
+    if (!*slot)
+    {
+        ++mCount;
+    }
+    *slot = templatep;
+}
+
+void LLMessageTemplateTable::clear()
+{
+    std::fill(std::begin(mHigh), std::end(mHigh), nullptr);
+    std::fill(std::begin(mMedium), std::end(mMedium), nullptr);
+    std::fill(mLow.begin(), mLow.end(), nullptr);
+    mCount = 0;
+}
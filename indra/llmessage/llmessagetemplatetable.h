@@ -0,0 +1,91 @@
+/**
+ * @file llmessagetemplatetable.h
+ * @brief Dense message number to template lookup for the UDP receive path.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESSAGETEMPLATETABLE_H
+#define LL_LLMESSAGETEMPLATETABLE_H
+
+#include <vector>
+
+class LLMessageTemplate;
+
+/**
+ * @class LLMessageTemplateTable
+ * @brief Templates indexed directly by frequency class and message number.
+ *
+ * Message numbers are 0x000000NN for high frequency messages,
+ * 0x0000FFNN for medium and 0xFFFFNNNN for low frequency ones. Each class
+ * gets an array indexed by the low bits, filled in once when the message
+ * template file is loaded, so looking up the template of a received
+ * packet is a couple of compares and one load instead of a std::map
+ * search.
+ *
+ * The table does not own the templates.
+ */
+class LLMessageTemplateTable
+{
+public:
+    LLMessageTemplateTable();
+
+    void add(LLMessageTemplate* templatep);
+    void clear();
+
+    /// Template for a full message number, or nullptr if there is none.
+    LLMessageTemplate* find(U32 message_number) const
+    {
+        if (message_number < HIGH_COUNT)
+        {
+            return mHigh[message_number];
+        }
+        if ((message_number & 0xFFFFFF00) == 0x0000FF00)
+        {
+            return mMedium[message_number & 0xFF];
+        }
+        if ((message_number & 0xFFFF0000) == 0xFFFF0000)
+        {
+            return mLow[message_number & 0xFFFF];
+        }
+        return nullptr;
+    }
+
+    /// Number of templates in the table.
+    size_t size() const         { return mCount; }
+
+private:
+    enum
+    {
+        HIGH_COUNT = 256,
+        MEDIUM_COUNT = 256,
+        LOW_COUNT = 65536
+    };
+
+    LLMessageTemplate*              mHigh[HIGH_COUNT];
+    LLMessageTemplate*              mMedium[MEDIUM_COUNT];
+    std::vector<LLMessageTemplate*> mLow;
+    size_t                          mCount;
+};
+
+#endif // LL_LLMESSAGETEMPLATETABLE_H
@@ -32,6 +32,11 @@
 #include "lltimer.h"
 #include "llhost.h"
 
+#if LL_LINUX
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+#endif
+
 LLPacketBuffer::LLPacketBuffer(const LLHost &host, const char *datap, const S32 size) : mHost(host)
 {
     mSize = 0;
@@ -82,3 +87,73 @@ void LLPacketBuffer::init(const char* buffer, S32 data_size, const LLHost& host)
     }
 }
 
+// static
+S32 LLPacketBuffer::receiveBatch(S32 hSocket, LLPacketBuffer** buffers, S32 count)
+{
+    count = llmin(count, MAX_RECEIVE_BATCH);
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+#if LL_LINUX
+    mmsghdr messages[MAX_RECEIVE_BATCH];
+    iovec iovs[MAX_RECEIVE_BATCH];
+    sockaddr_in senders[MAX_RECEIVE_BATCH];
+    char controls[MAX_RECEIVE_BATCH][CMSG_SPACE(sizeof(in_pktinfo))];
+
+    memset(messages, 0, sizeof(mmsghdr) * count);
+    for (S32 i = 0; i < count; ++i)
+    {
+        iovs[i].iov_base = buffers[i]->mData;
+        iovs[i].iov_len = NET_BUFFER_SIZE;
+
+        msghdr& header = messages[i].msg_hdr;
+        header.msg_name = &senders[i];
+        header.msg_namelen = sizeof(sockaddr_in);
+        header.msg_iov = &iovs[i];
+        header.msg_iovlen = 1;
+        header.msg_control = controls[i];
+        header.msg_controllen = sizeof(controls[i]);
+    }
+
+    S32 received = recvmmsg(hSocket, messages, count, MSG_DONTWAIT, nullptr);
+    if (received <= 0)
+    {
+        return 0;
+    }
+
+    for (S32 i = 0; i < received; ++i)
+    {
+        LLPacketBuffer* packet = buffers[i];
+        packet->mSize = messages[i].msg_len;
+        packet->mHost = LLHost(senders[i].sin_addr.s_addr, ntohs(senders[i].sin_port));
+
+        // Same as recvfrom_destip() in net.cpp
+        U32 receiving_ip = INVALID_HOST_IP_ADDRESS;
+        msghdr& header = messages[i].msg_hdr;
+        for (cmsghdr* cmsgptr = CMSG_FIRSTHDR(&header); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(&header, cmsgptr))
+        {
+            if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+            {
+                receiving_ip = ((in_pktinfo*)CMSG_DATA(cmsgptr))->ipi_spec_dst.s_addr;
+            }
+        }
+        packet->mReceivingIF = LLHost(receiving_ip, INVALID_PORT);
+    }
+    return received;
+#else
+    // One receive per packet elsewhere
+    S32 received = 0;
+    while (received < count)
+    {
+        buffers[received]->init(hSocket);
+        if (buffers[received]->getSize() <= 0)
+        {
+            break;
+        }
+        ++received;
+    }
+    return received;
+#endif
+}
@@ -46,6 +46,12 @@ public:
     void init(S32 hSocket);
     void init(const char* buffer, S32 data_size, const LLHost& host);
 
+    // Receive up to count packets into buffers, with a single recvmmsg()
+    // call on Linux. Returns the number of buffers filled.
+    static S32 receiveBatch(S32 hSocket, LLPacketBuffer** buffers, S32 count);
+
+    static constexpr S32 MAX_RECEIVE_BATCH = 64;
+
 protected:
     char    mData[NET_BUFFER_SIZE]; // packet data       /* Flawfinder : ignore */
     S32     mSize;                  // size of buffer in bytes
@@ -71,6 +71,15 @@ LLPacketRing::~LLPacketRing ()
 S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 {
     bool drop = computeDrop();
+    if (mNumBufferedPackets == 0 && mUseBatchReceive && !LLProxy::isSOCKSProxyEnabled())
+    {
+        // Refill the ring in one go and serve the rest of the batch from
+        // it, instead of one syscall per packet
+        if (bufferInboundBatch(socket) == 0)
+        {
+            return 0;
+        }
+    }
     return (mNumBufferedPackets > 0) ?
         receiveOrDropBufferedPacket(datap, drop) :
         receiveOrDropPacket(socket, datap, drop);
@@ -296,18 +305,71 @@ S32 LLPacketRing::bufferInboundPacket(S32 socket)
     return packet_size;
 }
 
+S32 LLPacketRing::bufferInboundBatch(S32 socket)
+{
+    if (mNumBufferedPackets == mPacketRing.size() && mNumBufferedPackets < MAX_BUFFER_RING_SIZE)
+    {
+        expandRing();
+    }
+
+    S16 ring_size = (S16)(mPacketRing.size());
+    S32 free_slots = ring_size - mNumBufferedPackets;
+    if (free_slots <= 0)
+    {
+        // ring is maxed out, overwrite the oldest packets one at a time
+        return (bufferInboundPacket(socket) > 0) ? 1 : 0;
+    }
+
+    // free slots start at mHeadIndex, don't wrap within one batch
+    S32 count = llmin(free_slots, ring_size - mHeadIndex);
+    LLPacketBuffer** slots = &mPacketRing[mHeadIndex];
+    S32 received = 0;
+    S32 num_packets = 0;
+    do
+    {
+        received = LLPacketBuffer::receiveBatch(socket, slots, count);
+
+        // empty datagrams are not packets, keep the others contiguous
+        for (S32 i = 0; i < received; ++i)
+        {
+            S32 packet_size = slots[i]->getSize();
+            if (packet_size > 0)
+            {
+                mActualBytesIn += packet_size;
+                mNumBufferedBytes += packet_size;
+                std::swap(slots[num_packets], slots[i]);
+                ++num_packets;
+            }
+        }
+    }
+    while (received > 0 && num_packets == 0);
+
+    mNumBufferedPackets += (S16)num_packets;
+    mHeadIndex = (mHeadIndex + num_packets) % ring_size;
+    return num_packets;
+}
+
 S32 LLPacketRing::drainSocket(S32 socket)
 {
     // drain into buffer
-    S32 packet_size = 1;
-    S32 num_loops = 0;
+    S32 num_received = 0;
     S32 old_num_packets = mNumBufferedPackets;
-    while (packet_size > 0)
+    if (mUseBatchReceive && !LLProxy::isSOCKSProxyEnabled())
+    {
+        S32 num_packets = 0;
+        while ((num_packets = bufferInboundBatch(socket)) > 0)
+        {
+            num_received += num_packets;
+        }
+    }
+    else
     {
-        packet_size = bufferInboundPacket(socket);
-        ++num_loops;
+        while (bufferInboundPacket(socket) > 0)
+        {
+            ++num_received;
+        }
     }
-    S32 num_dropped_packets = (num_loops - 1 + old_num_packets) - mNumBufferedPackets;
+    S32 num_dropped_packets = (num_received + old_num_packets) - mNumBufferedPackets;
     if (num_dropped_packets > 0)
     {
         // It will eventually be accounted by mDroppedPackets
@@ -52,6 +52,10 @@ public:
     void dropPackets(U32);
     void setDropPercentage (F32 percent_to_drop);
 
+    // fill the ring several packets per syscall where the platform allows it
+    void setUseBatchReceive(bool use_batch) { mUseBatchReceive = use_batch; }
+    bool getUseBatchReceive() const { return mUseBatchReceive; }
+
     inline LLHost getLastSender() const;
     inline LLHost getLastReceivingInterface() const;
 
@@ -77,6 +81,9 @@ protected:
     // returns packet_size of packet buffered
     S32 bufferInboundPacket(S32 socket);
 
+    // returns number of packets buffered
+    S32 bufferInboundBatch(S32 socket);
+
     // returns 'true' if ring was expanded
     bool expandRing();
 
@@ -92,6 +99,11 @@ protected:
     S32 mActualBytesOut { 0 };
     F32 mDropPercentage { 0.0f };   // % of inbound packets to drop
     U32 mPacketsToDrop { 0 };       // drop next inbound n packets
+#if LL_LINUX
+    bool mUseBatchReceive { true }; // recvmmsg() into the ring, not through SOCKS proxy
+#else
+    bool mUseBatchReceive { false };
+#endif
 
     // These are the sender and receiving_interface for the last packet delivered by receivePacket()
     LLHost mLastSender;
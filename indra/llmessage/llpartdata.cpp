@@ -327,7 +327,6 @@ std::ostream& operator<<(std::ostream& s, const LLPartSysData &data)
 bool LLPartSysData::isNullPS(const S32 block_num)
 {
     U8 ps_data_block[PS_MAX_DATA_BLOCK_SIZE];
-    U32 crc;
 
     S32 size;
     // Check size of block
@@ -346,6 +345,23 @@ bool LLPartSysData::isNullPS(const S32 block_num)
 
     gMessageSystem->getBinaryData("ObjectData", "PSBlock", ps_data_block, size, block_num, PS_MAX_DATA_BLOCK_SIZE);
 
+    // <FS> object update pipeline
+    return isNullPS(ps_data_block, size);
+}
+
+// static
+bool LLPartSysData::isNullPS(const U8* data, S32 size)
+{
+    U8 ps_data_block[PS_MAX_DATA_BLOCK_SIZE];
+    U32 crc = 0;
+
+    if (size <= 0 || size > PS_MAX_DATA_BLOCK_SIZE)
+    {
+        return true;
+    }
+
+    memcpy(ps_data_block, data, size);
+    // </FS>
     LLDataPackerBinaryBuffer dp(ps_data_block, size);
     if (size > PS_LEGACY_DATA_BLOCK_SIZE)
     {
@@ -384,6 +400,22 @@ bool LLPartSysData::unpackBlock(const S32 block_num)
     // Get from message
     gMessageSystem->getBinaryData("ObjectData", "PSBlock", ps_data_block, size, block_num, PS_MAX_DATA_BLOCK_SIZE);
 
+    // <FS> object update pipeline
+    return unpackBlock(ps_data_block, size);
+}
+
+bool LLPartSysData::unpackBlock(const U8* data, S32 size)
+{
+    U8 ps_data_block[PS_MAX_DATA_BLOCK_SIZE];
+
+    if (size < 0 || size > PS_MAX_DATA_BLOCK_SIZE)
+    {
+        // Larger packets are newer and unsupported
+        return false;
+    }
+
+    memcpy(ps_data_block, data, size);
+    // </FS>
     LLDataPackerBinaryBuffer dp(ps_data_block, size);
 
     if (size == PS_LEGACY_DATA_BLOCK_SIZE)
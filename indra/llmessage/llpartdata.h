@@ -191,11 +191,14 @@ public:
     bool unpack(LLDataPacker &dp);
     bool unpackLegacy(LLDataPacker &dp);
     bool unpackBlock(const S32 block_num);
+    // <FS> object update pipeline: a PSBlock copied out of the message
+    bool unpackBlock(const U8* data, S32 size);
 
     LLSD asLLSD() const;
     bool fromLLSD(LLSD& sd);
 
     static bool isNullPS(const S32 block_num); // Returns false if this is a "NULL" particle system (i.e. no system)
+    static bool isNullPS(const U8* data, S32 size); // <FS> object update pipeline
 
     bool isLegacyCompatible() const;
 
@@ -30,6 +30,7 @@
 #include "llfasttimer.h"
 #include "llmessagebuilder.h"
 #include "llmessagetemplate.h"
+#include "llmessagetemplatetable.h"
 #include "llmath.h"
 #include "llquaternion.h"
 #include "message.h"
@@ -40,12 +41,11 @@
 
 #include "nd/ndexceptions.h" // <FS:ND/> For ndxran
 
-LLTemplateMessageReader::LLTemplateMessageReader(message_template_number_map_t&
-                                                 number_template_map) :
+LLTemplateMessageReader::LLTemplateMessageReader(const LLMessageTemplateTable& template_table) :
     mReceiveSize(0),
     mCurrentRMessageTemplate(NULL),
     mCurrentRMessageData(NULL),
-    mMessageNumbers(number_template_map)
+    mTemplateTable(template_table)
 {
 }
 
@@ -494,7 +494,7 @@ bool LLTemplateMessageReader::decodeTemplate(
         return(false);
     }
 
-    LLMessageTemplate* temp = get_ptr_in_map(mMessageNumbers,num);
+    LLMessageTemplate* temp = mTemplateTable.find(num);
     if (temp)
     {
         *msg_template = temp;
@@ -640,7 +640,7 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 
                 // ok, build out the variables
                 // add variable block
-                cur_data_block->addVariable(mvci.getName(), mvci.getType());
+                LLMsgVarData& var_data = cur_data_block->addVariable(mvci.getName(), mvci.getType());
 
                 // what type of variable?
                 if (mvci.getType() == MVT_VARIABLE)
@@ -680,7 +680,7 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
                     }
                     decode_pos += data_size;
 
-                    cur_data_block->addData(mvci.getName(), &buffer[decode_pos], tsize, mvci.getType());
+                    var_data.addData(&buffer[decode_pos], tsize, mvci.getType());
                     decode_pos += tsize;
                 }
                 else
@@ -694,15 +694,13 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
                         // default to 0s.
                         U32 size = mvci.getSize();
                         std::vector<U8> data(size, 0);
-                        cur_data_block->addData(mvci.getName(), &(data[0]),
-                                                size, mvci.getType());
+                        var_data.addData(&(data[0]), size, mvci.getType());
                     }
                     else
                     {
-                        cur_data_block->addData(mvci.getName(),
-                                                &buffer[decode_pos],
-                                                mvci.getSize(),
-                                                mvci.getType());
+                        var_data.addData(&buffer[decode_pos],
+                                         mvci.getSize(),
+                                         mvci.getType());
                     }
                     decode_pos += mvci.getSize();
                 }
@@ -32,6 +32,7 @@
 #include <map>
 
 class LLMessageTemplate;
+class LLMessageTemplateTable;
 class LLMsgData;
 
 class LLTemplateMessageReader : public LLMessageReader
@@ -40,7 +41,7 @@ public:
 
     typedef std::map<U32, LLMessageTemplate*> message_template_number_map_t;
 
-    LLTemplateMessageReader(message_template_number_map_t&);
+    LLTemplateMessageReader(const LLMessageTemplateTable&);
     virtual ~LLTemplateMessageReader();
 
     /** All get* methods expect pointers to canonical strings. */
@@ -121,7 +122,7 @@ private:
     S32 mReceiveSize;
     LLMessageTemplate* mCurrentRMessageTemplate;
     LLMsgData* mCurrentRMessageData;
-    message_template_number_map_t& mMessageNumbers;
+    const LLMessageTemplateTable& mTemplateTable;
 };
 
 #endif // LL_LLTEMPLATEMESSAGEREADER_H
@@ -233,7 +233,7 @@ LLMessageSystem::LLMessageSystem(const std::string& filename, U32 port,
     mLLSDMessageBuilder = new LLSDMessageBuilder();
     mMessageBuilder = NULL;
 
-    mTemplateMessageReader = new LLTemplateMessageReader(mMessageNumbers);
+    mTemplateMessageReader = new LLTemplateMessageReader(mTemplateTable);
     mLLSDMessageReader = new LLSDMessageReader();
 
     // initialize various bits of net info
@@ -326,6 +326,7 @@ void LLMessageSystem::loadTemplateFile(const std::string& filename, bool failure
 LLMessageSystem::~LLMessageSystem()
 {
     mMessageTemplates.clear(); // don't delete templates.
+    mTemplateTable.clear();
     for_each(mMessageNumbers.begin(), mMessageNumbers.end(), DeletePairedPointer());
     mMessageNumbers.clear();
 
@@ -2702,7 +2703,7 @@ void LLMessageSystem::dumpReceiveCounts()
     S32 i;
     for (i = 0; i < mNumMessageCounts; i++)
     {
-        mt = get_ptr_in_map(mMessageNumbers,mMessageCountList[i].mMessageNum);
+        mt = mTemplateTable.find(mMessageCountList[i].mMessageNum);
         if (mt)
         {
             mt->mReceiveCount++;
@@ -2940,6 +2941,7 @@ void LLMessageSystem::addTemplate(LLMessageTemplate *templatep)
     }
     mMessageTemplates[templatep->mName] = templatep;
     mMessageNumbers[templatep->mMessageNumber] = templatep;
+    mTemplateTable.add(templatep);
 }
 
 
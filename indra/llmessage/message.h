@@ -53,6 +53,7 @@
 #include "llstl.h"
 #include "llmsgvariabletype.h"
 #include "llmessagesenderinterface.h"
+#include "llmessagetemplatetable.h"
 
 #include "llstoredmessage.h"
 #include "boost/function.hpp"
@@ -306,6 +307,7 @@ class LLMessageSystem : public LLMessageSenderInterface
 private:
     message_template_name_map_t     mMessageTemplates;
     message_template_number_map_t   mMessageNumbers;
+    LLMessageTemplateTable          mTemplateTable;     // receive side lookup by message number
 
 public:
     S32                 mSystemVersionMajor;
@@ -0,0 +1,233 @@
+/**
+ * @file llpacketring_test.cpp
+ * @brief LLPacketRing loopback receive tests and flood benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpacketring.h"
+#include "../net.h"
+
+#include "../test/lltut.h"
+
+#if !LL_WINDOWS
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    // Packets of one "frame" worth of object updates after a teleport
+    // into a crowded region.
+    constexpr S32 PACKETS_PER_FRAME = 256;
+    constexpr S32 PACKET_SIZE = 200;
+}
+
+namespace tut
+{
+    struct packetring_data
+    {
+        packetring_data()
+        {
+#if !LL_WINDOWS
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = 0;
+
+            mReceiver = socket(AF_INET, SOCK_DGRAM, 0);
+            bind(mReceiver, (sockaddr*)&addr, sizeof(addr));
+            fcntl(mReceiver, F_SETFL, O_NONBLOCK);
+            int rec_size = 4 * 1024 * 1024;
+            setsockopt(mReceiver, SOL_SOCKET, SO_RCVBUF, &rec_size, sizeof(rec_size));
+
+            socklen_t len = sizeof(mReceiverAddr);
+            getsockname(mReceiver, (sockaddr*)&mReceiverAddr, &len);
+
+            mSender = socket(AF_INET, SOCK_DGRAM, 0);
+            bind(mSender, (sockaddr*)&addr, sizeof(addr));
+            len = sizeof(mSenderAddr);
+            getsockname(mSender, (sockaddr*)&mSenderAddr, &len);
+#endif
+        }
+
+        ~packetring_data()
+        {
+#if !LL_WINDOWS
+            close(mSender);
+            close(mReceiver);
+#endif
+        }
+
+        // Each packet starts with its sequence number
+        void flood(S32 count, S32 first = 0)
+        {
+#if !LL_WINDOWS
+            char buffer[PACKET_SIZE];
+            memset(buffer, 'x', sizeof(buffer));
+            for (S32 i = 0; i < count; ++i)
+            {
+                S32 sequence = first + i;
+                memcpy(buffer, &sequence, sizeof(sequence));
+                sendto(mSender, buffer, sizeof(buffer), 0, (sockaddr*)&mReceiverAddr, sizeof(mReceiverAddr));
+            }
+#endif
+        }
+
+        // What LLMessageSystem::checkMessages() does with the ring
+        S32 receiveAll(LLPacketRing& ring, std::vector<S32>* sequences = nullptr)
+        {
+            char buffer[NET_BUFFER_SIZE];
+            S32 received = 0;
+            S32 packet_size = 0;
+            while ((packet_size = ring.receivePacket(mReceiver, buffer)) > 0)
+            {
+                ++received;
+                if (sequences)
+                {
+                    S32 sequence;
+                    memcpy(&sequence, buffer, sizeof(sequence));
+                    sequences->push_back(sequence);
+                }
+            }
+            return received;
+        }
+
+        S32 mReceiver = -1;
+        S32 mSender = -1;
+#if !LL_WINDOWS
+        sockaddr_in mReceiverAddr = {};
+        sockaddr_in mSenderAddr = {};
+#endif
+    };
+    typedef test_group<packetring_data> packetring_test;
+    typedef packetring_test::object packetring_object;
+    tut::packetring_test packetring_testcase("LLPacketRing");
+
+    template<> template<>
+    void packetring_object::test<1>()
+    {
+        set_test_name("packets arrive in order with their sender");
+#if LL_WINDOWS
+        skip("loopback flood test uses POSIX sockets");
+#else
+        for (bool use_batch : { false, true })
+        {
+            LLPacketRing ring;
+            ring.setUseBatchReceive(use_batch);
+
+            flood(300);
+            std::vector<S32> sequences;
+            ensure_equals("all received", receiveAll(ring, &sequences), 300);
+            for (S32 i = 0; i < 300; ++i)
+            {
+                ensure_equals("in order", sequences[i], i);
+            }
+            ensure_equals("sender", ring.getLastSender(),
+                          LLHost(mSenderAddr.sin_addr.s_addr, ntohs(mSenderAddr.sin_port)));
+            ensure_equals("bytes counted", ring.getActualInBytes(), 300 * PACKET_SIZE);
+            ensure_equals("nothing left over", ring.getNumBufferedPackets(), 0);
+        }
+#endif
+    }
+
+    template<> template<>
+    void packetring_object::test<2>()
+    {
+        set_test_name("drained packets and simulated loss");
+#if LL_WINDOWS
+        skip("loopback flood test uses POSIX sockets");
+#else
+        for (bool use_batch : { false, true })
+        {
+            LLPacketRing ring;
+            ring.setUseBatchReceive(use_batch);
+
+            // drain grows the ring past its default size
+            flood(400);
+            ensure_equals("drained", ring.drainSocket(mReceiver), 400);
+            ensure_equals("buffered bytes", ring.getNumBufferedBytes(), 400 * PACKET_SIZE);
+            ensure_equals("drained packets delivered", receiveAll(ring), 400);
+
+            // a dropped packet still ends the receive loop, as before
+            flood(100, 1000);
+            ring.dropPackets(10);
+            S32 delivered = 0;
+            char buffer[NET_BUFFER_SIZE];
+            for (S32 i = 0; i < 100; ++i)
+            {
+                delivered += ring.receivePacket(mReceiver, buffer) > 0;
+            }
+            ensure_equals("dropped first ten", delivered, 90);
+            S32 sequence;
+            memcpy(&sequence, buffer, sizeof(sequence));
+            ensure_equals("last one delivered", sequence, 1099);
+        }
+#endif
+    }
+
+    template<> template<>
+    void packetring_object::test<3>()
+    {
+        set_test_name("flood throughput and main thread time per frame");
+
+        skip_unless_benchmarks();
+#if LL_WINDOWS
+        skip("loopback flood test uses POSIX sockets");
+#else
+        constexpr S32 FRAMES = 200;
+        for (bool use_batch : { false, true })
+        {
+            LLPacketRing ring;
+            ring.setUseBatchReceive(use_batch);
+
+            F64 seconds = 0.0;
+            F64 worst = 0.0;
+            S32 received = 0;
+            for (S32 frame = 0; frame < FRAMES; ++frame)
+            {
+                flood(PACKETS_PER_FRAME);
+                auto start = std::chrono::steady_clock::now();
+                received += receiveAll(ring);
+                F64 frame_time = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+                seconds += frame_time;
+                worst = llmax(worst, frame_time);
+            }
+            ensure_equals("nothing lost", received, FRAMES * PACKETS_PER_FRAME);
+
+            std::cout << "\nLLPacketRing " << (use_batch ? "recvmmsg" : "recvfrom") << ": "
+                      << received / llmax(seconds, 1e-9) << " packets/s, "
+                      << seconds * 1000.0 / FRAMES << " ms per frame (worst "
+                      << worst * 1000.0 << " ms) for " << PACKETS_PER_FRAME << " packets" << std::endl;
+        }
+#endif
+    }
+}
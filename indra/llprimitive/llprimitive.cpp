@@ -1385,9 +1385,11 @@ bool LLPrimitive::packTEMessage(LLDataPacker &dp) const
 S32 LLPrimitive::parseTEMessage(LLMessageSystem* mesgsys, char const* block_name, const S32 block_num, LLTEContents& tec)
 {
     S32 retval = 0;
-    // temp buffer for material ID processing
-    // data will end up in tec.material_id[]
-    material_id_type material_data[LLTEContents::MAX_TES];
+    // <FS> moved to parseTEContents()
+    //// temp buffer for material ID processing
+    //// data will end up in tec.material_id[]
+    //material_id_type material_data[LLTEContents::MAX_TES];
+    // </FS>
 
     if (block_num < 0)
     {
@@ -1419,6 +1421,18 @@ S32 LLPrimitive::parseTEMessage(LLMessageSystem* mesgsys, char const* block_name
 
     tec.face_count = llmin((U32)getNumTEs(),(U32)LLTEContents::MAX_TES);
 
+    // <FS> shared with the object update pipeline
+    return parseTEContents(tec) ? 1 : 0;
+}
+
+// static
+bool LLPrimitive::parseTEContents(LLTEContents& tec)
+{
+    // temp buffer for material ID processing
+    // data will end up in tec.material_id[]
+    material_id_type material_data[LLTEContents::MAX_TES];
+    // </FS>
+
     U8 *cur_ptr = tec.packed_buffer;
     LL_DEBUGS("TEXTUREENTRY") << "Texture Entry with buffere sized: " << tec.size << LL_ENDL;
     U8 *buffer_end = tec.packed_buffer + tec.size;
@@ -1435,7 +1449,7 @@ S32 LLPrimitive::parseTEMessage(LLMessageSystem* mesgsys, char const* block_name
             unpack_TEField<U8>(tec.glow, tec.face_count, cur_ptr, buffer_end, MVT_U8)))
     {
         LL_WARNS("TEXTUREENTRY") << "Failure parsing Texture Entry Message due to malformed TE Field! Dropping changes on the floor. " << LL_ENDL;
-        return 0;
+        return false;
     }
 
     if (cur_ptr >= buffer_end || !unpack_TEField<material_id_type>(material_data, tec.face_count, cur_ptr, buffer_end, MVT_LLUUID))
@@ -1448,8 +1462,7 @@ S32 LLPrimitive::parseTEMessage(LLMessageSystem* mesgsys, char const* block_name
         tec.material_ids[i].set(&(material_data[i]));
     }
 
-    retval = 1;
-    return retval;
+    return true;
     }
 
 S32 LLPrimitive::applyParsedTEMessage(LLTEContents& tec)
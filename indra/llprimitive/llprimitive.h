@@ -511,6 +511,10 @@ public:
     S32 unpackTEMessage(LLDataPacker &dp);
     S32 parseTEMessage(LLMessageSystem* mesgsys, char const* block_name, const S32 block_num, LLTEContents& tec);
     S32 applyParsedTEMessage(LLTEContents& tec);
+    // <FS> Parses the tec.size bytes in tec.packed_buffer for tec.face_count
+    // faces. Needs no object, so it can run on any thread.
+    static bool parseTEContents(LLTEContents& tec);
+    // </FS>
 
 #ifdef CHECK_FOR_FINITE
     inline void setPosition(const LLVector3& pos);
@@ -1039,13 +1039,19 @@ void LLVertexBuffer::flushBuffers()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
     // must only be called from main thread
+    size_t kept = 0;
     for (auto& buffer : sMappedBuffers)
     {
+        if (buffer->mWorkerFill)
+        { // still being written, flushed after finishWorkerFill()
+            sMappedBuffers[kept++] = buffer;
+            continue;
+        }
         buffer->_unmapBuffer();
         buffer->mMapped = false;
     }
 
-    sMappedBuffers.resize(0);
+    sMappedBuffers.resize(kept);
 }
 
 //static
@@ -1094,6 +1100,7 @@ LLVertexBuffer::~LLVertexBuffer()
     if (mMapped)
     { // is on the mapped buffer list but doesn't need to be flushed
         mMapped = false;
+        mWorkerFill = false;
         unmapBuffer();
     }
 
@@ -1298,6 +1305,11 @@ bool expand_region(LLVertexBuffer::MappedRegion& region, U32 start, U32 end)
 U8* LLVertexBuffer::mapVertexBuffer(LLVertexBuffer::AttributeType type, U32 index, S32 count)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+    if (mWorkerFill)
+    { // already flagged in full, the bookkeeping below isn't thread safe
+        return mMappedData+mOffsets[type]+sTypeSize[type]*index;
+    }
+
     _mapBuffer();
 
     if (count == -1)
@@ -1335,6 +1347,11 @@ U8* LLVertexBuffer::mapVertexBuffer(LLVertexBuffer::AttributeType type, U32 inde
 U8* LLVertexBuffer::mapIndexBuffer(U32 index, S32 count)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+    if (mWorkerFill)
+    {
+        return mMappedIndexData + sizeof(U16)*index;
+    }
+
     _mapBuffer();
 
     if (count == -1)
@@ -1418,6 +1435,32 @@ void LLVertexBuffer::unmapBuffer()
     flushBuffers();
 }
 
+void LLVertexBuffer::beginWorkerFill()
+{
+    _mapBuffer();
+
+    if (!gGLManager.mIsApple)
+    {
+        mMappedVertexRegions.clear();
+        mMappedIndexRegions.clear();
+        if (mSize > 0)
+        {
+            mMappedVertexRegions.push_back({ 0, mSize - 1 });
+        }
+        if (mIndicesSize > 0)
+        {
+            mMappedIndexRegions.push_back({ 0, mIndicesSize - 1 });
+        }
+    }
+
+    mWorkerFill = true;
+}
+
+void LLVertexBuffer::finishWorkerFill()
+{
+    mWorkerFill = false;
+}
+
 void LLVertexBuffer::_mapBuffer()
 {
     if (!mMapped)
@@ -202,6 +202,13 @@ public:
     // synonym for flushBuffers
     void    unmapBuffer();
 
+    // Flag the whole buffer for upload and let getXXXStrider() be called
+    // from worker threads until finishWorkerFill(). flushBuffers() leaves
+    // the buffer alone meanwhile. Main thread only, and only for a buffer
+    // that is about to be written in full.
+    void    beginWorkerFill();
+    void    finishWorkerFill();
+
     // set for rendering
     // assumes (and will assert on) the following:
     //      - this buffer has no pending unmapBuffer call
@@ -332,6 +339,7 @@ private:
     // add to set of mapped buffers
     void _mapBuffer();
     bool mMapped = false;
+    bool mWorkerFill = false;
 
 public:
 
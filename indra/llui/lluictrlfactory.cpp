@@ -88,8 +88,12 @@ void LLUICtrlFactory::loadWidgetTemplate(const std::string& widget_tag, LLInitPa
 {
     std::string filename = gDirUtilp->add("widgets", widget_tag + ".xml");
     LLXMLNodePtr root_node;
+    // <FS> XUI layout cache
+    //std::vector<std::string> search_paths =
+    //    gDirUtilp->findSkinnedFilenames(LLDir::XUI, filename);
     std::vector<std::string> search_paths =
-        gDirUtilp->findSkinnedFilenames(LLDir::XUI, filename);
+        LLUICtrlFactory::instance().getSkinnedFilenames(filename, LLDir::CURRENT_SKIN);
+    // </FS>
 
     if (search_paths.empty())
     {
@@ -102,7 +106,10 @@ void LLUICtrlFactory::loadWidgetTemplate(const std::string& widget_tag, LLInitPa
     {
         LLUICtrlFactory::instance().pushFileName(base_filename);
 
-        if (!LLXMLNode::getLayeredXMLNode(root_node, search_paths))
+        // <FS> XUI layout cache
+        //if (!LLXMLNode::getLayeredXMLNode(root_node, search_paths))
+        if (!LLUICtrlFactory::instance().mLayoutCache.getLayeredXMLNode(root_node, search_paths))
+        // </FS>
         {
             LL_WARNS() << "Couldn't parse widget from: " << base_filename << LL_ENDL;
             return;
@@ -174,8 +181,12 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
                                         LLDir::ESkinConstraint constraint)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
-    std::vector<std::string> paths =
-        gDirUtilp->findSkinnedFilenames(LLDir::XUI, xui_filename, constraint);
+    // <FS> XUI layout cache
+    //std::vector<std::string> paths =
+    //    gDirUtilp->findSkinnedFilenames(LLDir::XUI, xui_filename, constraint);
+    LLUICtrlFactory& factory = instance();
+    std::vector<std::string> paths = factory.getSkinnedFilenames(xui_filename, constraint);
+    // </FS>
 
     if (paths.empty())
     {
@@ -183,9 +194,40 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
         paths.push_back(xui_filename);
     }
 
-    return LLXMLNode::getLayeredXMLNode(root, paths);
+    // <FS> XUI layout cache
+    //return LLXMLNode::getLayeredXMLNode(root, paths);
+    return factory.mLayoutCache.getLayeredXMLNode(root, paths);
+    // </FS>
 }
 
+// <FS> XUI layout cache
+std::vector<std::string> LLUICtrlFactory::getSkinnedFilenames(const std::string& filename, LLDir::ESkinConstraint constraint)
+{
+    if (!mLayoutCache.isEnabled())
+    {
+        mSkinnedFilenames.clear();
+        return gDirUtilp->findSkinnedFilenames(LLDir::XUI, filename, constraint);
+    }
+
+    // the search paths change with the skin, theme and language
+    const std::string skin = gDirUtilp->getUserSkinDir() + "|" + gDirUtilp->getSkinThemeDir() + "|"
+                           + gDirUtilp->getSkinDir() + "|" + gDirUtilp->getLanguage();
+    if (skin != mSkinnedFilenamesSkin)
+    {
+        mSkinnedFilenames.clear();
+        mSkinnedFilenamesSkin = skin;
+    }
+
+    auto key = std::make_pair(filename, constraint);
+    auto iter = mSkinnedFilenames.find(key);
+    if (iter == mSkinnedFilenames.end())
+    {
+        iter = mSkinnedFilenames.emplace(key, gDirUtilp->findSkinnedFilenames(LLDir::XUI, filename, constraint)).first;
+    }
+    return iter->second;
+}
+// </FS>
+
 
 //-----------------------------------------------------------------------------
 // saveToXML()
@@ -35,6 +35,7 @@
 #include "lldir.h"
 #include "llsingleton.h"
 #include "llheteromap.h"
+#include "lllayeredxmlcache.h" // <FS> XUI layout cache
 
 class LLView;
 void deleteView(LLView*); // Inside LLView.cpp, avoid having to potentially delete an incomplete type here.
@@ -194,6 +195,11 @@ fail:
     static bool getLayeredXMLNode(const std::string &filename, LLXMLNodePtr& root,
                                   LLDir::ESkinConstraint constraint=LLDir::CURRENT_SKIN);
 
+    // <FS> XUI layout cache
+    // Merged trees getLayeredXMLNode() keeps, the viewer loads and saves it
+    static LLLayeredXMLCache& getLayoutCache() { return instance().mLayoutCache; }
+    // </FS>
+
 private:
     //NOTE: both friend declarations are necessary to keep both gcc and msvc happy
     template <typename T> friend class LLChildRegistry;
@@ -274,6 +280,16 @@ private:
     class LLPanel*      mDummyPanel;
     std::vector<std::string>    mFileNames;
 
+    // <FS> XUI layout cache
+    // findSkinnedFilenames() for the current skin and language, remembered
+    // while the layout cache is on
+    std::vector<std::string> getSkinnedFilenames(const std::string& filename, LLDir::ESkinConstraint constraint);
+
+    LLLayeredXMLCache mLayoutCache;
+    std::map<std::pair<std::string, LLDir::ESkinConstraint>, std::vector<std::string> > mSkinnedFilenames;
+    std::string mSkinnedFilenamesSkin;
+    // </FS>
+
     // store ParamDefaults specializations
     // Each ParamDefaults specialization used to be an LLSingleton in its own
     // right. But the 2016 changes to the LLSingleton mechanism, making
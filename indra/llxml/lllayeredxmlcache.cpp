@@ -0,0 +1,412 @@
+/**
+ * @file lllayeredxmlcache.cpp
+ * @brief Cache of merged skin and language XML layers.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lllayeredxmlcache.h"
+
+#include "llfile.h"
+
+namespace
+{
+    const char CACHE_MAGIC[8] = { 'L', 'L', 'X', 'M', 'L', 'C', 'C', 'H' };
+    constexpr U32 CACHE_FORMAT_VERSION = 1;
+
+    // Host byte order, the file is only read back on the same machine
+    class Writer
+    {
+    public:
+        template <typename T>
+        void put(T value)
+        {
+            mBuffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void putString(const std::string& str)
+        {
+            put((U32)str.size());
+            mBuffer.append(str);
+        }
+
+        void putNode(const LLXMLNode* node)
+        {
+            put((U8)node->mIsAttribute);
+            putString(node->getName() ? node->getName()->mString : std::string());
+            putString(node->mID);
+            putString(node->getValue());
+            put(node->mVersionMajor);
+            put(node->mVersionMinor);
+            put(node->mLength);
+            put(node->mPrecision);
+            put((U8)node->mType);
+            put((U8)node->mEncoding);
+            put(node->mLineNumber);
+
+            put((U32)node->mAttributes.size());
+            for (const auto& attribute : node->mAttributes)
+            {
+                putNode(attribute.second);
+            }
+            put(node->getChildCount());
+            for (LLXMLNodePtr child = node->getFirstChild(); child.notNull(); child = child->getNextSibling())
+            {
+                putNode(child);
+            }
+        }
+
+        const std::string& getBuffer() const { return mBuffer; }
+
+    private:
+        std::string mBuffer;
+    };
+
+    // Every read is bounds checked, a short file just fails
+    class Reader
+    {
+    public:
+        Reader(const std::string& buffer) : mBuffer(buffer), mPos(0), mFailed(false) {}
+
+        template <typename T>
+        T get()
+        {
+            T value{};
+            if (mFailed || mBuffer.size() - mPos < sizeof(T))
+            {
+                mFailed = true;
+                return value;
+            }
+            memcpy(&value, mBuffer.data() + mPos, sizeof(T));
+            mPos += sizeof(T);
+            return value;
+        }
+
+        std::string getString()
+        {
+            const U32 size = get<U32>();
+            if (mFailed || mBuffer.size() - mPos < size)
+            {
+                mFailed = true;
+                return std::string();
+            }
+            std::string str(mBuffer, mPos, size);
+            mPos += size;
+            return str;
+        }
+
+        // A count of records at least record_size bytes each, more than
+        // the rest of the buffer can hold fails
+        U32 getCount(size_t record_size)
+        {
+            const U32 count = get<U32>();
+            if (mFailed || (mBuffer.size() - mPos) / record_size < count)
+            {
+                mFailed = true;
+                return 0;
+            }
+            return count;
+        }
+
+        // Reads the node and, once it is attached to parent, what is below
+        // it. Attaching first keeps addChild() from walking the subtree.
+        LLXMLNodePtr getNode(LLXMLNode* parent)
+        {
+            const bool is_attribute = get<U8>() != 0;
+            const std::string name = getString();
+            if (mFailed || name.empty())
+            {
+                mFailed = true;
+                return nullptr;
+            }
+            LLXMLNodePtr node = new LLXMLNode(name.c_str(), is_attribute);
+            node->mID = getString();
+            node->setValue(getString());
+            node->mVersionMajor = get<U32>();
+            node->mVersionMinor = get<U32>();
+            node->mLength = get<U32>();
+            node->mPrecision = get<U32>();
+            node->mType = (LLXMLNode::ValueType)get<U8>();
+            node->mEncoding = (LLXMLNode::Encoding)get<U8>();
+            node->mLineNumber = get<S32>();
+            if (parent)
+            {
+                parent->addChild(node);
+            }
+
+            for (U32 count = get<U32>(); count > 0 && !mFailed; --count)
+            {
+                getNode(node);
+            }
+            for (U32 count = get<U32>(); count > 0 && !mFailed; --count)
+            {
+                getNode(node);
+            }
+            return mFailed ? nullptr : node;
+        }
+
+        bool failed() const { return mFailed; }
+        bool atEnd() const { return mPos == mBuffer.size(); }
+
+    private:
+        const std::string& mBuffer;
+        size_t mPos;
+        bool mFailed;
+    };
+
+    // Attaches each copy before filling it, so addChild() has nothing
+    // below it to walk
+    void copy_below(const LLXMLNode* src, LLXMLNode* dst)
+    {
+        for (const auto& attribute : src->mAttributes)
+        {
+            LLXMLNodePtr copy = new LLXMLNode(*attribute.second);
+            copy->mLineNumber = attribute.second->mLineNumber;
+            dst->addChild(copy);
+        }
+        for (LLXMLNodePtr child = src->getFirstChild(); child.notNull(); child = child->getNextSibling())
+        {
+            LLXMLNodePtr copy = new LLXMLNode(*child);
+            copy->mLineNumber = child->mLineNumber;
+            dst->addChild(copy);
+            copy_below(child, copy);
+        }
+    }
+}
+
+LLLayeredXMLCache::LLLayeredXMLCache() :
+    mHitCount(0),
+    mMissCount(0),
+    mEnabled(true)
+{
+}
+
+void LLLayeredXMLCache::setEnabled(bool enabled)
+{
+    if (enabled != mEnabled)
+    {
+        clear();
+        mEnabled = enabled;
+    }
+}
+
+bool LLLayeredXMLCache::getLayeredXMLNode(LLXMLNodePtr& root, const std::vector<std::string>& paths)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    if (!mEnabled)
+    {
+        return LLXMLNode::getLayeredXMLNode(root, paths);
+    }
+
+    const std::string key = makeKey(paths);
+    auto iter = mEntries.find(key);
+    if (iter != mEntries.end())
+    {
+        Entry& entry = iter->second;
+        if (!entry.mVerified && !layersUnchanged(entry.mLayers))
+        {
+            mEntries.erase(iter);
+        }
+        else
+        {
+            entry.mVerified = true;
+            ++mHitCount;
+            root = copyTree(entry.mRoot);
+            return true;
+        }
+    }
+
+    ++mMissCount;
+    // taken before parsing, so a file saved meanwhile is caught next session
+    std::vector<Layer> layers;
+    const bool have_layers = statLayers(paths, layers);
+    if (!LLXMLNode::getLayeredXMLNode(root, paths))
+    {
+        return false;
+    }
+    if (have_layers)
+    {
+        Entry& entry = mEntries[key];
+        entry.mLayers.swap(layers);
+        entry.mRoot = copyTree(root);
+        entry.mVerified = true;
+    }
+    return true;
+}
+
+void LLLayeredXMLCache::clear()
+{
+    mEntries.clear();
+}
+
+bool LLLayeredXMLCache::loadFromFile(const std::string& filename)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    const std::string buffer = LLFile::getContents(filename);
+    Reader reader(buffer);
+    char magic[sizeof(CACHE_MAGIC)];
+    for (char& c : magic)
+    {
+        c = reader.get<char>();
+    }
+    if (reader.failed() || memcmp(magic, CACHE_MAGIC, sizeof(magic)) || reader.get<U32>() != CACHE_FORMAT_VERSION)
+    {
+        return false;
+    }
+
+    entry_map_t entries;
+    for (U32 count = reader.get<U32>(); count > 0 && !reader.failed(); --count)
+    {
+        const std::string key = reader.getString();
+        Entry& entry = entries[key];
+        // path size, modified time and size
+        entry.mLayers.resize(reader.getCount(sizeof(U32) + sizeof(S64) + sizeof(U64)));
+        for (Layer& layer : entry.mLayers)
+        {
+            layer.mPath = reader.getString();
+            layer.mModified = reader.get<S64>();
+            layer.mSize = reader.get<U64>();
+        }
+        entry.mRoot = reader.getNode(nullptr);
+        entry.mVerified = false;
+    }
+    if (reader.failed() || !reader.atEnd())
+    {
+        LL_WARNS("XMLNode") << "Ignoring damaged XML cache " << filename << LL_ENDL;
+        return false;
+    }
+
+    // entries built this session are newer
+    for (auto& entry : entries)
+    {
+        mEntries.insert(std::move(entry));
+    }
+    LL_INFOS("XMLNode") << "Loaded " << entries.size() << " cached XML trees from " << filename << LL_ENDL;
+    return true;
+}
+
+bool LLLayeredXMLCache::saveToFile(const std::string& filename) const
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    Writer writer;
+    for (char c : CACHE_MAGIC)
+    {
+        writer.put(c);
+    }
+    writer.put(CACHE_FORMAT_VERSION);
+    // loaded entries nobody asked for, e.g. of another skin, are dropped
+    U32 count = 0;
+    for (const auto& entry : mEntries)
+    {
+        count += entry.second.mVerified;
+    }
+    writer.put(count);
+    for (const auto& entry : mEntries)
+    {
+        if (!entry.second.mVerified)
+        {
+            continue;
+        }
+        writer.putString(entry.first);
+        writer.put((U32)entry.second.mLayers.size());
+        for (const Layer& layer : entry.second.mLayers)
+        {
+            writer.putString(layer.mPath);
+            writer.put(layer.mModified);
+            writer.put(layer.mSize);
+        }
+        writer.putNode(entry.second.mRoot);
+    }
+
+    llofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    const std::string& buffer = writer.getBuffer();
+    if (!file.is_open() || !file.write(buffer.data(), buffer.size()))
+    {
+        LL_WARNS("XMLNode") << "Could not write XML cache " << filename << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+
+// static
+LLXMLNodePtr LLLayeredXMLCache::copyTree(const LLXMLNode* node)
+{
+    LLXMLNodePtr copy = new LLXMLNode(*node);
+    copy->mLineNumber = node->mLineNumber;
+    copy_below(node, copy);
+    return copy;
+}
+
+// static
+std::string LLLayeredXMLCache::makeKey(const std::vector<std::string>& paths)
+{
+    std::string key;
+    for (const std::string& path : paths)
+    {
+        key.append(path);
+        key.push_back('\n');
+    }
+    return key;
+}
+
+// static
+bool LLLayeredXMLCache::statLayers(const std::vector<std::string>& paths, std::vector<Layer>& layers)
+{
+    layers.clear();
+    for (const std::string& path : paths)
+    {
+        // the files LLXMLNode::getLayeredXMLNode() skips
+        if (path.empty() || (!layers.empty() && path == layers.front().mPath))
+        {
+            continue;
+        }
+        llstat status;
+        if (LLFile::stat(path, &status))
+        {
+            return false;
+        }
+        layers.push_back({ path, (S64)status.st_mtime, (U64)status.st_size });
+    }
+    return !layers.empty();
+}
+
+// static
+bool LLLayeredXMLCache::layersUnchanged(const std::vector<Layer>& layers)
+{
+    for (const Layer& layer : layers)
+    {
+        llstat status;
+        if (LLFile::stat(layer.mPath, &status)
+            || (S64)status.st_mtime != layer.mModified
+            || (U64)status.st_size != layer.mSize)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file lllayeredxmlcache.h
+ * @brief Cache of merged skin and language XML layers.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLLAYEREDXMLCACHE_H
+#define LL_LLLAYEREDXMLCACHE_H
+
+#include "llxmlnode.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLLayeredXMLCache
+//
+//   Keeps the trees LLXMLNode::getLayeredXMLNode() builds, keyed by the list
+//   of layer files, so the default, skin and language files are read and
+//   merged once. Callers get their own copy of the tree since some of them
+//   edit it.
+//
+//   The cache can be saved to a binary file. Entries loaded from one are
+//   checked against the modification time and size of their layer files the
+//   first time they are asked for, and parsed again if a file changed.
+//   Saving leaves out the loaded entries that were not asked for.
+//
+//   Not thread safe, like the UI code using it.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+class LLLayeredXMLCache
+{
+public:
+    LLLayeredXMLCache();
+
+    // Disabling it empties the cache, getLayeredXMLNode() then always parses
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return mEnabled; }
+
+    // Same result as LLXMLNode::getLayeredXMLNode()
+    bool getLayeredXMLNode(LLXMLNodePtr& root, const std::vector<std::string>& paths);
+
+    void clear();
+    size_t size() const { return mEntries.size(); }
+    U32 getHitCount() const { return mHitCount; }
+    U32 getMissCount() const { return mMissCount; }
+
+    // Adds the entries of the file to the cache, returns false if it is
+    // missing, truncated or of another format version
+    bool loadFromFile(const std::string& filename);
+    bool saveToFile(const std::string& filename) const;
+
+    // Copy of node and everything below it, keeping the order of the children
+    // and line numbers, unlike LLXMLNode::deepCopy()
+    static LLXMLNodePtr copyTree(const LLXMLNode* node);
+
+private:
+    struct Layer
+    {
+        std::string mPath;
+        S64 mModified;
+        U64 mSize;
+    };
+
+    struct Entry
+    {
+        std::vector<Layer> mLayers;
+        LLXMLNodePtr mRoot;
+        bool mVerified;     // layer files checked this session
+    };
+
+    typedef std::unordered_map<std::string, Entry> entry_map_t;
+
+    static std::string makeKey(const std::vector<std::string>& paths);
+    // The files getLayeredXMLNode() reads for paths, with their current
+    // time and size; false if one of them is missing
+    static bool statLayers(const std::vector<std::string>& paths, std::vector<Layer>& layers);
+    static bool layersUnchanged(const std::vector<Layer>& layers);
+
+    entry_map_t mEntries;
+    U32 mHitCount;
+    U32 mMissCount;
+    bool mEnabled;
+};
+
+#endif // LL_LLLAYEREDXMLCACHE_H
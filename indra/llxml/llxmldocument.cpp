@@ -0,0 +1,324 @@
+/**
+ * @file llxmldocument.cpp
+ * @brief Read only XML DOM kept in one arena per document.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llxmldocument.h"
+
+#include "llfile.h"
+#include "llxmlnode.h"
+
+#include <expat.h>
+
+namespace
+{
+    constexpr size_t MIN_BLOCK_SIZE = 1024;
+    constexpr size_t MAX_BLOCK_SIZE = 64 * 1024;
+}
+
+//-----------------------------------------------------------------------------
+// LLXMLDocumentNode
+//-----------------------------------------------------------------------------
+
+const LLXMLDocumentAttribute* LLXMLDocumentNode::getAttribute(const LLStringTableEntry* name) const
+{
+    for (U32 i = 0; i < mAttributeCount; ++i)
+    {
+        if (mAttributes[i].mName == name)
+        {
+            return &mAttributes[i];
+        }
+    }
+    return nullptr;
+}
+
+const LLXMLDocumentAttribute* LLXMLDocumentNode::getAttribute(const char* name) const
+{
+    // a name nobody interned is on no node
+    const LLStringTableEntry* entry = gStringTable.checkStringEntry(name);
+    return entry ? getAttribute(entry) : nullptr;
+}
+
+bool LLXMLDocumentNode::getAttributeString(const char* name, std::string& value) const
+{
+    const LLXMLDocumentAttribute* attribute = getAttribute(name);
+    if (!attribute)
+    {
+        return false;
+    }
+    value.assign(attribute->mValue, attribute->mLength);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// LLXMLDocument
+//-----------------------------------------------------------------------------
+
+// The open elements while expat runs. Text is collected per element and
+// copied into the arena when the element closes, since it may come in
+// several pieces around the child elements.
+struct LLXMLDocument::ParseState
+{
+    struct Open
+    {
+        LLXMLDocumentNode* mNode;
+        LLXMLDocumentNode* mLastChild;
+        std::string mText;
+    };
+
+    LLXMLDocument* mDocument;
+    XML_Parser mParser;
+    std::vector<Open> mOpen;    // grows only, to keep the text buffers
+    size_t mDepth;
+
+    void startElement(const char* name, const char** atts)
+    {
+        LLXMLDocumentNode* node = static_cast<LLXMLDocumentNode*>(mDocument->allocate(sizeof(LLXMLDocumentNode), alignof(LLXMLDocumentNode)));
+        node->mName = gStringTable.addStringEntry(name);
+        node->mValue = "";
+        node->mLength = 0;
+        node->mLineNumber = (S32)XML_GetCurrentLineNumber(mParser);
+        node->mFirstChild = nullptr;
+        node->mNextSibling = nullptr;
+
+        U32 count = 0;
+        while (atts[count * 2])
+        {
+            ++count;
+        }
+        LLXMLDocumentAttribute* attributes = nullptr;
+        if (count)
+        {
+            attributes = static_cast<LLXMLDocumentAttribute*>(mDocument->allocate(sizeof(LLXMLDocumentAttribute) * count, alignof(LLXMLDocumentAttribute)));
+            for (U32 i = 0; i < count; ++i)
+            {
+                const char* value = atts[i * 2 + 1];
+                const size_t length = strlen(value);
+                attributes[i].mName = gStringTable.addStringEntry(atts[i * 2]);
+                attributes[i].mValue = mDocument->copyString(value, length);
+                attributes[i].mLength = (U32)length;
+            }
+        }
+        node->mAttributeCount = count;
+        node->mAttributes = attributes;
+
+        if (mDepth)
+        {
+            Open& parent = mOpen[mDepth - 1];
+            node->mParent = parent.mNode;
+            if (parent.mLastChild)
+            {
+                parent.mLastChild->mNextSibling = node;
+            }
+            else
+            {
+                parent.mNode->mFirstChild = node;
+            }
+            parent.mLastChild = node;
+        }
+        else
+        {
+            node->mParent = nullptr;
+            mDocument->mRoot = node;
+        }
+
+        if (mOpen.size() == mDepth)
+        {
+            mOpen.emplace_back();
+        }
+        Open& open = mOpen[mDepth++];
+        open.mNode = node;
+        open.mLastChild = nullptr;
+        open.mText.clear();
+    }
+
+    // Strips whitespace only values like EndXMLNode() does
+    void endElement()
+    {
+        Open& open = mOpen[--mDepth];
+        std::string& text = open.mText;
+        if (LLXMLNode::sStripWhitespaceValues && text.find_first_not_of(" \t\n") == std::string::npos)
+        {
+            text.clear();
+        }
+        if (!text.empty())
+        {
+            open.mNode->mValue = mDocument->copyString(text.data(), text.size());
+            open.mNode->mLength = (U32)text.size();
+        }
+    }
+
+    // Same unescaping of quoted pieces as XMLData()
+    void characterData(const char* s, int len)
+    {
+        if (!mDepth)
+        {
+            return;
+        }
+        std::string& text = mOpen[mDepth - 1].mText;
+        if (LLXMLNode::sStripEscapedStrings && s[0] == '\"' && s[len - 1] == '\"')
+        {
+            for (S32 pos = 1; pos < len - 1; ++pos)
+            {
+                if (s[pos] == '\\' && (s[pos + 1] == '\\' || s[pos + 1] == '\"'))
+                {
+                    text.push_back(s[pos + 1]);
+                    ++pos;
+                }
+                else
+                {
+                    text.push_back(s[pos]);
+                }
+            }
+            return;
+        }
+        text.append(s, len);
+    }
+
+    static void XMLCALL startElementCallback(void* user_data, const XML_Char* name, const XML_Char** atts)
+    {
+        static_cast<ParseState*>(user_data)->startElement(name, atts);
+    }
+
+    static void XMLCALL endElementCallback(void* user_data, const XML_Char* name)
+    {
+        static_cast<ParseState*>(user_data)->endElement();
+    }
+
+    static void XMLCALL characterDataCallback(void* user_data, const XML_Char* s, int len)
+    {
+        static_cast<ParseState*>(user_data)->characterData(s, len);
+    }
+};
+
+LLXMLDocument::LLXMLDocument() :
+    mBlockPos(nullptr),
+    mBlockLeft(0),
+    mNextBlockSize(MIN_BLOCK_SIZE),
+    mArenaSize(0),
+    mRoot(nullptr)
+{
+}
+
+LLXMLDocument::~LLXMLDocument()
+{
+}
+
+bool LLXMLDocument::parseFile(const std::string& filename)
+{
+    std::string xml = LLFile::getContents(filename);
+    if (xml.empty())
+    {
+        LL_WARNS("XMLNode") << "no XML file: " << filename << LL_ENDL;
+        clear();
+        return false;
+    }
+    return parseBuffer(xml.data(), xml.size());
+}
+
+bool LLXMLDocument::parseBuffer(const char* buffer, U64 length)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    clear();
+    // small files are common, size the first block after the text
+    mNextBlockSize = llclamp((size_t)length * 2, MIN_BLOCK_SIZE, MAX_BLOCK_SIZE);
+
+    // thread_local keeps the text buffers of the open elements between
+    // documents
+    static thread_local ParseState state;
+    state.mDocument = this;
+    state.mParser = XML_ParserCreate(NULL);
+    state.mDepth = 0;
+    XML_SetElementHandler(state.mParser, ParseState::startElementCallback, ParseState::endElementCallback);
+    XML_SetCharacterDataHandler(state.mParser, ParseState::characterDataCallback);
+    XML_SetUserData(state.mParser, &state);
+
+    bool success = XML_STATUS_OK == XML_Parse(state.mParser, buffer, (int)length, true);
+    if (!success)
+    {
+        LL_WARNS("XMLNode") << "Error parsing xml error code: "
+                            << XML_ErrorString(XML_GetErrorCode(state.mParser))
+                            << " on line " << XML_GetCurrentLineNumber(state.mParser)
+                            << ", column " << XML_GetCurrentColumnNumber(state.mParser)
+                            << LL_ENDL;
+    }
+    XML_ParserFree(state.mParser);
+    state.mParser = nullptr;
+    state.mDocument = nullptr;
+
+    if (!success || !mRoot)
+    {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void LLXMLDocument::clear()
+{
+    mBlocks.clear();
+    mBlockPos = nullptr;
+    mBlockLeft = 0;
+    mArenaSize = 0;
+    mRoot = nullptr;
+}
+
+void* LLXMLDocument::allocate(size_t size, size_t alignment)
+{
+    size_t padding = (alignment - (uintptr_t)mBlockPos % alignment) % alignment;
+    if (!mBlockPos || padding + size > mBlockLeft)
+    {
+        // a string too big for a block gets one of its own, the current
+        // block stays open
+        const size_t block_size = llmax(mNextBlockSize, size + alignment);
+        mBlocks.emplace_back(new char[block_size]);
+        mArenaSize += block_size;
+        char* block = mBlocks.back().get();
+        if (block_size > mNextBlockSize)
+        {
+            padding = (alignment - (uintptr_t)block % alignment) % alignment;
+            return block + padding;
+        }
+        mBlockPos = block;
+        mBlockLeft = block_size;
+        mNextBlockSize = llmin(mNextBlockSize * 2, MAX_BLOCK_SIZE);
+        padding = (alignment - (uintptr_t)mBlockPos % alignment) % alignment;
+    }
+    void* result = mBlockPos + padding;
+    mBlockPos += padding + size;
+    mBlockLeft -= padding + size;
+    return result;
+}
+
+const char* LLXMLDocument::copyString(const char* str, size_t length)
+{
+    char* copy = static_cast<char*>(allocate(length + 1, 1));
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
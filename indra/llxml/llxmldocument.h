@@ -0,0 +1,125 @@
+/**
+ * @file llxmldocument.h
+ * @brief Read only XML DOM kept in one arena per document.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLXMLDOCUMENT_H
+#define LL_LLXMLDOCUMENT_H
+
+#include "llstringtable.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class LLXMLDocument;
+
+struct LLXMLDocumentAttribute
+{
+    const LLStringTableEntry* mName;
+    const char* mValue;     // nul terminated
+    U32 mLength;
+};
+
+// An element of an LLXMLDocument. Names are LLStringTable entries like
+// LLXMLNode's, so they compare by pointer; values read the same as
+// LLXMLNode::getValue() would for the same file.
+class LLXMLDocumentNode
+{
+public:
+    const LLStringTableEntry* getName() const { return mName; }
+    bool hasName(const char* name) const { return mName == gStringTable.checkStringEntry(name); }
+    std::string_view getValue() const { return std::string_view(mValue, mLength); }
+    S32 getLineNumber() const { return mLineNumber; }
+
+    const LLXMLDocumentNode* getParent() const { return mParent; }
+    const LLXMLDocumentNode* getFirstChild() const { return mFirstChild; }
+    const LLXMLDocumentNode* getNextSibling() const { return mNextSibling; }
+
+    U32 getAttributeCount() const { return mAttributeCount; }
+    const LLXMLDocumentAttribute* getAttributes() const { return mAttributes; }
+    const LLXMLDocumentAttribute* getAttribute(const LLStringTableEntry* name) const;
+    const LLXMLDocumentAttribute* getAttribute(const char* name) const;
+    bool getAttributeString(const char* name, std::string& value) const;
+
+private:
+    friend class LLXMLDocument;
+
+    const LLStringTableEntry* mName;
+    const char* mValue;
+    U32 mLength;
+    S32 mLineNumber;
+    U32 mAttributeCount;
+    const LLXMLDocumentAttribute* mAttributes;
+    const LLXMLDocumentNode* mParent;
+    const LLXMLDocumentNode* mFirstChild;
+    const LLXMLDocumentNode* mNextSibling;
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLXMLDocument
+//
+//   A parsed XML file for code that only reads it. The nodes, attributes and
+//   strings are carved out of large blocks owned by the document and are all
+//   freed with it, instead of being a ref counted LLXMLNode each, with an
+//   LLXMLNode per attribute and a map entry per child.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+class LLXMLDocument
+{
+public:
+    LLXMLDocument();
+    ~LLXMLDocument();
+
+    LLXMLDocument(const LLXMLDocument&) = delete;
+    LLXMLDocument& operator=(const LLXMLDocument&) = delete;
+
+    // Replace the document, which is left empty on failure
+    bool parseFile(const std::string& filename);
+    bool parseBuffer(const char* buffer, U64 length);
+
+    // Frees every node at once
+    void clear();
+
+    const LLXMLDocumentNode* getRoot() const { return mRoot; }
+    // Bytes of the blocks holding the document
+    size_t getArenaSize() const { return mArenaSize; }
+
+private:
+    struct ParseState;
+
+    void* allocate(size_t size, size_t alignment);
+    const char* copyString(const char* str, size_t length);
+
+    std::vector<std::unique_ptr<char[]> > mBlocks;
+    char* mBlockPos;
+    size_t mBlockLeft;
+    size_t mNextBlockSize;      // doubles up to a limit
+    size_t mArenaSize;
+    const LLXMLDocumentNode* mRoot;
+};
+
+#endif // LL_LLXMLDOCUMENT_H
@@ -44,6 +44,7 @@
 #include "llstring.h"
 #include "lluuid.h"
 #include "lldir.h"
+#include "llxmldocument.h" // <FS> Arena XML DOM
 
 // static
 bool LLXMLNode::sStripEscapedStrings = true;
@@ -569,6 +570,64 @@ void XMLCALL XMLData(void *userData,
 
 
 
+// <FS> Arena XML DOM
+namespace
+{
+    // Updates every child of node with the child of update_node that has the
+    // same name, or the same value for nameless ones like combo box items.
+    // UPDATE_PTR is an LLXMLNodePtr or a const LLXMLDocumentNode*.
+    template <typename UPDATE_PTR>
+    void update_matching_children(LLXMLNodePtr& node, const UPDATE_PTR& update_node)
+    {
+        LLXMLNodePtr child = node->getFirstChild();
+        LLXMLNodePtr last_child = child;
+
+        for (UPDATE_PTR updateChild = update_node->getFirstChild(); updateChild;
+             updateChild = updateChild->getNextSibling())
+        {
+            while(child.notNull())
+            {
+                std::string nodeName;
+                std::string updateName;
+
+                updateChild->getAttributeString("name", updateName);
+                child->getAttributeString("name", nodeName);
+
+
+                //if it's a combobox there's no name, but there is a value
+                if (updateName.empty())
+                {
+                    updateChild->getAttributeString("value", updateName);
+                    child->getAttributeString("value", nodeName);
+                }
+
+                if ((nodeName != "") && (updateName == nodeName))
+                {
+                    LLXMLNode::updateNode(child, updateChild);
+                    last_child = child;
+                    child = child->getNextSibling();
+                    if (child.isNull())
+                    {
+                        child = node->getFirstChild();
+                    }
+                    break;
+                }
+
+                child = child->getNextSibling();
+                if (child.isNull())
+                {
+                    child = node->getFirstChild();
+                }
+                if (child == last_child)
+                {
+                    break;
+                }
+            }
+        }
+    }
+}
+// </FS>
+
 // static
 bool LLXMLNode::updateNode(
     LLXMLNodePtr& node,
@@ -602,56 +661,47 @@ bool LLXMLNode::updateNode(
         }
     }
 
-    //update all of node's children with updateNodes children that match name
-    LLXMLNodePtr child = node->getFirstChild();
-    LLXMLNodePtr last_child = child;
-    LLXMLNodePtr updateChild;
+    // <FS> Arena XML DOM
+    update_matching_children(node, update_node);
+    // </FS>
 
-    for (updateChild = update_node->getFirstChild(); updateChild.notNull();
-         updateChild = updateChild->getNextSibling())
-    {
-        while(child.notNull())
-        {
-            std::string nodeName;
-            std::string updateName;
+    return true;
+}
 
-            updateChild->getAttributeString("name", updateName);
-            child->getAttributeString("name", nodeName);
+// <FS> Arena XML DOM
+// static
+bool LLXMLNode::updateNode(
+    LLXMLNodePtr& node,
+    const LLXMLDocumentNode* update_node)
+{
+    if (!node || !update_node)
+    {
+        LL_WARNS() << "Node invalid" << LL_ENDL;
+        return false;
+    }
 
+    //update the node value
+    node->mValue = update_node->getValue();
 
-            //if it's a combobox there's no name, but there is a value
-            if (updateName.empty())
-            {
-                updateChild->getAttributeString("value", updateName);
-                child->getAttributeString("value", nodeName);
-            }
+    //update all attribute values
+    const LLXMLDocumentAttribute* update_attributes = update_node->getAttributes();
+    for (U32 i = 0; i < update_node->getAttributeCount(); ++i)
+    {
+        LLXMLNodePtr attribNode;
 
-            if ((nodeName != "") && (updateName == nodeName))
-            {
-                updateNode(child, updateChild);
-                last_child = child;
-                child = child->getNextSibling();
-                if (child.isNull())
-                {
-                    child = node->getFirstChild();
-                }
-                break;
-            }
+        node->getAttribute(update_attributes[i].mName, attribNode, 0);
 
-            child = child->getNextSibling();
-            if (child.isNull())
-            {
-                child = node->getFirstChild();
-            }
-            if (child == last_child)
-            {
-                break;
-            }
+        if (attribNode)
+        {
+            attribNode->mValue.assign(update_attributes[i].mValue, update_attributes[i].mLength);
         }
     }
 
+    update_matching_children(node, update_node);
+
     return true;
 }
+// </FS>
 
 // static
 bool LLXMLNode::parseFile(const std::string& filename, LLXMLNodePtr& node, LLXMLNode* defaults_tree)
@@ -857,7 +907,11 @@ bool LLXMLNode::getLayeredXMLNode(LLXMLNodePtr& root,
         return false;
     }
 
-    LLXMLNodePtr updateRoot;
+    // <FS> Arena XML DOM
+    //LLXMLNodePtr updateRoot;
+    // the layers are only read while merging
+    LLXMLDocument updateDocument;
+    // </FS>
 
     std::vector<std::string>::const_iterator itor;
 
@@ -871,11 +925,15 @@ bool LLXMLNode::getLayeredXMLNode(LLXMLNodePtr& root,
             continue;
         }
 
-        if (!LLXMLNode::parseFile(layer_filename, updateRoot, NULL))
+        // <FS> Arena XML DOM
+        //if (!LLXMLNode::parseFile(layer_filename, updateRoot, NULL))
+        if (!updateDocument.parseFile(layer_filename))
+        // </FS>
         {
             LL_WARNS() << "Problem reading localized UI description file: " << layer_filename << LL_ENDL;
             return false;
         }
+        const LLXMLDocumentNode* updateRoot = updateDocument.getRoot(); // <FS> Arena XML DOM
 
         std::string nodeName;
         std::string updateName;
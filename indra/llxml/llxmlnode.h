@@ -77,6 +77,7 @@ typedef std::map<const LLStringTableEntry *, LLXMLNodePtr, CompareAttributes> LL
 
 class LLColor4;
 class LLColor4U;
+class LLXMLDocumentNode; // <FS> Arena XML DOM
 class LLQuaternion;
 class LLVector3;
 class LLVector3d;
@@ -147,6 +148,12 @@ public:
     static bool updateNode(
         LLXMLNodePtr& node,
         LLXMLNodePtr& update_node);
+    // <FS> Arena XML DOM
+    // Same merge, from a layer that is only read
+    static bool updateNode(
+        LLXMLNodePtr& node,
+        const LLXMLDocumentNode* update_node);
+    // </FS>
 
     static bool getLayeredXMLNode(LLXMLNodePtr& root, const std::vector<std::string>& paths);
 
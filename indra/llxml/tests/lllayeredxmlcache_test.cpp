@@ -0,0 +1,231 @@
+/**
+ * @file lllayeredxmlcache_test.cpp
+ * @brief LLLayeredXMLCache tests and benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llfile.h"
+#include "llformat.h"
+
+#include "../lllayeredxmlcache.h"
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    void write_file(const std::string& filename, const std::string& contents)
+    {
+        llofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        file << contents;
+    }
+
+    std::string to_string(LLXMLNodePtr node)
+    {
+        std::ostringstream str;
+        node->writeToOstream(str);
+        return str.str();
+    }
+
+    // A floater with a tab container of panels full of controls
+    std::string make_floater(S32 panels, S32 controls, const char* label)
+    {
+        std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\n"
+                          "<floater name=\"test\" title=\"Test\" width=\"600\" height=\"400\">\n"
+                          " <tab_container name=\"tabs\" follows=\"all\">\n";
+        for (S32 panel = 0; panel < panels; ++panel)
+        {
+            xml += llformat("  <panel name=\"panel%d\" label=\"%s panel %d\" layout=\"topleft\">\n", panel, label, panel);
+            for (S32 control = 0; control < controls; ++control)
+            {
+                xml += llformat("   <check_box name=\"check%d\" label=\"%s %d\" control_name=\"Setting%d\" top_pad=\"4\" left=\"10\" width=\"200\" height=\"16\"/>\n",
+                                control, label, control, control);
+                xml += llformat("   <text name=\"text%d\" follows=\"left|top\" width=\"300\">%s text %d</text>\n", control, label, control);
+            }
+            xml += "  </panel>\n";
+        }
+        xml += " </tab_container>\n</floater>\n";
+        return xml;
+    }
+}
+
+namespace tut
+{
+    struct layeredxmlcache_data
+    {
+        layeredxmlcache_data()
+        {
+            const std::string dir = LLFile::tmpdir();
+            mBase = dir + "lllayeredxmlcache_test_en.xml";
+            mLocal = dir + "lllayeredxmlcache_test_de.xml";
+            mCache = dir + "lllayeredxmlcache_test.bin";
+            mPaths = { mBase, mLocal };
+        }
+
+        ~layeredxmlcache_data()
+        {
+            LLFile::remove(mBase, ENOENT);
+            LLFile::remove(mLocal, ENOENT);
+            LLFile::remove(mCache, ENOENT);
+        }
+
+        std::string mBase;
+        std::string mLocal;
+        std::string mCache;
+        std::vector<std::string> mPaths;
+    };
+    typedef test_group<layeredxmlcache_data> layeredxmlcache_test;
+    typedef layeredxmlcache_test::object layeredxmlcache_object;
+    tut::layeredxmlcache_test layeredxmlcache_testcase("LLLayeredXMLCache");
+
+    template<> template<>
+    void layeredxmlcache_object::test<1>()
+    {
+        set_test_name("same trees as parsing, private copies");
+        write_file(mBase, make_floater(3, 5, "English"));
+        write_file(mLocal, make_floater(2, 5, "Deutsch"));
+
+        LLXMLNodePtr parsed;
+        ensure("parsed", LLXMLNode::getLayeredXMLNode(parsed, mPaths));
+
+        LLLayeredXMLCache cache;
+        LLXMLNodePtr first;
+        ensure("first", cache.getLayeredXMLNode(first, mPaths));
+        ensure_equals("first parses", cache.getMissCount(), 1U);
+        ensure_equals("same as parsed", to_string(first), to_string(parsed));
+
+        // callers may edit what they get
+        first->setAttributeString("title", "Changed");
+        first->deleteChild(first->getFirstChild());
+
+        LLXMLNodePtr second;
+        ensure("second", cache.getLayeredXMLNode(second, mPaths));
+        ensure_equals("second is cached", cache.getHitCount(), 1U);
+        ensure_equals("not edited", to_string(second), to_string(parsed));
+        ensure_equals("line numbers kept", second->getFirstChild()->getFirstChild()->getLineNumber(),
+                      parsed->getFirstChild()->getFirstChild()->getLineNumber());
+
+        LLXMLNodePtr missing;
+        ensure("missing file", !cache.getLayeredXMLNode(missing, { mBase + ".missing" }));
+        ensure_equals("failures not cached", cache.size(), size_t(1));
+
+        cache.setEnabled(false);
+        ensure_equals("emptied", cache.size(), size_t(0));
+        ensure("disabled", cache.getLayeredXMLNode(second, mPaths));
+        ensure_equals("disabled parses", to_string(second), to_string(parsed));
+        ensure_equals("nothing kept", cache.size(), size_t(0));
+    }
+
+    template<> template<>
+    void layeredxmlcache_object::test<2>()
+    {
+        set_test_name("saved cache is checked against the files");
+        write_file(mBase, make_floater(2, 4, "English"));
+        write_file(mLocal, make_floater(2, 4, "Deutsch"));
+
+        LLXMLNodePtr parsed;
+        {
+            LLLayeredXMLCache cache;
+            ensure("parsed", cache.getLayeredXMLNode(parsed, mPaths));
+            ensure("saved", cache.saveToFile(mCache));
+        }
+
+        LLLayeredXMLCache cache;
+        ensure("loaded", cache.loadFromFile(mCache));
+        ensure_equals("entries", cache.size(), size_t(1));
+        LLXMLNodePtr loaded;
+        ensure("from file", cache.getLayeredXMLNode(loaded, mPaths));
+        ensure_equals("hit", cache.getHitCount(), 1U);
+        ensure_equals("same as parsed", to_string(loaded), to_string(parsed));
+
+        // a translation update is picked up by the next session
+        write_file(mLocal, make_floater(2, 4, "Neu"));
+        ensure("saved again", cache.saveToFile(mCache));
+        LLLayeredXMLCache next;
+        ensure("loaded again", next.loadFromFile(mCache));
+        ensure("reparsed", next.getLayeredXMLNode(loaded, mPaths));
+        ensure_equals("miss", next.getMissCount(), 1U);
+        ensure("new text", to_string(loaded).find("Neu text") != std::string::npos);
+
+        // damaged files are ignored
+        std::string contents = LLFile::getContents(mCache);
+        {
+            // magic, version and entry count, then the key and the layer count
+            std::string damaged = contents;
+            U32 key_size = 0;
+            memcpy(&key_size, &damaged[16], sizeof(key_size));
+            const U32 layer_count = 0xFFFFFFF0;
+            memcpy(&damaged[20 + key_size], &layer_count, sizeof(layer_count));
+            write_file(mCache, damaged);
+            ensure("bad layer count", !next.loadFromFile(mCache));
+        }
+        write_file(mCache, contents.substr(0, contents.size() / 2));
+        ensure("truncated", !next.loadFromFile(mCache));
+        write_file(mCache, "not a cache");
+        ensure("garbage", !next.loadFromFile(mCache));
+    }
+
+    template<> template<>
+    void layeredxmlcache_object::test<3>()
+    {
+        set_test_name("benchmark");
+
+        skip_unless_benchmarks();
+        write_file(mBase, make_floater(20, 40, "English"));
+        write_file(mLocal, make_floater(20, 40, "Deutsch"));
+        const S32 ROUNDS = 50;
+
+        typedef std::chrono::steady_clock clock;
+        auto start = clock::now();
+        for (S32 i = 0; i < ROUNDS; ++i)
+        {
+            LLXMLNodePtr root;
+            LLXMLNode::getLayeredXMLNode(root, mPaths);
+        }
+        auto parsed = clock::now();
+
+        LLLayeredXMLCache cache;
+        for (S32 i = 0; i < ROUNDS; ++i)
+        {
+            LLXMLNodePtr root;
+            cache.getLayeredXMLNode(root, mPaths);
+        }
+        auto cached = clock::now();
+
+        ensure("saved", cache.saveToFile(mCache));
+        auto saved = clock::now();
+        LLLayeredXMLCache loaded;
+        ensure("loaded", loaded.loadFromFile(mCache));
+        auto load_done = clock::now();
+
+        std::cout << "\nLayered XML, 2 layers of " << LLFile::getContents(mBase).size() / 1024 << " KB:\n"
+                  << "  parse and merge " << std::chrono::duration<F64, std::milli>(parsed - start).count() / ROUNDS << " ms\n"
+                  << "  cached copy     " << std::chrono::duration<F64, std::milli>(cached - parsed).count() / ROUNDS << " ms\n"
+                  << "  save " << std::chrono::duration<F64, std::milli>(saved - cached).count()
+                  << " ms, load " << std::chrono::duration<F64, std::milli>(load_done - saved).count() << " ms" << std::endl;
+    }
+}
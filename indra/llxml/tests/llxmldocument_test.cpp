@@ -0,0 +1,479 @@
+/**
+ * @file llxmldocument_test.cpp
+ * @brief LLXMLDocument tests and skin parse benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llfile.h"
+
+#include "../llxmldocument.h"
+#include "../llxmlnode.h"
+#include "../test/lltut.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+// Count live heap bytes through operator new, which is where LLXMLNodes,
+// their maps and strings and the document blocks come from.
+#if !((TRACY_ENABLE) && LL_PROFILER_ENABLE_TRACY_MEMORY)
+static std::atomic<S64> sLiveBytes{ 0 };
+static std::atomic<S64> sPeakBytes{ 0 };
+
+static constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+void* operator new(size_t size)
+{
+    char* ptr = (char*)(malloc)(size + HEADER_SIZE);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    *(size_t*)ptr = size;
+    S64 live = (sLiveBytes += (S64)size);
+    S64 peak = sPeakBytes.load();
+    while (live > peak && !sPeakBytes.compare_exchange_weak(peak, live))
+    {
+    }
+    return ptr + HEADER_SIZE;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr)
+    {
+        char* block = (char*)ptr - HEADER_SIZE;
+        sLiveBytes -= (S64)*(size_t*)block;
+        (free)(block);
+    }
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+static S64 live_bytes()
+{
+    return sLiveBytes.load();
+}
+
+static void reset_peak_bytes()
+{
+    sPeakBytes = sLiveBytes.load();
+}
+
+static S64 peak_bytes()
+{
+    return sPeakBytes.load();
+}
+#else
+static S64 live_bytes()
+{
+    return 0;
+}
+
+static void reset_peak_bytes()
+{
+}
+
+static S64 peak_bytes()
+{
+    return 0;
+}
+#endif
+
+namespace
+{
+    const char SAMPLE[] =
+        "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\n"
+        "<floater name=\"sample\" title=\"Sample &amp; more\" version=\"1.2\">\n"
+        "  <text name=\"plain\">Some text</text>\n"
+        "  <text name=\"quoted\">\"a \\\"quoted\\\" \\\\ string\"</text>\n"
+        "  <panel name=\"mixed\">before<check_box name=\"inner\" enabled=\"false\"/>after &lt;3</panel>\n"
+        "  <combo_box>\n"
+        "    <combo_box.item label=\"One\" value=\"1\"/>\n"
+        "    <combo_box.item label=\"Two\" value=\"2\"/>\n"
+        "  </combo_box>\n"
+        "  <string name=\"multi\">line one\n"
+        "line two\n"
+        "line three</string>\n"
+        "  <empty/>\n"
+        "</floater>\n";
+
+    // Differences between the two parses of the same file, empty if none
+    std::string compare(const LLXMLNode* node, const LLXMLDocumentNode* doc_node, const std::string& path = std::string())
+    {
+        const std::string here = path + "/" + node->getName()->mString;
+        if (node->getName() != doc_node->getName())
+        {
+            return here + ": name " + doc_node->getName()->mString;
+        }
+        if (node->getValue() != doc_node->getValue())
+        {
+            return here + ": value '" + std::string(doc_node->getValue()) + "' instead of '" + node->getValue() + "'";
+        }
+        if (const_cast<LLXMLNode*>(node)->getLineNumber() != doc_node->getLineNumber())
+        {
+            return here + ": line number";
+        }
+        if (node->mAttributes.size() != doc_node->getAttributeCount())
+        {
+            return here + ": attribute count";
+        }
+        for (const auto& attribute : node->mAttributes)
+        {
+            const LLXMLDocumentAttribute* doc_attribute = doc_node->getAttribute(attribute.first);
+            if (!doc_attribute || attribute.second->getValue() != doc_attribute->mValue)
+            {
+                return here + ": attribute " + attribute.first->mString;
+            }
+        }
+        const LLXMLDocumentNode* doc_child = doc_node->getFirstChild();
+        for (LLXMLNodePtr child = node->getFirstChild(); child.notNull(); child = child->getNextSibling())
+        {
+            if (!doc_child)
+            {
+                return here + ": missing child";
+            }
+            if (doc_child->getParent() != doc_node)
+            {
+                return here + ": parent";
+            }
+            std::string difference = compare(child, doc_child, here);
+            if (!difference.empty())
+            {
+                return difference;
+            }
+            doc_child = doc_child->getNextSibling();
+        }
+        return doc_child ? here + ": extra child" : std::string();
+    }
+
+    std::string to_string(LLXMLNodePtr node)
+    {
+        std::ostringstream str;
+        node->writeToOstream(str);
+        return str.str();
+    }
+
+    void write_file(const std::string& filename, const std::string& contents)
+    {
+        llofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        file << contents;
+    }
+}
+
+namespace tut
+{
+    struct xmldocument_data
+    {
+    };
+    typedef test_group<xmldocument_data> xmldocument_test;
+    typedef xmldocument_test::object xmldocument_object;
+    tut::xmldocument_test xmldocument_testcase("LLXMLDocument");
+
+    template<> template<>
+    void xmldocument_object::test<1>()
+    {
+        set_test_name("reads like LLXMLNode");
+        for (bool strip : { true, false })
+        {
+            LLXMLNode::sStripEscapedStrings = strip;
+            LLXMLNode::sStripWhitespaceValues = strip;
+
+            LLXMLNodePtr root;
+            ensure("LLXMLNode parse", LLXMLNode::parseBuffer(SAMPLE, sizeof(SAMPLE) - 1, root));
+            LLXMLDocument document;
+            ensure("document parse", document.parseBuffer(SAMPLE, sizeof(SAMPLE) - 1));
+            ensure("root", document.getRoot() && document.getRoot()->hasName("floater"));
+            ensure_equals("same tree", compare(root, document.getRoot()), std::string());
+
+            std::string value;
+            ensure("attribute", document.getRoot()->getAttributeString("title", value));
+            ensure_equals("entity", value, std::string("Sample & more"));
+            ensure("no such attribute", !document.getRoot()->getAttributeString("no_such_attribute_anywhere", value));
+        }
+        LLXMLNode::sStripEscapedStrings = true;
+        LLXMLNode::sStripWhitespaceValues = false;
+
+        LLXMLDocument document;
+        ensure("malformed", !document.parseBuffer("<a><b></a>", 10));
+        ensure("emptied", !document.getRoot() && !document.getArenaSize());
+    }
+
+    template<> template<>
+    void xmldocument_object::test<2>()
+    {
+        set_test_name("layers merge as before");
+        const std::string dir = LLFile::tmpdir();
+        const std::string base = dir + "llxmldocument_test_en.xml";
+        const std::string layer = dir + "llxmldocument_test_fr.xml";
+        write_file(base, SAMPLE);
+        write_file(layer,
+                   "<floater name=\"sample\" title=\"Exemple\">\n"
+                   "  <combo_box>\n"
+                   "    <combo_box.item label=\"Deux\" value=\"2\"/>\n"
+                   "    <combo_box.item label=\"Un\" value=\"1\"/>\n"
+                   "  </combo_box>\n"
+                   "  <string name=\"multi\">ligne un</string>\n"
+                   "  <text name=\"plain\" missing=\"ignored\">Du texte</text>\n"
+                   "  <text name=\"nowhere\">not merged</text>\n"
+                   "</floater>\n");
+
+        // what getLayeredXMLNode() did with two LLXMLNode trees
+        LLXMLNodePtr expected;
+        LLXMLNodePtr update;
+        ensure("parse base", LLXMLNode::parseFile(base, expected));
+        ensure("parse layer", LLXMLNode::parseFile(layer, update));
+        LLXMLNode::updateNode(expected, update);
+
+        LLXMLNodePtr merged;
+        ensure("layered", LLXMLNode::getLayeredXMLNode(merged, { base, layer }));
+        ensure_equals("same merge", to_string(merged), to_string(expected));
+        ensure("translated", to_string(merged).find("Exemple") != std::string::npos);
+
+        LLFile::remove(base);
+        LLFile::remove(layer);
+    }
+
+    template<> template<>
+    void xmldocument_object::test<3>()
+    {
+        set_test_name("skins benchmark");
+
+        skip_unless_benchmarks();
+
+        const std::filesystem::path skins = std::filesystem::path(__FILE__).parent_path() / ".." / ".." / "newview" / "skins";
+        std::error_code error;
+        if (!std::filesystem::is_directory(skins, error))
+        {
+            std::cout << "\nNo skins directory at " << skins.string() << ", skipping benchmark" << std::endl;
+            return;
+        }
+
+        std::vector<std::string> files;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(skins, error))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".xml")
+            {
+                files.push_back(LLFile::getContents(entry.path().string()));
+            }
+        }
+
+        typedef std::chrono::steady_clock clock;
+        F64 node_ms = 0.0;
+        F64 document_ms = 0.0;
+        S64 node_bytes = 0;
+        S64 document_bytes = 0;
+        S64 node_peak = 0;
+        S64 document_peak = 0;
+        size_t bytes = 0;
+        S32 parsed = 0;
+        for (const std::string& xml : files)
+        {
+            LLXMLDocument document;
+            // intern the names first, so neither pays for the string table
+            if (!document.parseBuffer(xml.data(), xml.size()))
+            {
+                continue;
+            }
+            document.clear();
+
+            S64 before = live_bytes();
+            reset_peak_bytes();
+            auto start = clock::now();
+            LLXMLNodePtr root;
+            LLXMLNode::parseBuffer(xml.data(), xml.size(), root);
+            node_ms += std::chrono::duration<F64, std::milli>(clock::now() - start).count();
+            node_bytes += live_bytes() - before;
+            node_peak = llmax(node_peak, peak_bytes() - before);
+
+            before = live_bytes();
+            reset_peak_bytes();
+            start = clock::now();
+            document.parseBuffer(xml.data(), xml.size());
+            document_ms += std::chrono::duration<F64, std::milli>(clock::now() - start).count();
+            document_bytes += live_bytes() - before;
+            document_peak = llmax(document_peak, peak_bytes() - before);
+
+            ensure_equals("same tree", compare(root, document.getRoot()), std::string());
+            bytes += xml.size();
+            ++parsed;
+        }
+
+        std::cout << "\nParsed " << parsed << " skin files, " << bytes / 1024 << " KB of XML:\n"
+                  << "  LLXMLNode     " << node_ms << " ms, " << node_bytes / 1024 << " KB held, "
+                  << node_peak / 1024 << " KB peak for one file\n"
+                  << "  LLXMLDocument " << document_ms << " ms, " << document_bytes / 1024 << " KB held, "
+                  << document_peak / 1024 << " KB peak for one file" << std::endl;
+    }
+
+    template<> template<>
+    void xmldocument_object::test<4>()
+    {
+        set_test_name("layered merge benchmark");
+
+        skip_unless_benchmarks();
+
+        const std::filesystem::path xui = std::filesystem::path(__FILE__).parent_path() / ".." / ".." / "newview" / "skins";
+        const std::filesystem::path base_dir = xui / "default" / "xui" / "en";
+        std::error_code error;
+        if (!std::filesystem::is_directory(base_dir, error))
+        {
+            std::cout << "\nNo skins directory at " << xui.string() << ", skipping benchmark" << std::endl;
+            return;
+        }
+
+        // The layers findSkinnedFilenames() gives for the vintage skin in
+        // German: default and skin files, English and then localized
+        std::vector<std::vector<std::string> > layered;
+        for (const auto& entry : std::filesystem::directory_iterator(base_dir, error))
+        {
+            if (entry.path().extension() != ".xml")
+            {
+                continue;
+            }
+            std::vector<std::string> paths;
+            for (const std::filesystem::path& path : { entry.path(),
+                    xui / "vintage" / "xui" / "en" / entry.path().filename(),
+                    xui / "default" / "xui" / "de" / entry.path().filename(),
+                    xui / "vintage" / "xui" / "de" / entry.path().filename() })
+            {
+                if (std::filesystem::is_regular_file(path, error))
+                {
+                    paths.push_back(path.string());
+                }
+            }
+            if (paths.size() > 1)
+            {
+                layered.push_back(paths);
+            }
+        }
+
+        typedef std::chrono::steady_clock clock;
+        F64 node_ms = 0.0;
+        F64 document_ms = 0.0;
+        S64 node_peak = 0;
+        S64 document_peak = 0;
+        size_t layers = 0;
+        for (const std::vector<std::string>& paths : layered)
+        {
+            // warm the file cache and the string table for both
+            LLXMLNodePtr warm;
+            LLXMLNode::getLayeredXMLNode(warm, paths);
+            warm = nullptr;
+
+            // getLayeredXMLNode() with every layer an LLXMLNode tree, as before
+            S64 before = live_bytes();
+            reset_peak_bytes();
+            auto start = clock::now();
+            LLXMLNodePtr expected;
+            bool parsed = LLXMLNode::parseFile(paths.front(), expected);
+            for (size_t i = 1; parsed && i < paths.size(); ++i)
+            {
+                LLXMLNodePtr update;
+                parsed = LLXMLNode::parseFile(paths[i], update);
+                if (!parsed)
+                {
+                    break;
+                }
+                std::string node_name;
+                std::string update_name;
+                update->getAttributeString("name", update_name);
+                expected->getAttributeString("name", node_name);
+                if (update_name == node_name)
+                {
+                    LLXMLNode::updateNode(expected, update);
+                }
+            }
+            node_ms += std::chrono::duration<F64, std::milli>(clock::now() - start).count();
+            node_peak = llmax(node_peak, peak_bytes() - before);
+            if (!parsed)
+            {
+                continue;
+            }
+
+            before = live_bytes();
+            reset_peak_bytes();
+            start = clock::now();
+            LLXMLNodePtr merged;
+            LLXMLNode::getLayeredXMLNode(merged, paths);
+            document_ms += std::chrono::duration<F64, std::milli>(clock::now() - start).count();
+            document_peak = llmax(document_peak, peak_bytes() - before);
+
+            ensure_equals("same merge", to_string(merged), to_string(expected));
+            layers += paths.size() - 1;
+        }
+
+        std::cout << "\nMerged " << layered.size() << " XUI files with " << layers << " skin and language layers:\n"
+                  << "  layers as LLXMLNode     " << node_ms << " ms, " << node_peak / 1024 << " KB peak for one file\n"
+                  << "  layers as LLXMLDocument " << document_ms << " ms, " << document_peak / 1024 << " KB peak for one file"
+                  << std::endl;
+    }
+
+    template<> template<>
+    void xmldocument_object::test<5>()
+    {
+        set_test_name("a sample of the skin files reads like LLXMLNode");
+
+        const std::filesystem::path skins = std::filesystem::path(__FILE__).parent_path() / ".." / ".." / "newview" / "skins" / "default" / "xui" / "en";
+        std::error_code error;
+        if (!std::filesystem::is_directory(skins, error))
+        {
+            skip("no skins directory");
+        }
+
+        // every 20th file keeps the default run short
+        S32 index = 0;
+        S32 compared = 0;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(skins, error))
+        {
+            if (!entry.is_regular_file() || entry.path().extension() != ".xml" || index++ % 20)
+            {
+                continue;
+            }
+            const std::string xml = LLFile::getContents(entry.path().string());
+            LLXMLNodePtr root;
+            LLXMLDocument document;
+            if (!LLXMLNode::parseBuffer(xml.data(), xml.size(), root) || !document.parseBuffer(xml.data(), xml.size()))
+            {
+                continue;
+            }
+            ensure_equals(entry.path().filename().string(), compare(root, document.getRoot()), std::string());
+            ++compared;
+        }
+        ensure("files compared", compared > 0);
+    }
+}
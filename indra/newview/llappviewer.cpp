@@ -302,6 +302,7 @@ using namespace LL;
 #endif // (LL_LINUX) && LL_GTK
 
 const char* const CRASH_SETTINGS_FILE = "settings_crash_behavior.xml"; // <FS:ND/> We need this filename defined here.
+const char* const XUI_LAYOUT_CACHE_FILE = "xui_layouts.bin"; // <FS> XUI layout cache
 
 static LLAppViewerListener sAppViewerListener(LLAppViewer::instance);
 
@@ -996,6 +997,14 @@ bool LLAppViewer::init()
 // [/SL:KB]
 //  gDirUtilp->setSkinFolder(gDirUtilp->getSkinFolder(), LLUI::getLanguage());
 
+    // <FS> XUI layout cache
+    LLUICtrlFactory::getLayoutCache().setEnabled(gSavedSettings.getBOOL("FSXUILayoutCache"));
+    if (LLUICtrlFactory::getLayoutCache().isEnabled())
+    {
+        LLUICtrlFactory::getLayoutCache().loadFromFile(gDirUtilp->getExpandedFilename(LL_PATH_USER_SETTINGS, XUI_LAYOUT_CACHE_FILE));
+    }
+    // </FS>
+
     // Setup LLTrans after LLUI::initClass has been called.
     initStrings();
 
@@ -2148,6 +2157,18 @@ bool LLAppViewer::cleanup()
     cleanupSavedSettings();
     LL_INFOS() << "Settings patched up" << LL_ENDL;
 
+    // <FS> XUI layout cache
+    const std::string xui_cache_file = gDirUtilp->getExpandedFilename(LL_PATH_USER_SETTINGS, XUI_LAYOUT_CACHE_FILE);
+    if (LLUICtrlFactory::getLayoutCache().isEnabled())
+    {
+        LLUICtrlFactory::getLayoutCache().saveToFile(xui_cache_file);
+    }
+    else
+    {
+        LLFile::remove(xui_cache_file, ENOENT);
+    }
+    // </FS>
+
     // delete some of the files left around in the cache.
     removeCacheFiles("*.wav");
     removeCacheFiles("*.tmp");
@@ -2581,6 +2602,15 @@ bool LLAppViewer::initThreads()
     threadCounts["ImageDecode"] = image_decode_count;
     gSavedSettings.setLLSD("ThreadPoolSizes", threadCounts);
 
+    // Large images can also split their own decode. Share out what the
+    // decode pool leaves of the cores so both together don't oversubscribe.
+    S32 threads_per_image = (S32)gSavedSettings.getU32("FSImageDecodeThreadsPerImage");
+    if (threads_per_image == 0)
+    {
+        threads_per_image = llclamp((cores - 2) / image_decode_count, 1, 4);
+    }
+    LLImageJ2C::setDecodeThreads(llclamp(threads_per_image, 1, 16));
+
     // Image decoding
     LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
     LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
@@ -5177,6 +5207,7 @@ bool LLAppViewer::initCache()
     // LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info);
     LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info, gSavedSettings.getF32("FSDiskCacheHighWaterPercent"), gSavedSettings.getF32("FSDiskCacheLowWaterPercent"));
     // </FS:Beq>
+    LLDiskCache::getInstance()->setPackThreshold(gSavedSettings.getU32("FSDiskCachePackThreshold")); // <FS> Pack file for small assets
 
     if (!read_only)
     {
@@ -6379,6 +6410,12 @@ void LLAppViewer::idleNetwork()
             lmc.processAcks(ack_collection_time());
         }
     }
+
+    // <FS> object updates queued by the messages above and earlier frames
+    static LLCachedControl<F32> update_apply_time(gSavedSettings, "FSObjectUpdateApplyTime", 3.f);
+    gObjectList.applyQueuedUpdates(update_apply_time() * 0.001f);
+    // </FS>
+
     add(LLStatViewer::NUM_NEW_OBJECTS, gObjectList.mNumNewObjects);
 
     // Retransmit unacknowledged packets.
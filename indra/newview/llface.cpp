@@ -1204,6 +1204,37 @@ void push_for_transform(LLVertexBuffer* buff, U32 source_count, U32 dest_count)
     }
 }
 
+bool LLFace::prepareGeometryVolume(S32 face_index)
+{
+    LLVolume* volume = mVObjp->getVolume();
+    const LLTextureEntry* tep = mVObjp->getTE(face_index);
+    if (!volume || !tep || mVertexBuffer.isNull() || face_index < 0 || face_index >= volume->getNumVolumeFaces())
+    {
+        return false;
+    }
+
+    if (mVertexBufferGLTF.notNull() || (tep->isSelected() && tep->getGLTFRenderMaterial()))
+    { // the selection highlight buffer is a GL side clone
+        return false;
+    }
+
+    // tangents get generated into the volume, which other objects may share
+    if (tep->getBumpmap() ||
+        tep->getTexGen() != LLTextureEntry::TEX_GEN_DEFAULT ||
+        mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TANGENT))
+    {
+        volume->genTangents(face_index);
+    }
+
+    // registerFace() goes by TEXTURE_ANIM before the geometry gets built
+    if (isState(TEXTURE_ANIM) && !((LLVOVolume*)mVObjp.get())->mTexAnimMode)
+    {
+        clearState(TEXTURE_ANIM);
+    }
+
+    return true;
+}
+
 bool LLFace::getGeometryVolume(const LLVolume& volume,
                                 S32 face_index,
                                 const LLMatrix4& mat_vert_in,
@@ -170,6 +170,10 @@ public:
                             bool force_rebuild = false,
                             bool no_debug_assert = false,
                             bool rebuild_for_gltf = false);
+    // Does on the main thread what getGeometryVolume() would do outside
+    // this face. If it returns true, getGeometryVolume() for face_index may
+    // run on a worker thread while nothing else touches the face.
+    bool prepareGeometryVolume(S32 face_index);
 
     // For avatar
     U16          getGeometryAvatar(
@@ -300,7 +300,10 @@ bool LLFolderViewModelItemInventory::filter(LLFolderViewFilter& filter)
                 view_model = static_cast<LLFolderViewModelItemInventory*>(view_model->mParent);
             }
         }
-        setPassedFilter(passed_filter, filter_generation, filter.getStringMatchOffset(this), filter.getFilterStringSize());
+        // <FS> Inventory search index: an item failing the filter is hidden, no match to highlight
+        //setPassedFilter(passed_filter, filter_generation, filter.getStringMatchOffset(this), filter.getFilterStringSize());
+        setPassedFilter(passed_filter, filter_generation, (passed_filter || is_folder) ? filter.getStringMatchOffset(this) : std::string::npos, filter.getFilterStringSize());
+        // </FS>
         continue_filtering = !filter.isTimedOut();
     }
     return continue_filtering;
@@ -92,6 +92,9 @@ LLInventoryFilter::LLInventoryFilter(const Params& p)
     mFirstRequiredGeneration(0),
     mFirstSuccessGeneration(0),
     mSearchType(SEARCHTYPE_NAME),
+    mSearchIndexField(LLInventorySearchIndex::NAME), // <FS> Inventory search index
+    mSearchIndexGeneration(0),
+    mSearchIndexValid(false),
     mSingleFolderMode(false)
 {
     // copy mFilterOps into mDefaultFilterOps
@@ -111,7 +114,16 @@ bool LLInventoryFilter::check(const LLFolderViewModelItem* item)
         return true;
     }
 
-    std::string desc = listener->getSearchableCreatorName();
+    // <FS> Inventory search index
+    if (!is_folder && !checkAgainstSearchIndex(listener))
+    {
+        return false;
+    }
+
+    // Every case below sets it, no need to look up the creator first
+    //std::string desc = listener->getSearchableCreatorName();
+    std::string desc;
+    // </FS>
     switch (mSearchType)
     {
         case SEARCHTYPE_CREATOR:
@@ -331,6 +343,62 @@ bool LLInventoryFilter::checkAgainstFilterSubString(const std::string& desc) con
     return pos != std::string::npos;
 }
 
+// <FS> Inventory search index
+// False only if the index tells that the item fails the sub string test
+bool LLInventoryFilter::checkAgainstSearchIndex(const LLFolderViewModelItemInventory* listener)
+{
+    // only plain sub string searches by name or description
+    if (!mExactToken.empty() || !mFilterTokens.empty()
+        || (mSearchType != SEARCHTYPE_NAME && mSearchType != SEARCHTYPE_DESCRIPTION))
+    {
+        return true;
+    }
+
+    const LLInventorySearchIndex* index = gInventory.getSearchIndex();
+    if (!index)
+    {
+        return true;
+    }
+
+    const LLInventorySearchIndex::EField field = (mSearchType == SEARCHTYPE_NAME) ? LLInventorySearchIndex::NAME : LLInventorySearchIndex::DESCRIPTION;
+    if (mSearchIndexGeneration != index->getGeneration() || mSearchIndexField != field || mSearchIndexQuery != mFilterSubString)
+    {
+        mSearchIndexValid = index->find(field, mFilterSubString, mSearchIndexMatches);
+        mSearchIndexGeneration = index->getGeneration();
+        mSearchIndexField = field;
+        mSearchIndexQuery = mFilterSubString;
+    }
+    if (!mSearchIndexValid)
+    {
+        return true;
+    }
+
+    const LLUUID& id = listener->getUUID();
+    const std::string* text = index->getText(id, field);
+    if (!text || mSearchIndexMatches.count(id))
+    {
+        return true;
+    }
+    if (field == LLInventorySearchIndex::DESCRIPTION)
+    {
+        // the searchable description is the indexed one
+        return false;
+    }
+
+    // The name does not contain the sub string, but the searchable name
+    // has the label suffix ("(worn)", "(no copy)"...) appended to it and
+    // that part can still match
+    const std::string& searchable = listener->getSearchableName();
+    if (searchable.compare(0, text->size(), *text))
+    {
+        // displayed under another name than the one indexed
+        return true;
+    }
+    const size_t start = (text->size() >= mFilterSubString.size()) ? text->size() - mFilterSubString.size() + 1 : 0;
+    return searchable.find(mFilterSubString, start) != std::string::npos;
+}
+// </FS>
+
 bool LLInventoryFilter::checkAgainstFilterType(const LLFolderViewModelItemInventory* listener) const
 {
     if (!listener)
@@ -27,6 +27,7 @@
 #ifndef LLINVENTORYFILTER_H
 #define LLINVENTORYFILTER_H
 
+#include "llinventorysearchindex.h" // <FS> Inventory search index
 #include "llinventorytype.h"
 #include "llpermissionsflags.h"
 #include "llfolderviewmodel.h"
@@ -373,6 +374,7 @@ private:
     bool                checkAgainstCreator(const class LLFolderViewModelItemInventory* listener) const;
     bool                checkAgainstSearchVisibility(const class LLFolderViewModelItemInventory* listener) const;
     bool                checkAgainstClipboard(const LLUUID& object_id) const;
+    bool                checkAgainstSearchIndex(const class LLFolderViewModelItemInventory* listener); // <FS> Inventory search index
 
     FilterOps               mFilterOps;
     FilterOps               mDefaultFilterOps;
@@ -403,6 +405,15 @@ private:
     std::vector<std::string> mFilterTokens;
     std::string              mExactToken;
 
+    // <FS> Inventory search index: the items matching mSearchIndexQuery,
+    // as of mSearchIndexGeneration of the index
+    LLInventorySearchIndex::id_set_t mSearchIndexMatches;
+    std::string              mSearchIndexQuery;
+    LLInventorySearchIndex::EField mSearchIndexField;
+    U32                      mSearchIndexGeneration;
+    bool                     mSearchIndexValid;
+    // </FS>
+
     bool mSingleFolderMode;
 };
 
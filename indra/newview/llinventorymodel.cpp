@@ -38,6 +38,7 @@
 #include "llavatarnamecache.h"
 #include "llclipboard.h"
 #include "lldispatcher.h"
+#include "llinventorycache.h"
 #include "llinventorypanel.h"
 #include "llinventorybridge.h"
 #include "llinventoryfunctions.h"
@@ -456,6 +457,7 @@ LLInventoryModel::LLInventoryModel()
     mItemMap(),
     mParentChildCategoryTree(),
     mParentChildItemTree(),
+    mSearchIndexBuilt(false), // <FS> Inventory search index
     mLastItem(NULL),
     mIsNotifyObservers(false),
     mModifyMask(LLInventoryObserver::ALL),
@@ -1496,6 +1498,60 @@ void LLInventoryModel::addChangedMaskForLinks(const LLUUID& object_id, U32 mask)
     };
 }
 
+// <FS> Inventory search index
+const LLInventorySearchIndex* LLInventoryModel::getSearchIndex()
+{
+    static LLCachedControl<bool> index_enabled(gSavedSettings, "FSInventorySearchIndex", true);
+    static LLCachedControl<bool> index_descriptions(gSavedSettings, "FSInventorySearchIndexDescriptions", false);
+
+    if (!index_enabled)
+    {
+        if (mSearchIndexBuilt)
+        {
+            mSearchIndex.clear();
+            mSearchIndexBuilt = false;
+        }
+        return nullptr;
+    }
+
+    if (!mSearchIndexBuilt || mSearchIndex.getIndexDescriptions() != index_descriptions)
+    {
+        LL_PROFILE_ZONE_NAMED("Build inventory search index");
+        mSearchIndex.clear();
+        mSearchIndex.setIndexDescriptions(index_descriptions);
+        for (item_map_t::const_iterator iit = mItemMap.begin(); iit != mItemMap.end(); ++iit)
+        {
+            const LLViewerInventoryItem* item = iit->second;
+            if (!item->getIsLinkType())
+            {
+                mSearchIndex.update(item->getUUID(), item->getName(), item->getDescription());
+            }
+        }
+        mSearchIndexBuilt = true;
+        LL_INFOS(LOG_INV) << "Indexed " << mSearchIndex.size() << " inventory items for search" << LL_ENDL;
+    }
+    return &mSearchIndex;
+}
+
+void LLInventoryModel::updateSearchIndex(const LLUUID& id)
+{
+    if (!mSearchIndexBuilt)
+    {
+        return;
+    }
+
+    const LLViewerInventoryItem* item = getItem(id);
+    if (item && !item->getIsLinkType())
+    {
+        mSearchIndex.update(id, item->getName(), item->getDescription());
+    }
+    else
+    {
+        mSearchIndex.remove(id);
+    }
+}
+// </FS>
+
 const LLUUID& LLInventoryModel::getLinkedItemID(const LLUUID& object_id) const
 {
     const LLInventoryItem *item = gInventory.getItem(object_id);
@@ -1878,7 +1934,10 @@ void LLInventoryModel::moveObject(const LLUUID& object_id, const LLUUID& cat_id)
         return;
     }
 
-    if((object_id == cat_id) || !is_in_map(mCategoryMap, cat_id))
+    // <FS> Hashed inventory maps
+    //if((object_id == cat_id) || !is_in_map(mCategoryMap, cat_id))
+    if((object_id == cat_id) || !mCategoryMap.count(cat_id))
+    // </FS>
     {
         LL_WARNS(LOG_INV) << "Could not move inventory object " << object_id << " to "
                           << cat_id << LL_ENDL;
@@ -2220,6 +2279,7 @@ void LLInventoryModel::deleteObject(const LLUUID& id, bool fix_broken_links, boo
     LLUUID parent_id = obj->getParentUUID();
     mCategoryMap.erase(id);
     mItemMap.erase(id);
+    updateSearchIndex(id); // <FS> Inventory search index
     //mInventory.erase(id);
     item_array_t* item_list = getUnlockedItemArray(parent_id);
     if(item_list)
@@ -2363,6 +2423,17 @@ void LLInventoryModel::notifyObservers(const LLUUID& transaction_id)
 // [SL:KB] - Patch: UI-Notifications | Checked: Catznip-6.5
     mTransactionId = transaction_id;
 // [/SL:KB]
+
+    // <FS> Inventory search index: catch renames and description edits
+    // made on the items in place before the observers filter on them
+    if (mSearchIndexBuilt)
+    {
+        for (const LLUUID& id : mChangedItemIDs)
+        {
+            updateSearchIndex(id);
+        }
+    }
+    // </FS>
     for (observer_list_t::iterator iter = mObservers.begin();
          iter != mObservers.end(); )
     {
@@ -2724,6 +2795,7 @@ void LLInventoryModel::addItem(LLViewerInventoryItem* item)
             addBacklinkInfo(link_id, target_id);
         }
         mItemMap[item->getUUID()] = item;
+        updateSearchIndex(item->getUUID()); // <FS> Inventory search index
     }
 }
 
@@ -2744,6 +2816,7 @@ void LLInventoryModel::empty()
     mBacklinkMMap.clear(); // forget all backlink information.
     mCategoryMap.clear(); // remove all references (should delete entries)
     mItemMap.clear(); // remove all references (should delete entries)
+    mSearchIndex.clear(); // <FS> Inventory search index
     mLastItem = NULL;
     //mInventory.clear();
 }
@@ -3229,6 +3302,10 @@ void LLInventoryModel::buildParentChildMap()
     cat_array_t* catsp;
     item_array_t* itemsp;
 
+    // <FS> Hashed inventory maps: size them once, plus the null parent
+    mParentChildCategoryTree.reserve(mCategoryMap.size() + 1);
+    mParentChildItemTree.reserve(mCategoryMap.size());
+    // </FS>
     for(cat_map_t::iterator cit = mCategoryMap.begin(); cit != mCategoryMap.end(); ++cit)
     {
         LLViewerInventoryCategory* cat = cit->second;
@@ -3653,6 +3730,13 @@ bool LLInventoryModel::loadFromFile(const std::string& filename,
     }
     LL_INFOS(LOG_INV) << "loading inventory from: (" << filename << ")" << LL_ENDL;
 
+    // <FS> Caches written before the binary format are still read
+    if (LLInventoryCacheReader::isCacheFile(filename))
+    {
+        return loadFromBinaryFile(filename, categories, items, cats_to_update, is_cache_obsolete);
+    }
+    // </FS>
+
     llifstream file(filename.c_str());
 
     if (!file.is_open())
@@ -3754,6 +3838,14 @@ bool LLInventoryModel::saveToFile(const std::string& filename,
         return false;
     }
 
+    // <FS> Binary cache
+    static LLCachedControl<bool> binary_cache(gSavedSettings, "FSBinaryInventoryCache", true);
+    if (binary_cache)
+    {
+        return saveToBinaryFile(filename, categories, items);
+    }
+    // </FS>
+
     LL_INFOS(LOG_INV) << "saving inventory to: (" << filename << ")" << LL_ENDL;
 
     try
@@ -3819,6 +3911,135 @@ bool LLInventoryModel::saveToFile(const std::string& filename,
     return true;
 }
 
+// <FS> Binary cache
+// static
+bool LLInventoryModel::loadFromBinaryFile(const std::string& filename,
+                                          LLInventoryModel::cat_array_t& categories,
+                                          LLInventoryModel::item_array_t& items,
+                                          LLInventoryModel::changed_items_t& cats_to_update,
+                                          bool &is_cache_obsolete)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    is_cache_obsolete = true; // Obsolete until proven current
+
+    LLInventoryCacheReader reader;
+    if (!reader.load(filename))
+    {
+        LL_WARNS(LOG_INV) << "Reading inventory cache failed" << LL_ENDL;
+        return false;
+    }
+    if (reader.getCacheVersion() != sCurrentInvCacheVersion)
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache is out of date" << LL_ENDL;
+        return false;
+    }
+    is_cache_obsolete = false;
+
+    // The records are turned into objects on the thread pool, each chunk
+    // into its own slots. What to keep is decided here afterwards, in
+    // file order like the LLSD cache.
+    cat_array_t loaded_categories(reader.getCategoryCount());
+    item_array_t loaded_items(reader.getItemCount());
+    reader.decodeChunks([&loaded_categories, &loaded_items](const LLInventoryCacheReader::Chunk& chunk)
+        {
+            for (U32 i = 0; i < chunk.mCategoryCount; ++i)
+            {
+                LLPointer<LLViewerInventoryCategory> inv_cat = new LLViewerInventoryCategory(LLUUID::null);
+                if (inv_cat->importCache(chunk.getCategory(i), chunk.mStrings))
+                {
+                    loaded_categories[chunk.mFirstCategory + i] = inv_cat;
+                }
+            }
+            for (U32 i = 0; i < chunk.mItemCount; ++i)
+            {
+                LLPointer<LLViewerInventoryItem> inv_item = new LLViewerInventoryItem;
+                if (inv_item->importCache(chunk.getItem(i), chunk.mStrings))
+                {
+                    loaded_items[chunk.mFirstItem + i] = inv_item;
+                }
+            }
+        });
+
+    categories.reserve(categories.size() + loaded_categories.size());
+    for (auto& inv_cat : loaded_categories)
+    {
+        if (inv_cat)
+        {
+            categories.push_back(inv_cat);
+        }
+    }
+
+    items.reserve(items.size() + loaded_items.size());
+    for (auto& inv_item : loaded_items)
+    {
+        if (!inv_item)
+        {
+            continue;
+        }
+        if (inv_item->getUUID().isNull())
+        {
+            LL_DEBUGS(LOG_INV) << "Ignoring inventory with null item id: "
+                << inv_item->getName() << LL_ENDL;
+        }
+        else if (inv_item->getType() == LLAssetType::AT_UNKNOWN)
+        {
+            cats_to_update.insert(inv_item->getParentUUID());
+        }
+        else
+        {
+            items.push_back(inv_item);
+        }
+    }
+
+    LL_INFOS(LOG_INV) << "Inventory cache read: " << reader.getCategoryCount() << " categories, "
+                      << reader.getItemCount() << " items in " << reader.getChunkCount() << " chunks." << LL_ENDL;
+    return true;
+}
+
+// static
+bool LLInventoryModel::saveToBinaryFile(const std::string& filename,
+                                        const cat_array_t& categories,
+                                        const item_array_t& items)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    LL_INFOS(LOG_INV) << "saving inventory to: (" << filename << ")" << LL_ENDL;
+
+    // The writer streams out a chunk whenever one fills up. Everything is
+    // written again rather than only what changed: cache() gzips the whole
+    // file and only runs at logout, and which folders are cached at all is
+    // only decided then by LLCanCache.
+    LLInventoryCacheWriter writer(sCurrentInvCacheVersion);
+    if (!writer.open(filename))
+    {
+        LL_WARNS(LOG_INV) << "Failed to open file. Unable to save inventory to: " << filename << LL_ENDL;
+        return false;
+    }
+
+    for (auto& cat : categories)
+    {
+        if (cat->getVersion() != LLViewerInventoryCategory::VERSION_UNKNOWN)
+        {
+            cat->exportCache(writer);
+        }
+    }
+    for (auto& item : items)
+    {
+        item->exportCache(writer);
+    }
+
+    if (!writer.close())
+    {
+        LL_WARNS(LOG_INV) << "Failed to write inventory to: " << filename << LL_ENDL;
+        return false;
+    }
+
+    LL_INFOS(LOG_INV) << "Inventory saved: " << writer.getCategoryCount() << " categories, " << writer.getItemCount() << " items." << LL_ENDL;
+    return true;
+}
+// </FS>
+
 // message handling functionality
 // static
 void LLInventoryModel::registerCallbacks(LLMessageSystem* msg)
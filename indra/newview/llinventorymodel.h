@@ -35,7 +35,9 @@
 #include "llassettype.h"
 #include "llfoldertype.h"
 #include "llframetimer.h"
+#include "llinventorysearchindex.h"
 #include "lluuid.h"
+#include "lluuidhashmap.h"
 #include "llpermissionsflags.h"
 #include "llviewerinventory.h"
 #include "llstring.h"
@@ -213,13 +215,16 @@ private:
     // the inventory using several different identifiers.
     // mInventory member data is the 'master' list of inventory, and
     // mCategoryMap and mItemMap store uuid->object mappings.
-    typedef std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
-    typedef std::map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+    // <FS> Hashed inventory maps: the walk order of these is unspecified
+    // and any insertion or erasure invalidates their iterators.
+    typedef LLUUIDHashMap<LLPointer<LLViewerInventoryCategory> > cat_map_t;
+    typedef LLUUIDHashMap<LLPointer<LLViewerInventoryItem> > item_map_t;
     cat_map_t mCategoryMap;
     item_map_t mItemMap;
     // This last set of indices is used to map parents to children.
-    typedef std::map<LLUUID, cat_array_t*> parent_cat_map_t;
-    typedef std::map<LLUUID, item_array_t*> parent_item_map_t;
+    typedef LLUUIDHashMap<cat_array_t*> parent_cat_map_t;
+    typedef LLUUIDHashMap<item_array_t*> parent_item_map_t;
+    // </FS>
     parent_cat_map_t mParentChildCategoryTree;
     parent_item_map_t mParentChildItemTree;
 
@@ -227,6 +232,12 @@ private:
     // category pointers here, because broken links are also supported.
     typedef std::multimap<LLUUID, LLUUID> backlink_mmap_t;
     backlink_mmap_t mBacklinkMMap; // key = target_id: ID of item, values = link_ids: IDs of item or folder links referencing it.
+    // <FS> Inventory search index
+    void updateSearchIndex(const LLUUID& id);
+    LLInventorySearchIndex mSearchIndex;
+    bool mSearchIndexBuilt;
+    // </FS>
+
     // For internal use only
     bool hasBacklinkInfo(const LLUUID& link_id, const LLUUID& target_id) const;
     void addBacklinkInfo(const LLUUID& link_id, const LLUUID& target_id);
@@ -381,6 +392,14 @@ public:
     //    updateCategory() method to actually modify values.
     LLViewerInventoryCategory* getCategory(const LLUUID& id) const;
 
+    // <FS> Inventory search index
+    // Item names, and descriptions if FSInventorySearchIndexDescriptions is
+    // set, for sub string searches. Links are left out, their name is the
+    // one of their target. Built on the first call and kept up to date from
+    // then on; NULL while FSInventorySearchIndex is off.
+    const LLInventorySearchIndex* getSearchIndex();
+    // </FS>
+
     // Get the inventoryID or item that this item points to, else just return object_id
     const LLUUID& getLinkedItemID(const LLUUID& object_id) const;
     LLViewerInventoryItem* getLinkedItem(const LLUUID& object_id) const;
@@ -732,6 +751,16 @@ protected:
     static bool saveToFile(const std::string& filename,
                            const cat_array_t& categories,
                            const item_array_t& items);
+    // <FS> Binary cache, see llinventorycache.h
+    static bool loadFromBinaryFile(const std::string& filename,
+                                   cat_array_t& categories,
+                                   item_array_t& items,
+                                   changed_items_t& cats_to_update,
+                                   bool& is_cache_obsolete);
+    static bool saveToBinaryFile(const std::string& filename,
+                                 const cat_array_t& categories,
+                                 const item_array_t& items);
+    // </FS>
 
     //--------------------------------------------------------------------
     // Message handling functionality
@@ -969,7 +969,7 @@ LLMeshRepoThread::LLMeshRepoThread()
 
     // Lod processing is expensive due to the number of requests
     // and a need to do expensive cacheOptimize().
-    mMeshThreadPool.reset(new LL::ThreadPool("MeshLodProcessing", 2));
+    mMeshThreadPool.reset(new LL::WorkStealingThreadPool("MeshLodProcessing", 2));
     mMeshThreadPool->start();
 }
 
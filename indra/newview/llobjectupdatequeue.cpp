@@ -0,0 +1,1158 @@
+/**
+ * @file llobjectupdatequeue.cpp
+ * @brief Object update packets applied within a per frame time budget.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llobjectupdatequeue.h"
+
+#include "lldatapacker.h"
+#include "llprimitive.h"
+#include "llquantize.h"
+#include "lltimer.h"
+#include "llvolumemessage.h"
+#include "message.h"
+#include "object_flags.h"
+#include "workqueue.h"
+
+#include <iostream>
+
+namespace
+{
+    // Compressed full update header, see LLViewerObject::sObjectDataMap
+    constexpr U32 FULL_ID_OFFSET = 0;
+    constexpr U32 FULL_LOCAL_ID_OFFSET = 16;
+    constexpr U32 FULL_PCODE_OFFSET = 20;
+
+    // Terse update after the LocalID: State, agent, Pos, Vel, Acc, Theta,
+    // Omega, plus the foot plane for agents
+    constexpr U32 TERSE_MOTION_SIZE = 40;
+    constexpr U32 TERSE_AGENT_OFFSET = 1;
+    constexpr U32 TERSE_FOOT_PLANE_SIZE = 16;
+
+    // ObjectData field of an ObjectUpdate, see
+    // LLViewerObject::processUpdateMessage()
+    constexpr S32 OBJECTDATA_FIELD_SIZE_140 = 140;
+    constexpr S32 OBJECTDATA_FIELD_SIZE_124 = 124;
+    constexpr S32 OBJECTDATA_FIELD_SIZE_76 = 76;
+    constexpr S32 OBJECTDATA_FIELD_SIZE_60 = 60;
+    constexpr S32 MAX_OBJECT_BINARY_DATA_SIZE = 60 + 16;
+
+    // TA_BLOCK_SIZE in lltextureanim.cpp
+    constexpr U32 TEXTURE_ANIM_SIZE = 16;
+    // what LLVolumeMessage::packVolumeParams() writes to a data packer
+    constexpr U32 VOLUME_PARAMS_SIZE = 23;
+
+    // packets per pool task, a packet holds five to ten blocks
+    constexpr size_t DISPATCH_BATCH = 8;
+
+    constexpr char CAPTURE_MAGIC[4] = { 'F', 'S', 'O', 'U' };
+    constexpr U32 CAPTURE_VERSION = 3;
+
+    // The ObjectUpdate fields addMessageBlock() copies, each with its size
+    // ahead of it. The volume parameters are in the order a data packer
+    // holds them, see LLVolumeMessage::unpackVolumeParams().
+    enum EFullField
+    {
+        FF_ID,
+        FF_STATE,
+        FF_FULL_ID,
+        FF_CRC,
+        FF_PCODE,
+        FF_MATERIAL,
+        FF_CLICK_ACTION,
+        FF_SCALE,
+        FF_OBJECT_DATA,
+        FF_PARENT_ID,
+        FF_UPDATE_FLAGS,
+        FF_PATH_CURVE,
+        FF_PATH_BEGIN,
+        FF_PATH_END,
+        FF_PATH_SCALE_X,
+        FF_PATH_SCALE_Y,
+        FF_PATH_SHEAR_X,
+        FF_PATH_SHEAR_Y,
+        FF_PATH_TWIST,
+        FF_PATH_TWIST_BEGIN,
+        FF_PATH_RADIUS_OFFSET,
+        FF_PATH_TAPER_X,
+        FF_PATH_TAPER_Y,
+        FF_PATH_REVOLUTIONS,
+        FF_PATH_SKEW,
+        FF_PROFILE_CURVE,
+        FF_PROFILE_BEGIN,
+        FF_PROFILE_END,
+        FF_PROFILE_HOLLOW,
+        FF_TEXTURE_ENTRY,
+        FF_TEXTURE_ANIM,
+        FF_NAME_VALUE,
+        FF_DATA,
+        FF_TEXT,
+        FF_TEXT_COLOR,
+        FF_MEDIA_URL,
+        FF_PS_BLOCK,
+        FF_EXTRA_PARAMS,
+        FF_SOUND,
+        FF_OWNER_ID,
+        FF_GAIN,
+        FF_FLAGS,
+        FF_RADIUS,
+        FF_COUNT
+    };
+
+    struct FieldTable
+    {
+        U32 mOffset[FF_COUNT];
+        U32 mSize[FF_COUNT];
+    };
+
+    U32 read_u32(const U8* data)
+    {
+        // the wire format is little endian, like the data packer
+        U32 value;
+        htolememcpy(&value, data, MVT_U32, sizeof(U32));
+        return value;
+    }
+
+    bool read_fields(const U8* data, U32 size, FieldTable& fields)
+    {
+        U32 offset = 0;
+        for (S32 i = 0; i < FF_COUNT; ++i)
+        {
+            if (size - offset < sizeof(U16))
+            {
+                return false;
+            }
+            U16 field_size;
+            htolememcpy(&field_size, data + offset, MVT_U16, sizeof(U16));
+            offset += sizeof(U16);
+            if (size - offset < field_size)
+            {
+                return false;
+            }
+            fields.mOffset[i] = offset;
+            fields.mSize[i] = field_size;
+            offset += field_size;
+        }
+        return true;
+    }
+
+    // The fields of an ObjectUpdate block, each with its size ahead of it
+    void copy_message_fields(LLMessageSystem* mesgsys, S32 block_num, std::vector<U8>& data)
+    {
+        const char* const names[FF_COUNT] =
+        {
+            _PREHASH_ID, _PREHASH_State, _PREHASH_FullID, _PREHASH_CRC, _PREHASH_PCode, _PREHASH_Material,
+            _PREHASH_ClickAction, _PREHASH_Scale, _PREHASH_ObjectData, _PREHASH_ParentID, _PREHASH_UpdateFlags,
+            _PREHASH_PathCurve, _PREHASH_PathBegin, _PREHASH_PathEnd, _PREHASH_PathScaleX, _PREHASH_PathScaleY,
+            _PREHASH_PathShearX, _PREHASH_PathShearY, _PREHASH_PathTwist, _PREHASH_PathTwistBegin,
+            _PREHASH_PathRadiusOffset, _PREHASH_PathTaperX, _PREHASH_PathTaperY, _PREHASH_PathRevolutions,
+            _PREHASH_PathSkew, _PREHASH_ProfileCurve, _PREHASH_ProfileBegin, _PREHASH_ProfileEnd,
+            _PREHASH_ProfileHollow, _PREHASH_TextureEntry, _PREHASH_TextureAnim, _PREHASH_NameValue, _PREHASH_Data,
+            _PREHASH_Text, _PREHASH_TextColor, _PREHASH_MediaURL, _PREHASH_PSBlock, _PREHASH_ExtraParams,
+            _PREHASH_Sound, _PREHASH_OwnerID, _PREHASH_Gain, _PREHASH_Flags, _PREHASH_Radius
+        };
+
+        data.clear();
+        data.reserve(512);
+        for (S32 i = 0; i < FF_COUNT; ++i)
+        {
+            const U16 size = (U16)llclamp(mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, names[i]), 0, 0xFFFF);
+            const size_t offset = data.size();
+            data.resize(offset + sizeof(U16) + size);
+            htolememcpy(&data[offset], &size, MVT_U16, sizeof(U16));
+            if (size)
+            {
+                mesgsys->getBinaryDataFast(_PREHASH_ObjectData, names[i], &data[offset + sizeof(U16)], 0, block_num, size);
+            }
+        }
+    }
+
+    // unpackBinaryData() does not know how much it may write
+    bool unpack_binary_data(LLDataPackerBinaryBuffer& dp, U8* value, S32& size, S32 max_size, const char* name)
+    {
+        S32 stored_size;
+        if (dp.getBufferSize() - dp.getCurrentSize() < (S32)sizeof(S32))
+        {
+            return false;
+        }
+        htolememcpy(&stored_size, dp.getBuffer() + dp.getCurrentSize(), MVT_S32, sizeof(S32));
+        return stored_size >= 0 && stored_size <= max_size && dp.unpackBinaryData(value, size, name);
+    }
+
+    // A fixed size field, zero if the field does not have that size
+    template <typename T>
+    T get_field(const U8* data, const FieldTable& fields, EFullField field, EMsgVariableType type)
+    {
+        T value{};
+        if (fields.mSize[field] == sizeof(T))
+        {
+            htolememcpy(&value, data + fields.mOffset[field], type, sizeof(T));
+        }
+        return value;
+    }
+
+    LLVector3 get_vector3(const U8* data, const FieldTable& fields, EFullField field)
+    {
+        LLVector3 value;
+        if (fields.mSize[field] == sizeof(LLVector3))
+        {
+            htolememcpy(value.mV, data + fields.mOffset[field], MVT_LLVector3, sizeof(LLVector3));
+        }
+        return value;
+    }
+
+    LLUUID get_uuid(const U8* data, const FieldTable& fields, EFullField field)
+    {
+        LLUUID value;
+        if (fields.mSize[field] == UUID_BYTES)
+        {
+            memcpy(value.mData, data + fields.mOffset[field], UUID_BYTES);
+        }
+        return value;
+    }
+
+    // As LLMessageSystem::getStringFast() reads it
+    std::string get_string(const U8* data, const FieldTable& fields, EFullField field)
+    {
+        const char* str = reinterpret_cast<const char*>(data + fields.mOffset[field]);
+        return std::string(str, strnlen(str, llmin(fields.mSize[field], (U32)MTUBYTES)));
+    }
+
+    // Parsed for every face the message can hold, the object applies as
+    // many as it has. Same as LLPrimitive::parseTEMessage() otherwise.
+    std::shared_ptr<LLTEContents> parse_texture_entry(const U8* data, U32 size)
+    {
+        if (!size)
+        {
+            return nullptr;
+        }
+        auto tec = std::make_shared<LLTEContents>();
+        if (size >= LLTEContents::MAX_TE_BUFFER)
+        {
+            LL_WARNS("TEXTUREENTRY") << "Excessive buffer size detected in Texture Entry! Truncating." << LL_ENDL;
+            size = LLTEContents::MAX_TE_BUFFER - 1;
+        }
+        memcpy(tec->packed_buffer, data, size);
+        // zero terminated like LLPrimitive::unpackTEMessage() does
+        tec->packed_buffer[size] = 0x00;
+        tec->size = size + 1;
+        tec->face_count = LLTEContents::MAX_TES;
+        return LLPrimitive::parseTEContents(*tec) ? tec : nullptr;
+    }
+
+    template <typename T>
+    void write_value(std::ostream& out, const T& value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool read_value(std::istream& in, T& value)
+    {
+        return (bool)in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+}
+
+LLObjectUpdatePacket::LLObjectUpdatePacket(EType type, U64 region_handle, U16 time_dilation, const LLHost& sender, U32 packet_id)
+:   mType(type),
+    mRegionHandle(region_handle),
+    mTimeDilation(time_dilation),
+    mSender(sender),
+    mPacketID(packet_id)
+{
+}
+
+void LLObjectUpdatePacket::reserve(U32 blocks, U32 bytes)
+{
+    mBlocks.reserve(blocks);
+    mBuffer.reserve(bytes);
+}
+
+void LLObjectUpdatePacket::addBlock(const U8* data, U32 size, U32 update_flags, const U8* texture_entry, U32 texture_entry_size)
+{
+    llassert(mState.load(std::memory_order_relaxed) == QUEUED);
+
+    Block block;
+    block.mUpdateFlags = update_flags;
+    block.mDataOffset = (U32)mBuffer.size();
+    block.mDataSize = llmin(size, mType == FULL ? MAX_FULL_DATA_SIZE : MAX_DATA_SIZE);
+    mBuffer.insert(mBuffer.end(), data, data + block.mDataSize);
+    if (texture_entry && texture_entry_size)
+    {
+        block.mTextureEntryOffset = (U32)mBuffer.size();
+        block.mTextureEntrySize = llmin(texture_entry_size, MAX_TEXTURE_ENTRY_SIZE);
+        mBuffer.insert(mBuffer.end(), texture_entry, texture_entry + block.mTextureEntrySize);
+    }
+
+    if (mType == TERSE)
+    {
+        if (block.mDataSize >= TERSE_HEADER_SIZE)
+        {
+            block.mLocalID = read_u32(data);
+            block.mAction = APPLY;
+        }
+    }
+    else if (mType == FULL)
+    {
+        // Never cached, the region's cache takes compressed updates only.
+        // A missing pcode only matters if the object has to be created.
+        FieldTable fields;
+        if (read_fields(data, block.mDataSize, fields))
+        {
+            block.mLocalID = get_field<U32>(data, fields, FF_ID, MVT_U32);
+            block.mFullID = get_uuid(data, fields, FF_FULL_ID);
+            block.mPCode = get_field<U8>(data, fields, FF_PCODE, MVT_U8);
+            block.mUpdateFlags = get_field<U32>(data, fields, FF_UPDATE_FLAGS, MVT_U32);
+            block.mAction = APPLY;
+        }
+    }
+    else if (block.mDataSize >= FULL_HEADER_SIZE)
+    {
+        memcpy(block.mFullID.mData, data + FULL_ID_OFFSET, UUID_BYTES);
+        block.mLocalID = read_u32(data + FULL_LOCAL_ID_OFFSET);
+        block.mPCode = data[FULL_PCODE_OFFSET];
+        if (block.mPCode == 0)
+        {
+            block.mAction = NO_PCODE;
+        }
+        else if (block.mUpdateFlags & FLAGS_TEMPORARY_ON_REZ)
+        {
+            block.mAction = APPLY;
+        }
+        else
+        {
+            block.mAction = CACHE;
+        }
+    }
+    mBlocks.push_back(block);
+}
+
+void LLObjectUpdatePacket::addMessageBlock(LLMessageSystem* mesgsys, S32 block_num)
+{
+    llassert(mType == FULL);
+
+    std::vector<U8> data;
+    copy_message_fields(mesgsys, block_num, data);
+    addBlock(data.data(), (U32)data.size(), 0);
+}
+
+bool LLObjectUpdatePacket::tryDecode()
+{
+    U8 expected = QUEUED;
+    if (!mState.compare_exchange_strong(expected, DECODING, std::memory_order_acquire))
+    {
+        return false;
+    }
+    decode();
+    mState.store(DECODED, std::memory_order_release);
+    mState.notify_all();
+    return true;
+}
+
+void LLObjectUpdatePacket::waitDecoded()
+{
+    if (!tryDecode())
+    {
+        // a worker is at it, and a packet is only a few blocks
+        mState.wait(DECODING, std::memory_order_acquire);
+    }
+}
+
+const LLObjectUpdatePacket::TerseUpdate* LLObjectUpdatePacket::getTerseUpdate(U32 index) const
+{
+    llassert(isDecoded());
+    return index < mTerseUpdates.size() && mTerseUpdates[index].mDecoded ? &mTerseUpdates[index] : nullptr;
+}
+
+const LLObjectUpdatePacket::FullUpdate* LLObjectUpdatePacket::getFullUpdate(U32 index) const
+{
+    llassert(isDecoded());
+    return index < mFullUpdates.size() && mFullUpdates[index].mDecoded ? &mFullUpdates[index] : nullptr;
+}
+
+void LLObjectUpdatePacket::decode()
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    if (mType == TERSE)
+    {
+        mTerseUpdates.resize(mBlocks.size());
+    }
+    else
+    {
+        mFullUpdates.resize(mBlocks.size());
+    }
+    for (size_t i = 0; i < mBlocks.size(); ++i)
+    {
+        const Block& block = mBlocks[i];
+        if (block.mAction != APPLY)
+        {
+            continue;
+        }
+        switch (mType)
+        {
+        case TERSE:
+            decodeTerse(block, mTerseUpdates[i]);
+            break;
+        case COMPRESSED:
+            decodeCompressed(block, mFullUpdates[i]);
+            break;
+        case FULL:
+            decodeFull(getData(block), block.mDataSize, mFullUpdates[i]);
+            break;
+        }
+    }
+}
+
+// Same reads as the OUT_TERSE_IMPROVED case of
+// LLViewerObject::processUpdateMessage() and the terse texture entry of
+// LLVOVolume::processUpdateMessage(). Blocks too short for that are left
+// to the data packer path, which copes with them the way it always did.
+void LLObjectUpdatePacket::decodeTerse(const Block& block, TerseUpdate& update)
+{
+    U8* data = mBuffer.data() + block.mDataOffset + TERSE_HEADER_SIZE;
+    const U32 size = block.mDataSize - TERSE_HEADER_SIZE;
+    if (size < TERSE_MOTION_SIZE || (data[TERSE_AGENT_OFFSET] && size < TERSE_MOTION_SIZE + TERSE_FOOT_PLANE_SIZE))
+    {
+        return;
+    }
+
+    LLDataPackerBinaryBuffer dp(data, size);
+    U8 agent;
+    U16 val[4];
+    dp.unpackU8(update.mState, "State");
+    dp.unpackU8(agent, "agent");
+    if (agent)
+    {
+        dp.unpackVector4(update.mFootPlane, "Plane");
+        update.mHasFootPlane = true;
+    }
+    dp.unpackVector3(update.mPosition, "Pos");
+    dp.unpackU16(val[VX], "VelX");
+    dp.unpackU16(val[VY], "VelY");
+    dp.unpackU16(val[VZ], "VelZ");
+    update.mVelocity.set(U16_to_F32(val[VX], -128.f, 128.f),
+                         U16_to_F32(val[VY], -128.f, 128.f),
+                         U16_to_F32(val[VZ], -128.f, 128.f));
+    dp.unpackU16(val[VX], "AccX");
+    dp.unpackU16(val[VY], "AccY");
+    dp.unpackU16(val[VZ], "AccZ");
+    update.mAcceleration.set(U16_to_F32(val[VX], -64.f, 64.f),
+                             U16_to_F32(val[VY], -64.f, 64.f),
+                             U16_to_F32(val[VZ], -64.f, 64.f));
+    dp.unpackU16(val[VX], "ThetaX");
+    dp.unpackU16(val[VY], "ThetaY");
+    dp.unpackU16(val[VZ], "ThetaZ");
+    dp.unpackU16(val[VS], "ThetaS");
+    update.mRotation.mQ[VX] = U16_to_F32(val[VX], -1.f, 1.f);
+    update.mRotation.mQ[VY] = U16_to_F32(val[VY], -1.f, 1.f);
+    update.mRotation.mQ[VZ] = U16_to_F32(val[VZ], -1.f, 1.f);
+    update.mRotation.mQ[VS] = U16_to_F32(val[VS], -1.f, 1.f);
+    dp.unpackU16(val[VX], "AccX");
+    dp.unpackU16(val[VY], "AccY");
+    dp.unpackU16(val[VZ], "AccZ");
+    update.mAngularVelocity.set(U16_to_F32(val[VX], -64.f, 64.f),
+                                U16_to_F32(val[VY], -64.f, 64.f),
+                                U16_to_F32(val[VZ], -64.f, 64.f));
+    update.mDecoded = true;
+
+    if (block.mTextureEntrySize)
+    {
+        // the field is size prefixed
+        LLDataPackerBinaryBuffer tdp(mBuffer.data() + block.mTextureEntryOffset, block.mTextureEntrySize);
+        U8 packed_buffer[MAX_TEXTURE_ENTRY_SIZE];
+        S32 te_size = 0;
+        if (!tdp.unpackBinaryData(packed_buffer, te_size, "TextureEntry"))
+        {
+            LL_WARNS() << "Bad texture entry block!  Abort!" << LL_ENDL;
+        }
+        else
+        {
+            update.mTextureEntry = parse_texture_entry(packed_buffer, te_size);
+        }
+    }
+}
+
+void LLObjectUpdatePacket::decodeCompressed(const Block& block, FullUpdate& update)
+{
+    // zero terminated, a string running off the end stops there
+    U8 data[MAX_DATA_SIZE + 1];
+    const S32 size = block.mDataSize - FULL_HEADER_SIZE;
+    memcpy(data, getData(block) + FULL_HEADER_SIZE, size);
+    data[size] = 0;
+    LLDataPackerBinaryBuffer dp(data, size);
+    decodeCompressed(dp, block.mPCode, update);
+    update.mUpdateFlags = block.mUpdateFlags;
+}
+
+// static
+// What the OUT_FULL_COMPRESSED and OUT_FULL_CACHED cases of
+// LLViewerObject::processUpdateMessage() and the volume part of
+// LLVOVolume::processUpdateMessage() apply. A block that runs short leaves
+// the rest at its defaults, as reading it through the data packer did.
+void LLObjectUpdatePacket::decodeCompressed(LLDataPackerBinaryBuffer& dp, LLPCode pcode, FullUpdate& update)
+{
+    // no field can be larger than a block
+    U8 scratch[MAX_DATA_SIZE];
+    S32 scratch_size = 0;
+    bool ok = true;
+    ok &= dp.unpackU8(update.mState, "State");
+    ok &= dp.unpackU32(update.mCRC, "CRC");
+    ok &= dp.unpackU8(update.mMaterial, "Material");
+    ok &= dp.unpackU8(update.mClickAction, "ClickAction");
+    ok &= dp.unpackVector3(update.mScale, "Scale");
+    ok &= dp.unpackVector3(update.mPosition, "Pos");
+    LLVector3 vec;
+    ok &= dp.unpackVector3(vec, "Rot");
+    update.mRotation.unpackFromVector3(vec);
+    update.mHasMotion = true;
+
+    U32 value = 0;
+    ok &= dp.unpackU32(value, "SpecialCode");
+    update.mSpecialCode = value;
+    ok &= dp.unpackUUID(update.mOwnerID, "Owner");
+
+    if (value & 0x80)
+    {
+        ok &= dp.unpackVector3(update.mAngularVelocity, "Omega");
+    }
+    if (value & 0x20)
+    {
+        ok &= dp.unpackU32(update.mParentID, "ParentID");
+    }
+    if (value & 0x2)
+    {
+        U8 tree_data = 0;
+        ok &= dp.unpackU8(tree_data, "TreeData");
+        update.mHasData = true;
+        update.mData.assign(1, tree_data);
+    }
+    else if (value & 0x1)
+    {
+        U32 scratch_pad_size;
+        ok &= dp.unpackU32(scratch_pad_size, "ScratchPadSize");
+        if (ok && unpack_binary_data(dp, scratch, scratch_size, sizeof(scratch), "PartData"))
+        {
+            update.mHasData = true;
+            update.mData.assign(scratch, scratch + scratch_size);
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    if (value & 0x4)
+    {
+        update.mHasText = true;
+        ok &= dp.unpackString(update.mText, "Text");
+        ok &= dp.unpackBinaryDataFixed(update.mTextColor.mV, 4, "Color");
+    }
+    if (value & 0x200)
+    {
+        ok &= dp.unpackString(update.mMediaURL, "MediaURL");
+    }
+    if (value & 0x8)
+    {
+        // legacy particle system
+        auto particles = std::make_shared<LLPartSysData>();
+        if (particles->unpackLegacy(dp))
+        {
+            update.mParticles = particles;
+        }
+    }
+
+    U8 num_parameters = 0;
+    ok &= dp.unpackU8(num_parameters, "num_params");
+    for (U8 param = 0; ok && param < num_parameters; ++param)
+    {
+        U16 param_type;
+        ok &= dp.unpackU16(param_type, "param_type");
+        if (ok && unpack_binary_data(dp, scratch, scratch_size, sizeof(scratch), "param_data"))
+        {
+            update.mExtraParams.push_back({ param_type, std::vector<U8>(scratch, scratch + scratch_size) });
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+
+    if (value & 0x10)
+    {
+        ok &= dp.unpackUUID(update.mSoundID, "SoundUUID");
+        ok &= dp.unpackF32(update.mGain, "SoundGain");
+        ok &= dp.unpackU8(update.mSoundFlags, "SoundFlags");
+        ok &= dp.unpackF32(update.mSoundRadius, "SoundRadius");
+    }
+    if (value & 0x100)
+    {
+        update.mHasNameValues = true;
+        ok &= dp.unpackString(update.mNameValues, "NV");
+    }
+
+    if (pcode == LL_PCODE_VOLUME)
+    {
+        update.mHasVolume = true;
+        if (ok && dp.getBufferSize() - dp.getCurrentSize() >= (S32)VOLUME_PARAMS_SIZE)
+        {
+            update.mVolumeParamsValid = LLVolumeMessage::unpackVolumeParams(&update.mVolumeParams, dp);
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if (ok && unpack_binary_data(dp, scratch, scratch_size, sizeof(scratch), "TextureEntry"))
+        {
+            update.mTextureEntry = parse_texture_entry(scratch, scratch_size);
+        }
+        else
+        {
+            update.mTextureEntryInvalid = true;
+            ok = false;
+        }
+
+        if (value & 0x40)
+        {
+            // LLTextureAnim::unpackTAMessage() trusts the size it reads,
+            // one it would not take leaves the animation off
+            update.mHasTextureAnim = true;
+            S32 anim_size = -1;
+            if (ok && dp.getBufferSize() - dp.getCurrentSize() >= (S32)sizeof(S32))
+            {
+                htolememcpy(&anim_size, dp.getBuffer() + dp.getCurrentSize(), MVT_S32, sizeof(S32));
+            }
+            if (anim_size >= 0 && anim_size <= (S32)TEXTURE_ANIM_SIZE)
+            {
+                update.mTextureAnim.unpackTAMessage(dp);
+            }
+            else
+            {
+                ok = false;
+            }
+        }
+        if (ok && (value & 0x400))
+        {
+            // new particle system
+            auto particles = std::make_shared<LLPartSysData>();
+            if (particles->unpack(dp))
+            {
+                update.mVolumeParticles = particles;
+            }
+        }
+    }
+    update.mDecoded = true;
+}
+
+// static
+void LLObjectUpdatePacket::decodeMessageBlock(LLMessageSystem* mesgsys, S32 block_num, FullUpdate& update)
+{
+    std::vector<U8> data;
+    copy_message_fields(mesgsys, block_num, data);
+    decodeFull(data.data(), (U32)data.size(), update);
+}
+
+// static
+// What the OUT_FULL case of LLViewerObject::processUpdateMessage() and
+// LLVOVolume::processUpdateMessage() apply, from the fields
+// copy_message_fields() copied
+void LLObjectUpdatePacket::decodeFull(const U8* data, U32 size, FullUpdate& update)
+{
+    FieldTable fields;
+    if (!read_fields(data, size, fields))
+    {
+        return;
+    }
+
+    update.mUpdateFlags = get_field<U32>(data, fields, FF_UPDATE_FLAGS, MVT_U32);
+    update.mState = get_field<U8>(data, fields, FF_STATE, MVT_U8);
+    update.mCRC = get_field<U32>(data, fields, FF_CRC, MVT_U32);
+    update.mMaterial = get_field<U8>(data, fields, FF_MATERIAL, MVT_U8);
+    update.mClickAction = get_field<U8>(data, fields, FF_CLICK_ACTION, MVT_U8);
+    update.mScale = get_vector3(data, fields, FF_SCALE);
+    update.mParentID = get_field<U32>(data, fields, FF_PARENT_ID, MVT_U32);
+    update.mSoundID = get_uuid(data, fields, FF_SOUND);
+    update.mOwnerID = get_uuid(data, fields, FF_OWNER_ID);
+    update.mGain = get_field<F32>(data, fields, FF_GAIN, MVT_F32);
+    update.mSoundFlags = get_field<U8>(data, fields, FF_FLAGS, MVT_U8);
+    update.mSoundRadius = get_field<F32>(data, fields, FF_RADIUS, MVT_F32);
+
+    // the message path cuts the field to its buffer the same way
+    const S32 length = llmin((S32)fields.mSize[FF_OBJECT_DATA], MAX_OBJECT_BINARY_DATA_SIZE);
+    const U8* motion = data + fields.mOffset[FF_OBJECT_DATA];
+    update.mMotionSize = length;
+    switch (length)
+    {
+    case OBJECTDATA_FIELD_SIZE_140:
+    case OBJECTDATA_FIELD_SIZE_76:
+        // collision normal for avatars
+        htolememcpy(update.mFootPlane.mV, motion, MVT_LLVector4, sizeof(LLVector4));
+        update.mHasFootPlane = true;
+        motion += sizeof(LLVector4);
+        [[fallthrough]];
+    case OBJECTDATA_FIELD_SIZE_124:
+    case OBJECTDATA_FIELD_SIZE_60:
+        {
+            htolememcpy(update.mPosition.mV, motion, MVT_LLVector3, sizeof(LLVector3));
+            motion += sizeof(LLVector3);
+            htolememcpy(update.mVelocity.mV, motion, MVT_LLVector3, sizeof(LLVector3));
+            motion += sizeof(LLVector3);
+            htolememcpy(update.mAcceleration.mV, motion, MVT_LLVector3, sizeof(LLVector3));
+            motion += sizeof(LLVector3);
+            LLVector3 vec;
+            htolememcpy(vec.mV, motion, MVT_LLVector3, sizeof(LLVector3));
+            update.mRotation.unpackFromVector3(vec);
+            motion += sizeof(LLVector3);
+            htolememcpy(update.mAngularVelocity.mV, motion, MVT_LLVector3, sizeof(LLVector3));
+            update.mHasMotion = true;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (fields.mSize[FF_NAME_VALUE] > 0)
+    {
+        update.mHasNameValues = true;
+        update.mNameValues = get_string(data, fields, FF_NAME_VALUE);
+    }
+    if (fields.mSize[FF_DATA] > 0)
+    {
+        const U8* generic_data = data + fields.mOffset[FF_DATA];
+        update.mHasData = true;
+        update.mData.assign(generic_data, generic_data + fields.mSize[FF_DATA]);
+    }
+    if (fields.mSize[FF_TEXT] > 1)
+    {
+        update.mHasText = true;
+        update.mText = get_string(data, fields, FF_TEXT);
+        if (fields.mSize[FF_TEXT_COLOR] == 4)
+        {
+            memcpy(update.mTextColor.mV, data + fields.mOffset[FF_TEXT_COLOR], 4);
+        }
+    }
+    update.mMediaURL = get_string(data, fields, FF_MEDIA_URL);
+
+    const U8* ps_block = data + fields.mOffset[FF_PS_BLOCK];
+    if (!LLPartSysData::isNullPS(ps_block, fields.mSize[FF_PS_BLOCK]))
+    {
+        auto particles = std::make_shared<LLPartSysData>();
+        if (particles->unpackBlock(ps_block, fields.mSize[FF_PS_BLOCK]))
+        {
+            update.mParticles = particles;
+        }
+    }
+
+    if (fields.mSize[FF_EXTRA_PARAMS] > 0)
+    {
+        // a Variable 1 field, so are its parameters
+        U8 buffer[256];
+        U8 param_block[256];
+        const U32 size = fields.mSize[FF_EXTRA_PARAMS];
+        memcpy(buffer, data + fields.mOffset[FF_EXTRA_PARAMS], size);
+        LLDataPackerBinaryBuffer dp(buffer, size);
+        U8 num_parameters = 0;
+        dp.unpackU8(num_parameters, "num_params");
+        for (U8 param = 0; param < num_parameters; ++param)
+        {
+            U16 param_type;
+            S32 param_size;
+            if (!dp.unpackU16(param_type, "param_type") || !dp.unpackBinaryData(param_block, param_size, "param_data"))
+            {
+                break;
+            }
+            update.mExtraParams.push_back({ param_type, std::vector<U8>(param_block, param_block + param_size) });
+        }
+    }
+
+    if (get_field<U8>(data, fields, FF_PCODE, MVT_U8) == LL_PCODE_VOLUME)
+    {
+        U8 volume_data[VOLUME_PARAMS_SIZE] = { 0 };
+        U32 volume_size = 0;
+        for (S32 i = FF_PATH_CURVE; i <= FF_PROFILE_HOLLOW && volume_size + fields.mSize[i] <= VOLUME_PARAMS_SIZE; ++i)
+        {
+            memcpy(volume_data + volume_size, data + fields.mOffset[i], fields.mSize[i]);
+            volume_size += fields.mSize[i];
+        }
+        LLDataPackerBinaryBuffer dp(volume_data, VOLUME_PARAMS_SIZE);
+        update.mVolumeParamsValid = LLVolumeMessage::unpackVolumeParams(&update.mVolumeParams, dp);
+
+        update.mTextureEntry = parse_texture_entry(data + fields.mOffset[FF_TEXTURE_ENTRY], fields.mSize[FF_TEXTURE_ENTRY]);
+
+        // as LLTextureAnim::unpackTAMessage() reads it from the message
+        const U32 anim_size = fields.mSize[FF_TEXTURE_ANIM];
+        if (anim_size)
+        {
+            update.mHasTextureAnim = true;
+            LLTextureAnim& anim = update.mTextureAnim;
+            if (anim_size != TEXTURE_ANIM_SIZE)
+            {
+                LL_WARNS() << "Bad size " << anim_size << " for TA block, ignoring." << LL_ENDL;
+                anim.mMode = 0;
+            }
+            else
+            {
+                const U8* anim_data = data + fields.mOffset[FF_TEXTURE_ANIM];
+                anim.mMode = anim_data[0];
+                anim.mFace = anim_data[1];
+                if (anim.mMode & LLTextureAnim::SMOOTH)
+                {
+                    anim.mSizeX = anim_data[2];
+                    anim.mSizeY = anim_data[3];
+                }
+                else
+                {
+                    anim.mSizeX = llmax((U8)1, anim_data[2]);
+                    anim.mSizeY = llmax((U8)1, anim_data[3]);
+                }
+                htolememcpy(&anim.mStart, anim_data + 4, MVT_F32, sizeof(F32));
+                htolememcpy(&anim.mLength, anim_data + 8, MVT_F32, sizeof(F32));
+                htolememcpy(&anim.mRate, anim_data + 12, MVT_F32, sizeof(F32));
+            }
+        }
+        update.mHasVolume = true;
+    }
+    update.mDecoded = true;
+}
+
+// static
+void LLObjectUpdatePacket::writeHeader(std::ostream& out)
+{
+    out.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    write_value(out, CAPTURE_VERSION);
+}
+
+// static
+bool LLObjectUpdatePacket::readHeader(std::istream& in)
+{
+    char magic[sizeof(CAPTURE_MAGIC)];
+    U32 version = 0;
+    return in.read(magic, sizeof(magic))
+        && !memcmp(magic, CAPTURE_MAGIC, sizeof(magic))
+        && read_value(in, version)
+        && version == CAPTURE_VERSION;
+}
+
+void LLObjectUpdatePacket::write(std::ostream& out, U32 arrival_ms) const
+{
+    write_value(out, arrival_ms);
+    write_value(out, (U8)mType);
+    write_value(out, mRegionHandle);
+    write_value(out, mTimeDilation);
+    write_value(out, mSender.getAddress());
+    write_value(out, (U32)mSender.getPort());
+    write_value(out, mPacketID);
+    write_value(out, (U32)mBlocks.size());
+    for (const Block& block : mBlocks)
+    {
+        write_value(out, block.mUpdateFlags);
+        write_value(out, block.mDataSize);
+        out.write(reinterpret_cast<const char*>(getData(block)), block.mDataSize);
+        write_value(out, block.mTextureEntrySize);
+        out.write(reinterpret_cast<const char*>(getTextureEntry(block)), block.mTextureEntrySize);
+    }
+}
+
+// static
+std::shared_ptr<LLObjectUpdatePacket> LLObjectUpdatePacket::read(std::istream& in, U32& arrival_ms)
+{
+    U8 type;
+    U64 region_handle;
+    U16 time_dilation;
+    U32 address, port, packet_id, block_count;
+    if (!read_value(in, arrival_ms) || !read_value(in, type) || type > FULL
+        || !read_value(in, region_handle) || !read_value(in, time_dilation)
+        || !read_value(in, address) || !read_value(in, port) || !read_value(in, packet_id)
+        || !read_value(in, block_count))
+    {
+        return nullptr;
+    }
+
+    auto packet = std::make_shared<LLObjectUpdatePacket>((EType)type, region_handle, time_dilation, LLHost(address, port), packet_id);
+    const U32 max_data_size = type == FULL ? MAX_FULL_DATA_SIZE : MAX_DATA_SIZE;
+    std::vector<U8> data(max_data_size);
+    U8 texture_entry[MAX_TEXTURE_ENTRY_SIZE];
+    for (U32 i = 0; i < block_count; ++i)
+    {
+        U32 flags, data_size, texture_entry_size;
+        if (!read_value(in, flags) || !read_value(in, data_size) || data_size > max_data_size
+            || !in.read(reinterpret_cast<char*>(data.data()), data_size)
+            || !read_value(in, texture_entry_size) || texture_entry_size > MAX_TEXTURE_ENTRY_SIZE
+            || !in.read(reinterpret_cast<char*>(texture_entry), texture_entry_size))
+        {
+            return nullptr;
+        }
+        packet->addBlock(data.data(), data_size, flags, texture_entry, texture_entry_size);
+    }
+    return packet;
+}
+
+LLObjectUpdateQueue::LLObjectUpdateQueue(const std::string& pool)
+:   mPool(pool)
+{
+}
+
+void LLObjectUpdateQueue::push(const packet_ptr_t& packet)
+{
+    const U32 sequence = getEndSequence();
+    const LLHost& sender = packet->getSender();
+    for (U32 i = 0; i < packet->getBlockCount(); ++i)
+    {
+        LLObjectUpdatePacket::Block& block = packet->getBlock(i);
+        const U64 key = getKey(sender, block.mLocalID);
+        Pending& pending = mPending[key];
+        if (!pending.mCount || !pending.hasUnapplied())
+        {
+            pending.mFirstSequence = sequence;
+        }
+        ++pending.mCount;
+        pending.mSequence = sequence;
+        if (block.mFullID.notNull())
+        {
+            pending.mFullID = block.mFullID;
+            mPendingIDs[block.mFullID] = key;
+        }
+
+        // A terse update carries the whole motion state, so the newer one
+        // makes an older one without a texture entry pointless. The key
+        // can collide, hence the checks.
+        if (packet->isTerse() && !block.mTextureEntrySize)
+        {
+            if (pending.mTersePacket && pending.mTersePacket->getSender() == sender)
+            {
+                LLObjectUpdatePacket::Block& older = pending.mTersePacket->getBlock(pending.mTerseBlock);
+                if (older.mLocalID == block.mLocalID && !older.mSuperseded && !older.mApplied)
+                {
+                    older.mSuperseded = true;
+                    ++mSupersededCount;
+                }
+            }
+            pending.mTersePacket = packet.get();
+            pending.mTerseBlock = i;
+        }
+        else
+        {
+            pending.mTersePacket = nullptr;
+        }
+    }
+    mPackets.push_back(packet);
+    schedule();
+}
+
+void LLObjectUpdateQueue::schedule()
+{
+    if (mPool.empty())
+    {
+        return;
+    }
+
+    if ((S32)(mScheduleSequence - mFrontSequence) < 0)
+    {
+        mScheduleSequence = mFrontSequence;
+    }
+    // Decoded packets hold several times what they came in, the ones far
+    // back wait until the queue gets to them
+    while (mScheduleSequence != getEndSequence() && mScheduleSequence - mFrontSequence < DECODE_AHEAD)
+    {
+        mUndispatched.push_back(mPackets[mScheduleSequence - mFrontSequence]);
+        ++mScheduleSequence;
+    }
+    if (mUndispatched.size() >= DISPATCH_BATCH)
+    {
+        dispatch();
+    }
+}
+
+void LLObjectUpdateQueue::dispatch()
+{
+    if (mUndispatched.empty())
+    {
+        return;
+    }
+
+    // Posting each packet on its own costs about as much as decoding it.
+    // If the pool is gone, apply() decodes them instead.
+    LL::WorkQueue::ptr_t queue = LL::WorkQueue::getInstance(mPool);
+    auto batch = std::make_shared<std::vector<packet_ptr_t> >();
+    batch->swap(mUndispatched);
+    if (queue)
+    {
+        queue->tryPost([batch]()
+            {
+                for (const packet_ptr_t& packet : *batch)
+                {
+                    packet->tryDecode();
+                }
+            });
+    }
+}
+
+U32 LLObjectUpdateQueue::apply(const apply_func_t& apply_block, U32 until, const LLTimer* timer, F32 max_time)
+{
+    U32 applied = 0;
+    bool out_of_time = false;
+    while (!out_of_time && !mPackets.empty() && (S32)(mFrontSequence - until) < 0)
+    {
+        LLObjectUpdatePacket& packet = *mPackets.front();
+        packet.waitDecoded();
+        const U32 count = packet.getBlockCount();
+        while (mNextBlock < count && !out_of_time)
+        {
+            const U32 index = mNextBlock++;
+            const LLObjectUpdatePacket::Block& block = packet.getBlock(index);
+            if (block.mSuperseded || block.mApplied)
+            {
+                continue;
+            }
+            apply_block(packet, index);
+            ++applied;
+            out_of_time = timer && timer->getElapsedTimeF32() > max_time;
+        }
+        if (mNextBlock >= count)
+        {
+            pop();
+        }
+    }
+    schedule();
+    return applied;
+}
+
+U32 LLObjectUpdateQueue::applyPending(const LLHost& sender, U32 local_id, const apply_func_t& apply_block)
+{
+    auto iter = mPending.find(getKey(sender, local_id));
+    if (iter == mPending.end() || !iter->second.hasUnapplied())
+    {
+        return 0;
+    }
+
+    const U32 first = (S32)(iter->second.mFirstSequence - mFrontSequence) > 0 ? iter->second.mFirstSequence : mFrontSequence;
+    const U32 last = iter->second.mSequence;
+    // before applying, nothing of the object is left once done
+    iter->second.mFirstSequence = last + 1;
+
+    U32 applied = 0;
+    for (U32 sequence = first; (S32)(sequence - last) <= 0; ++sequence)
+    {
+        // the queue does not change while applying
+        LLObjectUpdatePacket& packet = *mPackets[sequence - mFrontSequence];
+        if (packet.getSender() != sender)
+        {
+            continue;
+        }
+        bool decoded = false;
+        for (U32 i = sequence == mFrontSequence ? mNextBlock : 0; i < packet.getBlockCount(); ++i)
+        {
+            LLObjectUpdatePacket::Block& block = packet.getBlock(i);
+            if (block.mLocalID != local_id || block.mSuperseded || block.mApplied)
+            {
+                continue;
+            }
+            if (!decoded)
+            {
+                packet.waitDecoded();
+                decoded = true;
+            }
+            block.mApplied = true;
+            apply_block(packet, i);
+            ++applied;
+        }
+    }
+    return applied;
+}
+
+void LLObjectUpdateQueue::pop()
+{
+    if (mPackets.empty())
+    {
+        return;
+    }
+
+    packet_ptr_t packet = mPackets.front();
+    mPackets.pop_front();
+    ++mFrontSequence;
+    mNextBlock = 0;
+
+    const LLHost& sender = packet->getSender();
+    for (U32 i = 0; i < packet->getBlockCount(); ++i)
+    {
+        auto iter = mPending.find(getKey(sender, packet->getBlock(i).mLocalID));
+        if (iter == mPending.end())
+        {
+            continue;
+        }
+        Pending& pending = iter->second;
+        if (pending.mTersePacket == packet.get())
+        {
+            pending.mTersePacket = nullptr;
+        }
+        if (--pending.mCount == 0)
+        {
+            if (pending.mFullID.notNull())
+            {
+                auto id_iter = mPendingIDs.find(pending.mFullID);
+                if (id_iter != mPendingIDs.end() && id_iter->second == iter->first)
+                {
+                    mPendingIDs.erase(id_iter);
+                }
+            }
+            mPending.erase(iter);
+        }
+    }
+}
+
+U32 LLObjectUpdateQueue::getPendingSequence(const LLHost& sender, U32 local_id) const
+{
+    auto iter = mPending.find(getKey(sender, local_id));
+    return iter != mPending.end() && iter->second.hasUnapplied() ? iter->second.mSequence : 0;
+}
+
+U32 LLObjectUpdateQueue::getPendingSequence(const LLHost& sender, const LLUUID& id, U32& local_id) const
+{
+    auto id_iter = mPendingIDs.find(id);
+    if (id_iter == mPendingIDs.end())
+    {
+        return 0;
+    }
+    // the key holds the local id and what the sender hashes to
+    local_id = (U32)(id_iter->second >> 32);
+    if (id_iter->second != getKey(sender, local_id))
+    {
+        return 0;
+    }
+    return getPendingSequence(sender, local_id);
+}
+
+void LLObjectUpdateQueue::clear()
+{
+    mFrontSequence += (U32)mPackets.size();
+    mNextBlock = 0;
+    mScheduleSequence = mFrontSequence;
+    mPackets.clear();
+    mUndispatched.clear();
+    mPending.clear();
+    mPendingIDs.clear();
+}
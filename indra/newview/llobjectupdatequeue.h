@@ -0,0 +1,361 @@
+/**
+ * @file llobjectupdatequeue.h
+ * @brief Object update packets applied within a per frame time budget.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLOBJECTUPDATEQUEUE_H
+#define LL_LLOBJECTUPDATEQUEUE_H
+
+#include "llhost.h"
+#include "llpartdata.h"
+#include "llquaternion.h"
+#include "lltextureanim.h"
+#include "lluuid.h"
+#include "llvolume.h"
+#include "v3math.h"
+#include "v4coloru.h"
+#include "v4math.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class LLDataPackerBinaryBuffer;
+class LLMessageSystem;
+class LLTimer;
+struct LLTEContents;
+
+/**
+ * The blocks of one ObjectUpdate, ObjectUpdateCompressed or
+ * ImprovedTerseObjectUpdate message, copied out of the message system.
+ *
+ * addBlock() and addMessageBlock() read the block header into plain
+ * fields and sort the block by what has to be done with it. decode(),
+ * which may run on a worker thread, unpacks the blocks to be applied into
+ * TerseUpdate or FullUpdate, texture entry and particle system included,
+ * so the main thread only copies the values into the object. Compressed
+ * blocks for the region's object cache keep their data as it came, the
+ * cache stores those bytes and creating an object from it decodes them
+ * with decodeCompressed(), as updates handled right away do.
+ */
+class LLObjectUpdatePacket
+{
+public:
+    // largest block data and texture entry the viewer reads
+    static constexpr U32 MAX_DATA_SIZE = 2048;
+    static constexpr U32 MAX_TEXTURE_ENTRY_SIZE = 1024;
+    // an ObjectUpdate block is a few hundred bytes, the message buffer
+    // could not hold this
+    static constexpr U32 MAX_FULL_DATA_SIZE = 65536;
+    // header addBlock() reads, the rest is for LLViewerObject::processUpdateMessage()
+    static constexpr U32 FULL_HEADER_SIZE = 21;     // ID, LocalID, PCode
+    static constexpr U32 TERSE_HEADER_SIZE = 4;     // LocalID
+
+    enum EType : U8
+    {
+        TERSE,          // ImprovedTerseObjectUpdate
+        COMPRESSED,     // ObjectUpdateCompressed
+        FULL            // ObjectUpdate, its fields one after the other
+    };
+
+    enum EAction : U8
+    {
+        APPLY,      // update an object, or create it
+        CACHE,      // compressed update for the region's object cache
+        NO_PCODE,   // compressed update without a pcode, object creation would fail
+        BAD         // too short to hold its header
+    };
+
+    struct Block
+    {
+        U32 mDataOffset = 0;
+        U32 mDataSize = 0;
+        U32 mTextureEntryOffset = 0;
+        U32 mTextureEntrySize = 0;
+        U32 mUpdateFlags = 0;
+        U32 mLocalID = 0;
+        LLUUID mFullID;         // full updates only, terse ones look it up
+        LLPCode mPCode = 0;
+        EAction mAction = BAD;
+
+        // a later terse update of the object replaces it
+        bool mSuperseded = false;
+        // applied ahead of its packet, see LLObjectUpdateQueue::applyPending()
+        bool mApplied = false;
+    };
+
+    // A terse block as LLViewerObject::processUpdateMessage() reads it
+    struct TerseUpdate
+    {
+        bool mDecoded = false;      // false if the block was too short
+        U8 mState = 0;
+        bool mHasFootPlane = false; // avatars only
+        LLVector4 mFootPlane;
+        LLVector3 mPosition;
+        LLVector3 mVelocity;
+        LLVector3 mAcceleration;
+        LLQuaternion mRotation;
+        LLVector3 mAngularVelocity;
+        // parsed for LLTEContents::MAX_TES faces, null without a texture
+        // entry or if it did not parse
+        std::shared_ptr<LLTEContents> mTextureEntry;
+    };
+
+    struct ExtraParam
+    {
+        U16 mType = 0;
+        std::vector<U8> mData;
+    };
+
+    // A full block of either kind as LLViewerObject::processUpdateMessage()
+    // and LLVOVolume::processUpdateMessage() read it
+    struct FullUpdate
+    {
+        bool mDecoded = false;      // false if the fields did not read
+        U32 mUpdateFlags = 0;
+        U8 mState = 0;
+        U32 mCRC = 0;
+        U8 mMaterial = 0;
+        U8 mClickAction = 0;
+        LLVector3 mScale;
+        U32 mParentID = 0;
+        LLUUID mOwnerID;
+        U32 mSpecialCode = 0;       // compressed only, which fields it has
+
+        // ObjectUpdate sends all of it in its ObjectData field, unless the
+        // field has a size the viewer does not know
+        S32 mMotionSize = 0;
+        bool mHasMotion = false;
+        bool mHasFootPlane = false;
+        LLVector4 mFootPlane;
+        LLVector3 mPosition;
+        LLVector3 mVelocity;
+        LLVector3 mAcceleration;
+        LLQuaternion mRotation;
+        LLVector3 mAngularVelocity;
+
+        // tree genome, prim count or scratch pad
+        bool mHasData = false;
+        std::vector<U8> mData;
+        bool mHasText = false;
+        std::string mText;
+        LLColor4U mTextColor;
+        std::string mMediaURL;
+        bool mHasNameValues = false;
+        std::string mNameValues;
+        LLUUID mSoundID;
+        F32 mGain = 0.f;
+        U8 mSoundFlags = 0;
+        F32 mSoundRadius = 0.f;
+        // the ObjectUpdate PSBlock or the legacy compressed one, null if
+        // there is none or it did not unpack
+        std::shared_ptr<LLPartSysData> mParticles;
+        std::vector<ExtraParam> mExtraParams;
+
+        // volumes only
+        bool mHasVolume = false;
+        bool mVolumeParamsValid = false;
+        LLVolumeParams mVolumeParams;
+        // parsed for LLTEContents::MAX_TES faces, null without a texture
+        // entry or if it did not parse
+        std::shared_ptr<LLTEContents> mTextureEntry;
+        // compressed only, the block ran out before its texture entry
+        bool mTextureEntryInvalid = false;
+        bool mHasTextureAnim = false;
+        LLTextureAnim mTextureAnim;
+        // compressed only, the particle system that follows the volume
+        std::shared_ptr<LLPartSysData> mVolumeParticles;
+    };
+
+    LLObjectUpdatePacket(EType type, U64 region_handle, U16 time_dilation, const LLHost& sender, U32 packet_id);
+
+    EType getType() const { return mType; }
+    bool isTerse() const { return mType == TERSE; }
+    U64 getRegionHandle() const { return mRegionHandle; }
+    U16 getTimeDilation() const { return mTimeDilation; }
+    const LLHost& getSender() const { return mSender; }
+    U32 getPacketID() const { return mPacketID; }
+
+    void reserve(U32 blocks, U32 bytes);
+    // Copies a block, truncating it to what the viewer would have read,
+    // and reads its header. For ObjectUpdate packets the data is what
+    // addMessageBlock() made of the block.
+    void addBlock(const U8* data, U32 size, U32 update_flags, const U8* texture_entry = nullptr, U32 texture_entry_size = 0);
+    // Copies the fields of an ObjectUpdate block
+    void addMessageBlock(LLMessageSystem* mesgsys, S32 block_num);
+
+    U32 getBlockCount() const { return (U32)mBlocks.size(); }
+    const Block& getBlock(U32 index) const { return mBlocks[index]; }
+    Block& getBlock(U32 index) { return mBlocks[index]; }
+    const U8* getData(const Block& block) const { return mBuffer.data() + block.mDataOffset; }
+    const U8* getTextureEntry(const Block& block) const { return mBuffer.data() + block.mTextureEntryOffset; }
+
+    // Decodes the packet unless another thread has started on it. Once
+    // all blocks are added, from any thread.
+    bool tryDecode();
+    // Decodes the packet here, or waits for the thread that is at it
+    void waitDecoded();
+    bool isDecoded() const { return mState.load(std::memory_order_acquire) == DECODED; }
+    // The decoded terse block, null for other packets and blocks that did
+    // not decode. Only once decoded.
+    const TerseUpdate* getTerseUpdate(U32 index) const;
+    // The decoded full block, null for terse packets, cached blocks and
+    // ObjectUpdate blocks whose fields did not read. Only once decoded.
+    const FullUpdate* getFullUpdate(U32 index) const;
+
+    // Capture files for replaying an arrival: a header, then packets with
+    // the milliseconds since capturing started, until the end of the file
+    static void writeHeader(std::ostream& out);
+    static bool readHeader(std::istream& in);
+    void write(std::ostream& out, U32 arrival_ms) const;
+    static std::shared_ptr<LLObjectUpdatePacket> read(std::istream& in, U32& arrival_ms);
+
+    // The one decoder for full updates, also for those handled right away
+    // and objects created from the region's cache. The compressed one reads
+    // what follows the ID, LocalID and PCode; the update flags are not in
+    // the data and are left to the caller.
+    static void decodeCompressed(LLDataPackerBinaryBuffer& dp, LLPCode pcode, FullUpdate& update);
+    static void decodeMessageBlock(LLMessageSystem* mesgsys, S32 block_num, FullUpdate& update);
+
+private:
+    enum EState : U8
+    {
+        QUEUED,
+        DECODING,
+        DECODED
+    };
+
+    void decode();
+    void decodeTerse(const Block& block, TerseUpdate& update);
+    void decodeCompressed(const Block& block, FullUpdate& update);
+    static void decodeFull(const U8* data, U32 size, FullUpdate& update);
+
+    EType mType;
+    U64 mRegionHandle;
+    U16 mTimeDilation;
+    LLHost mSender;
+    U32 mPacketID;
+    std::vector<U8> mBuffer;
+    std::vector<Block> mBlocks;
+    std::vector<TerseUpdate> mTerseUpdates;
+    std::vector<FullUpdate> mFullUpdates;
+    std::atomic<U8> mState{ QUEUED };
+};
+
+/**
+ * Update packets in arrival order, applied a block at a time for as long
+ * as the frame's budget allows. A packet cut short is resumed from its
+ * next block.
+ *
+ * Packets near the front are handed to the "General" pool in batches, so
+ * they are usually decoded by the time they are applied, while the ones
+ * further back stay as they came and take no more memory than that. The
+ * main thread decodes a packet itself when no worker has started on it.
+ *
+ * Also tracks which objects have updates waiting, so a message handled
+ * right away can first apply what is queued for its objects, and drops a
+ * queued terse update when a newer one for the same object arrives.
+ * Everything but the decoding is main thread only.
+ */
+class LLObjectUpdateQueue
+{
+public:
+    typedef std::shared_ptr<LLObjectUpdatePacket> packet_ptr_t;
+    typedef std::function<void(const LLObjectUpdatePacket& packet, U32 block)> apply_func_t;
+
+    // packets ahead of the one being applied that are handed to the pool
+    static constexpr U32 DECODE_AHEAD = 256;
+
+    // Without a pool, packets are decoded when applied
+    explicit LLObjectUpdateQueue(const std::string& pool = std::string());
+
+    void push(const packet_ptr_t& packet);
+    // Hands what push() and apply() have batched up to the pool
+    void dispatch();
+
+    // Calls apply_block for the queued blocks of the packets before the
+    // sequence until, skipping superseded ones, and pops the finished
+    // packets. With a timer, stops once max_time has passed. Returns the
+    // number of blocks applied.
+    U32 apply(const apply_func_t& apply_block, U32 until, const LLTimer* timer = nullptr, F32 max_time = 0.f);
+    // Calls apply_block for the blocks still queued for one object, in
+    // order, ahead of everything else. Returns the number applied.
+    U32 applyPending(const LLHost& sender, U32 local_id, const apply_func_t& apply_block);
+
+    LLObjectUpdatePacket* front() const { return mPackets.empty() ? nullptr : mPackets.front().get(); }
+    U32 getFrontSequence() const { return mFrontSequence; }
+    // sequence the next packet pushed gets
+    U32 getEndSequence() const { return mFrontSequence + (U32)mPackets.size(); }
+    void pop();
+
+    bool empty() const { return mPackets.empty(); }
+    U32 size() const { return (U32)mPackets.size(); }
+    U32 getSupersededCount() const { return mSupersededCount; }
+
+    // Sequence of the newest queued packet with a block for the object
+    // that is yet to be applied, 0 if there is none
+    U32 getPendingSequence(const LLHost& sender, U32 local_id) const;
+    // Same for an object the queue has a full update for. Sets local_id to
+    // the one that update has.
+    U32 getPendingSequence(const LLHost& sender, const LLUUID& id, U32& local_id) const;
+
+    void clear();
+
+private:
+    struct Pending
+    {
+        U32 mCount = 0;
+        U32 mFirstSequence = 0;     // oldest packet not applied by applyPending()
+        U32 mSequence = 0;
+        LLUUID mFullID;
+        // last queued terse block for the object, if it can be dropped
+        LLObjectUpdatePacket* mTersePacket = nullptr;
+        U32 mTerseBlock = 0;
+
+        bool hasUnapplied() const { return (S32)(mSequence - mFirstSequence) >= 0; }
+    };
+
+    static U64 getKey(const LLHost& sender, U32 local_id) { return ((U64)local_id << 32) | (sender.getAddress() ^ ((U32)sender.getPort() << 16)); }
+
+    // Batches packets up to DECODE_AHEAD past the front for the pool
+    void schedule();
+
+    std::string mPool;
+    std::deque<packet_ptr_t> mPackets;
+    std::vector<packet_ptr_t> mUndispatched;
+    std::unordered_map<U64, Pending> mPending;
+    std::unordered_map<LLUUID, U64> mPendingIDs;
+    U32 mFrontSequence = 1;     // sequence of mPackets.front()
+    U32 mNextBlock = 0;         // in mPackets.front()
+    U32 mScheduleSequence = 1;  // first packet not batched for the pool yet
+    U32 mSupersededCount = 0;
+};
+
+#endif // LL_LLOBJECTUPDATEQUEUE_H
@@ -6411,6 +6411,7 @@ void LLSelectMgr::processForceObjectSelect(LLMessageSystem* msg, void**)
     std::vector<LLViewerObject*> objects;
     S32 i;
     S32 block_count = msg->getNumberOfBlocks("Data");
+    gObjectList.flushQueuedUpdatesFor(msg, _PREHASH_Data, _PREHASH_LocalID); // <FS> object update pipeline
 
     for (i = 0; i < block_count; i++)
     {
@@ -694,6 +694,15 @@ class LLVolumeGeometryManager: public LLGeometryManager
     U32 genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace** faces, U32 face_count, bool distance_sort = false, bool batch_textures = false, bool rigged = false);
     void registerFace(LLSpatialGroup* group, LLFace* facep, U32 type);
 
+    static void initClass();
+    static void cleanupClass();
+
+    // While a build batch is open, genDrawInfo() leaves packing face vertex
+    // data to finishBuildBatch(), which spreads it over the "GeometryBuild"
+    // pool. Finish the batch before flushing vertex buffers.
+    static void startBuildBatch();
+    static void finishBuildBatch();
+
 private:
     void allocateFaces(U32 pMaxFaceCount);
     void freeFaces();
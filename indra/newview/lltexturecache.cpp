@@ -41,7 +41,7 @@
 
 // Cache organization:
 // cache/texture.entries
-//  Unordered array of Entry structs
+//  Unordered array of Entry structs, memory mapped while the cache is open (<FS>)
 // cache/texture.cache
 //  First TEXTURE_CACHE_ENTRY_SIZE bytes of each texture in texture.entries in same order
 // cache/textures/[0-F]/UUID.texture
@@ -795,7 +795,9 @@ LLTextureCache::LLTextureCache(bool threaded)
       mHeaderMutex(),
       mListMutex(),
       mFastCacheMutex(),
-      mHeaderAPRFile(NULL),
+      // <FS> Memory mapped texture entries
+      //mHeaderAPRFile(NULL),
+      // </FS>
       mReadOnly(true), //do not allow to change the texture cache until setReadOnly() is called.
       mTexturesSizeTotal(0),
       mDoPurge(false),
@@ -875,10 +877,14 @@ std::string LLTextureCache::getTextureFileName(const LLUUID& id)
 //debug
 bool LLTextureCache::isInCache(const LLUUID& id)
 {
-    LLMutexLock lock(&mHeaderMutex);
-    id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-
-    return (iter != mHeaderIDMap.end()) ;
+    // <FS> Memory mapped texture entries
+    //LLMutexLock lock(&mHeaderMutex);
+    //id_map_t::const_iterator iter = mHeaderIDMap.find(id);
+    //
+    //return (iter != mHeaderIDMap.end()) ;
+    LLSharedMutexLock lock(&mHeaderMutex);
+    return mHeaderIDIndex.find(id, getMappedEntries()) >= 0;
+    // </FS>
 }
 
 //debug
@@ -954,12 +960,12 @@ void LLTextureCache::setDirNames(ELLPath location)
 
 void LLTextureCache::purgeCache(ELLPath location, bool remove_dir)
 {
-    LLMutexLock lock(&mHeaderMutex);
+    LLExclusiveMutexLock lock(&mHeaderMutex); // <FS> Memory mapped texture entries
 
     if (!mReadOnly)
     {
         setDirNames(location);
-        llassert_always(mHeaderAPRFile == NULL);
+        //llassert_always(mHeaderAPRFile == NULL); // <FS> Memory mapped texture entries
 
         //remove the legacy cache if exists
         std::string texture_dir = mTexturesDirName ;
@@ -1049,38 +1055,301 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, bool texture_cache
 //----------------------------------------------------------------------------
 // mHeaderMutex must be locked for the following functions!
 
-LLAPRFile* LLTextureCache::openHeaderEntriesFile(bool readonly, S32 offset)
+// <FS> Memory mapped texture entries
+// texture.entries stays mapped while the cache is in use, so reading or
+// writing an entry is a plain memory access and startup only has to walk
+// the mapped array once to build the id index. The file is sized for more
+// entries than are in use, in steps, so that new entries rarely need a
+// remap; the extra space is harmless to older viewers, which only read
+// mHeaderEntriesInfo.mEntries entries.
+static const U32 HEADER_ENTRIES_MIN_CAPACITY = 4096;
+
+LLTextureCache::IDIndex::IDIndex()
+:   mCount(0),
+    mDeleted(0)
+{
+}
+
+void LLTextureCache::IDIndex::clear()
+{
+    mSlots.clear();
+    mCount = 0;
+    mDeleted = 0;
+}
+
+void LLTextureCache::IDIndex::reserve(U32 count, const Entry* entries)
+{
+    // Keep the load factor at or under 1/2
+    size_t capacity = 16;
+    while (capacity < (size_t)count * 2)
+    {
+        capacity <<= 1;
+    }
+    if (capacity > mSlots.size())
+    {
+        rehash((U32)capacity, entries);
+    }
+}
+
+void LLTextureCache::IDIndex::rehash(U32 capacity, const Entry* entries)
+{
+    std::vector<S32> old_slots(capacity, EMPTY);
+    old_slots.swap(mSlots);
+    mDeleted = 0;
+
+    const size_t mask = mSlots.size() - 1;
+    for (S32 idx : old_slots)
+    {
+        if (idx >= 0)
+        {
+            size_t slot = entries[idx].mID.getDigest64() & mask;
+            while (mSlots[slot] != EMPTY)
+            {
+                slot = (slot + 1) & mask;
+            }
+            mSlots[slot] = idx;
+        }
+    }
+}
+
+S32 LLTextureCache::IDIndex::find(const LLUUID& id, const Entry* entries) const
+{
+    if (!mCount || !entries)
+    {
+        return -1;
+    }
+
+    const size_t mask = mSlots.size() - 1;
+    for (size_t slot = id.getDigest64() & mask; ; slot = (slot + 1) & mask)
+    {
+        S32 idx = mSlots[slot];
+        if (idx == EMPTY)
+        {
+            return -1;
+        }
+        if (idx >= 0 && entries[idx].mID == id)
+        {
+            return idx;
+        }
+    }
+}
+
+void LLTextureCache::IDIndex::insert(const LLUUID& id, S32 idx, const Entry* entries)
+{
+    if ((size_t)(mCount + mDeleted + 1) * 2 > mSlots.size())
+    {
+        // Grow, or just sweep out the deleted slots if there are many
+        size_t capacity = 16;
+        while (capacity < (size_t)(mCount + 1) * 4)
+        {
+            capacity <<= 1;
+        }
+        rehash((U32)capacity, entries);
+    }
+
+    const size_t mask = mSlots.size() - 1;
+    size_t target = mSlots.size();
+    for (size_t slot = id.getDigest64() & mask; ; slot = (slot + 1) & mask)
+    {
+        S32 current = mSlots[slot];
+        if (current == EMPTY)
+        {
+            if (target == mSlots.size())
+            {
+                target = slot;
+            }
+            break;
+        }
+        if (current == DELETED)
+        {
+            if (target == mSlots.size())
+            {
+                target = slot;
+            }
+        }
+        else if (entries[current].mID == id)
+        {
+            mSlots[slot] = idx;
+            return;
+        }
+    }
+
+    if (mSlots[target] == DELETED)
+    {
+        --mDeleted;
+    }
+    mSlots[target] = idx;
+    ++mCount;
+}
+
+bool LLTextureCache::IDIndex::erase(const LLUUID& id, const Entry* entries)
+{
+    if (!mCount || !entries)
+    {
+        return false;
+    }
+
+    const size_t mask = mSlots.size() - 1;
+    for (size_t slot = id.getDigest64() & mask; ; slot = (slot + 1) & mask)
+    {
+        S32 idx = mSlots[slot];
+        if (idx == EMPTY)
+        {
+            return false;
+        }
+        if (idx >= 0 && entries[idx].mID == id)
+        {
+            mSlots[slot] = DELETED;
+            --mCount;
+            ++mDeleted;
+            return true;
+        }
+    }
+}
+
+bool LLTextureCache::openHeaderEntriesFile()
 {
-    llassert_always(mHeaderAPRFile == NULL);
-    apr_int32_t flags = readonly ? APR_READ|APR_BINARY : APR_READ|APR_WRITE|APR_BINARY;
-    mHeaderAPRFile = new LLAPRFile(mHeaderEntriesFileName, flags, mHeaderAPRFilePoolp);
-    if(offset > 0)
+    if (mHeaderEntriesFile.isOpen())
+    {
+        if (mHeaderEntriesFile.isWritable() != mReadOnly)
+        {
+            return true;
+        }
+        // Read only mode changed since the file was mapped
+        closeHeaderEntriesFile();
+    }
+
+    if (mReadOnly)
     {
-        mHeaderAPRFile->seek(APR_SET, offset);
+        return LLFile::isfile(mHeaderEntriesFileName) &&
+               mHeaderEntriesFile.open(mHeaderEntriesFileName, LLMappedFile::READ_ONLY);
     }
-    return mHeaderAPRFile;
+
+    if (!mHeaderEntriesFile.open(mHeaderEntriesFileName, LLMappedFile::READ_WRITE))
+    {
+        LL_WARNS("TextureCache") << "Unable to map " << mHeaderEntriesFileName << LL_ENDL;
+        return false;
+    }
+    return true;
 }
 
 void LLTextureCache::closeHeaderEntriesFile()
 {
-    if(!mHeaderAPRFile)
+    if (mHeaderEntriesFile.isOpen())
     {
-        return ;
+        if (mHeaderEntriesFile.isWritable())
+        {
+            mHeaderEntriesFile.flush();
+        }
+        mHeaderEntriesFile.close();
     }
 
-    delete mHeaderAPRFile;
-    mHeaderAPRFile = NULL;
+    // Both refer to the mapped entries
+    mHeaderIDIndex.clear();
+    mLRU.clear();
 }
 
-void LLTextureCache::readEntriesHeader()
+LLTextureCache::Entry* LLTextureCache::getMappedEntries()
 {
-    // mHeaderEntriesInfo initializes to default values so safe not to read it
-    llassert_always(mHeaderAPRFile == NULL);
-    if (LLAPRFile::isExist(mHeaderEntriesFileName, mHeaderAPRFilePoolp))
+    if (!mHeaderEntriesFile.isOpen() || mHeaderEntriesFile.size() < sizeof(EntriesInfo))
+    {
+        return NULL;
+    }
+    return (Entry*)(mHeaderEntriesFile.data() + sizeof(EntriesInfo));
+}
+
+U32 LLTextureCache::getMappedEntryCapacity() const
+{
+    if (!mHeaderEntriesFile.isOpen() || mHeaderEntriesFile.size() < sizeof(EntriesInfo))
+    {
+        return 0;
+    }
+    return (U32)((mHeaderEntriesFile.size() - sizeof(EntriesInfo)) / sizeof(Entry));
+}
+
+// Make sure the mapping has room for the header and count entries.
+// Growing remaps the file, so no pointer from getMappedEntries() may be
+// held across this call.
+bool LLTextureCache::reserveHeaderEntries(U32 count)
+{
+    if (mReadOnly || !openHeaderEntriesFile() || !mHeaderEntriesFile.isWritable())
+    {
+        return false;
+    }
+    if (mHeaderEntriesFile.size() >= sizeof(EntriesInfo) + (size_t)count * sizeof(Entry))
+    {
+        return true;
+    }
+
+    U32 capacity = llmax(getMappedEntryCapacity(), HEADER_ENTRIES_MIN_CAPACITY);
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+    capacity = llmin(capacity, llmax(count, sCacheMaxEntries));
+
+    // The grown space is zero filled, i.e. unused entries
+    if (!mHeaderEntriesFile.resize(sizeof(EntriesInfo) + (size_t)capacity * sizeof(Entry)))
+    {
+        LL_WARNS("TextureCache") << "Unable to grow " << mHeaderEntriesFileName << " to " << capacity << " entries" << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+
+bool LLTextureCache::needsEntryTimeStamp() const
+{
+    static const U32 MAX_ENTRIES_WITHOUT_TIME_STAMP = (U32)(LLTextureCache::sCacheMaxEntries * 0.75f) ;
+
+    // While there is plenty of empty entry index space nothing gets evicted,
+    // so there is no need to stamp time.
+    return mHeaderEntriesInfo.mEntries >= MAX_ENTRIES_WITHOUT_TIME_STAMP;
+}
+
+// Fill mLRU with the oldest TEXTURE_CACHE_LRU_SIZE of the entries
+void LLTextureCache::buildLRU()
+{
+    mLRU.clear();
+
+    Entry* entries = getMappedEntries();
+    U32 num_entries = llmin(mHeaderEntriesInfo.mEntries, getMappedEntryCapacity());
+    for (U32 idx = 0; idx < num_entries; ++idx)
+    {
+        if (mHeaderIDIndex.find(entries[idx].mID, entries) == (S32)idx)
+        {
+            mLRU.push_back(std::make_pair((S32)idx, entries[idx].mTime));
+        }
+    }
+
+    auto newer_first = [](const std::pair<S32, U32>& a, const std::pair<S32, U32>& b)
+    {
+        return a.second > b.second;
+    };
+    size_t lru_entries = llmax((size_t)1, (size_t)((F32)sCacheMaxEntries * TEXTURE_CACHE_LRU_SIZE));
+    if (mLRU.size() > lru_entries)
     {
-        LLAPRFile::readEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
-                          mHeaderAPRFilePoolp);
+        std::nth_element(mLRU.begin(), mLRU.end() - lru_entries, mLRU.end(), newer_first);
+        mLRU.erase(mLRU.begin(), mLRU.end() - lru_entries);
     }
+    std::sort(mLRU.begin(), mLRU.end(), newer_first);
+}
+// </FS>
+
+void LLTextureCache::readEntriesHeader()
+{
+    // mHeaderEntriesInfo initializes to default values so safe not to read it
+    // <FS> Memory mapped texture entries
+    //llassert_always(mHeaderAPRFile == NULL);
+    //if (LLAPRFile::isExist(mHeaderEntriesFileName, mHeaderAPRFilePoolp))
+    //{
+    //    LLAPRFile::readEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
+    //                      mHeaderAPRFilePoolp);
+    //}
+    if (openHeaderEntriesFile() && mHeaderEntriesFile.size() >= sizeof(EntriesInfo))
+    {
+        memcpy((void*)&mHeaderEntriesInfo, mHeaderEntriesFile.data(), sizeof(EntriesInfo));
+    }
+    // </FS>
     else //create an empty entries header.
     {
         setEntriesHeader();
@@ -1107,24 +1376,33 @@ void LLTextureCache::setEntriesHeader()
 
 void LLTextureCache::writeEntriesHeader()
 {
-    llassert_always(mHeaderAPRFile == NULL);
-    if (!mReadOnly)
-    {
-        LLAPRFile::writeEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
-                           mHeaderAPRFilePoolp);
-    }
+    // <FS> Memory mapped texture entries
+    //llassert_always(mHeaderAPRFile == NULL);
+    //if (!mReadOnly)
+    //{
+    //    LLAPRFile::writeEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
+    //                       mHeaderAPRFilePoolp);
+    //}
+    if (reserveHeaderEntries(mHeaderEntriesInfo.mEntries))
+    {
+        memcpy(mHeaderEntriesFile.data(), (void*)&mHeaderEntriesInfo, sizeof(EntriesInfo));
+    }
+    // </FS>
 }
 
 //mHeaderMutex is locked before calling this.
 S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create)
 {
-    S32 idx = -1;
-
-    id_map_t::iterator iter1 = mHeaderIDMap.find(id);
-    if (iter1 != mHeaderIDMap.end())
-    {
-        idx = iter1->second;
-    }
+    // <FS> Memory mapped texture entries
+    //S32 idx = -1;
+    //
+    //id_map_t::iterator iter1 = mHeaderIDMap.find(id);
+    //if (iter1 != mHeaderIDMap.end())
+    //{
+    //    idx = iter1->second;
+    //}
+    S32 idx = mHeaderIDIndex.find(id, getMappedEntries());
+    // </FS>
 
     if (idx < 0)
     {
@@ -1133,8 +1411,13 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
             if (mHeaderEntriesInfo.mEntries < sCacheMaxEntries)
             {
                 // Add an entry to the end of the list
-                idx = mHeaderEntriesInfo.mEntries++;
-
+                // <FS> Memory mapped texture entries
+                //idx = mHeaderEntriesInfo.mEntries++;
+                if (reserveHeaderEntries(mHeaderEntriesInfo.mEntries + 1))
+                {
+                    idx = mHeaderEntriesInfo.mEntries++;
+                }
+                // </FS>
             }
             else if (!mFreeList.empty())
             {
@@ -1144,21 +1427,27 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
             else
             {
                 // Look for a still valid entry in the LRU
-                for (std::set<LLUUID>::iterator iter2 = mLRU.begin(); iter2 != mLRU.end();)
+                // <FS> Memory mapped texture entries
+                // The LRU is only built once it is needed. Entries that were
+                // used or removed since then are skipped.
+                if (mLRU.empty())
                 {
-                    std::set<LLUUID>::iterator curiter2 = iter2++;
-                    LLUUID oldid = *curiter2;
-                    // Erase entry from LRU regardless
-                    mLRU.erase(curiter2);
-                    // Look up entry and use it if it is valid
-                    id_map_t::iterator iter3 = mHeaderIDMap.find(oldid);
-                    if (iter3 != mHeaderIDMap.end() && iter3->second >= 0)
+                    buildLRU();
+                }
+                Entry* entries = getMappedEntries();
+                while (idx < 0 && !mLRU.empty())
+                {
+                    std::pair<S32, U32> oldest = mLRU.back();
+                    mLRU.pop_back();
+                    LLUUID oldid = entries[oldest.first].mID;
+                    if (entries[oldest.first].mTime == oldest.second &&
+                        mHeaderIDIndex.find(oldid, entries) == oldest.first)
                     {
-                        idx = iter3->second;
+                        idx = oldest.first;
                         removeCachedTexture(oldid) ;//remove the existing cached texture to release the entry index.
-                        break;
                     }
                 }
+                // </FS>
                 // if (idx < 0) at this point, we will rebuild the LRU
                 //  and retry if called from setHeaderCacheEntry(),
                 //  otherwise this shouldn't happen and will trigger an error
@@ -1173,18 +1462,25 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
     }
     else
     {
-        // Remove this entry from the LRU if it exists
-        mLRU.erase(id);
-        // Read the entry
-        idx_entry_map_t::iterator iter = mUpdatedEntryMap.find(idx) ;
-        if(iter != mUpdatedEntryMap.end())
-        {
-            entry = iter->second ;
-        }
-        else
+        // <FS> Memory mapped texture entries: time stamps are written to the mapping directly
+        //// Remove this entry from the LRU if it exists
+        //mLRU.erase(id);
+        //// Read the entry
+        //idx_entry_map_t::iterator iter = mUpdatedEntryMap.find(idx) ;
+        //if(iter != mUpdatedEntryMap.end())
+        //{
+        //    entry = iter->second ;
+        //}
+        //else
+        //{
+        //    readEntryFromHeaderImmediately(idx, entry) ;
+        //}
+        readEntryFromHeaderImmediately(idx, entry) ;
+        if (idx < 0)
         {
-            readEntryFromHeaderImmediately(idx, entry) ;
+            return idx;
         }
+        // </FS>
         if(entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
         {
             LL_WARNS() << "corrupted entry: " << id << " entry image size: " << entry.mImageSize << " entry body size: " << entry.mBodySize << LL_ENDL ;
@@ -1192,7 +1488,10 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
             //erase this entry and the cached texture from the cache.
             std::string tex_filename = getTextureFileName(id);
             removeEntry(idx, entry, tex_filename) ;
-            mUpdatedEntryMap.erase(idx) ;
+            // <FS> Memory mapped texture entries
+            //mUpdatedEntryMap.erase(idx) ;
+            writeEntryToHeaderImmediately(idx, entry);
+            // </FS>
             idx = -1 ;
         }
     }
@@ -1202,61 +1501,52 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 //mHeaderMutex is locked before calling this.
 void LLTextureCache::writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header)
 {
-    LLAPRFile* aprfile ;
-    S32 bytes_written ;
-    S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-    if(write_header)
-    {
-        aprfile = openHeaderEntriesFile(false, 0);
-        bytes_written = aprfile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-        if(bytes_written != sizeof(EntriesInfo))
-        {
-            clearCorruptedCache() ; //clear the cache.
-            idx = -1 ;//mark the idx invalid.
-            return ;
-        }
-
-        mHeaderAPRFile->seek(APR_SET, offset);
-    }
-    else
+    // <FS> Memory mapped texture entries
+    if (mReadOnly)
     {
-        aprfile = openHeaderEntriesFile(false, offset);
+        return;
     }
-    bytes_written = aprfile->write((void*)&entry, (S32)sizeof(Entry));
-    if(bytes_written != sizeof(Entry))
+
+    if (idx < 0 || !reserveHeaderEntries(idx + 1))
     {
         clearCorruptedCache() ; //clear the cache.
         idx = -1 ;//mark the idx invalid.
-
         return ;
     }
 
-    closeHeaderEntriesFile();
-    mUpdatedEntryMap.erase(idx) ;
+    getMappedEntries()[idx] = entry;
+    if (write_header)
+    {
+        memcpy(mHeaderEntriesFile.data(), (void*)&mHeaderEntriesInfo, sizeof(EntriesInfo));
+    }
+    // </FS>
 }
 
 //mHeaderMutex is locked before calling this.
 void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
 {
-    S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-    LLAPRFile* aprfile = openHeaderEntriesFile(true, offset);
-    S32 bytes_read = aprfile->read((void*)&entry, (S32)sizeof(Entry));
-    closeHeaderEntriesFile();
-
-    if(bytes_read != sizeof(Entry))
+    // <FS> Memory mapped texture entries
+    Entry* entries = getMappedEntries();
+    if (!entries || idx < 0 || (U32)idx >= getMappedEntryCapacity())
     {
         clearCorruptedCache() ; //clear the cache.
         idx = -1 ;//mark the idx invalid.
+        return;
     }
+    entry = entries[idx];
+    // </FS>
 }
 
 //mHeaderMutex is locked before calling this.
 //update an existing entry time stamp, delay writing.
 void LLTextureCache::updateEntryTimeStamp(S32 idx, Entry& entry)
 {
-    static const U32 MAX_ENTRIES_WITHOUT_TIME_STAMP = (U32)(LLTextureCache::sCacheMaxEntries * 0.75f) ;
-
-    if(mHeaderEntriesInfo.mEntries < MAX_ENTRIES_WITHOUT_TIME_STAMP)
+    // <FS> Memory mapped texture entries
+    //static const U32 MAX_ENTRIES_WITHOUT_TIME_STAMP = (U32)(LLTextureCache::sCacheMaxEntries * 0.75f) ;
+    //
+    //if(mHeaderEntriesInfo.mEntries < MAX_ENTRIES_WITHOUT_TIME_STAMP)
+    if (!needsEntryTimeStamp())
+    // </FS>
     {
         return ; //there are enough empty entry index space, no need to stamp time.
     }
@@ -1266,7 +1556,14 @@ void LLTextureCache::updateEntryTimeStamp(S32 idx, Entry& entry)
         if (!mReadOnly)
         {
             entry.mTime = (U32)time(NULL);
-            mUpdatedEntryMap[idx] = entry ;
+            // <FS> Memory mapped texture entries
+            //mUpdatedEntryMap[idx] = entry ;
+            Entry* entries = getMappedEntries();
+            if (entries && mHeaderEntriesFile.isWritable() && (U32)idx < getMappedEntryCapacity())
+            {
+                entries[idx].mTime = entry.mTime;
+            }
+            // </FS>
         }
     }
 }
@@ -1290,8 +1587,10 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
         bool update_header = false ;
         if(entry.mImageSize < 0) //is a brand-new entry
         {
-            mHeaderIDMap[entry.mID] = idx;
-            mTexturesSizeMap[entry.mID] = new_body_size ;
+            // <FS> Memory mapped texture entries: indexed once the entry is written below
+            //mHeaderIDMap[entry.mID] = idx;
+            //mTexturesSizeMap[entry.mID] = new_body_size ;
+            // </FS>
             mTexturesSizeTotal += new_body_size ;
 
             // Update Header
@@ -1299,8 +1598,10 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
         }
         else if (entry.mBodySize != new_body_size)
         {
-            //already in mHeaderIDMap.
-            mTexturesSizeMap[entry.mID] = new_body_size ;
+            //already in mHeaderIDIndex.
+            // <FS> Memory mapped texture entries
+            //mTexturesSizeMap[entry.mID] = new_body_size ;
+            // </FS>
             mTexturesSizeTotal -= entry.mBodySize ;
             mTexturesSizeTotal += new_body_size ;
         }
@@ -1310,6 +1611,13 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 
         writeEntryToHeaderImmediately(idx, entry, update_header) ;
 
+        // <FS> Memory mapped texture entries
+        if (update_header && idx >= 0)
+        {
+            mHeaderIDIndex.insert(entry.mID, idx, getMappedEntries());
+        }
+        // </FS>
+
         if (mTexturesSizeTotal > sCacheMaxTexturesSize)
         {
             purge = true;
@@ -1326,146 +1634,60 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
     return false ;
 }
 
-U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
+// <FS> Memory mapped texture entries
+// Rebuild the id index, free list and total size from the mapped entries.
+// Replaces openAndReadEntries(), which read the whole file into a vector.
+U32 LLTextureCache::loadHeaderEntries()
 {
     U32 num_entries = mHeaderEntriesInfo.mEntries;
 
-    mHeaderIDMap.clear();
-    mTexturesSizeMap.clear();
+    mHeaderIDIndex.clear();
     mFreeList.clear();
+    mLRU.clear();
     mTexturesSizeTotal = 0;
 
-    LLAPRFile* aprfile = NULL;
-    if(mUpdatedEntryMap.empty())
+    Entry* entries = getMappedEntries();
+    if (num_entries > getMappedEntryCapacity())
     {
-        aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
+        LL_WARNS() << "Corrupted header entries, " << getMappedEntryCapacity() << " / " << num_entries << " present" << LL_ENDL;
+        clearCorruptedCache();
+        return 0;
     }
-    else //update the header file first.
-    {
-        aprfile = openHeaderEntriesFile(false, 0);
-        updatedHeaderEntriesFile() ;
-        if(!aprfile)
-        {
-            return 0;
-        }
-        aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo));
-    }
-    for (U32 idx=0; idx<num_entries; idx++)
+
+    mHeaderIDIndex.reserve(num_entries, entries);
+    for (U32 idx = 0; idx < num_entries; idx++)
     {
-        try
+        const Entry& entry = entries[idx];
+        if (entry.mImageSize > entry.mBodySize)
         {
-            Entry entry;
-            S32 bytes_read = aprfile->read((void*)(&entry), (S32)sizeof(Entry));
-            if (bytes_read < sizeof(Entry))
-            {
-                LL_WARNS() << "Corrupted header entries, failed at " << idx << " / " << num_entries << LL_ENDL;
-                return 0;
-            }
-            entries.push_back(entry);
-            //      LL_INFOS() << "ENTRY: " << entry.mTime << " TEX: " << entry.mID << " IDX: " << idx << " Size: " << entry.mImageSize << LL_ENDL;
-            if (entry.mImageSize > entry.mBodySize)
-            {
-                mHeaderIDMap[entry.mID] = idx;
-                mTexturesSizeMap[entry.mID] = entry.mBodySize;
-                mTexturesSizeTotal += entry.mBodySize;
-            }
-            else
-            {
-                mFreeList.insert(idx);
-            }
+            mHeaderIDIndex.insert(entry.mID, idx, entries);
+            mTexturesSizeTotal += entry.mBodySize;
         }
-        catch (std::bad_alloc&)
+        else
         {
-            // Too little ram yet very large cache?
-            // Should this actually crash viewer?
-            entries.clear();
-            LL_WARNS() << "Bad alloc trying to read texture entries from cache, mFreeList: " << (S32)mFreeList.size()
-                << ", added entries: " << idx << ", total entries: " << num_entries << LL_ENDL;
-            closeHeaderEntriesFile();
-            purgeAllTextures(false);
-            return 0;
+            mFreeList.insert(idx);
         }
     }
-    closeHeaderEntriesFile();
     return num_entries;
 }
-
-void LLTextureCache::writeEntriesAndClose(const std::vector<Entry>& entries)
-{
-    auto num_entries = entries.size();
-    llassert_always(num_entries == mHeaderEntriesInfo.mEntries);
-
-    if (!mReadOnly)
-    {
-        LLAPRFile* aprfile = openHeaderEntriesFile(false, (S32)sizeof(EntriesInfo));
-        for (size_t idx=0; idx<num_entries; idx++)
-        {
-            S32 bytes_written = aprfile->write((void*)(&entries[idx]), (S32)sizeof(Entry));
-            if(bytes_written != sizeof(Entry))
-            {
-                clearCorruptedCache() ; //clear the cache.
-                return ;
-            }
-        }
-        closeHeaderEntriesFile();
-    }
-}
+// </FS>
 
 void LLTextureCache::writeUpdatedEntries()
 {
-    lockHeaders() ;
-    if (!mReadOnly && !mUpdatedEntryMap.empty())
+    // <FS> Memory mapped texture entries: all changes are in the mapping already, just push them to disk
+    LLSharedMutexLock lock(&mHeaderMutex);
+    if (!mReadOnly && mHeaderEntriesFile.isOpen())
     {
-        openHeaderEntriesFile(false, 0);
-        updatedHeaderEntriesFile() ;
-        closeHeaderEntriesFile();
-    }
-    unlockHeaders() ;
-}
-
-//mHeaderMutex is locked and mHeaderAPRFile is created before calling this.
-void LLTextureCache::updatedHeaderEntriesFile()
-{
-    if (!mReadOnly && !mUpdatedEntryMap.empty() && mHeaderAPRFile)
-    {
-        //entriesInfo
-        mHeaderAPRFile->seek(APR_SET, 0);
-        S32 bytes_written = mHeaderAPRFile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-        if(bytes_written != sizeof(EntriesInfo))
-        {
-            clearCorruptedCache() ; //clear the cache.
-            return ;
-        }
-
-        //write each updated entry
-        S32 entry_size = (S32)sizeof(Entry) ;
-        S32 prev_idx = -1 ;
-        S32 delta_idx ;
-        for (idx_entry_map_t::iterator iter = mUpdatedEntryMap.begin(); iter != mUpdatedEntryMap.end(); ++iter)
-        {
-            delta_idx = iter->first - prev_idx - 1;
-            prev_idx = iter->first ;
-            if(delta_idx)
-            {
-                mHeaderAPRFile->seek(APR_CUR, delta_idx * entry_size);
-            }
-
-            bytes_written = mHeaderAPRFile->write((void*)(&iter->second), entry_size);
-            if(bytes_written != entry_size)
-            {
-                clearCorruptedCache() ; //clear the cache.
-                return ;
-            }
-        }
-        mUpdatedEntryMap.clear() ;
+        mHeaderEntriesFile.flush();
     }
+    // </FS>
 }
 //----------------------------------------------------------------------------
 
 // Called from either the main thread or the worker thread
 void LLTextureCache::readHeaderCache()
 {
-    mHeaderMutex.lock();
+    lockHeaders();
 
     mLRU.clear(); // always clear the LRU
 
@@ -1483,70 +1705,55 @@ void LLTextureCache::readHeaderCache()
     }
     else
     {
-        std::vector<Entry> entries;
-        U32 num_entries = openAndReadEntries(entries);
-        if (num_entries)
+        // <FS> Memory mapped texture entries
+        // The entries are used in place, nothing is read into memory but
+        // the id index. The LRU is built when the entries table fills up.
+        U32 num_entries = loadHeaderEntries();
+        if (num_entries && !mReadOnly)
         {
-            U32 empty_entries = 0;
-            typedef std::pair<U32, S32> lru_data_t;
-            std::set<lru_data_t> lru;
-            std::set<U32> purge_list;
+            Entry* entries = getMappedEntries();
+            std::vector<U32> purge_list;
             for (U32 i=0; i<num_entries; i++)
             {
-                Entry& entry = entries[i];
-                if (entry.mImageSize <= 0)
-                {
-                    // This will be in the Free List, don't put it in the LRU
-                    ++empty_entries;
-                }
-                else
+                const Entry& entry = entries[i];
+                if (entry.mImageSize > 0 && entry.mBodySize > entry.mImageSize)
                 {
-                    lru.insert(std::make_pair(entry.mTime, i));
-                    if (entry.mBodySize > 0)
-                    {
-                        if (entry.mBodySize > entry.mImageSize)
-                        {
-                            // Shouldn't happen, failsafe only
-                            LL_WARNS() << "Bad entry: " << i << ": " << entry.mID << ": BodySize: " << entry.mBodySize << LL_ENDL;
-                            purge_list.insert(i);
-                        }
-                    }
+                    // Shouldn't happen, failsafe only
+                    LL_WARNS() << "Bad entry: " << i << ": " << entry.mID << ": BodySize: " << entry.mBodySize << LL_ENDL;
+                    purge_list.push_back(i);
                 }
             }
-            if (num_entries - empty_entries > sCacheMaxEntries)
+
+            U32 valid_entries = mHeaderIDIndex.size();
+            if (valid_entries > sCacheMaxEntries)
             {
                 // Special case: cache size was reduced, need to remove entries
-                U32 entries_to_purge = (num_entries - empty_entries) - sCacheMaxEntries;
-                LL_INFOS() << "Texture Cache Entries: " << num_entries << " Max: " << sCacheMaxEntries << " Empty: " << empty_entries << " Purging: " << entries_to_purge << LL_ENDL;
-                // We can exit the following loop with the given condition, since if we'd reach the end of the lru set we'd have:
-                // purge_list.size() = lru.size() = num_entries - empty_entries = entries_to_purge + sCacheMaxEntries >= entries_to_purge
-                // So, it's certain that iter will never reach lru.end() first.
-                std::set<lru_data_t>::iterator iter = lru.begin();
-                while (purge_list.size() < entries_to_purge)
+                U32 entries_to_purge = valid_entries - sCacheMaxEntries;
+                LL_INFOS() << "Texture Cache Entries: " << num_entries << " Max: " << sCacheMaxEntries << " Empty: " << num_entries - valid_entries << " Purging: " << entries_to_purge << LL_ENDL;
+
+                std::vector<std::pair<U32, U32> > lru;
+                lru.reserve(valid_entries);
+                for (U32 i = 0; i < num_entries; i++)
                 {
-                    purge_list.insert(iter->second);
-                    ++iter;
+                    if (mHeaderIDIndex.find(entries[i].mID, entries) == (S32)i)
+                    {
+                        lru.push_back(std::make_pair(entries[i].mTime, i));
+                    }
                 }
-            }
-
-            {
-                S32 lru_entries = (S32)((F32)sCacheMaxEntries * TEXTURE_CACHE_LRU_SIZE);
-                for (std::set<lru_data_t>::iterator iter = lru.begin(); iter != lru.end(); ++iter)
+                std::nth_element(lru.begin(), lru.begin() + entries_to_purge, lru.end());
+                for (U32 i = 0; i < entries_to_purge; i++)
                 {
-                    mLRU.insert(entries[iter->second].mID);
-//                  LL_INFOS() << "LRU: " << iter->first << " : " << iter->second << LL_ENDL;
-                    if (--lru_entries <= 0)
-                        break;
+                    purge_list.push_back(lru[i].second);
                 }
             }
 
             if (purge_list.size() > 0)
             {
                 LLTimer timer;
-                for (std::set<U32>::iterator iter = purge_list.begin(); iter != purge_list.end(); ++iter)
+                for (U32 idx : purge_list)
                 {
-                    std::string tex_filename = getTextureFileName(entries[*iter].mID);
-                    removeEntry((S32)*iter, entries[*iter], tex_filename);
+                    std::string tex_filename = getTextureFileName(entries[idx].mID);
+                    removeEntry((S32)idx, entries[idx], tex_filename);
 
                     //make sure that pruning entries doesn't take too much time
                     if (timer.getElapsedTimeF32() > TEXTURE_PRUNING_MAX_TIME)
@@ -1554,15 +1761,11 @@ void LLTextureCache::readHeaderCache()
                         break;
                     }
                 }
-                writeEntriesAndClose(entries);
-            }
-            else
-            {
-                //entries are not changed, nothing here.
             }
         }
+        // </FS>
     }
-    mHeaderMutex.unlock();
+    unlockHeaders();
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1592,6 +1795,9 @@ void LLTextureCache::clearCorruptedCache()
 
 void LLTextureCache::purgeAllTextures(bool purge_directories)
 {
+    // <FS> Memory mapped texture entries: unmap texture.entries before it is deleted
+    closeHeaderEntriesFile();
+    // </FS>
     if (!mReadOnly)
     {
 // <FS:ND> Windows can be really slow deleting a huge texture cache.
@@ -1649,12 +1855,16 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
         // </FS:Ansariel>
         }
     }
-    mHeaderIDMap.clear();
-    mTexturesSizeMap.clear();
+    // <FS> Memory mapped texture entries
+    //mHeaderIDMap.clear();
+    //mTexturesSizeMap.clear();
+    mHeaderIDIndex.clear();
+    mLRU.clear();
+    // </FS>
     mTexturesSizeTotal = 0;
     mFreeList.clear();
     mTexturesSizeTotal = 0;
-    mUpdatedEntryMap.clear();
+    //mUpdatedEntryMap.clear(); // <FS> Memory mapped texture entries
 
     // Info with 0 entries
     setEntriesHeader();
@@ -1676,38 +1886,30 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
     }
 
     // time_limit doesn't account for lock time
-    LLMutexLock lock(&mHeaderMutex);
+    LLExclusiveMutexLock lock(&mHeaderMutex); // <FS> Memory mapped texture entries
 
     if (mPurgeEntryList.empty())
     {
-        // Read the entries list and form list of textures to purge
-        std::vector<Entry> entries;
-        U32 num_entries = openAndReadEntries(entries);
+        // <FS> Memory mapped texture entries
+        // Form the list of textures to purge straight from the mapped entries
+        Entry* entries = getMappedEntries();
+        U32 num_entries = llmin(mHeaderEntriesInfo.mEntries, getMappedEntryCapacity());
         if (!num_entries)
         {
             return; // nothing to purge
         }
 
-        // Use mTexturesSizeMap to collect UUIDs of textures with bodies
+        // Collect the textures with bodies
         typedef std::set<std::pair<U32, S32> > time_idx_set_t;
         std::set<std::pair<U32, S32> > time_idx_set;
-        for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
-            iter1 != mTexturesSizeMap.end(); ++iter1)
+        for (U32 i = 0; i < num_entries; ++i)
         {
-            if (iter1->second > 0)
+            if (entries[i].mBodySize > 0 && mHeaderIDIndex.find(entries[i].mID, entries) == (S32)i)
             {
-                id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-                if (iter2 != mHeaderIDMap.end())
-                {
-                    S32 idx = iter2->second;
-                    time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
-                }
-                else
-                {
-                    LL_ERRS("TextureCache") << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL;
-                }
+                time_idx_set.insert(std::make_pair(entries[i].mTime, (S32)i));
             }
         }
+        // </FS>
 
         S64 cache_size = mTexturesSizeTotal;
         S64 purged_cache_size = (llmax(cache_size, sCacheMaxTexturesSize) * (S64)((1.f - TEXTURE_CACHE_PURGE_AMOUNT) * 100)) / 100;
@@ -1737,8 +1939,11 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
             Entry entry = mPurgeEntryList.back().second;
             mPurgeEntryList.pop_back();
             // make sure record is still valid
-            id_map_t::iterator iter_header = mHeaderIDMap.find(entry.mID);
-            if (iter_header != mHeaderIDMap.end() && iter_header->second == idx)
+            // <FS> Memory mapped texture entries
+            //id_map_t::iterator iter_header = mHeaderIDMap.find(entry.mID);
+            //if (iter_header != mHeaderIDMap.end() && iter_header->second == idx)
+            if (mHeaderIDIndex.find(entry.mID, getMappedEntries()) == idx)
+            // </FS>
             {
                 std::string tex_filename = getTextureFileName(entry.mID);
                 removeEntry(idx, entry, tex_filename);
@@ -1761,39 +1966,30 @@ void LLTextureCache::purgeTextures(bool validate)
         LLAppViewer::instance()->pauseMainloopTimeout();
     }
 
-    LLMutexLock lock(&mHeaderMutex);
+    LLExclusiveMutexLock lock(&mHeaderMutex); // <FS> Memory mapped texture entries
 
     LL_INFOS() << "TEXTURE CACHE: Purging." << LL_ENDL;
 
-    // Read the entries list
-    std::vector<Entry> entries;
-    U32 num_entries = openAndReadEntries(entries);
+    // <FS> Memory mapped texture entries
+    // The entries are purged in place in the mapping
+    Entry* entries = getMappedEntries();
+    U32 num_entries = llmin(mHeaderEntriesInfo.mEntries, getMappedEntryCapacity());
     if (!num_entries)
     {
         return; // nothing to purge
     }
 
-    // Use mTexturesSizeMap to collect UUIDs of textures with bodies
-    typedef std::set<std::pair<U32,S32> > time_idx_set_t;
-    std::set<std::pair<U32,S32> > time_idx_set;
-    for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
-         iter1 != mTexturesSizeMap.end(); ++iter1)
+    // Collect the textures with bodies
+    typedef std::vector<std::pair<U32,S32> > time_idx_set_t;
+    time_idx_set_t time_idx_set;
+    for (U32 i = 0; i < num_entries; ++i)
     {
-        if (iter1->second > 0)
+        if (entries[i].mBodySize > 0 && mHeaderIDIndex.find(entries[i].mID, entries) == (S32)i)
         {
-            id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-            if (iter2 != mHeaderIDMap.end())
-            {
-                S32 idx = iter2->second;
-                time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
-//              LL_INFOS() << "TIME: " << entries[idx].mTime << " TEX: " << entries[idx].mID << " IDX: " << idx << " Size: " << entries[idx].mImageSize << LL_ENDL;
-            }
-            else
-            {
-                LL_ERRS() << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL ;
-            }
+            time_idx_set.push_back(std::make_pair(entries[i].mTime, (S32)i));
         }
     }
+    // </FS>
 
     // Validate 1/256th of the files on startup
     U32 validate_idx = 0;
@@ -1808,6 +2004,14 @@ void LLTextureCache::purgeTextures(bool validate)
     S64 cache_size = mTexturesSizeTotal;
     S64 purged_cache_size = (llmax(cache_size, sCacheMaxTexturesSize) * (S64)((1.f - TEXTURE_CACHE_PURGE_AMOUNT) * 100)) / 100;
     S32 purge_count = 0;
+    // <FS> Memory mapped texture entries
+    // Validation does not care about the order, so only sort oldest first
+    // when something has to go.
+    if (cache_size >= purged_cache_size)
+    {
+        std::sort(time_idx_set.begin(), time_idx_set.end());
+    }
+    // </FS>
     for (time_idx_set_t::iterator iter = time_idx_set.begin();
          iter != time_idx_set.end(); ++iter)
     {
@@ -1850,9 +2054,11 @@ void LLTextureCache::purgeTextures(bool validate)
         }
     }
 
-    LL_DEBUGS("TextureCache") << "TEXTURE CACHE: Writing Entries: " << num_entries << LL_ENDL;
-
-    writeEntriesAndClose(entries);
+    // <FS> Memory mapped texture entries: already written
+    //LL_DEBUGS("TextureCache") << "TEXTURE CACHE: Writing Entries: " << num_entries << LL_ENDL;
+    //
+    //writeEntriesAndClose(entries);
+    // </FS>
 
     // *FIX:Mani - watchdog back on.
     LLAppViewer::instance()->resumeMainloopTimeout();
@@ -1898,7 +2104,27 @@ LLTextureCacheWorker* LLTextureCache::getWriter(handle_t handle)
 S32 LLTextureCache::getHeaderCacheEntry(const LLUUID& id, Entry& entry)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-    LLMutexLock lock(&mHeaderMutex);
+    // <FS> Memory mapped texture entries
+    // Plain lookups only read the mapping. The exclusive lock is only needed
+    // to stamp the time or to drop a bad entry.
+    {
+        LLSharedMutexLock lock(&mHeaderMutex);
+        Entry* entries = getMappedEntries();
+        S32 idx = mHeaderIDIndex.find(id, entries);
+        if (idx < 0)
+        {
+            return -1;
+        }
+        entry = entries[idx];
+        if (entry.mImageSize > entry.mBodySize && (mReadOnly || !needsEntryTimeStamp()))
+        {
+            return idx;
+        }
+    }
+
+    //LLMutexLock lock(&mHeaderMutex);
+    LLExclusiveMutexLock lock(&mHeaderMutex);
+    // </FS>
     S32 idx = openAndReadEntry(id, entry, false);
     if (idx >= 0)
     {
@@ -1911,17 +2137,17 @@ S32 LLTextureCache::getHeaderCacheEntry(const LLUUID& id, Entry& entry)
 S32 LLTextureCache::setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-    mHeaderMutex.lock();
+    lockHeaders(); // <FS> Memory mapped texture entries
     S32 idx = openAndReadEntry(id, entry, true); // read or create
-    mHeaderMutex.unlock();
+    unlockHeaders(); // <FS> Memory mapped texture entries
 
     if(idx < 0) // retry once
     {
         readHeaderCache(); // We couldn't write an entry, so refresh the LRU
 
-        mHeaderMutex.lock();
+        lockHeaders(); // <FS> Memory mapped texture entries
         idx = openAndReadEntry(id, entry, true);
-        mHeaderMutex.unlock();
+        unlockHeaders(); // <FS> Memory mapped texture entries
     }
 
     if (idx >= 0)
@@ -2045,14 +2271,24 @@ LLPointer<LLImageRaw> LLTextureCache::readFromFastCache(const LLUUID& id, S32& d
 {
     U32 offset;
     {
-        LLMutexLock lock(&mHeaderMutex);
-        id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-        if(iter == mHeaderIDMap.end())
+        // <FS> Memory mapped texture entries
+        //LLMutexLock lock(&mHeaderMutex);
+        //id_map_t::const_iterator iter = mHeaderIDMap.find(id);
+        //if(iter == mHeaderIDMap.end())
+        //{
+        //    return NULL; //not in the cache
+        //}
+        //
+        //offset = iter->second;
+        LLSharedMutexLock lock(&mHeaderMutex);
+        S32 idx = mHeaderIDIndex.find(id, getMappedEntries());
+        if (idx < 0)
         {
             return NULL; //not in the cache
         }
 
-        offset = iter->second;
+        offset = idx;
+        // </FS>
     }
     offset *= TEXTURE_FAST_CACHE_ENTRY_SIZE;
 
@@ -2289,12 +2525,21 @@ void LLTextureCache::addCompleted(Responder* responder, bool success)
 //called after mHeaderMutex is locked.
 void LLTextureCache::removeCachedTexture(const LLUUID& id)
 {
-    if(mTexturesSizeMap.find(id) != mTexturesSizeMap.end())
+    // <FS> Memory mapped texture entries
+    //if(mTexturesSizeMap.find(id) != mTexturesSizeMap.end())
+    //{
+    //    mTexturesSizeTotal -= mTexturesSizeMap[id] ;
+    //    mTexturesSizeMap.erase(id);
+    //}
+    //mHeaderIDMap.erase(id);
+    Entry* entries = getMappedEntries();
+    S32 idx = mHeaderIDIndex.find(id, entries);
+    if (idx >= 0)
     {
-        mTexturesSizeTotal -= mTexturesSizeMap[id] ;
-        mTexturesSizeMap.erase(id);
+        mTexturesSizeTotal -= entries[idx].mBodySize;
+        mHeaderIDIndex.erase(id, entries);
     }
-    mHeaderIDMap.erase(id);
+    // </FS>
     // We are inside header's mutex so mHeaderAPRFilePoolp is safe to use,
     // but getLocalAPRFilePool() is not safe, it might be in use by worker
     LLAPRFile::remove(getTextureFileName(id), mHeaderAPRFilePoolp);
@@ -2321,12 +2566,22 @@ void LLTextureCache::removeEntry(S32 idx, Entry& entry, std::string& filename)
               file_maybe_exists = false;
           }
         }
-        mTexturesSizeTotal -= entry.mBodySize;
+        // <FS> Memory mapped texture entries
+        // Only valid entries are counted in the total; erase before the
+        // mapped entry is marked free, it is the key of the index.
+        //mTexturesSizeTotal -= entry.mBodySize;
+        if (mHeaderIDIndex.erase(entry.mID, getMappedEntries()))
+        {
+            mTexturesSizeTotal -= entry.mBodySize;
+        }
+        // </FS>
 
         entry.mImageSize = -1;
         entry.mBodySize = 0;
-        mHeaderIDMap.erase(entry.mID);
-        mTexturesSizeMap.erase(entry.mID);
+        // <FS> Memory mapped texture entries
+        //mHeaderIDMap.erase(entry.mID);
+        //mTexturesSizeMap.erase(entry.mID);
+        // </FS>
         mFreeList.insert(idx);
     }
 
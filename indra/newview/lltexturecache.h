@@ -28,6 +28,7 @@
 #define LL_LLTEXTURECACHE_H
 
 #include "lldir.h"
+#include "llmappedfile.h" // <FS> Memory mapped texture entries
 #include "llstl.h"
 #include "llstring.h"
 #include "lluuid.h"
@@ -165,16 +166,22 @@ private:
     void purgeAllTextures(bool purge_directories);
     void purgeTexturesLazy(F32 time_limit_sec);
     void purgeTextures(bool validate);
-    LLAPRFile* openHeaderEntriesFile(bool readonly, S32 offset);
+    // <FS> Memory mapped texture entries
+    bool openHeaderEntriesFile();
     void closeHeaderEntriesFile();
+    bool reserveHeaderEntries(U32 count);
+    Entry* getMappedEntries();
+    U32 getMappedEntryCapacity() const;
+    bool needsEntryTimeStamp() const;
+    U32 loadHeaderEntries();
+    void buildLRU();
+    // </FS>
     void readEntriesHeader();
     void setEntriesHeader();
     void writeEntriesHeader();
     S32 openAndReadEntry(const LLUUID& id, Entry& entry, bool create);
     bool updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32 new_body_size);
     void updateEntryTimeStamp(S32 idx, Entry& entry) ;
-    U32 openAndReadEntries(std::vector<Entry>& entries);
-    void writeEntriesAndClose(const std::vector<Entry>& entries);
     void readEntryFromHeaderImmediately(S32& idx, Entry& entry) ;
     void writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header = false) ;
     void removeEntry(S32 idx, Entry& entry, std::string& filename);
@@ -182,21 +189,53 @@ private:
     S32 getHeaderCacheEntry(const LLUUID& id, Entry& entry);
     S32 setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize);
     void writeUpdatedEntries() ;
-    void updatedHeaderEntriesFile() ;
-    void lockHeaders() { mHeaderMutex.lock(); }
-    void unlockHeaders() { mHeaderMutex.unlock(); }
+    void lockHeaders() { mHeaderMutex.lockExclusive(); }
+    void unlockHeaders() { mHeaderMutex.unlockExclusive(); }
 
     void openFastCache(bool first_time = false);
     void closeFastCache(bool forced = false);
     bool writeToFastCache(LLUUID image_id, S32 cache_id, LLPointer<LLImageRaw> raw, S32 discardlevel);
 
+private:
+    // <FS> Memory mapped texture entries
+    // Open addressing hash from texture id to entry index. The slots only
+    // hold entry indices; the id of a slot is the mID of the mapped entry
+    // it points at, so an entry must be written before it is inserted and
+    // erased before its id is overwritten.
+    class IDIndex
+    {
+    public:
+        IDIndex();
+
+        void clear();
+        void reserve(U32 count, const Entry* entries);
+        S32  find(const LLUUID& id, const Entry* entries) const;
+        void insert(const LLUUID& id, S32 idx, const Entry* entries);
+        bool erase(const LLUUID& id, const Entry* entries);
+        U32  size() const { return mCount; }
+
+    private:
+        void rehash(U32 capacity, const Entry* entries);
+
+        static const S32 EMPTY = -1;
+        static const S32 DELETED = -2;
+
+        std::vector<S32> mSlots;
+        U32 mCount;
+        U32 mDeleted;
+    };
+    // </FS>
+
 private:
     // Internal
     LLMutex mWorkersMutex;
-    LLMutex mHeaderMutex;
+    LLSharedMutex mHeaderMutex; // <FS> Memory mapped texture entries: lookups only need a shared lock
     LLMutex mListMutex;
     LLMutex mFastCacheMutex;
-    LLAPRFile* mHeaderAPRFile;
+    // <FS> Memory mapped texture entries
+    //LLAPRFile* mHeaderAPRFile;
+    LLMappedFile mHeaderEntriesFile;
+    // </FS>
     LLVolatileAPRPool* mFastCachePoolp;
 
     // mLocalAPRFilePoolp is not thread safe and is meant only for workers
@@ -224,9 +263,16 @@ private:
     std::string mFastCacheFileName;
     EntriesInfo mHeaderEntriesInfo;
     std::set<S32> mFreeList; // deleted entries
-    std::set<LLUUID> mLRU;
-    typedef std::map<LLUUID, S32> id_map_t;
-    id_map_t mHeaderIDMap;
+    // <FS> Memory mapped texture entries
+    //std::set<LLUUID> mLRU;
+    //typedef std::map<LLUUID, S32> id_map_t;
+    //id_map_t mHeaderIDMap;
+
+    // Oldest entries, most recent first, with their time stamp when the
+    // list was built. Only built once the entries table is full.
+    std::vector<std::pair<S32, U32> > mLRU;
+    IDIndex mHeaderIDIndex;
+    // </FS>
 
     LLAPRFile*   mFastCachep;
     LLFrameTimer mFastCacheTimer;
@@ -234,13 +280,17 @@ private:
 
     // BODIES (TEXTURES minus headers)
     std::string mTexturesDirName;
-    typedef std::map<LLUUID,S32> size_map_t;
-    size_map_t mTexturesSizeMap;
+    // <FS> Memory mapped texture entries: body sizes are read from the entries
+    //typedef std::map<LLUUID,S32> size_map_t;
+    //size_map_t mTexturesSizeMap;
+    // </FS>
     S64 mTexturesSizeTotal;
     LLAtomicBool mDoPurge;
 
-    typedef std::map<S32, Entry> idx_entry_map_t;
-    idx_entry_map_t mUpdatedEntryMap;
+    // <FS> Memory mapped texture entries: time stamps are written straight to the mapping
+    //typedef std::map<S32, Entry> idx_entry_map_t;
+    //idx_entry_map_t mUpdatedEntryMap;
+    // </FS>
     typedef std::vector<std::pair<S32, Entry> > idx_entry_vector_t;
     idx_entry_vector_t mPurgeEntryList;
 
@@ -968,6 +968,7 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
 
     mType = host.isOk() ? LLImageBase::TYPE_AVATAR_BAKE : LLImageBase::TYPE_NORMAL;
 //  LL_INFOS(LOG_TXT) << "Create: " << mID << " mHost:" << host << " Discard=" << discard << LL_ENDL;
+    setWorkPriority(mImagePriority);
     if (!mFetcher->mDebugPause)
     {
         addWork(0);
@@ -1098,6 +1099,9 @@ void LLTextureFetchWorker::setDesiredDiscard(S32 discard, S32 size)
 void LLTextureFetchWorker::setImagePriority(F32 priority)
 {
     mImagePriority = priority; //should map to max virtual size, abort if zero
+    // move our queued request, so a texture that just came into view
+    // doesn't wait behind everything requested before it
+    setWorkPriority(priority);
 }
 
 // Locks:  Mw
@@ -3157,6 +3161,8 @@ bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S3
 bool LLTextureFetch::updateRequestPriority(const LLUUID& id, F32 priority)
 {
     LL_PROFILE_ZONE_SCOPED;
+    // Posted without a priority, so it runs ahead of the queued requests;
+    // locking the worker here would stall on a worker busy in doWork()
     mRequestQueue.tryPost([=, this]()
         {
             LLTextureFetchWorker* worker = getWorker(id);
@@ -0,0 +1,172 @@
+/**
+ * @file lltexturepriority.cpp
+ * @brief Batched texture decode priority evaluation.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturepriority.h"
+
+#include "llvector4a.h"
+#include "threadpool.h"
+
+namespace
+{
+    // Roughly how many faces one thread pool task evaluates
+    constexpr U32 FACES_PER_CHUNK = 4096;
+
+    // Same operations in the same order as the SIMD path, so both round alike
+    inline F32 boosted_size(F32 vsize, F32 importance, F32 close, F32 camera_boost)
+    {
+        // boost resolution of textures that are important to the camera
+        vsize += vsize * importance * camera_boost;
+        // and again for textures close to the camera
+        vsize += vsize * close * camera_boost;
+        return vsize;
+    }
+}
+
+void LLTexturePriorityBatch::clear()
+{
+    mVirtualSize.clear();
+    mImportance.clear();
+    mCloseToCamera.clear();
+    mFlags.clear();
+    mFaceStart.clear();
+    mTextureBias.clear();
+    mTextureAnimated.clear();
+}
+
+void LLTexturePriorityBatch::reserve(U32 textures, U32 faces)
+{
+    mVirtualSize.reserve(faces);
+    mImportance.reserve(faces);
+    mCloseToCamera.reserve(faces);
+    mFlags.reserve(faces);
+    mFaceStart.reserve(textures + 1);
+    mTextureBias.reserve(textures);
+    mTextureAnimated.reserve(textures);
+}
+
+void LLTexturePriorityBatch::evaluate(F32 camera_boost, U32 min_parallel_faces)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+
+    const U32 texture_count = getTextureCount();
+    const U32 face_count = getFaceCount();
+    mFaceStart.resize(texture_count + 1);
+    mFaceStart[texture_count] = face_count;
+    mBoostedSize.resize(face_count);
+    mResults.resize(texture_count);
+
+    if (!min_parallel_faces || face_count < min_parallel_faces || face_count <= FACES_PER_CHUNK)
+    {
+        evaluateTextures(0, texture_count, camera_boost);
+        mFaceStart.pop_back();
+        return;
+    }
+
+    // Split on texture boundaries, so each chunk reduces its own textures
+    std::vector<U32> chunk_start; // texture index, one more than there are chunks
+    chunk_start.push_back(0);
+    for (U32 t = 0; t < texture_count; ++t)
+    {
+        if (mFaceStart[t + 1] - mFaceStart[chunk_start.back()] >= FACES_PER_CHUNK)
+        {
+            chunk_start.push_back(t + 1);
+        }
+    }
+    if (chunk_start.back() != texture_count)
+    {
+        chunk_start.push_back(texture_count);
+    }
+
+    LL::parallel_for("General", chunk_start.size() - 1, [&](size_t chunk)
+        {
+            evaluateTextures(chunk_start[chunk], chunk_start[chunk + 1], camera_boost);
+        });
+    mFaceStart.pop_back();
+}
+
+void LLTexturePriorityBatch::evaluateTextures(U32 first, U32 last, F32 camera_boost)
+{
+    const U32 face_begin = mFaceStart[first];
+    const U32 face_end = mFaceStart[last];
+
+    // Boost every face of the range, four at a time
+    LLVector4a boost;
+    boost.splat(camera_boost);
+    U32 i = face_begin;
+    for (; i + 4 <= face_end; i += 4)
+    {
+        LLVector4a vsize, importance, close, delta;
+        vsize.loadua(&mVirtualSize[i]);
+        importance.loadua(&mImportance[i]);
+        close.loadua(&mCloseToCamera[i]);
+
+        delta.setMul(vsize, importance);
+        delta.mul(boost);
+        vsize.add(delta);
+
+        delta.setMul(vsize, close);
+        delta.mul(boost);
+        vsize.add(delta);
+
+        _mm_storeu_ps(&mBoostedSize[i], vsize);
+    }
+    for (; i < face_end; ++i)
+    {
+        mBoostedSize[i] = boosted_size(mVirtualSize[i], mImportance[i], mCloseToCamera[i], camera_boost);
+    }
+
+    // Then reduce per texture
+    for (U32 t = first; t < last; ++t)
+    {
+        Result& result = mResults[t];
+        const U32 begin = mFaceStart[t];
+        const U32 end = mFaceStart[t + 1];
+
+        F32 max_on_screen_vsize = 0.f;
+        bool on_screen = false;
+        bool close_to_camera = false;
+        U8 flags = 0;
+        for (U32 f = begin; f < end; ++f)
+        {
+            max_on_screen_vsize = llmax(max_on_screen_vsize, mBoostedSize[f]);
+            // a texture even a little important to the camera counts as on screen
+            on_screen |= mImportance[f] * 1000.f >= 1.f;
+            close_to_camera |= mCloseToCamera[f] != 0.f;
+            flags |= mFlags[f];
+        }
+
+        result.mFaceCount = end - begin;
+        result.mMaxOnScreenVirtualSize = max_on_screen_vsize;
+        // the bias is a positive scale, so it can be applied after the max
+        result.mMaxVirtualSize = max_on_screen_vsize * mTextureBias[t];
+        result.mOnScreen = on_screen || (flags & FACE_IN_FRUSTUM);
+        result.mCloseToCamera = close_to_camera;
+        result.mAnimated = (flags & FACE_ANIMATED) || (result.mFaceCount && mTextureAnimated[t]);
+    }
+}
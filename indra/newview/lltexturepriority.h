@@ -0,0 +1,107 @@
+/**
+ * @file lltexturepriority.h
+ * @brief Batched texture decode priority evaluation.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTUREPRIORITY_H
+#define LL_LLTEXTUREPRIORITY_H
+
+#include <vector>
+
+/**
+ * Structure of arrays snapshot of the faces using a batch of textures.
+ *
+ * LLViewerTextureList fills it on the main thread, one texture after the
+ * other, from the face data that is already up to date (virtual size,
+ * frustum state, importance to camera). evaluate() then computes the
+ * per texture decode priority inputs with SIMD, optionally split across
+ * the "General" thread pool, and the results are applied to all the
+ * textures of the batch at once.
+ */
+class LLTexturePriorityBatch
+{
+public:
+    struct Result
+    {
+        F32  mMaxVirtualSize = 0.f;         // bias applied
+        F32  mMaxOnScreenVirtualSize = 0.f; // no bias
+        U32  mFaceCount = 0;
+        bool mOnScreen = false;
+        bool mCloseToCamera = false;
+        bool mAnimated = false;
+    };
+
+    void clear();
+    void reserve(U32 textures, U32 faces);
+
+    // Faces added after this belong to the new texture. bias is the vsize
+    // scale for the texture, animated is for state shared by all its faces.
+    U32 addTexture(F32 bias, bool animated)
+    {
+        mFaceStart.push_back((U32)mVirtualSize.size());
+        mTextureBias.push_back(bias);
+        mTextureAnimated.push_back(animated);
+        return (U32)mTextureBias.size() - 1;
+    }
+
+    // Called for every face in view, keep it inline
+    void addFace(F32 virtual_size, F32 importance_to_camera, F32 close_to_camera, bool in_frustum, bool animated)
+    {
+        mVirtualSize.push_back(virtual_size);
+        mImportance.push_back(importance_to_camera);
+        mCloseToCamera.push_back(close_to_camera);
+        mFlags.push_back((in_frustum ? FACE_IN_FRUSTUM : 0) | (animated ? FACE_ANIMATED : 0));
+    }
+
+    // Fill in the results for every texture added since clear().
+    // Batches with at least min_parallel_faces faces are split across the
+    // "General" thread pool when there is one, 0 keeps it on this thread.
+    void evaluate(F32 camera_boost, U32 min_parallel_faces = 0);
+
+    U32 getTextureCount() const             { return (U32)mTextureBias.size(); }
+    U32 getFaceCount() const                { return (U32)mVirtualSize.size(); }
+    const Result& getResult(U32 texture) const { return mResults[texture]; }
+
+private:
+    static constexpr U8 FACE_IN_FRUSTUM = 0x01;
+    static constexpr U8 FACE_ANIMATED   = 0x02;
+
+    void evaluateTextures(U32 first, U32 last, F32 camera_boost);
+
+    // per face
+    std::vector<F32> mVirtualSize;
+    std::vector<F32> mImportance;
+    std::vector<F32> mCloseToCamera;
+    std::vector<U8>  mFlags;
+    std::vector<F32> mBoostedSize;
+
+    // per texture, mFaceStart has one more entry than there are textures
+    std::vector<U32>    mFaceStart;
+    std::vector<F32>    mTextureBias;
+    std::vector<U8>     mTextureAnimated;
+    std::vector<Result> mResults;
+};
+
+#endif // LL_LLTEXTUREPRIORITY_H
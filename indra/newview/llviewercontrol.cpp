@@ -71,7 +71,9 @@
 #include "llappviewer.h"
 #include "llvosurfacepatch.h"
 #include "llvowlsky.h"
+#include "llvolume.h"
 #include "llrender.h"
+#include "lluictrlfactory.h" // <FS> XUI layout cache
 #include "llnavigationbar.h"
 #include "llnotificationsutil.h"
 #include "llfloatertools.h"
@@ -1106,6 +1108,29 @@ void handleDiskCacheLowWaterPctChanged(const LLSD& newValue)
 }
 // </FS:Beq>
 
+// <FS> Pack file for small assets
+void handleDiskCachePackThresholdChanged(const LLSD& newValue)
+{
+    LLDiskCache::getInstance()->setPackThreshold((U32)newValue.asInteger());
+}
+// </FS>
+
+// <FS> Face BVH for picking
+static bool handleRaycastBVHChanged(const LLSD& newvalue)
+{
+    LLVolumeFace::setRaycastBVH(newvalue.asBoolean());
+    return true;
+}
+// </FS>
+
+// <FS> XUI layout cache
+static bool handleXUILayoutCacheChanged(const LLSD& newvalue)
+{
+    LLUICtrlFactory::getLayoutCache().setEnabled(newvalue.asBoolean());
+    return true;
+}
+// </FS>
+
 void handleTargetFPSChanged(const LLSD& newValue)
 {
     const auto targetFPS = gSavedSettings.getU32("TargetFPS");
@@ -1546,6 +1571,9 @@ void settings_setup_listeners()
     setting_setup_signal_listener(gSavedSettings, "FSDiskCacheHighWaterPercent", handleDiskCacheHighWaterPctChanged);
     setting_setup_signal_listener(gSavedSettings, "FSDiskCacheLowWaterPercent", handleDiskCacheLowWaterPctChanged);
     // </FS:Beq>
+    setting_setup_signal_listener(gSavedSettings, "FSDiskCachePackThreshold", handleDiskCachePackThresholdChanged); // <FS> Pack file for small assets
+    setting_setup_signal_listener(gSavedSettings, "FSRaycastBVH", handleRaycastBVHChanged); // <FS> Face BVH for picking
+    setting_setup_signal_listener(gSavedSettings, "FSXUILayoutCache", handleXUILayoutCacheChanged); // <FS> XUI layout cache
 
     // <FS:Zi> Handle IME text input getting enabled or disabled
 #if LL_SDL2
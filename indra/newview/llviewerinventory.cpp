@@ -41,6 +41,7 @@
 #include "llfolderview.h"
 #include "llviewercontrol.h"
 #include "llconsole.h"
+#include "llinventorycache.h"
 #include "llinventorydefines.h"
 #include "llinventoryfunctions.h"
 #include "llinventorymodel.h"
@@ -71,6 +72,7 @@
 #include "llclipboard.h"
 #include "llhttpretrypolicy.h"
 #include "llsettingsvo.h"
+#include "llslabpool.h" // <FS> Slab allocated inventory objects
 // [RLVa:KB] - Checked: 2014-11-02 (RLVa-1.4.11)
 #include "rlvcommon.h"
 // [/RLVa:KB]
@@ -387,6 +389,48 @@ LLViewerInventoryItem::~LLViewerInventoryItem()
 {
 }
 
+// <FS> Slab allocated inventory objects
+namespace
+{
+    static_assert(alignof(LLViewerInventoryItem) <= alignof(std::max_align_t), "slab blocks are not aligned enough");
+    static_assert(alignof(LLViewerInventoryCategory) <= alignof(std::max_align_t), "slab blocks are not aligned enough");
+
+    // Never destroyed: inventory objects can still be released during
+    // static destruction, after a function local pool would be gone
+    LLSlabPool& get_item_pool()
+    {
+        static LLSlabPool* pool = new LLSlabPool(sizeof(LLViewerInventoryItem), 1024);
+        return *pool;
+    }
+
+    LLSlabPool& get_category_pool()
+    {
+        static LLSlabPool* pool = new LLSlabPool(sizeof(LLViewerInventoryCategory), 256);
+        return *pool;
+    }
+}
+
+// static
+void* LLViewerInventoryItem::operator new(size_t size)
+{
+    // a derived class of another size gets the heap
+    return size == sizeof(LLViewerInventoryItem) ? get_item_pool().allocate() : ::operator new(size);
+}
+
+// static
+void LLViewerInventoryItem::operator delete(void* ptr, size_t size)
+{
+    if (size == sizeof(LLViewerInventoryItem))
+    {
+        get_item_pool().free(ptr);
+    }
+    else
+    {
+        ::operator delete(ptr);
+    }
+}
+// </FS>
+
 void LLViewerInventoryItem::copyViewerItem(const LLViewerInventoryItem* other)
 {
     LLInventoryItem::copyItem(other);
@@ -653,6 +697,27 @@ LLViewerInventoryCategory::~LLViewerInventoryCategory()
 {
 }
 
+// <FS> Slab allocated inventory objects
+// static
+void* LLViewerInventoryCategory::operator new(size_t size)
+{
+    return size == sizeof(LLViewerInventoryCategory) ? get_category_pool().allocate() : ::operator new(size);
+}
+
+// static
+void LLViewerInventoryCategory::operator delete(void* ptr, size_t size)
+{
+    if (size == sizeof(LLViewerInventoryCategory))
+    {
+        get_category_pool().free(ptr);
+    }
+    else
+    {
+        ::operator delete(ptr);
+    }
+}
+// </FS>
+
 void LLViewerInventoryCategory::copyViewerCategory(const LLViewerInventoryCategory* other)
 {
     copyCategory(other);
@@ -864,6 +929,23 @@ bool LLViewerInventoryCategory::importLLSD(const LLSD& cat_data)
     return true;
 }
 
+void LLViewerInventoryCategory::exportCache(LLInventoryCacheWriter& writer) const
+{
+    LLInventoryCacheCategory record;
+    LLInventoryCategory::exportCacheRecord(record, writer);
+    record.mOwnerID = mOwnerID;
+    record.mVersion = mVersion;
+    writer.addCategory(record);
+}
+
+bool LLViewerInventoryCategory::importCache(const LLInventoryCacheCategory& record, const LLInventoryCacheStrings& strings)
+{
+    LLInventoryCategory::importCache(record, strings);
+    mOwnerID = record.mOwnerID;
+    setVersion(record.mVersion);
+    return true;
+}
+
 bool LLViewerInventoryCategory::acceptItem(LLInventoryItem* inv_item)
 {
     if (!inv_item)
@@ -54,6 +54,11 @@ class LLViewerInventoryItem : public LLInventoryItem, public boost::signals2::tr
 public:
     typedef std::vector<LLPointer<LLViewerInventoryItem> > item_array_t;
 
+    // <FS> Slab allocated, large inventories hold hundreds of thousands
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
+    // </FS>
+
 protected:
     ~LLViewerInventoryItem( void ); // ref counted
     bool extractSortFieldAndDisplayName(S32* sortField, std::string* displayName) const { return extractSortFieldAndDisplayName(mName, sortField, displayName); }
@@ -182,6 +187,11 @@ class LLViewerInventoryCategory  : public LLInventoryCategory
 public:
     typedef std::vector<LLPointer<LLViewerInventoryCategory> > cat_array_t;
 
+    // <FS> Slab allocated, like LLViewerInventoryItem
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
+    // </FS>
+
 protected:
     ~LLViewerInventoryCategory();
 
@@ -234,6 +244,8 @@ public:
 
     LLSD exportLLSD() const;
     bool importLLSD(const LLSD& cat_data);
+    void exportCache(LLInventoryCacheWriter& writer) const;
+    bool importCache(const LLInventoryCacheCategory& record, const LLInventoryCacheStrings& strings);
 
     void determineFolderType();
     void changeType(LLFolderType::EType new_folder_type);
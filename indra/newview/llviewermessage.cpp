@@ -4451,7 +4451,10 @@ void process_object_update(LLMessageSystem *mesgsys, void **user_data)
 
     // Update the object...
     S32 old_num_objects = gObjectList.mNumNewObjects;
-    gObjectList.processObjectUpdate(mesgsys, user_data, OUT_FULL);
+    // <FS> object update pipeline
+    //gObjectList.processObjectUpdate(mesgsys, user_data, OUT_FULL);
+    gObjectList.processFullObjectUpdate(mesgsys, user_data);
+    // </FS>
     if (old_num_objects != gObjectList.mNumNewObjects)
     {
         update_attached_sounds();
@@ -4492,6 +4495,7 @@ void process_cached_object_update(LLMessageSystem *mesgsys, void **user_data)
     }
 
     // Update the object...
+    gObjectList.flushQueuedUpdatesFor(mesgsys, _PREHASH_ObjectData, _PREHASH_ID); // <FS> object update pipeline
     gObjectList.processCachedObjectUpdate(mesgsys, user_data, OUT_FULL_CACHED);
 }
 
@@ -4519,6 +4523,10 @@ void process_kill_object(LLMessageSystem *mesgsys, void **user_data)
 {
     LL_PROFILE_ZONE_SCOPED;
 
+    // <FS> queued updates must not bring the objects back
+    gObjectList.flushQueuedUpdatesFor(mesgsys, _PREHASH_ObjectData, _PREHASH_ID);
+    // </FS>
+
     LLUUID      id;
 
     U32 ip = mesgsys->getSenderIP();
@@ -4623,6 +4631,8 @@ void process_kill_object(LLMessageSystem *mesgsys, void **user_data)
 // <FS:Techwolf Lupindo> area search
 void process_object_properties(LLMessageSystem *msg, void**user_data)
 {
+    gObjectList.flushQueuedUpdatesForIDs(msg, _PREHASH_ObjectData, _PREHASH_ObjectID); // <FS> object update pipeline
+
     // Send the result to the corresponding requesters.
     LLSelectMgr::processObjectProperties(msg, user_data);
 
@@ -4645,6 +4655,8 @@ void process_object_properties(LLMessageSystem *msg, void**user_data)
 // <FS:Ansariel> Anti spam
 void process_object_properties_family(LLMessageSystem *msg, void**user_data)
 {
+    gObjectList.flushQueuedUpdatesForIDs(msg, _PREHASH_ObjectData, _PREHASH_ObjectID); // <FS> object update pipeline
+
     // Send the result to the corresponding requesters.
     LLSelectMgr::processObjectPropertiesFamily(msg, user_data);
 
@@ -4866,6 +4878,7 @@ void process_preload_sound(LLMessageSystem *msg, void **user_data)
     msg->getUUIDFast(_PREHASH_DataBlock, _PREHASH_SoundID, sound_id);
     msg->getUUIDFast(_PREHASH_DataBlock, _PREHASH_ObjectID, object_id);
     msg->getUUIDFast(_PREHASH_DataBlock, _PREHASH_OwnerID, owner_id);
+    gObjectList.flushQueuedUpdatesForIDs(msg, _PREHASH_DataBlock, _PREHASH_ObjectID); // <FS> object update pipeline
 
     // <FS:ND> Protect against corrupted sounds
     if (gAudiop->isCorruptSound(sound_id))
@@ -4921,6 +4934,7 @@ void process_attached_sound(LLMessageSystem *msg, void **user_data)
     msg->getUUIDFast(_PREHASH_DataBlock, _PREHASH_SoundID, sound_id);
     msg->getUUIDFast(_PREHASH_DataBlock, _PREHASH_ObjectID, object_id);
     msg->getUUIDFast(_PREHASH_DataBlock, _PREHASH_OwnerID, owner_id);
+    gObjectList.flushQueuedUpdatesForIDs(msg, _PREHASH_DataBlock, _PREHASH_ObjectID); // <FS> object update pipeline
 
     // <FS:ND> Protect against corrupted sounds
     if (gAudiop->isCorruptSound(sound_id))
@@ -4974,6 +4988,7 @@ void process_attached_sound_gain_change(LLMessageSystem *mesgsys, void **user_da
     LLViewerObject *objectp = NULL;
 
     mesgsys->getUUIDFast(_PREHASH_DataBlock, _PREHASH_ObjectID, object_guid);
+    gObjectList.flushQueuedUpdatesForIDs(mesgsys, _PREHASH_DataBlock, _PREHASH_ObjectID); // <FS> object update pipeline
 
     if (!((objectp = gObjectList.findObject(object_guid))))
     {
@@ -5100,6 +5115,10 @@ void process_avatar_animation(LLMessageSystem *mesgsys, void **user_data)
     LLVOAvatar *avatarp = NULL;
 
     mesgsys->getUUIDFast(_PREHASH_Sender, _PREHASH_ID, uuid);
+    // <FS> object update pipeline
+    gObjectList.flushQueuedUpdatesForIDs(mesgsys, _PREHASH_Sender, _PREHASH_ID);
+    gObjectList.flushQueuedUpdatesForIDs(mesgsys, _PREHASH_AnimationSourceList, _PREHASH_ObjectID);
+    // </FS>
 
     LLViewerObject *objp = gObjectList.findObject(uuid);
     if (objp)
@@ -5227,6 +5246,7 @@ void process_object_animation(LLMessageSystem *mesgsys, void **user_data)
     S32     anim_sequence_id;
 
     mesgsys->getUUIDFast(_PREHASH_Sender, _PREHASH_ID, uuid);
+    gObjectList.flushQueuedUpdatesForIDs(mesgsys, _PREHASH_Sender, _PREHASH_ID); // <FS> object update pipeline
 
     LL_DEBUGS("AnimatedObjectsNotify") << "Received animation state for object " << uuid << LL_ENDL;
 
@@ -5289,6 +5309,7 @@ void process_avatar_appearance(LLMessageSystem *mesgsys, void **user_data)
 {
     LLUUID uuid;
     mesgsys->getUUIDFast(_PREHASH_Sender, _PREHASH_ID, uuid);
+    gObjectList.flushQueuedUpdatesForIDs(mesgsys, _PREHASH_Sender, _PREHASH_ID); // <FS> object update pipeline
 
     LLVOAvatar* avatarp = (LLVOAvatar *)gObjectList.findObject(uuid);
     if (avatarp)
@@ -5332,6 +5353,7 @@ void process_avatar_sit_response(LLMessageSystem *mesgsys, void **user_data)
     LLUUID sitObjectID;
     bool use_autopilot;
     mesgsys->getUUIDFast(_PREHASH_SitObject, _PREHASH_ID, sitObjectID);
+    gObjectList.flushQueuedUpdatesForIDs(mesgsys, _PREHASH_SitObject, _PREHASH_ID); // <FS> object update pipeline
     mesgsys->getBOOLFast(_PREHASH_SitTransform, _PREHASH_AutoPilot, use_autopilot);
     mesgsys->getVector3Fast(_PREHASH_SitTransform, _PREHASH_SitPosition, sitPosition);
     mesgsys->getQuatFast(_PREHASH_SitTransform, _PREHASH_SitRotation, sitRotation);
@@ -5394,6 +5416,7 @@ void process_set_follow_cam_properties(LLMessageSystem *mesgsys, void **user_dat
     LLUUID      source_id;
 
     mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_ObjectID, source_id);
+    gObjectList.flushQueuedUpdatesForIDs(mesgsys, _PREHASH_ObjectData, _PREHASH_ObjectID); // <FS> object update pipeline
 
     LLViewerObject* objectp = gObjectList.findObject(source_id);
     if (objectp)
@@ -5508,6 +5531,7 @@ void process_name_value(LLMessageSystem *mesgsys, void **user_data)
     S32     i, num_blocks;
 
     mesgsys->getUUIDFast(_PREHASH_TaskData, _PREHASH_ID, id);
+    gObjectList.flushQueuedUpdatesForIDs(mesgsys, _PREHASH_TaskData, _PREHASH_ID); // <FS> object update pipeline
 
     LLViewerObject* object = gObjectList.findObject(id);
 
@@ -5534,6 +5558,7 @@ void process_remove_name_value(LLMessageSystem *mesgsys, void **user_data)
     S32     i, num_blocks;
 
     mesgsys->getUUIDFast(_PREHASH_TaskData, _PREHASH_ID, id);
+    gObjectList.flushQueuedUpdatesForIDs(mesgsys, _PREHASH_TaskData, _PREHASH_ID); // <FS> object update pipeline
 
     LLViewerObject* object = gObjectList.findObject(id);
 
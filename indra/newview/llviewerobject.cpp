@@ -97,6 +97,7 @@
 #include "llviewernetwork.h"
 #include "llvowlsky.h"
 #include "llmanip.h"
+#include "llobjectupdatequeue.h" // <FS> object update pipeline
 #include "lltrans.h"
 #include "llsdutil.h"
 #include "llmediaentry.h"
@@ -1211,7 +1212,9 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                      void **user_data,
                      U32 block_num,
                      const EObjectUpdateType update_type,
-                     LLDataPacker *dp)
+                     LLDataPacker *dp,
+                     const LLObjectUpdatePacket* packet,
+                     const LLObjectUpdatePacket::FullUpdate* full_update)
 {
     LL_PROFILE_ZONE_SCOPED;
     LL_DEBUGS_ONCE("SceneLoadTiming") << "Received viewer object data" << LL_ENDL;
@@ -1223,10 +1226,12 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
     // Each case should start at the beginning of the buffer and extract all known
     // values, and ignore any unknown data at the end of the buffer.
     // This allows new data in the future without breaking current viewers.
-    const S32 OBJECTDATA_FIELD_SIZE_140 = 140;  // Full precision avatar update for future extended data
-    const S32 OBJECTDATA_FIELD_SIZE_124 = 124;  // Full precision object update for future extended data
-    const S32 OBJECTDATA_FIELD_SIZE_76  =  76;  // Full precision avatar update
-    const S32 OBJECTDATA_FIELD_SIZE_60  =  60;  // Full precision object update
+    // <FS> object update pipeline: the full precision sizes are read by LLObjectUpdatePacket
+    //const S32 OBJECTDATA_FIELD_SIZE_140 = 140;  // Full precision avatar update for future extended data
+    //const S32 OBJECTDATA_FIELD_SIZE_124 = 124;  // Full precision object update for future extended data
+    //const S32 OBJECTDATA_FIELD_SIZE_76  =  76;  // Full precision avatar update
+    //const S32 OBJECTDATA_FIELD_SIZE_60  =  60;  // Full precision object update
+    // </FS>
     const S32 OBJECTDATA_FIELD_SIZE_80 =   80;  // Terse avatar update, 16 bit precision for future extended data
     const S32 OBJECTDATA_FIELD_SIZE_64  =  64;  // Terse object update, 16 bit precision for future extended data
     const S32 OBJECTDATA_FIELD_SIZE_48  =  48;  // Terse avatar update, 16 bit precision
@@ -1244,9 +1249,28 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
     // Coordinates of objects on simulators are region-local.
     U64 region_handle = 0;
 
-    if(mesgsys != NULL)
+    // <FS> A queued update stands in for the message, a terse one comes
+    // decoded unless its block ran short. Full updates always come
+    // decoded, see LLViewerObjectList::processUpdateCore().
+    const LLObjectUpdatePacket::TerseUpdate* terse_update = packet ? packet->getTerseUpdate(block_num) : NULL;
+    if (update_type != OUT_TERSE_IMPROVED && !full_update)
+    {
+        LL_WARNS("UpdateFail") << "Full update without its decoded block for " << getID() << LL_ENDL;
+        return retval;
+    }
+
+    //if(mesgsys != NULL)
+    if(mesgsys != NULL || packet)
     {
-        mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+        if (packet)
+        {
+            region_handle = packet->getRegionHandle();
+        }
+        else
+        {
+            mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+        }
+    // </FS>
         LLViewerRegion* regionp = LLWorld::getInstance()->getRegionFromHandle(region_handle);
         if(regionp != mRegionp && regionp && mRegionp)//region cross
         {
@@ -1284,10 +1308,20 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
     }
 
     F32 time_dilation = 1.f;
-    if(mesgsys != NULL)
+    // <FS> object update pipeline
+    //if(mesgsys != NULL)
+    if(mesgsys != NULL || packet)
     {
         U16 time_dilation16;
-        mesgsys->getU16Fast(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation16);
+        if (packet)
+        {
+            time_dilation16 = packet->getTimeDilation();
+        }
+        else
+        {
+            mesgsys->getU16Fast(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation16);
+        }
+    // </FS>
         time_dilation = ((F32) time_dilation16) / 65535.f;
         mRegionp->setTimeDilation(time_dilation);
     }
@@ -1336,7 +1370,11 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
         parent_id = cur_parentp->mLocalID;
     }
 
-    if (!dp)
+    // <FS> object update pipeline: compressed updates come decoded,
+    // queued ones without a data packer
+    //if (!dp)
+    if (!dp && update_type != OUT_FULL_COMPRESSED && update_type != OUT_FULL_CACHED)
+    // </FS>
     {
         switch(update_type)
         {
@@ -1352,36 +1390,18 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                     gFloaterTools->dirty();
                 }
 
-                LLUUID audio_uuid;
-                LLUUID owner_id;    // only valid if audio_uuid or particle system is not null
-                F32    gain;
-                F32    cutoff;
-                U8     sound_flags;
-
-                mesgsys->getU32Fast( _PREHASH_ObjectData, _PREHASH_CRC, crc, block_num);
-                mesgsys->getU32Fast( _PREHASH_ObjectData, _PREHASH_ParentID, parent_id, block_num);
-                mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_Sound, audio_uuid, block_num );
-                // HACK: Owner id only valid if non-null sound id or particle system
-                mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_OwnerID, owner_id, block_num );
-                mesgsys->getF32Fast( _PREHASH_ObjectData, _PREHASH_Gain, gain, block_num );
-                mesgsys->getF32Fast(  _PREHASH_ObjectData, _PREHASH_Radius, cutoff, block_num );
-                mesgsys->getU8Fast(  _PREHASH_ObjectData, _PREHASH_Flags, sound_flags, block_num );
-                mesgsys->getU8Fast(  _PREHASH_ObjectData, _PREHASH_Material, material, block_num );
-                mesgsys->getU8Fast(  _PREHASH_ObjectData, _PREHASH_ClickAction, click_action, block_num);
-                mesgsys->getVector3Fast(_PREHASH_ObjectData, _PREHASH_Scale, new_scale, block_num );
-                length = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_ObjectData);
-                mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_ObjectData, data, length, block_num, MAX_OBJECT_BINARY_DATA_SIZE);
-                length = llmin(length, MAX_OBJECT_BINARY_DATA_SIZE);  // getBinaryDataFast() safely fills the buffer to max_size
+                // <FS> object update pipeline: decoded by LLObjectUpdatePacket
+                crc = full_update->mCRC;
+                parent_id = full_update->mParentID;
+                material = full_update->mMaterial;
+                click_action = full_update->mClickAction;
+                new_scale = full_update->mScale;
 
                 mTotalCRC = crc;
-                // Might need to update mSourceMuted here to properly pick up new radius
-                mSoundCutOffRadius = cutoff;
+                mSoundCutOffRadius = full_update->mSoundRadius;
+                setAttachedSound(full_update->mSoundID, full_update->mOwnerID, full_update->mGain, full_update->mSoundFlags);
 
-                // Owner ID used for sound muting or particle system muting
-                setAttachedSound(audio_uuid, owner_id, gain, sound_flags);
-
-                U8 old_material = getMaterial();
-                if (old_material != material)
+                if (getMaterial() != material)
                 {
                     setMaterial(material);
                     if (mDrawable.notNull())
@@ -1391,162 +1411,93 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                 }
                 setClickAction(click_action);
 
-                count = 0;
-                LLVector4 collision_plane;
-
-                switch(length)
+                if (full_update->mHasMotion)
                 {
-                case OBJECTDATA_FIELD_SIZE_140:
-                case OBJECTDATA_FIELD_SIZE_76:
-                    // pull out collision normal for avatar
-                    htolememcpy(collision_plane.mV, &data[count], MVT_LLVector4, sizeof(LLVector4));
-                    ((LLVOAvatar*)this)->setFootPlane(collision_plane);
-                    count += sizeof(LLVector4);
-
-                case OBJECTDATA_FIELD_SIZE_124:
-                case OBJECTDATA_FIELD_SIZE_60:
-                    this_update_precision = 32;
-                    // this is a full precision update
-                    // pos
-                    htolememcpy(new_pos_parent.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
-                    count += sizeof(LLVector3);
-                    // vel
-                    htolememcpy((void*)getVelocity().mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
-                    count += sizeof(LLVector3);
-                    // acc
-                    htolememcpy((void*)getAcceleration().mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
-                    count += sizeof(LLVector3);
-                    // theta
+                    if (full_update->mHasFootPlane)
                     {
-                        LLVector3 vec;
-                        htolememcpy(vec.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
-                        new_rot.unpackFromVector3(vec);
+                        ((LLVOAvatar*)this)->setFootPlane(full_update->mFootPlane);
                     }
-                    count += sizeof(LLVector3);
-                    // omega
-                    htolememcpy((void*)new_angv.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
+                    this_update_precision = 32;
+                    new_pos_parent = full_update->mPosition;
+                    // written in place, the message is not checked for being finite
+                    const_cast<LLVector3&>(getVelocity()) = full_update->mVelocity;
+                    const_cast<LLVector3&>(getAcceleration()) = full_update->mAcceleration;
+                    new_rot = full_update->mRotation;
+                    new_angv = full_update->mAngularVelocity;
                     if (new_angv.isExactlyZero())
                     {
                         // reset rotation time
                         resetRot();
                     }
                     setAngularVelocity(new_angv);
-                    count += sizeof(LLVector3);
 #if LL_DARWIN
-                    if (length == OBJECTDATA_FIELD_SIZE_76 ||
-                        length == OBJECTDATA_FIELD_SIZE_140)
+                    // the avatar sizes, 76 and 140
+                    if (full_update->mHasFootPlane)
                     {
                         setAngularVelocity(LLVector3::zero);
                     }
 #endif
-                    break;
-
-                // length values 48, 32 and 16 were once in viewer code but
-                //   are never sent by the SL simulator
-                default:
-                    LL_WARNS("UpdateFail") << "Unexpected ObjectData buffer size " << length
+                }
+                else
+                {
+                    LL_WARNS("UpdateFail") << "Unexpected ObjectData buffer size " << full_update->mMotionSize
                         << " for " << getID() << " with OUT_FULL message" << LL_ENDL;
                 }
 
-                ////////////////////////////////////////////////////
-                //
-                // Here we handle data specific to the full message.
-                //
-
-                U32 flags;
-                mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, block_num);
+                const U32 flags = full_update->mUpdateFlags;
                 // clear all but local flags
                 mFlags &= FLAGS_LOCAL;
                 mFlags |= flags;
-
-                U8 state;
-                mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_State, state, block_num );
-                mAttachmentState = state;
-
-                // ...new objects that should come in selected need to be added to the selected list
+                mAttachmentState = full_update->mState;
                 mCreateSelected = ((flags & FLAGS_CREATE_SELECTED) != 0);
 
-                // Set all name value pairs
-                S32 nv_size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_NameValue);
-                if (nv_size > 0)
+                if (full_update->mHasNameValues)
                 {
-                    std::string name_value_list;
-                    mesgsys->getStringFast(_PREHASH_ObjectData, _PREHASH_NameValue, name_value_list, block_num);
-                    setNameValueList(name_value_list);
+                    setNameValueList(full_update->mNameValues);
                 }
 
-                // Clear out any existing generic data
                 if (mData)
                 {
                     delete [] mData;
                     mData = NULL;
                 }
-
-                // Dec 2023 new generic data:
-                //    Trees work as before, this field contains genome data
-                //    Not a tree:  root objects send 1 byte with the number of
-                //      total prims in the linkset
-                //    If the generic data size is zero, then number of prims is 1
-                //
-                // Viewers should not check for specific data sizes exactly, but if
-                // the field has data, process it from the start and ignore the remainder.
-
-                // Check for appended generic data
-                const S32 GENERIC_DATA_BUFFER_SIZE = 16;
-                S32 data_size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_Data);
-                if (data_size > 0)
-                {    // has generic data
+                if (full_update->mHasData)
+                {
                     if (getPCode() == LL_PCODE_LEGACY_TREE || getPCode() == LL_PCODE_TREE_NEW)
                     {
-                        mData = new U8[data_size];
-                        mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, mData, data_size, block_num);
-                        LL_DEBUGS("NewObjectData") << "Read " << data_size << " bytes tree genome data for " << getID() << ", pcode "
+                        mData = new U8[full_update->mData.size()];
+                        memcpy(mData, full_update->mData.data(), full_update->mData.size());
+                        LL_DEBUGS("NewObjectData") << "Read " << full_update->mData.size() << " bytes tree genome data for " << getID() << ", pcode "
                                              << getPCodeString() << ", value " << (S32) mData[0] << LL_ENDL;
                     }
-                    else
-                    {   // Extract number of prims
-                        U8 generic_data[GENERIC_DATA_BUFFER_SIZE];
-                        mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data,
-                            &generic_data[0], llmin(data_size, GENERIC_DATA_BUFFER_SIZE), block_num);
-                        // This is sample code to extract the number of prims
-                        //    Future viewers should use it for their own purposes
-                        if (!isAvatar())
-                        {
-                            S32 num_prims = (S32) generic_data[0];
-                            LL_DEBUGS("NewObjectData") << "Root prim " << getID() << " has "
-                                << num_prims << " prims in linkset" << LL_ENDL;
-                        }
+                    else if (!isAvatar())
+                    {
+                        LL_DEBUGS("NewObjectData") << "Root prim " << getID() << " has "
+                            << (S32) full_update->mData[0] << " prims in linkset" << LL_ENDL;
                     }
                 }
 
-                S32 text_size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_Text);
-                if (text_size > 1)
+                if (full_update->mHasText)
                 {
-                    // Setup object text
                     if (!mText)
                     {
                         initHudText();
                     }
 
-                    std::string temp_string;
-                    mesgsys->getStringFast(_PREHASH_ObjectData, _PREHASH_Text, temp_string, block_num );
-
-                    LLColor4U coloru;
-                    mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_TextColor, coloru.mV, 4, block_num);
-
+                    LLColor4U coloru = full_update->mTextColor;
                     // alpha was flipped so that it zero encoded better
                     coloru.mV[3] = 255 - coloru.mV[3];
 
                     mText->setColor(LLColor4(coloru));
-                    mText->setString(temp_string);
+                    mText->setString(full_update->mText);
 // [RLVa:KB] - Checked: 2010-03-27 (RLVa-1.4.0a) | Added: RLVa-1.0.0f
                     if (RlvActions::isRlvEnabled())
                     {
-                        mText->setObjectText(temp_string);
+                        mText->setObjectText(full_update->mText);
                     }
 // [/RLVa:KB]
 
-                    mHudText = temp_string;
+                    mHudText = full_update->mText;
                     mHudTextColor = LLColor4(coloru);
 
                     setChanged(MOVED | SILHOUETTE);
@@ -1561,51 +1512,20 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                     mHudText.clear();
                 }
 
-                std::string media_url;
-                mesgsys->getStringFast(_PREHASH_ObjectData, _PREHASH_MediaURL, media_url, block_num);
-                retval |= checkMediaURL(media_url);
+                retval |= checkMediaURL(full_update->mMediaURL);
 
-                //
-                // Unpack particle system data
-                //
-                unpackParticleSource(block_num, owner_id);
+                unpackParticleSource(full_update->mParticles.get(), full_update->mOwnerID, true);
 
-                // Mark all extra parameters not used
                 std::unordered_map<U16, ExtraParameter*>::iterator iter;
                 for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
                 {
                     iter->second->in_use = false;
                 }
-
-                // Unpack extra parameters
-                S32 size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_ExtraParams);
-                if (size > 0)
+                for (const LLObjectUpdatePacket::ExtraParam& param : full_update->mExtraParams)
                 {
-                    U8 *buffer = new(std::nothrow) U8[size];
-                    if (!buffer)
-                    {
-                        LLError::LLUserWarningMsg::showOutOfMemory();
-                        LL_ERRS() << "Bad memory allocation for buffer, size: " << size << LL_ENDL;
-                    }
-                    mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_ExtraParams, buffer, size, block_num);
-                    LLDataPackerBinaryBuffer dp(buffer, size);
-
-                    U8 num_parameters;
-                    dp.unpackU8(num_parameters, "num_params");
-                    U8 param_block[MAX_OBJECT_PARAMS_SIZE];
-                    for (U8 param=0; param<num_parameters; ++param)
-                    {
-                        U16 param_type;
-                        S32 param_size;
-                        dp.unpackU16(param_type, "param_type");
-                        dp.unpackBinaryData(param_block, param_size, "param_data");
-                        //LL_INFOS() << "Param type: " << param_type << ", Size: " << param_size << LL_ENDL;
-                        LLDataPackerBinaryBuffer dp2(param_block, param_size);
-                        unpackParameterEntry(param_type, &dp2);
-                    }
-                    delete[] buffer;
+                    LLDataPackerBinaryBuffer dp2(const_cast<U8*>(param.mData.data()), (S32)param.mData.size());
+                    unpackParameterEntry(param.mType, &dp2);
                 }
-
                 for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
                 {
                     if (!iter->second->in_use)
@@ -1614,7 +1534,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                         parameterChanged(iter->first, iter->second->data, false, false);
                     }
                 }
-
+                // </FS>
                 break;
             }
 
@@ -1724,17 +1644,27 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
     else
     {
         // handle the compressed case - have dp datapacker
-        LLUUID sound_uuid;
         LLUUID  owner_id;
-        F32    gain = 0;
-        U8     sound_flags = 0;
-        F32     cutoff = 0;
 
         U16 val[4];
 
         U8      state;
 
-        dp->unpackU8(state, "State");
+        // <FS> object update pipeline
+        //dp->unpackU8(state, "State");
+        if (full_update)
+        {
+            state = full_update->mState;
+        }
+        else if (terse_update)
+        {
+            state = terse_update->mState;
+        }
+        else
+        {
+            dp->unpackU8(state, "State");
+        }
+        // </FS>
         mAttachmentState = state;
 
         switch(update_type)
@@ -1744,6 +1674,23 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 #ifdef DEBUG_UPDATE_TYPE
                 LL_INFOS() << "CompTI:" << getID() << LL_ENDL;
 #endif
+                // <FS> object update pipeline: same as below, decoded on a worker
+                if (terse_update)
+                {
+                    if (terse_update->mHasFootPlane)
+                    {
+                        ((LLVOAvatar*)this)->setFootPlane(terse_update->mFootPlane);
+                    }
+                    test_pos_parent = getPosition();
+                    new_pos_parent = terse_update->mPosition;
+                    setVelocity(terse_update->mVelocity);
+                    setAcceleration(terse_update->mAcceleration);
+                    new_rot = terse_update->mRotation;
+                    new_angv = terse_update->mAngularVelocity;
+                    setAngularVelocity(new_angv);
+                    break;
+                }
+                // </FS>
                 U8      value;
                 dp->unpackU8(value, "agent");
                 if (value)
@@ -1797,11 +1744,11 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                     gFloaterTools->dirty();
                 }
 
-                dp->unpackU32(crc, "CRC");
+                // <FS> object update pipeline: decoded by LLObjectUpdatePacket
+                crc = full_update->mCRC;
                 mTotalCRC = crc;
-                dp->unpackU8(material, "Material");
-                U8 old_material = getMaterial();
-                if (old_material != material)
+                material = full_update->mMaterial;
+                if (getMaterial() != material)
                 {
                     setMaterial(material);
                     if (mDrawable.notNull())
@@ -1809,82 +1756,51 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                         gPipeline.markMoved(mDrawable, false); // undamped
                     }
                 }
-                dp->unpackU8(click_action, "ClickAction");
+                click_action = full_update->mClickAction;
                 setClickAction(click_action);
-                dp->unpackVector3(new_scale, "Scale");
-                dp->unpackVector3(new_pos_parent, "Pos");
-                LLVector3 vec;
-                dp->unpackVector3(vec, "Rot");
-                new_rot.unpackFromVector3(vec);
+                new_scale = full_update->mScale;
+                new_pos_parent = full_update->mPosition;
+                new_rot = full_update->mRotation;
                 setAcceleration(LLVector3::zero);
 
-                U32 value;
-                dp->unpackU32(value, "SpecialCode");
-                dp->setPassFlags(value);
-                dp->unpackUUID(owner_id, "Owner");
-
+                const U32 value = full_update->mSpecialCode;
+                owner_id = full_update->mOwnerID;
                 mOwnerID = owner_id;
 
                 if (value & 0x80)
                 {
-                    dp->unpackVector3(new_angv, "Omega");
+                    new_angv = full_update->mAngularVelocity;
                     setAngularVelocity(new_angv);
                 }
+                parent_id = full_update->mParentID;
 
-                if (value & 0x20)
+                delete [] mData;
+                mData = NULL;
+                if (full_update->mHasData)
                 {
-                    dp->unpackU32(parent_id, "ParentID");
-                }
-                else
-                {
-                    parent_id = 0;
-                }
-
-                S32 sp_size;
-                U32 size;
-                if (value & 0x2)
-                {
-                    sp_size = 1;
-                    delete [] mData;
-                    mData = new U8[1];
-                    dp->unpackU8(((U8*)mData)[0], "TreeData");
-                }
-                else if (value & 0x1)
-                {
-                    dp->unpackU32(size, "ScratchPadSize");
-                    delete [] mData;
-                    mData = new U8[size];
-                    dp->unpackBinaryData((U8 *)mData, sp_size, "PartData");
-                }
-                else
-                {
-                    mData = NULL;
-                }
-
-                // Setup object text
-                if (!mText && (value & 0x4))
-                {
-                    initHudText();
+                    mData = new U8[full_update->mData.size()];
+                    memcpy(mData, full_update->mData.data(), full_update->mData.size());
                 }
 
-                if (value & 0x4)
+                if (full_update->mHasText)
                 {
-                    std::string temp_string;
-                    dp->unpackString(temp_string, "Text");
+                    if (!mText)
+                    {
+                        initHudText();
+                    }
 
-                    LLColor4U coloru;
-                    dp->unpackBinaryDataFixed(coloru.mV, 4, "Color");
+                    LLColor4U coloru = full_update->mTextColor;
                     coloru.mV[3] = 255 - coloru.mV[3];
                     mText->setColor(LLColor4(coloru));
-                    mText->setString(temp_string);
+                    mText->setString(full_update->mText);
 // [RLVa:KB] - Checked: 2010-03-27 (RLVa-1.4.0a) | Added: RLVa-1.0.0f
                     if (RlvActions::isRlvEnabled())
                     {
-                        mText->setObjectText(temp_string);
+                        mText->setObjectText(full_update->mText);
                     }
 // [/RLVa:KB]
 
-                    mHudText = temp_string;
+                    mHudText = full_update->mText;
                     mHudTextColor = LLColor4(coloru);
 
                     setChanged(TEXTURE);
@@ -1899,47 +1815,27 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                     mHudText.clear();
                 }
 
-                std::string media_url;
-                if (value & 0x200)
-                {
-                    dp->unpackString(media_url, "MediaURL");
-                }
-                retval |= checkMediaURL(media_url);
+                retval |= checkMediaURL(full_update->mMediaURL);
 
-                //
-                // Unpack particle system data (legacy)
-                //
                 if (value & 0x8)
                 {
-                    unpackParticleSource(*dp, owner_id, true);
+                    unpackParticleSource(full_update->mParticles.get(), owner_id, false);
                 }
                 else if (!(value & 0x400))
                 {
                     deleteParticleSource();
                 }
 
-                // Mark all extra parameters not used
                 std::unordered_map<U16, ExtraParameter*>::iterator iter;
                 for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
                 {
                     iter->second->in_use = false;
                 }
-
-                // Unpack extra params
-                U8 num_parameters;
-                dp->unpackU8(num_parameters, "num_params");
-                U8 param_block[MAX_OBJECT_PARAMS_SIZE];
-                for (U8 param=0; param<num_parameters; ++param)
+                for (const LLObjectUpdatePacket::ExtraParam& param : full_update->mExtraParams)
                 {
-                    U16 param_type;
-                    S32 param_size;
-                    dp->unpackU16(param_type, "param_type");
-                    dp->unpackBinaryData(param_block, param_size, "param_data");
-                    //LL_INFOS() << "Param type: " << param_type << ", Size: " << param_size << LL_ENDL;
-                    LLDataPackerBinaryBuffer dp2(param_block, param_size);
-                    unpackParameterEntry(param_type, &dp2);
+                    LLDataPackerBinaryBuffer dp2(const_cast<U8*>(param.mData.data()), (S32)param.mData.size());
+                    unpackParameterEntry(param.mType, &dp2);
                 }
-
                 for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
                 {
                     if (!iter->second->in_use)
@@ -1949,37 +1845,23 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                     }
                 }
 
-                if (value & 0x10)
+                if (full_update->mHasNameValues)
                 {
-                    dp->unpackUUID(sound_uuid, "SoundUUID");
-                    dp->unpackF32(gain, "SoundGain");
-                    dp->unpackU8(sound_flags, "SoundFlags");
-                    dp->unpackF32(cutoff, "SoundRadius");
-                }
-
-                if (value & 0x100)
-                {
-                    std::string name_value_list;
-                    dp->unpackString(name_value_list, "NV");
-
-                    setNameValueList(name_value_list);
+                    setNameValueList(full_update->mNameValues);
                 }
 
-                mTotalCRC = crc;
-                mSoundCutOffRadius = cutoff;
-
-                setAttachedSound(sound_uuid, owner_id, gain, sound_flags);
+                mSoundCutOffRadius = full_update->mSoundRadius;
+                setAttachedSound(full_update->mSoundID, owner_id, full_update->mGain, full_update->mSoundFlags);
 
                 // only get these flags on updates from sim, not cached ones
                 // Preload these five flags for every object.
                 // Finer shades require the object to be selected, and the selection manager
                 // stores the extended permission info.
-                if(mesgsys != NULL)
+                if (mesgsys != NULL || packet)
                 {
-                U32 flags;
-                mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, block_num);
-                loadFlags(flags);
+                    loadFlags(full_update->mUpdateFlags);
                 }
+                // </FS>
             }
             break;
 
@@ -2302,9 +2184,14 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 
     new_rot.normQuat();
 
-    if (sPingInterpolate && mesgsys != NULL)
+    // <FS> object update pipeline
+    //if (sPingInterpolate && mesgsys != NULL)
+    //{
+    //    LLCircuitData *cdp = gMessageSystem->mCircuitInfo.findCircuit(mesgsys->getSender());
+    if (sPingInterpolate && (mesgsys != NULL || packet))
     {
-        LLCircuitData *cdp = gMessageSystem->mCircuitInfo.findCircuit(mesgsys->getSender());
+        LLCircuitData *cdp = gMessageSystem->mCircuitInfo.findCircuit(packet ? packet->getSender() : mesgsys->getSender());
+    // </FS>
         if (cdp)
         {
             // Note: delay is U32 and usually less then second,
@@ -2327,9 +2214,14 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 
     // If we're going to skip this message, why are we
     // doing all the parenting, etc above?
-    if(mesgsys != NULL)
+    // <FS> object update pipeline
+    //if(mesgsys != NULL)
+    //{
+    //U32 packet_id = mesgsys->getCurrentRecvPacketID();
+    if(mesgsys != NULL || packet)
     {
-    U32 packet_id = mesgsys->getCurrentRecvPacketID();
+    U32 packet_id = packet ? packet->getPacketID() : mesgsys->getCurrentRecvPacketID();
+    // </FS>
     if (packet_id < mLatestRecvPacketID &&
         mLatestRecvPacketID - packet_id < 65536)
     {
@@ -6433,7 +6325,8 @@ void LLViewerObject::setParticleSource(const LLPartSysData& particle_parameters,
     LLViewerPartSim::getInstance()->addPartSource(pss);
 }
 
-void LLViewerObject::unpackParticleSource(const S32 block_num, const LLUUID& owner_id)
+// <FS> object update pipeline
+void LLViewerObject::unpackParticleSource(const LLPartSysData* data, const LLUUID& owner_id, bool restart_on_age_change)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VIEWER;
     if (!mPartSourcep.isNull() && mPartSourcep->isDead())
@@ -6443,74 +6336,25 @@ void LLViewerObject::unpackParticleSource(const S32 block_num, const LLUUID& own
     if (mPartSourcep)
     {
         // If we've got one already, just update the existing source (or remove it)
-        if (!LLViewerPartSourceScript::unpackPSS(this, mPartSourcep, block_num))
+        if (!data)
         {
             mPartSourcep->setDead();
             mPartSourcep = NULL;
         }
-    }
-    else
-    {
-        LLPointer<LLViewerPartSourceScript> pss = LLViewerPartSourceScript::unpackPSS(this, NULL, block_num);
-        //If the owner is muted, don't create the system
-        if(LLMuteList::getInstance()->isMuted(owner_id, LLMute::flagParticles)) return;
-
-        // We need to be able to deal with a particle source that hasn't changed, but still got an update!
-        if (pss)
-        {
-//          LL_INFOS() << "Making particle system with owner " << owner_id << LL_ENDL;
-            pss->setOwnerUUID(owner_id);
-            mPartSourcep = pss;
-            LLViewerPartSim::getInstance()->addPartSource(pss);
-        }
-    }
-    if (mPartSourcep)
-    {
-        if (mPartSourcep->getImage()->getID() != mPartSourcep->mPartSysData.mPartImageID)
-        {
-            LLViewerTexture* image;
-            if (mPartSourcep->mPartSysData.mPartImageID == LLUUID::null)
-            {
-                image = LLViewerFetchedTexture::sDefaultParticleImagep;
-            }
-            else
-            {
-                image = LLViewerTextureManager::getFetchedTexture(mPartSourcep->mPartSysData.mPartImageID);
-            }
-            mPartSourcep->setImage(image);
-        }
-    }
-}
-
-void LLViewerObject::unpackParticleSource(LLDataPacker &dp, const LLUUID& owner_id, bool legacy)
-{
-    LL_PROFILE_ZONE_SCOPED_CATEGORY_VIEWER;
-    if (!mPartSourcep.isNull() && mPartSourcep->isDead())
-    {
-        mPartSourcep = NULL;
-    }
-    if (mPartSourcep)
-    {
-        // If we've got one already, just update the existing source (or remove it)
-        if (!LLViewerPartSourceScript::unpackPSS(this, mPartSourcep, dp, legacy))
+        else
         {
-            mPartSourcep->setDead();
-            mPartSourcep = NULL;
+            LLViewerPartSourceScript::unpackPSS(this, mPartSourcep, *data, restart_on_age_change);
         }
     }
-    else
+    else if (data)
     {
-        LLPointer<LLViewerPartSourceScript> pss = LLViewerPartSourceScript::unpackPSS(this, NULL, dp, legacy);
         //If the owner is muted, don't create the system
         if(LLMuteList::getInstance()->isMuted(owner_id, LLMute::flagParticles)) return;
-        // We need to be able to deal with a particle source that hasn't changed, but still got an update!
-        if (pss)
-        {
-//          LL_INFOS() << "Making particle system with owner " << owner_id << LL_ENDL;
-            pss->setOwnerUUID(owner_id);
-            mPartSourcep = pss;
-            LLViewerPartSim::getInstance()->addPartSource(pss);
-        }
+
+        LLPointer<LLViewerPartSourceScript> pss = LLViewerPartSourceScript::unpackPSS(this, NULL, *data, restart_on_age_change);
+        pss->setOwnerUUID(owner_id);
+        mPartSourcep = pss;
+        LLViewerPartSim::getInstance()->addPartSource(pss);
     }
     if (mPartSourcep)
     {
@@ -6529,6 +6373,7 @@ void LLViewerObject::unpackParticleSource(LLDataPacker &dp, const LLUUID& owner_
         }
     }
 }
+// </FS>
 
 void LLViewerObject::deleteParticleSource()
 {
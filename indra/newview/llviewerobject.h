@@ -34,6 +34,7 @@
 #include "llassetstorage.h"
 #include "llhudicon.h" // <FS:Ansariel> Changed to get the attached icon
 #include "llinventory.h"
+#include "llobjectupdatequeue.h" // <FS> object update pipeline
 #include "llrefcount.h"
 #include "llprimitive.h"
 #include "lluuid.h"
@@ -182,12 +183,16 @@ public:
     };
 
     static  U32     extractSpatialExtents(LLDataPackerBinaryBuffer *dp, LLVector3& pos, LLVector3& scale, LLQuaternion& rot);
+    // <FS> object update pipeline: packet is set for an update
+    // LLViewerObjectList queued, block_num is its block in there
     virtual U32     processUpdateMessage(LLMessageSystem *mesgsys,
                                         void **user_data,
                                         U32 block_num,
                                         const EObjectUpdateType update_type,
-                                        LLDataPacker *dp);
-
+                                        LLDataPacker *dp,
+                                        const LLObjectUpdatePacket* packet = NULL,
+                                        const LLObjectUpdatePacket::FullUpdate* full_update = NULL);
+    // </FS>
 
     virtual bool    isActive() const; // Whether this object needs to do an idleUpdate.
     bool            onActiveList() const                {return mOnActiveList;}
@@ -872,8 +877,9 @@ protected:
 
     bool isOnMap();
 
-    void unpackParticleSource(const S32 block_num, const LLUUID& owner_id);
-    void unpackParticleSource(LLDataPacker &dp, const LLUUID& owner_id, bool legacy);
+    // <FS> object update pipeline: null if the update has no particle system or it did not unpack
+    void unpackParticleSource(const LLPartSysData* data, const LLUUID& owner_id, bool restart_on_age_change);
+    // </FS>
     void deleteParticleSource();
     void setParticleSource(const LLPartSysData& particle_parameters, const LLUUID& owner_id);
 
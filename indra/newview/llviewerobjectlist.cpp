@@ -68,6 +68,7 @@
 #include "u64.h"
 #include "llviewertexturelist.h"
 #include "lldatapacker.h"
+#include "lldir.h" // <FS> object update pipeline
 #ifdef LL_USESYSTEMLIBS
 #include <zlib.h>
 #else
@@ -98,6 +99,7 @@ extern bool gAnimateTextures;
 #define MAX_CONCURRENT_PHYSICS_REQUESTS 256
 
 void dialog_refresh_all();
+void update_attached_sounds(); // <FS> object update pipeline
 
 // Global lists of objects - should go away soon.
 LLViewerObjectList gObjectList;
@@ -109,6 +111,10 @@ U32                     LLViewerObjectList::sSimulatorMachineIndex = 1; // Not z
 
 LLViewerObjectList::LLViewerObjectList()
     : mNewObjectSignal() // <FS:Ansariel> FIRE-16647: Default object properties randomly aren't applied
+    // <FS> object update pipeline: updates are decoded on the general pool
+    , mTerseUpdateQueue("General")
+    , mUpdateQueue("General")
+    // </FS>
 {
     mCurLazyUpdateIndex = 0;
     mCurBin = 0;
@@ -128,6 +134,7 @@ LLViewerObjectList::~LLViewerObjectList()
 void LLViewerObjectList::destroy()
 {
     killAllObjects();
+    mUpdateCapture.reset(); // <FS> object update pipeline
 
     resetObjectBeacons();
     mActiveObjects.clear();
@@ -242,9 +249,10 @@ void LLViewerObjectList::processUpdateCore(LLViewerObject* objectp,
                                            void** user_data,
                                            U32 i,
                                            const EObjectUpdateType update_type,
-                                           LLDataPacker* dpp,
+                                           LLDataPackerBinaryBuffer* dpp,
                                            bool just_created,
-                                           bool from_cache)
+                                           bool from_cache,
+                                           const LLObjectUpdatePacket* packet)
 {
     LLMessageSystem* msg = NULL;
 
@@ -257,7 +265,34 @@ void LLViewerObjectList::processUpdateCore(LLViewerObject* objectp,
     LL_DEBUGS("ObjectUpdate") << "uuid " << objectp->mID << " calling processUpdateMessage "
                               << objectp << " just_created " << just_created << " from_cache " << from_cache << " msg " << msg << LL_ENDL;
 
-    objectp->processUpdateMessage(msg, user_data, i, update_type, dpp);
+    // <FS> object update pipeline
+    // Full updates are decoded by LLObjectUpdatePacket however they came,
+    // queued, handled right away or from the region's cache
+    const LLObjectUpdatePacket::FullUpdate* full_update = NULL;
+    LLObjectUpdatePacket::FullUpdate decoded;
+    if (update_type != OUT_TERSE_IMPROVED)
+    {
+        full_update = packet ? packet->getFullUpdate(i) : NULL;
+        if (!full_update)
+        {
+            if (dpp)
+            {
+                LLObjectUpdatePacket::decodeCompressed(*dpp, objectp->getPCode(), decoded);
+                if (msg)
+                {
+                    msg->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, decoded.mUpdateFlags, i);
+                }
+            }
+            else if (msg)
+            {
+                LLObjectUpdatePacket::decodeMessageBlock(msg, i, decoded);
+            }
+            full_update = &decoded;
+        }
+    }
+
+    objectp->processUpdateMessage(msg, user_data, i, update_type, dpp, packet, full_update);
+    // </FS>
 
     if (objectp->isDead())
     {
@@ -333,7 +368,7 @@ LLViewerObject* LLViewerObjectList::processObjectUpdateFromCache(LLVOCacheEntry*
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
 
-    LLDataPacker *cached_dpp = entry->getDP();
+    LLDataPackerBinaryBuffer *cached_dpp = entry->getDP(); // <FS> object update pipeline
 
     if (!cached_dpp || gNonInteractive)
     {
@@ -755,9 +790,36 @@ void LLViewerObjectList::processCompressedObjectUpdate(LLMessageSystem *mesgsys,
                                              void **user_data,
                                              const EObjectUpdateType update_type)
 {
+    // <FS> object update pipeline
+    static LLCachedControl<bool> use_pipeline(gSavedSettings, "FSObjectUpdatePipeline");
+    if (use_pipeline)
+    {
+        queueObjectUpdate(mesgsys, update_type);
+        return;
+    }
+
+    // left over from before it was turned off
+    flushQueuedUpdates();
+    // </FS>
     processObjectUpdate(mesgsys, user_data, update_type, true);
 }
 
+// <FS> object update pipeline
+void LLViewerObjectList::processFullObjectUpdate(LLMessageSystem *mesgsys, void **user_data)
+{
+    static LLCachedControl<bool> use_pipeline(gSavedSettings, "FSObjectUpdatePipeline");
+    if (use_pipeline)
+    {
+        queueObjectUpdate(mesgsys, OUT_FULL);
+        return;
+    }
+
+    // left over from before it was turned off
+    flushQueuedUpdates();
+    processObjectUpdate(mesgsys, user_data, OUT_FULL);
+}
+// </FS>
+
 void LLViewerObjectList::processCachedObjectUpdate(LLMessageSystem *mesgsys,
                                              void **user_data,
                                              const EObjectUpdateType update_type)
@@ -805,6 +867,371 @@ void LLViewerObjectList::processCachedObjectUpdate(LLMessageSystem *mesgsys,
     return;
 }
 
+// <FS> object update pipeline
+void LLViewerObjectList::queueObjectUpdate(LLMessageSystem *mesgsys, const EObjectUpdateType update_type)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    const LLObjectUpdatePacket::EType type = update_type == OUT_TERSE_IMPROVED ? LLObjectUpdatePacket::TERSE
+        : (update_type == OUT_FULL ? LLObjectUpdatePacket::FULL : LLObjectUpdatePacket::COMPRESSED);
+    S32 num_objects = mesgsys->getNumberOfBlocksFast(_PREHASH_ObjectData);
+    gFullObjectUpdates += num_objects;
+
+    U64 region_handle;
+    U16 time_dilation;
+    mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+    mesgsys->getU16Fast(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation);
+
+    // The blocks are copied, the message system only holds this message
+    auto packet = std::make_shared<LLObjectUpdatePacket>(type, region_handle, time_dilation,
+                                                         mesgsys->getSender(), mesgsys->getCurrentRecvPacketID());
+    packet->reserve(num_objects, mesgsys->getReceiveSize());
+    if (type == LLObjectUpdatePacket::FULL)
+    {
+        for (S32 i = 0; i < num_objects; i++)
+        {
+            packet->addMessageBlock(mesgsys, i);
+        }
+    }
+    else
+    {
+        U8 data[LLObjectUpdatePacket::MAX_DATA_SIZE];
+        U8 texture_entry[LLObjectUpdatePacket::MAX_TEXTURE_ENTRY_SIZE];
+        for (S32 i = 0; i < num_objects; i++)
+        {
+            S32 data_size = llclamp(mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data), 0, (S32)LLObjectUpdatePacket::MAX_DATA_SIZE);
+            mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, data, 0, i, LLObjectUpdatePacket::MAX_DATA_SIZE);
+
+            U32 flags = 0;
+            S32 texture_entry_size = 0;
+            if (type == LLObjectUpdatePacket::TERSE)
+            {
+                texture_entry_size = llclamp(mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_TextureEntry), 0, (S32)LLObjectUpdatePacket::MAX_TEXTURE_ENTRY_SIZE);
+                if (texture_entry_size)
+                {
+                    mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_TextureEntry, texture_entry, 0, i, LLObjectUpdatePacket::MAX_TEXTURE_ENTRY_SIZE);
+                }
+            }
+            else
+            {
+                mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
+            }
+            packet->addBlock(data, data_size, flags, texture_entry, texture_entry_size);
+        }
+    }
+
+    static LLCachedControl<bool> capture(gSavedSettings, "FSObjectUpdateCapture");
+    if (capture)
+    {
+        if (!mUpdateCapture)
+        {
+            std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "object_updates.bin");
+            mUpdateCapture = std::make_unique<llofstream>(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+            LLObjectUpdatePacket::writeHeader(*mUpdateCapture);
+            mUpdateCaptureTimer.reset();
+            LL_INFOS("ObjectUpdate") << "Capturing object updates to " << filename << LL_ENDL;
+        }
+        packet->write(*mUpdateCapture, (U32)(mUpdateCaptureTimer.getElapsedTimeF32() * 1000.f));
+    }
+    else if (mUpdateCapture)
+    {
+        mUpdateCapture.reset();
+    }
+
+    if (type == LLObjectUpdatePacket::TERSE)
+    {
+        mTerseUpdateQueue.push(packet);
+    }
+    else
+    {
+        mUpdateQueue.push(packet);
+    }
+}
+
+void LLViewerObjectList::applyQueuedUpdates(F32 max_time)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    LLTimer timer;
+    // Avatars, vehicles and the agent move with terse updates, those are
+    // all applied right away. The full backlog gets what is left.
+    mUpdateQueue.dispatch();
+    if (!mTerseUpdateQueue.empty())
+    {
+        mTerseUpdateQueue.dispatch();
+        applyQueuedUpdatesUntil(mTerseUpdateQueue, mTerseUpdateQueue.getEndSequence());
+    }
+    if (!mUpdateQueue.empty())
+    {
+        applyQueuedUpdatesUntil(mUpdateQueue, mUpdateQueue.getEndSequence(), &timer, max_time);
+    }
+}
+
+void LLViewerObjectList::flushQueuedUpdates()
+{
+    if (!mTerseUpdateQueue.empty())
+    {
+        applyQueuedUpdatesUntil(mTerseUpdateQueue, mTerseUpdateQueue.getEndSequence());
+    }
+    if (!mUpdateQueue.empty())
+    {
+        applyQueuedUpdatesUntil(mUpdateQueue, mUpdateQueue.getEndSequence());
+    }
+}
+
+void LLViewerObjectList::flushQueuedUpdatesFor(LLMessageSystem *mesgsys, const char* block, const char* var)
+{
+    if (mTerseUpdateQueue.empty() && mUpdateQueue.empty())
+    {
+        return;
+    }
+
+    S32 num_blocks = mesgsys->getNumberOfBlocksFast(block);
+    for (S32 i = 0; i < num_blocks; i++)
+    {
+        U32 local_id;
+        mesgsys->getU32Fast(block, var, local_id, i);
+        applyPendingUpdates(mesgsys->getSender(), local_id);
+    }
+}
+
+void LLViewerObjectList::flushQueuedUpdatesForIDs(LLMessageSystem *mesgsys, const char* block, const char* var)
+{
+    if (mTerseUpdateQueue.empty() && mUpdateQueue.empty())
+    {
+        return;
+    }
+
+    S32 num_blocks = mesgsys->getNumberOfBlocksFast(block);
+    for (S32 i = 0; i < num_blocks; i++)
+    {
+        LLUUID id;
+        mesgsys->getUUIDFast(block, var, id, i);
+        if (id.isNull())
+        {
+            continue;
+        }
+
+        // A full update has the id, a terse one only has the local id of
+        // an object that exists already
+        U32 local_id = 0;
+        if (mUpdateQueue.getPendingSequence(mesgsys->getSender(), id, local_id))
+        {
+            applyPendingUpdates(mesgsys->getSender(), local_id);
+        }
+        else if (LLViewerObject* objectp = findObject(id))
+        {
+            applyPendingUpdates(mesgsys->getSender(), objectp->getLocalID());
+        }
+    }
+}
+
+void LLViewerObjectList::applyPendingUpdates(const LLHost& sender, U32 local_id)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    const S32 old_num_objects = mNumNewObjects;
+    auto apply_block = [this](const LLObjectUpdatePacket& packet, U32 index)
+        {
+            applyQueuedBlock(packet, index);
+        };
+    // a terse update comes after what created the object
+    U32 applied = mUpdateQueue.applyPending(sender, local_id, apply_block);
+    applied += mTerseUpdateQueue.applyPending(sender, local_id, apply_block);
+
+    if (applied)
+    {
+        LLVOAvatar::cullAvatarsByPixelArea();
+    }
+    if (old_num_objects != mNumNewObjects)
+    {
+        update_attached_sounds();
+    }
+}
+
+void LLViewerObjectList::applyQueuedUpdatesUntil(LLObjectUpdateQueue& queue, U32 sequence, const LLTimer* timer, F32 max_time)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    const S32 old_num_objects = mNumNewObjects;
+    U32 applied = queue.apply([this](const LLObjectUpdatePacket& packet, U32 index)
+        {
+            applyQueuedBlock(packet, index);
+        }, sequence, timer, max_time);
+
+    if (applied)
+    {
+        LLVOAvatar::cullAvatarsByPixelArea();
+    }
+    if (old_num_objects != mNumNewObjects)
+    {
+        update_attached_sounds();
+    }
+}
+
+// Same as processObjectUpdate(), with the header already decoded and the
+// rest of the block decoded on the pool
+void LLViewerObjectList::applyQueuedBlock(const LLObjectUpdatePacket& packet, U32 index)
+{
+    const LLObjectUpdatePacket::Block& block = packet.getBlock(index);
+    LLViewerStatsRecorder& recorder = LLViewerStatsRecorder::instance();
+    const LLObjectUpdatePacket::EType type = packet.getType();
+    const EObjectUpdateType update_type = type == LLObjectUpdatePacket::TERSE ? OUT_TERSE_IMPROVED
+        : (type == LLObjectUpdatePacket::FULL ? OUT_FULL : OUT_FULL_COMPRESSED);
+    const LLHost& sender = packet.getSender();
+    const U32 local_id = block.mLocalID;
+    LLUUID fullid = block.mFullID;
+
+    if (type == LLObjectUpdatePacket::TERSE)
+    {
+        // A full update still queued for the object may be what creates
+        // it. One that came later is dropped by the packet id check once
+        // the terse update has been applied.
+        mUpdateQueue.applyPending(sender, local_id, [this](const LLObjectUpdatePacket& full_packet, U32 full_index)
+            {
+                applyQueuedBlock(full_packet, full_index);
+            });
+    }
+
+    LLViewerRegion* regionp = LLWorld::getInstance()->getRegionFromHandle(packet.getRegionHandle());
+    if (!regionp)
+    {
+        LL_WARNS() << "Object update from unknown region! " << packet.getRegionHandle() << LL_ENDL;
+        return;
+    }
+
+    switch (block.mAction)
+    {
+    case LLObjectUpdatePacket::NO_PCODE:
+        // object creation will fail, LLViewerObject::createObject()
+        LL_WARNS() << "Received object " << fullid
+            << " with 0 PCode. Local id: " << local_id
+            << " Flags: " << block.mUpdateFlags
+            << " Region: " << regionp->getName()
+            << " Region id: " << regionp->getRegionID() << LL_ENDL;
+        recorder.objectUpdateFailure();
+        return;
+    case LLObjectUpdatePacket::BAD:
+        LL_WARNS() << "Object update block of " << block.mDataSize << " bytes too short, local id " << local_id << LL_ENDL;
+        recorder.objectUpdateFailure();
+        return;
+    case LLObjectUpdatePacket::CACHE:
+        {
+            //send to object cache
+            U8 cache_dpbuffer[LLObjectUpdatePacket::MAX_DATA_SIZE];
+            memcpy(cache_dpbuffer, packet.getData(block), block.mDataSize);
+            LLDataPackerBinaryBuffer cache_dp(cache_dpbuffer, block.mDataSize);
+            cache_dp.shift(LLObjectUpdatePacket::FULL_HEADER_SIZE);
+            regionp->cacheFullUpdate(cache_dp, block.mUpdateFlags);
+        }
+        return;
+    default:
+        break;
+    }
+
+    LLViewerObject *objectp;
+    if (type == LLObjectUpdatePacket::TERSE)
+    {
+        getUUIDFromLocal(fullid, local_id, sender.getAddress(), sender.getPort());
+        if (fullid.isNull())
+        {
+            LL_DEBUGS() << "update for unknown localid " << local_id << " host " << sender << LL_ENDL;
+            mNumUnknownUpdates++;
+        }
+        //update object cache if the object receives a full-update or terse update
+        objectp = regionp->updateCacheEntry(local_id, findObject(fullid));
+    }
+    else if (type == LLObjectUpdatePacket::FULL)
+    {
+        objectp = regionp->updateCacheEntry(local_id, findObject(fullid));
+    }
+    else
+    {
+        objectp = findObject(fullid);
+    }
+
+    // Reset object local id and region pointer if things have changed
+    if (objectp &&
+        ((objectp->mLocalID != local_id) ||
+         (objectp->getRegion() != regionp)))
+    {
+        removeFromLocalIDTable(objectp);
+        setUUIDAndLocal(fullid, local_id, sender.getAddress(), sender.getPort(), objectp);
+
+        if (objectp->mLocalID != local_id)
+        {   // Update local ID in object with the one sent from the region
+            objectp->mLocalID = local_id;
+        }
+
+        if (objectp->getRegion() != regionp)
+        {   // Object changed region, so update it
+            objectp->updateRegion(regionp); // for LLVOAvatar
+        }
+    }
+
+    bool just_created = false;
+    if (!objectp)
+    {
+        if (type == LLObjectUpdatePacket::TERSE)
+        {
+            recorder.objectUpdateFailure();
+            return;
+        }
+
+        const LLPCode pcode = block.mPCode;
+        if (FSAssetBlacklist::getInstance()->isBlacklisted(fullid, (pcode == LL_PCODE_LEGACY_AVATAR ? LLAssetType::AT_PERSON : LLAssetType::AT_OBJECT)))
+        {
+            LL_INFOS() << "Blacklisted " << (pcode == LL_PCODE_LEGACY_AVATAR ? "avatar" : "object") << " blocked." << LL_ENDL;
+            return;
+        }
+
+        // <FS:Ansariel> FIRE-20288: Option to render friends only
+        if (isNonFriendDerendered(fullid, pcode))
+        {
+            LL_INFOS() << "Not rendering avatar " << fullid.asString() << " because it is not on the friend list" << LL_ENDL;
+            return;
+        }
+        // </FS:Ansariel>
+
+        objectp = createObject(pcode, regionp, fullid, local_id, sender);
+        if (!objectp)
+        {
+            LL_INFOS() << "createObject failure for object: " << fullid << LL_ENDL;
+            recorder.objectUpdateFailure();
+            return;
+        }
+
+        just_created = true;
+        mNumNewObjects++;
+    }
+
+    if (type != LLObjectUpdatePacket::TERSE)
+    {
+        objectp->mLocalID = local_id;
+    }
+
+    // No message to read from, LLViewerObject::processUpdateMessage()
+    // takes the decoded block from the packet. The data packer is for
+    // terse blocks too short to decode, full ones always decode.
+    if (type == LLObjectUpdatePacket::TERSE)
+    {
+        U8 compressed_dpbuffer[LLObjectUpdatePacket::MAX_DATA_SIZE];
+        memcpy(compressed_dpbuffer, packet.getData(block), block.mDataSize);
+        LLDataPackerBinaryBuffer compressed_dp(compressed_dpbuffer, block.mDataSize);
+        // processUpdateMessage() reads on from after the header
+        compressed_dp.shift(LLObjectUpdatePacket::TERSE_HEADER_SIZE);
+        processUpdateCore(objectp, NULL, index, update_type, &compressed_dp, just_created, true, &packet);
+    }
+    else
+    {
+        processUpdateCore(objectp, NULL, index, update_type, NULL, just_created, true, &packet);
+    }
+
+    recorder.objectUpdateEvent(update_type);
+    objectp->setLastUpdateType(update_type);
+}
+// </FS>
+
 void LLViewerObjectList::dirtyAllObjectInventory()
 {
     for (vobj_list_t::iterator iter = mObjects.begin(); iter != mObjects.end(); ++iter)
@@ -1069,6 +1496,10 @@ void LLViewerObjectList::update(LLAgent &agent)
 
     std::vector<LLViewerObject*>::iterator idle_end = idle_list.begin()+idle_count;
 
+    // avatars leave blending their poses to the end of the idle loop, where
+    // it is spread across threads
+    LLVOAvatar::startSkeletonBatch();
+
     // <FS:Ansariel> Speed up debug settings
     //if (gSavedSettings.getBOOL("FreezeTime"))
     if (freezeTime)
@@ -1084,6 +1515,7 @@ void LLViewerObjectList::update(LLAgent &agent)
                 objectp->idleUpdate(agent, frame_time);
             }
         }
+        LLVOAvatar::finishSkeletonBatch();
     }
     else
     {
@@ -1094,6 +1526,7 @@ void LLViewerObjectList::update(LLAgent &agent)
             llassert(objectp->isActive());
                 objectp->idleUpdate(agent, frame_time);
         }
+        LLVOAvatar::finishSkeletonBatch();
 
         //update flexible objects
         LLVolumeImplFlexible::updateClass();
@@ -1628,6 +2061,8 @@ void LLViewerObjectList::killAllObjects()
     // Used only on global destruction.
 
     // Mass cleanup to not clear lists one item at a time
+    mTerseUpdateQueue.clear(); // <FS> object update pipeline
+    mUpdateQueue.clear(); // <FS> object update pipeline
     mIndexAndLocalIDToUUID.clear();
     mActiveObjects.clear();
     mMapObjects.clear();
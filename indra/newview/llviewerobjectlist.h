@@ -28,13 +28,17 @@
 #define LL_LLVIEWEROBJECTLIST_H
 
 #include <map>
+#include <memory>
 #include <set>
 
 // common includes
+#include "llfile.h" // <FS> object update pipeline
+#include "llframetimer.h" // <FS> object update pipeline
 #include "llstring.h"
 #include "lltrace.h"
 
 // project includes
+#include "llobjectupdatequeue.h" // <FS> object update pipeline
 #include "llviewerobject.h"
 #include "lleventcoro.h"
 #include "llcoros.h"
@@ -84,11 +88,27 @@ public:
 
     // Simulator and viewer side object updates...
     void processUpdateCore(LLViewerObject* objectp, void** data, U32 block, const EObjectUpdateType update_type,
-                           LLDataPacker* dpp, bool justCreated, bool from_cache = false);
+                           LLDataPackerBinaryBuffer* dpp, bool justCreated, bool from_cache = false,
+                           const LLObjectUpdatePacket* packet = NULL); // <FS> object update pipeline
     LLViewerObject* processObjectUpdateFromCache(LLVOCacheEntry* entry, LLViewerRegion* regionp);
     void processObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type, bool compressed=false);
     void processCompressedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
     void processCachedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
+
+    // <FS> Full, compressed and terse updates are queued when
+    // FSObjectUpdatePipeline is on. Once per frame all queued terse updates
+    // are applied, then full and compressed ones for at most max_time
+    // seconds.
+    void processFullObjectUpdate(LLMessageSystem *mesgsys, void **user_data);
+    void queueObjectUpdate(LLMessageSystem *mesgsys, EObjectUpdateType update_type);
+    void applyQueuedUpdates(F32 max_time);
+    void flushQueuedUpdates();
+    // For a message handled right away, applies what is queued for the
+    // objects it names, by local id or by id, in each of its blocks
+    void flushQueuedUpdatesFor(LLMessageSystem *mesgsys, const char* block, const char* var);
+    void flushQueuedUpdatesForIDs(LLMessageSystem *mesgsys, const char* block, const char* var);
+    U32 getQueuedUpdateCount() const { return mTerseUpdateQueue.size() + mUpdateQueue.size(); }
+    // </FS>
     // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
     //void updateApparentAngles(LLAgent &agent);
     // Added time limit on processing of objects as they affect the texture system
@@ -253,6 +273,22 @@ private:
     static void reportPhysicsFlagFailure(LLSD &obejectList);
     void fetchPhisicsFlagsCoro(std::string url);
 
+    // <FS> object update pipeline
+    void applyQueuedBlock(const LLObjectUpdatePacket& packet, U32 index);
+    // what is queued for one object, ahead of everything else
+    void applyPendingUpdates(const LLHost& sender, U32 local_id);
+    // packets queued before sequence, with a timer only for max_time seconds
+    void applyQueuedUpdatesUntil(LLObjectUpdateQueue& queue, U32 sequence, const LLTimer* timer = NULL, F32 max_time = 0.f);
+
+    // Terse updates move avatars, vehicles and the agent, they must not
+    // wait behind a region's worth of compressed ones
+    LLObjectUpdateQueue mTerseUpdateQueue;
+    LLObjectUpdateQueue mUpdateQueue;
+    std::unique_ptr<llofstream> mUpdateCapture;
+    // frame time, packets handled in the same frame share a timestamp
+    LLFrameTimer mUpdateCaptureTimer;
+    // </FS>
+
     // <FS:Ansariel> FIRE-20288: Option to render friends only
     bool isNonFriendDerendered(const LLUUID& id, LLPCode pcode);
 
@@ -441,112 +441,31 @@ void LLViewerPartSourceScript::update(const F32 dt)
     }
 }
 
+// <FS> object update pipeline
 // static
-LLPointer<LLViewerPartSourceScript> LLViewerPartSourceScript::unpackPSS(LLViewerObject *source_objp, LLPointer<LLViewerPartSourceScript> pssp, const S32 block_num)
+LLPointer<LLViewerPartSourceScript> LLViewerPartSourceScript::unpackPSS(LLViewerObject *source_objp, LLPointer<LLViewerPartSourceScript> pssp, const LLPartSysData& data, bool restart_on_age_change)
 {
     if (!pssp)
     {
-        if (LLPartSysData::isNullPS(block_num))
-        {
-            return NULL;
-        }
-        LLPointer<LLViewerPartSourceScript> new_pssp = new LLViewerPartSourceScript(source_objp);
-        if (!new_pssp->mPartSysData.unpackBlock(block_num))
-        {
-            return NULL;
-        }
-        if (new_pssp->mPartSysData.mTargetUUID.notNull())
-        {
-            LLViewerObject *target_objp = gObjectList.findObject(new_pssp->mPartSysData.mTargetUUID);
-            new_pssp->setTargetObject(target_objp);
-        }
-        return new_pssp;
+        pssp = new LLViewerPartSourceScript(source_objp);
     }
-    else
+    else if (restart_on_age_change && data.mMaxAge
+             && (pssp->mPartSysData.mMaxAge != data.mMaxAge || pssp->mPartSysData.mStartAge != data.mStartAge))
     {
-        if (LLPartSysData::isNullPS(block_num))
-        {
-            return NULL;
-        }
-
-        F32 prev_max_age = pssp->mPartSysData.mMaxAge;
-        F32 prev_start_age = pssp->mPartSysData.mStartAge;
-        if (!pssp->mPartSysData.unpackBlock(block_num))
-        {
-            return NULL;
-        }
-        else if (pssp->mPartSysData.mMaxAge
-                 && (prev_max_age != pssp->mPartSysData.mMaxAge || prev_start_age != pssp->mPartSysData.mStartAge))
-        {
-            // reusing existing pss, so reset time to allow particles to start again
-            pssp->mLastUpdateTime = 0.f;
-            pssp->mLastPartTime = 0.f;
-        }
-
-        if (pssp->mPartSysData.mTargetUUID.notNull())
-        {
-            LLViewerObject *target_objp = gObjectList.findObject(pssp->mPartSysData.mTargetUUID);
-            pssp->setTargetObject(target_objp);
-        }
-        return pssp;
+        // reusing existing pss, so reset time to allow particles to start again
+        pssp->mLastUpdateTime = 0.f;
+        pssp->mLastPartTime = 0.f;
     }
-}
-
-
-LLPointer<LLViewerPartSourceScript> LLViewerPartSourceScript::unpackPSS(LLViewerObject *source_objp, LLPointer<LLViewerPartSourceScript> pssp, LLDataPacker &dp, bool legacy)
-{
-    if (!pssp)
-    {
-        LLPointer<LLViewerPartSourceScript> new_pssp = new LLViewerPartSourceScript(source_objp);
-        if (legacy)
-        {
-            if (!new_pssp->mPartSysData.unpackLegacy(dp))
-            {
-                return NULL;
-            }
-        }
-        else
-        {
-            if (!new_pssp->mPartSysData.unpack(dp))
-            {
-                return NULL;
-            }
-        }
+    pssp->mPartSysData = data;
 
-        if (new_pssp->mPartSysData.mTargetUUID.notNull())
-        {
-            LLViewerObject *target_objp = gObjectList.findObject(new_pssp->mPartSysData.mTargetUUID);
-            new_pssp->setTargetObject(target_objp);
-        }
-
-        return new_pssp;
-    }
-    else
+    if (pssp->mPartSysData.mTargetUUID.notNull())
     {
-        if (legacy)
-        {
-            if (!pssp->mPartSysData.unpackLegacy(dp))
-            {
-                return NULL;
-            }
-        }
-        else
-        {
-            if (!pssp->mPartSysData.unpack(dp))
-            {
-                return NULL;
-            }
-        }
-
-        if (pssp->mPartSysData.mTargetUUID.notNull())
-        {
-            LLViewerObject *target_objp = gObjectList.findObject(pssp->mPartSysData.mTargetUUID);
-            pssp->setTargetObject(target_objp);
-        }
-        return pssp;
+        LLViewerObject *target_objp = gObjectList.findObject(pssp->mPartSysData.mTargetUUID);
+        pssp->setTargetObject(target_objp);
     }
+    return pssp;
 }
-
+// </FS>
 
 /* static */
 LLPointer<LLViewerPartSourceScript> LLViewerPartSourceScript::createPSS(LLViewerObject *source_objp, const LLPartSysData& particle_parameters)
@@ -115,8 +115,9 @@ public:
     bool updateFromMesg();
 
     // Returns a new particle source to attach to an object...
-    static LLPointer<LLViewerPartSourceScript> unpackPSS(LLViewerObject *source_objp, LLPointer<LLViewerPartSourceScript> pssp, const S32 block_num);
-    static LLPointer<LLViewerPartSourceScript> unpackPSS(LLViewerObject *source_objp, LLPointer<LLViewerPartSourceScript> pssp, LLDataPacker &dp, bool legacy);
+    // <FS> object update pipeline: from data decoded by LLObjectUpdatePacket
+    static LLPointer<LLViewerPartSourceScript> unpackPSS(LLViewerObject *source_objp, LLPointer<LLViewerPartSourceScript> pssp, const LLPartSysData& data, bool restart_on_age_change);
+    // </FS>
     static LLPointer<LLViewerPartSourceScript> createPSS(LLViewerObject *source_objp, const LLPartSysData& particle_parameters);
 
     LLViewerTexture *getImage() const               { return mImagep; }
@@ -139,7 +139,8 @@ LLTrace::CountStatHandle<>  FPS("FPS", "Frames rendered"),
                             KILLED("killed", "Number of times killed"),
                             TEX_BAKES("texbakes", "Number of times avatar textures have been baked"),
                             TEX_REBAKES("texrebakes", "Number of times avatar textures have been forced to rebake"),
-                            NUM_NEW_OBJECTS("numnewobjectsstat", "Number of objects in scene that were not previously in cache");
+                            NUM_NEW_OBJECTS("numnewobjectsstat", "Number of objects in scene that were not previously in cache"),
+                            GEOMETRY_FACES_BUILT("geometryfacesbuilt", "Faces whose vertex data was packed by the geometry build batch");
 
 LLTrace::CountStatHandle<LLUnit<F64, LLUnits::Kilotriangles> >
                             TRIANGLES_DRAWN("trianglesdrawnstat");
@@ -238,7 +239,8 @@ LLTrace::EventStatHandle<F64Milliseconds >  REGION_CROSSING_TIME("regioncrossing
                                                                 NETWORK_STACKTIME("networkstacktime", "NETWORK_SECS"),
                                                                 IMAGE_STACKTIME("imagestacktime", "IMAGE_SECS"),
                                                                 REBUILD_STACKTIME("rebuildstacktime", "REBUILD_SECS"),
-                                                                RENDER_STACKTIME("renderstacktime", "RENDER_SECS");
+                                                                RENDER_STACKTIME("renderstacktime", "RENDER_SECS"),
+                                                                GEOMETRY_BUILD_TIME("geometrybuildtime", "Time to pack one geometry build batch");
 
 LLTrace::EventStatHandle<F64Seconds >   AVATAR_EDIT_TIME("avataredittime", "Seconds in Edit Appearance"),
                                                             TOOLBOX_TIME("toolboxtime", "Seconds using Toolbox"),
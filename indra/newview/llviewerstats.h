@@ -137,7 +137,8 @@ extern LLTrace::CountStatHandle<>           FPS,
                                             KILLED,
                                             TEX_BAKES,
                                             TEX_REBAKES,
-                                            NUM_NEW_OBJECTS;
+                                            NUM_NEW_OBJECTS,
+                                            GEOMETRY_FACES_BUILT;
 
 extern LLTrace::CountStatHandle<LLUnit<F64, LLUnits::Kilotriangles> > TRIANGLES_DRAWN;
 
@@ -226,7 +227,8 @@ extern LLTrace::EventStatHandle<F64Milliseconds >   REGION_CROSSING_TIME,
                                                         NETWORK_STACKTIME,
                                                         IMAGE_STACKTIME,
                                                         REBUILD_STACKTIME,
-                                                        RENDER_STACKTIME;
+                                                        RENDER_STACKTIME,
+                                                        GEOMETRY_BUILD_TIME;
 
 extern LLTrace::EventStatHandle<F64Seconds >    AVATAR_EDIT_TIME,
                                                                 TOOLBOX_TIME,
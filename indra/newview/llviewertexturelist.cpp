@@ -1088,238 +1088,153 @@ void LLViewerTextureList::updateImageDecodePriority(LLViewerFetchedTexture* imag
 {
     llassert(!gCubeSnapshot);
 
-    constexpr F32 BIAS_TRS_OUT_OF_SCREEN = 1.5f;
-    constexpr F32 BIAS_TRS_ON_SCREEN = 1.f;
+    // a batch of one, see updateImagesFetchTextures() for the batched version
+    LLTexturePriorityBatch& batch = mPriorityBatch;
+    batch.clear();
+    S32 index = gatherImageDecodePriority(batch, imagep);
+    if (index >= 0)
+    {
+        static LLCachedControl<F32> texture_camera_boost(gSavedSettings, "TextureCameraBoost", 7.f);
+        batch.evaluate(texture_camera_boost);
+        applyImageDecodePriority(imagep, batch.getResult(index));
+    }
 
-    if (imagep->getBoostLevel() < LLViewerFetchedTexture::BOOST_HIGH)  // don't bother checking face list for boosted textures
+    updateImageDecodeState(imagep, flush_images);
+}
+
+S32 LLViewerTextureList::gatherImageDecodePriority(LLTexturePriorityBatch& batch, LLViewerFetchedTexture* imagep)
+{
+    if (imagep->getBoostLevel() >= LLViewerFetchedTexture::BOOST_HIGH)  // don't bother checking face list for boosted textures
     {
-        static LLCachedControl<F32> texture_scale_min(gSavedSettings, "TextureScaleMinAreaFactor", 0.0095f);
-        static LLCachedControl<F32> texture_scale_max(gSavedSettings, "TextureScaleMaxAreaFactor", 25.f);
+        return -1;
+    }
 
-        F32 max_vsize = 0.f;
-        bool on_screen = false;
+    // get adjusted bias based on image resolution
+    LLImageGL* img = imagep->getGLTexture();
+    F32 max_discard = F32(img ? img->getMaxDiscardLevel() : MAX_DISCARD_LEVEL);
+    F32 bias = llclamp(max_discard - 2.f, 1.f, LLViewerTexture::sDesiredDiscardBias);
 
-        U32 face_count = 0;
+    // convert bias into a vsize scaler
+    // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
+    //bias = (F32) llroundf(powf(4, bias - 1.f));
+    // Pre-divide the bias so you can just use multiply in the loop
+    bias = (F32) 1.0f / llroundf(powf(4, bias - 1.f));
+    // </FS:minerjr> [FIRE-35081]
 
-        // get adjusted bias based on image resolution
-        LLImageGL* img = imagep->getGLTexture();
-        F32 max_discard = F32(img ? img->getMaxDiscardLevel() : MAX_DISCARD_LEVEL);
-        F32 bias = llclamp(max_discard - 2.f, 1.f, LLViewerTexture::sDesiredDiscardBias);
+    // If the texture is animated, then set the boost level to high, so that it will ways be the best quality
+    S32 index = batch.addTexture(bias, imagep->hasParcelMedia());
 
-        // convert bias into a vsize scaler
-        // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
-        //bias = (F32) llroundf(powf(4, bias - 1.f));
-        // Pre-divide the bias so you can just use multiply in the loop
-        bias = (F32) 1.0f / llroundf(powf(4, bias - 1.f));
-
-        // Apply new rules to bias discard, there are now 2 bias, off-screen and on-screen.
-        // On-screen Bias
-        // Only applied to LOD Textures and one that have Discard > 1 (0, 1 protected)
-        // 
-        // Off-screen Bias
-        // Will be using the old method of applying the mMaxVirtualSize, however
-        // only on LOD textures and fetched textures get bias applied.
-        // 
-        // Local (UI & Icons), Media and Dynamic textures should not have any discard applied to them.
-        // 
-        // Without this, textures will become blurry that are on screen, which is one of the #1
-        // user complaints.
-
-        // Store a seperate max on screen vsize without bias applied.
-        F32 max_on_screen_vsize = 0.0f;
-        S32 on_screen_count = 0;
-        // Moved all the variables outside of the loop
-        bool current_on_screen = false;
-        F32 vsize = 0.0f; // Moved outside the loop to save reallocation every loop
-        F32 important_to_camera = 0.0f;
-        F32 close_to_camera = 0.0f; // Track if the texture is close to the cameras
-        F64 animated = 0; // U64 used to track if a pointer is set for the animations. (The texture matrix of the face is null if no animation assigned to the texture)
-                           // So if you keep adding and the final result is 0, there is no animation
-        // </FS:minerjr> [FIRE-35081]
-        // boost resolution of textures that are important to the camera
-        // Can instead of using max for a min of 1.0, just subtract 1 from the boost and just do a 1 + (TextureCameraBoost - 1) * importanceToCamera)
-        static LLCachedControl<F32> texture_camera_boost(gSavedSettings, "TextureCameraBoost", 7.f);
-        LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-        for (U32 i = 0; i < LLRender::NUM_TEXTURE_CHANNELS; ++i)
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    for (U32 i = 0; i < LLRender::NUM_TEXTURE_CHANNELS; ++i)
+    {
+        for (S32 fi = 0; fi < imagep->getNumFaces(i); ++fi)
         {
-            for (S32 fi = 0; fi < imagep->getNumFaces(i); ++fi)
-            {
-                LLFace* face = (*(imagep->getFaceList(i)))[fi];
+            LLFace* face = (*(imagep->getFaceList(i)))[fi];
 
-                if (face && face->getViewerObject())
-                {
-                    ++face_count;
-                    // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
-                    // No longer needed as we no longer re-calculate the face's virtual texture size, we use it directly from the face
-                    //F32 radius;
-                    //F32 cos_angle_to_view_dir;
-                    // </FS:minerjr> [FIRE-35081]
+            if (face && face->getViewerObject())
+            {
+                if ((gFrameCount - face->mLastTextureUpdate) > 10)
+                { // only call calcPixelArea at most once every 10 frames for a given face
+                    // this helps eliminate redundant calls to calcPixelArea for faces that have multiple textures
+                    // assigned to them, such as is the case with GLTF materials or Blinn-Phong materials
 
-                    if ((gFrameCount - face->mLastTextureUpdate) > 10)
-                    { // only call calcPixelArea at most once every 10 frames for a given face
-                        // this helps eliminate redundant calls to calcPixelArea for faces that have multiple textures
-                        // assigned to them, such as is the case with GLTF materials or Blinn-Phong materials
-
-                        //face->calcPixelArea(cos_angle_to_view_dir, radius);
-                        // The face already has a function to calculate the Texture Virtual Size, which already calls the calcPixelArea method
-                        // so just call this instead. This can be called from outside this loop by LLVolume objects
-                        face->getTextureVirtualSize();
-                        face->mLastTextureUpdate = gFrameCount;
-                    }
-                                        
-                    // Also moved allocation outside the loop
                     // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
-                    //F32 vsize = face->getPixelArea();
-
-                    //on_screen |= face->mInFrustum;
-                    // Get the already calculated face's virtual size, instead of re-calculating it
-                    vsize = face->getVirtualSize();
-                    
-                    current_on_screen = face->mInFrustum; // Create a new var to store the current on screen status                    
-                    on_screen_count += current_on_screen; // Count the number of on sceen faces instead of using brach
-                    important_to_camera = face->mImportanceToCamera; // Store so we don't have to do 2 indirects later on
-                    // If the face/texture is animated, then set the boost level to high, so that it will ways be the best quality
-                    animated += S64(face->mTextureMatrix);
-                    animated += S64(face->hasMedia()); // Add has media for both local and parcel media
-                    animated += S64(imagep->hasParcelMedia());
-
-                    // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings (It is)
-                    /*
-                    // Scale desired texture resolution higher or lower depending on texture scale
-                    //
-                    // Minimum usage examples: a 1024x1024 texture with aplhabet (texture atlas),
-                    // runing string shows one letter at a time. If texture has ten 100px symbols
-                    // per side, minimal scale is (100/1024)^2 = 0.0095
-                    //
-                    // Maximum usage examples: huge chunk of terrain repeats texture
-                    // TODO: make this work with the GLTF texture transforms
-
-                    S32 te_offset = face->getTEOffset();  // offset is -1 if not inited
-                    LLViewerObject* objp = face->getViewerObject();
-                    const LLTextureEntry* te = (te_offset < 0 || te_offset >= objp->getNumTEs()) ? nullptr : objp->getTE(te_offset);
-                    F32 min_scale = te ? llmin(fabsf(te->getScaleS()), fabsf(te->getScaleT())) : 1.f;
-                    min_scale = llclamp(min_scale * min_scale, texture_scale_min(), texture_scale_max());
-                    vsize /= min_scale;
-
-                    // apply bias to offscreen faces all the time, but only to onscreen faces when bias is large
-                    // use mImportanceToCamera to make bias switch a bit more gradual
-                    if (!face->mInFrustum || LLViewerTexture::sDesiredDiscardBias > 1.9f + face->mImportanceToCamera / 2.f)
-                    {
-                        vsize /= bias;
-                    }
-
-                    // boost resolution of textures that are important to the camera
-                    if (face->mInFrustum)
-                    {
-                        static LLCachedControl<F32> texture_camera_boost(gSavedSettings, "TextureCameraBoost", 8.f);
-                        vsize *= llmax(face->mImportanceToCamera*texture_camera_boost, 1.f);
-                    }
-
-                    max_vsize = llmax(max_vsize, vsize);
-
-                    // addTextureStats limits size to sMaxVirtualSize
-                    if (max_vsize >= LLViewerFetchedTexture::sMaxVirtualSize
-                        && (on_screen || LLViewerTexture::sDesiredDiscardBias <= BIAS_TRS_ON_SCREEN))
-                    {
-                        break;
-                    }
-                    */
-
-                    // Use math to skip having to use a conditaional check
-                    // Bools are stored as 0 false, 1 true, use to cheat
-                    // Lerp instead of doing conditional input
-                    // If the image is import to the camera, even a little then make the on screen true                    
-                    on_screen_count += S32(important_to_camera * 1000.0f);
-                    //vsize = vsize + (vsize * (1.0f + important_to_camera * texture_camera_boost) - vsize) * F32(current_on_screen);
-                    // Apply boost of size based upon importance to camera
-                    vsize = vsize + (vsize * important_to_camera * texture_camera_boost);
-                    // Apply second boost based upon if the texture is close to the camera (< 16.1 meters * draw distance multiplier)
-                    vsize = vsize + (vsize * face->mCloseToCamera * texture_camera_boost);
-                    // Update the max on screen vsize based upon the on screen vsize
-                    close_to_camera += face->mCloseToCamera;
-                    // LL_DEBUGS() << face->getViewerObject()->getID() << " TID " << imagep->getID() << " #F " << imagep->getNumFaces(i) << " OS Vsize: " << vsize << " Vsize: " << (vsize * bias) << " CTC: " << face->mCloseToCamera << " Channel " << i << " Face Index " << fi << LL_ENDL;
-                    max_on_screen_vsize = llmax(max_on_screen_vsize, vsize);
-                    max_vsize = llmax(max_vsize, vsize * bias);
+                    // The face already has a function to calculate the Texture Virtual Size, which already calls the calcPixelArea method
+                    // so just call this instead. This can be called from outside this loop by LLVolume objects
+                    face->getTextureVirtualSize();
                     // </FS:minerjr> [FIRE-35081]
+                    face->mLastTextureUpdate = gFrameCount;
                 }
-            }
 
-            // <FS> [FIRE-35081] Blurry prims not changing with graphics settings
-            //if (max_vsize >= LLViewerFetchedTexture::sMaxVirtualSize
-            //    && (on_screen || LLViewerTexture::sDesiredDiscardBias <= BIAS_TRS_ON_SCREEN))
-            //{
-            //    break;
-            //}
-            // </FS>
+                // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
+                // Get the already calculated face's virtual size, instead of re-calculating it
+                batch.addFace(face->getVirtualSize(),
+                              face->mImportanceToCamera,
+                              face->mCloseToCamera,
+                              face->mInFrustum,
+                              face->mTextureMatrix || face->hasMedia()); // Add has media for both local and parcel media
+                // </FS:minerjr> [FIRE-35081]
+            }
         }
+    }
 
-        // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
-        // Replaced all the checks for this bool to be only in this 1 place instead of in the loop.
-        // If the on screen counter is greater then 0, then there was at least 1 on screen texture
-        on_screen = bool(on_screen_count);
-        imagep->setCloseToCamera(close_to_camera > 0.0f ? 1.0f : 0.0f);
-
-        //if (face_count > 1024)
-        // Add check for if the image is animated to boost to high as well
-        if (face_count > 1024 || animated != 0)
-        // </FS:minerjr> [FIRE-35081]
-        { // this texture is used in so many places we should just boost it and not bother checking its vsize
-            // this is especially important because the above is not time sliced and can hit multiple ms for a single texture
-            imagep->setBoostLevel(LLViewerFetchedTexture::BOOST_HIGH);
-            // Do we ever remove it? This also sets texture nodelete!
-        }
+    return index;
+}
 
-        if (imagep->getType() == LLViewerTexture::LOD_TEXTURE && imagep->getBoostLevel() == LLViewerTexture::BOOST_NONE)
-        { // conditionally reset max virtual size for unboosted LOD_TEXTURES
-          // this is an alternative to decaying mMaxVirtualSize over time
-          // that keeps textures from continously downrezzing and uprezzing in the background
+void LLViewerTextureList::applyImageDecodePriority(LLViewerFetchedTexture* imagep, const LLTexturePriorityBatch::Result& result)
+{
+    constexpr F32 BIAS_TRS_OUT_OF_SCREEN = 1.5f;
+    constexpr F32 BIAS_TRS_ON_SCREEN = 1.f;
 
-            if (LLViewerTexture::sDesiredDiscardBias > BIAS_TRS_OUT_OF_SCREEN ||
-                (!on_screen && LLViewerTexture::sDesiredDiscardBias > BIAS_TRS_ON_SCREEN))
-            {
-                imagep->mMaxVirtualSize = 0.f;
-            }
-        }
+    // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
+    // Apply new rules to bias discard, there are now 2 bias, off-screen and on-screen.
+    // On-screen Bias
+    // Only applied to LOD Textures and one that have Discard > 1 (0, 1 protected)
+    //
+    // Off-screen Bias
+    // Will be using the old method of applying the mMaxVirtualSize, however
+    // only on LOD textures and fetched textures get bias applied.
+    //
+    // Local (UI & Icons), Media and Dynamic textures should not have any discard applied to them.
+    //
+    // Without this, textures will become blurry that are on screen, which is one of the #1
+    // user complaints.
+    const bool on_screen = result.mOnScreen;
+    imagep->setCloseToCamera(result.mCloseToCamera ? 1.0f : 0.0f);
+
+    //if (face_count > 1024)
+    // Add check for if the image is animated to boost to high as well
+    if (result.mFaceCount > 1024 || result.mAnimated)
+    // </FS:minerjr> [FIRE-35081]
+    { // this texture is used in so many places we should just boost it and not bother checking its vsize
+        // this is especially important because the above is not time sliced and can hit multiple ms for a single texture
+        imagep->setBoostLevel(LLViewerFetchedTexture::BOOST_HIGH);
+        // Do we ever remove it? This also sets texture nodelete!
+    }
 
-        // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
-        //imagep->addTextureStats(max_vsize);
-        // New logic block for the bias system        
-        // Then depending on the type of texture, the higher resolution on_screen_max_vsize is applied.
-        // On Screen (Without Bias applied:
-        //      LOD/Fetch Texture: Discard Levels 0, 1
-        //      Fetch Texture 2, 3, 5 with bias < 2.0
-        //      BoostLevel = Boost_High
-        //      Local, Media, Dynamic Texture        
-        // If the textures are on screen and either 1 are the first 2 levels of discard and are either fetched or LOD textures
-        if (on_screen && ((imagep->getDiscardLevel() < 2 && imagep->getType() >= LLViewerTexture::FETCHED_TEXTURE) || (imagep->getType() == LLViewerTexture::FETCHED_TEXTURE && LLViewerTexture::sDesiredDiscardBias < 2.0f)))
-        {
-            // Always use the best quality of the texture
-            imagep->addTextureStats(max_on_screen_vsize);
-        }
-        // If the boost level just became high, or the texture is (Local, Media Dynamic)
-        else if (imagep->getBoostLevel() >= LLViewerTexture::BOOST_HIGH || imagep->getType() < LLViewerTexture::FETCHED_TEXTURE || close_to_camera)
-        {
-            // Always use the best quality of the texture
-            imagep->addTextureStats(max_on_screen_vsize);
-        }
-        // All other texture cases will use max_vsize with bias applied.
-        else
+    if (imagep->getType() == LLViewerTexture::LOD_TEXTURE && imagep->getBoostLevel() == LLViewerTexture::BOOST_NONE)
+    { // conditionally reset max virtual size for unboosted LOD_TEXTURES
+      // this is an alternative to decaying mMaxVirtualSize over time
+      // that keeps textures from continously downrezzing and uprezzing in the background
+
+        if (LLViewerTexture::sDesiredDiscardBias > BIAS_TRS_OUT_OF_SCREEN ||
+            (!on_screen && LLViewerTexture::sDesiredDiscardBias > BIAS_TRS_ON_SCREEN))
         {
-            imagep->addTextureStats(max_vsize);
+            imagep->mMaxVirtualSize = 0.f;
         }
-        // </FS:minerjr> [FIRE-35081]
     }
 
-#if 0
-    imagep->setDebugText(llformat("%d/%d - %d/%d -- %d/%d",
-        (S32)sqrtf(max_vsize),
-        (S32)sqrtf(imagep->mMaxVirtualSize),
-        imagep->getDiscardLevel(),
-        imagep->getDesiredDiscardLevel(),
-        imagep->getWidth(),
-        imagep->getFullWidth()));
-#endif
+    // <FS:minerjr> [FIRE-35081] Blurry prims not changing with graphics settings
+    //imagep->addTextureStats(max_vsize);
+    // New logic block for the bias system
+    // Then depending on the type of texture, the higher resolution on_screen_max_vsize is applied.
+    // On Screen (Without Bias applied:
+    //      LOD/Fetch Texture: Discard Levels 0, 1
+    //      Fetch Texture 2, 3, 5 with bias < 2.0
+    //      BoostLevel = Boost_High
+    //      Local, Media, Dynamic Texture
+    // If the textures are on screen and either 1 are the first 2 levels of discard and are either fetched or LOD textures
+    if (on_screen && ((imagep->getDiscardLevel() < 2 && imagep->getType() >= LLViewerTexture::FETCHED_TEXTURE) || (imagep->getType() == LLViewerTexture::FETCHED_TEXTURE && LLViewerTexture::sDesiredDiscardBias < 2.0f)))
+    {
+        // Always use the best quality of the texture
+        imagep->addTextureStats(result.mMaxOnScreenVirtualSize);
+    }
+    // If the boost level just became high, or the texture is (Local, Media Dynamic)
+    else if (imagep->getBoostLevel() >= LLViewerTexture::BOOST_HIGH || imagep->getType() < LLViewerTexture::FETCHED_TEXTURE || result.mCloseToCamera)
+    {
+        // Always use the best quality of the texture
+        imagep->addTextureStats(result.mMaxOnScreenVirtualSize);
+    }
+    // All other texture cases will use max_vsize with bias applied.
+    else
+    {
+        imagep->addTextureStats(result.mMaxVirtualSize);
+    }
+    // </FS:minerjr> [FIRE-35081]
+}
 
+void LLViewerTextureList::updateImageDecodeState(LLViewerFetchedTexture* imagep, bool flush_images)
+{
     // make sure to addTextureStats for any spotlights that are using this texture
     for (S32 vi = 0; vi < imagep->getNumVolumes(LLRender::LIGHT_TEX); ++vi)
     {
@@ -1573,19 +1488,55 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
 
     LLTimer timer;
 
-    for (auto& imagep : entries)
-    {
-        mLastUpdateKey = LLTextureKey(imagep->getID(), (ETexListType)imagep->getTextureListType());
-
-        if (imagep->getNumRefs() > 1) // make sure this image hasn't been deleted before attempting to update (may happen as a side effect of some other image updating)
+    // Snapshot the faces of as many textures as time allows, evaluate them
+    // in one pass (split across the "General" thread pool when there are
+    // plenty), then apply the results and update the fetches. Gathering
+    // may use half of max_time, applying gets the rest. Whatever isn't
+    // applied in time is gathered again next frame, which starts after
+    // mLastUpdateKey.
+    constexpr U32 MIN_PARALLEL_FACES = 16384;
+    LLTexturePriorityBatch& batch = mPriorityBatch;
+    batch.clear();
+    std::vector<S32> batch_index;
+    batch_index.reserve(entries.size());
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vtluift - gather");
+        for (auto& imagep : entries)
         {
-            updateImageDecodePriority(imagep);
-            imagep->updateFetch();
+            // make sure this image hasn't been deleted before attempting to update (may happen as a side effect of some other image updating)
+            batch_index.push_back(imagep->getNumRefs() > 1 ? gatherImageDecodePriority(batch, imagep) : -1);
+
+            if (timer.getElapsedTimeF32() > max_time * 0.5f)
+            {
+                break;
+            }
         }
+    }
 
-        if (timer.getElapsedTimeF32() > max_time)
+    static LLCachedControl<F32> texture_camera_boost(gSavedSettings, "TextureCameraBoost", 7.f);
+    batch.evaluate(texture_camera_boost, MIN_PARALLEL_FACES);
+
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vtluift - apply");
+        for (size_t i = 0; i < batch_index.size(); ++i)
         {
-            break;
+            LLViewerFetchedTexture* imagep = entries[i];
+            mLastUpdateKey = LLTextureKey(imagep->getID(), (ETexListType)imagep->getTextureListType());
+
+            if (imagep->getNumRefs() > 1)
+            {
+                if (batch_index[i] >= 0)
+                {
+                    applyImageDecodePriority(imagep, batch.getResult(batch_index[i]));
+                }
+                updateImageDecodeState(imagep, true);
+                imagep->updateFetch();
+            }
+
+            if (timer.getElapsedTimeF32() > max_time)
+            {
+                break;
+            }
         }
     }
 
@@ -35,6 +35,7 @@
 #include <list>
 #include <unordered_set>
 #include "lluiimage.h"
+#include "lltexturepriority.h"
 
 const U32 LL_IMAGE_REZ_LOSSLESS_CUTOFF = 128;
 
@@ -155,6 +156,14 @@ public:
     void updateImageDecodePriority(LLViewerFetchedTexture* imagep, bool flush_images = true);
 
 private:
+    // updateImageDecodePriority() in three steps, so updateImagesFetchTextures()
+    // can evaluate the faces of all its textures in one batch.
+    // gatherImageDecodePriority() returns the texture index in batch, or -1
+    // for textures that are boosted and don't need their faces looked at.
+    S32  gatherImageDecodePriority(LLTexturePriorityBatch& batch, LLViewerFetchedTexture* imagep);
+    void applyImageDecodePriority(LLViewerFetchedTexture* imagep, const LLTexturePriorityBatch::Result& result);
+    void updateImageDecodeState(LLViewerFetchedTexture* imagep, bool flush_images);
+
     F32  updateImagesCreateTextures(F32 max_time);
     F32  updateImagesFetchTextures(F32 max_time);
     void updateImagesUpdateStats();
@@ -243,6 +252,9 @@ private:
     uuid_map_t mUUIDMap;
     LLTextureKey mLastUpdateKey;
 
+    // reused every frame to avoid reallocating the face arrays
+    LLTexturePriorityBatch mPriorityBatch;
+
     image_list_t mImageList;
 
     // simply holds on to LLViewerFetchedTexture references to stop them from being purged too soon
@@ -119,8 +119,10 @@
 #include "llskinningutil.h"
 
 #include "llperfstats.h"
+#include "threadpool.h"
 
 #include <boost/lexical_cast.hpp>
+#include <thread>
 
 #include "fscommon.h"
 #include "fsdata.h"
@@ -655,6 +657,9 @@ F32 LLVOAvatar::sGreyUpdateTime = 0.f;
 LLPointer<LLViewerTexture> LLVOAvatar::sCloudTexture = NULL;
 std::vector<LLUUID> LLVOAvatar::sAVsIgnoringARTLimit;
 S32 LLVOAvatar::sAvatarsNearby = 0;
+bool LLVOAvatar::sBatchingSkeletons = false;
+std::vector<LLPointer<LLVOAvatar> > LLVOAvatar::sSkeletonBatch;
+std::unique_ptr<LL::ThreadPool> LLVOAvatar::sSkeletonThreadPool;
 
 //-----------------------------------------------------------------------------
 // Helper functions
@@ -1271,11 +1276,29 @@ void LLVOAvatar::initClass()
     sCloudTexture = LLViewerTextureManager::getFetchedTextureFromFile("cloud-particle.j2c");
 
     initCloud();
+
+    // the main thread takes a share of every skeleton batch too
+    S32 skeleton_threads = (S32)gSavedSettings.getU32("FSAvatarSkeletonThreads");
+    if (skeleton_threads == 0)
+    {
+        skeleton_threads = llclamp((S32)std::thread::hardware_concurrency() / 2 - 1, 0, 4);
+    }
+    if (skeleton_threads > 0 && !sSkeletonThreadPool)
+    {
+        sSkeletonThreadPool.reset(new LL::ThreadPool("AvatarSkeleton", llmin(skeleton_threads, 16)));
+        sSkeletonThreadPool->start();
+    }
 }
 
 
 void LLVOAvatar::cleanupClass()
 {
+    sSkeletonBatch.clear();
+    if (sSkeletonThreadPool)
+    {
+        sSkeletonThreadPool->close();
+        sSkeletonThreadPool.reset();
+    }
 }
 
 LLPartSysData LLVOAvatar::sCloud;
@@ -2937,12 +2960,14 @@ void LLVOAvatar::updateMeshData()
 U32 LLVOAvatar::processUpdateMessage(LLMessageSystem *mesgsys,
                                      void **user_data,
                                      U32 block_num, const EObjectUpdateType update_type,
-                                     LLDataPacker *dp)
+                                     LLDataPacker *dp,
+                                     const LLObjectUpdatePacket* packet,
+                                     const LLObjectUpdatePacket::FullUpdate* full_update)
 {
     const bool had_no_name = !getNVPair("FirstName");
 
     // Do base class updates...
-    U32 retval = LLViewerObject::processUpdateMessage(mesgsys, user_data, block_num, update_type, dp);
+    U32 retval = LLViewerObject::processUpdateMessage(mesgsys, user_data, block_num, update_type, dp, packet, full_update);
 
     // Print out arrival information once we have name of avatar.
     const bool has_name = getNVPair("FirstName");
@@ -3200,6 +3225,17 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
     mLastRootPos = mRoot->getWorldPosition();
     bool detailed_update = updateCharacter(agent);
 
+    if (mInSkeletonBatch)
+    {
+        // finishSkeletonBatch() carries on from here
+        mBatchedDetailedUpdate = detailed_update;
+        return;
+    }
+    idleUpdateAfterCharacter(detailed_update);
+}
+
+void LLVOAvatar::idleUpdateAfterCharacter(bool detailed_update)
+{
     static LLUICachedControl<bool> visualizers_in_calls("ShowVoiceVisualizersInCalls", false);
     bool voice_enabled = (visualizers_in_calls || LLVoiceClient::getInstance()->inProximalChannel()) &&
                          LLVoiceClient::getInstance()->getVoiceEnabled(mID);
@@ -4919,6 +4955,7 @@ LLViewerInventoryItem* recursiveGetObjectInventoryItem(LLViewerObject *vobj, LLU
 
 void LLVOAvatar::updateAnimationDebugText()
 {
+    addDebugText(llformat("Animation %.3f ms", mAnimationTime));
     for (LLMotionController::motion_list_t::iterator iter = mMotionController.getActiveMotions().begin();
          iter != mMotionController.getActiveMotions().end(); ++iter)
     {
@@ -5746,6 +5783,12 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     // store data relevant to motions
     mSpeed = speed;
 
+    // in a batch, the pose gets blended in updateSkeleton() along with the
+    // other avatars'
+    bool batched = sBatchingSkeletons && !isSelf();
+    mMotionController.setDeferPose(batched);
+    F64 motion_start = LLTimer::getTotalSeconds();
+
     // update animations
     if (!visible && !isSelf()) // NOTE: never do a "hidden update" for self avatar as it interrupts controller processing
     {
@@ -5761,6 +5804,9 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
         updateMotions(LLCharacter::NORMAL_UPDATE);
     }
 
+    mMotionTime = LLTimer::getTotalSeconds() - motion_start;
+    mMotionController.setDeferPose(false);
+
     // Special handling for sitting on ground.
     if (!getParent() && (isSitting() || was_sit_ground_constrained))
     {
@@ -5776,22 +5822,115 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
         }
     }
 
+    if (visible)
+    {
+        // System avatar mesh vertices need to be reskinned.
+        mNeedsSkin = true;
+    }
+
+    if (batched)
+    {
+        mInSkeletonBatch = true;
+        sSkeletonBatch.push_back(this);
+        return visible;
+    }
+
+    updateSkeleton();
+    finishCharacterUpdate();
+
+    return visible;
+}
+
+//-----------------------------------------------------------------------------
+// updateSkeleton()
+// Blends the pose the motions left and updates the joint matrices. Touches
+// nothing outside this avatar's motions and skeleton.
+//-----------------------------------------------------------------------------
+void LLVOAvatar::updateSkeleton()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    F64 start = LLTimer::getTotalSeconds();
+
+    mMotionController.applyPose();
+
+    // Update child joints as needed.
+    mRoot->updateWorldMatrixChildren();
+
+    mSkeletonTime = LLTimer::getTotalSeconds() - start;
+}
+
+//-----------------------------------------------------------------------------
+// finishCharacterUpdate()
+// The part of updateCharacter() that needs the new pose
+//-----------------------------------------------------------------------------
+void LLVOAvatar::finishCharacterUpdate()
+{
     // update head position
     updateHeadOffset();
 
     // Generate footstep sounds when feet hit the ground
     updateFootstepSounds();
 
-    // Update child joints as needed.
-    mRoot->updateWorldMatrixChildren();
+    F32 animation_time = (F32)((mMotionTime + mSkeletonTime) * 1000.0);
+    mAnimationTime = lerp(mAnimationTime, animation_time, 0.1f);
+}
 
-    if (visible)
+//-----------------------------------------------------------------------------
+// startSkeletonBatch()
+//-----------------------------------------------------------------------------
+// static
+void LLVOAvatar::startSkeletonBatch()
+{
+    sBatchingSkeletons = true;
+}
+
+//-----------------------------------------------------------------------------
+// finishSkeletonBatch()
+//-----------------------------------------------------------------------------
+// static
+void LLVOAvatar::finishSkeletonBatch()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    sBatchingSkeletons = false;
+    if (sSkeletonBatch.empty())
     {
-        // System avatar mesh vertices need to be reskinned.
-        mNeedsSkin = true;
+        return;
     }
 
-    return visible;
+    std::vector<LLVOAvatar*> avatars;
+    avatars.reserve(sSkeletonBatch.size());
+    for (LLVOAvatar* avatar : sSkeletonBatch)
+    {
+        if (!avatar->isDead())
+        {
+            avatars.push_back(avatar);
+        }
+    }
+
+    // Nothing else runs on the main thread until the batch is done, so the
+    // skeletons are all the workers touch.
+    if (sSkeletonThreadPool)
+    {
+        LL::parallel_for(*sSkeletonThreadPool, avatars.size(), [&avatars](size_t i) { avatars[i]->updateSkeleton(); });
+    }
+    else
+    {
+        for (LLVOAvatar* avatar : avatars)
+        {
+            avatar->updateSkeleton();
+        }
+    }
+
+    for (LLVOAvatar* avatar : sSkeletonBatch)
+    {
+        avatar->mInSkeletonBatch = false;
+        if (!avatar->isDead())
+        {
+            avatar->finishCharacterUpdate();
+            avatar->idleUpdateAfterCharacter(avatar->mBatchedDetailedUpdate);
+        }
+    }
+    sSkeletonBatch.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -54,6 +54,7 @@
 #include "llvovolume.h"
 #include "llavatarrendernotifier.h"
 #include "llmodel.h"
+#include "threadpool_fwd.h"
 
 extern const LLUUID ANIM_AGENT_BODY_NOISE;
 extern const LLUUID ANIM_AGENT_BREATHE_ROT;
@@ -132,7 +133,9 @@ public:
                                                      void **user_data,
                                                      U32 block_num,
                                                      const EObjectUpdateType update_type,
-                                                     LLDataPacker *dp);
+                                                     LLDataPacker *dp,
+                                                     const LLObjectUpdatePacket* packet = NULL,
+                                                     const LLObjectUpdatePacket::FullUpdate* full_update = NULL);
     virtual void                idleUpdate(LLAgent &agent, const F64 &time);
     /*virtual*/ bool            updateLOD();
     bool                        updateJointLODs();
@@ -342,6 +345,11 @@ public:
     // return 0.f if this avatar has not been profiled using gPipeline.mProfileAvatar
     F32             getCPURenderTime() { return mCPURenderTime; }
 
+    // get the CPU time in ms of animating this avatar, smoothed over updates:
+    // running its motions plus blending the pose and updating the joint
+    // matrices, on whichever thread that ran
+    F32             getAnimationTime() const { return mAnimationTime; }
+
 
     // avatar render cost
     U32             getVisualComplexity()           { return mVisualComplexity;             };
@@ -362,6 +370,33 @@ public:
 
     LLVector3 idleCalcNameTagPosition(const LLVector3 &root_pos_last);
 
+    //--------------------------------------------------------------------
+    // Skeleton batch
+    //--------------------------------------------------------------------
+public:
+    // LLViewerObjectList::update() brackets its idle loop with these. In
+    // between, avatars other than self stop their idle update once their
+    // motions have run. finishSkeletonBatch() then blends their poses and
+    // updates their joint matrices on the "AvatarSkeleton" thread pool and
+    // the main thread together, and finishes the idle updates.
+    static void     startSkeletonBatch();
+    static void     finishSkeletonBatch();
+
+    // no GL work and no global state, so may run on a worker thread
+    void            updateSkeleton();
+
+private:
+    void            finishCharacterUpdate();
+    void            idleUpdateAfterCharacter(bool detailed_update);
+
+    static bool     sBatchingSkeletons;
+    static std::vector<LLPointer<LLVOAvatar> > sSkeletonBatch;
+    static std::unique_ptr<LL::ThreadPool> sSkeletonThreadPool;
+    bool            mInSkeletonBatch = false;
+    bool            mBatchedDetailedUpdate = false;
+    F64             mMotionTime = 0.0;      // seconds, this update's motions
+    F64             mSkeletonTime = 0.0;    // seconds, this update's pose blend and joint matrices
+
     //--------------------------------------------------------------------
     // Static preferences (controlled by user settings/menus)
     //--------------------------------------------------------------------
@@ -603,6 +638,9 @@ private:
     // CPU render time in ms
     F32 mCPURenderTime = 0.f;
 
+    // CPU animation time in ms
+    F32 mAnimationTime = 0.f;
+
     // the isTooComplex method uses these mutable values to avoid recalculating too frequently
     // DEPRECATED -- obsolete avatar render cost values
     mutable U32  mVisualComplexity;
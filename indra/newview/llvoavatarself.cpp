@@ -3549,9 +3549,11 @@ U32  LLVOAvatarSelf::processUpdateMessage(LLMessageSystem *mesgsys,
                                                      void **user_data,
                                                      U32 block_num,
                                                      const EObjectUpdateType update_type,
-                                                     LLDataPacker *dp)
+                                                     LLDataPacker *dp,
+                                                     const LLObjectUpdatePacket* packet,
+                                                     const LLObjectUpdatePacket::FullUpdate* full_update)
 {
-    U32 retval = LLVOAvatar::processUpdateMessage(mesgsys,user_data,block_num,update_type,dp);
+    U32 retval = LLVOAvatar::processUpdateMessage(mesgsys,user_data,block_num,update_type,dp, packet, full_update);
 
     return retval;
 }
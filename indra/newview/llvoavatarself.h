@@ -114,7 +114,9 @@ public:
                                                      void **user_data,
                                                      U32 block_num,
                                                      const EObjectUpdateType update_type,
-                                                     LLDataPacker *dp);
+                                                     LLDataPacker *dp,
+                                                     const LLObjectUpdatePacket* packet = NULL,
+                                                     const LLObjectUpdatePacket::FullUpdate* full_update = NULL);
     // </FS:Ansariel> [Legacy Bake]
 
 private:
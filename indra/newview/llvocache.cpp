@@ -35,6 +35,8 @@
 #include "llsdserialize.h"
 #include "llagent.h" // <FS:Beq/> For gAgent
 #include "llworld.h" // For LLWorld::getInstance()
+#include "llvocacheextras.h" // <FS/> Binary extras cache
+#include "llvolume.h"
 
 //static variables
 U32 LLVOCacheEntry::sMinFrameRange = 0;
@@ -59,7 +61,6 @@ bool check_write(LLAPRFile* apr_file, void* src, S32 n_bytes)
 
 // Material Override Cache needs a version label, so we can upgrade this later.
 const std::string LLGLTFOverrideCacheEntry::VERSION_LABEL = {"GLTFCacheVer"};
-const int LLGLTFOverrideCacheEntry::VERSION = 1;
 
 bool LLGLTFOverrideCacheEntry::fromLLSD(const LLSD& data)
 {
@@ -524,6 +525,13 @@ void LLVOCacheEntry::updateDebugSettings()
     // </FS:Beq>
     const U32 clamped_frames = inv_obj_time ? llclamp((U32) inv_obj_time, MIN_FRAMES, MAX_FRAMES) : MAX_FRAMES; // [10, 64], with zero => 64
     sMinFrameRange = MIN_FRAMES + (U32)((clamped_frames - MIN_FRAMES) * adjust_factor);
+
+    // <FS> Face octrees for picking, down to a quarter under memory pressure
+    static LLCachedControl<U32> face_octree_budget_MB(gSavedSettings, "FSFaceOctreeBudget");
+    static const F32 MIN_OCTREE_BUDGET_FRACTION = 0.25f;
+    const F32 octree_budget_fraction = MIN_OCTREE_BUDGET_FRACTION + ((1.f - MIN_OCTREE_BUDGET_FRACTION) * adjust_factor);
+    LLVolumeFace::setOctreeBudget((U64)((F32)face_octree_budget_MB * octree_budget_fraction * 1024.f * 1024.f));
+    // </FS>
 }
 #endif // LL_TEST
 
@@ -1652,114 +1660,56 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
 	LL_PROFILE_ZONE_TEXT(extra_filename,256);
 	#endif
     // </FS:Beq>
-    llifstream in(filename, std::ios::in | std::ios::binary);
+    // <FS> Binary extras cache
+    // One mapping, one pass, no per-line parsing. Anything that is not a
+    // complete version 2 file (including the old text format) is dropped
+    // along with the region's objects so the simulator resends them.
+    LL_DEBUGS("GLTF") << "Beginning reading extras cache for handle " << handle << " from " << filename << LL_ENDL;
+    LLVOCacheExtrasFile::EStatus status = LLVOCacheExtrasFile::load(filename, id,
+        [&](LLGLTFOverrideCacheEntry& entry)
+        {
+            U32 local_id = entry.mLocalId;
+            // only add entries that exist in the primary cache
+            // this is a self-healing test that avoids us polluting the cache with entries that are no longer valid based on the main cache.
+            if(cache_entry_map.find(local_id)!= cache_entry_map.end())
+            {
+                // attempt to backfill a null objectId, though these shouldn't be in the persisted cache really
+                if(entry.mObjectId.isNull() && pRegion)
+                {
+                    gObjectList.getUUIDFromLocal( entry.mObjectId, local_id, pRegion->getHost().getAddress(), pRegion->getHost().getPort() );
+                }
+                cache_extras_entry_map[local_id] = std::move(entry);
+                loaded++;
+            }
+            else
+            {
+                discarded++;
+            }
+        });
 
-    std::string line;
-    std::getline(in, line);
-    if(!in.good())
+    switch (status)
     {
+    case LLVOCacheExtrasFile::LOADED:
+        break;
+    case LLVOCacheExtrasFile::NOT_FOUND:
         LL_WARNS() << "Failed reading extras cache for handle " << handle << LL_ENDL;
-        in.close();
         removeGenericExtrasForHandle(handle);
         return;
-    }
-    // file formats need versions, let's add one. legacy cache files will be considered version 0
-    // This will make it easier to upgrade/revise later.
-    int versionNumber=0;
-    if (line.compare(0, LLGLTFOverrideCacheEntry::VERSION_LABEL.length(), LLGLTFOverrideCacheEntry::VERSION_LABEL) == 0)
-    {
-        std::string versionStr = line.substr(LLGLTFOverrideCacheEntry::VERSION_LABEL.length()+1); // skip the version label and ':'
-        versionNumber = std::stol(versionStr);
-    }
-    // For future versions we may call a legacy handler here, but realistically we'll just consider this cache out of date.
-    // The important thing is to make sure it gets removed.
-    if(versionNumber != LLGLTFOverrideCacheEntry::VERSION)
-    {
-        LL_WARNS() << "Unexpected version number " << versionNumber << " for extras cache for handle " << handle << LL_ENDL;
-        in.close();
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
-
-    LL_DEBUGS("VOCache") << "Reading extras cache for handle " << handle << ", version " << versionNumber << LL_ENDL;
-    std::getline(in, line);
-    if(!LLUUID::validate(line))
-    {
-        LL_WARNS() << "Failed reading extras cache for handle" << handle << ". invalid uuid line: '" << line << "'" << LL_ENDL;
-        in.close();
+    case LLVOCacheExtrasFile::BAD_FORMAT:
+        LL_WARNS() << "Unexpected format or version for extras cache for handle " << handle << LL_ENDL;
         removeGenericExtrasForHandle(handle);
         return;
-    }
-
-    LLUUID cache_id(line);
-    if(cache_id != id)
-    {
+    case LLVOCacheExtrasFile::WRONG_REGION:
         // if the cache id doesn't match the expected region we should just kill the file.
         LL_WARNS() << "Cache ID doesn't match for this region, deleting it" << LL_ENDL;
-        in.close();
         removeGenericExtrasForHandle(handle);
         return;
-    }
-
-    U32 num_entries;  // if removal was enabled during write num_entries might be wrong
-    std::getline(in, line);
-    if(!in.good())
-    {
-        LL_WARNS() << "Failed reading extras cache for handle " << handle << LL_ENDL;
-        in.close();
+    case LLVOCacheExtrasFile::TRUNCATED:
+        LL_WARNS() << "Failed reading extras cache for handle " << handle << ", entry number " << (loaded + discarded) << " cache partial load only." << LL_ENDL;
         removeGenericExtrasForHandle(handle);
-        return;
-    }
-    try
-    {
-        num_entries = std::stol(line);
-    }
-    catch(std::logic_error&)  // either invalid_argument or out_of_range
-    {
-        LL_WARNS() << "Failed reading extras cache for handle " << handle << ". unreadable num_entries" << LL_ENDL;
-        in.close();
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
-
-    LL_DEBUGS("GLTF") << "Beginning reading extras cache for handle " << handle << " from " << getObjectCacheExtrasFilename(handle) << LL_ENDL;
-
-    LLSD entry_llsd;
-	LL_PROFILE_ZONE_NUM(num_entries);
-    for (U32 i = 0; i < num_entries && !in.eof(); i++)
-    {
-		LL_PROFILE_ZONE_NAMED_CATEGORY_NETWORK("RegionExtrasReadEntries");
-        static const U32 max_size = 4096;
-        bool success = LLSDSerialize::deserialize(entry_llsd, in, max_size);
-        // check bool(in) this time since eof is not a failure condition here
-        if(!success || !in)
-        {
-            LL_WARNS() << "Failed reading extras cache for handle " << handle << ", entry number " << i << " cache patrtial load only." << LL_ENDL;
-            in.close();
-            removeGenericExtrasForHandle(handle);
-            break;
-        }
-
-        LLGLTFOverrideCacheEntry entry;
-        entry.fromLLSD(entry_llsd);
-        U32 local_id = entry_llsd["local_id"].asInteger();
-        // only add entries that exist in the primary cache
-        // this is a self-healing test that avoids us polluting the cache with entries that are no longer valid based on the main cache.
-        if(cache_entry_map.find(local_id)!= cache_entry_map.end())
-        {
-            // attempt to backfill a null objectId, though these shouldn't be in the persisted cache really
-            if(entry.mObjectId.isNull() && pRegion)
-            {
-                gObjectList.getUUIDFromLocal( entry.mObjectId, local_id, pRegion->getHost().getAddress(), pRegion->getHost().getPort() );
-            }
-            cache_extras_entry_map[local_id] = entry;
-            loaded++;
-        }
-        else
-        {
-            discarded++;
-        }
+        break;
     }
+    // </FS>
     LL_DEBUGS("GLTF") << "Completed reading extras cache for handle " << handle << ", " << loaded << " loaded, " << discarded << " discarded" << LL_ENDL;
 }
 
@@ -1951,82 +1901,55 @@ void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LL
     }
 
     std::string filename = getObjectCacheExtrasFilename(handle);
-    llofstream out(filename, std::ios::out | std::ios::binary);
-    if(!out.good())
-    {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
-    // It is good practice to version file formats so let's add one.
-    // legacy versions will be treated as version 0.
-    out << LLGLTFOverrideCacheEntry::VERSION_LABEL << ":" << LLGLTFOverrideCacheEntry::VERSION << '\n';
 
-    out << id << '\n';
-    if(!out.good())
-    {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
-    // Because we don't write out all the entries we need to record a placeholder and rewrite this later
-    auto num_entries_placeholder = out.tellp();
-    out << std::setw(10) << std::setfill('0') << 0 << '\n';
-    if(!out.good())
-    {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
+    // <FS> Binary extras cache
+    // Build the whole file in memory and write it out in one go.
+    LLVOCacheExtrasFile extras_file;
+    extras_file.reserve(cache_extras_entry_map.size());
 
     // get ViewerRegion pointer from handle
     LLViewerRegion* pRegion = LLWorld::getInstance()->getRegionFromHandle(handle);
 
-    U32 num_entries = 0;
     U32 skipped = 0;
     size_t inmem_entries = cache_extras_entry_map.size();
-    for (auto [local_id, entry] : cache_extras_entry_map)
+    for (auto const & [local_id, entry] : cache_extras_entry_map)
     {
         // Only write out GLTFOverrides that we can actually apply again on import.
         // worst case we have an extra cache miss.
-        // Note: A null mObjectId is valid when in memory as we might have a data race between GLTF of the object itself.
-        // This remains a valid state to persist as it is consistent with the localid checks on import with the main cache.
-        // the mObjectId will be updated if/when the local object is updated from the gObject list (due to full update)
-        if(entry.mObjectId.isNull() && pRegion)
+        if( entry.mSides.size() == 0 ||
+            entry.mSides.size() != entry.mGLTFMaterial.size()
+          )
         {
-            gObjectList.getUUIDFromLocal( entry.mObjectId, local_id, pRegion->getHost().getAddress(), pRegion->getHost().getPort() );
+            skipped++;
+            continue;
         }
 
-        if( entry.mSides.size() > 0 &&
-            entry.mSides.size() == entry.mGLTFMaterial.size()
-          )
+        // Note: A null mObjectId is valid when in memory as we might have a data race between GLTF of the object itself.
+        // This remains a valid state to persist as it is consistent with the localid checks on import with the main cache.
+        // the mObjectId will be updated if/when the local object is updated from the gObject list (due to full update)
+        if ((entry.mObjectId.isNull() && pRegion) || entry.mLocalId != local_id)
         {
-            LLSD entry_llsd = entry.toLLSD();
-            entry_llsd["local_id"] = (S32)local_id;
-            LLSDSerialize::serialize(entry_llsd, out, LLSDSerialize::LLSD_XML);
-            out << '\n';
-            if(!out.good())
+            LLGLTFOverrideCacheEntry fixed_entry = entry;
+            fixed_entry.mLocalId = local_id;
+            if (fixed_entry.mObjectId.isNull() && pRegion)
             {
-                // We're not in a good place when this happens so we might as well nuke the file.
-                LL_WARNS() << "Failed writing extras cache for handle " << handle << ". Corrupted cache file " << filename << " removed." << LL_ENDL;
-                removeGenericExtrasForHandle(handle);
-                return;
+                gObjectList.getUUIDFromLocal( fixed_entry.mObjectId, local_id, pRegion->getHost().getAddress(), pRegion->getHost().getPort() );
             }
-            num_entries++;
+            extras_file.add(fixed_entry);
         }
         else
         {
-            skipped++;
+            extras_file.add(entry);
         }
     }
-    // Rewrite the placeholder
-    out.seekp(num_entries_placeholder);
-    out << std::setw(10) << std::setfill('0') << num_entries << '\n';
-    if(!out.good())
+
+    if(!extras_file.save(filename, id))
     {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
+        // We're not in a good place when this happens so we might as well nuke the file.
+        LL_WARNS() << "Failed writing extras cache for handle " << handle << ". Corrupted cache file " << filename << " removed." << LL_ENDL;
         removeGenericExtrasForHandle(handle);
         return;
     }
-    LL_DEBUGS("GLTF") << "Completed writing extras cache for handle " << handle << ", " << num_entries << " entries. Total in RAM: " << inmem_entries << " skipped (no persist): " << skipped << LL_ENDL;
+    // </FS>
+    LL_DEBUGS("GLTF") << "Completed writing extras cache for handle " << handle << ", " << extras_file.getCount() << " entries. Total in RAM: " << inmem_entries << " skipped (no persist): " << skipped << LL_ENDL;
 }
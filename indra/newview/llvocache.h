@@ -47,6 +47,12 @@ public:
     static const int VERSION;
     bool fromLLSD(const LLSD& data);
     LLSD toLLSD() const;
+    // <FS> Binary extras cache
+    // Append this entry as one record of the binary extras cache file
+    void toBinary(std::vector<U8>& buffer) const;
+    // Read one record written by toBinary() and advance data past it. Returns false on malformed data.
+    bool fromBinary(const U8*& data, const U8* end);
+    // </FS>
 
     LLUUID mObjectId;
     U32    mLocalId = 0;
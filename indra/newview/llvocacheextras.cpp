@@ -0,0 +1,228 @@
+/**
+ * @file llvocacheextras.cpp
+ * @brief Binary file of the GLTF material overrides of a cached region.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llvocacheextras.h"
+
+#include "llfile.h"
+#include "llmappedfile.h"
+#include "llmemorystream.h"
+#include "llsdserialize.h"
+
+// Version 1 was the text format (label line, region id line, entry count
+// line, then one LLSD XML document per entry). Version 2 is binary:
+//
+//     ExtrasFileHeader
+//     mRecordCount records of
+//         U32 local id, 16 byte object id, U64 region handle, U32 side count
+//         per side: S32 side index, U32 length, binary LLSD override
+//
+// so the whole file can be mapped and decoded in a single pass.
+const int LLGLTFOverrideCacheEntry::VERSION = 2;
+
+namespace
+{
+    const char EXTRAS_MAGIC[8] = { 'G', 'L', 'T', 'F', 'B', 'I', 'N', '\0' };
+
+    struct ExtrasFileHeader
+    {
+        char    mMagic[8];
+        U32     mVersion;
+        U32     mRecordCount;
+        U8      mRegionID[UUID_BYTES];
+    };
+    static_assert(sizeof(ExtrasFileHeader) == 32, "extras cache header layout changed");
+
+    template<typename T>
+    void append_value(std::vector<U8>& buffer, const T& value)
+    {
+        const U8* bytes = reinterpret_cast<const U8*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    bool read_value(const U8*& data, const U8* end, T& value)
+    {
+        if (end - data < (ptrdiff_t)sizeof(T))
+        {
+            return false;
+        }
+        memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// LLGLTFOverrideCacheEntry
+//-----------------------------------------------------------------------------
+
+void LLGLTFOverrideCacheEntry::toBinary(std::vector<U8>& buffer) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    llassert(mSides.size() == mGLTFMaterial.size());
+
+    append_value(buffer, mLocalId);
+    buffer.insert(buffer.end(), mObjectId.mData, mObjectId.mData + UUID_BYTES);
+    append_value(buffer, mRegionHandle);
+    append_value(buffer, (U32)mSides.size());
+
+    std::ostringstream str;
+    for (auto const & side : mSides)
+    {
+        str.str(std::string());
+        LLSDSerialize::toBinary(side.second, str);
+        const std::string override_bytes = str.str();
+        append_value(buffer, (S32)side.first);
+        append_value(buffer, (U32)override_bytes.size());
+        buffer.insert(buffer.end(), override_bytes.begin(), override_bytes.end());
+    }
+}
+
+bool LLGLTFOverrideCacheEntry::fromBinary(const U8*& data, const U8* end)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    U32 side_count = 0;
+    if (!read_value(data, end, mLocalId) || end - data < UUID_BYTES)
+    {
+        return false;
+    }
+    memcpy(mObjectId.mData, data, UUID_BYTES);
+    data += UUID_BYTES;
+    if (!read_value(data, end, mRegionHandle) || !read_value(data, end, side_count))
+    {
+        return false;
+    }
+
+    for (U32 i = 0; i < side_count; ++i)
+    {
+        S32 side_idx = 0;
+        U32 length = 0;
+        if (!read_value(data, end, side_idx) || !read_value(data, end, length) || (U64)(end - data) < length)
+        {
+            return false;
+        }
+
+        LLSD override_llsd;
+        LLMemoryStream str(data, (S32)length);
+        if (LLSDSerialize::fromBinary(override_llsd, str, length) == LLSDParser::PARSE_FAILURE)
+        {
+            return false;
+        }
+        data += length;
+
+        mSides[side_idx] = override_llsd;
+        LLGLTFMaterial* override_mat = new LLGLTFMaterial();
+        override_mat->applyOverrideLLSD(override_llsd);
+        mGLTFMaterial[side_idx] = override_mat;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// LLVOCacheExtrasFile
+//-----------------------------------------------------------------------------
+
+// static
+LLVOCacheExtrasFile::EStatus LLVOCacheExtrasFile::load(const std::string& filename, const LLUUID& region_id, const entry_callback_t& add)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    LLMappedFile mapping;
+    if (!mapping.open(filename, LLMappedFile::READ_ONLY) || mapping.size() < sizeof(ExtrasFileHeader))
+    {
+        return NOT_FOUND;
+    }
+
+    ExtrasFileHeader header;
+    memcpy(&header, mapping.data(), sizeof(header));
+    if (memcmp(header.mMagic, EXTRAS_MAGIC, sizeof(EXTRAS_MAGIC)) != 0 || header.mVersion != (U32)LLGLTFOverrideCacheEntry::VERSION)
+    {
+        return BAD_FORMAT;
+    }
+
+    LLUUID cache_id;
+    memcpy(cache_id.mData, header.mRegionID, UUID_BYTES);
+    if (cache_id != region_id)
+    {
+        return WRONG_REGION;
+    }
+
+    LL_PROFILE_ZONE_NUM(header.mRecordCount);
+    const U8* data = mapping.data() + sizeof(ExtrasFileHeader);
+    const U8* data_end = mapping.data() + mapping.size();
+    for (U32 i = 0; i < header.mRecordCount; i++)
+    {
+        LLGLTFOverrideCacheEntry entry;
+        if (!entry.fromBinary(data, data_end))
+        {
+            return TRUNCATED;
+        }
+        add(entry);
+    }
+    return LOADED;
+}
+
+LLVOCacheExtrasFile::LLVOCacheExtrasFile() :
+    mBuffer(sizeof(ExtrasFileHeader)),
+    mCount(0)
+{
+}
+
+void LLVOCacheExtrasFile::reserve(size_t count)
+{
+    // most overrides are a few small maps
+    mBuffer.reserve(sizeof(ExtrasFileHeader) + count * 256);
+}
+
+void LLVOCacheExtrasFile::add(const LLGLTFOverrideCacheEntry& entry)
+{
+    entry.toBinary(mBuffer);
+    ++mCount;
+}
+
+bool LLVOCacheExtrasFile::save(const std::string& filename, const LLUUID& region_id)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    ExtrasFileHeader header;
+    memcpy(header.mMagic, EXTRAS_MAGIC, sizeof(EXTRAS_MAGIC));
+    header.mVersion = (U32)LLGLTFOverrideCacheEntry::VERSION;
+    header.mRecordCount = mCount;
+    memcpy(header.mRegionID, region_id.mData, UUID_BYTES);
+    memcpy(mBuffer.data(), &header, sizeof(header));
+
+    LLFILE* out = LLFile::fopen(filename, "wb");
+    bool success = out && fwrite(mBuffer.data(), 1, mBuffer.size(), out) == mBuffer.size();
+    if (out)
+    {
+        success = (fclose(out) == 0) && success;
+    }
+    return success;
+}
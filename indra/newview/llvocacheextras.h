@@ -0,0 +1,81 @@
+/**
+ * @file llvocacheextras.h
+ * @brief Binary file of the GLTF material overrides of a cached region.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOCACHEEXTRAS_H
+#define LL_LLVOCACHEEXTRAS_H
+
+#include "llvocache.h"
+
+#include <functional>
+#include <vector>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLVOCacheExtrasFile
+//
+//   The "extras" file LLVOCache keeps next to each region's object cache:
+//
+//     ExtrasFileHeader (magic, LLGLTFOverrideCacheEntry::VERSION, record
+//     count, region id), then the records of LLGLTFOverrideCacheEntry::
+//     toBinary()
+//
+//   The records are collected in memory and written with one call; reading
+//   maps the file and decodes it in a single pass. LLVOCache decides which
+//   entries go in and which of the loaded ones it keeps.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+class LLVOCacheExtrasFile
+{
+public:
+    enum EStatus
+    {
+        LOADED,
+        NOT_FOUND,      // missing or shorter than the header
+        BAD_FORMAT,     // other magic or version, e.g. the old text format
+        WRONG_REGION,
+        TRUNCATED       // the records before the damage were passed on
+    };
+
+    typedef std::function<void(LLGLTFOverrideCacheEntry& entry)> entry_callback_t;
+
+    // Calls add for every record of the file
+    static EStatus load(const std::string& filename, const LLUUID& region_id, const entry_callback_t& add);
+
+    LLVOCacheExtrasFile();
+
+    void reserve(size_t count);
+    void add(const LLGLTFOverrideCacheEntry& entry);
+    U32 getCount() const { return mCount; }
+
+    // Writes the header and the records added so far
+    bool save(const std::string& filename, const LLUUID& region_id);
+
+private:
+    std::vector<U8> mBuffer;
+    U32 mCount;
+};
+
+#endif // LL_LLVOCACHEEXTRAS_H
@@ -49,7 +49,9 @@ public:
                                             void **user_data,
                                             U32 block_num,
                                             const EObjectUpdateType update_type,
-                                            LLDataPacker *dp);
+                                            LLDataPacker *dp,
+                                            const LLObjectUpdatePacket* packet = NULL,
+                                            const LLObjectUpdatePacket::FullUpdate* full_update = NULL);
     static void import(LLFILE *file, LLMessageSystem *mesgsys, const LLVector3 &pos);
     /*virtual*/ void exportFile(LLFILE *file, const LLVector3 &position);
 
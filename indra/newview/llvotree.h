@@ -57,7 +57,9 @@ public:
     /*virtual*/ U32 processUpdateMessage(LLMessageSystem *mesgsys,
                                             void **user_data,
                                             U32 block_num, const EObjectUpdateType update_type,
-                                            LLDataPacker *dp);
+                                            LLDataPacker *dp,
+                                            const LLObjectUpdatePacket* packet = NULL,
+                                            const LLObjectUpdatePacket::FullUpdate* full_update = NULL);
     /*virtual*/ void idleUpdate(LLAgent &agent, const F64 &time);
 
     // Graphical stuff for objects - maybe broken out into render class later?
@@ -71,6 +71,7 @@
 #include "llmediaentry.h"
 #include "llmediadataclient.h"
 #include "llmeshrepository.h"
+#include "llobjectupdatequeue.h" // <FS> object update pipeline
 #include "llnotifications.h"
 #include "llnotificationsutil.h"
 #include "llagent.h"
@@ -94,6 +95,10 @@
 #include "rlvlocks.h"
 // [/RLVa:KB]
 #include "llviewernetwork.h"
+#include "llviewerstats.h"
+#include "threadpool.h"
+
+#include <thread>
 
 const F32 FORCE_SIMPLE_RENDER_AREA = 512.f;
 const F32 FORCE_CULL_AREA = 8.f;
@@ -341,6 +346,8 @@ void LLVOVolume::initClass()
         sObjectMediaNavigateClient = new LLObjectMediaNavigateClient(queue_timer_delay, retry_timer_delay,
                                                                      max_retries, max_sorted_queue_size, max_round_robin_queue_size);
     }
+
+    LLVolumeGeometryManager::initClass();
 }
 
 // static
@@ -348,12 +355,16 @@ void LLVOVolume::cleanupClass()
 {
     sObjectMediaClient = NULL;
     sObjectMediaNavigateClient = NULL;
+
+    LLVolumeGeometryManager::cleanupClass();
 }
 
 U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
                                           void **user_data,
                                           U32 block_num, EObjectUpdateType update_type,
-                                          LLDataPacker *dp)
+                                          LLDataPacker *dp,
+                                          const LLObjectUpdatePacket* packet,
+                                          const LLObjectUpdatePacket::FullUpdate* full_update)
 {
     // <FS:Ansariel> Improved bad object handling
     static LLCachedControl<bool> fsEnforceStrictObjectCheck(gSavedSettings, "FSEnforceStrictObjectCheck");
@@ -375,7 +386,7 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
     const bool previously_color_changed = mColorChanged;
 
     // Do base class updates...
-    U32 retval = LLViewerObject::processUpdateMessage(mesgsys, user_data, block_num, update_type, dp);
+    U32 retval = LLViewerObject::processUpdateMessage(mesgsys, user_data, block_num, update_type, dp, packet, full_update);
 
     LLUUID sculpt_id;
     U8 sculpt_type = 0;
@@ -388,36 +399,36 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
         LL_DEBUGS("ObjectUpdate") << "uuid " << mID << " set sculpt_id " << sculpt_id << LL_ENDL;
     }
 
-    if (!dp)
+    // <FS> object update pipeline: full updates are decoded by
+    // LLObjectUpdatePacket, see LLViewerObjectList::processUpdateCore()
+    //if (!dp)
+    if (full_update)
     {
-        if (update_type == OUT_FULL)
+        // a block that is not for a volume has nothing more to read
+        if (full_update->mHasVolume)
         {
-            ////////////////////////////////
-            //
-            // Unpack texture animation data
-            //
-            //
-
-            if (mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_TextureAnim))
+            // ObjectUpdate has the texture animation ahead of the volume,
+            // ObjectUpdateCompressed after the texture entry
+            const bool compressed = update_type != OUT_FULL;
+            auto update_texture_anim = [this, full_update]()
             {
-                if (!mTextureAnimp)
+                if (full_update->mHasTextureAnim)
                 {
-                    mTextureAnimp = new LLViewerTextureAnim(this);
-                }
-                else
-                {
-                    if (!(mTextureAnimp->mMode & LLTextureAnim::SMOOTH))
+                    if (!mTextureAnimp)
+                    {
+                        mTextureAnimp = new LLViewerTextureAnim(this);
+                    }
+                    else
                     {
-                        mTextureAnimp->reset();
+                        if (!(mTextureAnimp->mMode & LLTextureAnim::SMOOTH))
+                        {
+                            mTextureAnimp->reset();
+                        }
                     }
+                    mTexAnimMode = 0;
+                    static_cast<LLTextureAnim&>(*mTextureAnimp) = full_update->mTextureAnim;
                 }
-                mTexAnimMode = 0;
-
-                mTextureAnimp->unpackTAMessage(mesgsys, block_num);
-            }
-            else
-            {
-                if (mTextureAnimp)
+                else if (mTextureAnimp)
                 {
                     delete mTextureAnimp;
                     mTextureAnimp = NULL;
@@ -437,14 +448,15 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
                     mFaceMappingChanged = true;
                     mTexAnimMode = 0;
                 }
+            };
+
+            if (!compressed)
+            {
+                update_texture_anim();
             }
 
-            // Unpack volume data
-            LLVolumeParams volume_params;
-            // <FS:Beq> Extend the bogus volume error handling to the other code path
-            //LLVolumeMessage::unpackVolumeParams(&volume_params, mesgsys, _PREHASH_ObjectData, block_num);
-            bool res = LLVolumeMessage::unpackVolumeParams(&volume_params, mesgsys, _PREHASH_ObjectData, block_num);
-            if (!res)
+            LLVolumeParams volume_params = full_update->mVolumeParams;
+            if (!full_update->mVolumeParamsValid)
             {
                 //<FS:Beq> Improved bad object handling courtesy of Drake.
                 std::string region_name = "unknown region";
@@ -474,8 +486,57 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
             {
                 markForUpdate();
             }
-        }
 
+            // parsed for every face the message can hold
+            S32 result = 0;
+            if (full_update->mTextureEntry)
+            {
+                LLTEContents& tec = *full_update->mTextureEntry;
+                tec.face_count = llmin((U32)getNumTEs(), LLTEContents::MAX_TES);
+                result = applyParsedTEMessage(tec);
+            }
+            if (full_update->mTextureEntryInvalid)
+            {
+                //<FS:Beq> Improved bad object handling courtesy of Drake.
+                std::string region_name = "unknown region";
+                if (getRegion())
+                {
+                    region_name = getRegion()->getName();
+                    if (enfore_strict_object_check)
+                    {
+                        LL_WARNS() << "An invalid object (" << getID() << ") has been removed (FSEnforceStrictObjectCheck)" << LL_ENDL;
+                        getRegion()->addCacheMissFull(getLocalID()); // force cache skip
+                    }
+                }
+
+                LL_WARNS() << "Bogus TE data in object " << getID() << " @ " << getPositionRegion()
+                    << " in " << region_name << LL_ENDL;
+                if (enfore_strict_object_check)
+                {
+                    gObjectList.killObject(this);
+                    return (INVALID_UPDATE);
+                }
+                // </FS:Beq>
+            }
+            else if (result & TEM_CHANGE_MEDIA)
+            {
+                retval |= MEDIA_FLAGS_CHANGED;
+            }
+
+            if (compressed)
+            {
+                update_texture_anim();
+
+                if (full_update->mSpecialCode & 0x400)
+                { //particle system (new)
+                    unpackParticleSource(full_update->mVolumeParticles.get(), mOwnerID, false);
+                }
+            }
+        }
+    }
+    else if (!dp)
+    // </FS>
+    {
         // Sigh, this needs to be done AFTER the volume is set as well, otherwise bad stuff happens...
         ////////////////////////////
         //
@@ -514,156 +575,57 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
     }
     else
     {
-        if (update_type != OUT_TERSE_IMPROVED)
+        // <FS> object update pipeline: a queued terse update has its
+        // texture entry parsed already, or was too short to decode and
+        // still holds it as it came
+        //S32 texture_length = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_TextureEntry);
+        U8 tdpbuffer[1024];
+        S32 texture_length = 0;
+        S32 result = 0;
+        if (mesgsys)
         {
-            LLVolumeParams volume_params;
-            bool res = LLVolumeMessage::unpackVolumeParams(&volume_params, *dp);
-            if (!res)
-            {
-                //<FS:Beq> Improved bad object handling courtesy of Drake.
-                //LL_WARNS() << "Bogus volume parameters in object " << getID() << LL_ENDL;
-                //LL_WARNS() << getRegion()->getOriginGlobal() << LL_ENDL;
-                std::string region_name = "unknown region";
-                if (getRegion())
-                {
-                    region_name = getRegion()->getName();
-                    if (enfore_strict_object_check)
-                    {
-                        LL_WARNS() << "An invalid object (" << getID() << ") has been removed (FSEnforceStrictObjectCheck)" << LL_ENDL;
-                        getRegion()->addCacheMissFull(getLocalID()); // force cache skip the object
-                    }
-                }
-                LL_WARNS() << "Bogus volume parameters in object " << getID() << " @ " << getPositionRegion()
-                            << " in " << region_name << LL_ENDL;
-                // <FS:Beq> [FIRE-16995] [CRASH] Continuous crashing upon entering 3 adjacent sims incl. Hathian, D8, Devil's Pocket
-                // A bad object entry in a .slc simobject cache can result in an unreadable/unusable volume
-                // This leaves the volume in an uncertain state and can result in a crash when later code access an uninitialised pointer
-                // return an INVALID_UPDATE instead
-                // <FS:Beq> July 2017 Change backed out due to side effects. FIRE-16995 still an exposure.
-                // return(INVALID_UPDATE);
-                // NOTE: An option here would be to correctly return the media status using "retval |= INVALID_UPDATE"
-                if (enfore_strict_object_check)
-                {
-                    gObjectList.killObject(this);
-                    return (INVALID_UPDATE);
-                }
-                // </FS:Beq>
-            }
-
-            volume_params.setSculptID(sculpt_id, sculpt_type);
-
-            if (setVolume(volume_params, 0))
+            texture_length = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_TextureEntry);
+            if (texture_length)
             {
-                markForUpdate();
+                mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_TextureEntry, tdpbuffer, 0, block_num, 1024);
             }
-            S32 res2 = unpackTEMessage(*dp);
-            if (TEM_INVALID == res2)
+        }
+        else if (packet)
+        {
+            const LLObjectUpdatePacket::TerseUpdate* terse_update = packet->getTerseUpdate(block_num);
+            if (terse_update)
             {
-                // There's something bogus in the data that we're unpacking.
-                dp->dumpBufferToLog();
-                //<FS:Beq> Improved bad object handling courtesy of Drake.
-                //LL_WARNS() << "Flushing cache files" << LL_ENDL;
-
-                //if(LLVOCache::instanceExists() && getRegion())
-                //{
-                //  LLVOCache::getInstance()->removeEntry(getRegion()->getHandle()) ;
-                //}
-                //
-                //LL_WARNS() << "Bogus TE data in " << getID() << LL_ENDL;
-                std::string region_name = "unknown region";
-                if (getRegion())
-                {
-                    region_name = getRegion()->getName();
-                    if (enfore_strict_object_check)
-                    {
-                        LL_WARNS() << "An invalid object (" << getID() << ") has been removed (FSEnforceStrictObjectCheck)" << LL_ENDL;
-                        getRegion()->addCacheMissFull(getLocalID()); // force cache skip
-                    }
-                }
-
-                LL_WARNS() << "Bogus TE data in object " << getID() << " @ " << getPositionRegion()
-                    << " in " << region_name << LL_ENDL;
-                if (enfore_strict_object_check)
+                if (terse_update->mTextureEntry)
                 {
-                    gObjectList.killObject(this);
-                    return (INVALID_UPDATE);
+                    LLTEContents& tec = *terse_update->mTextureEntry;
+                    tec.face_count = llmin((U32)getNumTEs(), LLTEContents::MAX_TES);
+                    result = applyParsedTEMessage(tec);
                 }
-                // </FS:Beq>
             }
             else
             {
-                if (res2 & TEM_CHANGE_MEDIA)
-                {
-                    retval |= MEDIA_FLAGS_CHANGED;
-                }
-            }
-
-            U32 value = dp->getPassFlags();
-
-            if (value & 0x40)
-            {
-                if (!mTextureAnimp)
-                {
-                    mTextureAnimp = new LLViewerTextureAnim(this);
-                }
-                else
-                {
-                    if (!(mTextureAnimp->mMode & LLTextureAnim::SMOOTH))
-                    {
-                        mTextureAnimp->reset();
-                    }
-                }
-                mTexAnimMode = 0;
-                mTextureAnimp->unpackTAMessage(*dp);
-            }
-            else if (mTextureAnimp)
-            {
-                delete mTextureAnimp;
-                mTextureAnimp = NULL;
-
-                for (S32 i = 0; i < getNumTEs(); i++)
-                {
-                    LLFace* facep = mDrawable->getFace(i);
-                    if (facep && facep->mTextureMatrix)
-                    {
-                        // delete or reset
-                        delete facep->mTextureMatrix;
-                        facep->mTextureMatrix = NULL;
-                    }
-                }
-
-                gPipeline.markTextured(mDrawable);
-                mFaceMappingChanged = true;
-                mTexAnimMode = 0;
-            }
-
-            if (value & 0x400)
-            { //particle system (new)
-                unpackParticleSource(*dp, mOwnerID, false);
+                const LLObjectUpdatePacket::Block& block = packet->getBlock(block_num);
+                texture_length = block.mTextureEntrySize;
+                memcpy(tdpbuffer, packet->getTextureEntry(block), texture_length);
             }
         }
-        else
+        if (texture_length)
         {
-            S32 texture_length = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_TextureEntry);
-            if (texture_length)
-            {
-                U8                          tdpbuffer[1024];
-                LLDataPackerBinaryBuffer    tdp(tdpbuffer, 1024);
-                mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_TextureEntry, tdpbuffer, 0, block_num, 1024);
-                S32 result = unpackTEMessage(tdp);
-                if (result & teDirtyBits)
-                {
-                    if (mDrawable)
-                    { //on the fly TE updates break batches, isolate in octree
-                        shrinkWrap();
-                    }
-                }
-                if (result & TEM_CHANGE_MEDIA)
-                {
-                    retval |= MEDIA_FLAGS_CHANGED;
-                }
+            LLDataPackerBinaryBuffer    tdp(tdpbuffer, 1024);
+            result = unpackTEMessage(tdp);
+        }
+        if (result & teDirtyBits)
+        {
+            if (mDrawable)
+            { //on the fly TE updates break batches, isolate in octree
+                shrinkWrap();
             }
         }
+        if (result & TEM_CHANGE_MEDIA)
+        {
+            retval |= MEDIA_FLAGS_CHANGED;
+        }
+        // </FS>
     }
 // <FS:CR> OpenSim returns a zero. Don't request MediaData where MOAP isn't supported
     //if (retval & (MEDIA_URL_REMOVED | MEDIA_URL_ADDED | MEDIA_URL_UPDATED | MEDIA_FLAGS_CHANGED))
@@ -5022,11 +4984,24 @@ bool LLVOVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a&
             }
 
             // This calculates the bounding box of the skinned mesh from scratch. It's actually quite expensive, but not nearly as expensive as building a full octree.
-            // rebuild_face_octrees = false because an octree for this face will be built later only if needed for narrow phase picking.
-            updateRiggedVolume(true, i, false);
+            // The octree for this face is built by lineSegmentIntersect() only if needed for narrow phase picking.
+            updateRiggedVolume(true, i);
+
+            // <FS:ND> Create a debug log for octree insertions if requested.
+            static LLCachedControl<bool> debugOctree(gSavedSettings,"FSCreateOctreeLog");
+            bool _debugOT( debugOctree && !transform );
+            if( _debugOT )
+                nd::octree::debug::gOctreeDebug += 1;
+            // </FS:ND>
+
             face_hit = volume->lineSegmentIntersect(local_start, local_end, i,
                                                     &p, &tc, &n, &tn);
 
+            // <FS:ND> Reset octree log
+            if( _debugOT )
+                nd::octree::debug::gOctreeDebug -= 1;
+            // </FS:ND>
+
             if (face_hit >= 0 && mDrawable->getNumFaces() > face_hit)
             {
                 LLFace* face = mDrawable->getFace(face_hit);
@@ -5147,7 +5122,7 @@ void LLVOVolume::clearRiggedVolume()
     }
 }
 
-void LLVOVolume::updateRiggedVolume(bool force_treat_as_rigged, LLRiggedVolume::FaceIndex face_index, bool rebuild_face_octrees)
+void LLVOVolume::updateRiggedVolume(bool force_treat_as_rigged, LLRiggedVolume::FaceIndex face_index)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
     //Update mRiggedVolume to match current animation frame of avatar.
@@ -5182,15 +5157,19 @@ void LLVOVolume::updateRiggedVolume(bool force_treat_as_rigged, LLRiggedVolume::
         updateRelativeXform();
     }
 
-    mRiggedVolume->update(skin, avatar, volume, face_index, rebuild_face_octrees);
+    mRiggedVolume->update(skin, avatar, volume, face_index);
+}
+
+namespace
+{
+    std::unique_ptr<LL::ThreadPool> sBuildThreadPool;
 }
 
 void LLRiggedVolume::update(
     const LLMeshSkinInfo* skin,
     LLVOAvatar* avatar,
     const LLVolume* volume,
-    FaceIndex face_index,
-    bool rebuild_face_octrees)
+    FaceIndex face_index)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
     bool copy = false;
@@ -5237,9 +5216,6 @@ void LLRiggedVolume::update(
     LLSkinningUtil::initSkinningMatrixPalette(mat, maxJoints, skin, avatar);
     const LLMatrix4a bind_shape_matrix = skin->mBindShapeMatrix;
 
-    S32 rigged_vert_count = 0;
-    S32 rigged_face_count = 0;
-    LLVector4a box_min, box_max;
     S32 face_begin;
     S32 face_end;
     if (face_index == DO_NOT_UPDATE_FACES)
@@ -5257,7 +5233,13 @@ void LLRiggedVolume::update(
         face_begin = face_index;
         face_end = face_begin + 1;
     }
-    for (S32 i = face_begin; i < face_end; ++i)
+
+    mSkinningBatches.resize(mVolumeFaces.size());
+    const U32 max_joints = LLSkinningUtil::getMaxJointCount();
+
+    // Everything here only touches face i of this volume and of the source
+    // volume, so faces can be skinned on the build pool side by side.
+    auto skin_face = [&](S32 i)
     {
         const LLVolumeFace& vol_face = volume->getVolumeFace(i);
 
@@ -5265,103 +5247,112 @@ void LLRiggedVolume::update(
 
         LLVector4a* weight = vol_face.mWeights;
 
-        if ( weight )
-        {
-            LLSkinningUtil::checkSkinWeights(weight, dst_face.mNumVertices, skin);
+        LLSkinningUtil::checkSkinWeights(weight, dst_face.mNumVertices, skin);
 
-            LLVector4a* pos = dst_face.mPositions;
+        LLVector4a* pos = dst_face.mPositions;
 
-            if (pos && dst_face.mExtents)
-            {
-                U32 max_joints = LLSkinningUtil::getMaxJointCount();
-                rigged_vert_count += dst_face.mNumVertices;
-                rigged_face_count++;
+        if (pos && dst_face.mExtents)
+        {
+            //update bounding box
+            // VFExtents change
+            LLVector4a& min = dst_face.mExtents[0];
+            LLVector4a& max = dst_face.mExtents[1];
 
-            #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
-                if (vol_face.mJointIndices) // fast path with preconditioned joint indices
-                {
-                    LLMatrix4a src[4];
-                    U8* joint_indices_cursor = vol_face.mJointIndices;
-                    LLVector4a* just_weights = vol_face.mJustWeights;
-                    for (U32 j = 0; j < dst_face.mNumVertices; ++j)
-                    {
-                        LLMatrix4a final_mat;
-                        F32* w = just_weights[j].getF32ptr();
-                        LLSkinningUtil::getPerVertexSkinMatrixWithIndices(w, joint_indices_cursor, mat, final_mat, src);
-                        joint_indices_cursor += 4;
-
-                        LLVector4a& v = vol_face.mPositions[j];
-                        LLVector4a t;
-                        LLVector4a dst;
-                        bind_shape_matrix.affineTransform(v, t);
-                        final_mat.affineTransform(t, dst);
-                        pos[j] = dst;
-                    }
-                }
-                else
-            #endif
+        #if USE_SEPARATE_JOINT_INDICES_AND_WEIGHTS
+            if (vol_face.mJointIndices) // fast path with preconditioned joint indices
+            {
+                LLMatrix4a src[4];
+                U8* joint_indices_cursor = vol_face.mJointIndices;
+                LLVector4a* just_weights = vol_face.mJustWeights;
+                for (U32 j = 0; j < dst_face.mNumVertices; ++j)
                 {
-                    for (S32 j = 0; j < dst_face.mNumVertices; ++j)
-                    {
-                        LLMatrix4a final_mat;
-                        // <FS:ND> Use the SSE2 version
-                        // LLSkinningUtil::getPerVertexSkinMatrix(weight[j].getF32ptr(), mat, false, final_mat, max_joints);
-                        FSSkinningUtil::getPerVertexSkinMatrixSSE(weight[j], mat, false, final_mat, max_joints);
-                        // </FS:ND>
-
-                        LLVector4a& v = vol_face.mPositions[j];
-                        LLVector4a t;
-                        LLVector4a dst;
-                        bind_shape_matrix.affineTransform(v, t);
-                        final_mat.affineTransform(t, dst);
-                        pos[j] = dst;
-                    }
+                    LLMatrix4a final_mat;
+                    F32* w = just_weights[j].getF32ptr();
+                    LLSkinningUtil::getPerVertexSkinMatrixWithIndices(w, joint_indices_cursor, mat, final_mat, src);
+                    joint_indices_cursor += 4;
+
+                    LLVector4a& v = vol_face.mPositions[j];
+                    LLVector4a t;
+                    LLVector4a dst;
+                    bind_shape_matrix.affineTransform(v, t);
+                    final_mat.affineTransform(t, dst);
+                    pos[j] = dst;
                 }
 
-                //update bounding box
-                // VFExtents change
-                LLVector4a& min = dst_face.mExtents[0];
-                LLVector4a& max = dst_face.mExtents[1];
-
                 min = pos[0];
-                max = pos[1];
-                if (i==0)
-                {
-                    box_min = min;
-                    box_max = max;
-                }
-
+                max = pos[0];
                 for (S32 j = 1; j < dst_face.mNumVertices; ++j)
                 {
                     min.setMin(min, pos[j]);
                     max.setMax(max, pos[j]);
                 }
+            }
+            else
+        #endif
+            {
+                // Vertices sharing joints and weights share their blended
+                // matrix; the grouping holds until the face or skin changes.
+                LLSkinningBatch& batch = mSkinningBatches[i];
+                if (!batch.isBuiltFor(vol_face.mPositions, weight, dst_face.mNumVertices, bind_shape_matrix, max_joints))
+                {
+                    batch.build(vol_face.mPositions, weight, dst_face.mNumVertices, bind_shape_matrix, max_joints);
+                }
+                batch.skin(mat, pos, min, max);
+            }
 
-                box_min.setMin(min,box_min);
-                box_max.setMax(max,box_max);
+            dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
+            dst_face.mCenter->mul(0.5f);
+        }
 
-                dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
-                dst_face.mCenter->mul(0.5f);
+        // the vertices moved, the next raycast to get this far builds a new one
+        dst_face.destroyOctree();
+    };
 
-            }
+    std::vector<S32> rigged_faces;
+    U32 total_verts = 0;
+    for (S32 i = face_begin; i < face_end; ++i)
+    {
+        if (volume->getVolumeFace(i).mWeights)
+        {
+            rigged_faces.push_back(i);
+            total_verts += mVolumeFaces[i].mNumVertices;
+        }
+    }
+
+    // Mesh bodies come as a few large faces: worth sharing out, a single
+    // face or a small attachment is not.
+    constexpr U32 MIN_PARALLEL_VERTS = 8192;
+    if (sBuildThreadPool && rigged_faces.size() > 1 && total_verts >= MIN_PARALLEL_VERTS)
+    {
+        LL::parallel_for(*sBuildThreadPool, rigged_faces.size(), [&](size_t i) { skin_face(rigged_faces[i]); });
+    }
+    else
+    {
+        for (S32 i : rigged_faces)
+        {
+            skin_face(i);
+        }
+    }
 
-            if (rebuild_face_octrees)
+    S32 rigged_vert_count = 0;
+    S32 rigged_face_count = 0;
+    LLVector4a box_min, box_max;
+    box_min.clear();
+    box_max.clear();
+    for (S32 i : rigged_faces)
+    {
+        const LLVolumeFace& dst_face = mVolumeFaces[i];
+        if (dst_face.mPositions && dst_face.mExtents)
+        {
+            if (!rigged_face_count)
             {
-                dst_face.destroyOctree();
-                // <FS:ND> Create a debug log for octree insertions if requested.
-                static LLCachedControl<bool> debugOctree(gSavedSettings,"FSCreateOctreeLog");
-                bool _debugOT( debugOctree );
-                if( _debugOT )
-                    nd::octree::debug::gOctreeDebug += 1;
-                // </FS:ND>
-
-                dst_face.createOctree();
-
-                // <FS:ND> Reset octree log
-                if( _debugOT )
-                    nd::octree::debug::gOctreeDebug -= 1;
-                // </FS:ND>
+                box_min = dst_face.mExtents[0];
+                box_max = dst_face.mExtents[1];
             }
+            rigged_vert_count += dst_face.mNumVertices;
+            rigged_face_count++;
+            box_min.setMin(dst_face.mExtents[0], box_min);
+            box_max.setMax(dst_face.mExtents[1], box_max);
         }
     }
     mExtraDebugText = llformat("rigged %d/%d - box (%f %f %f) (%f %f %f)",
@@ -5548,6 +5539,117 @@ void LLVolumeGeometryManager::freeFaces()
     }
 }
 
+namespace
+{
+    // A face whose vertex data genDrawInfo() left to the build batch. The
+    // transforms are copied, animated children only have theirs set up
+    // around genDrawInfo().
+    struct BuildJob
+    {
+        LLPointer<LLDrawable> mDrawable;
+        LLFace* mFace;
+        LLPointer<LLVolume> mVolume;
+        LLPointer<LLVertexBuffer> mBuffer;
+        LLMatrix4 mVertexMatrix;
+        LLMatrix3 mNormalMatrix;
+        S32 mTEOffset;
+        U16 mIndexOffset;
+    };
+
+    void build_job(const BuildJob& job)
+    {
+        // skip faces rebuilt again into another buffer since
+        if (!job.mDrawable->isDead() && job.mFace->getVertexBuffer() == job.mBuffer)
+        {
+            if (!job.mFace->getGeometryVolume(*job.mVolume, job.mTEOffset,
+                job.mVertexMatrix, job.mNormalMatrix, job.mIndexOffset, true))
+            {
+                LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
+            }
+        }
+    }
+
+    bool sBatchingBuilds = false;
+    std::vector<BuildJob> sBuildJobs;
+    std::vector<LLPointer<LLVertexBuffer> > sBuildBuffers;
+}
+
+// static
+void LLVolumeGeometryManager::initClass()
+{
+    // the main thread takes a share of every build batch too
+    S32 build_threads = (S32)gSavedSettings.getU32("FSGeometryBuildThreads");
+    if (build_threads == 0)
+    {
+        build_threads = llclamp((S32)std::thread::hardware_concurrency() / 2 - 1, 0, 4);
+    }
+    if (build_threads > 0 && !sBuildThreadPool)
+    {
+        sBuildThreadPool.reset(new LL::ThreadPool("GeometryBuild", llmin(build_threads, 16)));
+        sBuildThreadPool->start();
+    }
+}
+
+// static
+void LLVolumeGeometryManager::cleanupClass()
+{
+    sBuildJobs.clear();
+    sBuildBuffers.clear();
+    if (sBuildThreadPool)
+    {
+        sBuildThreadPool->close();
+        sBuildThreadPool.reset();
+    }
+}
+
+// static
+void LLVolumeGeometryManager::startBuildBatch()
+{
+    sBatchingBuilds = true;
+}
+
+// static
+void LLVolumeGeometryManager::finishBuildBatch()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+    sBatchingBuilds = false;
+    if (sBuildJobs.empty())
+    {
+        sBuildBuffers.clear();
+        return;
+    }
+
+    LLTimer build_timer;
+    const size_t face_count = sBuildJobs.size();
+
+    // Nothing else runs on the main thread until the batch is done, so the
+    // faces and their buffers' staging memory are all the workers touch.
+    constexpr size_t FACES_PER_HELPER = 8;
+    if (sBuildThreadPool && face_count > FACES_PER_HELPER)
+    {
+        LL::parallel_for(*sBuildThreadPool, face_count, [](size_t i) { build_job(sBuildJobs[i]); },
+                         face_count / FACES_PER_HELPER);
+    }
+    else
+    {
+        for (const BuildJob& job : sBuildJobs)
+        {
+            build_job(job);
+        }
+    }
+    sBuildJobs.clear();
+
+    // hand the buffers back to flushBuffers() for upload
+    for (LLVertexBuffer* buffer : sBuildBuffers)
+    {
+        buffer->finishWorkerFill();
+    }
+    sBuildBuffers.clear();
+
+    add(LLStatViewer::GEOMETRY_FACES_BUILT, (F64)face_count);
+    record(LLStatViewer::GEOMETRY_BUILD_TIME, F64Seconds(build_timer.getElapsedTimeF64()));
+}
+
 void LLVolumeGeometryManager::registerFace(LLSpatialGroup* group, LLFace* facep, U32 type)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
@@ -6802,6 +6904,7 @@ U32 LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace
 
         U32 indices_index = 0;
         U16 index_offset = 0;
+        bool worker_fill = false;
 
         while (face_iter < i)
         {
@@ -6841,7 +6944,18 @@ U32 LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace
 
                     U32 te_idx = facep->getTEOffset();
 
-                    if (!facep->getGeometryVolume(*volume, te_idx,
+                    if (sBatchingBuilds && facep->prepareGeometryVolume(te_idx))
+                    {
+                        if (!worker_fill)
+                        {
+                            buffer->beginWorkerFill();
+                            sBuildBuffers.push_back(buffer);
+                            worker_fill = true;
+                        }
+                        sBuildJobs.push_back({ drawablep, facep, volume, buffer,
+                            vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), (S32)te_idx, index_offset });
+                    }
+                    else if (!facep->getGeometryVolume(*volume, te_idx,
                         vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), index_offset,true))
                     {
                         LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
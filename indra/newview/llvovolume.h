@@ -34,6 +34,7 @@
 #include "lllocalbitmaps.h"
 #include "m3math.h"     // LLMatrix3
 #include "m4math.h"     // LLMatrix4
+#include "llskinningbatch.h"
 #include <unordered_map>
 #include <unordered_set>
 
@@ -74,10 +75,13 @@ public:
         const LLMeshSkinInfo* skin,
         LLVOAvatar* avatar,
         const LLVolume* src_volume,
-        FaceIndex face_index = UPDATE_ALL_FACES,
-        bool rebuild_face_octrees = true);
+        FaceIndex face_index = UPDATE_ALL_FACES);
 
     std::string mExtraDebugText;
+
+private:
+    // per face, vertices grouped by joint influence
+    std::vector<LLSkinningBatch> mSkinningBatches;
 };
 
 // Base class for implementations of the volume - Primitive, Flexible Object, etc.
@@ -198,7 +202,9 @@ public:
     /*virtual*/ U32     processUpdateMessage(LLMessageSystem *mesgsys,
                                             void **user_data,
                                             U32 block_num, const EObjectUpdateType update_type,
-                                            LLDataPacker *dp) override;
+                                            LLDataPacker *dp,
+                                            const LLObjectUpdatePacket* packet = NULL,
+                                            const LLObjectUpdatePacket::FullUpdate* full_update = NULL) override;
 
     /*virtual*/ void    setSelected(bool sel) override;
     /*virtual*/ bool    setDrawableParent(LLDrawable* parentp) override;
@@ -410,11 +416,11 @@ public:
 
 
     // Rigged volume update (for raycasting)
-    // By default, this updates the bounding boxes of all the faces and builds an octree for precise per-triangle raycasting
+    // By default, this updates the bounding boxes of all the faces. Face octrees for precise per-triangle
+    // raycasting are dropped and built again by the first raycast that reaches the face.
     void updateRiggedVolume(
         bool force_treat_as_rigged,
-        LLRiggedVolume::FaceIndex face_index = LLRiggedVolume::UPDATE_ALL_FACES,
-        bool rebuild_face_octrees = true);
+        LLRiggedVolume::FaceIndex face_index = LLRiggedVolume::UPDATE_ALL_FACES);
     LLRiggedVolume* getRiggedVolume();
 
     //returns true if volume should be treated as a rigged volume
@@ -461,6 +461,7 @@ void LLPipeline::init()
     gOctreeMaxCapacity = gSavedSettings.getU32("OctreeMaxNodeCapacity");
     gOctreeMinSize = gSavedSettings.getF32("OctreeMinimumNodeSize");
     sDynamicLOD = gSavedSettings.getBOOL("RenderDynamicLOD");
+    LLVolumeFace::setRaycastBVH(gSavedSettings.getBOOL("FSRaycastBVH")); // <FS> Face BVH for picking
     sRenderAttachedLights = gSavedSettings.getBOOL("RenderAttachedLights");
     sRenderAttachedParticles = gSavedSettings.getBOOL("RenderAttachedParticles");
 
@@ -3711,6 +3712,9 @@ void LLPipeline::postSort(LLCamera &camera)
 
     if (!gCubeSnapshot)
     {
+        // face vertex data gets packed on the build pool, see finishBuildBatch() below
+        LLVolumeGeometryManager::startBuildBatch();
+
         // rebuild drawable geometry
         for (LLCullResult::sg_iterator i = sCull->beginDrawableGroups(); i != sCull->endDrawableGroups(); ++i)
         {
@@ -3831,6 +3835,8 @@ void LLPipeline::postSort(LLCamera &camera)
         glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, mMeshDirtyQueryObject);
     }*/
 
+    LLVolumeGeometryManager::finishBuildBatch();
+
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_PIPELINE("rebuild delayed upd groups");
     // pack vertex buffers for groups that chose to delay their updates
@@ -0,0 +1,884 @@
+/**
+ * @file llobjectupdatequeue_test.cpp
+ * @brief LLObjectUpdateQueue tests and object update replay benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+// Precompiled header: almost always required for newview cpp files
+#include "../llviewerprecompiledheaders.h"
+// Class to test
+#include "../llobjectupdatequeue.h"
+// Dependencies
+#include "lldatapacker.h"
+#include "llprimitive.h"
+#include "llquantize.h"
+#include "lltimer.h"
+#include "llvolume.h"
+#include "llvolumemessage.h"
+#include "material_codes.h"
+#include "object_flags.h"
+#include "workqueue.h"
+
+// Tut header
+#include "../test/lltut.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    const LLHost SIM(0x0100007f, 13005);
+
+    void put_u32(U8* data, U32 value)
+    {
+        for (S32 i = 0; i < 4; ++i)
+        {
+            data[i] = (U8)(value >> (8 * i));
+        }
+    }
+
+    // A compressed full update: ID, LocalID and PCode, then filler
+    std::vector<U8> full_block(const LLUUID& id, U32 local_id, LLPCode pcode, U32 size)
+    {
+        std::vector<U8> data(llmax(size, 21u));
+        for (U32 i = 0; i < data.size(); ++i)
+        {
+            data[i] = (U8)(i * 7);
+        }
+        memcpy(data.data(), id.mData, UUID_BYTES);
+        put_u32(data.data() + 16, local_id);
+        data[20] = pcode;
+        data.resize(size);
+        return data;
+    }
+
+    std::vector<U8> terse_block(U32 local_id, U32 size)
+    {
+        std::vector<U8> data(size, 0x5a);
+        put_u32(data.data(), local_id);
+        return data;
+    }
+
+    // A terse update as the simulator packs it, with a texture entry
+    // field when te is not empty
+    std::vector<U8> encode_terse_block(U32 local_id, const LLVector4* foot_plane, const LLVector3& pos,
+                                       const LLVector3& vel, const LLQuaternion& rot)
+    {
+        U8 buffer[64];
+        LLDataPackerBinaryBuffer dp(buffer, sizeof(buffer));
+        dp.packU32(local_id, "LocalID");
+        dp.packU8(3, "State");
+        dp.packU8(foot_plane ? 1 : 0, "agent");
+        if (foot_plane)
+        {
+            dp.packVector4(*foot_plane, "Plane");
+        }
+        dp.packVector3(pos, "Pos");
+        for (S32 i = 0; i < 3; ++i)
+        {
+            dp.packU16(F32_to_U16(vel.mV[i], -128.f, 128.f), "Vel");
+        }
+        for (S32 i = 0; i < 3; ++i)
+        {
+            dp.packU16(F32_to_U16(1.f, -64.f, 64.f), "Acc");
+        }
+        for (S32 i = 0; i < 4; ++i)
+        {
+            dp.packU16(F32_to_U16(rot.mQ[i], -1.f, 1.f), "Theta");
+        }
+        for (S32 i = 0; i < 3; ++i)
+        {
+            dp.packU16(F32_to_U16(-2.f, -64.f, 64.f), "Omega");
+        }
+        return std::vector<U8>(buffer, buffer + dp.getCurrentSize());
+    }
+
+    // Texture entry field: every face gets image, face 1 other_image, then
+    // defaults for the rest, size prefixed like the simulator sends it
+    std::vector<U8> encode_texture_entry(const LLUUID& image, const LLUUID& other_image)
+    {
+        std::vector<U8> te(4);
+        auto put = [&te](const void* data, size_t size) { te.insert(te.end(), (const U8*)data, (const U8*)data + size); };
+        const U8 end = 0;
+        const U8 face_1 = 0x02;
+        put(image.mData, UUID_BYTES);
+        put(&face_1, 1);
+        put(other_image.mData, UUID_BYTES);
+        put(&end, 1);
+        const U8 color[4] = { 0, 0, 0, 0 };
+        put(color, sizeof(color));
+        put(&end, 1);
+        const F32 scale = 1.f;
+        put(&scale, sizeof(scale));
+        put(&end, 1);
+        put(&scale, sizeof(scale));
+        put(&end, 1);
+        const S16 offset = 0;
+        for (S32 i = 0; i < 3; ++i)     // offsets and rotation
+        {
+            put(&offset, sizeof(offset));
+            put(&end, 1);
+        }
+        const U8 bump = 0;
+        put(&bump, 1);
+        put(&end, 1);
+        put(&bump, 1);                  // media
+        put(&end, 1);
+        put(&bump, 1);                  // glow, the last field is not terminated
+        put_u32(te.data(), (U32)te.size() - 4);
+        return te;
+    }
+
+    LLUUID make_id(U32 seed)
+    {
+        LLUUID id;
+        for (S32 i = 0; i < UUID_BYTES; ++i)
+        {
+            id.mData[i] = (U8)(seed * 31 + i * 17);
+        }
+        return id;
+    }
+
+    // A volume as the simulator packs it in an ObjectUpdateCompressed,
+    // with its parent and hover text. Cut short by cut bytes.
+    std::vector<U8> encode_compressed_block(const LLUUID& id, U32 local_id, const LLVolumeParams& volume,
+                                            const std::vector<U8>& te, U32 cut = 0)
+    {
+        U8 buffer[512];
+        LLDataPackerBinaryBuffer dp(buffer, sizeof(buffer));
+        dp.packUUID(id, "ID");
+        dp.packU32(local_id, "LocalID");
+        dp.packU8(LL_PCODE_VOLUME, "PCode");
+        dp.packU8(0, "State");
+        dp.packU32(77, "CRC");
+        dp.packU8(LL_MCODE_WOOD, "Material");
+        dp.packU8(0, "ClickAction");
+        dp.packVector3(LLVector3(1.f, 2.f, 3.f), "Scale");
+        dp.packVector3(LLVector3(10.f, 20.f, 30.f), "Pos");
+        dp.packVector3(LLQuaternion::DEFAULT.packToVector3(), "Rot");
+        dp.packU32(0x20 | 0x4, "SpecialCode");
+        dp.packUUID(make_id(100), "Owner");
+        dp.packU32(3, "ParentID");
+        dp.packString("hover", "Text");
+        const U8 color[4] = { 255, 0, 0, 255 };
+        dp.packBinaryDataFixed(color, 4, "Color");
+        dp.packU8(0, "num_params");
+        LLVolumeMessage::packVolumeParams(&volume, dp);
+        // the texture entry helper already has the size ahead of it
+        std::vector<U8> data(buffer, buffer + dp.getCurrentSize());
+        data.insert(data.end(), te.begin(), te.end());
+        data.resize(data.size() - cut);
+        return data;
+    }
+
+    // The fields LLObjectUpdatePacket::addMessageBlock() copies out of an
+    // ObjectUpdate block, each with its size ahead of it
+    enum EFullField
+    {
+        FF_ID = 0,
+        FF_FULL_ID = 2,
+        FF_PCODE = 4,
+        FF_SCALE = 7,
+        FF_OBJECT_DATA = 8,
+        FF_PARENT_ID = 9,
+        FF_UPDATE_FLAGS = 10,
+        FF_PATH_CURVE = 11,
+        FF_TEXTURE_ENTRY = 29,
+        FF_TEXTURE_ANIM = 30,
+        FF_TEXT = 33,
+        FF_OWNER_ID = 39,
+        FF_COUNT = 43
+    };
+
+    std::vector<U8> encode_full_block(const std::vector<std::vector<U8> >& fields)
+    {
+        std::vector<U8> data;
+        for (const std::vector<U8>& field : fields)
+        {
+            const U16 size = (U16)field.size();
+            data.push_back((U8)size);
+            data.push_back((U8)(size >> 8));
+            data.insert(data.end(), field.begin(), field.end());
+        }
+        return data;
+    }
+
+    template <typename T>
+    std::vector<U8> field_of(const T& value)
+    {
+        return std::vector<U8>((const U8*)&value, (const U8*)&value + sizeof(T));
+    }
+
+    std::shared_ptr<LLObjectUpdatePacket> terse_packet(U32 local_id, bool texture_entry = false)
+    {
+        auto packet = std::make_shared<LLObjectUpdatePacket>(LLObjectUpdatePacket::TERSE, 1, 65535, SIM, 1);
+        std::vector<U8> data = terse_block(local_id, 60);
+        U8 te[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+        packet->addBlock(data.data(), (U32)data.size(), 0, texture_entry ? te : nullptr, texture_entry ? sizeof(te) : 0);
+        return packet;
+    }
+
+    // Roughly a region arrival: full updates for every prim, a few
+    // temporary, followed by a stream of terse updates for the moving ones
+    std::vector<std::shared_ptr<LLObjectUpdatePacket> > make_arrival(U32 prims, U32 seed)
+    {
+        auto next = [&seed]() { seed = seed * 1664525 + 1013904223; return seed >> 8; };
+
+        std::vector<std::shared_ptr<LLObjectUpdatePacket> > packets;
+        U32 packet_id = 1;
+        for (U32 prim = 0; prim < prims; )
+        {
+            auto packet = std::make_shared<LLObjectUpdatePacket>(LLObjectUpdatePacket::COMPRESSED, 1, 65535, SIM, packet_id++);
+            for (U32 i = 0; i < 6 && prim < prims; ++i, ++prim)
+            {
+                U32 flags = next() % 50 ? 0 : FLAGS_TEMPORARY_ON_REZ;
+                std::vector<U8> data = full_block(make_id(prim), prim + 1, LL_PCODE_VOLUME, 80 + next() % 300);
+                packet->addBlock(data.data(), (U32)data.size(), flags);
+            }
+            packets.push_back(packet);
+        }
+        for (U32 terse = 0; terse < prims / 4; )
+        {
+            auto packet = std::make_shared<LLObjectUpdatePacket>(LLObjectUpdatePacket::TERSE, 1, 65535, SIM, packet_id++);
+            for (U32 i = 0; i < 20 && terse < prims / 4; ++i, ++terse)
+            {
+                std::vector<U8> data = terse_block(next() % (prims / 20) + 1, 44);
+                packet->addBlock(data.data(), (U32)data.size(), 0);
+            }
+            packets.push_back(packet);
+        }
+        return packets;
+    }
+
+    // A capture the viewer wrote with FSObjectUpdateCapture, the packets
+    // of each frame it was handled in
+    std::vector<std::vector<std::shared_ptr<LLObjectUpdatePacket> > > load_capture(const char* filename)
+    {
+        std::vector<std::vector<std::shared_ptr<LLObjectUpdatePacket> > > frames;
+        std::ifstream in(filename, std::ios::binary);
+        if (LLObjectUpdatePacket::readHeader(in))
+        {
+            U32 arrival_ms = 0;
+            U32 frame_ms = 0;
+            while (auto packet = LLObjectUpdatePacket::read(in, arrival_ms))
+            {
+                if (frames.empty() || arrival_ms != frame_ms)
+                {
+                    frames.emplace_back();
+                    frame_ms = arrival_ms;
+                }
+                frames.back().push_back(packet);
+            }
+        }
+        return frames;
+    }
+
+    // copies, the way the viewer copies them out of the message system
+    std::vector<std::shared_ptr<LLObjectUpdatePacket> > copy_packets(const std::vector<std::shared_ptr<LLObjectUpdatePacket> >& packets)
+    {
+        std::vector<std::shared_ptr<LLObjectUpdatePacket> > copies;
+        copies.reserve(packets.size());
+        for (const auto& packet : packets)
+        {
+            auto copy = std::make_shared<LLObjectUpdatePacket>(packet->getType(), packet->getRegionHandle(),
+                packet->getTimeDilation(), packet->getSender(), packet->getPacketID());
+            for (U32 i = 0; i < packet->getBlockCount(); ++i)
+            {
+                const LLObjectUpdatePacket::Block& block = packet->getBlock(i);
+                copy->addBlock(packet->getData(block), block.mDataSize, block.mUpdateFlags,
+                    packet->getTextureEntry(block), block.mTextureEntrySize);
+            }
+            copies.push_back(copy);
+        }
+        return copies;
+    }
+
+    struct FrameStats
+    {
+        std::vector<F64> mFrames;   // main thread seconds per frame
+
+        void print(const char* name) const
+        {
+            std::vector<F64> sorted = mFrames;
+            std::sort(sorted.begin(), sorted.end());
+            F64 total = 0.0;
+            for (F64 frame : sorted)
+            {
+                total += frame;
+            }
+            std::cout << "\n  " << name << ": total " << total * 1000.0
+                      << " ms, mean " << total * 1000.0 / sorted.size()
+                      << " ms, p99 " << sorted[sorted.size() * 99 / 100] * 1000.0
+                      << " ms, worst " << sorted.back() * 1000.0 << " ms";
+        }
+    };
+
+    template <typename CALLABLE>
+    F64 time_of(CALLABLE&& callable)
+    {
+        auto start = std::chrono::steady_clock::now();
+        callable();
+        return std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+namespace tut
+{
+    struct objectupdatequeue_data
+    {
+    };
+    typedef test_group<objectupdatequeue_data> objectupdatequeue_test;
+    typedef objectupdatequeue_test::object objectupdatequeue_object;
+    tut::objectupdatequeue_test objectupdatequeue_testcase("LLObjectUpdateQueue");
+
+    template<> template<>
+    void objectupdatequeue_object::test<1>()
+    {
+        set_test_name("blocks are sorted by what the main thread does with them");
+
+        LLObjectUpdatePacket packet(LLObjectUpdatePacket::COMPRESSED, 1, 65535, SIM, 1);
+        std::vector<U8> cached = full_block(make_id(1), 11, LL_PCODE_VOLUME, 120);
+        std::vector<U8> temporary = full_block(make_id(2), 12, LL_PCODE_VOLUME, 120);
+        std::vector<U8> no_pcode = full_block(make_id(3), 13, 0, 120);
+        std::vector<U8> too_short = full_block(make_id(4), 14, LL_PCODE_VOLUME, 20);
+        std::vector<U8> too_long = full_block(make_id(5), 15, LL_PCODE_VOLUME, 3000);
+        packet.addBlock(cached.data(), (U32)cached.size(), 0);
+        packet.addBlock(temporary.data(), (U32)temporary.size(), FLAGS_TEMPORARY_ON_REZ | FLAGS_PHANTOM);
+        packet.addBlock(no_pcode.data(), (U32)no_pcode.size(), 0);
+        packet.addBlock(too_short.data(), (U32)too_short.size(), 0);
+        packet.addBlock(too_long.data(), (U32)too_long.size(), 0);
+
+        ensure_equals("local id", packet.getBlock(1).mLocalID, 12u);
+        ensure_equals("cached", packet.getBlock(0).mAction, LLObjectUpdatePacket::CACHE);
+        ensure_equals("cached id", packet.getBlock(0).mFullID, make_id(1));
+        ensure_equals("cached pcode", packet.getBlock(0).mPCode, (LLPCode)LL_PCODE_VOLUME);
+        ensure_equals("temporary", packet.getBlock(1).mAction, LLObjectUpdatePacket::APPLY);
+        ensure_equals("temporary id", packet.getBlock(1).mFullID, make_id(2));
+        ensure_equals("no pcode", packet.getBlock(2).mAction, LLObjectUpdatePacket::NO_PCODE);
+        ensure_equals("too short", packet.getBlock(3).mAction, LLObjectUpdatePacket::BAD);
+        ensure_equals("truncated", packet.getBlock(4).mDataSize, LLObjectUpdatePacket::MAX_DATA_SIZE);
+        ensure_equals("truncated still decoded", packet.getBlock(4).mAction, LLObjectUpdatePacket::CACHE);
+        ensure("data kept", !memcmp(packet.getData(packet.getBlock(1)), temporary.data(), temporary.size()));
+
+        LLObjectUpdatePacket terse(LLObjectUpdatePacket::TERSE, 1, 65535, SIM, 2);
+        std::vector<U8> moving = terse_block(21, 44);
+        std::vector<U8> texture_entry(1500, 3);
+        terse.addBlock(moving.data(), (U32)moving.size(), 0, texture_entry.data(), (U32)texture_entry.size());
+        terse.addBlock(moving.data(), 3, 0);
+        ensure_equals("terse", terse.getBlock(0).mAction, LLObjectUpdatePacket::APPLY);
+        ensure_equals("terse local id", terse.getBlock(0).mLocalID, 21u);
+        ensure_equals("texture entry truncated", terse.getBlock(0).mTextureEntrySize, LLObjectUpdatePacket::MAX_TEXTURE_ENTRY_SIZE);
+        ensure_equals("terse too short", terse.getBlock(1).mAction, LLObjectUpdatePacket::BAD);
+    }
+
+    template<> template<>
+    void objectupdatequeue_object::test<2>()
+    {
+        set_test_name("capture files read back the same packets");
+
+        std::vector<std::shared_ptr<LLObjectUpdatePacket> > packets = make_arrival(200, 1);
+        packets.push_back(terse_packet(7, true));
+
+        std::stringstream capture;
+        LLObjectUpdatePacket::writeHeader(capture);
+        for (size_t i = 0; i < packets.size(); ++i)
+        {
+            packets[i]->write(capture, (U32)i / 3);
+        }
+
+        ensure("header", LLObjectUpdatePacket::readHeader(capture));
+        for (size_t p = 0; p < packets.size(); ++p)
+        {
+            const auto& packet = packets[p];
+            U32 arrival_ms = 0;
+            auto copy = LLObjectUpdatePacket::read(capture, arrival_ms);
+            ensure("read", copy != nullptr);
+            ensure_equals("arrival", arrival_ms, (U32)p / 3);
+            ensure_equals("type", copy->getType(), packet->getType());
+            ensure_equals("region", copy->getRegionHandle(), packet->getRegionHandle());
+            ensure_equals("sender", copy->getSender(), packet->getSender());
+            ensure_equals("packet id", copy->getPacketID(), packet->getPacketID());
+            ensure_equals("blocks", copy->getBlockCount(), packet->getBlockCount());
+            for (U32 i = 0; i < packet->getBlockCount(); ++i)
+            {
+                const LLObjectUpdatePacket::Block& block = packet->getBlock(i);
+                const LLObjectUpdatePacket::Block& copied = copy->getBlock(i);
+                ensure_equals("flags", copied.mUpdateFlags, block.mUpdateFlags);
+                ensure_equals("local id", copied.mLocalID, block.mLocalID);
+                ensure("data", copied.mDataSize == block.mDataSize
+                    && !memcmp(copy->getData(copied), packet->getData(block), block.mDataSize));
+                ensure("texture entry", copied.mTextureEntrySize == block.mTextureEntrySize
+                    && !memcmp(copy->getTextureEntry(copied), packet->getTextureEntry(block), block.mTextureEntrySize));
+            }
+        }
+        U32 arrival_ms = 0;
+        ensure("end of capture", !LLObjectUpdatePacket::read(capture, arrival_ms));
+
+        std::stringstream bogus("not a capture");
+        ensure("bad header", !LLObjectUpdatePacket::readHeader(bogus));
+    }
+
+    template<> template<>
+    void objectupdatequeue_object::test<3>()
+    {
+        set_test_name("queue keeps order and tracks pending objects");
+
+        LLObjectUpdateQueue queue;
+        auto first = terse_packet(5);
+        auto with_texture = terse_packet(5, true);
+        auto second = terse_packet(5);
+        auto third = terse_packet(5);
+        auto other = terse_packet(6);
+
+        queue.push(first);
+        U32 first_sequence = queue.getFrontSequence();
+        queue.push(with_texture);
+        queue.push(second);
+        queue.push(other);
+        queue.push(third);
+
+        ensure_equals("size", queue.size(), 5u);
+        ensure_equals("pending up to the last one", queue.getPendingSequence(SIM, 5), first_sequence + 4);
+        ensure_equals("other object", queue.getPendingSequence(SIM, 6), first_sequence + 3);
+        ensure_equals("other sim", queue.getPendingSequence(LLHost(0x0100007f, 13006), 5), 0u);
+        ensure_equals("nothing for it", queue.getPendingSequence(SIM, 7), 0u);
+
+        // a texture entry is not in the newer update, so that one stays
+        ensure("first stays", !first->getBlock(0).mSuperseded);
+        ensure("texture entry stays", !with_texture->getBlock(0).mSuperseded);
+        ensure("replaced by the third", second->getBlock(0).mSuperseded);
+        ensure("newest stays", !third->getBlock(0).mSuperseded);
+        ensure_equals("superseded count", queue.getSupersededCount(), 1u);
+
+        ensure("front", queue.front() == first.get());
+        queue.pop();
+        ensure_equals("front sequence", queue.getFrontSequence(), first_sequence + 1);
+        queue.pop();
+        queue.pop();
+        queue.pop();
+        ensure_equals("other applied", queue.getPendingSequence(SIM, 6), 0u);
+        ensure_equals("still pending", queue.getPendingSequence(SIM, 5), first_sequence + 4);
+
+        // the last terse block is gone from the queue, nothing to replace
+        queue.pop();
+        ensure("empty", queue.empty());
+        ensure_equals("none pending", queue.getPendingSequence(SIM, 5), 0u);
+        auto fourth = terse_packet(5);
+        auto fifth = terse_packet(5);
+        queue.push(fourth);
+        queue.push(fifth);
+        ensure("replaced after the pop", fourth->getBlock(0).mSuperseded);
+        ensure("the older one is untouched", !third->getBlock(0).mSuperseded);
+
+        queue.clear();
+        ensure("cleared", queue.empty() && !queue.front());
+        ensure_equals("nothing pending", queue.getPendingSequence(SIM, 5), 0u);
+    }
+
+    template<> template<>
+    void objectupdatequeue_object::test<4>()
+    {
+        set_test_name("apply resumes a packet cut short and skips superseded blocks");
+
+        LLObjectUpdateQueue queue;
+        auto packet = std::make_shared<LLObjectUpdatePacket>(LLObjectUpdatePacket::TERSE, 1, 65535, SIM, 1);
+        for (U32 local_id = 1; local_id <= 3; ++local_id)
+        {
+            std::vector<U8> data = terse_block(local_id, 44);
+            packet->addBlock(data.data(), (U32)data.size(), 0);
+        }
+        auto newer = terse_packet(2);
+        auto last = terse_packet(9);
+        queue.push(packet);
+        queue.push(newer);
+        queue.push(last);
+        ensure("replaced", packet->getBlock(1).mSuperseded);
+
+        std::vector<U32> applied;
+        auto record = [&](const LLObjectUpdatePacket& p, U32 index) { applied.push_back(p.getBlock(index).mLocalID); };
+
+        // out of time after every block
+        LLTimer timer;
+        ensure_equals("one block", queue.apply(record, queue.getEndSequence(), &timer, -1.f), 1u);
+        ensure("packet kept", queue.front() == packet.get());
+        ensure_equals("next block, superseded one skipped", queue.apply(record, queue.getEndSequence(), &timer, -1.f), 1u);
+        ensure("packet done", queue.front() == newer.get());
+
+        // only up to the given sequence
+        ensure_equals("until", queue.apply(record, queue.getFrontSequence() + 1), 1u);
+        ensure("last left", queue.front() == last.get());
+        ensure_equals("rest", queue.apply(record, queue.getEndSequence()), 1u);
+        ensure("drained", queue.empty());
+
+        ensure_equals("applied", applied.size(), (size_t)4);
+        ensure("in order", applied[0] == 1 && applied[1] == 3 && applied[2] == 2 && applied[3] == 9);
+    }
+
+    template<> template<>
+    void objectupdatequeue_object::test<5>()
+    {
+        set_test_name("terse blocks decode into what processUpdateMessage() reads");
+
+        const LLVector4 foot_plane(0.f, 0.f, 1.f, -22.5f);
+        const LLVector3 pos(128.25f, 64.5f, 22.75f);
+        const LLVector3 vel(3.f, -1.5f, 0.25f);
+        LLQuaternion rot(F_PI_BY_TWO, LLVector3::z_axis);
+        const LLUUID image = make_id(10);
+        const LLUUID other_image = make_id(11);
+
+        LLObjectUpdatePacket packet(LLObjectUpdatePacket::TERSE, 1, 65535, SIM, 1);
+        std::vector<U8> avatar = encode_terse_block(31, &foot_plane, pos, vel, rot);
+        std::vector<U8> prim = encode_terse_block(32, nullptr, pos, vel, rot);
+        std::vector<U8> te = encode_texture_entry(image, other_image);
+        std::vector<U8> bad_te(te.begin(), te.begin() + 10);
+        packet.addBlock(avatar.data(), (U32)avatar.size(), 0);
+        packet.addBlock(prim.data(), (U32)prim.size(), 0, te.data(), (U32)te.size());
+        packet.addBlock(prim.data(), (U32)prim.size() - 1, 0);
+        packet.addBlock(avatar.data(), (U32)prim.size(), 0);
+        packet.addBlock(prim.data(), (U32)prim.size(), 0, bad_te.data(), (U32)bad_te.size());
+        ensure_equals("sizes", avatar.size(), (size_t)60);
+        ensure_equals("prim size", prim.size(), (size_t)44);
+
+        ensure("not yet", !packet.isDecoded());
+        packet.waitDecoded();
+        ensure("decoded", packet.isDecoded());
+        ensure("only once", !packet.tryDecode());
+
+        const LLObjectUpdatePacket::TerseUpdate* update = packet.getTerseUpdate(0);
+        ensure("avatar", update != nullptr);
+        ensure_equals("state", update->mState, (U8)3);
+        ensure("foot plane", update->mHasFootPlane && update->mFootPlane == foot_plane);
+        ensure("position", update->mPosition == pos);
+        ensure("velocity", dist_vec(update->mVelocity, vel) < 0.01f);
+        ensure("acceleration", dist_vec(update->mAcceleration, LLVector3(1.f, 1.f, 1.f)) < 0.01f);
+        ensure("angular velocity", dist_vec(update->mAngularVelocity, LLVector3(-2.f, -2.f, -2.f)) < 0.01f);
+        ensure("rotation", fabsf(dot(update->mRotation, rot)) > 0.9999f);
+        ensure("no texture entry", !update->mTextureEntry);
+
+        update = packet.getTerseUpdate(1);
+        ensure("prim", update != nullptr && !update->mHasFootPlane && update->mPosition == pos);
+        ensure("texture entry", update->mTextureEntry != nullptr);
+        const LLTEContents& tec = *update->mTextureEntry;
+        ensure_equals("every face", tec.face_count, LLTEContents::MAX_TES);
+        ensure("default image", tec.image_data[0] == image && tec.image_data[2] == image && tec.image_data[LLTEContents::MAX_TES - 1] == image);
+        ensure("face 1", tec.image_data[1] == other_image);
+        ensure_equals("scale", tec.scale_s[5], 1.f);
+
+        // left to the data packer path, which reads what it can
+        ensure("too short", !packet.getTerseUpdate(2));
+        ensure("too short for the foot plane", !packet.getTerseUpdate(3));
+        update = packet.getTerseUpdate(4);
+        ensure("bad texture entry dropped", update && !update->mTextureEntry);
+
+        LLObjectUpdatePacket full(LLObjectUpdatePacket::COMPRESSED, 1, 65535, SIM, 2);
+        std::vector<U8> data = full_block(make_id(1), 11, LL_PCODE_VOLUME, 120);
+        full.addBlock(data.data(), (U32)data.size(), 0);
+        full.waitDecoded();
+        ensure("cached blocks stay raw", !full.getTerseUpdate(0) && !full.getFullUpdate(0));
+    }
+
+    template<> template<>
+    void objectupdatequeue_object::test<6>()
+    {
+        set_test_name("terse packets are decoded by the pool, or by apply()");
+
+        LL::WorkQueue pool("ObjectUpdateQueueTest");
+        std::thread worker([&pool]() { pool.runUntilClose(); });
+
+        LLObjectUpdateQueue queue("ObjectUpdateQueueTest");
+        std::vector<std::shared_ptr<LLObjectUpdatePacket> > packets;
+        std::vector<U8> prim = encode_terse_block(1, nullptr, LLVector3(1.f, 2.f, 3.f), LLVector3::zero, LLQuaternion::DEFAULT);
+        for (U32 i = 0; i < 21; ++i)
+        {
+            auto packet = std::make_shared<LLObjectUpdatePacket>(LLObjectUpdatePacket::TERSE, 1, 65535, SIM, i + 1);
+            for (U32 local_id = 1; local_id <= 10; ++local_id)
+            {
+                put_u32(prim.data(), i * 10 + local_id);
+                packet->addBlock(prim.data(), (U32)prim.size(), 0);
+            }
+            packets.push_back(packet);
+            queue.push(packet);
+        }
+
+        // whatever the worker has not got to, apply() decodes itself
+        U32 applied = queue.apply([](const LLObjectUpdatePacket& packet, U32 index)
+            {
+                ensure("decoded when applied", packet.getTerseUpdate(index) != nullptr);
+                ensure("position", packet.getTerseUpdate(index)->mPosition == LLVector3(1.f, 2.f, 3.f));
+            }, queue.getEndSequence());
+        ensure_equals("applied", applied, 210u);
+
+        pool.close();
+        worker.join();
+        for (const auto& packet : packets)
+        {
+            ensure("all decoded", packet->isDecoded());
+        }
+    }
+
+    template<> template<>
+    void objectupdatequeue_object::test<7>()
+    {
+        set_test_name("captured object update replay");
+
+        // FS_OBJECT_UPDATE_CAPTURE names a file the viewer wrote with
+        // FSObjectUpdateCapture. The packets are replayed in the frames
+        // they were handled in: the main thread time per frame of copying
+        // and decoding them as the message handlers did, against copying
+        // and queuing them for the pool, plus the decoding the pool
+        // had not finished by the end of the frame.
+        const char* capture = getenv("FS_OBJECT_UPDATE_CAPTURE");
+        if (!capture)
+        {
+            skip("set FS_OBJECT_UPDATE_CAPTURE to a capture to replay");
+        }
+        std::vector<std::vector<std::shared_ptr<LLObjectUpdatePacket> > > frames = load_capture(capture);
+        ensure("capture read", !frames.empty());
+
+        U32 packets = 0;
+        std::map<std::string, U32> blocks;
+        for (const auto& frame : frames)
+        {
+            for (const auto& packet : frame)
+            {
+                ++packets;
+                for (U32 i = 0; i < packet->getBlockCount(); ++i)
+                {
+                    const LLObjectUpdatePacket::Block& block = packet->getBlock(i);
+                    ++blocks[packet->isTerse() ? (block.mTextureEntrySize ? "terse with texture entry" : "terse")
+                             : packet->getType() == LLObjectUpdatePacket::FULL ? "full"
+                             : block.mAction == LLObjectUpdatePacket::CACHE ? "compressed, cached" : "compressed, applied"];
+                }
+            }
+        }
+
+        FrameStats inline_decode;
+        for (const auto& frame : frames)
+        {
+            inline_decode.mFrames.push_back(time_of([&]()
+                {
+                    for (const auto& packet : copy_packets(frame))
+                    {
+                        packet->waitDecoded();
+                    }
+                }));
+        }
+
+        LL::WorkQueue pool("ObjectUpdateReplay");
+        std::thread worker([&pool]() { pool.runUntilClose(); });
+        LLObjectUpdateQueue queue("ObjectUpdateReplay");
+        FrameStats pooled_decode;
+        U32 applied = 0;
+        for (const auto& frame : frames)
+        {
+            pooled_decode.mFrames.push_back(time_of([&]()
+                {
+                    for (const auto& packet : copy_packets(frame))
+                    {
+                        queue.push(packet);
+                    }
+                    queue.dispatch();
+                    applied += queue.apply([](const LLObjectUpdatePacket&, U32) {}, queue.getEndSequence());
+                }));
+        }
+        pool.close();
+        worker.join();
+
+        std::cout << "\nObject update replay, " << capture << ", " << frames.size() << " frames, " << packets << " packets:";
+        for (const auto& count : blocks)
+        {
+            std::cout << "\n  " << count.first << ": " << count.second << " blocks";
+        }
+        std::cout << "\n  terse superseded in the queue: " << queue.getSupersededCount()
+                  << "\n  main thread time per frame, applying the blocks not included:";
+        inline_decode.print("decoded by the handlers");
+        pooled_decode.print("decoded by the pool    ");
+        std::cout << std::endl;
+
+        ensure("queue drained", queue.empty());
+    }
+
+    template<> template<>
+    void objectupdatequeue_object::test<8>()
+    {
+        set_test_name("compressed and full blocks decode into what processUpdateMessage() reads");
+
+        LLVolumeParams volume;
+        volume.setType(LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_CIRCLE);
+        const std::vector<U8> te = encode_texture_entry(make_id(10), make_id(11));
+
+        LLObjectUpdatePacket compressed(LLObjectUpdatePacket::COMPRESSED, 1, 65535, SIM, 1);
+        std::vector<U8> prim = encode_compressed_block(make_id(1), 11, volume, te);
+        std::vector<U8> short_tail = encode_compressed_block(make_id(2), 12, volume, te, (U32)te.size() + 5);
+        compressed.addBlock(prim.data(), (U32)prim.size(), FLAGS_TEMPORARY_ON_REZ);
+        compressed.addBlock(short_tail.data(), (U32)short_tail.size(), FLAGS_TEMPORARY_ON_REZ);
+        compressed.addBlock(prim.data(), (U32)prim.size(), 0);
+        compressed.waitDecoded();
+
+        const LLObjectUpdatePacket::FullUpdate* update = compressed.getFullUpdate(0);
+        ensure("compressed", update != nullptr);
+        ensure_equals("crc", update->mCRC, 77u);
+        ensure_equals("material", update->mMaterial, LL_MCODE_WOOD);
+        ensure("scale", update->mScale == LLVector3(1.f, 2.f, 3.f));
+        ensure("position", update->mHasMotion && update->mPosition == LLVector3(10.f, 20.f, 30.f));
+        ensure_equals("parent", update->mParentID, 3u);
+        ensure_equals("owner", update->mOwnerID, make_id(100));
+        ensure("text", update->mHasText && update->mText == "hover" && update->mTextColor.mV[VRED] == 255);
+        ensure("volume", update->mHasVolume && update->mVolumeParamsValid);
+        ensure_equals("path", update->mVolumeParams.getPathParams().getCurveType(), (U8)LL_PCODE_PATH_CIRCLE);
+        ensure_equals("profile", update->mVolumeParams.getProfileParams().getCurveType(), (U8)LL_PCODE_PROFILE_CIRCLE);
+        ensure("texture entry", update->mTextureEntry && update->mTextureEntry->image_data[1] == make_id(11));
+        ensure("no texture animation", !update->mHasTextureAnim);
+        ensure_equals("flags from the block", update->mUpdateFlags, (U32)FLAGS_TEMPORARY_ON_REZ);
+
+        // what reads is kept, the rest is left at its defaults
+        update = compressed.getFullUpdate(1);
+        ensure("short volume tail", update && update->mHasVolume && !update->mVolumeParamsValid);
+        ensure("no texture entry after it", !update->mTextureEntry && update->mTextureEntryInvalid);
+        ensure("cached blocks are the region's", !compressed.getFullUpdate(2));
+
+        // as an object created from the region's cache decodes them
+        LLObjectUpdatePacket::FullUpdate cached;
+        LLDataPackerBinaryBuffer cached_dp(prim.data() + LLObjectUpdatePacket::FULL_HEADER_SIZE,
+                                           (S32)prim.size() - LLObjectUpdatePacket::FULL_HEADER_SIZE);
+        LLObjectUpdatePacket::decodeCompressed(cached_dp, LL_PCODE_VOLUME, cached);
+        ensure("cached decoded", cached.mDecoded && cached.mCRC == 77u && cached.mParentID == 3u);
+        ensure("cached texture entry", cached.mTextureEntry && cached.mTextureEntry->image_data[1] == make_id(11));
+
+        std::vector<std::vector<U8> > fields(FF_COUNT);
+        fields[FF_ID] = field_of((U32)21);
+        fields[FF_FULL_ID] = std::vector<U8>(make_id(3).mData, make_id(3).mData + UUID_BYTES);
+        fields[FF_PCODE] = field_of((U8)LL_PCODE_VOLUME);
+        fields[FF_SCALE] = field_of(LLVector3(4.f, 5.f, 6.f));
+        fields[FF_PARENT_ID] = field_of((U32)0);
+        fields[FF_UPDATE_FLAGS] = field_of((U32)FLAGS_PHANTOM);
+        fields[FF_OWNER_ID] = std::vector<U8>(make_id(101).mData, make_id(101).mData + UUID_BYTES);
+        fields[FF_TEXT] = { 'h', 'i', 0 };
+        // position, velocity, acceleration, rotation and angular velocity
+        std::vector<U8> motion;
+        for (const LLVector3& value : { LLVector3(1.f, 1.f, 1.f), LLVector3(2.f, 0.f, 0.f), LLVector3::zero,
+                                        LLQuaternion::DEFAULT.packToVector3(), LLVector3::zero })
+        {
+            std::vector<U8> bytes = field_of(value);
+            motion.insert(motion.end(), bytes.begin(), bytes.end());
+        }
+        fields[FF_OBJECT_DATA] = motion;
+        U8 volume_data[23];
+        LLDataPackerBinaryBuffer dp(volume_data, sizeof(volume_data));
+        LLVolumeMessage::packVolumeParams(&volume, dp);
+        const U32 volume_sizes[18] = { 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2 };
+        for (U32 i = 0, offset = 0; i < 18; offset += volume_sizes[i], ++i)
+        {
+            fields[FF_PATH_CURVE + i].assign(volume_data + offset, volume_data + offset + volume_sizes[i]);
+        }
+        fields[FF_TEXTURE_ENTRY].assign(te.begin() + 4, te.end());
+        fields[FF_TEXTURE_ANIM] = std::vector<U8>(7, 1);
+        std::vector<U8> full_data = encode_full_block(fields);
+
+        LLObjectUpdatePacket full(LLObjectUpdatePacket::FULL, 1, 65535, SIM, 2);
+        full.addBlock(full_data.data(), (U32)full_data.size(), 0);
+        full.addBlock(full_data.data(), (U32)full_data.size() - 3, 0);
+        const LLObjectUpdatePacket::Block& block = full.getBlock(0);
+        ensure_equals("full is applied", block.mAction, LLObjectUpdatePacket::APPLY);
+        ensure_equals("local id", block.mLocalID, 21u);
+        ensure_equals("id", block.mFullID, make_id(3));
+        ensure_equals("flags from the block", block.mUpdateFlags, (U32)FLAGS_PHANTOM);
+        ensure_equals("cut short", full.getBlock(1).mAction, LLObjectUpdatePacket::BAD);
+        full.waitDecoded();
+
+        update = full.getFullUpdate(0);
+        ensure("full", update != nullptr);
+        ensure("full scale", update->mScale == LLVector3(4.f, 5.f, 6.f));
+        ensure_equals("full flags", update->mUpdateFlags, (U32)FLAGS_PHANTOM);
+        ensure_equals("full motion", update->mMotionSize, 60);
+        ensure("full position", update->mHasMotion && !update->mHasFootPlane && update->mPosition == LLVector3(1.f, 1.f, 1.f));
+        ensure("full velocity", update->mVelocity == LLVector3(2.f, 0.f, 0.f));
+        ensure_equals("full owner", update->mOwnerID, make_id(101));
+        ensure("full text", update->mHasText && update->mText == "hi");
+        ensure("full volume", update->mHasVolume && update->mVolumeParamsValid
+            && update->mVolumeParams.getPathParams().getCurveType() == LL_PCODE_PATH_CIRCLE);
+        ensure("full texture entry", update->mTextureEntry && update->mTextureEntry->image_data[0] == make_id(10));
+        ensure("bad texture animation ignored", update->mHasTextureAnim && update->mTextureAnim.mMode == 0);
+        ensure("no particles", !update->mParticles);
+        ensure("cut short not decoded", !full.getFullUpdate(1));
+    }
+
+    template<> template<>
+    void objectupdatequeue_object::test<9>()
+    {
+        set_test_name("applyPending() applies one object's blocks ahead of the rest");
+
+        LLObjectUpdateQueue queue;
+        auto full = std::make_shared<LLObjectUpdatePacket>(LLObjectUpdatePacket::COMPRESSED, 1, 65535, SIM, 1);
+        std::vector<U8> data = full_block(make_id(2), 12, LL_PCODE_VOLUME, 120);
+        full->addBlock(data.data(), (U32)data.size(), FLAGS_TEMPORARY_ON_REZ);
+        data = full_block(make_id(3), 13, LL_PCODE_VOLUME, 120);
+        full->addBlock(data.data(), (U32)data.size(), FLAGS_TEMPORARY_ON_REZ);
+        auto terse = std::make_shared<LLObjectUpdatePacket>(LLObjectUpdatePacket::TERSE, 1, 65535, SIM, 2);
+        for (U32 local_id : { 13u, 12u })
+        {
+            data = terse_block(local_id, 44);
+            terse->addBlock(data.data(), (U32)data.size(), 0);
+        }
+        queue.push(full);
+        queue.push(terse);
+
+        U32 local_id = 0;
+        ensure_equals("by id", queue.getPendingSequence(SIM, make_id(2), local_id), queue.getFrontSequence() + 1);
+        ensure_equals("its local id", local_id, 12u);
+        ensure_equals("unknown id", queue.getPendingSequence(SIM, make_id(9), local_id), 0u);
+        ensure_equals("other sim", queue.getPendingSequence(LLHost(0x0100007f, 13006), make_id(2), local_id), 0u);
+
+        std::vector<std::pair<U32, U32> > applied;
+        auto record = [&](const LLObjectUpdatePacket& p, U32 index) { applied.emplace_back(p.getPacketID(), p.getBlock(index).mLocalID); };
+
+        // the front packet is part way through
+        LLTimer timer;
+        ensure_equals("first block", queue.apply(record, queue.getEndSequence(), &timer, -1.f), 1u);
+        ensure_equals("object 13", queue.applyPending(SIM, 13, record), 2u);
+        ensure_equals("nothing left for it", queue.getPendingSequence(SIM, 13), 0u);
+        ensure_equals("only once", queue.applyPending(SIM, 13, record), 0u);
+        ensure_equals("other sim untouched", queue.applyPending(LLHost(0x0100007f, 13006), 12, record), 0u);
+        ensure("still pending", queue.getPendingSequence(SIM, 12) != 0);
+
+        // applied ones are skipped, and a later terse update does not
+        // supersede them
+        auto newer = terse_packet(13);
+        queue.push(newer);
+        ensure("applied kept", !terse->getBlock(0).mSuperseded);
+        ensure_equals("the rest", queue.apply(record, queue.getEndSequence()), 2u);
+        ensure("drained", queue.empty());
+
+        ensure_equals("applied", applied.size(), (size_t)5);
+        ensure("front first", applied[0] == std::make_pair(1u, 12u));
+        ensure("object 13 in order", applied[1] == std::make_pair(1u, 13u) && applied[2] == std::make_pair(2u, 13u));
+        ensure("then the queue", applied[3] == std::make_pair(2u, 12u) && applied[4] == std::make_pair(1u, 13u));
+    }
+}
@@ -0,0 +1,239 @@
+/**
+ * @file lltexturepriority_test.cpp
+ * @brief LLTexturePriorityBatch tests and texture priority pass benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+// Precompiled header: almost always required for newview cpp files
+#include "../llviewerprecompiledheaders.h"
+// Class to test
+#include "../lltexturepriority.h"
+// Dependencies
+#include "threadpool.h"
+
+// Tut header
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    struct TestFace
+    {
+        F32  mVirtualSize;
+        F32  mImportance;
+        F32  mCloseToCamera;
+        bool mInFrustum;
+        bool mAnimated;
+    };
+
+    struct TestTexture
+    {
+        F32  mBias;
+        bool mParcelMedia;
+        std::vector<TestFace> mFaces;
+    };
+
+    // Roughly what a busy region looks like: most textures on a few faces,
+    // a handful on hundreds, most faces off screen or far away.
+    std::vector<TestTexture> makeScene(U32 texture_count, U32 face_count, U32 seed)
+    {
+        auto next = [&seed]() { seed = seed * 1664525 + 1013904223; return seed >> 8; };
+        auto unit = [&next]() { return (F32)(next() & 0xffff) / 65535.f; };
+
+        std::vector<TestTexture> scene(texture_count);
+        for (TestTexture& texture : scene)
+        {
+            texture.mBias = 1.f / (F32)(1 << (2 * (next() % 3)));
+            texture.mParcelMedia = next() % 997 == 0;
+        }
+        for (U32 i = 0; i < face_count; ++i)
+        {
+            // skew towards low texture indices
+            U32 t = (U32)(unit() * unit() * texture_count) % texture_count;
+            TestFace face;
+            face.mVirtualSize = unit() * 1024.f * 1024.f;
+            face.mImportance = (next() % 4) ? 0.f : unit();
+            face.mCloseToCamera = (next() % 8) ? 0.f : 1.f;
+            face.mInFrustum = next() % 3 == 0;
+            face.mAnimated = next() % 5003 == 0;
+            scene[t].mFaces.push_back(face);
+        }
+        return scene;
+    }
+
+    void fillBatch(LLTexturePriorityBatch& batch, const std::vector<TestTexture>& scene)
+    {
+        batch.clear();
+        for (const TestTexture& texture : scene)
+        {
+            batch.addTexture(texture.mBias, texture.mParcelMedia);
+            for (const TestFace& face : texture.mFaces)
+            {
+                batch.addFace(face.mVirtualSize, face.mImportance, face.mCloseToCamera, face.mInFrustum, face.mAnimated);
+            }
+        }
+    }
+
+    // The face loop LLViewerTextureList::updateImageDecodePriority() used to run
+    LLTexturePriorityBatch::Result reference(const TestTexture& texture, F32 camera_boost)
+    {
+        LLTexturePriorityBatch::Result result;
+        S32 on_screen_count = 0;
+        F32 close_to_camera = 0.f;
+        F64 animated = 0;
+        for (const TestFace& face : texture.mFaces)
+        {
+            ++result.mFaceCount;
+            F32 vsize = face.mVirtualSize;
+            on_screen_count += face.mInFrustum;
+            animated += S64(face.mAnimated);
+            animated += S64(texture.mParcelMedia);
+            on_screen_count += S32(face.mImportance * 1000.0f);
+            vsize = vsize + (vsize * face.mImportance * camera_boost);
+            vsize = vsize + (vsize * face.mCloseToCamera * camera_boost);
+            close_to_camera += face.mCloseToCamera;
+            result.mMaxOnScreenVirtualSize = llmax(result.mMaxOnScreenVirtualSize, vsize);
+            result.mMaxVirtualSize = llmax(result.mMaxVirtualSize, vsize * texture.mBias);
+        }
+        result.mOnScreen = bool(on_screen_count);
+        result.mCloseToCamera = close_to_camera > 0.f;
+        result.mAnimated = animated != 0;
+        return result;
+    }
+
+    bool close_enough(F32 a, F32 b)
+    {
+        return fabsf(a - b) <= 1e-5f * llmax(fabsf(a), fabsf(b), 1.f);
+    }
+
+    template <typename CALLABLE>
+    F64 best_of(S32 runs, CALLABLE&& callable)
+    {
+        F64 best = 0.0;
+        for (S32 i = 0; i < runs; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            callable();
+            F64 seconds = std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+            best = i ? llmin(best, seconds) : seconds;
+        }
+        return best;
+    }
+}
+
+namespace tut
+{
+    struct texturepriority_data
+    {
+        void ensure_matches(const std::vector<TestTexture>& scene, const LLTexturePriorityBatch& batch, F32 camera_boost)
+        {
+            ensure_equals("texture count", batch.getTextureCount(), (U32)scene.size());
+            for (U32 t = 0; t < scene.size(); ++t)
+            {
+                const LLTexturePriorityBatch::Result& result = batch.getResult(t);
+                LLTexturePriorityBatch::Result expected = reference(scene[t], camera_boost);
+                ensure_equals("face count", result.mFaceCount, expected.mFaceCount);
+                ensure("max vsize", close_enough(result.mMaxVirtualSize, expected.mMaxVirtualSize));
+                ensure("max on screen vsize", close_enough(result.mMaxOnScreenVirtualSize, expected.mMaxOnScreenVirtualSize));
+                ensure_equals("on screen", result.mOnScreen, expected.mOnScreen);
+                ensure_equals("close to camera", result.mCloseToCamera, expected.mCloseToCamera);
+                ensure_equals("animated", result.mAnimated, expected.mAnimated);
+            }
+        }
+    };
+    typedef test_group<texturepriority_data> texturepriority_test;
+    typedef texturepriority_test::object texturepriority_object;
+    tut::texturepriority_test texturepriority_testcase("LLTexturePriorityBatch");
+
+    template<> template<>
+    void texturepriority_object::test<1>()
+    {
+        set_test_name("batch matches the per texture face loop");
+
+        // odd sizes so textures straddle the four wide face groups
+        std::vector<TestTexture> scene = makeScene(257, 3001, 1);
+        scene.push_back(TestTexture{ 0.25f, true, {} }); // no faces is never animated
+        LLTexturePriorityBatch batch;
+        for (F32 camera_boost : { 7.f, 1.f, 0.f })
+        {
+            fillBatch(batch, scene);
+            batch.evaluate(camera_boost);
+            ensure_matches(scene, batch, camera_boost);
+        }
+    }
+
+    template<> template<>
+    void texturepriority_object::test<2>()
+    {
+        set_test_name("thread pool split matches");
+
+        LL::ThreadPool pool("General", 3, 1024, false);
+        pool.start();
+
+        std::vector<TestTexture> scene = makeScene(8000, 100000, 2);
+        LLTexturePriorityBatch batch;
+        fillBatch(batch, scene);
+        batch.evaluate(7.f, 1);
+        ensure_matches(scene, batch, 7.f);
+
+        pool.close();
+    }
+
+    template<> template<>
+    void texturepriority_object::test<3>()
+    {
+        set_test_name("priority pass time for 8k textures and 100k faces");
+
+        skip_unless_benchmarks();
+
+        std::vector<TestTexture> scene = makeScene(8000, 100000, 3);
+        LLTexturePriorityBatch batch;
+        batch.reserve(8000, 100000);
+
+        std::vector<LLTexturePriorityBatch::Result> results(scene.size());
+        F64 scalar = best_of(5, [&]()
+            {
+                for (size_t t = 0; t < scene.size(); ++t)
+                {
+                    results[t] = reference(scene[t], 7.f);
+                }
+            });
+        // filling happens on the main thread in the viewer, so it counts
+        F64 simd = best_of(5, [&]() { fillBatch(batch, scene); batch.evaluate(7.f); });
+        F64 evaluate_only = best_of(5, [&]() { batch.evaluate(7.f); });
+
+        LL::ThreadPool pool("General", 3, 1024, false);
+        pool.start();
+        F64 threaded = best_of(5, [&]() { batch.evaluate(7.f, 1); });
+        pool.close();
+
+        std::cout << "\nTexture priority pass, 8000 textures / 100000 faces:"
+                  << "\n  per texture loop:      " << scalar * 1000.0 << " ms"
+                  << "\n  batch fill + evaluate: " << simd * 1000.0 << " ms"
+                  << "\n  batch evaluate:        " << evaluate_only * 1000.0 << " ms"
+                  << "\n  batch evaluate, pool:  " << threaded * 1000.0 << " ms" << std::endl;
+    }
+}
@@ -142,6 +142,6 @@ namespace tut
         U64 region_handle = to_region_handle(140, 81);
         LLUUID region_id = LLUUID::generateNewID();
 
-        LLVOCache::instance().readGenericExtrasFromCache(region_handle, region_id, extras);
+        LLVOCache::instance().readGenericExtrasFromCache(region_handle, region_id, extras, LLVOCacheEntry::vocache_entry_map_t());
     }
 }
@@ -0,0 +1,320 @@
+/**
+ * @file llvocacheextras_test.cpp
+ * @brief Tests and benchmark for the binary GLTF override cache file.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+// Precompiled header: almost always required for newview cpp files
+#include "../llviewerprecompiledheaders.h"
+// Class to test
+#include "../llvocacheextras.h"
+// Dependencies
+#include "llfile.h"
+#include "llregionhandle.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+
+// Tut header
+#include "../test/lltut.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+//----------------------------------------------------------------------------
+// Stubs: llvocache.cpp is not linked in. These are its LLSD conversions, used
+// to reproduce the version 1 text file the benchmark compares against.
+
+bool LLGLTFOverrideCacheEntry::fromLLSD(const LLSD& data)
+{
+    if (!data.has("local_id") || !data.has("region_handle_x") || !data.has("region_handle_y"))
+    {
+        return false;
+    }
+    mRegionHandle = to_region_handle(data["region_handle_x"].asInteger(), data["region_handle_y"].asInteger());
+    mLocalId = data["local_id"].asInteger();
+    mObjectId = data["object_id"];
+
+    LLSD const& sides = data["sides"];
+    LLSD const& gltf_llsd = data["gltf_llsd"];
+    for (int i = 0; i < sides.size() && i < gltf_llsd.size(); ++i)
+    {
+        S32 side_idx = sides[i].asInteger();
+        mSides[side_idx] = gltf_llsd[i];
+        LLGLTFMaterial* override_mat = new LLGLTFMaterial();
+        override_mat->applyOverrideLLSD(gltf_llsd[i]);
+        mGLTFMaterial[side_idx] = override_mat;
+    }
+    return true;
+}
+
+LLSD LLGLTFOverrideCacheEntry::toLLSD() const
+{
+    LLSD data;
+    U32 region_handle_x, region_handle_y;
+    from_region_handle(mRegionHandle, &region_handle_x, &region_handle_y);
+    data["region_handle_y"] = LLSD::Integer(region_handle_y);
+    data["region_handle_x"] = LLSD::Integer(region_handle_x);
+    data["object_id"] = mObjectId;
+    data["local_id"] = (LLSD::Integer) mLocalId;
+    for (auto const & side : mSides)
+    {
+        data["sides"].append(LLSD::Integer(side.first));
+        data["gltf_llsd"].append(side.second);
+    }
+    return data;
+}
+
+namespace
+{
+    // The busiest regions carry overrides on this many objects
+    const U32 BENCH_OBJECT_COUNT = 15000;
+
+    void makeEntries(std::vector<LLGLTFOverrideCacheEntry>& entries, U32 count)
+    {
+        // A typical override: tinted base color and a texture transform on two faces
+        LLSD override_llsd;
+        override_llsd["bc"] = llsd::array(0.5, 0.25, 1.0, 1.0);
+        override_llsd["ti"][0]["s"] = llsd::array(2.0, 2.0);
+        override_llsd["ti"][0]["o"] = llsd::array(0.5, 0.0);
+
+        entries.resize(count);
+        for (U32 i = 0; i < count; ++i)
+        {
+            LLGLTFOverrideCacheEntry& entry = entries[i];
+            entry.mLocalId = i + 1;
+            entry.mObjectId.generate();
+            entry.mRegionHandle = to_region_handle(256000, 256000);
+            for (S32 side = 0; side < 2; ++side)
+            {
+                entry.mSides[side] = override_llsd;
+                entry.mGLTFMaterial[side] = new LLGLTFMaterial();
+                entry.mGLTFMaterial[side]->applyOverrideLLSD(override_llsd);
+            }
+        }
+    }
+
+    // What LLVOCache::writeGenericExtrasToCache() did with version 1
+    void writeTextFile(const std::string& filename, const LLUUID& region_id, const std::vector<LLGLTFOverrideCacheEntry>& entries)
+    {
+        llofstream out(filename, std::ios::out | std::ios::binary);
+        out << "GLTFCacheVer:1\n";
+        out << region_id << '\n';
+        auto num_entries_placeholder = out.tellp();
+        out << std::setw(10) << std::setfill('0') << 0 << '\n';
+        U32 num_entries = 0;
+        for (auto entry : entries)
+        {
+            LLSD entry_llsd = entry.toLLSD();
+            entry_llsd["local_id"] = (S32)entry.mLocalId;
+            LLSDSerialize::serialize(entry_llsd, out, LLSDSerialize::LLSD_XML);
+            out << '\n';
+            num_entries++;
+        }
+        out.seekp(num_entries_placeholder);
+        out << std::setw(10) << std::setfill('0') << num_entries << '\n';
+    }
+
+    // What LLVOCache::readGenericExtrasFromCache() did with version 1
+    U32 readTextFile(const std::string& filename, const LLUUID& region_id, LLVOCacheEntry::vocache_gltf_overrides_map_t& entries)
+    {
+        llifstream in(filename, std::ios::in | std::ios::binary);
+        std::string line;
+        std::getline(in, line);
+        std::getline(in, line);
+        if (!LLUUID::validate(line) || LLUUID(line) != region_id)
+        {
+            return 0;
+        }
+        std::getline(in, line);
+        U32 num_entries = std::stol(line);
+
+        U32 loaded = 0;
+        LLSD entry_llsd;
+        for (U32 i = 0; i < num_entries && !in.eof(); i++)
+        {
+            if (!LLSDSerialize::deserialize(entry_llsd, in, 4096) || !in)
+            {
+                break;
+            }
+            LLGLTFOverrideCacheEntry entry;
+            entry.fromLLSD(entry_llsd);
+            entries[entry.mLocalId] = std::move(entry);
+            ++loaded;
+        }
+        return loaded;
+    }
+}
+
+namespace tut
+{
+    struct LLVOCacheExtrasFixture
+    {
+        std::string mFilename;
+        LLUUID mRegionID;
+
+        LLVOCacheExtrasFixture()
+        {
+            mFilename = std::string(LLFile::tmpdir()) + "llvocacheextras_test.slc";
+            mRegionID.generate();
+            LLFile::remove(mFilename, ENOENT);
+        }
+
+        ~LLVOCacheExtrasFixture()
+        {
+            LLFile::remove(mFilename, ENOENT);
+        }
+
+        LLVOCacheExtrasFile::EStatus load(LLVOCacheEntry::vocache_gltf_overrides_map_t& entries)
+        {
+            return LLVOCacheExtrasFile::load(mFilename, mRegionID,
+                [&](LLGLTFOverrideCacheEntry& entry)
+                {
+                    entries[entry.mLocalId] = std::move(entry);
+                });
+        }
+    };
+    typedef test_group<LLVOCacheExtrasFixture> LLVOCacheExtras_t;
+    typedef LLVOCacheExtras_t::object LLVOCacheExtras_object_t;
+    tut::LLVOCacheExtras_t tut_LLVOCacheExtras("LLVOCacheExtras");
+
+    template<> template<>
+    void LLVOCacheExtras_object_t::test<1>()
+    {
+        set_test_name("entries survive a save and load");
+
+        std::vector<LLGLTFOverrideCacheEntry> entries;
+        makeEntries(entries, 3);
+        entries[1].mSides.erase(1);
+        entries[1].mGLTFMaterial.erase(1);
+
+        LLVOCacheExtrasFile file;
+        for (const LLGLTFOverrideCacheEntry& entry : entries)
+        {
+            file.add(entry);
+        }
+        ensure_equals("count", file.getCount(), 3U);
+        ensure("save", file.save(mFilename, mRegionID));
+
+        LLVOCacheEntry::vocache_gltf_overrides_map_t loaded;
+        ensure_equals("load", load(loaded), LLVOCacheExtrasFile::LOADED);
+        ensure_equals("loaded count", loaded.size(), (size_t)3);
+        for (const LLGLTFOverrideCacheEntry& entry : entries)
+        {
+            const LLGLTFOverrideCacheEntry& read_back = loaded[entry.mLocalId];
+            ensure_equals("object id", read_back.mObjectId, entry.mObjectId);
+            ensure_equals("region handle", read_back.mRegionHandle, entry.mRegionHandle);
+            ensure_equals("sides", read_back.mSides.size(), entry.mSides.size());
+            ensure_equals("materials", read_back.mGLTFMaterial.size(), entry.mSides.size());
+            ensure_equals("override", read_back.mSides.at(0), entry.mSides.at(0));
+        }
+    }
+
+    template<> template<>
+    void LLVOCacheExtras_object_t::test<2>()
+    {
+        set_test_name("missing, foreign, old and torn files are rejected");
+
+        LLVOCacheEntry::vocache_gltf_overrides_map_t loaded;
+        ensure_equals("missing", load(loaded), LLVOCacheExtrasFile::NOT_FOUND);
+
+        std::vector<LLGLTFOverrideCacheEntry> entries;
+        makeEntries(entries, 2);
+        LLVOCacheExtrasFile file;
+        file.add(entries[0]);
+        file.add(entries[1]);
+        ensure("save foreign", file.save(mFilename, LLUUID::generateNewID()));
+        ensure_equals("other region", load(loaded), LLVOCacheExtrasFile::WRONG_REGION);
+
+        writeTextFile(mFilename, mRegionID, entries);
+        ensure_equals("version 1", load(loaded), LLVOCacheExtrasFile::BAD_FORMAT);
+
+        // Cut the second entry short, the first is still handed over
+        ensure("save", file.save(mFilename, mRegionID));
+        std::string contents = LLFile::getContents(mFilename);
+        LLFILE* out = LLFile::fopen(mFilename, "wb");
+        ensure("rewrite", out != nullptr);
+        fwrite(contents.data(), 1, contents.size() - 10, out);
+        fclose(out);
+        ensure_equals("torn", load(loaded), LLVOCacheExtrasFile::TRUNCATED);
+        ensure_equals("entries before the tear", loaded.size(), (size_t)1);
+        ensure_equals("first entry", loaded.begin()->first, entries[0].mLocalId);
+    }
+
+    template<> template<>
+    void LLVOCacheExtras_object_t::test<3>()
+    {
+        set_test_name("region extras write and read, text vs binary file");
+
+        skip_unless_benchmarks();
+
+        std::vector<LLGLTFOverrideCacheEntry> entries;
+        makeEntries(entries, BENCH_OBJECT_COUNT);
+
+        typedef std::chrono::steady_clock clock;
+        auto ms = [](clock::duration d) { return std::chrono::duration<F64, std::milli>(d).count(); };
+
+        // Version 1
+        auto start = clock::now();
+        writeTextFile(mFilename, mRegionID, entries);
+        auto text_written = clock::now();
+        llstat text_stat;
+        LLFile::stat(mFilename, &text_stat);
+
+        LLVOCacheEntry::vocache_gltf_overrides_map_t text_loaded;
+        U32 text_count = readTextFile(mFilename, mRegionID, text_loaded);
+        auto text_read = clock::now();
+        LLFile::remove(mFilename);
+
+        // Version 2, through the same calls LLVOCache makes
+        auto binary_start = clock::now();
+        LLVOCacheExtrasFile file;
+        file.reserve(entries.size());
+        for (const LLGLTFOverrideCacheEntry& entry : entries)
+        {
+            file.add(entry);
+        }
+        ensure("save", file.save(mFilename, mRegionID));
+        auto binary_written = clock::now();
+        llstat binary_stat;
+        LLFile::stat(mFilename, &binary_stat);
+
+        LLVOCacheEntry::vocache_gltf_overrides_map_t binary_loaded;
+        binary_loaded.reserve(entries.size());
+        LLVOCacheExtrasFile::EStatus status = load(binary_loaded);
+        auto binary_read = clock::now();
+
+        std::cout << "\nGLTF extras cache, " << BENCH_OBJECT_COUNT << " objects:\n"
+                  << "  text   " << text_stat.st_size << " bytes, write " << ms(text_written - start)
+                  << " ms, read " << ms(text_read - text_written) << " ms\n"
+                  << "  binary " << binary_stat.st_size << " bytes, write " << ms(binary_written - binary_start)
+                  << " ms, read " << ms(binary_read - binary_written) << " ms"
+                  << std::endl;
+
+        ensure_equals("text entries", text_count, BENCH_OBJECT_COUNT);
+        ensure_equals("binary status", status, LLVOCacheExtrasFile::LOADED);
+        ensure_equals("binary entries", binary_loaded.size(), (size_t)BENCH_OBJECT_COUNT);
+        ensure_equals("same content", binary_loaded[BENCH_OBJECT_COUNT].toLLSD(), text_loaded[BENCH_OBJECT_COUNT].toLLSD());
+    }
+}
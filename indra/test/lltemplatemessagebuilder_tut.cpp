@@ -31,6 +31,7 @@
 
 #include "llapr.h"
 #include "llmessagetemplate.h"
+#include "llmessagetemplatetable.h"
 #include "llmath.h"
 #include "llquaternion.h"
 #include "lltemplatemessagebuilder.h"
@@ -44,7 +45,7 @@
 namespace tut
 {
     static LLTemplateMessageBuilder::message_template_name_map_t nameMap;
-    static LLTemplateMessageReader::message_template_number_map_t numberMap;
+    static LLMessageTemplateTable numberTable;
 
     struct LLTemplateMessageBuilderTestData
     {
@@ -103,14 +104,14 @@ namespace tut
             LLTemplateMessageBuilder* builder,
             U8 offset = 0)
         {
-            numberMap[1] = &messageTemplate;
+            numberTable.add(&messageTemplate);
             const U32 bufferSize = 1024;
             U8 buffer[bufferSize];
             // zero out the packet ID field
             memset(buffer, 0, LL_PACKET_ID_SIZE);
             U32 builtSize = builder->buildMessage(buffer, bufferSize, offset);
             delete builder;
-            LLTemplateMessageReader* reader = new LLTemplateMessageReader(numberMap);
+            LLTemplateMessageReader* reader = new LLTemplateMessageReader(numberTable);
             reader->validateMessage(buffer, builtSize, LLHost());
             reader->readMessage(buffer, LLHost());
             return reader;
@@ -885,9 +886,9 @@ namespace tut
         messageTemplate.addBlock(createBlock(const_cast<char*>(_PREHASH_Test1), MVT_U32, 4, MBT_SINGLE));
 
         // read message value and default value
-        numberMap[1] = &messageTemplate;
+        numberTable.add(&messageTemplate);
         LLTemplateMessageReader* reader =
-            new LLTemplateMessageReader(numberMap);
+            new LLTemplateMessageReader(numberTable);
         reader->validateMessage(buffer, builtSize, LLHost());
         reader->readMessage(buffer, LLHost());
         reader->getU32(_PREHASH_Test0, _PREHASH_Test0, outValue);
@@ -918,9 +919,9 @@ namespace tut
         messageTemplate.addBlock(createBlock(const_cast<char*>(_PREHASH_Test1), MVT_U32, 4));
 
         // read message value and check block repeat count
-        numberMap[1] = &messageTemplate;
+        numberTable.add(&messageTemplate);
         LLTemplateMessageReader* reader =
-            new LLTemplateMessageReader(numberMap);
+            new LLTemplateMessageReader(numberTable);
         reader->validateMessage(buffer, builtSize, LLHost());
         reader->readMessage(buffer, LLHost());
         reader->getU32(_PREHASH_Test0, _PREHASH_Test0, outValue);
@@ -952,9 +953,9 @@ namespace tut
                                              MBT_SINGLE));
 
         // read message value and default string
-        numberMap[1] = &messageTemplate;
+        numberTable.add(&messageTemplate);
         LLTemplateMessageReader* reader =
-            new LLTemplateMessageReader(numberMap);
+            new LLTemplateMessageReader(numberTable);
         reader->validateMessage(buffer, builtSize, LLHost());
         reader->readMessage(buffer, LLHost());
         reader->getU32(_PREHASH_Test0, _PREHASH_Test0, outValue);
@@ -0,0 +1,342 @@
+/**
+ * @file lltemplatemessagereader_tut.cpp
+ * @brief Template dispatch tests and UDP packet replay benchmark.
+ *
+ * $LicenseInfo:firstyear=2025&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2025, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+#include "linden_common.h"
+#include "lltut.h"
+
+#include "llapr.h"
+#include "llformat.h"
+#include "llmessagetemplate.h"
+#include "llmessagetemplateparser.h"
+#include "llmessagetemplatetable.h"
+#include "lltemplatemessagebuilder.h"
+#include "lltemplatemessagereader.h"
+#include "message.h"
+#include "message_prehash.h"
+#include "v3math.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    // The two messages that dominate a busy region, as in
+    // message_template.msg except that ObjectUpdate only keeps the fields
+    // the viewer reads on every update. The remaining messages pad the
+    // table out to the size of the real template file.
+    std::string benchmarkTemplates()
+    {
+        std::ostringstream str;
+        str << "version 2.0\n"
+            << "{\n"
+            << "    ObjectUpdate High 12 Trusted Unencoded\n"
+            << "    {\n"
+            << "        RegionData Single\n"
+            << "        {   RegionHandle    U64 }\n"
+            << "        {   TimeDilation    U16 }\n"
+            << "    }\n"
+            << "    {\n"
+            << "        ObjectData Variable\n"
+            << "        {   ID              U32         }\n"
+            << "        {   State           U8          }\n"
+            << "        {   FullID          LLUUID      }\n"
+            << "        {   CRC             U32         }\n"
+            << "        {   PCode           U8          }\n"
+            << "        {   Scale           LLVector3   }\n"
+            << "        {   ObjectData      Variable 1  }\n"
+            << "        {   ParentID        U32         }\n"
+            << "        {   UpdateFlags     U32         }\n"
+            << "        {   TextureEntry    Variable 2  }\n"
+            << "        {   ExtraParams     Variable 1  }\n"
+            << "    }\n"
+            << "}\n"
+            << "{\n"
+            << "    ImprovedTerseObjectUpdate High 15 Trusted Unencoded\n"
+            << "    {\n"
+            << "        RegionData Single\n"
+            << "        {   RegionHandle    U64 }\n"
+            << "        {   TimeDilation    U16 }\n"
+            << "    }\n"
+            << "    {\n"
+            << "        ObjectData Variable\n"
+            << "        {   Data            Variable 1  }\n"
+            << "        {   TextureEntry    Variable 2  }\n"
+            << "    }\n"
+            << "}\n";
+        for (S32 i = 0; i < 450; ++i)
+        {
+            const char* frequency = (i < 30) ? "High" : (i < 100) ? "Medium" : "Low";
+            const S32 number = (i < 30) ? 20 + i : (i < 100) ? i - 29 : i + 1;
+            str << "{\n"
+                << "    ReplayFiller" << i << " " << frequency << " " << number << " NotTrusted Unencoded\n"
+                << "    {\n"
+                << "        AgentData Single\n"
+                << "        {   AgentID     LLUUID  }\n"
+                << "    }\n"
+                << "}\n";
+        }
+        return str.str();
+    }
+
+    S32 sHandled = 0;
+
+    void count_message(LLMessageSystem*, void**)
+    {
+        ++sHandled;
+    }
+}
+
+namespace tut
+{
+    struct LLTemplateMessageReaderTestData
+    {
+        LLTemplateMessageReaderTestData()
+        {
+            if (!gMessageSystem)
+            {
+                ll_init_apr();
+                const F32 circuit_heartbeat_interval = 5;
+                const F32 circuit_timeout = 100;
+                start_messaging_system("notafile", 13035,
+                                       1,
+                                       0,
+                                       0,
+                                       false,
+                                       "notasharedsecret",
+                                       NULL,
+                                       false,
+                                       circuit_heartbeat_interval,
+                                       circuit_timeout);
+            }
+
+            std::string body = benchmarkTemplates();
+            LLTemplateTokenizer tokens(body);
+            LLTemplateParser parsed(tokens);
+            for (LLTemplateParser::message_iterator iter = parsed.getMessagesBegin();
+                 iter != parsed.getMessagesEnd(); ++iter)
+            {
+                LLMessageTemplate* templatep = *iter;
+                templatep->setHandlerFunc(count_message, NULL);
+                mNameMap[templatep->mName] = templatep;
+                mNumberMap[templatep->mMessageNumber] = templatep;
+                mTable.add(templatep);
+            }
+        }
+
+        ~LLTemplateMessageReaderTestData()
+        {
+            for_each(mNumberMap.begin(), mNumberMap.end(), DeletePairedPointer());
+        }
+
+        // Each of these builds one packet and appends it to mPackets
+        void addObjectUpdate(LLTemplateMessageBuilder& builder, S32 objects)
+        {
+            builder.newMessage(_PREHASH_ObjectUpdate);
+            builder.nextBlock(_PREHASH_RegionData);
+            builder.addU64(_PREHASH_RegionHandle, 0x0003e80000003e800ULL);
+            builder.addU16(_PREHASH_TimeDilation, 65535);
+            U8 object_data[60] = { 0 };
+            U8 texture_entry[120] = { 1 };
+            U8 extra_params[40] = { 2 };
+            for (S32 i = 0; i < objects; ++i)
+            {
+                builder.nextBlock(_PREHASH_ObjectData);
+                builder.addU32(_PREHASH_ID, 1000 + i);
+                builder.addU8(_PREHASH_State, 0);
+                builder.addUUID(_PREHASH_FullID, LLUUID::generateNewID());
+                builder.addU32(_PREHASH_CRC, i);
+                builder.addU8(_PREHASH_PCode, 9);
+                builder.addVector3(_PREHASH_Scale, LLVector3(1.f, 2.f, 3.f));
+                builder.addBinaryData(_PREHASH_ObjectData, object_data, sizeof(object_data));
+                builder.addU32(_PREHASH_ParentID, 0);
+                builder.addU32(_PREHASH_UpdateFlags, 0x10000);
+                builder.addBinaryData(_PREHASH_TextureEntry, texture_entry, sizeof(texture_entry));
+                builder.addBinaryData(_PREHASH_ExtraParams, extra_params, sizeof(extra_params));
+            }
+            finishPacket(builder);
+        }
+
+        void addTerseUpdate(LLTemplateMessageBuilder& builder, S32 objects)
+        {
+            builder.newMessage(_PREHASH_ImprovedTerseObjectUpdate);
+            builder.nextBlock(_PREHASH_RegionData);
+            builder.addU64(_PREHASH_RegionHandle, 0x0003e80000003e800ULL);
+            builder.addU16(_PREHASH_TimeDilation, 65535);
+            U8 data[60] = { 3 };
+            for (S32 i = 0; i < objects; ++i)
+            {
+                builder.nextBlock(_PREHASH_ObjectData);
+                builder.addBinaryData(_PREHASH_Data, data, sizeof(data));
+                builder.addBinaryData(_PREHASH_TextureEntry, NULL, 0);
+            }
+            finishPacket(builder);
+        }
+
+        void finishPacket(LLTemplateMessageBuilder& builder)
+        {
+            std::vector<U8> packet(MAX_BUFFER_SIZE, 0);
+            U32 size = builder.buildMessage(&packet[0], (U32)packet.size(), 0);
+            packet.resize(size);
+            builder.clearMessage();
+            mPackets.push_back(packet);
+        }
+
+        LLTemplateMessageBuilder::message_template_name_map_t mNameMap;
+        LLTemplateMessageReader::message_template_number_map_t mNumberMap;
+        LLMessageTemplateTable mTable;
+        std::vector<std::vector<U8> > mPackets;
+    };
+
+    typedef test_group<LLTemplateMessageReaderTestData> LLTemplateMessageReaderTestGroup;
+    typedef LLTemplateMessageReaderTestGroup::object LLTemplateMessageReaderTestObject;
+    LLTemplateMessageReaderTestGroup templateMessageReaderTestGroup("LLTemplateMessageReader");
+
+    template<> template<>
+    void LLTemplateMessageReaderTestObject::test<1>()
+        // the dense table finds the same templates as the number map
+    {
+        ensure_equals("all templates dispatchable", mTable.size(), mNumberMap.size());
+        for (const auto& entry : mNumberMap)
+        {
+            ensure("same template", mTable.find(entry.first) == entry.second);
+        }
+        ensure("unknown high", mTable.find(250) == NULL);
+        ensure("unknown low", mTable.find(0xFFFF0000 | 60000) == NULL);
+        ensure("not a message number", mTable.find(0x00012345) == NULL);
+    }
+
+    template<> template<>
+    void LLTemplateMessageReaderTestObject::test<2>()
+        // decoded packets read back what was built
+    {
+        LLTemplateMessageBuilder builder(mNameMap);
+        addObjectUpdate(builder, 3);
+        addTerseUpdate(builder, 5);
+
+        LLTemplateMessageReader reader(mTable);
+        sHandled = 0;
+
+        const std::vector<U8>& full = mPackets[0];
+        ensure("full update valid", reader.validateMessage(&full[0], (S32)full.size(), LLHost()));
+        ensure("full update read", reader.readMessage(&full[0], LLHost()));
+        ensure_equals("full update blocks", reader.getNumberOfBlocks(_PREHASH_ObjectData), 3);
+        U32 id = 0;
+        reader.getU32(_PREHASH_ObjectData, _PREHASH_ID, id, 2);
+        ensure_equals("object id", id, (U32)1002);
+        ensure_equals("texture entry size", reader.getSize(_PREHASH_ObjectData, 1, _PREHASH_TextureEntry), 120);
+        reader.clearMessage();
+
+        const std::vector<U8>& terse = mPackets[1];
+        ensure("terse update valid", reader.validateMessage(&terse[0], (S32)terse.size(), LLHost()));
+        ensure("terse update read", reader.readMessage(&terse[0], LLHost()));
+        ensure_equals("terse update blocks", reader.getNumberOfBlocks(_PREHASH_ObjectData), 5);
+        reader.clearMessage();
+
+        ensure_equals("handlers called", sHandled, 2);
+    }
+
+    template<> template<>
+    void LLTemplateMessageReaderTestObject::test<3>()
+        // packet replay benchmark
+    {
+        skip_unless_benchmarks();
+
+        // A busy region: mostly terse updates with the odd full update
+        LLTemplateMessageBuilder builder(mNameMap);
+        for (S32 i = 0; i < 64; ++i)
+        {
+            if (i % 8)
+            {
+                addTerseUpdate(builder, 1 + i % 10);
+            }
+            else
+            {
+                addObjectUpdate(builder, 1 + i % 4);
+            }
+        }
+
+        std::vector<U32> numbers;
+        U64 total_bytes = 0;
+        for (const std::vector<U8>& packet : mPackets)
+        {
+            numbers.push_back(packet[LL_PACKET_ID_SIZE]);
+            total_bytes += packet.size();
+        }
+
+        const S32 REPLAYS = 2000;
+
+        // template lookup alone, map against dense table
+        U64 found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (S32 r = 0; r < REPLAYS; ++r)
+        {
+            for (U32 number : numbers)
+            {
+                found += get_ptr_in_map(mNumberMap, number) != NULL;
+            }
+        }
+        std::chrono::duration<F64> map_time = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        for (S32 r = 0; r < REPLAYS; ++r)
+        {
+            for (U32 number : numbers)
+            {
+                found += mTable.find(number) != NULL;
+            }
+        }
+        std::chrono::duration<F64> table_time = std::chrono::steady_clock::now() - start;
+        ensure_equals("all found", found, (U64)(2 * REPLAYS * numbers.size()));
+
+        // full receive path: validate, decode, dispatch
+        LLTemplateMessageReader reader(mTable);
+        sHandled = 0;
+        start = std::chrono::steady_clock::now();
+        for (S32 r = 0; r < REPLAYS; ++r)
+        {
+            for (const std::vector<U8>& packet : mPackets)
+            {
+                if (reader.validateMessage(&packet[0], (S32)packet.size(), LLHost()))
+                {
+                    reader.readMessage(&packet[0], LLHost());
+                }
+                reader.clearMessage();
+            }
+        }
+        std::chrono::duration<F64> replay_time = std::chrono::steady_clock::now() - start;
+        ensure_equals("all dispatched", sHandled, (S32)(REPLAYS * mPackets.size()));
+
+        const F64 lookups = (F64)REPLAYS * numbers.size();
+        const F64 packets = (F64)REPLAYS * mPackets.size();
+        std::cout << "\nTemplate lookup: std::map " << map_time.count() * 1e9 / lookups << " ns, table "
+                  << table_time.count() * 1e9 / lookups << " ns; packet replay "
+                  << packets / llmax(replay_time.count(), 1e-9) << " packets/s, "
+                  << (F64)total_bytes * REPLAYS / (1024.0 * 1024.0) / llmax(replay_time.count(), 1e-9) << " MB/s"
+                  << std::endl;
+    }
+}
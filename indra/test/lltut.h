@@ -30,6 +30,7 @@
 #define LL_LLTUT_H
 
 #include "is_approx_equal_fraction.h" // instead of llmath.h
+#include "llstring.h"
 #include <cstring>
 
 class LLDate;
@@ -162,6 +163,16 @@ namespace tut
     {
         ensure_not_equals(NULL, actual, expected);
     }
+
+    // Benchmarks are slow and only print their numbers, so they run only
+    // when LL_TEST_BENCHMARKS is set
+    inline void skip_unless_benchmarks()
+    {
+        if (LLStringUtil::getenv("LL_TEST_BENCHMARKS").empty())
+        {
+            skip("set LL_TEST_BENCHMARKS to run benchmarks");
+        }
+    }
 }
 
 #endif // LL_LLTUT_H